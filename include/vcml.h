@@ -17,6 +17,10 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/range.h"
 #include "vcml/core/peq.h"
+#include "vcml/core/entropy.h"
+#include "vcml/core/checkpoint.h"
+#include "vcml/core/replay.h"
+#include "vcml/core/fork.h"
 #include "vcml/core/command.h"
 #include "vcml/core/module.h"
 #include "vcml/core/component.h"
@@ -24,13 +28,22 @@
 #include "vcml/core/peripheral.h"
 #include "vcml/core/processor.h"
 #include "vcml/core/system.h"
+#include "vcml/core/roi.h"
+#include "vcml/core/offload.h"
+#include "vcml/core/crc.h"
 #include "vcml/core/setup.h"
 #include "vcml/core/model.h"
+#include "vcml/core/startup.h"
 
 #include "vcml/logging/logger.h"
+#include "vcml/logging/async_publisher.h"
+#include "vcml/logging/log_throttle.h"
 
 #include "vcml/tracing/tracer.h"
 #include "vcml/tracing/tracer_file.h"
+#include "vcml/tracing/tracer_bin.h"
+#include "vcml/tracing/tracer_chrome.h"
+#include "vcml/tracing/tracer_vcd.h"
 #include "vcml/tracing/tracer_term.h"
 
 #include "vcml/properties/property_base.h"
@@ -44,15 +57,19 @@
 #include "vcml/debugging/symtab.h"
 #include "vcml/debugging/target.h"
 #include "vcml/debugging/loader.h"
+#include "vcml/debugging/profiler.h"
 #include "vcml/debugging/subscriber.h"
 #include "vcml/debugging/suspender.h"
 #include "vcml/debugging/rspserver.h"
 #include "vcml/debugging/gdbarch.h"
 #include "vcml/debugging/gdbserver.h"
 #include "vcml/debugging/vspserver.h"
+#include "vcml/debugging/metrics_server.h"
 
 #include "vcml/ui/keymap.h"
 #include "vcml/ui/video.h"
+#include "vcml/ui/damage.h"
+#include "vcml/ui/convert.h"
 #include "vcml/ui/display.h"
 #include "vcml/ui/console.h"
 
@@ -77,6 +94,7 @@
 #include "vcml/models/generic/gpio.h"
 #include "vcml/models/generic/hwrng.h"
 #include "vcml/models/generic/fbdev.h"
+#include "vcml/models/generic/remote.h"
 
 #include "vcml/models/serial/backend.h"
 #include "vcml/models/serial/terminal.h"
@@ -145,6 +163,7 @@
 #include "vcml/models/riscv/plic.h"
 #include "vcml/models/riscv/aclint.h"
 #include "vcml/models/riscv/aplic.h"
+#include "vcml/models/riscv/mtimer.h"
 #include "vcml/models/riscv/simdev.h"
 
 #include "vcml/models/deprecated.h"
@@ -0,0 +1,117 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef VCML_CHECKPOINT_H
+#define VCML_CHECKPOINT_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/protocols/tlm_memory.h"
+
+namespace vcml {
+
+// a checkpoint file holds a list of named records; records written for
+// memories skip all zero pages and are either compressed or placed at page
+// aligned file offsets, so that they can be mapped back in on restore.
+// Incremental checkpoints name a parent and only hold what has changed
+// since then, they must be restored on top of their parent
+class checkpoint
+{
+public:
+    enum : u64 {
+        PAGE_BYTES = 4 * KiB,
+        MAX_EXTENT = 16 * MiB,
+    };
+
+private:
+    struct record {
+        u32 flags;
+        u64 offset;
+        u64 size;
+        u64 stored;
+        u64 pos;
+    };
+
+    string m_path;
+    string m_parent;
+    bool m_writing;
+    bool m_compress;
+    sc_time m_time;
+    fstream m_file;
+    std::multimap<string, record> m_index;
+
+    void write_header();
+    void read_header();
+
+    void write_record(const string& name, u32 flags, u64 offset,
+                      const void* data, size_t size);
+    void read_record(const record& rec, void* data);
+
+    void save_delta(const string& name, tlm_memory& mem);
+
+public:
+    const char* path() const { return m_path.c_str(); }
+    const char* parent() const { return m_parent.c_str(); }
+    bool is_incremental() const { return !m_parent.empty(); }
+    bool is_writing() const { return m_writing; }
+    bool is_compressed() const { return m_compress; }
+
+    // simulation time at which the checkpoint was taken
+    const sc_time& time() const { return m_time; }
+
+    checkpoint(const string& path, bool write, bool compress = false,
+               const string& parent = "");
+    virtual ~checkpoint();
+
+    checkpoint() = delete;
+    checkpoint(const checkpoint&) = delete;
+
+    bool has(const string& name) const;
+
+    void save(const string& name, const void* data, size_t size,
+              u64 offset = 0);
+    bool load(const string& name, void* data, size_t size);
+
+    // calls fn for every record called name, in the order they were saved
+    size_t load_all(const string& name,
+                    const function<void(u64, const u8*, size_t)>& fn);
+
+    template <typename T>
+    void save(const string& name, const T& val);
+    template <typename T>
+    bool load(const string& name, T& val);
+
+    // properties of all objects below root; those of skip are left out and
+    // if prev is given, only values that differ from it are saved
+    void save_properties(const sc_object& root, const sc_object* skip,
+                         unordered_map<string, string>* prev = nullptr);
+    void load_properties(const sc_object& root, const sc_object* skip);
+
+    // memories tracking dirty pages only save those pages in incremental
+    // checkpoints; every checkpoint consumes the dirty bits of the memory
+    void save_memory(const string& name, tlm_memory& mem);
+    void load_memory(const string& name, tlm_memory& mem);
+};
+
+template <typename T>
+void checkpoint::save(const string& name, const T& val) {
+    save(name, &val, sizeof(val));
+}
+
+template <typename T>
+bool checkpoint::load(const string& name, T& val) {
+    return load(name, &val, sizeof(val));
+}
+
+} // namespace vcml
+
+#endif
@@ -34,8 +34,7 @@ private:
     sc_event m_clkrst_ev;
 
     bool cmd_reset(const vector<string>& args, ostream& os);
-
-    void do_reset();
+    bool cmd_tlm_stats(const vector<string>& args, ostream& os);
 
 public:
     clk_target_socket clk;
@@ -50,6 +49,9 @@ public:
 
     virtual void reset();
 
+    // invalidates all dmi pointers handed out before calling reset
+    void do_reset();
+
     virtual void wait_clock_reset();
     virtual void wait_clock_cycle();
     virtual void wait_clock_cycles(u64 num);
@@ -57,6 +59,9 @@ public:
     sc_time clock_cycle() const { return clk.cycle(); }
     sc_time clock_cycles(size_t n) const { return clk.cycles(n); }
 
+    // clock cycle in units of the systemc time resolution
+    u64 clock_cycle_ticks() const { return clk.cycle_ticks(); }
+
     hz_t clock_hz() const { return clk.read(); }
 
     virtual unsigned int transport(tlm_target_socket& socket,
@@ -0,0 +1,45 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_CRC_H
+#define VCML_CRC_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+enum crc_isa {
+    CRC_ISA_BYTEWISE, // one table lookup per byte
+    CRC_ISA_SLICED,   // slicing-by-8, one pass over eight tables per word
+    CRC_ISA_PCLMUL,   // x86 carry-less multiplication folding
+    CRC_ISA_ARMV8,    // armv8 crc32 instructions
+};
+
+const char* crc_isa_str(crc_isa isa);
+bool crc_isa_supported(crc_isa isa);
+crc_isa crc_isa_host();
+
+// crc-7/mmc (poly 0x09, init 0, msb first) returned in bits 7:1, so that
+// sd commands and registers only need to add their end bit
+u8 crc7_sd(const u8* data, size_t len, u8 crc = 0);
+
+// crc-16/xmodem (poly 0x1021, init 0, msb first) protecting sd data blocks;
+// there are no instructions for it, so hardware isas use the sliced tables
+u16 crc16_sd(const u8* data, size_t len, u16 crc = 0);
+u16 crc16_sd(const u8* data, size_t len, u16 crc, crc_isa isa);
+
+// crc-32/iso-hdlc (reflected poly 0xedb88320, inverted in and out) used as
+// ethernet frame check sequence; pass a previous result to continue it
+u32 crc32_eth(const u8* data, size_t len, u32 crc = 0);
+u32 crc32_eth(const u8* data, size_t len, u32 crc, crc_isa isa);
+
+} // namespace vcml
+
+#endif
@@ -0,0 +1,59 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef VCML_ENTROPY_H
+#define VCML_ENTROPY_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// hands out random bytes from a pool that is refilled in bulk, either from
+// a seeded xoshiro256** generator (pseudo) or from the host entropy source;
+// requests larger than the pool are generated straight into the buffer
+class entropy_pool
+{
+private:
+    bool m_pseudo;
+    u64 m_state[4];
+    vector<u8> m_pool;
+    size_t m_pos;
+
+    u64 xoshiro();
+    bool generate(u8* buffer, size_t size);
+
+public:
+    static constexpr size_t POOL_SIZE = 4 * KiB;
+
+    bool is_pseudo() const { return m_pseudo; }
+
+    entropy_pool();
+    entropy_pool(bool pseudo, u64 seed);
+
+    // drops all buffered bytes and restarts the pseudo sequence from seed
+    void reset(bool pseudo, u64 seed);
+
+    bool fill(void* buffer, size_t size);
+
+    template <typename T>
+    T next();
+};
+
+template <typename T>
+T entropy_pool::next() {
+    T val = T();
+    fill(&val, sizeof(val));
+    return val;
+}
+
+} // namespace vcml
+
+#endif
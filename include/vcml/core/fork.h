@@ -0,0 +1,42 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_FORK_H
+#define VCML_FORK_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// host threads do not survive fork(), so backends that own one derive from
+// this to have the fork server stop their thread in the parent before the
+// first child is forked and start it anew in every child
+class fork_handler
+{
+public:
+    fork_handler();
+    virtual ~fork_handler();
+
+    virtual void fork_prepare() = 0;
+    virtual void fork_child() = 0;
+};
+
+// listens on port and forks one child per client connection. The parent
+// never returns unless serving fails. Each child returns with the first
+// line the client sent and keeps the connection open until fork_exit
+// reports its exit code back to the client
+bool fork_serve(u16 port, string& request);
+
+bool fork_is_child();
+void fork_exit(int code);
+
+} // namespace vcml
+
+#endif
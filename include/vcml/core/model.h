@@ -17,12 +17,32 @@
 
 namespace vcml {
 
+// stands in for optional models that have not been enabled, binding any of
+// its ports via tlm_bind or gpio_bind stubs the peer socket instead
+class placeholder : public module
+{
+public:
+    const string model_kind;
+
+    placeholder(const sc_module_name& nm, const string& kind):
+        module(nm), model_kind(kind) {}
+    virtual ~placeholder() = default;
+    VCML_KIND(placeholder);
+};
+
+inline bool is_placeholder(const sc_object& obj) {
+    return dynamic_cast<const placeholder*>(&obj) != nullptr;
+}
+
 class model
 {
 public:
     typedef module* (*create_fn)(const sc_module_name&, const vector<string>&);
 
     model(const sc_module_name& name, const string& kind);
+
+    // optional models only get constructed if <name>.enabled is set
+    model(const sc_module_name& name, const string& kind, bool optional);
     virtual ~model() = default;
 
     model(const model& other) = default;
@@ -31,6 +51,8 @@ public:
     operator module&() const { return *m_impl; }
     shared_ptr<module> operator->() const { return m_impl; }
 
+    bool is_enabled() const { return !is_placeholder(*m_impl); }
+
     static bool define(const string& kind, create_fn fn);
     static void list_models(ostream& os);
 
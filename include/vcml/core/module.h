@@ -21,6 +21,8 @@
 
 namespace vcml {
 
+class checkpoint;
+
 class module : public sc_module
 {
 private:
@@ -53,6 +55,12 @@ public:
     virtual void session_suspend();
     virtual void session_resume();
 
+    // save_state is called before and load_state after the properties of
+    // all modules have been processed, models keeping state elsewhere must
+    // save and restore it here
+    virtual void save_state(checkpoint& cp);
+    virtual void load_state(checkpoint& cp);
+
     bool execute(const string& name, ostream& os);
     bool execute(const string& name, const vector<string>& args, ostream& os);
 
@@ -131,6 +139,8 @@ inline command_base* module::get_command(const string& name) {
 template <typename PAYLOAD>
 void module::record(trace_direction dir, const sc_object& port,
                     const PAYLOAD& tx, const sc_time& t) const {
+    if (!tracer::any())
+        return;
     if (trace_all || (trace_errors && is_backward_trace(dir) && failed(tx)))
         tracer::record(dir, port, tx, t);
 }
@@ -0,0 +1,65 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_OFFLOAD_H
+#define VCML_OFFLOAD_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/properties/property.h"
+
+namespace vcml {
+
+// runs expensive, self-contained compute jobs of a model (checksums,
+// decompression, software segmentation) on an sc_async worker: the calling
+// SC_THREAD only resumes once the job has finished while all other processes
+// keep running, and simulated time advances by latency plus the job size
+// divided by throughput. Simulation only moves past the end of that time
+// once the job is done, so a zero cost stalls everyone else until then. Jobs
+// must not touch systemc or model state that other processes use. Outside of
+// SC_THREAD context or with async disabled, jobs run inline; time is then
+// only charged from within threads
+class offload
+{
+private:
+    string m_name;
+    u64 m_num_jobs;
+    u64 m_num_async;
+
+    string prop_name(const char* suffix) const;
+
+public:
+    property<bool> async;
+    property<sc_time> latency;
+    property<u64> throughput; // bytes per second, zero means infinite
+
+    const char* name() const { return m_name.c_str(); }
+
+    u64 num_jobs() const { return m_num_jobs; }
+    u64 num_async() const { return m_num_async; }
+
+    // creates the properties <name>_async, <name>_latency and
+    // <name>_throughput below parent
+    offload(sc_object* parent, const string& name, bool async = false,
+            const sc_time& latency = SC_ZERO_TIME, u64 throughput = 0);
+    virtual ~offload() = default;
+
+    offload() = delete;
+    offload(const offload&) = delete;
+
+    sc_time cost(size_t bytes) const;
+
+    void run(function<void(void)> job, size_t bytes = 0);
+};
+
+} // namespace vcml
+
+#endif
@@ -16,15 +16,52 @@
 
 namespace vcml {
 
+enum peq_backend {
+    PEQ_TREE, // ordered multimap, one tree node per event
+    PEQ_HEAP, // pooled binary heap, payloads (hashed) indexed for cancel
+};
+
 template <typename T>
 class peq : public sc_object
 {
 private:
+    struct heap_entry {
+        sc_time time;
+        u64 seq;
+        u64 gen;
+        T payload;
+    };
+
+    struct heap_compare {
+        bool operator()(const heap_entry& a, const heap_entry& b) const {
+            if (a.time != b.time)
+                return a.time > b.time;
+            return a.seq > b.seq;
+        }
+    };
+
+    struct heap_index {
+        u64 gen;
+        vector<sc_time> times;
+    };
+
+    const peq_backend m_backend;
     sc_event m_event;
     std::multimap<sc_time, T> m_schedule;
 
+    vector<heap_entry> m_heap;
+    unordered_map<T, heap_index> m_index;
+    u64 m_seq;
+    u64 m_gen;
+
+    bool heap_live(const heap_entry& entry) const;
+    void heap_purge();
+    bool next_time(sc_time& t);
+
 public:
-    peq(const char* nm);
+    peq_backend backend() const { return m_backend; }
+
+    peq(const char* nm, peq_backend backend = PEQ_TREE);
     virtual ~peq() = default;
     VCML_KIND(peq);
 
@@ -35,10 +72,46 @@ public:
 };
 
 template <typename T>
-inline peq<T>::peq(const char* nm):
+inline bool peq<T>::heap_live(const heap_entry& entry) const {
+    auto it = m_index.find(entry.payload);
+    return it != m_index.end() && it->second.gen == entry.gen;
+}
+
+template <typename T>
+inline void peq<T>::heap_purge() {
+    // entries of cancelled payloads are only dropped once they surface
+    while (!m_heap.empty() && !heap_live(m_heap.front())) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), heap_compare());
+        m_heap.pop_back();
+    }
+}
+
+template <typename T>
+inline bool peq<T>::next_time(sc_time& t) {
+    if (m_backend == PEQ_HEAP) {
+        heap_purge();
+        if (m_heap.empty())
+            return false;
+        t = m_heap.front().time;
+        return true;
+    }
+
+    if (m_schedule.empty())
+        return false;
+    t = m_schedule.begin()->first;
+    return true;
+}
+
+template <typename T>
+inline peq<T>::peq(const char* nm, peq_backend backend):
     sc_object(nm),
+    m_backend(backend),
     m_event(mkstr("%s_event", basename()).c_str()),
-    m_schedule() {
+    m_schedule(),
+    m_heap(),
+    m_index(),
+    m_seq(0),
+    m_gen(0) {
     // nothing to do
 }
 
@@ -50,29 +123,47 @@ inline void peq<T>::notify(const T& payload, double t, sc_time_unit tu) {
 template <typename T>
 inline void peq<T>::notify(const T& payload, const sc_time& delta) {
     sc_time t = sc_time_stamp() + delta;
-    auto range = m_schedule.equal_range(t);
-    for (auto it = range.first; it != range.second; it++)
-        if (it->second == payload)
+
+    if (m_backend == PEQ_HEAP) {
+        auto it = m_index.find(payload);
+        if (it == m_index.end())
+            it = m_index.emplace(payload, heap_index{ m_gen++, {} }).first;
+        else if (stl_contains(it->second.times, t))
             return;
 
-    m_schedule.emplace(t, payload);
-    m_event.notify(m_schedule.begin()->first - sc_time_stamp());
+        it->second.times.push_back(t);
+        m_heap.push_back({ t, m_seq++, it->second.gen, payload });
+        std::push_heap(m_heap.begin(), m_heap.end(), heap_compare());
+    } else {
+        auto range = m_schedule.equal_range(t);
+        for (auto it = range.first; it != range.second; it++)
+            if (it->second == payload)
+                return;
+
+        m_schedule.emplace(t, payload);
+    }
+
+    sc_time next;
+    if (next_time(next))
+        m_event.notify(next - sc_time_stamp());
 }
 
 template <typename T>
 inline void peq<T>::cancel(const T& payload) {
-    if (m_schedule.empty())
+    sc_time curr, next;
+    if (!next_time(curr))
         return;
 
-    sc_time curr = m_schedule.begin()->first;
-    mwr::stl_remove(m_schedule, payload);
+    if (m_backend == PEQ_HEAP)
+        m_index.erase(payload);
+    else
+        mwr::stl_remove(m_schedule, payload);
 
-    if (m_schedule.empty()) {
+    if (!next_time(next)) {
         m_event.cancel();
         return;
     }
 
-    sc_time next = m_schedule.begin()->first;
     if (next == curr)
         return;
 
@@ -82,17 +173,35 @@ inline void peq<T>::cancel(const T& payload) {
 
 template <typename T>
 inline void peq<T>::wait(T& obj) {
-    auto it = m_schedule.find(sc_time_stamp());
-    while (it == m_schedule.end()) {
-        sc_core::wait(m_event);
-        it = m_schedule.find(sc_time_stamp());
+    if (m_backend == PEQ_HEAP) {
+        sc_time t;
+        while (!next_time(t) || t > sc_time_stamp())
+            sc_core::wait(m_event);
+
+        std::pop_heap(m_heap.begin(), m_heap.end(), heap_compare());
+        heap_entry& entry = m_heap.back();
+        obj = entry.payload;
+
+        auto it = m_index.find(entry.payload);
+        mwr::stl_remove(it->second.times, entry.time);
+        if (it->second.times.empty())
+            m_index.erase(it);
+
+        m_heap.pop_back();
+    } else {
+        auto it = m_schedule.find(sc_time_stamp());
+        while (it == m_schedule.end()) {
+            sc_core::wait(m_event);
+            it = m_schedule.find(sc_time_stamp());
+        }
+
+        obj = it->second;
+        m_schedule.erase(it);
     }
 
-    obj = it->second;
-    m_schedule.erase(it);
-
-    if (!m_schedule.empty())
-        m_event.notify(m_schedule.begin()->first - sc_time_stamp());
+    sc_time next;
+    if (next_time(next))
+        m_event.notify(next - sc_time_stamp());
 }
 
 } // namespace vcml
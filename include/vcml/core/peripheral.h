@@ -32,6 +32,15 @@ private:
     unordered_map<address_space, vector<reg_base*>> m_registers;
 
     bool cmd_mmap(const vector<string>& args, ostream& os);
+    bool cmd_regstats(const vector<string>& args, ostream& os);
+
+    typedef vector<reg_base*>::const_iterator reg_iter;
+
+    unsigned int receive_regs(tlm_generic_payload& tx, const tlm_sbi& info,
+                              address_space as, const vector<reg_base*>& regs,
+                              reg_iter first);
+    unsigned int receive_burst(tlm_generic_payload& tx, const tlm_sbi& info,
+                               address_space as);
 
 public:
     property<endianess> endian;
@@ -39,6 +48,9 @@ public:
     property<unsigned int> read_latency;
     property<unsigned int> write_latency;
 
+    // counts register accesses and host time spent in their callbacks
+    property<bool> register_stats;
+
     sc_time read_cycles() const { return clock_cycles(read_latency); }
     sc_time write_cycles() const { return clock_cycles(write_latency); }
 
@@ -76,6 +88,7 @@ public:
 
     const vector<reg_base*>& get_registers() const;
     const vector<reg_base*>& get_registers(address_space as) const;
+    vector<const reg_base*> get_all_registers() const;
 
     void map_dmi(const tlm_dmi& dmi);
     void map_dmi(unsigned char* ptr, u64 start, u64 end, vcml_access a);
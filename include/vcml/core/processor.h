@@ -16,6 +16,7 @@
 #include "vcml/core/component.h"
 
 #include "vcml/logging/logger.h"
+#include "vcml/logging/log_throttle.h"
 #include "vcml/properties/property.h"
 
 #include "vcml/protocols/tlm.h"
@@ -23,6 +24,7 @@
 
 #include "vcml/debugging/target.h"
 #include "vcml/debugging/gdbserver.h"
+#include "vcml/debugging/profiler.h"
 
 namespace vcml {
 
@@ -35,16 +37,100 @@ struct irq_stats {
     sc_time irq_longest;
 };
 
+struct processor_stats {
+    u64 num_quanta;
+    u64 num_cycles;
+    u64 num_idle_cycles;
+    u64 num_bus_errors;
+    u64 insn_dmi_hits;
+    u64 insn_dmi_misses;
+    u64 data_dmi_hits;
+    u64 data_dmi_misses;
+    double run_time;  // host seconds spent in simulate
+    double sync_time; // host seconds spent waiting for systemc
+    double mips;
+};
+
 class processor : public component, public debugging::target
 {
+public:
+    typedef function<void(const processor&, const processor_stats&)>
+        stats_hook;
+
 private:
     double m_run_time;
+    double m_sync_time;
     u64 m_cycle_count;
+    u64 m_cycle_base; // cycle_count() when stats were last reset
+    u64 m_num_quanta;
+    u64 m_num_bus_errors;
+    log_throttle m_bus_errors;
+
+    vector<stats_hook> m_stats_hooks;
+
+    bool m_idle;
+    bool m_sleeping;
+    sc_event m_idle_ev;
+    sc_time m_idle_time;
+    u64 m_idle_cycles;
 
     debugging::gdbserver* m_gdb;
 
-    unordered_map<size_t, irq_stats> m_irq_stats;
-    unordered_map<u64, property<void>*> m_regprops;
+    debugging::profiler* m_profiler;
+    sc_time m_next_sample;
+
+    // indexed by irq number, sized during elaboration
+    vector<irq_stats> m_irq_stats;
+
+    // pending interrupt lines as seen by gpio_notify, readable without
+    // locks from the iss thread, e.g. while simulating asynchronously
+    enum : size_t { IRQ_PENDING_WORDS = 4 };
+    atomic<u64> m_irq_pending[IRQ_PENDING_WORDS];
+    atomic<u64> m_irq_gen;
+
+    void update_irq_pending(size_t irqno, bool state);
+
+    // register properties are only fetched from the cpu on first access
+    // after a suspend or resume, and only modified ones get flushed back
+    class regprop;
+    unordered_map<u64, regprop*> m_regprops;
+    vector<regprop*> m_dirty_regprops;
+    u64 m_regprops_gen;
+
+    void flush_dirty_cpuregs();
+
+    // disassembly shown by cmd_disas keyed by physical address, entries are
+    // only reused while memory still holds the same instruction bytes
+    struct disas_entry {
+        u8 insn[16];
+        u64 size;
+        string code;
+    };
+
+    enum : size_t { DISAS_CACHE_ENTRIES = 4096 };
+    map<u64, disas_entry> m_disas_cache;
+
+    // stack trace shown by cmd_stack, valid until the next resume
+    struct {
+        bool valid;
+        u64 pc;
+        u64 sp;
+        u64 fp;
+        vector<debugging::stackframe> frames;
+    } m_stack_cache;
+
+    // instruction memory most recently handed out through fetch_block
+    struct {
+        range addr;
+        u8* ptr;
+    } m_fetch_block;
+
+    u64 m_fetch_epoch;
+
+    bool disassemble_cached(const range& addr,
+                            vector<debugging::disassembly>& s);
+    void invalidate_disas_cache(u64 start, u64 end);
+    void invalidate_stack_cache() { m_stack_cache.valid = false; }
 
     bool cmd_dump(const vector<string>& args, ostream& os);
     bool cmd_read(const vector<string>& args, ostream& os);
@@ -54,6 +140,11 @@ private:
     bool cmd_v2p(const vector<string>& args, ostream& os);
     bool cmd_stack(const vector<string>& args, ostream& os);
     bool cmd_gdb(const vector<string>& args, ostream& os);
+    bool cmd_stats(const vector<string>& args, ostream& os);
+    bool cmd_profile(const vector<string>& args, ostream& os);
+    bool cmd_bus_errors(const vector<string>& args, ostream& os);
+
+    irq_stats& lookup_irq_stats(size_t irq);
 
     virtual bool read_cpureg_dbg(const debugging::cpureg& reg, void* buf,
                                  size_t len) override;
@@ -64,6 +155,11 @@ private:
     void processor_thread();
     bool processor_thread_sync();
     bool processor_thread_async();
+    bool processor_thread_parallel();
+    bool processor_idle();
+    void processor_sync();
+    void processor_sample();
+    void trace_simulate(const sc_time& start);
 
 public:
     property<string> cpuarch;
@@ -77,6 +173,17 @@ public:
     property<bool> async;
     property<unsigned int> async_rate;
 
+    property<bool> parallel;
+    property<bool> deterministic;
+
+    property<unsigned int> stats_interval;
+
+    property<bool> profile;
+    property<sc_time> profile_interval;
+    property<string> profile_output;
+
+    property<unsigned int> bus_error_limit;
+
     gpio_target_array irq;
 
     tlm_initiator_socket insn;
@@ -92,18 +199,64 @@ public:
     virtual void session_suspend() override;
     virtual void session_resume() override;
 
+    virtual void save_state(checkpoint& cp) override;
+    virtual void load_state(checkpoint& cp) override;
+
     virtual u64 cycle_count() const = 0;
 
     double get_run_time() const { return m_run_time; }
-    double get_cps() const { return cycle_count() / m_run_time; }
+    double get_cps() const {
+        return (cycle_count() - m_cycle_base) / m_run_time;
+    }
+
+    bool is_idle() const { return m_idle; }
+    const sc_time& get_idle_time() const { return m_idle_time; }
+    u64 get_idle_cycles() const { return m_idle_cycles; }
+
+    // true while every processor sleeps waiting for an interrupt, the
+    // wakeup event gets notified as soon as the first one of them resumes
+    static bool platform_idle();
+    static const sc_event& platform_wakeup();
 
     virtual void reset() override;
 
     bool get_irq_stats(size_t irq, irq_stats& stats) const;
 
+    // lock-free alternative to the interrupt callback for isses that poll
+    // between translation blocks: irq_generation changes with every edge,
+    // only the first 64 * IRQ_PENDING_WORDS irqs are tracked
+    static constexpr size_t max_pending_irqs() {
+        return 64 * IRQ_PENDING_WORDS;
+    }
+
+    u64 irq_generation() const;
+    u64 irq_pending_word(size_t idx) const;
+    bool irq_pending(size_t irq) const;
+    bool irq_pending_any() const;
+
+    processor_stats get_stats() const;
+
+    // starts counting all statistics and the profile over, e.g. when the
+    // guest enters its region of interest
+    void reset_stats();
+
+    // hooks get called every stats_interval quanta and at the end of the
+    // simulation, a stats_interval of zero only reports at the end
+    void add_stats_hook(stats_hook hook);
+
+    // only available with profile enabled, otherwise returns nullptr
+    debugging::profiler* get_profiler() const { return m_profiler; }
+
     template <typename T>
     inline tlm_response_status fetch(u64 addr, T& data);
 
+    // returns a host pointer to the instruction memory at addr and sets
+    // size to the number of contiguous bytes behind it, or returns nullptr
+    // if addr cannot be reached via dmi and fetch must be used instead;
+    // pointers stay valid for as long as fetch_epoch remains unchanged
+    const u8* fetch_block(u64 addr, u64& size);
+    u64 fetch_epoch() const { return m_fetch_epoch; }
+
     template <typename T>
     inline tlm_response_status read(u64 addr, T& data);
 
@@ -120,13 +273,22 @@ protected:
     virtual void interrupt(size_t irq, bool set, gpio_vector vector);
     virtual void interrupt(size_t irq, bool set);
 
+    // called by the ISS from within simulate when it waits for interrupts
+    // (e.g. WFI), it should then return, the processor thread will sleep
+    // until the next interrupt is raised instead of simulating more cycles
+    void enter_idle() { m_idle = true; }
+
     virtual void simulate(size_t cycles) = 0;
     virtual void update_local_time(sc_time& time, sc_process_b* proc) override;
     virtual void end_of_elaboration() override;
+    virtual void end_of_simulation() override;
 
     virtual void fetch_cpuregs();
     virtual void flush_cpuregs();
 
+    virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                           u64 start, u64 end) override;
+
     virtual void define_cpureg(size_t regno, const string& name, size_t size,
                                size_t count, int prot) override;
 
@@ -146,6 +308,27 @@ protected:
     virtual const char* arch() override;
 };
 
+inline u64 processor::irq_generation() const {
+    return m_irq_gen.load(std::memory_order_acquire);
+}
+
+inline u64 processor::irq_pending_word(size_t idx) const {
+    if (idx >= IRQ_PENDING_WORDS)
+        return 0;
+    return m_irq_pending[idx].load(std::memory_order_acquire);
+}
+
+inline bool processor::irq_pending(size_t irq) const {
+    return (irq_pending_word(irq / 64) >> (irq % 64)) & 1;
+}
+
+inline bool processor::irq_pending_any() const {
+    for (size_t i = 0; i < IRQ_PENDING_WORDS; i++)
+        if (irq_pending_word(i))
+            return true;
+    return false;
+}
+
 template <typename T>
 inline tlm_response_status processor::fetch(u64 addr, T& data) {
     tlm_response_status rs = insn.readw(addr, data);
@@ -23,6 +23,16 @@ namespace vcml {
 
 class peripheral;
 
+// non-debug accesses and host time spent serving them, only collected when
+// the register_stats property of the host peripheral is set
+struct reg_stats {
+    u64 num_reads;
+    u64 num_writes;
+    double time;
+
+    u64 num_accesses() const { return num_reads + num_writes; }
+};
+
 class reg_base : public sc_object
 {
 private:
@@ -37,6 +47,7 @@ private:
     bool m_secure;
     u64 m_privilege;
     peripheral* m_host;
+    reg_stats m_stats;
 
     void do_receive(tlm_generic_payload& tx, const tlm_sbi& info);
 
@@ -89,6 +100,9 @@ public:
     peripheral* get_host() const { return m_host; }
     int current_cpu() const;
 
+    const reg_stats& stats() const { return m_stats; }
+    void reset_stats() { m_stats = reg_stats(); }
+
     reg_base(address_space as, const string& nm, u64 addr, u64 size, u64 n);
     virtual ~reg_base();
 
@@ -102,6 +116,11 @@ public:
     virtual void do_write(const range& addr, const void* ptr) = 0;
 };
 
+// lists the given registers sorted by number of accesses, at most limit
+// of them unless limit is zero
+void reg_print_stats(ostream& os, vector<const reg_base*> regs,
+                     size_t limit = 0);
+
 inline bool reg_base::is_read_only() const {
     return m_access == VCML_ACCESS_READ;
 }
@@ -110,6 +129,18 @@ inline bool reg_base::is_write_only() const {
     return m_access == VCML_ACCESS_WRITE;
 }
 
+template <typename FN>
+struct reg_callback_traits;
+
+template <typename HOST, typename RET, typename... ARGS>
+struct reg_callback_traits<RET (HOST::*)(ARGS...)> {
+    typedef HOST host_type;
+    static constexpr size_t nargs = sizeof...(ARGS);
+};
+
+template <auto FN>
+using reg_callback_host = typename reg_callback_traits<decltype(FN)>::host_type;
+
 template <typename DATA, size_t N = 1>
 class reg : public reg_base, public property<DATA, N>
 {
@@ -128,6 +159,9 @@ public:
     template <typename HOST>
     void on_read(DATA (HOST::*rd)(size_t), HOST* host = nullptr);
 
+    template <auto FN>
+    void on_read(reg_callback_host<FN>* host = nullptr);
+
     void on_write(const writefn& wr);
     void on_write(const writefn_tagged& wr);
 
@@ -137,6 +171,9 @@ public:
     template <typename HOST>
     void on_write(void (HOST::*wr)(DATA, size_t), HOST* h = nullptr);
 
+    template <auto FN>
+    void on_write(reg_callback_host<FN>* host = nullptr);
+
     void on_write_mask(DATA mask);
     void on_write_mask(const array<DATA, N>& mask);
 
@@ -227,19 +264,39 @@ public:
 private:
     bool m_banked;
     DATA m_init[N];
-    std::map<int, DATA*> m_banks;
+
+    // banks are stored back to back at slot bank + 1, so that accesses
+    // without a cpu (bank -1) get their own slot; bank 0 is the property
+    // itself. Creating a bank beyond the current ones invalidates all
+    // references to other banks, so room for MIN_BANKS is made at once
+    vector<DATA> m_banks;
+    size_t m_nbanks;
+
+    static constexpr size_t MIN_BANKS = 8;
 
     readfn m_read;
     writefn m_write;
     readfn_tagged m_read_tagged;
     writefn_tagged m_write_tagged;
 
+    // callbacks bound at compile time via on_read<FN> and on_write<FN>
+    DATA (*m_read_static)(void* host, size_t tag);
+    void (*m_write_static)(void* host, DATA val, size_t tag);
+    void* m_read_host;
+    void* m_write_host;
+
+    template <auto FN>
+    static DATA read_static(void* host, size_t tag);
+    template <auto FN>
+    static void write_static(void* host, DATA val, size_t tag);
+
     void init_bank(int bank);
 };
 template <typename DATA, size_t N>
 void reg<DATA, N>::on_read(const readfn& rd) {
     VCML_ERROR_ON(m_read, "read callback already defined");
     VCML_ERROR_ON(m_read_tagged, "tagged read callback already defined");
+    VCML_ERROR_ON(m_read_static, "static read callback already defined");
     m_read = rd;
 }
 
@@ -247,6 +304,7 @@ template <typename DATA, size_t N>
 void reg<DATA, N>::on_read(const readfn_tagged& rd) {
     VCML_ERROR_ON(m_read, "read callback already defined");
     VCML_ERROR_ON(m_read_tagged, "tagged read callback already defined");
+    VCML_ERROR_ON(m_read_static, "static read callback already defined");
     m_read_tagged = rd;
 }
 
@@ -270,10 +328,26 @@ void reg<DATA, N>::on_read(DATA (HOST::*rd)(size_t), HOST* host) {
     on_read(fn);
 }
 
+template <typename DATA, size_t N>
+template <auto FN>
+void reg<DATA, N>::on_read(reg_callback_host<FN>* host) {
+    static_assert(reg_callback_traits<decltype(FN)>::nargs <= 1,
+                  "read callback must take no arguments or a tag");
+    if (host == nullptr)
+        host = dynamic_cast<reg_callback_host<FN>*>(get_host());
+    VCML_ERROR_ON(!host, "static read callback has no host");
+    VCML_ERROR_ON(m_read, "read callback already defined");
+    VCML_ERROR_ON(m_read_tagged, "tagged read callback already defined");
+    VCML_ERROR_ON(m_read_static, "static read callback already defined");
+    m_read_static = &reg<DATA, N>::read_static<FN>;
+    m_read_host = host;
+}
+
 template <typename DATA, size_t N>
 void reg<DATA, N>::on_write(const writefn& wr) {
     VCML_ERROR_ON(m_write, "write callback already defined");
     VCML_ERROR_ON(m_write_tagged, "tagged write callback already defined");
+    VCML_ERROR_ON(m_write_static, "static write callback already defined");
     m_write = wr;
 }
 
@@ -281,6 +355,7 @@ template <typename DATA, size_t N>
 void reg<DATA, N>::on_write(const writefn_tagged& wr) {
     VCML_ERROR_ON(m_write, "write callback already defined");
     VCML_ERROR_ON(m_write_tagged, "tagged write callback already defined");
+    VCML_ERROR_ON(m_write_static, "static write callback already defined");
     m_write_tagged = wr;
 }
 
@@ -305,6 +380,42 @@ void reg<DATA, N>::on_write(void (HOST::*wr)(DATA, size_t), HOST* host) {
     on_write(fn);
 }
 
+template <typename DATA, size_t N>
+template <auto FN>
+void reg<DATA, N>::on_write(reg_callback_host<FN>* host) {
+    static_assert(reg_callback_traits<decltype(FN)>::nargs >= 1 &&
+                      reg_callback_traits<decltype(FN)>::nargs <= 2,
+                  "write callback must take a value and optionally a tag");
+    if (host == nullptr)
+        host = dynamic_cast<reg_callback_host<FN>*>(get_host());
+    VCML_ERROR_ON(!host, "static write callback has no host");
+    VCML_ERROR_ON(m_write, "write callback already defined");
+    VCML_ERROR_ON(m_write_tagged, "tagged write callback already defined");
+    VCML_ERROR_ON(m_write_static, "static write callback already defined");
+    m_write_static = &reg<DATA, N>::write_static<FN>;
+    m_write_host = host;
+}
+
+template <typename DATA, size_t N>
+template <auto FN>
+DATA reg<DATA, N>::read_static(void* host, size_t tag) {
+    auto* obj = static_cast<reg_callback_host<FN>*>(host);
+    if constexpr (reg_callback_traits<decltype(FN)>::nargs == 0)
+        return (obj->*FN)();
+    else
+        return (obj->*FN)(tag);
+}
+
+template <typename DATA, size_t N>
+template <auto FN>
+void reg<DATA, N>::write_static(void* host, DATA val, size_t tag) {
+    auto* obj = static_cast<reg_callback_host<FN>*>(host);
+    if constexpr (reg_callback_traits<decltype(FN)>::nargs == 1)
+        (obj->*FN)(val);
+    else
+        (obj->*FN)(val, tag);
+}
+
 template <typename DATA, size_t N>
 void reg<DATA, N>::on_write_mask(DATA mask) {
     on_write([this, mask](DATA val) -> void {
@@ -334,9 +445,9 @@ const DATA& reg<DATA, N>::bank(int bk, size_t idx) const {
     VCML_ERROR_ON(idx >= N, "index %zu out of bounds", idx);
     if (bk == 0 || !m_banked)
         return property<DATA, N>::get(idx);
-    if (!stl_contains(m_banks, bk))
+    if ((size_t)(bk + 1) >= m_nbanks)
         return property<DATA, N>::get_default();
-    return m_banks.at(bk)[idx];
+    return m_banks[(bk + 1) * N + idx];
 }
 
 template <typename DATA, size_t N>
@@ -344,9 +455,9 @@ DATA& reg<DATA, N>::bank(int bk, size_t idx) {
     VCML_ERROR_ON(idx >= N, "index %zu out of bounds", idx);
     if (bk == 0 || !m_banked)
         return property<DATA, N>::get(idx);
-    if (!stl_contains(m_banks, bk))
+    if ((size_t)(bk + 1) >= m_nbanks)
         init_bank(bk);
-    return m_banks[bk][idx];
+    return m_banks[(bk + 1) * N + idx];
 }
 
 template <typename DATA, size_t N>
@@ -371,10 +482,15 @@ reg<DATA, N>::reg(address_space a, const string& nm, u64 addr, DATA d):
     m_banked(false),
     m_init(),
     m_banks(),
+    m_nbanks(0),
     m_read(),
     m_write(),
     m_read_tagged(),
-    m_write_tagged() {
+    m_write_tagged(),
+    m_read_static(nullptr),
+    m_write_static(nullptr),
+    m_read_host(nullptr),
+    m_write_host(nullptr) {
     for (size_t i = 0; i < N; i++)
         m_init[i] = property<DATA, N>::get(i);
 }
@@ -387,19 +503,15 @@ reg<DATA, N>::reg(const tlm_target_socket& socket, const string& name,
 
 template <typename DATA, size_t N>
 reg<DATA, N>::~reg() {
-    for (auto bank : m_banks)
-        delete[] bank.second;
+    // nothing to do
 }
 
 template <typename DATA, size_t N>
 void reg<DATA, N>::reset() {
-    for (size_t i = 0; i < N; i++)
-        property<DATA, N>::set(m_init[i], i);
+    property<DATA, N>::set(m_init);
 
-    for (auto bank : m_banks) {
-        for (unsigned int i = 0; i < N; i++)
-            m_banks[bank.first][i] = m_init[i];
-    }
+    for (size_t bk = 0; bk < m_nbanks; bk++)
+        memcpy(m_banks.data() + bk * N, m_init, sizeof(m_init));
 }
 
 template <typename DATA, size_t N>
@@ -414,7 +526,9 @@ void reg<DATA, N>::do_read(const range& txaddr, void* ptr) {
 
         DATA val;
 
-        if (m_read_tagged)
+        if (m_read_static)
+            val = m_read_static(m_read_host, N > 1 ? idx : tag);
+        else if (m_read_tagged)
             val = m_read_tagged(N > 1 ? idx : tag);
         else if (m_read)
             val = m_read();
@@ -447,7 +561,9 @@ void reg<DATA, N>::do_write(const range& txaddr, const void* data) {
         unsigned char* ptr = (unsigned char*)&val + off;
         memcpy(ptr, src, size);
 
-        if (m_write_tagged)
+        if (m_write_static)
+            m_write_static(m_write_host, val, N > 1 ? idx : tag);
+        else if (m_write_tagged)
             m_write_tagged(val, N > 1 ? idx : tag);
         else if (m_write)
             m_write(val);
@@ -670,12 +786,15 @@ template <typename DATA, size_t N>
 void reg<DATA, N>::init_bank(int bank) {
     VCML_ERROR_ON(!m_banked, "cannot create banks in register %s", name());
 
-    if (bank == 0 || stl_contains(m_banks, bank))
+    VCML_ERROR_ON(bank < -1, "invalid bank %d in register %s", bank, name());
+    if (bank == 0 || (size_t)(bank + 1) < m_nbanks)
         return;
 
-    m_banks[bank] = new DATA[N];
-    for (size_t i = 0; i < N; i++)
-        m_banks[bank][i] = m_init[i];
+    size_t nbanks = max<size_t>(bank + 2, MIN_BANKS);
+    m_banks.resize(nbanks * N);
+    for (size_t bk = m_nbanks; bk < nbanks; bk++)
+        memcpy(m_banks.data() + bk * N, m_init, sizeof(m_init));
+    m_nbanks = nbanks;
 }
 
 } // namespace vcml
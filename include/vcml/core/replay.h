@@ -0,0 +1,67 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_REPLAY_H
+#define VCML_REPLAY_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+
+// models that take input from the host, such as network frames or serial
+// input, feed it through a named channel. While recording, each input is
+// logged together with the simulation time at which it entered the model.
+// While replaying, channels ignore the host and hand out the recorded
+// inputs at the very same simulation times instead
+class replay_channel
+{
+public:
+    typedef function<void(const u8*, size_t)> handler;
+
+private:
+    string m_name;
+    u32 m_id;
+    bool m_replaying;
+    handler m_deliver;
+
+    void deliver_inputs();
+
+public:
+    const char* name() const { return m_name.c_str(); }
+
+    bool is_recording() const { return m_id != ~0u; }
+    bool is_replaying() const { return m_replaying; }
+
+    replay_channel(const string& name);
+    virtual ~replay_channel() = default;
+
+    replay_channel() = delete;
+    replay_channel(const replay_channel&) = delete;
+
+    // logs one input at the current simulation time, no-op unless recording
+    void record(const void* data, size_t size);
+
+    // spawns a thread that passes each recorded input to deliver at the time
+    // it was recorded at, no-op unless replaying
+    void replay(const handler& deliver);
+};
+
+// selects the mode for all channels created afterwards
+void replay_record(const string& path);
+void replay_open(const string& path);
+void replay_close();
+
+bool replay_recording();
+bool replay_replaying();
+
+} // namespace vcml
+
+#endif
@@ -0,0 +1,43 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_ROI_H
+#define VCML_ROI_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+
+// region of interest as marked by the guest, e.g. via meta::simdev, so that
+// only a benchmark kernel gets measured and not the boot leading up to it.
+// Beginning it resets the statistics of all processors and sockets and the
+// profiles of all processors, ending it pauses the profilers. With tracing
+// set, tracers are only active while inside the region of interest
+bool roi_active();
+void roi_begin(bool tracing = false);
+void roi_end(bool tracing = false);
+
+// applies to all processors and tlm sockets below root, or in the whole
+// hierarchy if root is null
+void platform_reset_stats(sc_object* root = nullptr);
+void platform_print_stats(ostream& os, const sc_object* root = nullptr);
+
+// appends the statistics of the whole platform below a header line holding
+// title to the file at path, or logs them if path is empty
+void platform_dump_stats(const string& path, const string& title);
+
+// saves a checkpoint of the platform once all processes have yielded,
+// returns false if there is no system to take the checkpoint of
+bool platform_checkpoint(const string& path);
+
+} // namespace vcml
+
+#endif
@@ -13,9 +13,15 @@
 
 #include "vcml/core/types.h"
 #include "vcml/core/thctl.h"
+#include "vcml/core/startup.h"
+
+#include "vcml/logging/async_publisher.h"
 
 #include "vcml/tracing/tracer.h"
 #include "vcml/tracing/tracer_file.h"
+#include "vcml/tracing/tracer_bin.h"
+#include "vcml/tracing/tracer_chrome.h"
+#include "vcml/tracing/tracer_vcd.h"
 #include "vcml/tracing/tracer_term.h"
 
 #include "vcml/properties/property.h"
@@ -33,9 +39,16 @@ private:
     mwr::option<bool> m_log_debug;
     mwr::option<bool> m_log_stdout;
     mwr::option<string> m_log_files;
+    mwr::option<bool> m_log_async;
+    mwr::option<bool> m_profile_startup;
 
     mwr::option<bool> m_trace_stdout;
+    mwr::option<bool> m_trace_buffered;
     mwr::option<string> m_trace_files;
+    mwr::option<string> m_trace_bin_files;
+    mwr::option<string> m_trace_chrome_files;
+    mwr::option<string> m_trace_vcd_files;
+    mwr::option<bool> m_trace_vcd_tlm;
 
     mwr::option<string> m_config_files;
     mwr::option<string> m_config_options;
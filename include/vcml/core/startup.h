@@ -0,0 +1,83 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_CORE_STARTUP_H
+#define VCML_CORE_STARTUP_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// collects host wall clock time spent on individual startup steps, such as
+// model construction, phase callbacks and image loading; when enabled, a
+// report sorted by time is logged at start of simulation
+class startup_profiler
+{
+public:
+    struct entry {
+        string phase;
+        string name;
+        size_t count;
+        double seconds;
+    };
+
+    class scope
+    {
+    private:
+        const char* m_phase;
+        string m_name;
+        double m_start;
+
+    public:
+        scope(const char* phase, const char* name);
+        scope(const char* phase, const string& name);
+        ~scope();
+    };
+
+    static bool enabled() { return s_enabled; }
+    static void enable(bool on = true);
+
+    static void record(const char* phase, const string& name, double secs);
+
+    static vector<entry> entries();
+    static double elapsed();
+    static void reset();
+
+    static void report(ostream& os, size_t limit = 0);
+    static void log_report();
+
+private:
+    static bool s_enabled;
+};
+
+inline startup_profiler::scope::scope(const char* phase, const char* nm):
+    m_phase(phase), m_name(), m_start(0.0) {
+    if (startup_profiler::enabled()) {
+        m_name = nm;
+        m_start = mwr::timestamp();
+    }
+}
+
+inline startup_profiler::scope::scope(const char* phase, const string& nm):
+    m_phase(phase), m_name(), m_start(0.0) {
+    if (startup_profiler::enabled()) {
+        m_name = nm;
+        m_start = mwr::timestamp();
+    }
+}
+
+inline startup_profiler::scope::~scope() {
+    if (startup_profiler::enabled() && m_start > 0.0)
+        startup_profiler::record(m_phase, m_name, mwr::timestamp() - m_start);
+}
+
+} // namespace vcml
+
+#endif
@@ -13,16 +13,62 @@
 
 #include "vcml/core/types.h"
 #include "vcml/core/module.h"
+#include "vcml/core/fork.h"
 #include "vcml/core/register.h"
 
 #include "vcml/debugging/vspserver.h"
+#include "vcml/debugging/metrics_server.h"
 
 namespace vcml {
 
-class system : public module
+class processor;
+
+class system : public module, private fork_handler
 {
 private:
+    u64 m_quantum_changes;
+
+    string m_last_checkpoint;
+    unordered_map<string, string> m_saved_properties;
+
+    struct monitor_sample {
+        u64 host;
+        sc_time sim;
+        u64 deltas;
+        u64 events;
+        vector<u64> cycles;
+    };
+
+    vector<processor*> m_processors;
+    monitor_sample m_first_sample;
+    monitor_sample m_last_sample;
+    ofstream m_monitor_file;
+    thread m_monitor_thread;
+    mutex m_monitor_mtx;
+    condition_variable m_monitor_cv;
+    bool m_monitor_stop;
+
+    unique_ptr<debugging::metrics_server> m_metrics;
+
+    void take_sample(monitor_sample& sample) const;
+    void report_sample(const monitor_sample& prev,
+                       const monitor_sample& curr, bool summary);
+    void report_progress();
+    void monitor_host();
+    void start_monitor();
+    void stop_monitor();
+
     void timeout();
+    void adapt_quantum();
+    void checkpoint_thread();
+
+    virtual void fork_prepare() override;
+    virtual void fork_child() override;
+
+    bool cmd_checkpoint(const vector<string>& args, ostream& os);
+    bool cmd_reset(const vector<string>& args, ostream& os);
+    bool cmd_tlm_stats(const vector<string>& args, ostream& os);
+    bool cmd_regstats(const vector<string>& args, ostream& os);
 
 public:
     property<string> name;
@@ -37,6 +83,39 @@ public:
     property<sc_time> quantum;
     property<sc_time> duration;
 
+    property<bool> adaptive_quantum;
+    property<sc_time> quantum_min;
+    property<sc_time> quantum_max;
+    property<sc_time> quantum_period;
+
+    property<unsigned int> async_pool;
+
+    property<string> restore;
+    property<string> checkpoint_file;
+    property<sc_time> checkpoint_at;
+    property<sc_time> checkpoint_period;
+    property<unsigned int> checkpoint_full;
+    property<bool> checkpoint_compress;
+
+    // reports simulation speed every monitor_period of host time to the
+    // log or as comma separated values to monitor_file, if specified
+    property<sc_time> monitor_period;
+    property<string> monitor_file;
+
+    // serves metrics in OpenMetrics format via http on this port, 0 = off
+    property<u16> metrics_port;
+
+    // records all host inputs to a file or replays them from there
+    property<string> record;
+    property<string> replay;
+
+    // elaborates, simulates until fork_at and then forks off one child per
+    // client connecting to this port, each child simulating on its own
+    property<u16> fork_server;
+    property<sc_time> fork_at;
+
+    u64 quantum_changes() const { return m_quantum_changes; }
+
     system() = delete;
     system(const system&) = delete;
     explicit system(const sc_module_name& name);
@@ -44,6 +123,19 @@ public:
     VCML_KIND(system);
 
     virtual int run();
+
+    // incremental checkpoints only hold what changed since the last one
+    // saved and fall back to a full checkpoint if there is none yet
+    void save_checkpoint(const string& path, bool compress = false,
+                         bool incremental = false);
+    void load_checkpoint(const string& path);
+
+    // resets all components in place without rebuilding the hierarchy
+    void reset_platform();
+
+protected:
+    virtual void start_of_simulation() override;
+    virtual void end_of_simulation() override;
 };
 
 } // namespace vcml
@@ -308,6 +308,28 @@ bool kernel_has_phase_callbacks();
 
 void on_next_update(function<void(void)> callback);
 
+struct update_queue_stats {
+    size_t depth;     // jobs currently waiting for the next update phase
+    size_t max_depth; // largest number of jobs drained in one batch
+    u64 num_jobs;     // total number of jobs executed
+    u64 num_batches;  // total number of update phases that ran jobs
+};
+
+update_queue_stats get_update_queue_stats();
+
+// activity counters observed by the adaptive quantum controller
+struct quantum_stats {
+    u64 num_syncs;      // quantum synchronizations of processors
+    u64 num_need_syncs; // syncs forced by transactions exceeding the quantum
+    u64 num_irqs;       // interrupts raised at processors
+};
+
+void quantum_count_sync();
+void quantum_count_need_sync();
+void quantum_count_irq();
+
+quantum_stats get_quantum_stats();
+
 void on_end_of_elaboration(function<void(void)> callback);
 void on_start_of_simulation(function<void(void)> callback);
 void on_end_of_simulation(function<void(void)> callback);
@@ -352,7 +374,50 @@ private:
     function<void(async_timer&)> m_cb;
 };
 
-void sc_async(function<void(void)> job);
+// deadline in simulation time for timer models: all deadlines share one
+// min-heap, kernel event and method process, so that idle timers cost
+// nothing and re-arming a timer only touches the kernel once it becomes the
+// earliest one. Callbacks run in method context and must not wait. Unlike
+// async_timer, this must only be used from within the systemc thread
+class deadline_timer
+{
+private:
+    friend class helper_module;
+
+    size_t m_pos;
+    u64 m_seq;
+    sc_time m_timeout;
+    function<void(void)> m_cb;
+
+public:
+    static constexpr size_t NPOS = ~(size_t)0;
+
+    bool is_pending() const { return m_pos != NPOS; }
+    const sc_time& timeout() const { return m_timeout; }
+
+    // time left until expiry, zero if not pending
+    sc_time remaining() const;
+
+    deadline_timer(function<void(void)> cb);
+    ~deadline_timer();
+
+    deadline_timer() = delete;
+    deadline_timer(const deadline_timer&) = delete;
+
+    void reset(const sc_time& delta);
+    void reset_at(const sc_time& timeout);
+    void cancel();
+};
+
+// absolute time of the earliest pending deadline_timer, SC_MAX_TIME if none
+sc_time next_deadline();
+
+// ordered jobs have their sc_sync requests served in deterministic order
+void sc_async(function<void(void)> job, bool ordered = false);
+
+// runs sc_async jobs on a shared pool of threads instead of one dedicated
+// thread per process, must be called before the first sc_async call
+void sc_async_pool(size_t nthreads);
 void sc_progress(const sc_time& delta);
 void sc_sync(function<void(void)> job);
 
@@ -361,6 +426,9 @@ bool sc_is_async();
 sc_time async_time_stamp();
 sc_time async_time_offset();
 
+// blocks the async thread until its offset to systemc time is below limit
+void async_wait_offset(const sc_time& limit);
+
 bool is_thread(sc_process_b* proc = nullptr);
 bool is_method(sc_process_b* proc = nullptr);
 
@@ -29,6 +29,15 @@ void thctl_flush();
 
 void thctl_set_sysc_thread(thread::id id = std::this_thread::get_id());
 
+struct thctl_stats {
+    u64 num_entries;  // number of critical sections entered
+    u64 num_parked;   // number of entries that had to block on the kernel
+    double wait_time; // total seconds spent waiting for the kernel
+};
+
+// statistics of the calling thread
+const thctl_stats& thctl_get_stats();
+
 class thctl_guard
 {
 private:
@@ -50,6 +59,23 @@ inline thctl_guard::~thctl_guard() {
         thctl_exit_critical();
 }
 
+// collects jobs and runs them all within a single critical section
+class thctl_batch
+{
+private:
+    vector<function<void(void)>> m_jobs;
+
+public:
+    bool empty() const { return m_jobs.empty(); }
+    size_t size() const { return m_jobs.size(); }
+
+    thctl_batch() = default;
+    ~thctl_batch() { commit(); }
+
+    void add(function<void(void)> job);
+    void commit();
+};
+
 } // namespace vcml
 
 #endif
@@ -31,6 +31,7 @@ enum gdb_status {
 };
 
 enum gdb_signal {
+    GDBSIG_NONE = 0,
     GDBSIG_TRAP = 5,
     GDBSIG_KILL = 9,
 };
@@ -46,9 +47,30 @@ private:
         vector<const cpureg*> cpuregs;
         target& tgt;
 
+        // register snapshot of the current stop in host byte order, writes
+        // from gdb stay here until the target resumes or memory is accessed
+        unordered_map<size_t, vector<u8>> regvals;
+        vector<const cpureg*> regdirty;
+        string regcache;
+
+        // non-stop mode only: set while this target is halted for gdb,
+        // along with the stop reply reported for it
+        bool stopped;
+        string stop_reply;
+
         gdb_target(u64 t, u64 p, const gdbarch* a, vector<const cpureg*>& c,
                    target& tg):
-            tid(t), pid(p), arch(a), xml(), cpuregs(c), tgt(tg) {}
+            tid(t),
+            pid(p),
+            arch(a),
+            xml(),
+            cpuregs(c),
+            tgt(tg),
+            regvals(),
+            regdirty(),
+            regcache(),
+            stopped(false),
+            stop_reply() {}
     };
 
     vector<gdb_target> m_targets;
@@ -63,6 +85,12 @@ private:
     const range* m_hit_wp_addr;
     vcml_access m_hit_wp_type;
 
+    // in non-stop mode only the targets that hit a breakpoint halt while
+    // the simulation continues; their stop replies are queued and handed
+    // out to gdb one by one via a stop notification and vStopped packets
+    atomic<bool> m_nonstop;
+    deque<string> m_stop_replies;
+
     vector<const cpureg*> m_cpuregs;
 
     mutable mutex m_mtx;
@@ -78,8 +106,24 @@ private:
     gdb_target* find_target(target& tgt);
 
     string create_stop_reply();
+    string create_stop_reply(const gdb_target& gtgt, int signal,
+                             const range* wp_addr = nullptr,
+                             vcml_access wp_type = VCML_ACCESS_NONE);
+
+    void stop_target(gdb_target& gtgt, int signal,
+                     const range* wp_addr = nullptr,
+                     vcml_access wp_type = VCML_ACCESS_NONE);
+    void resume_target(gdb_target& gtgt, bool step);
+
+    void set_nonstop(bool nonstop);
 
     void cancel_singlestep();
+    void invalidate_regcache();
+    void flush_regcache();
+    void flush_regcache(gdb_target& gtgt);
+
+    const vector<u8>* read_cached(gdb_target& gtgt, const cpureg& reg);
+    void write_cached(gdb_target& gtgt, const cpureg& reg, vector<u8>& val);
 
     void update_status(gdb_status status, gdb_target* gtgt = nullptr,
                        const range* wp_addr = nullptr,
@@ -123,6 +167,7 @@ private:
     string handle_reg_read_all(const string& command);
     string handle_reg_write_all(const string& command);
     string handle_mem_read(const string& command);
+    string handle_mem_read_bin(const string& command);
     string handle_mem_write(const string& command);
     string handle_mem_write_bin(const string& command);
 
@@ -133,10 +178,13 @@ private:
     string handle_thread(const string& command);
     string handle_thread_alive(const string& command);
     string handle_vcont(const string& command);
+    string handle_vcont_nonstop(const string& command);
+    string handle_vstopped(const string& command);
+    string handle_nonstop(const string& command);
 
 public:
     enum : size_t {
-        PACKET_SIZE = 8 * MiB,
+        PACKET_SIZE = 64 * MiB,
         BUFFER_SIZE = PACKET_SIZE / 2,
     };
 
@@ -144,6 +192,7 @@ public:
     bool is_stepping() const { return m_status == GDB_STEPPING; }
     bool is_running() const { return m_status == GDB_RUNNING; }
     bool is_killed() const { return m_status == GDB_KILLED; }
+    bool is_nonstop() const { return m_nonstop; }
 
     gdbserver() = delete;
     gdbserver(const gdbserver&) = delete;
@@ -153,6 +202,7 @@ public:
         gdbserver(port, { &stub }, status) {}
     virtual ~gdbserver();
 
+    virtual string handle_command(const string& command) override;
     virtual void handle_connect(const char* peer) override;
     virtual void handle_disconnect() override;
 
@@ -36,11 +36,14 @@ struct image_info {
 
 vector<image_info> images_from_string(const string& s);
 
+bool is_compressed_image(const string& filename);
+
 class loader
 {
 private:
     module& m_owner;
     logger& m_log;
+    u64 m_image_bytes;
 
     bool cmd_load(const vector<string>& args, ostream& os);
     bool cmd_load_bin(const vector<string>& args, ostream& os);
@@ -50,6 +53,22 @@ private:
 
     static unordered_map<string, loader*> s_loaders;
 
+    // granularity at which DMI is retried for images that could not be
+    // allocated as a whole, e.g. because they span multiple DMI regions
+    static constexpr u64 IMAGE_PAGE_SIZE = 4 * KiB;
+
+    // size of the chunks in which compressed images are decoded
+    static constexpr u64 IMAGE_CHUNK_SIZE = 1 * MiB;
+
+    void copy_chunk(const u8* img, u64 size, u64 offset);
+    void copy_pages(const u8* img, u64 size, u64 offset);
+    void copy_pages(const u8* img, const mwr::elf::segment& seg, u64 offset);
+
+    void load_stream(const string& filename, u64 offset);
+    void load_streams(const vector<image_info>& images);
+
+    void report_image(const image_info& image, u64 bytes, u64 micros);
+
 protected:
     virtual void load_bin(const string& filename, u64 offset);
     virtual void load_elf(const string& filename, u64 offset);
@@ -76,8 +95,10 @@ public:
     void load_image(const string& filename, u64 offset, image_type type);
     void load_image(const image_info& image);
 
-    void load_images(const vector<string>& images);
-    void load_images(const vector<image_info>& images);
+    // with parallel set, binary images are streamed concurrently and the
+    // order in which overlapping binary images are written is undefined
+    void load_images(const vector<string>& images, bool parallel = false);
+    void load_images(const vector<image_info>& images, bool parallel = false);
 
     static loader* find(const string& name);
     static vector<loader*> all();
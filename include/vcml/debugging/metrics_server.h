@@ -0,0 +1,66 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_METRICS_SERVER_H
+#define VCML_METRICS_SERVER_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+#include "vcml/logging/logger.h"
+
+namespace vcml {
+namespace debugging {
+
+// serves simulation metrics in OpenMetrics text format via http from its
+// own thread. Scrapes never touch model state: each one asks the systemc
+// side to render a fresh snapshot at its next update phase and answers with
+// the newest snapshot available after a short grace period, so scraping a
+// stopped or slow simulation returns slightly stale values instead of
+// blocking either side
+class metrics_server
+{
+private:
+    struct snapshot_state;
+
+    mwr::socket m_sock;
+    u16 m_port;
+
+    atomic<bool> m_running;
+    thread m_thread;
+
+    shared_ptr<snapshot_state> m_state;
+
+    void request_snapshot();
+    void handle_request();
+    void run();
+
+public:
+    logger log;
+
+    u16 port() const { return m_port; }
+    bool is_running() const { return m_running; }
+
+    metrics_server(u16 port);
+    virtual ~metrics_server();
+
+    metrics_server() = delete;
+    metrics_server(const metrics_server&) = delete;
+
+    void start();
+    void shutdown();
+
+    // newest snapshot rendered so far, empty before the first scrape
+    string snapshot() const;
+};
+
+} // namespace debugging
+} // namespace vcml
+
+#endif
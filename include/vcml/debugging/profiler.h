@@ -0,0 +1,71 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_DEBUGGING_PROFILER_H
+#define VCML_DEBUGGING_PROFILER_H
+
+#include "vcml/core/types.h"
+#include "vcml/debugging/symtab.h"
+#include "vcml/debugging/target.h"
+
+namespace vcml {
+namespace debugging {
+
+struct profile_entry {
+    string function;
+    u64 self;
+    u64 total;
+};
+
+// statistical profiler that attributes samples of the program counter and
+// call stack of a target to functions found in its symbol table
+class profiler
+{
+private:
+    target& m_target;
+    size_t m_depth;
+    u64 m_samples;
+    bool m_paused;
+
+    unordered_map<string, profile_entry> m_flat;
+    unordered_map<string, u64> m_folded;
+    vector<stackframe> m_trace;
+
+    const char* frame_name(const stackframe& frame) const;
+
+public:
+    target& get_target() const { return m_target; }
+    size_t depth() const { return m_depth; }
+    u64 samples() const { return m_samples; }
+
+    // samples are dropped while paused, e.g. outside a region of interest
+    bool is_paused() const { return m_paused; }
+    void pause() { m_paused = true; }
+    void resume() { m_paused = false; }
+
+    profiler(target& t, size_t depth = 64);
+    virtual ~profiler() = default;
+
+    void reset();
+
+    // records one sample counting weight times, e.g. when several sample
+    // intervals have passed since the previous sample was taken
+    void sample(u64 weight = 1);
+
+    vector<profile_entry> flat_profile() const;
+
+    void write_flat(ostream& os) const;
+    void write_folded(ostream& os) const;
+};
+
+} // namespace debugging
+} // namespace vcml
+
+#endif
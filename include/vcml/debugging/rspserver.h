@@ -12,12 +12,13 @@
 #define VCML_RSPSERVER_H
 
 #include "vcml/core/types.h"
+#include "vcml/core/fork.h"
 #include "vcml/logging/logger.h"
 
 namespace vcml {
 namespace debugging {
 
-class rspserver
+class rspserver : private fork_handler
 {
 public:
     typedef function<string(const string&)> handler;
@@ -29,13 +30,19 @@ private:
     string m_name;
 
     atomic<bool> m_echo;
+    atomic<bool> m_noack;
     atomic<bool> m_running;
+    bool m_resume;
 
     mutex m_mutex;
+    mutex m_tx_mutex;
     thread m_thread;
 
     std::map<string, handler> m_handlers;
 
+    virtual void fork_prepare() override;
+    virtual void fork_child() override;
+
     // disabled
     rspserver();
     rspserver(const rspserver&);
@@ -51,12 +58,19 @@ public:
 
     void echo(bool e = true) { m_echo = e; }
 
+    bool is_noack() const { return m_noack; }
+
     rspserver(u16 port);
     virtual ~rspserver();
 
     void send_packet(const string& s);
     void send_packet(const char* format, ...);
     string recv_packet();
+
+    // notifications are not acknowledged and may be sent from any thread,
+    // even while the server thread is waiting for the next packet
+    void send_notification(const string& s);
+
     int recv_signal(time_t timeoutms = ~0ull);
 
     void listen();
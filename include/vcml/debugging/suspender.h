@@ -25,6 +25,13 @@ private:
     string m_name;
     sc_object* m_owner;
 
+    // set while any suspender has requested the simulation to pause, this
+    // allows handle_requests to return after a single load in the common
+    // case where nobody is suspending
+    static atomic<bool> requests_pending;
+
+    static void handle_pending();
+
 public:
     const char* name() const { return m_name.c_str(); }
     sc_object* owner() const { return m_owner; }
@@ -46,6 +53,11 @@ public:
     static void handle_requests();
 };
 
+inline void suspender::handle_requests() {
+    if (requests_pending.load(std::memory_order_relaxed))
+        handle_pending();
+}
+
 } // namespace debugging
 } // namespace vcml
 
@@ -70,25 +70,32 @@ public:
         }
     };
 
-    typedef std::set<symbol, symbol_compare> symset;
+    // symbols sorted by address, at most one symbol per address
+    typedef vector<symbol> symset;
 
-    size_t count_functions() const { return m_functions.size(); }
-    size_t count_objects() const { return m_objects.size(); }
+    size_t count_functions() const { return m_functions->size(); }
+    size_t count_objects() const { return m_objects->size(); }
 
     size_t count() const { return count_functions() + count_objects(); }
     bool empty() const { return count() == 0; }
 
-    const symset& functions() const { return m_functions; }
-    const symset& objects() const { return m_objects; }
+    const symset& functions() const { return *m_functions; }
+    const symset& objects() const { return *m_objects; }
 
-    symtab() = default;
+    symtab();
+    symtab(const symtab& other);
     ~symtab() = default;
 
+    symtab& operator=(const symtab& other);
+
     void insert(const symbol& sym);
     void remove(const symbol& sym);
 
     void clear();
 
+    // replaces all symbols, faster than inserting them one by one
+    void assign(symset&& functions, symset&& objects);
+
     const symbol* find_symbol(const string& name) const;
     const symbol* find_symbol(u64 addr) const;
 
@@ -100,20 +107,33 @@ public:
 
     void merge(const symtab&);
 
+    // symbols of files loaded before are shared instead of parsed again
     u64 load_elf(const string& filename);
 
-private:
-    std::set<symbol, symbol_compare> m_functions;
-    std::set<symbol, symbol_compare> m_objects;
-
-    unordered_map<string, const symbol*> m_function_names;
-    unordered_map<string, const symbol*> m_object_names;
-
-    void insert_function(const symbol& sym);
-    void insert_object(const symbol& sym);
+    // starts parsing a file on a host thread, so that a later load_elf
+    // only has to wait for it; distinct files are parsed in parallel
+    static void prefetch_elf(const string& filename);
 
-    void remove_function(const symbol& sym);
-    void remove_object(const symbol& sym);
+private:
+    // copies share their symbols until either side gets modified, so all
+    // targets that loaded the same file refer to a single set of symbols
+    shared_ptr<symset> m_functions;
+    shared_ptr<symset> m_objects;
+
+    // name lookups are indexed lazily upon the first query by name
+    mutable mutex m_mtx;
+    mutable atomic<bool> m_indexed;
+    mutable unordered_map<string, const symbol*> m_function_names;
+    mutable unordered_map<string, const symbol*> m_object_names;
+
+    void update_index() const;
+    void invalidate_index();
+
+    static symset& unshare(shared_ptr<symset>& syms);
+    static void insert_sorted(symset& syms, const symbol& sym);
+    static void remove_sorted(symset& syms, const symbol& sym);
+    static void sort_unique(symset& syms);
+    static const symbol* find_sorted(const symset& syms, u64 addr);
 };
 
 } // namespace debugging
@@ -71,6 +71,13 @@ struct stackframe {
 
 class target
 {
+public:
+    // granularity at which watched memory is tracked
+    enum : u64 {
+        WATCH_PAGE_BITS = 12,
+        WATCH_PAGE_SIZE = 1ull << WATCH_PAGE_BITS,
+    };
+
 private:
     mutable mutex m_mtx;
 
@@ -89,6 +96,11 @@ private:
     vector<breakpoint*> m_breakpoints;
     vector<watchpoint*> m_watchpoints;
 
+    unordered_map<u64, breakpoint*> m_breakpoint_index;
+    unordered_map<u64, size_t> m_watched_pages;
+
+    void index_watchpoint(const range& addr, bool insert);
+
     static unordered_map<string, target*> s_targets;
 
 protected:
@@ -165,6 +177,10 @@ public:
     const vector<breakpoint*>& breakpoints() const;
     const vector<watchpoint*>& watchpoints() const;
 
+    bool is_breakpoint(u64 addr) const;
+    bool is_watched(u64 addr) const;
+    bool is_watched(const range& mem) const;
+
     const breakpoint* lookup_breakpoint(u64 addr);
     const breakpoint* insert_breakpoint(u64 addr, subscriber* subscr);
     bool remove_breakpoint(const breakpoint* bp, subscriber* subscr);
@@ -218,6 +234,16 @@ inline const vector<watchpoint*>& target::watchpoints() const {
     return m_watchpoints;
 }
 
+inline bool target::is_breakpoint(u64 addr) const {
+    return !m_breakpoint_index.empty() &&
+           stl_contains(m_breakpoint_index, addr);
+}
+
+inline bool target::is_watched(u64 addr) const {
+    return !m_watched_pages.empty() &&
+           stl_contains(m_watched_pages, addr >> WATCH_PAGE_BITS);
+}
+
 inline bool target::is_stepping() const {
     lock_guard<mutex> guard(m_mtx);
     return !m_steppers.empty();
@@ -24,12 +24,37 @@ namespace debugging {
 class vspserver : public rspserver, private suspender, private subscriber
 {
 private:
+    struct index_entry {
+        sc_object* obj;
+        string tag;  // opening object tag, without its closing bracket
+        string body; // attributes and commands
+        vector<size_t> children;
+    };
+
     string m_announce;
     string m_stop_reason;
     sc_time m_duration;
 
     unordered_map<u64, const breakpoint*> m_breakpoints;
 
+    // resolved attributes and last values reported for subscriptions
+    unordered_map<string, sc_attr_base*> m_attributes;
+    std::map<string, string> m_subscriptions;
+
+    // hierarchy listed by the list command, built once and reused
+    vector<index_entry> m_index;
+    vector<size_t> m_index_roots;
+    unordered_map<string, size_t> m_index_names;
+    bool m_index_check;
+
+    sc_attr_base* lookup_attribute(const string& name);
+
+    size_t index_object(sc_object* obj);
+    void build_index();
+    bool index_matches(const vector<sc_object*>& objs, size_t& pos) const;
+    void update_index();
+    void list_index(ostream& os, size_t idx, size_t depth) const;
+
     string handle_version(const string& command);
     string handle_status(const string& command);
     string handle_resume(const string& command);
@@ -42,6 +67,11 @@ private:
     string handle_setq(const string& command);
     string handle_geta(const string& command);
     string handle_seta(const string& command);
+    string handle_getm(const string& command);
+    string handle_setm(const string& command);
+    string handle_subs(const string& command);
+    string handle_unsub(const string& command);
+    string handle_poll(const string& command);
     string handle_mkbp(const string& command);
     string handle_rmbp(const string& command);
 
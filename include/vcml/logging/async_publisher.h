@@ -0,0 +1,81 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_LOGGING_ASYNC_PUBLISHER_H
+#define VCML_LOGGING_ASYNC_PUBLISHER_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// publishes log messages without blocking the logging thread: messages are
+// copied into a lock-free ring owned by the calling thread and a dedicated
+// thread formats and writes them; consecutive identical messages are only
+// written once, followed by a line stating how often they were repeated
+class async_publisher : public mwr::publisher
+{
+private:
+    struct entry {
+        mwr::logmsg msg;
+        u64 time_ns;
+    };
+
+    struct ring {
+        vector<entry> entries;
+        atomic<size_t> head;
+        atomic<size_t> tail;
+        atomic<size_t> dropped;
+        ring(size_t capacity);
+    };
+
+    const u64 m_id;
+    const size_t m_capacity;
+
+    ofstream m_file;
+    ostream& m_os;
+
+    mutex m_rings_mtx;
+    vector<unique_ptr<ring>> m_rings;
+
+    atomic<bool> m_running;
+    thread m_writer;
+
+    entry m_last;
+    size_t m_repeats;
+
+    ring* local_ring();
+
+    bool same_message(const entry& a, const entry& b) const;
+    void write_repeats();
+    void write_entry(const entry& e);
+    void write_dropped(size_t count);
+    bool drain();
+    void write_thread();
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    size_t capacity() const { return m_capacity; }
+
+    async_publisher(const string& filename,
+                    size_t capacity = DEFAULT_CAPACITY);
+    async_publisher(ostream& os = std::cerr,
+                    size_t capacity = DEFAULT_CAPACITY);
+    virtual ~async_publisher();
+
+    async_publisher(const async_publisher&) = delete;
+    async_publisher& operator=(const async_publisher&) = delete;
+
+    virtual void publish(const mwr::logmsg& msg) override;
+};
+
+} // namespace vcml
+
+#endif
@@ -0,0 +1,60 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_LOGGING_LOG_THROTTLE_H
+#define VCML_LOGGING_LOG_THROTTLE_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// counts recurring events, such as bus errors, per source and address and
+// decides which of them are worth reporting: the first occurrence always is,
+// repeats only at exponentially growing intervals (2nd, 4th, 8th, ...) and
+// nothing after limit reports have been made for the same source and address
+class log_throttle
+{
+public:
+    struct entry {
+        u64 source;
+        u64 addr;
+        u64 count;
+        u64 reported;
+    };
+
+private:
+    std::map<pair<u64, u64>, entry> m_entries;
+    size_t m_capacity;
+    u64 m_total;
+    u64 m_untracked;
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    u64 total() const { return m_total; }
+    u64 untracked() const { return m_untracked; }
+    size_t size() const { return m_entries.size(); }
+
+    log_throttle(size_t capacity = DEFAULT_CAPACITY);
+
+    // returns true if this occurrence should be reported, a limit of zero
+    // reports every occurrence
+    bool record(u64 source, u64 addr, u64 limit);
+
+    u64 count(u64 source, u64 addr) const;
+    void reset();
+
+    void summary(ostream& os,
+                 const function<string(u64)>& source_name) const;
+};
+
+} // namespace vcml
+
+#endif
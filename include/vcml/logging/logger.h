@@ -14,15 +14,55 @@
 #include "vcml/core/types.h"
 #include "vcml/core/systemc.h"
 
+// least severe log level whose messages are compiled in, see VCML_LOG_LEVEL
+// in CMakeLists.txt; calls to less severe levels do not evaluate arguments
+#ifndef VCML_LOG_LEVEL
+#define VCML_LOG_LEVEL 3
+#endif
+
+// expands to log.discard(...) just like the regular macros expand to calls
+// on log, so that prefixes such as vcml:: or comp. keep working
+#define VCML_LOG_DISCARD(...) \
+    log.discard(sizeof(::vcml::log_discard(__VA_ARGS__)))
+
+#if VCML_LOG_LEVEL < 3
+#undef log_debug
+#define log_debug(...) VCML_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if VCML_LOG_LEVEL < 2
+#undef log_info
+#define log_info(...) VCML_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if VCML_LOG_LEVEL < 1
+#undef log_warn
+#define log_warn(...) VCML_LOG_DISCARD(__VA_ARGS__)
+#endif
+
 namespace vcml {
 
+static_assert(LOG_ERROR == 0 && LOG_WARN == 1 && LOG_INFO == 2 &&
+                  LOG_DEBUG == 3,
+              "VCML_LOG_LEVEL does not match log_level");
+
+// never defined, only used in unevaluated context to type check arguments
+template <typename... ARGS>
+int log_discard(ARGS&&... args);
+
 class logger : public mwr::logger
 {
 private:
     class module* m_parent;
 
+    // points to the loglvl property of our parent, to avoid going through
+    // the property interface on every call
+    const log_level* m_level;
+
 public:
     virtual bool can_log(log_level lvl) const;
+    static constexpr bool compiled_in(log_level lvl);
+    void discard(size_t) const {}
 
     logger();
     logger(sc_object* parent);
@@ -32,6 +72,10 @@ public:
     logger(const logger&) = default;
 };
 
+constexpr bool logger::compiled_in(log_level lvl) {
+    return (int)lvl <= VCML_LOG_LEVEL;
+}
+
 extern logger log;
 
 } // namespace vcml
@@ -422,6 +422,7 @@ public:
     u8 get_irq_priority(size_t cpu, size_t irq);
 
     void update(bool virt = false);
+    void update_cpu(size_t cpu, bool virt = false);
 
     virtual void end_of_elaboration() override;
     virtual void gpio_notify(const gpio_target_socket& socket) override;
@@ -429,12 +430,21 @@ public:
     void handle_ppi(size_t cpu, size_t idx, bool state);
     void handle_spi(size_t idx, bool state);
 
+    // message signaled interrupts, e.g. from gicv2m: equivalent to pulsing
+    // spi_in[idx], but only re-evaluates the cpus targeted by the spi
+    void signal_spi(size_t idx);
+
 private:
     size_t m_irq_num;
     cpu_mask_t m_cpu_num;
 
     irq_state m_irq_state[NIRQ + NRES];
 
+    // per cpu and group: irqs that are enabled, pending and not active
+    u64 m_pending_map[NCPU][2][NREGS / 64];
+
+    void refresh_irq(size_t irq);
+
     pair<size_t, u32> get_highest_pend_irq(size_t cpu, bool virt);
     u8 get_prio_mask(u32 n, bool alias, bool virt);
     pair<bool, bool> update_excp_state(size_t cpu, size_t& irq, bool virt);
@@ -448,12 +458,14 @@ inline void gic400::enable_irq(size_t irq, cpu_mask_t mask) {
     if (m_irq_state[irq].enabled == 0 && mask)
         log_debug("enabled irq %zu", irq);
     m_irq_state[irq].enabled |= mask;
+    refresh_irq(irq);
 }
 
 inline void gic400::disable_irq(size_t irq, cpu_mask_t mask) {
     if (m_irq_state[irq].enabled && mask == 0)
         log_debug("disabled irq %zu", irq);
     m_irq_state[irq].enabled &= ~mask;
+    refresh_irq(irq);
 }
 
 inline bool gic400::is_irq_enabled(size_t irq, cpu_mask_t mask) {
@@ -466,6 +478,7 @@ inline void gic400::set_irq_pending(size_t irq, bool pending,
         m_irq_state[irq].pending |= mask;
     else
         m_irq_state[irq].pending &= ~mask;
+    refresh_irq(irq);
 }
 
 inline bool gic400::is_irq_pending(size_t irq, cpu_mask_t mask) {
@@ -477,6 +490,7 @@ inline void gic400::set_irq_active(size_t irq, bool active, cpu_mask_t mask) {
         m_irq_state[irq].active |= mask;
     else
         m_irq_state[irq].active &= ~mask;
+    refresh_irq(irq);
 }
 
 inline bool gic400::is_irq_active(size_t irq, cpu_mask_t mask) {
@@ -488,6 +502,7 @@ inline void gic400::set_irq_level(size_t irq, bool level, cpu_mask_t mask) {
         m_irq_state[irq].level |= mask;
     else
         m_irq_state[irq].level &= ~mask;
+    refresh_irq(irq);
 }
 
 inline bool gic400::get_irq_level(size_t irq, cpu_mask_t mask) {
@@ -515,10 +530,12 @@ inline void gic400::set_irq_group(size_t irq, group_mode g, cpu_mask_t m) {
         m_irq_state[irq].group &= ~m;
     else
         m_irq_state[irq].group |= m;
+    refresh_irq(irq);
 }
 
 inline void gic400::set_irq_trigger(size_t irq, trigger_mode t) {
     m_irq_state[irq].trigger = t;
+    refresh_irq(irq);
 }
 
 inline void gic400::set_irq_signaled(size_t irq, bool signaled, u8 mask) {
@@ -526,6 +543,7 @@ inline void gic400::set_irq_signaled(size_t irq, bool signaled, u8 mask) {
         m_irq_state[irq].signaled |= mask;
     else
         m_irq_state[irq].signaled &= ~mask;
+    refresh_irq(irq);
 }
 
 inline bool gic400::irq_signaled(size_t irq, u8 mask) {
@@ -20,12 +20,16 @@
 #include "vcml/protocols/tlm.h"
 #include "vcml/protocols/gpio.h"
 
+#include "vcml/models/arm/gic400.h"
+
 namespace vcml {
 namespace arm {
 
 class gicv2m : public peripheral
 {
 private:
+    gic400* m_gic;
+
     void write_setspi(u32 val);
 
     u32 read_typer();
@@ -65,6 +69,10 @@ public:
     gicv2m(const sc_module_name& nm);
     virtual ~gicv2m();
     VCML_KIND(arm::gicv2m);
+
+    // delivers msis straight to the spis of the given gic instead of
+    // pulsing the out ports, which then need not be bound
+    void connect(gic400& gic);
 };
 
 } // namespace arm
@@ -30,6 +30,12 @@ private:
     u32 m_current_irq;
     bool m_vect_int;
 
+    // sources routed to at least one enabled vector slot, and the enabled
+    // slots of each source, so the active vector is found without a scan
+    u32 m_vect_srcs;
+    u16 m_src_slots[32];
+
+    void update_vectors();
     void update();
 
     void write_inte(u32 val);
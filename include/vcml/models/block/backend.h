@@ -12,6 +12,9 @@
 #define VCML_BLOCK_BACKEND_H
 
 #include "vcml/core/types.h"
+#include "vcml/core/range.h"
+
+#include <sys/uio.h>
 
 namespace vcml {
 namespace block {
@@ -46,6 +49,29 @@ public:
     virtual void discard(size_t size);
     virtual void flush();
 
+    // positional accesses that leave pos() untouched, backends returning true
+    // from concurrent() allow them to be issued from several threads at once
+    virtual bool concurrent() const { return false; }
+    virtual void read_at(size_t offset, u8* buffer, size_t size);
+    virtual void write_at(size_t offset, const u8* buffer, size_t size);
+
+    // scatter/gather variants of the above
+    virtual void readv_at(size_t offset, const vector<iovec>& iov);
+    virtual void writev_at(size_t offset, const vector<iovec>& iov);
+
+    // file descriptor for native asynchronous i/o, -1 if there is none
+    virtual int fd() const { return -1; }
+
+    // lists the ranges that may differ from the image as it was opened,
+    // backends that cannot tell return false and are left out of
+    // checkpoints, since their writes already went to the image itself
+    virtual bool delta(vector<range>& extents);
+
+    // image is either a plain file path, ramdisk:<size>, pio:<path> for
+    // positional i/o, direct:<path> for positional i/o using O_DIRECT,
+    // mmap:<path> for an image mapped into memory or cow:<base>[,<delta>]
+    // for a copy-on-write overlay of another image with its delta kept in
+    // memory or in an optional file
     static backend* create(const string& image, bool readonly);
 };
 
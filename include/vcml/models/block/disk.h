@@ -21,37 +21,145 @@
 namespace vcml {
 namespace block {
 
+struct io_request;
+struct disk_timing;
+class io_engine;
+class backend_cache;
+
 class disk : public module
 {
+public:
+    enum latency_bucket : size_t {
+        LAT_10US,
+        LAT_100US,
+        LAT_1MS,
+        LAT_10MS,
+        LAT_100MS,
+        LAT_MORE,
+        NUM_LAT_BUCKETS,
+    };
+
+    // statistics get updated from all queues accessing the disk at once,
+    // so counters are relaxed atomics that otherwise read like integers
+    class counter
+    {
+    private:
+        atomic<size_t> m_val;
+
+    public:
+        counter(): m_val(0) {}
+        counter(const counter&) = delete;
+
+        operator size_t() const { return get(); }
+        size_t get() const { return m_val.load(std::memory_order_relaxed); }
+
+        void set(size_t v) { m_val.store(v, std::memory_order_relaxed); }
+        counter& operator=(size_t v) {
+            set(v);
+            return *this;
+        }
+
+        void add(size_t n) { m_val.fetch_add(n, std::memory_order_relaxed); }
+        counter& operator+=(size_t n) {
+            add(n);
+            return *this;
+        }
+
+        size_t operator++(int) {
+            return m_val.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void update_max(size_t v);
+    };
+
+    // host time spent on requests, from submission to completion
+    struct latency_hist {
+        array<counter, NUM_LAT_BUCKETS> buckets;
+        counter count;
+        counter total_ns;
+        counter max_ns;
+
+        void record(u64 ns);
+        u64 avg_ns() const;
+    };
+
 private:
     backend* m_backend;
+    backend_cache* m_cache;
+    io_engine* m_engine;
+
+    const disk_timing* m_timing;
+    sc_time m_busy_until;
+    size_t m_next_offset;
+    std::multimap<sc_time, io_request*> m_timed;
+    sc_event m_timed_ev;
+
+    mutex m_backend_mtx;
+    mutex m_done_mtx;
+    vector<io_request*> m_done;
+    sc_event m_done_ev;
+    size_t m_inflight;
+
+    void submit(io_request* req);
+    void execute(io_request* req);
+    void complete(io_request* req);
+    void finish(io_request* req);
+    void deliver(io_request* req);
+    void completion_thread();
+    void timing_thread();
+    void update_cache_stats();
+
+    sc_time schedule(int op, size_t offset, size_t size);
 
     bool cmd_show_stats(const vector<string>& args, ostream& os);
     bool cmd_save_image(const vector<string>& args, ostream& os);
 
 public:
     struct stats {
-        size_t num_bytes_read;
-        size_t num_bytes_written;
-        size_t num_seek_req;
-        size_t num_read_req;
-        size_t num_write_req;
-        size_t num_flush_req;
-        size_t num_discard_req;
-        size_t num_req;
-        size_t num_seek_err;
-        size_t num_read_err;
-        size_t num_write_err;
-        size_t num_flush_err;
-        size_t num_discard_err;
-        size_t num_err;
+        counter num_bytes_read;
+        counter num_bytes_written;
+        counter num_seek_req;
+        counter num_read_req;
+        counter num_write_req;
+        counter num_flush_req;
+        counter num_discard_req;
+        counter num_req;
+        counter num_seek_err;
+        counter num_read_err;
+        counter num_write_err;
+        counter num_flush_err;
+        counter num_discard_err;
+        counter num_err;
+        counter num_cache_hits;
+        counter num_cache_misses;
+        counter num_cache_readahead;
+        counter num_cache_evictions;
+        latency_hist read_latency;
+        latency_hist write_latency;
+        latency_hist flush_latency;
     } stats;
 
     property<string> image;
     property<string> serial;
     property<bool> readonly;
 
+    property<size_t> io_threads;
+    property<size_t> io_depth;
+
+    // page cache in front of the image, disabled if cache_size is zero
+    property<size_t> cache_size;
+    property<size_t> cache_readahead;
+
+    // simulated device timing, one of none, ssd, emmc or hdd; requests
+    // are served one at a time and asynchronous ones only complete once
+    // the device would have finished them
+    property<string> timing;
+
     bool has_backing() const { return m_backend != nullptr; }
+    bool has_cache() const { return m_cache != nullptr; }
+    bool has_timing() const { return m_timing != nullptr; }
+
+    const sc_time& busy_until() const { return m_busy_until; }
 
     disk(const sc_module_name& name, const string& img = "",
          bool readonly = false);
@@ -65,9 +173,33 @@ public:
     bool seek(size_t pos);
     bool read(u8* buffer, size_t size);
     bool write(const u8* buffer, size_t size);
+
+    // positional accesses that leave pos() untouched and need just one
+    // backend call, they only serialize if the backend is not concurrent
+    bool read_at(size_t offset, u8* buffer, size_t size);
+    bool write_at(size_t offset, const u8* buffer, size_t size);
     bool wzero(size_t size, bool may_unmap = true);
     bool discard(size_t size);
     bool flush();
+
+    virtual void save_state(checkpoint& cp) override;
+    virtual void load_state(checkpoint& cp) override;
+
+    // asynchronous requests leave pos() untouched and may complete in any
+    // order; done is called from a systemc thread once they have finished,
+    // buffers must stay valid until then; without io_threads and timing
+    // they finish before returning
+    size_t in_flight() const { return m_inflight; }
+
+    void read_async(size_t offset, u8* buffer, size_t size,
+                    function<void(bool)> done);
+    void write_async(size_t offset, const u8* buffer, size_t size,
+                     function<void(bool)> done);
+    void readv_async(size_t offset, const vector<iovec>& iov,
+                     function<void(bool)> done);
+    void writev_async(size_t offset, const vector<iovec>& iov,
+                      function<void(bool)> done);
+    void flush_async(function<void(bool)> done);
 };
 
 } // namespace block
@@ -40,7 +40,12 @@ public:
     backend(backend&&) = default;
 
     virtual void send_to_host(const can_frame& frame) = 0;
+    virtual void send_batch_to_host(const vector<can_frame>& frames);
     virtual void send_to_guest(can_frame frame);
+    void send_batch_to_guest(const can_frame* frames, size_t count);
+
+    // frames are passed to the guest no earlier than the given time
+    void send_to_guest(can_frame frame, const sc_time& delivery);
 
     static backend* create(bridge* br, const string& type);
 };
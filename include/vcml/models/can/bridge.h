@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/replay.h"
 
 #include "vcml/properties/property.h"
 #include "vcml/protocols/can.h"
@@ -32,10 +33,37 @@ private:
     unordered_map<size_t, backend*> m_dynamic_backends;
     vector<backend*> m_backends;
 
-    mutable mutex m_mtx;
-    queue<can_frame> m_rx;
+    // frames from the backends travel through lock-free rings owned by the
+    // sending thread, the systemc side is only woken up once per batch
+    struct rx_entry {
+        can_frame frame;
+        sc_time delivery;
+    };
+
+    struct rx_ring {
+        vector<rx_entry> frames;
+        atomic<size_t> head;
+        atomic<size_t> tail;
+        rx_ring(size_t capacity);
+    };
+
+    const u64 m_id;
+    mutex m_rings_mtx;
+    vector<unique_ptr<rx_ring>> m_rings;
+    atomic<bool> m_rx_pending;
+    atomic<size_t> m_rx_dropped;
     sc_event m_ev;
 
+    // frames for the host are collected for one delta cycle and handed to
+    // the backends as a batch
+    vector<can_frame> m_tx;
+    sc_event m_tx_ev;
+
+    replay_channel m_replay;
+
+    rx_ring* local_ring();
+    size_t drain_rings();
+
     bool cmd_create_backend(const vector<string>& args, ostream& os);
     bool cmd_destroy_backend(const vector<string>& args, ostream& os);
     bool cmd_list_backends(const vector<string>& args, ostream& os);
@@ -43,11 +71,13 @@ private:
     virtual void can_receive(can_frame& frame) override;
 
     void can_transmit();
+    void flush_host();
 
     static unordered_map<string, bridge*>& bridges();
 
 public:
     property<string> backends;
+    property<size_t> rx_capacity;
 
     can_initiator_socket can_tx;
     can_target_socket can_rx;
@@ -57,7 +87,12 @@ public:
     VCML_KIND(can::bridge);
 
     void send_to_host(const can_frame& frame);
+    void send_to_host(const vector<can_frame>& frames);
     void send_to_guest(can_frame frame);
+    void send_to_guest(const can_frame* frames, size_t count);
+    void send_to_guest(can_frame frame, const sc_time& delivery);
+
+    size_t num_dropped() const { return m_rx_dropped; }
 
     void attach(backend* b);
     void detach(backend* b);
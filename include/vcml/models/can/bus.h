@@ -21,17 +21,45 @@
 namespace vcml {
 namespace can {
 
+// acceptance filter as used by socketcan: a frame passes if its msgid
+// matches id in all bits set in mask
+struct can_filter {
+    u32 id;
+    u32 mask;
+
+    bool matches(const can_frame& frame) const {
+        return (frame.msgid & mask) == (id & mask);
+    }
+};
+
 class bus : public module, public can_host
 {
 protected:
     size_t m_next_id;
 
+    // flat list of ports built at the end of elaboration, so that frames
+    // are fanned out without any socket lookups; frames are handed to all
+    // ports by reference and only visit ports whose filters accept them
+    struct port {
+        size_t id;
+        can_initiator_socket* tx;
+        vector<can_filter> filters;
+    };
+
+    vector<port> m_ports;
+    unordered_map<size_t, vector<can_filter>> m_filters;
+
     const can_initiator_socket& peer_of(const can_target_socket& rx) const {
         return can_tx[can_rx.index_of(rx)];
     }
 
+    bool accepts(const port& p, const can_frame& frame) const;
+    void build_ports();
+
     void can_receive(const can_target_socket&, can_frame& frame) override;
 
+    virtual void end_of_elaboration() override;
+
 public:
     can_initiator_array can_tx;
     can_target_array can_rx;
@@ -42,6 +70,11 @@ public:
 
     void bind(can_initiator_socket& tx, can_target_socket& rx);
 
+    // ports without filters receive all frames, otherwise only frames
+    // accepted by at least one of their filters
+    void add_filter(size_t port, u32 id, u32 mask);
+    void clear_filters(size_t port);
+
     template <typename DEVICE>
     void connect(DEVICE& device) {
         bind(device.can_tx, device.can_rx);
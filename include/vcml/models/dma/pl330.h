@@ -114,6 +114,13 @@ public:
         u8 tag;
     };
 
+    struct insn_descr;
+
+    struct decoded_insn {
+        const insn_descr* descr;
+        u8 code[6];
+    };
+
     class channel : public module
     {
     public:
@@ -131,6 +138,15 @@ public:
         u32 request_flag;
         u32 watchdog_timer;
 
+        // decoded microcode by cpc, flushed on DMAGO, DMAKILL and whenever
+        // the dma writes to memory holding the cached instructions
+        unordered_map<u32, decoded_insn> icache;
+        void invalidate_icache(u64 start, u64 end);
+
+        // each channel runs in its own thread that sleeps on this event
+        // until it is started or something it may be waiting for changes
+        sc_event wakeup;
+
         bool is_state(u8 state) const { return get_state() == state; }
         u32 get_state() const { return csr & 0x7; }
         void set_state(u32 new_state) { csr = (csr & ~0x7) | new_state; }
@@ -195,7 +211,7 @@ public:
     reg<u32, 4> periph_id; // Peripheral Identification Registers
     reg<u32, 4> pcell_id;  // Component Identification Registers
 
-    u8 periph_busy[6];
+    u8 periph_busy[32];
     gpio_target_array periph_irq;
 
     tlm_target_socket in;
@@ -211,7 +227,9 @@ public:
 private:
     void pl330_thread();
     void run_manager();
-    void run_channels();
+    void run_channel(channel& ch);
+
+    virtual void gpio_notify(const gpio_target_socket& socket) override;
     void handle_debug_instruction();
 
     sc_event m_dma;
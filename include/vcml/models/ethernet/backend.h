@@ -39,9 +39,16 @@ public:
     backend(const backend&) = delete;
     backend(backend&&) = default;
 
+    // offloads this backend can pass on to the host, all others get
+    // finished in software before frames reach send_to_host
+    virtual u32 offloads() const { return ETH_OFFLOAD_NONE; }
+
     virtual void send_to_host(const eth_frame& frame) = 0;
     virtual void send_to_guest(eth_frame frame);
 
+    // frames are passed to the guest no earlier than the given time
+    void send_to_guest(eth_frame frame, const sc_time& delivery);
+
     static backend* create(bridge* br, const string& type);
 };
 
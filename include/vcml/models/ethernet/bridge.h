@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/replay.h"
 
 #include "vcml/properties/property.h"
 #include "vcml/protocols/eth.h"
@@ -32,14 +33,40 @@ private:
     unordered_map<size_t, backend*> m_dynamic_backends;
     vector<backend*> m_backends;
 
-    mutable mutex m_mtx;
-    queue<eth_frame> m_rx;
+    // frames from the backends travel through lock-free rings owned by the
+    // sending thread, the systemc side is only woken up once per batch
+    struct rx_entry {
+        eth_frame frame;
+        sc_time delivery;
+    };
+
+    struct rx_ring {
+        vector<rx_entry> frames;
+        atomic<size_t> head;
+        atomic<size_t> tail;
+        rx_ring(size_t capacity);
+    };
+
+    const u64 m_id;
+    mutex m_rings_mtx;
+    vector<unique_ptr<rx_ring>> m_rings;
+    atomic<bool> m_rx_pending;
+    atomic<size_t> m_rx_dropped;
     sc_event m_ev;
 
+    replay_channel m_replay;
+
+    void record_frame(const eth_frame& frame);
+    void replay_frame(const u8* data, size_t size);
+
+    rx_ring* local_ring();
+    size_t drain_rings();
+
     bool cmd_create_backend(const vector<string>& args, ostream& os);
     bool cmd_destroy_backend(const vector<string>& args, ostream& os);
     bool cmd_list_backends(const vector<string>& args, ostream& os);
 
+    virtual u32 eth_rx_offloads() const override;
     virtual void eth_receive(const eth_frame& frame) override;
 
     void eth_transmit();
@@ -48,6 +75,7 @@ private:
 
 public:
     property<string> backends;
+    property<size_t> rx_capacity;
 
     eth_initiator_socket eth_tx;
     eth_target_socket eth_rx;
@@ -58,6 +86,9 @@ public:
 
     void send_to_host(const eth_frame& frame);
     void send_to_guest(eth_frame frame);
+    void send_to_guest(eth_frame frame, const sc_time& delivery);
+
+    size_t num_dropped() const { return m_rx_dropped; }
 
     void attach(backend* b);
     void detach(backend* b);
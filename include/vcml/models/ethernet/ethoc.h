@@ -57,6 +57,12 @@ private:
     sc_event m_tx_event;
     sc_event m_rx_event;
 
+    u32 m_irq_held;
+    size_t m_irq_pending;
+    sc_event m_irq_flush_ev;
+
+    void flush_interrupts();
+
     void tx_process();
     void rx_process();
 
@@ -257,6 +263,11 @@ public:
     property<hz_t> clock;
     property<string> mac;
 
+    // frame interrupts are held back until irq_batch frames are done or
+    // irq_delay has passed since the first one, zero disables coalescing
+    property<size_t> irq_batch;
+    property<sc_time> irq_delay;
+
     gpio_initiator_socket irq;
 
     tlm_target_socket in;
@@ -102,6 +102,46 @@ public:
 class lan9118 : public peripheral, public eth_host
 {
 private:
+    enum : size_t {
+        SRAM_SIZE = 16 * KiB,
+        TX_STATUS_FIFO_SIZE = 512,
+        TXFF_SIZE_MIN = 2 * KiB,
+        RX_STATUS_FIFO_MAX = (SRAM_SIZE - TXFF_SIZE_MIN) / 16,
+        RX_STATUS_RING_SIZE = 1 * KiB,
+    };
+
+    static_assert(RX_STATUS_RING_SIZE >= RX_STATUS_FIFO_MAX,
+                  "rx status ring cannot hold largest fifo allocation");
+
+    // fixed ring of words with a power of two capacity that covers the
+    // largest fifo allocation the chip allows, frames are moved in and out
+    // using word-granular memcpy instead of per-byte ops
+    class word_fifo
+    {
+    private:
+        vector<u32> m_buf;
+        size_t m_mask;
+        size_t m_head;
+        size_t m_count;
+
+    public:
+        size_t capacity() const { return m_buf.size(); }
+        size_t size() const { return m_count; }
+        bool empty() const { return m_count == 0; }
+        void clear() { m_head = m_count = 0; }
+
+        u32 front() const { return m_buf[m_head]; }
+
+        word_fifo(size_t bytes);
+
+        void push(u32 val);
+        void push(const void* words, size_t count);
+        void push_zeros(size_t count);
+
+        u32 pop();
+        size_t pop(u32* words, size_t count);
+    };
+
     struct packet {
         enum { CMDA, CMDB, DATA } state;
 
@@ -149,10 +189,17 @@ private:
 
     packet m_tx_pkt;
     deque<packet> m_tx_packets;
-    deque<u32> m_tx_status_fifo;
+    word_fifo m_tx_status_fifo;
+
+    word_fifo m_rx_data_fifo;
+    vector<u8> m_rx_stage;
+
+    size_t m_irq_pending;
+    sc_event m_irq_flush_ev;
 
-    deque<u32> m_rx_data_fifo;
-    deque<u32> m_rx_status_fifo;
+    void coalesce_irq();
+    void flush_irq();
+    word_fifo m_rx_status_fifo;
 
     void reset_fifo_size(size_t txff_size);
 
@@ -203,7 +250,7 @@ private:
     void gpt_restart();
     void gpt_update();
 
-    bool rx_enqueue(const vector<u8>& data);
+    bool rx_enqueue(const u8* pkt, size_t size);
 
     void rx_thread();
     void tx_thread();
@@ -211,6 +258,9 @@ private:
     u32 read_rx_data_fifo();
     void write_tx_data_fifo(u32 val);
 
+    void read_rx_data_burst(u32* words, size_t count);
+    void write_tx_data_burst(const u8* data, size_t count);
+
     u32 read_rx_status_fifo();
     u32 read_rx_status_peek();
     u32 read_tx_status_fifo();
@@ -246,6 +296,11 @@ private:
 public:
     property<string> eeprom_mac;
 
+    // rx and tx completion interrupts are only evaluated once irq_batch
+    // frames are done or irq_delay has passed, zero disables coalescing
+    property<size_t> irq_batch;
+    property<sc_time> irq_delay;
+
     reg<u32, 8> rx_data_fifo;
     reg<u32, 8> tx_data_fifo;
     reg<u32> rx_status_fifo;
@@ -294,6 +349,9 @@ public:
     VCML_KIND(ethernet::lan9118);
     virtual void reset() override;
 
+    virtual unsigned int receive(tlm_generic_payload& tx, const tlm_sbi& info,
+                                 address_space as) override;
+
     void update_irq();
 
 protected:
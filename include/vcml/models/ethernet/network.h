@@ -16,26 +16,67 @@
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
 
+#include "vcml/properties/property.h"
+
 #include "vcml/protocols/eth.h"
 
 namespace vcml {
 namespace ethernet {
 
+// forwards frames between all attached devices; by default every frame is
+// flooded to all ports but the sender, in learning mode the network acts
+// like a switch and only floods frames to unknown, broadcast or multicast
+// destinations; with vlans enabled, tagged frames are learned per vlan id
 class network : public module, public eth_host
 {
 protected:
+    struct port_stats {
+        u64 rx_frames;
+        u64 rx_bytes;
+        u64 tx_frames;
+        u64 tx_bytes;
+        u64 tx_flooded;
+        u64 filtered;
+    };
+
+    struct mac_entry {
+        size_t port;
+        sc_time stamp;
+    };
+
     size_t m_next_id;
+    std::map<size_t, port_stats> m_stats;
+    unordered_map<u64, mac_entry> m_table;
 
     const eth_initiator_socket& peer_of(const eth_target_socket& rx) const {
         return eth_tx[eth_rx.index_of(rx)];
     }
 
+    u16 vlan_of(const eth_frame& frame) const;
+    u64 table_key(const mac_addr& addr, u16 vlan) const;
+
+    bool lookup(const mac_addr& dest, u16 vlan, size_t& port);
+    void learn(const mac_addr& src, u16 vlan, size_t port);
+
+    void forward(size_t port, const eth_frame& frame, bool flooded);
+
+    u32 eth_rx_offloads() const override { return ETH_OFFLOAD_ALL; }
     void eth_receive(const eth_target_socket&, const eth_frame&) override;
 
+    bool cmd_show_ports(const vector<string>& args, ostream& os);
+    bool cmd_show_macs(const vector<string>& args, ostream& os);
+    bool cmd_flush_macs(const vector<string>& args, ostream& os);
+
 public:
+    property<bool> learning;
+    property<sc_time> aging;
+    property<bool> vlans;
+
     eth_initiator_array eth_tx;
     eth_target_array eth_rx;
 
+    size_t num_learned() const { return m_table.size(); }
+
     network(const sc_module_name& nm);
     virtual ~network() = default;
     VCML_KIND(ethernet::network);
@@ -17,6 +17,8 @@
 #include "vcml/core/component.h"
 #include "vcml/core/model.h"
 
+#include "vcml/logging/log_throttle.h"
+
 #include "vcml/protocols/tlm.h"
 
 namespace vcml {
@@ -48,13 +50,41 @@ private:
     const char* target_peer_name(size_t port) const;
     const char* source_peer_name(size_t port) const;
 
+    // per-source decode table, sorted by start address, with a hint that
+    // remembers the mapping that was last used by that source port, as well
+    // as the address ranges this source port has been granted DMI for
+    struct route {
+        vector<const mapping*> decode;
+        const mapping* hint;
+        vector<range> dmi;
+        size_t invalidations;
+    };
+
     set<mapping> m_mappings;
     mapping m_default;
 
+    mutable bool m_dirty;
+    mutable vector<const mapping*> m_decode_any;
+    mutable vector<route> m_routes;
+
+    void rebuild_decoder() const;
+    const mapping* decode(const vector<const mapping*>& maps,
+                          const range& addr) const;
+
     const mapping& lookup(tlm_target_socket& src, const range& addr) const;
-    void handle_bus_error(tlm_generic_payload& tx) const;
+
+    void track_dmi(size_t port, const range& addr);
+    bool untrack_dmi(size_t port, const range& addr);
+    log_throttle m_bus_errors;
+
+    void handle_bus_error(tlm_target_socket& origin, tlm_generic_payload& tx);
+
+    void collect_dmi(const mapping& m, size_t source,
+                     const vector<range>& shadowed, vector<tlm_dmi>& dmis);
 
     bool cmd_mmap(const vector<string>& args, ostream& os);
+    bool cmd_dmi_map(const vector<string>& args, ostream& os);
+    bool cmd_bus_errors(const vector<string>& args, ostream& os);
 
 protected:
     virtual void b_transport(tlm_target_socket& origin,
@@ -70,11 +100,14 @@ protected:
     virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
                                            u64 start, u64 end) override;
 
+    virtual void end_of_elaboration() override;
+
 public:
     using initiator_t = tlm::tlm_base_initiator_socket<>;
     using target_t = tlm::tlm_base_target_socket<>;
 
     property<bool> lenient;
+    property<unsigned int> bus_error_limit;
 
     tlm_target_array in;
     tlm_initiator_array out;
@@ -89,6 +122,15 @@ public:
 
     void map_default(size_t target, u64 offset = 0);
 
+    // all regions source can access via dmi with their host pointers and
+    // latencies in bus addresses, found by asking every mapped target for
+    // dmi, so nested buses are walked, too. Regions are tracked like any
+    // other dmi grant, so source learns about invalidations as usual
+    vector<tlm_dmi> dmi_map(size_t source);
+
+    template <typename SOURCE>
+    vector<tlm_dmi> dmi_map(SOURCE& s);
+
     void stub(const range& addr, tlm_response_status rs = TLM_OK_RESPONSE);
     void stub(u64 lo, u64 hi, tlm_response_status rs = TLM_OK_RESPONSE);
 
@@ -163,6 +205,14 @@ inline void bus::stub(SOURCE& s, u64 lo, u64 hi, tlm_response_status rs) {
     stub(s, range(lo, hi), rs);
 }
 
+template <typename SOURCE>
+vector<tlm_dmi> bus::dmi_map(SOURCE& s) {
+    size_t port = find_source_port(s);
+    VCML_ERROR_ON(port == TARGET_NONE, "%s not bound to %s", s.name(),
+                  name());
+    return dmi_map(port);
+}
+
 template <typename SOURCE>
 size_t bus::bind(SOURCE& source) {
     size_t port = find_source_port(source);
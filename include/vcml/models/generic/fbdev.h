@@ -18,6 +18,7 @@
 
 #include "vcml/protocols/tlm.h"
 #include "vcml/ui/console.h"
+#include "vcml/ui/damage.h"
 
 namespace vcml {
 namespace generic {
@@ -27,6 +28,7 @@ class fbdev : public component
 private:
     ui::console m_console;
     ui::videomode m_mode;
+    ui::damage_tracker m_damage;
     u8* m_vptr;
 
     void update();
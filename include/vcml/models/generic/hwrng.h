@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/peripheral.h"
 #include "vcml/core/model.h"
+#include "vcml/core/entropy.h"
 
 #include "vcml/protocols/tlm.h"
 
@@ -24,6 +25,8 @@ namespace generic {
 class hwrng : public peripheral
 {
 private:
+    entropy_pool m_pool;
+
     u32 read_rng();
 
 public:
@@ -28,12 +28,33 @@ class memory : public peripheral, public debugging::loader
 private:
     tlm_memory m_memory;
 
+    // sparse copy of all non-zero pages at the start of simulation
+    bool m_has_pristine;
+    unordered_map<size_t, vector<u8>> m_pristine;
+
+    void save_pristine();
+    void restore_pristine();
+
+    // keeps dmi and exclusive locks coherent with other processes that
+    // map the same shared memory region
+    unique_ptr<tlm_shared_channel> m_channel;
+    vector<range> m_local_locks;
+    vector<range> m_remote_locks;
+
+    void map_memory_dmi();
+    void invalidate_peers();
+    void notify_peers(const range& addr, const tlm_sbi& info);
+    void notify_write(const range& addr, const tlm_sbi& info);
+    void handle_message(tlm_shared_channel::message msg, const range& addr);
+
     bool cmd_show(const vector<string>& args, ostream& os);
+    bool cmd_heatmap(const vector<string>& args, ostream& os);
 
     memory();
     memory(const memory&);
 
 protected:
+    virtual void load_bin(const string& filename, u64 offset) override;
     virtual u8* allocate_image(u64 size, u64 offset) override;
     virtual void copy_image(const u8* img, u64 size, u64 offset) override;
 
@@ -45,11 +66,35 @@ public:
     property<string> shared;
     property<vector<string>> images;
     property<u8> poison;
+    property<bool> hugepages;
+    property<bool> hugetlb;
+    property<bool> prefault;
+    property<int> numa_node;
+    property<bool> map_images;
+    property<bool> track_dirty;
+
+    // reset restores the contents from the start of simulation instead of
+    // clearing the memory and reloading all images
+    property<bool> pristine;
+
+    // reset hands all pages back to the host so that memory reads as zero
+    // again before images get reloaded
+    property<bool> clear_on_reset;
+
+    // samples per-page reads, writes and fetches, written to heatmap_file
+    // at the end of simulation if one is given
+    property<bool> heatmap;
+    property<sc_time> heatmap_period;
+    property<string> heatmap_file;
 
     tlm_target_socket in;
 
     u8* data() const { return m_memory.data(); }
 
+    vector<u64> fetch_dirty(const range& addr) {
+        return m_memory.fetch_dirty(addr);
+    }
+
     u8& operator[](size_t idx) { return m_memory[idx]; }
     u8 operator[](size_t idx) const { return m_memory[idx]; }
 
@@ -60,10 +105,20 @@ public:
     VCML_KIND(memory);
     virtual void reset() override;
 
+    virtual void save_state(checkpoint& cp) override;
+    virtual void load_state(checkpoint& cp) override;
+
     virtual tlm_response_status read(const range& addr, void* data,
                                      const tlm_sbi& info) override;
     virtual tlm_response_status write(const range& addr, const void* data,
                                       const tlm_sbi& info) override;
+
+    virtual unsigned int receive(tlm_generic_payload& tx, const tlm_sbi& info,
+                                 address_space as) override;
+
+protected:
+    virtual void start_of_simulation() override;
+    virtual void end_of_simulation() override;
 };
 
 } // namespace generic
@@ -0,0 +1,116 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_GENERIC_REMOTE_H
+#define VCML_GENERIC_REMOTE_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+#include "vcml/core/component.h"
+#include "vcml/core/model.h"
+
+#include "vcml/protocols/tlm.h"
+
+namespace vcml {
+namespace generic {
+
+class memory;
+
+struct remote_channel;
+struct remote_slot;
+
+// remote_target and remote_initiator are the two ends of a tlm bridge
+// between two processes. Both attach to the shared memory channel of the
+// same name: the target forwards everything it receives to the initiator,
+// which issues it on its own socket in the other process. Simulation time
+// is not synchronized, the initiator only adds its delay to the one of
+// each transaction
+class remote_target : public component
+{
+private:
+    string m_name;
+    int m_fd;
+    remote_channel* m_chan;
+
+    mutex m_maps_mtx;
+    unordered_map<string, pair<u8*, size_t>> m_maps;
+
+    atomic<bool> m_running;
+    thread m_watcher;
+
+    u8* map_shared(const string& name, size_t size);
+    void watch_invalidations();
+
+    remote_slot& post(u64& idx);
+    bool await(remote_slot& slot, u64 idx);
+    void release(remote_slot& slot, u64 idx);
+
+    void forward(tlm_generic_payload& tx, sc_time& dt, bool debug);
+
+public:
+    property<string> channel;
+
+    tlm_target_socket in;
+
+    remote_target(const sc_module_name& nm, const string& channel = "");
+    virtual ~remote_target();
+    VCML_KIND(remote_target);
+
+protected:
+    virtual void b_transport(tlm_target_socket& origin,
+                             tlm_generic_payload& tx, sc_time& dt) override;
+    virtual unsigned int transport_dbg(tlm_target_socket& origin,
+                                       tlm_generic_payload& tx) override;
+    virtual bool get_direct_mem_ptr(tlm_target_socket& origin,
+                                    tlm_generic_payload& tx,
+                                    tlm_dmi& dmi) override;
+};
+
+class remote_initiator : public component
+{
+private:
+    string m_name;
+    int m_fd;
+    remote_channel* m_chan;
+    atomic<u64> m_tail;
+
+    atomic<bool> m_running;
+    atomic<bool> m_pending;
+    thread m_listener;
+    sc_event m_ev;
+
+    // only memories backed by named shared memory can be exported as dmi
+    vector<const memory*> m_shared;
+
+    bool has_request() const;
+    void listen();
+    void serve();
+    void serve_request(remote_slot& slot);
+    void serve_dmi(remote_slot& slot, tlm_generic_payload& tx);
+
+public:
+    property<string> channel;
+
+    tlm_initiator_socket out;
+
+    remote_initiator(const sc_module_name& nm, const string& channel = "");
+    virtual ~remote_initiator();
+    VCML_KIND(remote_initiator);
+
+protected:
+    virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                           u64 start, u64 end) override;
+    virtual void end_of_elaboration() override;
+};
+
+} // namespace generic
+} // namespace vcml
+
+#endif
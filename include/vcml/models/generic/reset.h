@@ -23,6 +23,9 @@ namespace generic {
 
 class reset : public module
 {
+private:
+    bool cmd_pulse(const vector<string>& args, ostream& os);
+
 public:
     property<bool> state;
 
@@ -33,6 +36,9 @@ public:
     virtual ~reset();
     VCML_KIND(reset);
 
+    // resets everything in this reset domain with one sweep over rst
+    void pulse() { rst.pulse(); }
+
 protected:
     virtual void end_of_elaboration() override;
 };
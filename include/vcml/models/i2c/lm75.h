@@ -78,6 +78,8 @@ protected:
                                   u8& data) override;
     virtual i2c_response i2c_write(const i2c_target_socket& socket,
                                    u8 data) override;
+    virtual void i2c_transport(const i2c_target_socket& socket,
+                               i2c_message& msg) override;
 };
 
 } // namespace i2c
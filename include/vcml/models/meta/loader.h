@@ -24,8 +24,16 @@ namespace meta {
 
 class loader : public component, public debugging::loader
 {
+private:
+    bool m_loaded;
+
 public:
     property<vector<string>> images;
+    property<bool> parallel;
+
+    // without reload, images are only loaded on the first reset and the
+    // target memories are expected to restore them themselves later on
+    property<bool> reload;
 
     tlm_initiator_socket insn;
     tlm_initiator_socket data;
@@ -36,6 +36,13 @@ private:
 
     u32 read_prng();
 
+    u32 read_roib();
+    void write_roib(u32 val);
+    void write_roie(u32 val);
+    void write_srst(u32 val);
+    void write_sdmp(u32 val);
+    void write_ckpt(u32 val);
+
     // disabled
     simdev();
     simdev(const simdev&);
@@ -57,6 +64,23 @@ public:
     // random
     reg<u32> prng;
 
+    // region of interest and statistics
+    reg<u32> roib;
+    reg<u32> roie;
+    reg<u32> srst;
+    reg<u32> sdmp;
+    reg<u32> ckpt;
+
+    // only trace while inside the region of interest
+    property<bool> roi_tracing;
+
+    // statistics dumps get appended here, or logged if empty
+    property<string> stats_file;
+
+    // checkpoint requests save to this file, suffixed with a nonzero value
+    // written to ckpt
+    property<string> checkpoint_file;
+
     tlm_target_socket in;
 
     simdev(const sc_module_name& name);
@@ -64,6 +88,9 @@ public:
     VCML_KIND(simdev);
 
     virtual void reset() override;
+
+protected:
+    virtual void start_of_simulation() override;
 };
 
 } // namespace meta
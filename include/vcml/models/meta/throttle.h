@@ -24,25 +24,68 @@ namespace meta {
 
 class throttle : public module
 {
+public:
+    // slack is the host time left until the deadline of an interval when
+    // its simulation work is done, negative slack means running late
+    enum slack_bucket : size_t {
+        SLACK_LATE,
+        SLACK_10US,
+        SLACK_100US,
+        SLACK_1MS,
+        SLACK_10MS,
+        SLACK_MORE,
+        NUM_SLACK_BUCKETS,
+    };
+
 private:
     bool m_throttling;
 
     u64 m_start;
     u64 m_extra;
 
+    u64 m_deadline;
+    sc_time m_interval;
+    sc_time m_last;
+
+    u64 m_host_start;
+    u64 m_host_suspended;
+    array<u64, NUM_SLACK_BUCKETS> m_slack;
+
+    void record_slack(i64 slack_ns);
+    void adapt_interval(bool missed);
+
+    void pace_coarse(const sc_time& interval);
+    void pace_precise(const sc_time& interval);
     void update();
 
+    bool cmd_stats(const vector<string>& args, ostream& os);
+
 public:
     property<sc_time> update_interval;
     property<double> rtf;
 
+    // precise pacing sleeps until an absolute deadline minus spin_time and
+    // busy waits the rest, adaptive shortens the interval down to the
+    // quantum while deadlines are met and backs off when they are missed
+    property<bool> precise;
+    property<sc_time> spin_time;
+    property<bool> adaptive;
+
     throttle(const sc_module_name& nm);
     virtual ~throttle() = default;
     VCML_KIND(throttle);
 
     bool is_throttling() const { return m_throttling; }
 
+    const sc_time& current_interval() const { return m_interval; }
+    double actual_rtf() const;
+
+    const array<u64, NUM_SLACK_BUCKETS>& slack_histogram() const {
+        return m_slack;
+    }
+
 protected:
+    virtual void end_of_simulation() override;
     virtual void session_suspend() override;
     virtual void session_resume() override;
 };
@@ -21,6 +21,7 @@
 
 #include "vcml/properties/property.h"
 #include "vcml/ui/console.h"
+#include "vcml/ui/damage.h"
 
 namespace vcml {
 namespace opencores {
@@ -39,6 +40,11 @@ private:
     u32 m_palette[PALETTE_SIZE];
 
     u8* m_fb;
+    u8* m_scanout;
+    vector<u8> m_linebuf;
+
+    ui::videomode m_mode;
+    ui::damage_tracker m_damage;
 
     u32 m_xres;
     u32 m_yres;
@@ -59,7 +65,11 @@ private:
 
     sc_event m_enable;
 
+    u32 vram_base() const { return (stat & STAT_AVMP) ? vbarb : vbara; }
+
     void create();
+    void scanout();
+    void fetch();
     void render();
     void update();
 
@@ -35,6 +35,7 @@ private:
 
     ui::keyboard m_keyboard;
     ui::console m_console;
+    sc_event m_update_ev;
 
     void update();
     void key_event(u32 key, u32 down);
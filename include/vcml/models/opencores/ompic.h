@@ -31,6 +31,18 @@ private:
     u32* m_control;
     u32* m_status;
 
+    // one bit per core with an unacknowledged ipi, so that the irq lines
+    // only get written when their state actually changes
+    vector<u64> m_pending;
+
+    vector<u64> m_num_sent;
+    vector<u64> m_num_received;
+    vector<u64> m_num_coalesced;
+
+    void set_pending(size_t core, bool pending);
+
+    bool cmd_stats(const vector<string>& args, ostream& os);
+
     u32 read_status(size_t core_idx);
     u32 read_control(size_t core_idx);
 
@@ -52,8 +64,24 @@ public:
     ompic(const sc_module_name& name, unsigned int num_cores);
     virtual ~ompic();
     VCML_KIND(opencores::ompic);
+
+    virtual void reset() override;
+
+    size_t num_cores() const { return m_num_cores; }
+
+    bool is_pending(size_t core) const;
+
+    // ipis sent and received by a core; an ipi arriving while the previous
+    // one is still unacknowledged is also counted as coalesced
+    u64 num_ipis_sent(size_t core) const { return m_num_sent.at(core); }
+    u64 num_ipis_received(size_t c) const { return m_num_received.at(c); }
+    u64 num_ipis_coalesced(size_t c) const { return m_num_coalesced.at(c); }
 };
 
+inline bool ompic::is_pending(size_t core) const {
+    return (m_pending[core / 64] >> (core % 64)) & 1;
+}
+
 } // namespace opencores
 } // namespace vcml
 
@@ -207,7 +207,10 @@ public:
                                       const tlm_sbi& info,
                                       address_space as) override;
 
-    void pci_declare_bar(int barno, u64 size, u32 type);
+    // memory bars may be backed by host memory, which is then granted to
+    // initiators via dmi and no longer routed through read/write
+    void pci_declare_bar(int barno, u64 size, u32 type,
+                         u8* memory = nullptr);
 
     void pci_declare_pm_cap(u16 pm_caps);
     void pci_declare_msi_cap(u16 msi_ctrl);
@@ -225,6 +228,12 @@ public:
 
     void pci_legacy_interrupt(bool state);
 
+    // coalesces msi and msi-x interrupts on the given vector: an interrupt
+    // is delivered once count of them have accumulated or delay has passed
+    // since the first one, whichever happens first
+    void pci_moderate_irq(unsigned int vector, size_t count,
+                          const sc_time& delay);
+
 protected:
     virtual void pci_transport(const pci_target_socket& socket,
                                pci_payload& tx) override;
@@ -238,12 +247,35 @@ private:
     sc_event m_msi_notify;
     sc_event m_msix_notify;
 
+    struct irq_moderation {
+        size_t count;
+        sc_time delay;
+        size_t events;
+        sc_time due;
+    };
+
+    vector<irq_moderation> m_moderation;
+
+    // flat map of the config space, holding for each byte the index of
+    // the register covering it in m_cfg_regs, with zero meaning none
+    vector<u8> m_cfg_index;
+    vector<reg_base*> m_cfg_regs;
+
+    void build_cfg_map();
+    bool receive_cfg(tlm_generic_payload& tx, const tlm_sbi& info);
+
+    void moderate_irq(unsigned int vector);
+    sc_time moderation_delay(unsigned int vector) const;
+    void moderation_done(unsigned int vector);
+
     void msi_send(unsigned int vector);
     void msi_process();
 
     void msix_send(unsigned int vector);
     void msix_process();
 
+    u8* bar_memory(address_space as, const range& addr) const;
+
     void write_bars(u32 val, size_t barno);
 
     void write_command(u16 val);
@@ -26,23 +26,44 @@ namespace pci {
 
 class host : public component, public pci_initiator
 {
+public:
+    typedef function<bool(u64 addr, u32 data)> msi_handler;
+
 private:
     struct pci_mapping {
         u32 devno;
         int barno;
         address_space space;
         range addr;
+        u8* memory;
 
         bool is_valid() const { return barno >= 0 && barno < 6; }
     };
 
     static const pci_mapping MAP_NONE;
 
+    // both maps are kept sorted by start address for binary search
     vector<pci_mapping> m_map_mmio;
     vector<pci_mapping> m_map_io;
 
     const pci_mapping& lookup(const pci_payload& pci, bool io) const;
 
+    void map_bar_dmi(const pci_mapping& mapping);
+    void unmap_bar_dmi(const pci_mapping& mapping);
+
+    struct msi_endpoint {
+        range addr;
+        msi_handler handler;
+    };
+
+    vector<msi_endpoint> m_msi_endpoints;
+
+    // config space targets of bus 0 indexed by devfn, built on first use
+    // once all sockets have been created during elaboration
+    vector<pci_initiator_socket*> m_cfg_targets;
+
+    void build_cfg_targets();
+
 public:
     property<bool> pcie;
 
@@ -62,6 +83,10 @@ public:
     virtual ~host();
     virtual const char* kind() const override;
 
+    // msis targeting addr are handed to the handler directly instead of
+    // being sent as a write transaction via dma_out
+    void map_msi(const range& addr, const msi_handler& handler);
+
 protected:
     u32 pci_devno(const pci_initiator_socket& socket) const {
         return (u32)pci_out.index_of(socket);
@@ -86,6 +111,8 @@ protected:
                                u64 size, const void* data) override;
     virtual void pci_interrupt(const pci_initiator_socket& socket, pci_irq irq,
                                bool state) override;
+    virtual bool pci_msi(const pci_initiator_socket& socket, u64 addr,
+                         u32 data) override;
 };
 
 } // namespace pci
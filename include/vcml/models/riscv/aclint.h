@@ -20,6 +20,8 @@
 #include "vcml/protocols/tlm.h"
 #include "vcml/protocols/gpio.h"
 
+#include "vcml/models/riscv/mtimer.h"
+
 namespace vcml {
 namespace riscv {
 
@@ -27,7 +29,7 @@ class aclint : public peripheral
 {
 private:
     sc_time m_time_reset;
-    sc_event m_trigger;
+    mtimer m_timers;
 
     u64 get_cycles() const;
 
@@ -40,7 +42,7 @@ private:
     u32 read_ssip(size_t hart);
     void write_ssip(u32 val, size_t hart);
 
-    void update_timer();
+    void update_timer(size_t hart);
 
     // disabled
     aclint();
@@ -77,6 +79,9 @@ public:
     VCML_KIND(riscv::aclint);
 
     virtual void reset() override;
+
+    // absolute time of the next timer interrupt, SC_MAX_TIME if none
+    sc_time next_timer_deadline() { return m_timers.next_deadline(); }
 };
 
 } // namespace riscv
@@ -52,8 +52,16 @@ private:
 
     irqinfo m_irqs[NIRQ];
 
+    // sources that are both enabled and pending
+    u64 m_ready[NIRQ / 64 + 1];
+
+    // msis raised during the current delta cycle
+    vector<pair<u64, u32>> m_msis;
+    sc_event m_msi_ev;
+
     void set_pending(irqinfo* irq, bool pending);
     void set_enabled(irqinfo* irq, bool enabled);
+    void set_ready(irqinfo* irq);
 
     u32 read_zero() { return 0; }
     u32 read_zero_idx(size_t idx) { return 0; }
@@ -94,7 +102,11 @@ private:
     void update();
     void update(irqinfo* irq);
 
-    void send_msi(u32 hart, u32 guest, u32 eiid);
+    u64 msi_address(u32 hart, u32 guest);
+    void send_msi(u64 addr, u32 eiid);
+    void queue_msi(u32 hart, u32 guest, u32 eiid);
+    void msi_thread();
+
     void send_irq(u32 hart);
 
 public:
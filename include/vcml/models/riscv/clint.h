@@ -20,6 +20,8 @@
 #include "vcml/protocols/tlm.h"
 #include "vcml/protocols/gpio.h"
 
+#include "vcml/models/riscv/mtimer.h"
+
 namespace vcml {
 namespace riscv {
 
@@ -27,7 +29,7 @@ class clint : public peripheral
 {
 private:
     sc_time m_time_reset;
-    sc_event m_trigger;
+    mtimer m_timers;
 
     u64 get_cycles() const;
 
@@ -36,7 +38,7 @@ private:
     void write_mtimecmp(u64 val, size_t hart);
     u64 read_mtime();
 
-    void update_timer();
+    void update_timer(size_t hart);
 
     // disabled
     clint();
@@ -59,6 +61,9 @@ public:
     VCML_KIND(riscv::clint);
 
     virtual void reset() override;
+
+    // absolute time of the next timer interrupt, SC_MAX_TIME if none
+    sc_time next_timer_deadline() { return m_timers.next_deadline(); }
 };
 
 } // namespace riscv
@@ -0,0 +1,54 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_RISCV_MTIMER_H
+#define VCML_RISCV_MTIMER_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+namespace riscv {
+
+// per-hart timers shared by clint and aclint; each hart gets its own
+// deadline_timer on first use, so that arming one timer does not touch
+// the others and idle harts do not cost anything
+class mtimer
+{
+public:
+    typedef function<void(size_t)> handler;
+
+private:
+    handler m_expire;
+    unordered_map<size_t, unique_ptr<deadline_timer>> m_harts;
+
+    deadline_timer* lookup(size_t hart);
+
+public:
+    mtimer(const handler& expire);
+    ~mtimer() = default;
+
+    mtimer() = delete;
+    mtimer(const mtimer&) = delete;
+
+    bool is_armed(size_t hart) const;
+
+    void arm(size_t hart, const sc_time& delay);
+    void cancel(size_t hart);
+    void cancel_all();
+
+    // absolute time of the earliest armed timer, SC_MAX_TIME if none
+    sc_time next_deadline() const;
+};
+
+} // namespace riscv
+} // namespace vcml
+
+#endif
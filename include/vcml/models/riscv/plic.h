@@ -38,19 +38,22 @@ private:
         reg<u32> threshold;
         reg<u32> claim;
 
+        // irqs enabled with a priority above threshold, rebuilt if stale
+        u64 eligible[NIRQ / 64];
+        bool stale;
+
         context(size_t id);
         ~context();
     };
 
     u32 m_claims[NIRQ];
+    u64 m_pending[NIRQ / 64]; // pending and not claimed
     context* m_contexts[NCTX];
 
     bool is_pending(size_t irqno) const;
     bool is_claimed(size_t irqno) const;
-    bool is_enabled(size_t irqno, size_t ctxno) const;
 
     u32 irq_priority(size_t irqno) const;
-    u32 ctx_threshold(size_t ctxno) const;
 
     u32 read_pending(size_t regno);
     u32 read_claim(size_t ctxno);
@@ -60,6 +63,12 @@ private:
     void write_threshold(u32 value, size_t ctxno);
     void write_complete(u32 value, size_t ctxno);
 
+    void update_pending(size_t irqno);
+    void update_eligible(context* ctx);
+    void invalidate_contexts();
+    size_t best_irq(size_t ctxno);
+
+    void update(size_t ctxno);
     void update();
 
     // disabled
@@ -27,6 +27,13 @@ class simdev : public peripheral
 private:
     void write_finish(u32 val);
 
+    u32 read_roib();
+    void write_roib(u32 val);
+    void write_roie(u32 val);
+    void write_srst(u32 val);
+    void write_sdmp(u32 val);
+    void write_ckpt(u32 val);
+
 public:
     enum : u32 {
         FINISH_FAIL = 0x3333,
@@ -36,6 +43,17 @@ public:
 
     reg<u32> finish;
 
+    // region of interest and statistics, same as in meta::simdev
+    reg<u32> roib;
+    reg<u32> roie;
+    reg<u32> srst;
+    reg<u32> sdmp;
+    reg<u32> ckpt;
+
+    property<bool> roi_tracing;
+    property<string> stats_file;
+    property<string> checkpoint_file;
+
     tlm_target_socket in;
 
     simdev() = delete;
@@ -44,6 +62,9 @@ public:
     simdev(const sc_module_name& nm);
     virtual ~simdev();
     VCML_KIND(sifive::simdev);
+
+protected:
+    virtual void start_of_simulation() override;
 };
 
 } // namespace riscv
@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/component.h"
 #include "vcml/core/model.h"
+#include "vcml/core/offload.h"
 
 #include "vcml/protocols/sd.h"
 #include "vcml/models/block/disk.h"
@@ -47,6 +48,23 @@ private:
     size_t m_curoff;
     size_t m_numblk;
 
+    // consecutive blocks of a multi-block transfer; reads fill it from the
+    // disk in one go, writes collect blocks in it until they are flushed
+    vector<u8> m_bulk;
+    size_t m_bulkoff;
+    bool m_bulkwr;
+
+    struct prefetch {
+        size_t offset;
+        bool ready;
+        bool success;
+        vector<u8> data;
+    };
+
+    // next window of a multi-block read, fetched while the host is still
+    // receiving the current one
+    std::shared_ptr<prefetch> m_prefetch;
+
     enum state {
         IDLE = 0,
         READY = 1,
@@ -76,6 +94,14 @@ private:
     void setup_tx(u8* data, size_t len);
     void setup_rx(u8* data, size_t len);
 
+    bool use_prefetch(size_t offset);
+    void prefetch_bulk(size_t offset, size_t size);
+
+    bool in_bulk(size_t offset, size_t blklen) const;
+    void load_bulk(size_t offset, size_t blklen);
+    void queue_bulk(size_t offset, size_t blklen);
+    void flush_bulk();
+
     void setup_tx_blk(size_t offset);
     void setup_rx_blk(size_t offset);
 
@@ -167,6 +193,9 @@ public:
     property<string> image;
     property<bool> readonly;
 
+    // computes and checks the crc16 of data blocks
+    offload crc;
+
     block::disk disk;
 
     sd_target_socket sd_in;
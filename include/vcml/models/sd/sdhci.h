@@ -46,6 +46,7 @@ private:
     enum normal_interrupts {
         INT_COMMAND_COMPLETE = bit(0),
         INT_TRANSFER_COMPLETE = bit(1),
+        INT_BLOCK_GAP_EVENT = bit(2),
         INT_DMA_INTERRUPT = bit(3),
         INT_BUFFER_WRITE_READY = bit(4),
         INT_BUFFER_READ_READY = bit(5),
@@ -60,10 +61,39 @@ private:
         ERR_DATA_TIMEOUT = bit(4),
         ERR_DATA_CRC = bit(5),
         ERR_DATA_END_BIT = bit(6),
+        ERR_ADMA = bit(9),
     };
 
     enum capabilities : u32 {
         CAPABILITY_VALUES_0 = 0x01000a8a,
+        CAPABILITY_ADMA2 = bit(19),
+        CAPABILITY_SDMA = bit(22),
+    };
+
+    enum host_control_bits : u8 {
+        HOST_CTRL_DMA_SELECT = 3 << 3,
+        HOST_CTRL_ADMA32 = 2 << 3,
+        HOST_CTRL_ADMA64 = 3 << 3,
+    };
+
+    enum block_gap_bits : u8 {
+        BLOCK_GAP_STOP = bit(0),
+        BLOCK_GAP_CONTINUE = bit(1),
+    };
+
+    enum adma_attributes : u16 {
+        ADMA_VALID = bit(0),
+        ADMA_END = bit(1),
+        ADMA_INT = bit(2),
+        ADMA_ACT = 3 << 4,
+        ADMA_ACT_TRAN = 2 << 4,
+        ADMA_ACT_LINK = 3 << 4,
+    };
+
+    enum adma_errors : u8 {
+        ADMA_ERR_ST_FDS = 1, // error while fetching a descriptor
+        ADMA_ERR_ST_TFR = 3, // error while transferring data
+        ADMA_ERR_LENGTH = bit(2),
     };
 
     sd_command m_cmd;
@@ -95,7 +125,14 @@ private:
     tlm_response_status dma_read(u32 boundary);
     tlm_response_status dma_write(u32 boundary);
 
+    bool adma_selected() const;
+    bool adma_error(u8 status);
+    bool adma_segment(u64 addr, u32 len, bool to_card);
+    bool adma_transfer();
+    void write_block_gap_ctrl(u8 val);
+
     sc_event m_dma_start;
+    sc_event m_dma_continue;
 
 public:
     // Common SDHCI registers
@@ -114,6 +151,7 @@ public:
     reg<u32> present_state;
     reg<u8> host_control_1;
     reg<u8> power_ctrl;
+    reg<u8> block_gap_ctrl;
     reg<u16> clock_ctrl;
     reg<u8> timeout_ctrl;
     reg<u8> software_reset;
@@ -127,6 +165,8 @@ public:
 
     reg<u32, 2> capabilities;
     reg<u32> max_curr_cap;
+    reg<u8> adma_err_stat;
+    reg<u32, 2> adma_system_address;
 
     reg<u16> host_controller_version;
 
@@ -135,6 +175,7 @@ public:
     reg<u32> f_sd_h30_esd_control;
 
     property<bool> dma_enabled;
+    property<bool> adma_enabled;
 
     gpio_initiator_socket irq;
     tlm_target_socket in;
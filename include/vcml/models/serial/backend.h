@@ -21,6 +21,30 @@ class terminal;
 
 class backend
 {
+public:
+    struct queue_stats {
+        size_t num_bytes;   // bytes handed to the backend so far
+        size_t num_dropped; // bytes discarded because the queue was full
+        size_t num_stalls;  // times the sender waited for queue space
+        size_t peak_level;  // highest number of bytes ever queued
+    };
+
+private:
+    // output can be decoupled from the simulation by a bounded queue that
+    // a thread of this backend drains using write, when full the sender
+    // either waits or drops the bytes that did not fit anymore
+    mutable mutex m_queue_mtx;
+    condition_variable m_queue_cv;
+    condition_variable m_space_cv;
+    vector<u8> m_queue;
+    size_t m_queue_cap;
+    bool m_queue_drop;
+    bool m_queue_running;
+    queue_stats m_queue_stats;
+    thread m_queue_thread;
+
+    void queue_thread();
+
 protected:
     terminal* m_term;
     string m_type;
@@ -42,6 +66,27 @@ public:
     virtual bool read(u8& val) = 0;
     virtual void write(u8 val) = 0;
 
+    // fetches up to size bytes of pending input at once, returns the number
+    // of bytes actually read or zero if no input is available right now
+    virtual size_t read(u8* data, size_t size);
+
+    // writes a batch of output from the terminal, backends should override
+    // this to emit the entire batch at once instead of byte by byte
+    virtual void write(const u8* data, size_t size);
+
+    bool is_queued() const { return m_queue_thread.joinable(); }
+    bool drops_output() const { return m_queue_drop; }
+    size_t queue_capacity() const { return m_queue_cap; }
+    queue_stats get_queue_stats() const;
+
+    // queued backends must be stopped before their destructor runs, since
+    // the queue thread calls write, terminal::destroy_backend does that
+    void start_queue(size_t capacity, bool drop);
+    void stop_queue();
+
+    // hands output to the queue if there is one and to write otherwise
+    void send(const u8* data, size_t size);
+
     void capture_stdin();
     void release_stdin();
 
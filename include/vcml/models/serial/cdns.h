@@ -27,13 +27,17 @@ namespace serial {
 class cdns : public peripheral, public serial_host
 {
 private:
-    queue<u8> m_rxff;
-    queue<u8> m_txff;
+    serial_fifo m_rxff;
+    serial_fifo m_txff;
 
     sc_event m_txev;
+    sc_event m_rtev;
+    sc_time m_bit_time;
 
     void push_rxff(u8 val);
     void push_txff(u8 val);
+    void restart_timeout();
+    void rx_timeout();
 
     void write_cr(u32 val);
     void write_mr(u32 val);
@@ -47,6 +51,8 @@ private:
     void tx_thread();
     void update_irq();
 
+    virtual void serial_receive(const serial_target_socket& socket,
+                                serial_payload& tx) override;
     virtual void serial_receive(u8 data) override;
 
 public:
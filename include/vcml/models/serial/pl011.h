@@ -27,11 +27,16 @@ namespace serial {
 class pl011 : public peripheral, public serial_host
 {
 private:
-    unsigned int m_fifo_size;
-    queue<u16> m_fifo;
+    serial_fifo m_fifo;
+    sc_event m_rx_timeout_ev;
 
     // serial host
-    virtual void serial_receive(u8 data) override;
+    virtual void serial_receive(const serial_target_socket& socket,
+                                serial_payload& tx) override;
+
+    size_t rx_trigger() const;
+    void rx_push(u16 val);
+    void rx_timeout();
 
     void update();
 
@@ -57,7 +62,8 @@ public:
     };
 
     enum : u32 {
-        FIFOSIZE = 16, // FIFO size
+        FIFOSIZE = 16,       // FIFO size
+        RX_TIMEOUT_BITS = 32 // bit periods until receive timeout
     };
 
     enum dr_bits : u16 {
@@ -108,6 +114,13 @@ public:
         LCR_H_M = 0xff       // LCR Header Mask
     };
 
+    enum ifls_bits : u16 {
+        IFLS_TX_O = 0,    // Transmit Interrupt FIFO Level Select Offset
+        IFLS_RX_O = 3,    // Receive Interrupt FIFO Level Select Offset
+        IFLS_LVL_M = 0x7, // FIFO Level Select Mask
+        IFLS_M = 0x3f     // Interrupt FIFO Level Select Mask
+    };
+
     enum cr_bits {
         CR_UARTEN = 1 << 0, // UART Enable
         CR_TXE = 1 << 8,    // Transmit Enable
@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/replay.h"
 
 #include "vcml/protocols/serial.h"
 #include "vcml/properties/property.h"
@@ -44,12 +45,19 @@ private:
     vector<backend*> m_listeners;
     sc_event m_async_ev;
 
+    vector<u8> m_txbuf;
+    sc_event m_flush_ev;
+
+    replay_channel m_replay;
+
     bool cmd_create_backend(const vector<string>& args, ostream& os);
     bool cmd_destroy_backend(const vector<string>& args, ostream& os);
     bool cmd_list_backends(const vector<string>& args, ostream& os);
     bool cmd_history(const vector<string>& args, ostream& os);
+    bool cmd_queue_stats(const vector<string>& args, ostream& os);
 
     void serial_transmit();
+    void flush_output();
 
     virtual void serial_receive(u8 data) override;
 
@@ -60,6 +68,18 @@ public:
     property<string> config;
     property<bool> untimed;
 
+    // guest output is buffered and handed to the backends at each newline,
+    // once flush_size bytes have accumulated or after flush_delay, flushing
+    // can be disabled by setting flush_size to zero
+    property<size_t> flush_size;
+    property<sc_time> flush_delay;
+
+    // backends created by the terminal get an output queue of queue_size
+    // bytes serviced by their own thread, zero writes output synchronously;
+    // backend kinds listed in queue_drop discard output when it is full
+    property<size_t> queue_size;
+    property<string> queue_drop;
+
     serial_initiator_socket serial_tx;
     serial_target_socket serial_rx;
 
@@ -67,9 +87,12 @@ public:
     virtual ~terminal();
     VCML_KIND(serial::terminal);
 
+    virtual void end_of_simulation() override;
+
     void attach(backend* b);
     void detach(backend* b);
     void notify(backend* b);
+    void flush();
 
     size_t create_backend(const string& type);
     bool destroy_backend(size_t id);
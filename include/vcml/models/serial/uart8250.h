@@ -27,17 +27,22 @@ namespace serial {
 class uart8250 : public peripheral, public serial_host
 {
 private:
-    const size_t m_rx_size;
-    const size_t m_tx_size;
+    serial_fifo m_rx_fifo;
+    size_t m_rx_trigger;
+    bool m_fifo_enabled;
 
-    queue<u8> m_rx_fifo;
-    queue<u8> m_tx_fifo;
+    bool m_rx_timeout;
+    sc_time m_rx_symbol;
+    sc_event m_rx_timeout_ev;
 
     u16 m_divisor;
 
     void calibrate();
     void update();
 
+    void rx_restart_timeout();
+    void rx_timeout();
+
     u8 read_rbr();
     u8 read_ier();
     u8 read_iir();
@@ -55,6 +60,11 @@ private:
 public:
     enum : baud_t { DEFAULT_BAUD = SERIAL_9600BD };
 
+    enum : size_t {
+        FIFO_SIZE = 16,       // receive FIFO size
+        RX_TIMEOUT_CHARS = 4, // character times until receive timeout
+    };
+
     // clang-format off
     enum lsr_status : u8 {
         LSR_DR   = bit(0), // line status data ready
@@ -77,6 +87,8 @@ public:
         IIR_THRE = 1 << 1, // irq transmitter hold empty
         IIR_RDA  = 2 << 1, // irq received data available
         IIR_RLS  = 3 << 1, // irq receiver line status
+        IIR_CTI  = 6 << 1, // irq character timeout
+        IIR_FIFO = 3 << 6, // FIFOs enabled
     };
 
     enum lcr_status : u8 {
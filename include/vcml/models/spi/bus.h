@@ -54,6 +54,8 @@ public:
 
     virtual void spi_transport(const spi_target_socket& socket,
                                spi_payload& spi) override;
+    virtual void spi_transport(const spi_target_socket& socket,
+                               spi_burst& burst) override;
 
     unsigned int next_free() const;
 
@@ -16,6 +16,7 @@
 #include "vcml/core/component.h"
 #include "vcml/core/model.h"
 
+#include "vcml/protocols/tlm.h"
 #include "vcml/protocols/spi.h"
 #include "vcml/protocols/gpio.h"
 
@@ -73,12 +74,32 @@ private:
 
     u8 m_buffer[16];
 
+    // copy of the flash contents served to xip_in, dmi grants are revoked
+    // on program and erase and handed out again once the command has ended;
+    // chunks are only paged in from the disk once they are first accessed
+    tlm_memory m_xip;
+    bool m_xip_stale;
+    vector<bool> m_xip_loaded;
+
+    void xip_load(u64 addr, size_t size);
+    void xip_map(u64 addr, size_t size);
+    void xip_update(u64 addr, const u8* data, size_t size);
+    void xip_remap();
+
     void decode(u8 val);
     void complete();
     void process(spi_payload& tx);
 
     virtual void spi_transport(const spi_target_socket& socket,
                                spi_payload& tx) override;
+    virtual void spi_transport(const spi_target_socket& socket,
+                               spi_burst& burst) override;
+
+    virtual void gpio_notify(const gpio_target_socket& socket) override;
+
+    virtual unsigned int transport(tlm_generic_payload& tx,
+                                   const tlm_sbi& sideband,
+                                   address_space as) override;
 
 public:
     property<string> device;
@@ -90,6 +111,13 @@ public:
     spi_target_socket spi_in;
     gpio_target_socket cs_in;
 
+    // memory-mapped read-only access to the flash for execute-in-place
+    tlm_target_socket xip_in;
+
+    static constexpr size_t XIP_CHUNK = 64 * KiB;
+
+    size_t xip_chunks_loaded() const;
+
     size_t sector_size() const { return m_info.sector_size; }
     size_t sector_count() const { return m_info.num_sectors; }
     size_t size() const { return sector_count() * sector_size(); }
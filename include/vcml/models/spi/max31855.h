@@ -62,6 +62,8 @@ public:
 
     virtual void spi_transport(const spi_target_socket& socket,
                                spi_payload& spi) override;
+    virtual void spi_transport(const spi_target_socket& socket,
+                               spi_burst& burst) override;
 
     void bind(gpio_initiator_socket& s, bool cs_active_high = true);
 };
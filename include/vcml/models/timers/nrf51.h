@@ -28,7 +28,7 @@ class nrf51 : public peripheral
 private:
     bool m_running;
     sc_time m_start;
-    sc_event m_trigger;
+    deadline_timer m_trigger;
     u32 m_inten;
 
     bool is_timer_mode() const { return m_running && mode == 0u; }
@@ -27,7 +27,7 @@ class pl031 : public peripheral
 {
 private:
     u32 m_offset;
-    sc_event m_notify;
+    deadline_timer m_match;
 
     u32 read_dr();
 
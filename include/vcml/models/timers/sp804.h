@@ -41,7 +41,7 @@ public:
     class timer : public peripheral
     {
     private:
-        sc_event m_ev;
+        deadline_timer m_deadline;
         sc_time m_prev;
         sc_time m_next;
         sp804* m_timer;
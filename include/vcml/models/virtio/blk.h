@@ -53,7 +53,8 @@ private:
         } topology;
 
         u8 writeback;
-        u8 unused0[3];
+        u8 unused0;
+        u16 num_queues;
         u32 max_discard_sectors;
         u32 max_discard_seg;
         u32 discard_sector_alignment;
@@ -63,10 +64,21 @@ private:
         u8 unused1[3];
     } m_config;
 
-    bool process_command(vq_message& msg);
-    bool process_in(virtio_blk_req& req, vq_message& msg);
-    bool process_out(virtio_blk_req& req, vq_message& msg);
-    bool process_flush(virtio_blk_req& req, vq_message& msg);
+    struct request {
+        u32 vqid;
+        vq_message msg;
+        u64 sector;
+        vector<iovec> iov;
+    };
+
+    void complete(request& io, u8 status);
+    void transfer_done(request& io, bool success);
+
+    // returns false if the request is still in flight
+    bool process_command(u32 vqid, vq_message& msg);
+    bool process_in(u32 vqid, virtio_blk_req& req, vq_message& msg);
+    bool process_out(u32 vqid, virtio_blk_req& req, vq_message& msg);
+    bool process_flush(u32 vqid, virtio_blk_req& req, vq_message& msg);
     bool process_get_id(virtio_blk_req& req, vq_message& msg);
     bool process_discard(virtio_blk_req& req, vq_message& msg);
     bool process_write_zeroes(virtio_blk_req& req, vq_message& msg);
@@ -87,6 +99,7 @@ public:
     property<u32> max_size;
     property<u32> max_discard_sectors;
     property<u32> max_write_zeroes_sectors;
+    property<u16> num_queues;
 
     block::disk disk;
 
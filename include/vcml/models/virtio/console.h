@@ -31,6 +31,7 @@ private:
         VIRTQUEUE_DATA_TX = 1,
         VIRTQUEUE_CTRL_RX = 2,
         VIRTQUEUE_CTRL_TX = 3,
+        VIRTQUEUE_PORT_BASE = 4, // rx/tx pairs of ports 1 and up
     };
 
     enum features : u64 {
@@ -46,7 +47,49 @@ private:
         u32 emerg_write;
     } m_config;
 
-    queue<vq_message> m_fifo;
+    enum control_events : u16 {
+        VIRTIO_CONSOLE_DEVICE_READY = 0,
+        VIRTIO_CONSOLE_DEVICE_ADD = 1,
+        VIRTIO_CONSOLE_DEVICE_REMOVE = 2,
+        VIRTIO_CONSOLE_PORT_READY = 3,
+        VIRTIO_CONSOLE_CONSOLE_PORT = 4,
+        VIRTIO_CONSOLE_RESIZE = 5,
+        VIRTIO_CONSOLE_PORT_OPEN = 6,
+        VIRTIO_CONSOLE_PORT_NAME = 7,
+    };
+
+    struct console_control {
+        u32 id;
+        u16 event;
+        u16 value;
+    };
+
+    struct port_state {
+        bool open; // guest has the port opened
+        queue<vq_message> rxbufs;
+        serial_fifo rxfifo;
+    };
+
+    bool m_multiport;
+    vector<port_state> m_ports;
+    queue<vq_message> m_ctrl_bufs;
+    queue<vector<u8>> m_ctrl_msgs;
+    sc_event m_rx_ev;
+
+    static u32 port_rxq(u32 port);
+    static u32 port_txq(u32 port);
+    bool lookup_port(u32 vqid, u32& port, bool& tx) const;
+
+    serial_initiator_socket& port_out(u32 port);
+    string port_name(u32 port) const;
+
+    void send_control(u32 id, u16 event, u16 value, const string& s = "");
+    bool flush_control();
+    void handle_control(vq_message& msg);
+
+    bool receive_port(u32 port, const u8* data, size_t size);
+    bool flush_port(u32 port);
+    void flush_rx();
 
     // virtio_device
     virtual void identify(virtio_device_desc& desc) override;
@@ -59,17 +102,28 @@ private:
     virtual bool write_config(const range& addr, const void* ptr) override;
 
     // serial_host
-    virtual void serial_receive(u8 data) override;
+    virtual void serial_receive(const serial_target_socket& socket,
+                                serial_payload& tx) override;
+    virtual void serial_receive(const serial_target_socket& socket,
+                                u8 data) override;
 
 public:
     property<u16> cols;
     property<u16> rows;
 
+    property<u32> ports;
+    property<vector<string>> names;
+    property<size_t> rxbuf_size;
+
     virtio_target_socket virtio_in;
 
+    // port 0 is the console, all further ports use the socket arrays
     serial_initiator_socket serial_tx;
     serial_target_socket serial_rx;
 
+    serial_initiator_array port_tx;
+    serial_target_array port_rx;
+
     console(const sc_module_name& nm);
     virtual ~console();
     VCML_KIND(virtio::console);
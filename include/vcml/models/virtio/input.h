@@ -33,6 +33,7 @@ private:
     enum virtqueues : int {
         VIRTQUEUE_EVENT = 0,
         VIRTQUEUE_STATUS = 1,
+        VIRTQUEUE_SIZE = 64,
     };
 
     struct input_event {
@@ -85,22 +86,25 @@ private:
     ui::pointer m_pointer;
     ui::console m_console;
 
-    queue<input_event> m_events;
+    deque<input_event> m_events;
     queue<vq_message> m_messages;
+    sc_event m_update_ev;
 
     void push_key(u16 key, u32 down) {
-        m_events.push({ ui::EV_KEY, key, down });
+        m_events.push_back({ ui::EV_KEY, key, down });
     }
 
     void push_rel(u16 axis, u32 val) {
-        m_events.push({ ui::EV_REL, axis, val });
+        m_events.push_back({ ui::EV_REL, axis, val });
     }
 
     void push_abs(u16 axis, u32 val) {
-        m_events.push({ ui::EV_ABS, axis, val });
+        m_events.push_back({ ui::EV_ABS, axis, val });
     }
 
-    void push_sync() { m_events.push({ ui::EV_SYN, ui::SYN_REPORT, 0 }); }
+    void push_sync() {
+        m_events.push_back({ ui::EV_SYN, ui::SYN_REPORT, 0 });
+    }
 
     void config_update_name();
     void config_update_serial();
@@ -111,6 +115,9 @@ private:
 
     void config_update();
 
+    size_t report_length() const;
+    bool deliver_report();
+
     void update();
 
     virtual void identify(virtio_device_desc& desc) override;
@@ -127,7 +134,7 @@ public:
     const property<bool> keyboard;
     const property<bool> mouse;
 
-    const property<u64> pollrate;
+    const property<u64> pollrate; // ignored, input is event driven
 
     const property<string> keymap;
 
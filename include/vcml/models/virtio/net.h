@@ -33,14 +33,22 @@ public:
     };
 
     enum features : u64 {
+        VIRTIO_NET_F_CSUM = bit(0),
+        VIRTIO_NET_F_GUEST_CSUM = bit(1),
         VIRTIO_NET_F_MTU = bit(3),
         VIRTIO_NET_F_MAC = bit(5),
+        VIRTIO_NET_F_GUEST_TSO4 = bit(7),
+        VIRTIO_NET_F_GUEST_TSO6 = bit(8),
+        VIRTIO_NET_F_HOST_TSO4 = bit(11),
+        VIRTIO_NET_F_HOST_TSO6 = bit(12),
+        VIRTIO_NET_F_MRG_RXBUF = bit(15),
         VIRTIO_NET_F_STATUS = bit(16),
         VIRTIO_NET_F_CTRL_VQ = bit(17),
         VIRTIO_NET_F_CTRL_RX = bit(18),
         VIRTIO_NET_F_CTRL_VLAN = bit(19),
         VIRTIO_NET_F_CTRL_RX_EXTRA = bit(20),
         VIRTIO_NET_F_CTRL_ANNOUNCE = bit(21),
+        VIRTIO_NET_F_MQ = bit(22),
         VIRTIO_NET_F_CTRL_MAC_ADDR = bit(23),
     };
 
@@ -53,6 +61,19 @@ private:
     } m_config;
 
     mac_addr m_mac;
+    u64 m_features;
+    u16 m_pairs;
+
+    struct queue_stats {
+        u64 rx_packets;
+        u64 rx_bytes;
+        u64 rx_dropped;
+        u64 tx_packets;
+        u64 tx_bytes;
+        u64 tx_errors;
+    };
+
+    vector<queue_stats> m_stats;
 
     bool m_promisc;
     bool m_allmulti;
@@ -69,13 +90,19 @@ private:
 
     bool filter(const eth_frame& frame);
 
+    u32 ctrl_queue() const;
+    u32 rx_queue(const eth_frame& frame) const;
+
     void handle_ctrl();
     void handle_ctrl_rx(vq_message& msg);
     void handle_ctrl_announce(vq_message& msg);
     void handle_ctrl_mac_addr(vq_message& msg);
+    void handle_ctrl_mq(vq_message& msg);
 
-    bool handle_rx(vq_message& msg, eth_frame& frame);
-    bool handle_tx(vq_message& msg);
+    bool handle_rx(u32 vqid, const eth_frame& frame);
+    bool handle_tx(u32 vqid, vq_message& msg);
+
+    bool cmd_stats(const vector<string>& args, ostream& os);
 
     void rx_thread();
     void tx_thread();
@@ -89,6 +116,8 @@ private:
     virtual bool read_config(const range& addr, void* ptr) override;
     virtual bool write_config(const range& addr, const void* ptr) override;
 
+    virtual u32 eth_rx_offloads() const override;
+
     virtual void eth_link_up() override;
     virtual void eth_link_down() override;
     virtual void eth_receive(const eth_frame& frame) override;
@@ -96,6 +125,7 @@ private:
 public:
     property<string> mac;
     property<u16> mtu;
+    property<u16> queues;
 
     virtio_target_socket virtio_in;
     eth_initiator_socket eth_tx;
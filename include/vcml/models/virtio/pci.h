@@ -64,6 +64,12 @@ private:
 
     unordered_map<u32, virtqueue*> m_queues;
 
+    size_t m_batched;
+    sc_event m_flush_ev;
+
+    deque<u32> m_pending_vqs;
+    sc_event m_notify_ev;
+
     cap_virtio* m_cap_common;
     cap_virtio* m_cap_notify;
     cap_virtio* m_cap_isr;
@@ -72,9 +78,13 @@ private:
     void enable_virtqueue(u32 vqid);
     void disable_virtqueue(u32 vqid);
     void cleanup_virtqueues();
+    void flush_virtqueues();
+    void notify_virtqueue(u32 vqid);
+    void notify_thread();
 
     virtual bool get(u32 vqid, vq_message& msg) override;
     virtual bool put(u32 vqid, vq_message& msg) override;
+    virtual bool put_batch(u32 vqid, vector<vq_message>& msgs) override;
 
     virtual bool notify() override;
 
@@ -112,6 +122,16 @@ public:
     property<bool> use_packed_queues;
     property<bool> use_strong_barriers;
 
+    // used buffers are signalled to the driver once irq_batch of them have
+    // been collected or irq_delay after the first one, 0 disables batching
+    property<size_t> irq_batch;
+    property<sc_time> irq_delay;
+
+    // with async_notify, writes to queue_notify only mark the virtqueue as
+    // pending and return right away, the device then serves it from a
+    // separate process in the order the notifications came in
+    property<bool> async_notify;
+
     property<unsigned int> msix_vectors;
     property<unsigned int> virtio_bar;
     property<unsigned int> msix_bar;
@@ -16,6 +16,7 @@
 #include "vcml/core/range.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/entropy.h"
 
 #include "vcml/protocols/virtio.h"
 
@@ -25,6 +26,8 @@ namespace virtio {
 class rng : public module, public virtio_device
 {
 private:
+    entropy_pool m_pool;
+
     enum virtqueues : int {
         VIRTQUEUE_REQUEST = 0,
     };
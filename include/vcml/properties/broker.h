@@ -14,20 +14,51 @@
 #include "vcml/core/types.h"
 #include "vcml/core/systemc.h"
 
+#include <typeindex>
+
 namespace vcml {
 
 class broker
 {
+private:
+    // shared index over the key value stores of all brokers, so that
+    // property initialization only needs a single lookup
+    class key_index;
+    static key_index& shared_index();
+
+    void define_value(const string& key, const string& val, size_t uses);
+
+    // like init, val points to the stored value if there is one
+    static broker* find(const string& key, string& str, struct value*& val);
+
 protected:
     struct value {
         string value;
         size_t uses;
+
+        // parsed forms of value by element type, shared between all the
+        // properties initialized from it, dropped when value gets redefined
+        unordered_map<std::type_index, shared_ptr<const void>> parsed;
+
+        // set while ${...} in value still needs to be expanded, which
+        // happens on first lookup, origin is used for error messages
+        bool deferred;
+        string origin;
     };
 
     string m_name;
     std::map<string, struct value> m_values;
 
     string expand(const string& s);
+    void expand_deferred(const string& key, struct value& val);
+
+    // like define, but only expands the value once it is looked up
+    void define_deferred(const string& key, const string& val,
+                         const string& origin);
+
+    // brokers that override lookup must return false here, otherwise
+    // properties are initialized from their key value store directly
+    virtual bool indexed() const { return true; }
 
 public:
     const char* name() const { return m_name.c_str(); }
@@ -51,6 +82,16 @@ public:
     template <typename T>
     static T get_or_default(const string& key, const T& def = T());
 
+    // splits s into elements and converts each of them to T
+    template <typename T>
+    static vector<T> parse(const string& s);
+
+    // like init, but parses the value only once for all properties that
+    // share the same broker key, e.g. via patterns like *.cpuarch
+    template <typename T>
+    static broker* init_parsed(const string& key,
+                               shared_ptr<const vector<T>>& values);
+
     static vector<pair<string, broker*>> collect_unused();
     static void report_unused();
 };
@@ -63,11 +104,7 @@ inline void broker::define(const string& key, const T& val, size_t uses) {
 template <>
 inline void broker::define(const string& key, const string& val, size_t uses) {
     if (!key.empty())
-        m_values[expand(key)] = { expand(val), uses };
-}
-
-inline void broker::undefine(const string& key) {
-    m_values.erase(key);
+        define_value(expand(key), expand(val), uses);
 }
 
 template <typename T>
@@ -82,6 +119,36 @@ inline broker* broker::init(const string& key, T& value) {
 template <>
 broker* broker::init(const string& key, string& value);
 
+template <typename T>
+inline vector<T> broker::parse(const string& s) {
+    vector<string> args = split(s);
+    vector<T> values(args.size());
+    for (size_t i = 0; i < args.size(); i++)
+        values[i] = from_string<T>(trim(args[i]));
+    return values;
+}
+
+template <typename T>
+inline broker* broker::init_parsed(const string& key,
+                                   shared_ptr<const vector<T>>& values) {
+    string str;
+    struct value* val = nullptr;
+    broker* brkr = find(key, str, val);
+    if (brkr == nullptr)
+        return nullptr;
+
+    if (val == nullptr) {
+        values = std::make_shared<const vector<T>>(parse<T>(str));
+        return brkr;
+    }
+
+    shared_ptr<const void>& parsed = val->parsed[typeid(T)];
+    if (!parsed)
+        parsed = std::make_shared<const vector<T>>(parse<T>(str));
+    values = std::static_pointer_cast<const vector<T>>(parsed);
+    return brkr;
+}
+
 template <typename T>
 inline T broker::get_or_default(const string& key, const T& defval) {
     T val = defval;
@@ -17,6 +17,9 @@ namespace vcml {
 
 class broker_env : public broker
 {
+protected:
+    virtual bool indexed() const override { return false; }
+
 public:
     broker_env();
     virtual ~broker_env();
@@ -13,6 +13,8 @@
 
 #include "vcml/properties/broker.h"
 
+#include <string_view>
+
 namespace vcml {
 
 class broker_file : public broker
@@ -30,11 +32,20 @@ private:
 
     std::deque<loopdesc> m_loops;
 
-    void parse_file(const string& filename);
-    void parse_expr(const string& expr, const string& file, size_t line);
-    void parse_loop(const string& expr, const string& file, size_t line);
-    void parse_done(const string& expr, const string& file, size_t line);
+    // statements are parsed from views into the mapped file, col is the
+    // column where the statement starts, for reporting errors
+    typedef std::string_view strview;
 
+    void parse_file(const string& filename);
+    void parse_text(const char* text, size_t size, const string& file);
+    void parse_expr(strview expr, const string& file, size_t line,
+                    size_t col);
+    void parse_loop(strview expr, const string& file, size_t line,
+                    size_t col);
+    void parse_done(strview expr, const string& file, size_t line,
+                    size_t col);
+
+    bool is_volatile(strview val) const;
     void resolve(const string&, const string&, const string&, size_t);
 
 public:
@@ -15,8 +15,15 @@
 
 namespace vcml {
 
+// if VCML_LUA_CACHE names a directory, the keys defined by a script are
+// stored there after its first run and replayed on later startups as long
+// as the script, the environment and the keys it looked up are unchanged
 class broker_lua : public broker
 {
+private:
+    void evaluate(const string& file);
+    bool load_cache(const string& path, u64 hash);
+
 public:
     broker_lua() = delete;
     broker_lua(const string& filename);
@@ -29,6 +29,8 @@ private:
 
     mutable string m_str;
 
+    void assign(const vector<T>& values);
+
 public:
     property(const char* nm, const T& def = T());
     property(sc_object* parent, const char* nm, const T& def = T());
@@ -139,9 +141,18 @@ inline void property<T, N>::reset() {
     for (size_t i = 0; i < N; i++)
         m_value[i] = m_defval;
 
+    shared_ptr<const vector<T>> init;
+    if (broker::init_parsed(fullname(), init))
+        assign(*init);
+}
+
+template <>
+inline void property<string, 1>::reset() {
+    m_value[0] = m_defval;
+
     string init;
     if (broker::init(fullname(), init))
-        property<T, N>::str(init);
+        property<string, 1>::str(init);
 }
 
 template <typename T, size_t N>
@@ -166,10 +177,9 @@ inline const char* property<string, 1>::str() const {
 }
 
 template <typename T, size_t N>
-inline void property<T, N>::str(const string& s) {
+inline void property<T, N>::assign(const vector<T>& values) {
     m_inited = true;
-    vector<string> args = split(s);
-    size_t size = args.size();
+    size_t size = values.size();
 
     if (size < N) {
         log_warn("property %s has not enough initializers", name().c_str());
@@ -178,7 +188,12 @@ inline void property<T, N>::str(const string& s) {
     }
 
     for (size_t i = 0; i < min(N, size); i++)
-        m_value[i] = from_string<T>(trim(args[i]));
+        m_value[i] = values[i];
+}
+
+template <typename T, size_t N>
+inline void property<T, N>::str(const string& s) {
+    assign(broker::parse<T>(s));
 }
 
 template <>
@@ -454,6 +469,8 @@ private:
 
     mutable string m_str;
 
+    void assign(const vector<u64>& values);
+
 public:
     property(const char* nm, size_t size, size_t count = N, u64 defval = 0);
     property(sc_object* parent, const char* nm, size_t size, size_t count = N,
@@ -533,9 +550,9 @@ inline void property<void, N>::reset() {
     m_inited = false;
     set_default(m_default);
 
-    string init;
-    if (broker::init(fullname(), init))
-        property<void, N>::str(init);
+    shared_ptr<const vector<u64>> init;
+    if (broker::init_parsed(fullname(), init))
+        assign(*init);
 }
 
 template <size_t N>
@@ -554,11 +571,9 @@ inline const char* property<void, N>::str() const {
 }
 
 template <size_t N>
-inline void property<void, N>::str(const string& s) {
+inline void property<void, N>::assign(const vector<u64>& values) {
     m_inited = true;
-
-    vector<string> args = split(s);
-    size_t count = args.size();
+    size_t count = values.size();
 
     if (count < m_count) {
         log_warn("property %s has not enough initializers", name().c_str());
@@ -568,7 +583,7 @@ inline void property<void, N>::str(const string& s) {
 
     u8* ptr = m_data;
     for (size_t i = 0; i < min(m_count, count); i++, ptr += m_size) {
-        u64 val = from_string<u64>(trim(args[i]));
+        u64 val = values[i];
         if (mwr::encode_size(val) / 8u > m_size) {
             log_warn("property %s initialization value too big: 0x%llx",
                      name().c_str(), val);
@@ -577,6 +592,11 @@ inline void property<void, N>::str(const string& s) {
     }
 }
 
+template <size_t N>
+inline void property<void, N>::str(const string& s) {
+    assign(broker::parse<u64>(s));
+}
+
 template <size_t N>
 inline const char* property<void, N>::type() const {
     switch (m_size) {
@@ -757,9 +777,9 @@ inline void property<vector<T>, 1>::reset() {
     m_inited = false;
     set_default(m_def);
 
-    string init;
-    if (broker::init(fullname(), init))
-        property<vector<T>, 1>::str(init);
+    shared_ptr<const vector<T>> init;
+    if (broker::init_parsed(fullname(), init))
+        set(*init);
 }
 
 template <typename T>
@@ -779,14 +799,7 @@ inline const char* property<vector<T>, 1>::str() const {
 
 template <typename T>
 inline void property<vector<T>, 1>::str(const string& s) {
-    m_inited = true;
-
-    vector<string> args = split(s);
-    size_t size = args.size();
-
-    m_val.resize(size);
-    for (size_t i = 0; i < size; i++)
-        m_val[i] = from_string<T>(trim(args[i]));
+    set(broker::parse<T>(s));
 }
 
 template <typename T>
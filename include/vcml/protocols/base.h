@@ -37,12 +37,21 @@ public:
     property<bool> trace_all;
     property<bool> trace_errors;
 
+private:
+    // refer to the property values directly, so they are always up to date
+    // without going through the property accessors on every transaction
+    const bool& m_trace_all;
+    const bool& m_trace_errors;
+
+public:
     base_socket() = delete;
     base_socket(sc_object* port, address_space space):
         m_port(port),
         as(space),
         trace_all(port, "trace", false),
-        trace_errors(port, "trace_errors", false) {
+        trace_errors(port, "trace_errors", false),
+        m_trace_all(trace_all.get()),
+        m_trace_errors(trace_errors.get()) {
         trace_all.inherit_default();
         trace_errors.inherit_default();
     }
@@ -54,13 +63,15 @@ public:
 protected:
     template <typename PAYLOAD>
     void trace_fw(const PAYLOAD& tx, const sc_time& t = SC_ZERO_TIME) {
-        if (trace_all)
+        if (tracer::any() && m_trace_all)
             tracer::record(TRACE_FW, *m_port, tx, t);
     }
 
     template <typename PAYLOAD>
     void trace_bw(const PAYLOAD& tx, const sc_time& t = SC_ZERO_TIME) {
-        if (trace_all || (trace_errors && failed(tx)))
+        if (!tracer::any())
+            return;
+        if (m_trace_all || (m_trace_errors && failed(tx)))
             tracer::record(TRACE_BW, *m_port, tx, t);
     }
 };
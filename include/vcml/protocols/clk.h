@@ -33,6 +33,58 @@ constexpr bool failed(const clk_payload& tx) {
 
 ostream& operator<<(ostream& os, const clk_payload& clk);
 
+// frequency shared by an initiator and all targets bound to it; the cycle
+// time is only recomputed on first use after the generation has changed and
+// also kept in time resolution units for integer arithmetic in hot paths
+class clk_domain
+{
+private:
+    hz_t m_hz;
+    u64 m_generation;
+    mutable u64 m_cached;
+    mutable u64 m_ticks;
+    mutable sc_time m_cycle;
+
+    void update() const;
+
+public:
+    hz_t hz() const { return m_hz; }
+    u64 generation() const { return m_generation; }
+
+    clk_domain(hz_t hz = 0):
+        m_hz(hz), m_generation(0), m_cached(~0ull), m_ticks(0), m_cycle() {}
+
+    void set(hz_t hz);
+    const sc_time& cycle() const;
+    u64 cycle_ticks() const;
+    sc_time cycles(u64 n) const { return time_from_value(cycle_ticks() * n); }
+};
+
+inline void clk_domain::set(hz_t hz) {
+    if (hz != m_hz) {
+        m_hz = hz;
+        m_generation++;
+    }
+}
+
+inline void clk_domain::update() const {
+    m_cycle = m_hz ? sc_time(1.0 / m_hz, SC_SEC) : SC_ZERO_TIME;
+    m_ticks = m_cycle.value();
+    m_cached = m_generation;
+}
+
+inline const sc_time& clk_domain::cycle() const {
+    if (m_cached != m_generation)
+        update();
+    return m_cycle;
+}
+
+inline u64 clk_domain::cycle_ticks() const {
+    if (m_cached != m_generation)
+        update();
+    return m_ticks;
+}
+
 class clk_fw_transport_if : public sc_core::sc_interface
 {
 public:
@@ -45,6 +97,7 @@ class clk_bw_transport_if : public sc_core::sc_interface
 public:
     typedef clk_payload protocol_types;
     virtual hz_t clk_get_hz() = 0;
+    virtual const clk_domain* clk_get_domain() { return nullptr; }
 };
 
 class clk_base_initiator_socket;
@@ -113,35 +166,35 @@ public:
     virtual ~clk_initiator_socket() = default;
     VCML_KIND(clk_initiator_socket);
 
-    hz_t get() const { return m_hz; }
+    hz_t get() const { return m_domain.hz(); }
     void set(hz_t hz);
 
     operator hz_t() const { return get(); }
     clk_initiator_socket& operator=(hz_t hz);
 
-    sc_time cycle() const;
-    sc_time cycles(size_t n) const { return cycle() * n; }
+    const sc_time& cycle() const { return m_domain.cycle(); }
+    sc_time cycles(size_t n) const { return m_domain.cycles(n); }
+    u64 cycle_ticks() const { return m_domain.cycle_ticks(); }
+
+    const clk_domain& domain() const { return m_domain; }
 
 private:
     clk_host* m_host;
-    hz_t m_hz;
+    clk_domain m_domain;
 
     struct clk_bw_transport : public clk_bw_transport_if {
         clk_initiator_socket* socket;
         clk_bw_transport(clk_initiator_socket* s):
             clk_bw_transport_if(), socket(s) {}
         hz_t clk_get_hz() override { return socket->get(); }
+        const clk_domain* clk_get_domain() override {
+            return &socket->m_domain;
+        }
     } m_transport;
 
     void clk_transport(const clk_payload& tx);
 };
 
-inline sc_time clk_initiator_socket::cycle() const {
-    if (m_hz == 0)
-        return SC_ZERO_TIME;
-    return sc_time(1.0 / m_hz, SC_SEC);
-}
-
 class clk_target_socket : public clk_base_target_socket
 {
 public:
@@ -157,10 +210,17 @@ public:
     operator hz_t() const { return read(); }
 
     sc_time cycle() const;
-    sc_time cycles(size_t n) const { return cycle() * n; }
+    sc_time cycles(size_t n) const;
+    u64 cycle_ticks() const;
+
+    // changes whenever the frequency of the bound initiator changes
+    u64 generation() const;
 
 private:
     clk_host* m_host;
+    mutable const clk_domain* m_domain;
+
+    const clk_domain* domain() const;
 
     struct clk_fw_transport : public clk_fw_transport_if {
         clk_target_socket* socket;
@@ -187,9 +247,12 @@ using clk_target_array = socket_array<clk_target_socket>;
 class clk_initiator_stub : private clk_bw_transport_if
 {
 private:
-    hz_t m_hz;
+    clk_domain m_domain;
 
-    virtual hz_t clk_get_hz() override { return m_hz; }
+    virtual hz_t clk_get_hz() override { return m_domain.hz(); }
+    virtual const clk_domain* clk_get_domain() override {
+        return &m_domain;
+    }
 
 public:
     clk_base_initiator_socket clk_out;
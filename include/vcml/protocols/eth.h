@@ -12,6 +12,7 @@
 #define VCML_PROTOCOLS_ETH_H
 
 #include "vcml/core/types.h"
+#include "vcml/core/crc.h"
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 
@@ -56,7 +57,7 @@ struct mac_addr {
 
     bool is_unicast() const { return !is_multicast() && !is_broadcast(); }
 
-    u32 hash_crc32() const { return crc32(bytes.data(), 6); }
+    u32 hash_crc32() const { return crc32_eth(bytes.data(), 6); }
 
     string to_string() const;
 
@@ -68,11 +69,37 @@ struct mac_addr {
     }
 };
 
-struct eth_frame : public vector<u8> {
+// offloads a receiver can finish on its own, frames that use any offloads
+// beyond those are completed in software on their way to that receiver
+enum eth_offloads : u32 {
+    ETH_OFFLOAD_NONE = 0,
+    ETH_OFFLOAD_CSUM = bit(0),
+    ETH_OFFLOAD_TSO4 = bit(1),
+    ETH_OFFLOAD_TSO6 = bit(2),
+    ETH_OFFLOAD_ALL = ETH_OFFLOAD_CSUM | ETH_OFFLOAD_TSO4 | ETH_OFFLOAD_TSO6,
+};
+
+struct eth_buffer;
+
+// frame data lives in pooled, reference counted buffers: copies of a frame
+// share its data until either of them is modified (copy on write); each
+// buffer keeps some headroom in front so that headers can be prepended
+// without having to move the frame data
+struct eth_frame {
+private:
+    eth_buffer* m_buf;
+    size_t m_head;
+    size_t m_size;
+
+    void make_writable(size_t size);
+    mac_addr address(size_t offset) const;
+
+public:
     enum : size_t {
         FRAME_HEADER_SIZE = 14,
         FRAME_MIN_SIZE = 64,
         FRAME_MAX_SIZE = 1522,
+        FRAME_HEADROOM = 64,
     };
 
     enum : u16 {
@@ -91,18 +118,66 @@ struct eth_frame : public vector<u8> {
         IP_UDP = 0x11,
     };
 
-    eth_frame() = default;
-    eth_frame(eth_frame&&) = default;
-    eth_frame(const eth_frame&) = default;
-    eth_frame(size_t length): vector<u8>(length) {}
+    enum : u8 {
+        GSO_NONE = 0,
+        GSO_TCPV4 = 1,
+        GSO_TCPV6 = 4,
+    };
+
+    // offload metadata, follows the semantics of virtio_net_hdr: with
+    // csum_partial, the checksum field at csum_start + csum_offset holds the
+    // pseudo header sum and still needs to be completed; gso frames carry
+    // one large tcp segment that still needs to be split into gso_size
+    // chunks of payload
+    bool csum_partial = false;
+    bool csum_valid = false;
+    u16 csum_start = 0;
+    u16 csum_offset = 0;
+    u8 gso_type = GSO_NONE;
+    u16 gso_size = 0;
+
+    eth_frame();
+    eth_frame(eth_frame&& other) noexcept;
+    eth_frame(const eth_frame& other);
+    eth_frame(size_t length);
     eth_frame(const vector<u8>& raw);
-    eth_frame(vector<u8>&& frame);
     eth_frame(const u8* data, size_t len);
     eth_frame(const mac_addr& dest, const mac_addr& src,
               const vector<u8>& payload);
+    ~eth_frame();
+
+    eth_frame& operator=(const eth_frame& other);
+    eth_frame& operator=(eth_frame&& other) noexcept;
+
+    bool operator==(const eth_frame& other) const;
+    bool operator!=(const eth_frame& other) const { return !(*this == other); }
 
-    eth_frame& operator=(const eth_frame&) = default;
-    eth_frame& operator=(eth_frame&&) = default;
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool shared() const;
+
+    // non-const access unshares the frame data first
+    const u8* data() const;
+    u8* data();
+
+    const u8* begin() const { return data(); }
+    const u8* end() const { return data() + m_size; }
+
+    u8 operator[](size_t i) const { return data()[i]; }
+    u8& operator[](size_t i) { return data()[i]; }
+
+    u8 at(size_t i) const;
+    u8& at(size_t i);
+
+    void resize(size_t size);
+    void push_back(u8 val);
+    void clear();
+
+    // grows the frame at the front, uses the headroom unless it is shared
+    u8* prepend(size_t n);
+    void pull(size_t n);
+
+    static size_t pool_size();
 
     template <typename T>
     T read(size_t offset) const {
@@ -114,14 +189,18 @@ struct eth_frame : public vector<u8> {
 
     u16 ether_type() const;
 
+    // same value for all frames of one tcp/udp flow, or for all frames
+    // between two stations for non-ip traffic
+    u32 flow_hash() const;
+
     size_t payload_size() const { return size() - FRAME_HEADER_SIZE; }
     u8* payload() { return data() + FRAME_HEADER_SIZE; }
     const u8* payload() const { return data() + FRAME_HEADER_SIZE; }
     u8& payload(size_t i) { return at(FRAME_HEADER_SIZE + i); }
     u8 payload(size_t i) const { return at(FRAME_HEADER_SIZE + i); }
 
-    mac_addr destination() const { return mac_addr(*this, 0); }
-    mac_addr source() const { return mac_addr(*this, 6); }
+    mac_addr destination() const { return address(0); }
+    mac_addr source() const { return address(6); }
 
     bool is_multicast() const { return destination().is_multicast(); }
     bool is_broadcast() const { return destination().is_broadcast(); }
@@ -133,6 +212,11 @@ struct eth_frame : public vector<u8> {
 
     string identify() const;
 
+    u32 offloads() const;
+    bool complete_checksum();
+    bool segment(vector<eth_frame>& segments) const;
+    bool resolve_offloads(vector<eth_frame>& frames) const;
+
     bool is_nc() const;
     bool is_avtp() const;
 
@@ -182,6 +266,8 @@ public:
     eth_host(const eth_host&) = delete;
 
 protected:
+    virtual u32 eth_rx_offloads() const { return ETH_OFFLOAD_NONE; }
+
     virtual void eth_receive(const eth_target_socket&, const eth_frame& frame);
     virtual void eth_receive(const eth_frame& frame);
     virtual bool eth_rx_pop(eth_frame& frame);
@@ -265,6 +351,8 @@ class eth_initiator_socket : public eth_base_initiator_socket
 private:
     bool m_link_up;
     eth_host* m_host;
+    u64 m_num_frames;
+    u64 m_num_bytes;
 
     struct eth_bw_transport : eth_bw_transport_if {
         eth_initiator_socket* socket;
@@ -281,6 +369,10 @@ public:
     virtual ~eth_initiator_socket();
     VCML_KIND(eth_initiator_socket);
 
+    // frames and bytes sent while the link was up
+    u64 num_frames() const { return m_num_frames; }
+    u64 num_bytes() const { return m_num_bytes; }
+
     void send(const vector<u8>& data);
     void send(eth_frame& frame);
 };
@@ -290,6 +382,8 @@ class eth_target_socket : public eth_base_target_socket
 private:
     bool m_link_up;
     eth_host* m_host;
+    u64 m_num_frames;
+    u64 m_num_bytes;
 
     struct eth_fw_transport : eth_fw_transport_if {
         eth_target_socket* socket;
@@ -310,6 +404,10 @@ public:
     eth_target_socket(const char* name, address_space as = VCML_AS_DEFAULT);
     virtual ~eth_target_socket();
     VCML_KIND(eth_target_socket);
+
+    // frames and bytes received while the link was up
+    u64 num_frames() const { return m_num_frames; }
+    u64 num_bytes() const { return m_num_bytes; }
 };
 
 class eth_initiator_stub : private eth_bw_transport_if
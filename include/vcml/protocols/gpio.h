@@ -37,6 +37,12 @@ class gpio_fw_transport_if : public sc_core::sc_interface
 public:
     typedef gpio_payload protocol_types;
     virtual void gpio_transport(gpio_payload& tx) = 0;
+
+    // receivers that can handle many lines at once should override this
+    virtual void gpio_transport_bulk(gpio_payload* tx, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            gpio_transport(tx[i]);
+    }
 };
 
 class gpio_bw_transport_if : public sc_core::sc_interface
@@ -136,6 +142,10 @@ public:
     operator bool() const { return read(GPIO_NO_VECTOR); }
     void write(bool state, gpio_vector vector = GPIO_NO_VECTOR);
 
+    // updates many vectors in a single transport, skipping unchanged ones
+    void write(const vector<gpio_payload>& states);
+    void write(const gpio_payload* states, size_t count);
+
     void raise(gpio_vector vector = GPIO_NO_VECTOR);
     void lower(gpio_vector vector = GPIO_NO_VECTOR);
     void pulse(gpio_vector vector = GPIO_NO_VECTOR);
@@ -150,6 +160,12 @@ private:
     gpio_host* m_host;
     sc_event* m_event;
     unordered_map<gpio_vector, gpio_state_tracker> m_state;
+    gpio_state_tracker* m_default;
+
+    // reused by bulk writes, nested writes from within a target callback
+    // fall back to a buffer of their own
+    vector<gpio_payload> m_changed;
+    bool m_changing;
 
     struct gpio_bw_transport : public gpio_bw_transport_if {
         mutable gpio_initiator_socket* socket;
@@ -188,6 +204,7 @@ private:
     gpio_host* m_host;
     sc_event* m_event;
     unordered_map<gpio_vector, bool> m_state;
+    bool* m_default;
     gpio_base_initiator_socket* m_initiator;
     vector<gpio_base_target_socket*> m_targets;
 
@@ -200,12 +217,19 @@ private:
             socket->gpio_transport_internal(tx);
         }
 
+        virtual void gpio_transport_bulk(gpio_payload* tx,
+                                         size_t count) override {
+            socket->gpio_transport_bulk_internal(tx, count);
+        }
+
         virtual const sc_event& default_event() const override {
             return socket->default_event();
         }
     } m_transport;
 
+    bool update_state(const gpio_payload& gpio);
     void gpio_transport_internal(gpio_payload& gpio);
+    void gpio_transport_bulk_internal(gpio_payload* gpio, size_t count);
 
 protected:
     virtual void gpio_transport(gpio_payload& gpio);
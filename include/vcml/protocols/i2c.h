@@ -41,6 +41,18 @@ struct i2c_payload {
     u8 data;
 };
 
+// transfers a whole message from start to stop condition in one go; acks
+// receives one response per data byte and may be null, bytes following the
+// first failed one are not transferred and keep I2C_INCOMPLETE
+struct i2c_message {
+    u8 address;
+    tlm_command cmd;
+    u8* data;
+    size_t size;
+    i2c_response* acks;
+    i2c_response resp;
+};
+
 constexpr bool success(i2c_response resp) {
     return resp > 0;
 }
@@ -81,6 +93,11 @@ public:
     virtual i2c_response i2c_stop(const i2c_target_socket&) = 0;
     virtual i2c_response i2c_read(const i2c_target_socket&, u8& data) = 0;
     virtual i2c_response i2c_write(const i2c_target_socket&, u8 data) = 0;
+
+    // hosts without a message handler receive start, data and stop one
+    // after the other
+    virtual void i2c_transport(const i2c_target_socket& socket,
+                               i2c_message& msg);
 };
 
 class i2c_fw_transport_if : public sc_core::sc_interface
@@ -89,6 +106,7 @@ public:
     typedef i2c_payload protocol_types;
 
     virtual void i2c_transport(i2c_payload& tx) = 0;
+    virtual void i2c_transport(i2c_message& msg) = 0;
 };
 
 class i2c_bw_transport_if : public sc_core::sc_interface
@@ -154,8 +172,11 @@ public:
     i2c_response start(u8 address, tlm_command cmd = TLM_IGNORE_COMMAND);
     i2c_response stop();
     i2c_response transport(u8& data);
+    i2c_response transport(u8 address, tlm_command cmd, u8* data,
+                           size_t size, i2c_response* acks = nullptr);
 
     void transport(i2c_payload& tx);
+    void transport(i2c_message& msg);
 };
 
 class i2c_target_socket : public i2c_base_target_socket
@@ -174,9 +195,13 @@ private:
         virtual void i2c_transport(i2c_payload& tx) override {
             socket->i2c_transport(tx);
         }
+        virtual void i2c_transport(i2c_message& msg) override {
+            socket->i2c_transport(msg);
+        }
     } m_transport;
 
     void i2c_transport(i2c_payload& tx);
+    void i2c_transport(i2c_message& msg);
 
 public:
     u8 address() const { return m_address; }
@@ -199,6 +224,7 @@ class i2c_target_stub : private i2c_fw_transport_if
 {
 private:
     virtual void i2c_transport(i2c_payload& tx) override;
+    virtual void i2c_transport(i2c_message& msg) override;
 
 public:
     i2c_base_target_socket i2c_in;
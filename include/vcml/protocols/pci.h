@@ -108,6 +108,11 @@ inline bool failed(const pci_payload& tx) {
     return failed(tx.response);
 }
 
+enum pci_cfg_size : size_t {
+    PCI_CFG_SIZE = 256,
+    PCIE_CFG_SIZE = 4096,
+};
+
 enum pci_bar_status : u32 {
     PCI_BAR_MMIO = 0,
     PCI_BAR_IO = 1 << 0,
@@ -130,6 +135,7 @@ struct pci_bar {
         };
     };
     u64 size;
+    u8* memory; // host memory backing prefetchable bars, may be null
 
     u64 mask() const { return ~(size - 1); }
     bool is_mapped() const { return (addr_lo ^ -1) & mask(); }
@@ -254,6 +260,10 @@ public:
     virtual void pci_interrupt(const pci_initiator_socket& socket, pci_irq irq,
                                bool state) = 0;
 
+    // delivers a message signaled interrupt, defaults to a dma write
+    virtual bool pci_msi(const pci_initiator_socket& socket, u64 addr,
+                         u32 data);
+
 private:
     pci_initiator_sockets m_sockets;
 };
@@ -284,6 +294,7 @@ protected:
     virtual bool pci_dma_read(u64 addr, u64 size, void* data);
     virtual bool pci_dma_write(u64 addr, u64 size, const void* data);
     virtual void pci_interrupt(pci_irq irq, bool state);
+    virtual bool pci_msi(u64 addr, u32 data);
 
 private:
     pci_target_sockets m_sockets;
@@ -308,6 +319,10 @@ public:
     virtual bool pci_dma_read(u64 addr, u64 size, void* data) = 0;
     virtual bool pci_dma_write(u64 addr, u64 size, const void* data) = 0;
     virtual void pci_interrupt(pci_irq irq, bool state) = 0;
+
+    virtual bool pci_msi(u64 addr, u32 data) {
+        return pci_dma_write(addr, sizeof(data), &data);
+    }
 };
 
 typedef base_initiator_socket<pci_fw_transport_if, pci_bw_transport_if>
@@ -381,6 +396,10 @@ private:
         virtual void pci_interrupt(pci_irq irq, bool state) override {
             socket->m_initiator->pci_interrupt(*socket, irq, state);
         }
+
+        virtual bool pci_msi(u64 addr, u32 data) override {
+            return socket->m_initiator->pci_msi(*socket, addr, data);
+        }
     } m_transport;
 
 public:
@@ -12,6 +12,7 @@
 #define VCML_PROTOCOLS_SD_H
 
 #include "vcml/core/types.h"
+#include "vcml/core/crc.h"
 #include "vcml/core/systemc.h"
 
 #include "vcml/protocols/base.h"
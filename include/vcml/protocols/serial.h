@@ -67,8 +67,78 @@ struct serial_payload {
     serial_bits width;
     serial_parity parity;
     serial_stop stop;
+
+    // bulk transfers carry count symbols from buffer instead of data; they
+    // are considered free of parity errors
+    const u8* buffer = nullptr;
+    size_t count = 0;
+
+    bool is_bulk() const { return buffer != nullptr; }
+};
+
+// time it takes to transfer one symbol including start, parity and stop bits
+sc_time serial_symbol_time(const serial_payload& tx);
+
+// ring buffer for modeling uart fifos; entries hold a received symbol in
+// their lower bits and may carry device specific error flags above
+class serial_fifo
+{
+private:
+    vector<u16> m_data;
+    size_t m_head;
+    size_t m_size;
+
+public:
+    size_t capacity() const { return m_data.size(); }
+    size_t size() const { return m_size; }
+    size_t space() const { return capacity() - m_size; }
+
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == capacity(); }
+
+    serial_fifo(size_t capacity = 1): m_data(capacity), m_head(), m_size() {}
+
+    void clear() { m_head = m_size = 0; }
+    void resize(size_t capacity);
+
+    bool push(u16 val);
+    size_t push(const u8* data, size_t count, u32 mask = ~0u);
+
+    u16 front() const { return m_data[m_head]; }
+    u16 pop();
 };
 
+inline void serial_fifo::resize(size_t capacity) {
+    if (capacity != m_data.size())
+        m_data.assign(max<size_t>(capacity, 1), 0);
+    clear();
+}
+
+inline bool serial_fifo::push(u16 val) {
+    if (full())
+        return false;
+
+    m_data[(m_head + m_size++) % m_data.size()] = val;
+    return true;
+}
+
+inline size_t serial_fifo::push(const u8* data, size_t count, u32 mask) {
+    size_t n = min(count, space());
+    for (size_t i = 0; i < n; i++)
+        m_data[(m_head + m_size++) % m_data.size()] = data[i] & mask;
+    return n;
+}
+
+inline u16 serial_fifo::pop() {
+    if (empty())
+        return 0;
+
+    u16 val = m_data[m_head];
+    m_head = (m_head + 1) % m_data.size();
+    m_size--;
+    return val;
+}
+
 const char* serial_parity_str(serial_parity par);
 const char* serial_stop_str(serial_stop stop);
 
@@ -189,6 +259,7 @@ public:
     VCML_KIND(serial_initiator_socket);
 
     void send(u8 data);
+    void send(const u8* data, size_t size);
 
     void transport(serial_payload& tx);
 };
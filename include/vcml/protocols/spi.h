@@ -27,6 +27,15 @@ struct spi_payload {
 
 ostream& operator<<(ostream& os, const spi_payload& spi);
 
+// exchanges size bytes in one go while chip select stays asserted; mosi and
+// miso may point to the same buffer, mosi[i] is consumed before miso[i] is
+// stored and bytes no target answers keep their previous miso value
+struct spi_burst {
+    const u8* mosi;
+    u8* miso;
+    size_t size;
+};
+
 class spi_initiator_socket;
 class spi_target_socket;
 class spi_initiator_stub;
@@ -38,6 +47,10 @@ public:
     spi_host() = default;
     virtual ~spi_host() = default;
     virtual void spi_transport(const spi_target_socket&, spi_payload&) = 0;
+
+    // hosts without a bulk handler receive bursts one byte at a time
+    virtual void spi_transport(const spi_target_socket& socket,
+                               spi_burst& burst);
 };
 
 class spi_fw_transport_if : public sc_core::sc_interface
@@ -45,6 +58,7 @@ class spi_fw_transport_if : public sc_core::sc_interface
 public:
     typedef spi_payload protocol_types;
     virtual void spi_transport(spi_payload& spi) = 0;
+    virtual void spi_transport(spi_burst& burst) = 0;
 };
 
 class spi_bw_transport_if : public sc_core::sc_interface
@@ -107,6 +121,8 @@ public:
     VCML_KIND(spi_initiator_socket);
 
     void transport(spi_payload& spi);
+    void transport(spi_burst& burst);
+    void transport(const u8* mosi, u8* miso, size_t size);
 };
 
 class spi_target_socket : public spi_base_target_socket
@@ -121,9 +137,13 @@ private:
         virtual void spi_transport(spi_payload& spi) override {
             socket->spi_transport(spi);
         }
+        virtual void spi_transport(spi_burst& burst) override {
+            socket->spi_transport(burst);
+        }
     } m_transport;
 
     void spi_transport(spi_payload& spi);
+    void spi_transport(spi_burst& burst);
 
 public:
     spi_target_socket(const char* nm, address_space as = VCML_AS_DEFAULT);
@@ -146,6 +166,7 @@ class spi_target_stub : private spi_fw_transport_if
 {
 private:
     virtual void spi_transport(spi_payload& spi) override;
+    virtual void spi_transport(spi_burst& burst) override;
 
 public:
     spi_base_target_socket spi_in;
@@ -13,8 +13,12 @@
 
 #include "vcml/protocols/tlm_sbi.h"
 #include "vcml/protocols/tlm_exmon.h"
+#include "vcml/protocols/tlm_trace_filter.h"
+#include "vcml/protocols/tlm_gather.h"
 #include "vcml/protocols/tlm_memory.h"
+#include "vcml/protocols/tlm_shared.h"
 #include "vcml/protocols/tlm_dmi_cache.h"
+#include "vcml/protocols/tlm_heatmap.h"
 #include "vcml/protocols/tlm_adapters.h"
 #include "vcml/protocols/tlm_stubs.h"
 #include "vcml/protocols/tlm_base.h"
@@ -17,46 +17,100 @@
 
 namespace vcml {
 
+// adapters only change the bus width seen by systemc, which tlm payloads do
+// not carry, so callers may skip over them and talk to whatever sits behind
+class tlm_passthrough_if
+{
+public:
+    virtual ~tlm_passthrough_if() = default;
+    virtual tlm::tlm_fw_transport_if<>* fw_target() = 0;
+    virtual tlm::tlm_bw_transport_if<>* bw_target() = 0;
+};
+
+// returns the interface at the far end of a chain of adapters, only valid
+// once binding has completed at the end of elaboration
+inline tlm::tlm_fw_transport_if<>* tlm_passthrough_fw(
+    tlm::tlm_fw_transport_if<>* fw) {
+    tlm_passthrough_if* adapter = dynamic_cast<tlm_passthrough_if*>(fw);
+    return adapter ? adapter->fw_target() : fw;
+}
+
+inline tlm::tlm_bw_transport_if<>* tlm_passthrough_bw(
+    tlm::tlm_bw_transport_if<>* bw) {
+    tlm_passthrough_if* adapter = dynamic_cast<tlm_passthrough_if*>(bw);
+    return adapter ? adapter->bw_target() : bw;
+}
+
 template <unsigned int WIDTH_IN, unsigned int WIDTH_OUT>
-class tlm_bus_width_adapter : public module
+class tlm_bus_width_adapter : public module,
+                              public tlm::tlm_fw_transport_if<>,
+                              public tlm::tlm_bw_transport_if<>,
+                              public tlm_passthrough_if
 {
+private:
+    tlm::tlm_fw_transport_if<>* m_fw;
+    tlm::tlm_bw_transport_if<>* m_bw;
+
 public:
     typedef tlm_bus_width_adapter<WIDTH_IN, WIDTH_OUT> this_type;
-    simple_target_socket<tlm_bus_width_adapter, WIDTH_IN> in;
-    simple_initiator_socket<tlm_bus_width_adapter, WIDTH_OUT> out;
+    tlm::tlm_target_socket<WIDTH_IN> in;
+    tlm::tlm_initiator_socket<WIDTH_OUT> out;
 
     tlm_bus_width_adapter() = delete;
 
     tlm_bus_width_adapter(const sc_module_name& nm):
-        module(nm), in("in"), out("out") {
-        in.register_b_transport(this, &this_type::b_transport);
-        in.register_transport_dbg(this, &this_type::transport_dbg);
-        in.register_get_direct_mem_ptr(this, &this_type::get_direct_mem_ptr);
-        out.register_invalidate_direct_mem_ptr(
-            this, &this_type::invalidate_direct_mem_ptr);
+        module(nm), m_fw(nullptr), m_bw(nullptr), in("in"), out("out") {
+        in.bind(*this);
+        out.bind(*this);
     }
 
     virtual ~tlm_bus_width_adapter() = default;
 
     VCML_KIND(tlm_bus_width_adapter);
 
+    virtual tlm::tlm_fw_transport_if<>* fw_target() override {
+        if (m_fw == nullptr)
+            m_fw = tlm_passthrough_fw(out.operator->());
+        return m_fw;
+    }
+
+    virtual tlm::tlm_bw_transport_if<>* bw_target() override {
+        if (m_bw == nullptr)
+            m_bw = tlm_passthrough_bw(in.operator->());
+        return m_bw;
+    }
+
 private:
-    void b_transport(tlm_generic_payload& tx, sc_time& t) {
+    virtual void b_transport(tlm_generic_payload& tx, sc_time& t) override {
         trace_fw(out, tx, t);
-        out->b_transport(tx, t);
+        fw_target()->b_transport(tx, t);
         trace_bw(out, tx, t);
     }
 
-    unsigned int transport_dbg(tlm_generic_payload& tx) {
-        return out->transport_dbg(tx);
+    virtual unsigned int transport_dbg(tlm_generic_payload& tx) override {
+        return fw_target()->transport_dbg(tx);
+    }
+
+    virtual bool get_direct_mem_ptr(tlm_generic_payload& tx,
+                                    tlm_dmi& dmi) override {
+        return fw_target()->get_direct_mem_ptr(tx, dmi);
+    }
+
+    virtual tlm::tlm_sync_enum nb_transport_fw(tlm_generic_payload& tx,
+                                               tlm::tlm_phase& phase,
+                                               sc_time& t) override {
+        return fw_target()->nb_transport_fw(tx, phase, t);
     }
 
-    bool get_direct_mem_ptr(tlm_generic_payload& tx, tlm_dmi& dmi) {
-        return out->get_direct_mem_ptr(tx, dmi);
+    virtual tlm::tlm_sync_enum nb_transport_bw(tlm_generic_payload& tx,
+                                               tlm::tlm_phase& phase,
+                                               sc_time& t) override {
+        return bw_target()->nb_transport_bw(tx, phase, t);
     }
 
-    void invalidate_direct_mem_ptr(sc_dt::uint64 s, sc_dt::uint64 e) {
-        in->invalidate_direct_mem_ptr(s, e);
+    virtual void invalidate_direct_mem_ptr(sc_dt::uint64 s,
+                                           sc_dt::uint64 e) override {
+        bw_target()->invalidate_direct_mem_ptr(s, e);
     }
 };
 
@@ -20,18 +20,32 @@ namespace vcml {
 class tlm_dmi_cache
 {
 private:
+    // Readers never lock: they announce themselves via m_readers and then
+    // operate on an immutable snapshot sorted by start address. Writers
+    // build a new snapshot under m_mtx, publish it and only reclaim old
+    // snapshots once no reader can still be referencing them.
+    struct snapshot {
+        vector<tlm_dmi> entries;
+        vector<u64> maxend;
+    };
+
     mutable mutex m_mtx;
 
     size_t m_limit;
     vector<tlm_dmi> m_entries;
 
+    atomic<const snapshot*> m_snapshot;
+    mutable atomic<size_t> m_readers;
+    vector<const snapshot*> m_retired;
+
     void insert_locked(const tlm_dmi& dmi);
+    void publish_locked();
 
 public:
     size_t get_entry_limit() const { return m_limit; }
-    void set_entry_limit(size_t lim) { m_limit = lim; }
+    void set_entry_limit(size_t lim);
 
-    vector<tlm_dmi> get_entries() { return m_entries; }
+    vector<tlm_dmi> get_entries();
     const vector<tlm_dmi>& get_entries() const { return m_entries; }
 
     tlm_dmi_cache();
@@ -42,24 +56,24 @@ public:
     bool invalidate(u64 start, u64 end);
     bool invalidate(const range& r);
 
-    bool lookup(const range& r, vcml_access rwx, tlm_dmi& dmi);
-    bool lookup(const range& addr, tlm_command c, tlm_dmi& dmi);
-    bool lookup(u64 addr, u64 size, tlm_command c, tlm_dmi& dmi);
-    bool lookup(const tlm_generic_payload& tx, tlm_dmi& dmi);
+    bool lookup(const range& r, vcml_access rwx, tlm_dmi& dmi) const;
+    bool lookup(const range& addr, tlm_command c, tlm_dmi& dmi) const;
+    bool lookup(u64 addr, u64 size, tlm_command c, tlm_dmi& dmi) const;
+    bool lookup(const tlm_generic_payload& tx, tlm_dmi& dmi) const;
 };
 
 inline bool tlm_dmi_cache::lookup(const range& addr, tlm_command command,
-                                  tlm_dmi& dmi) {
+                                  tlm_dmi& dmi) const {
     return lookup(addr, tlm_command_to_access(command), dmi);
 }
 
 inline bool tlm_dmi_cache::lookup(u64 addr, u64 size, tlm_command command,
-                                  tlm_dmi& dmi) {
+                                  tlm_dmi& dmi) const {
     return lookup({ addr, addr + size - 1 }, command, dmi);
 }
 
 inline bool tlm_dmi_cache::lookup(const tlm_generic_payload& tx,
-                                  tlm_dmi& dmi) {
+                                  tlm_dmi& dmi) const {
     return lookup(tx, tx.get_command(), dmi);
 }
 
@@ -23,21 +23,37 @@ namespace vcml {
 struct exlock {
     int cpu;
     range addr;
+    bool dmi; // taken via dmi, so dmi need not be revoked for it
 };
 
 class tlm_exmon
 {
 private:
-    vector<exlock> m_locks;
+    // one slot per cpu, unused slots have cpu set to -1
+    vector<exlock> m_slots;
+    size_t m_active;
+
+    // covers all active locks, may be larger than needed after breaks
+    range m_bounds;
+
+    bool m_excl_dmi;
+
+    bool may_overlap(const range& r) const {
+        return m_active > 0 && m_bounds.overlaps(r);
+    }
 
 public:
-    const vector<exlock> get_locks() const { return m_locks; }
+    bool has_locks() const { return m_active > 0; }
+    const vector<exlock> get_locks() const;
 
-    tlm_exmon() = default;
-    virtual ~tlm_exmon() = default;
+    bool allows_excl_dmi() const { return m_excl_dmi; }
+    void allow_excl_dmi(bool allow = true);
+
+    tlm_exmon();
+    virtual ~tlm_exmon();
 
     bool has_lock(int cpu, const range& r) const;
-    bool add_lock(int cpu, const range& r);
+    bool add_lock(int cpu, const range& r, bool dmi = false);
 
     void break_locks(int cpu);
     void break_locks(const range& r);
@@ -45,6 +61,12 @@ public:
     bool update(tlm_generic_payload& tx);
 
     bool override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi);
+
+    // remembers which monitor guards a dmi region, so that initiators can
+    // perform exclusive accesses directly on the dmi pointer and only need
+    // to tell the monitor about them using add_lock and break_locks
+    void register_dmi(const tlm_dmi& dmi);
+    static tlm_exmon* lookup_dmi(const u8* ptr, size_t size, u64& addr);
 };
 
 } // namespace vcml
@@ -0,0 +1,82 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_PROTOCOLS_TLM_GATHER_H
+#define VCML_PROTOCOLS_TLM_GATHER_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/range.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+
+struct tlm_gather_entry {
+    u64 offset;
+    unsigned int size;
+};
+
+// turns a transaction into a scatter-gather list: its data buffer holds all
+// entries back to back and each entry is placed at its offset relative to
+// the transaction address. All entries must lie within one target that
+// understands this extension, such as tlm_memory
+class tlm_gather : public tlm_extension<tlm_gather>
+{
+public:
+    vector<tlm_gather_entry> entries;
+
+    tlm_gather() = default;
+    tlm_gather(const vector<tlm_gather_entry>& list): entries(list) {}
+
+    void add(u64 offset, unsigned int size) {
+        entries.push_back({ offset, size });
+    }
+
+    unsigned int total_size() const;
+    range footprint(u64 addr) const;
+
+    virtual tlm_extension_base* clone() const override;
+    virtual void copy_from(const tlm_extension_base& ext) override;
+};
+
+inline unsigned int tlm_gather::total_size() const {
+    unsigned int total = 0;
+    for (const tlm_gather_entry& entry : entries)
+        total += entry.size;
+    return total;
+}
+
+inline range tlm_gather::footprint(u64 addr) const {
+    u64 lo = ~0ull, hi = 0;
+    for (const tlm_gather_entry& entry : entries) {
+        if (entry.size == 0)
+            continue;
+        lo = min(lo, addr + entry.offset);
+        hi = max(hi, addr + entry.offset + entry.size - 1);
+    }
+
+    return lo <= hi ? range(lo, hi) : range(addr, addr);
+}
+
+inline tlm_extension_base* tlm_gather::clone() const {
+    return new tlm_gather(*this);
+}
+
+inline void tlm_gather::copy_from(const tlm_extension_base& ext) {
+    VCML_ERROR_ON(typeid(ext) != typeid(tlm_gather), "cannot copy extension");
+    entries = ((const tlm_gather&)ext).entries;
+}
+
+inline const tlm_gather* tx_get_gather(const tlm_generic_payload& tx) {
+    return tx.get_extension<tlm_gather>();
+}
+
+} // namespace vcml
+
+#endif
@@ -0,0 +1,67 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef VCML_PROTOCOLS_TLM_HEATMAP_H
+#define VCML_PROTOCOLS_TLM_HEATMAP_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+#include "vcml/core/range.h"
+
+#include "vcml/protocols/tlm_sbi.h"
+
+namespace vcml {
+
+// per-page access counters of a target socket. Transport accesses are
+// counted as they pass, accesses via dmi are only seen when the socket
+// briefly revokes dmi for a sampled page and the next access falls back
+// to transport, so page counts are samples rather than exact numbers
+class tlm_heatmap
+{
+public:
+    struct counters {
+        u64 reads;
+        u64 writes;
+        u64 fetches;
+
+        u64 total() const { return reads + writes + fetches; }
+    };
+
+private:
+    u64 m_page_size;
+    u64 m_samples;
+    unordered_map<u64, counters> m_pages;
+
+public:
+    u64 page_size() const { return m_page_size; }
+    u64 num_samples() const { return m_samples; }
+    const unordered_map<u64, counters>& pages() const { return m_pages; }
+
+    tlm_heatmap(u64 page_size = 4 * KiB);
+    virtual ~tlm_heatmap() = default;
+
+    u64 page_of(u64 addr) const { return addr & ~(m_page_size - 1); }
+
+    void record(const tlm_generic_payload& tx, const tlm_sbi& info);
+    void count_sample() { m_samples++; }
+    void reset();
+
+    // pages with the most accesses first, at most limit pages
+    vector<pair<u64, counters>> hottest(size_t limit) const;
+
+    // one line per page of the form "page,reads,writes,fetches"
+    void dump(ostream& os) const;
+    void save(const string& path) const;
+};
+
+} // namespace vcml
+
+#endif
@@ -37,7 +37,7 @@ private:
     vector<tlm_initiator_socket*> m_initiator_sockets;
     vector<tlm_target_socket*> m_target_sockets;
 
-    unsigned int do_transport(tlm_target_socket& socket,
+    unsigned int do_transport(proc_data& data, tlm_target_socket& socket,
                               tlm_generic_payload& tx, const tlm_sbi& info);
 
 protected:
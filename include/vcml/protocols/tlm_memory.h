@@ -16,6 +16,7 @@
 #include "vcml/core/systemc.h"
 
 #include "vcml/protocols/tlm_sbi.h"
+#include "vcml/protocols/tlm_gather.h"
 #include "vcml/protocols/tlm_dmi_cache.h"
 
 namespace vcml {
@@ -29,7 +30,20 @@ private:
     bool m_discard;
     string m_shared;
 
+    bool m_thp;
+    bool m_hugetlb;
+    bool m_prefault;
+    int m_numa_node;
+    size_t m_page_size;
+
+    size_t m_dirty_shift;
+    vector<u64> m_dirty;
+
+    // regions backed by copy-on-write file mappings
+    vector<range> m_mapped;
+
     int init_shared(const string& shared, size_t size);
+    bool release(u8* ptr, size_t len);
 
 public:
     u8* data() const { return get_dmi_ptr(); }
@@ -43,6 +57,27 @@ public:
 
     void discard_writes(bool discard = true) { m_discard = discard; }
 
+    // allocation hints, these must be set before calling init
+    void use_transparent_hugepages(bool use = true) { m_thp = use; }
+    void use_explicit_hugepages(bool use = true) { m_hugetlb = use; }
+    void prefault(bool pf = true) { m_prefault = pf; }
+    void bind_numa_node(int node) { m_numa_node = node; }
+
+    size_t page_size() const { return m_page_size; }
+
+    // dirty tracking only covers writes through this interface, users
+    // writing via data() or DMI must call mark_dirty themselves
+    bool is_tracking_dirty() const { return !m_dirty.empty(); }
+    size_t dirty_page_size() const { return 1ull << m_dirty_shift; }
+
+    void track_dirty(size_t pagesize = 4 * KiB);
+    void untrack_dirty();
+    void mark_dirty(const range& addr);
+
+    // returns one bit per page overlapping addr and clears them, bit 0 of
+    // the first word corresponds to the page containing addr.start
+    vector<u64> fetch_dirty(const range& addr);
+
     tlm_memory();
     tlm_memory(size_t size);
     tlm_memory(size_t size, alignment al);
@@ -57,6 +92,19 @@ public:
     void free();
     void fill(u8 data);
 
+    // zeroes memory by handing whole pages back to the host instead of
+    // writing them, file mappings covering those pages are dropped
+    void clear();
+    void clear(const range& addr);
+
+    // maps a file copy-on-write at the given offset, returns false if the
+    // file cannot be mapped there, in which case memory stays unchanged
+    bool map_file(const string& filename, u64 offset);
+
+    // same as above, but only maps size bytes starting at fileoff, which
+    // must be page aligned; a size of ~0ull maps the rest of the file
+    bool map_file(const string& filename, u64 offset, u64 fileoff, u64 size);
+
     tlm_response_status fill(u8 data, bool debug);
 
     tlm_response_status read(const range& addr, void* dest,
@@ -71,6 +119,8 @@ public:
     template <typename T>
     tlm_response_status write(u64 addr, const T& data, bool debug = false);
 
+    // serves the whole transaction at once, including fixed address bursts,
+    // byte enables and gather lists attached via the tlm_gather extension
     void transport(tlm_generic_payload& tx, const tlm_sbi& sbi);
 
     u8 operator[](size_t offset) const;
@@ -81,8 +131,68 @@ inline void tlm_memory::init(size_t size, alignment al) {
     init("", size, al);
 }
 
+inline bool tlm_memory::map_file(const string& filename, u64 offset) {
+    return map_file(filename, offset, 0, ~0ull);
+}
+
 inline void tlm_memory::fill(u8 val) {
+    if (val == 0) {
+        clear();
+        return;
+    }
+
     memset(data(), val, size());
+    if (is_tracking_dirty())
+        mark_dirty({ 0, size() - 1 });
+}
+
+inline void tlm_memory::clear() {
+    clear({ 0, size() - 1 });
+}
+
+inline void tlm_memory::track_dirty(size_t pagesize) {
+    VCML_ERROR_ON(data() == nullptr, "memory not initialized");
+    VCML_ERROR_ON(!is_pow2(pagesize), "invalid dirty page size: %zu",
+                  pagesize);
+
+    m_dirty_shift = ctz(pagesize);
+    size_t npages = ((size() - 1) >> m_dirty_shift) + 1;
+    m_dirty.assign((npages + 63) / 64, 0);
+}
+
+inline void tlm_memory::untrack_dirty() {
+    m_dirty.clear();
+    m_dirty.shrink_to_fit();
+}
+
+inline void tlm_memory::mark_dirty(const range& addr) {
+    if (!is_tracking_dirty())
+        return;
+
+    for (u64 pg = addr.start >> m_dirty_shift; pg <= addr.end >> m_dirty_shift;
+         pg++) {
+        m_dirty[pg / 64] |= 1ull << (pg % 64);
+    }
+}
+
+inline vector<u64> tlm_memory::fetch_dirty(const range& addr) {
+    VCML_ERROR_ON(!is_tracking_dirty(), "dirty tracking not enabled");
+    VCML_ERROR_ON(addr.end >= size(), "range out of bounds");
+
+    u64 first = addr.start >> m_dirty_shift;
+    u64 last = addr.end >> m_dirty_shift;
+
+    vector<u64> bitmap((last - first) / 64 + 1, 0);
+    for (u64 pg = first; pg <= last; pg++) {
+        u64& word = m_dirty[pg / 64];
+        u64 mask = 1ull << (pg % 64);
+        if (word & mask) {
+            bitmap[(pg - first) / 64] |= 1ull << ((pg - first) % 64);
+            word &= ~mask;
+        }
+    }
+
+    return bitmap;
 }
 
 template <typename T>
@@ -17,6 +17,8 @@
 #include "vcml/core/thctl.h"
 #include "vcml/core/module.h"
 
+#include "vcml/properties/property_base.h"
+
 #include "vcml/protocols/tlm_sbi.h"
 #include "vcml/protocols/tlm_exmon.h"
 #include "vcml/protocols/tlm_stubs.h"
@@ -25,10 +27,54 @@
 
 namespace vcml {
 
+// read-only property exposing a statistics counter
+class tlm_probe_counter : public property_base
+{
+private:
+    atomic<u64> m_value;
+    mutable string m_str;
+
+public:
+    tlm_probe_counter(const char* nm);
+    virtual ~tlm_probe_counter() = default;
+    VCML_KIND(tlm_probe_counter);
+
+    virtual void reset() override { m_value = 0; }
+
+    virtual const char* str() const override;
+    virtual void str(const string& s) override;
+
+    virtual size_t size() const override { return sizeof(u64); }
+    virtual size_t count() const override { return 1; }
+    virtual const char* type() const override { return "u64"; }
+
+    u64 get() const { return m_value.load(std::memory_order_relaxed); }
+    void add(u64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+
+    operator u64() const { return get(); }
+};
+
 class tlm_probe : public module,
                   protected tlm::tlm_fw_transport_if<>,
                   protected tlm::tlm_bw_transport_if<>
 {
+private:
+    enum : size_t {
+        NUM_RESPONSES = 7,
+        NUM_BUCKETS = 32,
+    };
+
+    atomic<u64> m_responses[NUM_RESPONSES];
+    atomic<u64> m_sizes[NUM_BUCKETS];
+    atomic<u64> m_latencies[NUM_BUCKETS];
+
+    void record_request(const tlm_generic_payload& tx);
+    void record_response(const tlm_generic_payload& tx);
+    void record_latency(const sc_time& t);
+
+    bool cmd_stats(const vector<string>& args, ostream& os);
+    bool cmd_reset_stats(const vector<string>& args, ostream& os);
+
 protected:
     virtual void b_transport(tlm_generic_payload& tx, sc_time& dt) override;
     virtual unsigned int transport_dbg(tlm_generic_payload& tx) override;
@@ -43,9 +89,27 @@ protected:
                                                sc_time& t) override;
 
 public:
+    property<bool> collect_stats;
+
+    tlm_probe_counter num_reads;
+    tlm_probe_counter num_writes;
+    tlm_probe_counter num_ignores;
+    tlm_probe_counter num_debug;
+    tlm_probe_counter num_errors;
+    tlm_probe_counter bytes_read;
+    tlm_probe_counter bytes_written;
+    tlm_probe_counter num_dmi_grants;
+    tlm_probe_counter num_dmi_invalidates;
+
     tlm_base_target_socket in;
     tlm_base_initiator_socket out;
 
+    u64 count_size(size_t bucket) const { return m_sizes[bucket]; }
+    u64 count_latency(size_t bucket) const { return m_latencies[bucket]; }
+    u64 count_response(tlm_response_status rs) const;
+
+    void reset_stats();
+
     tlm_probe(const sc_module_name& nm);
     virtual ~tlm_probe() = default;
     VCML_KIND(tlm_probe);
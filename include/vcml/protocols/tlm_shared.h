@@ -0,0 +1,72 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_PROTOCOLS_TLM_SHARED_H
+#define VCML_PROTOCOLS_TLM_SHARED_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/range.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+
+struct tlm_shared_ctl;
+
+// control channel next to a shared tlm_memory, through which all processes
+// mapping the same region tell each other about dmi invalidations, changes
+// to exclusive locks and dirtied pages. Messages are collected by a host
+// thread and handed to the handler from within the systemc thread
+class tlm_shared_channel
+{
+public:
+    enum message : u32 {
+        MSG_INVALIDATE = 0, // peers must drop their dmi pointers
+        MSG_LOCK = 1,       // a peer holds an exclusive lock
+        MSG_UNLOCK = 2,     // a peer has released its exclusive lock
+        MSG_BREAK = 3,      // a peer wrote, exclusive locks are broken
+        MSG_DIRTY = 4,      // a peer wrote without dirty tracking seeing it
+    };
+
+    typedef function<void(message, const range&)> handler;
+
+private:
+    string m_path;
+    int m_fd;
+    tlm_shared_ctl* m_ctl;
+    u32 m_peer;
+    u64 m_tail;
+    handler m_handler;
+
+    atomic<bool> m_running;
+    thread m_thread;
+    shared_ptr<atomic<bool>> m_alive;
+
+    void attach();
+    void detach();
+    void receive(vector<pair<message, range>>& msgs);
+    void run();
+
+public:
+    const char* path() const { return m_path.c_str(); }
+    u32 peer_id() const { return m_peer; }
+    size_t num_peers() const;
+
+    tlm_shared_channel(const string& shared, const handler& h);
+    virtual ~tlm_shared_channel();
+
+    tlm_shared_channel() = delete;
+    tlm_shared_channel(const tlm_shared_channel&) = delete;
+
+    void broadcast(message msg, const range& addr);
+};
+
+} // namespace vcml
+
+#endif
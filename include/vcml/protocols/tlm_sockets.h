@@ -20,9 +20,11 @@
 #include "vcml/protocols/base.h"
 #include "vcml/protocols/tlm_sbi.h"
 #include "vcml/protocols/tlm_exmon.h"
+#include "vcml/protocols/tlm_trace_filter.h"
 #include "vcml/protocols/tlm_stubs.h"
 #include "vcml/protocols/tlm_adapters.h"
 #include "vcml/protocols/tlm_dmi_cache.h"
+#include "vcml/protocols/tlm_heatmap.h"
 #include "vcml/protocols/tlm_host.h"
 #include "vcml/protocols/tlm_base.h"
 
@@ -31,10 +33,72 @@
 
 namespace vcml {
 
+struct tlm_segment {
+    u64 addr;
+    void* data;
+    unsigned int size;
+};
+
+// always-on access counters kept by every socket; bytes only account for
+// successful non-debug accesses, dmi counts accesses served via dmi on the
+// initiator side and dmi pointers granted on the target side
+struct tlm_socket_stats {
+    u64 num_transactions;
+    u64 num_bytes;
+    u64 num_dmi;
+    u64 num_debug;
+    u64 num_errors;
+};
+
 class tlm_initiator_socket
-    : public simple_initiator_socket<tlm_initiator_socket>
+    : public simple_initiator_socket<tlm_initiator_socket>,
+      public tlm_trace_filter
 {
 private:
+    // Small per-socket cache of recent DMI hits in front of the shared
+    // tlm_dmi_cache. Entries are invalidated lazily by bumping m_dmi_gen,
+    // which happens on every DMI invalidation reaching this socket. Not
+    // thread-safe, sockets are only ever driven by a single thread.
+    struct dmi_hint {
+        u64 start;
+        u64 end;
+        u8* base;
+        int access;
+        u64 generation;
+        sc_time rdlat;
+        sc_time wrlat;
+    };
+
+    enum : size_t { NUM_DMI_HINTS = 4 };
+
+    dmi_hint m_dmi_hints[NUM_DMI_HINTS];
+    size_t m_dmi_next;
+    u64 m_dmi_gen;
+
+    u64 m_dmi_hits;
+    u64 m_dmi_misses;
+
+    tlm_socket_stats m_stats;
+
+    const dmi_hint* lookup_dmi_hint(const range& mem, vcml_access rw) const;
+    const dmi_hint* insert_dmi_hint(const tlm_dmi& dmi);
+    const dmi_hint* find_dmi_hint(const range& mem, vcml_access rw);
+
+    // value seen by the last exclusive load performed via dmi, exclusive
+    // stores via dmi only succeed if memory still holds that value
+    struct dmi_reservation {
+        const u8* ptr;
+        unsigned int size;
+        u8 data[8];
+    };
+
+    dmi_reservation m_excl;
+
+    tlm_response_status access_dmi_excl(tlm_command cmd, u64 addr,
+                                        void* data, unsigned int size,
+                                        const tlm_sbi& info,
+                                        unsigned int& nbytes);
+
     tlm_generic_payload m_tx;
     tlm_generic_payload m_txd;
     tlm_sbi m_sbi;
@@ -44,6 +108,10 @@ private:
     module* m_parent;
     module* m_adapter;
 
+    // forward interface of the target, past any bus width adapters
+    tlm::tlm_fw_transport_if<>* m_fw;
+    tlm::tlm_fw_transport_if<>* fw();
+
     void trace_fw(const tlm_generic_payload& tx, const sc_time& t);
     void trace_bw(const tlm_generic_payload& tx, const sc_time& t);
 
@@ -57,6 +125,12 @@ public:
     property<bool> trace_errors;
     property<bool> allow_dmi;
 
+private:
+    // direct references to the trace property values for the fast path
+    const bool& m_trace_all;
+    const bool& m_trace_errors;
+
+public:
     int get_cpuid() const { return m_sbi.cpuid; }
     int get_privilege() const { return m_sbi.privilege; }
 
@@ -69,6 +143,14 @@ public:
 
     VCML_KIND(tlm_initiator_socket);
 
+    // number of accesses served via dmi and accesses that fell back to
+    // regular transactions, ignores accesses where dmi was not allowed
+    u64 dmi_hits() const { return m_dmi_hits; }
+    u64 dmi_misses() const { return m_dmi_misses; }
+
+    const tlm_socket_stats& stats() const { return m_stats; }
+    void reset_stats();
+
     u8* lookup_dmi_ptr(const range& addr, vcml_access rw = VCML_ACCESS_READ);
     u8* lookup_dmi_ptr(u64 start, u64 length,
                        vcml_access rw = VCML_ACCESS_READ);
@@ -99,6 +181,19 @@ public:
                               const tlm_sbi& info = SBI_NONE,
                               unsigned int* nbytes = nullptr);
 
+    tlm_response_status access(tlm_command cmd,
+                               const vector<tlm_segment>& segments,
+                               const tlm_sbi& info = SBI_NONE,
+                               unsigned int* nbytes = nullptr);
+
+    tlm_response_status read(const vector<tlm_segment>& segments,
+                             const tlm_sbi& info = SBI_NONE,
+                             unsigned int* nbytes = nullptr);
+
+    tlm_response_status write(const vector<tlm_segment>& segments,
+                              const tlm_sbi& info = SBI_NONE,
+                              unsigned int* nbytes = nullptr);
+
     template <typename T>
     tlm_response_status readw(u64 addr, T& data,
                               const tlm_sbi& info = SBI_NONE,
@@ -119,15 +214,24 @@ public:
     void stub(tlm_response_status resp = TLM_ADDRESS_ERROR_RESPONSE);
 };
 
+inline tlm::tlm_fw_transport_if<>* tlm_initiator_socket::fw() {
+    if (m_fw == nullptr)
+        m_fw = tlm_passthrough_fw((*this).operator->());
+    return m_fw;
+}
+
 inline void tlm_initiator_socket::trace_fw(const tlm_generic_payload& tx,
                                            const sc_time& t) {
-    if (trace_all)
+    if (tracer::any() && m_trace_all && trace_filter_fw(tx))
         tracer::record(TRACE_FW, *this, tx, t);
 }
 
 inline void tlm_initiator_socket::trace_bw(const tlm_generic_payload& tx,
                                            const sc_time& t) {
-    if (trace_all || (trace_errors && failed(tx)))
+    if (!tracer::any())
+        return;
+    if ((m_trace_all && trace_filter_bw(tx)) ||
+        (m_trace_errors && failed(tx) && trace_match(tx)))
         tracer::record(TRACE_BW, *this, tx, t);
 }
 
@@ -144,18 +248,37 @@ inline u8* tlm_initiator_socket::lookup_dmi_ptr(u64 addr, u64 size,
     return lookup_dmi_ptr({ addr, addr + size - 1 }, rw);
 }
 
+inline const tlm_initiator_socket::dmi_hint*
+tlm_initiator_socket::lookup_dmi_hint(const range& mem,
+                                      vcml_access rw) const {
+    for (const dmi_hint& hint : m_dmi_hints) {
+        if (hint.generation == m_dmi_gen && mem.start >= hint.start &&
+            mem.end <= hint.end && is_set(hint.access, rw))
+            return &hint;
+    }
+
+    return nullptr;
+}
+
 inline tlm_dmi_cache& tlm_initiator_socket::dmi_cache() {
     if (!m_dmi_cache)
         m_dmi_cache = new tlm_dmi_cache();
     return *m_dmi_cache;
 }
 
+inline void tlm_initiator_socket::reset_stats() {
+    m_stats = tlm_socket_stats();
+    m_dmi_hits = 0;
+    m_dmi_misses = 0;
+}
+
 inline void tlm_initiator_socket::map_dmi(const tlm_dmi& dmi) {
     if (m_dmi_cache)
         m_dmi_cache->insert(dmi);
 }
 
 inline void tlm_initiator_socket::unmap_dmi(u64 start, u64 end) {
+    m_dmi_gen++;
     if (m_dmi_cache)
         m_dmi_cache->invalidate(start, end);
 }
@@ -176,6 +299,18 @@ inline tlm_response_status tlm_initiator_socket::write(u64 addr,
     return access(TLM_WRITE_COMMAND, addr, ptr, size, info, bytes);
 }
 
+inline tlm_response_status tlm_initiator_socket::read(
+    const vector<tlm_segment>& segments, const tlm_sbi& info,
+    unsigned int* nbytes) {
+    return access(TLM_READ_COMMAND, segments, info, nbytes);
+}
+
+inline tlm_response_status tlm_initiator_socket::write(
+    const vector<tlm_segment>& segments, const tlm_sbi& info,
+    unsigned int* nbytes) {
+    return access(TLM_WRITE_COMMAND, segments, info, nbytes);
+}
+
 template <typename T>
 inline tlm_response_status tlm_initiator_socket::readw(u64 addr, T& data,
                                                        const tlm_sbi& info,
@@ -231,7 +366,8 @@ inline void tlm_initiator_socket::bind<32>(
     base_type::bind(other);
 }
 
-class tlm_target_socket : public simple_target_socket<tlm_target_socket>
+class tlm_target_socket : public simple_target_socket<tlm_target_socket>,
+                          public tlm_trace_filter
 {
 private:
     int m_curr;
@@ -244,19 +380,47 @@ private:
     module* m_parent;
     module* m_adapter;
 
+    // backward interface of the initiator, past any bus width adapters
+    tlm::tlm_bw_transport_if<>* m_bw;
+    tlm::tlm_bw_transport_if<>* bw();
+
     tlm_generic_payload* m_payload;
     tlm_sbi m_sideband;
 
+    tlm_socket_stats m_stats;
+
+    // dmi for one randomly picked page gets revoked periodically, so that
+    // the next access to it passes through transport and is recorded
+    tlm_heatmap* m_heatmap;
+    deadline_timer* m_heatmap_timer;
+    sc_time m_heatmap_period;
+    u64 m_heatmap_rng;
+    bool m_heatmap_pending;
+    tlm_dmi m_heatmap_dmi;
+
+    void sample_heatmap();
+    void restore_heatmap();
+
     void wait_free();
 
     void trace_fw(const tlm_generic_payload& tx, const sc_time& t);
     void trace_bw(const tlm_generic_payload& tx, const sc_time& t);
 
+    // transaction path picked at the end of elaboration, the fast one
+    // falls back to b_transport for anything but plain accesses
+    typedef void (tlm_target_socket::*dispatch_fn)(tlm_generic_payload&,
+                                                   sc_time&);
+    dispatch_fn m_dispatch;
+
+    void b_transport_fast(tlm_generic_payload& tx, sc_time& dt);
+
     void b_transport_int(tlm_generic_payload& tx, sc_time& dt);
     unsigned int transport_dbg_int(tlm_generic_payload& tx);
     bool get_dmi_ptr_int(tlm_generic_payload& tx, tlm_dmi& dmi);
 
 protected:
+    virtual void end_of_elaboration() override;
+
     virtual void b_transport(tlm_generic_payload& tx, sc_time& dt);
     virtual unsigned int transport_dbg(tlm_generic_payload& tx);
     virtual bool get_dmi_ptr(tlm_generic_payload& tx, tlm_dmi& dmi);
@@ -266,6 +430,12 @@ public:
     property<bool> trace_errors;
     property<bool> allow_dmi;
 
+private:
+    // direct references to the trace property values for the fast path
+    const bool& m_trace_all;
+    const bool& m_trace_errors;
+
+public:
     const address_space as;
 
     tlm_target_socket() = delete;
@@ -277,6 +447,14 @@ public:
     tlm_dmi_cache& dmi_cache();
     tlm_exmon& exmon() { return m_exmon; }
 
+    const tlm_socket_stats& stats() const { return m_stats; }
+    void reset_stats() { m_stats = tlm_socket_stats(); }
+
+    // counts accesses per page, sampling dmi accesses by revoking dmi for
+    // a random page every period, a zero period only counts transport
+    tlm_heatmap* heatmap() const { return m_heatmap; }
+    void enable_heatmap(const sc_time& period, u64 page_size = 4 * KiB);
+
     void map_dmi(const tlm_dmi& dmi);
     void unmap_dmi(const range& mem);
     void unmap_dmi(u64 start, u64 end);
@@ -305,6 +483,12 @@ public:
     range current_transaction_address() const;
 };
 
+inline tlm::tlm_bw_transport_if<>* tlm_target_socket::bw() {
+    if (m_bw == nullptr)
+        m_bw = tlm_passthrough_bw((*this).operator->());
+    return m_bw;
+}
+
 inline void tlm_target_socket::wait_free() {
     if (!m_free_ev) {
         hierarchy_guard guard(this);
@@ -316,13 +500,16 @@ inline void tlm_target_socket::wait_free() {
 
 inline void tlm_target_socket::trace_fw(const tlm_generic_payload& tx,
                                         const sc_time& t) {
-    if (trace_all)
+    if (tracer::any() && m_trace_all && trace_filter_fw(tx))
         tracer::record(TRACE_FW, *this, tx, t);
 }
 
 inline void tlm_target_socket::trace_bw(const tlm_generic_payload& tx,
                                         const sc_time& t) {
-    if (trace_all || (trace_errors && failed(tx)))
+    if (!tracer::any())
+        return;
+    if ((m_trace_all && trace_filter_bw(tx)) ||
+        (m_trace_errors && failed(tx) && trace_match(tx)))
         tracer::record(TRACE_BW, *this, tx, t);
 }
 
@@ -454,6 +641,11 @@ void tlm_bind(const sc_object& obj1, const string& port1, size_t idx1,
 void tlm_bind(const sc_object& obj1, const string& port1, size_t idx1,
               const sc_object& obj2, const string& port2, size_t idx2);
 
+// writes one row per tlm socket found below root, or in the whole hierarchy
+// if root is null, in comma separated format starting with a header row
+void tlm_print_stats(ostream& os, const sc_object* root = nullptr);
+void tlm_reset_stats(sc_object* root = nullptr);
+
 } // namespace vcml
 
 #endif
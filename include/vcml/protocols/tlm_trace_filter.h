@@ -0,0 +1,67 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_PROTOCOLS_TLM_TRACE_FILTER_H
+#define VCML_PROTOCOLS_TLM_TRACE_FILTER_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+#include "vcml/core/range.h"
+
+#include "vcml/properties/property.h"
+
+namespace vcml {
+
+// decides which transactions of a tlm socket get traced; it is applied
+// before any trace activity is created and thus affects all tracers alike
+class tlm_trace_filter
+{
+private:
+    u64 m_count;
+    bool m_sampled;
+
+    bool match_response(tlm_response_status rs) const;
+
+public:
+    property<vector<range>> trace_ranges;
+    property<bool> trace_reads;
+    property<bool> trace_writes;
+    property<vector<string>> trace_responses;
+    property<unsigned int> trace_ratio;
+
+    tlm_trace_filter(sc_object* parent);
+    virtual ~tlm_trace_filter() = default;
+
+    // checks address and command of a transaction
+    bool trace_match(const tlm_generic_payload& tx) const;
+
+    // called for forward traces, also decides whether the transaction is
+    // sampled; backward traces follow the decision of the forward trace
+    bool trace_filter_fw(const tlm_generic_payload& tx);
+    bool trace_filter_bw(const tlm_generic_payload& tx) const;
+};
+
+inline bool tlm_trace_filter::trace_filter_fw(const tlm_generic_payload& tx) {
+    m_sampled = trace_match(tx);
+    if (m_sampled && trace_ratio > 1u)
+        m_sampled = (m_count++ % trace_ratio) == 0;
+    return m_sampled;
+}
+
+inline bool tlm_trace_filter::trace_filter_bw(
+    const tlm_generic_payload& tx) const {
+    if (!m_sampled)
+        return false;
+    return trace_responses.empty() || match_response(tx.get_response_status());
+}
+
+} // namespace vcml
+
+#endif
@@ -19,6 +19,8 @@
 #include "vcml/protocols/base.h"
 #include "vcml/protocols/pci_ids.h"
 
+#include <sys/uio.h>
+
 namespace vcml {
 
 enum virtio_status : int {
@@ -177,6 +179,15 @@ struct vq_message {
     size_t copy_out(const void* ptr, size_t sz, size_t offset = 0);
     size_t copy_in(void* ptr, size_t sz, size_t offset = 0);
 
+    // host iovecs of the descriptor buffers covering sz bytes starting at
+    // offset, resolved once through dmi, so that device models and their
+    // backends can operate on guest memory without copying
+    size_t map_out(vector<iovec>& iov, size_t sz, size_t offset = 0);
+    size_t map_in(vector<iovec>& iov, size_t sz, size_t offset = 0);
+
+    size_t map_out(vector<iovec>& iov) { return map_out(iov, length_out()); }
+    size_t map_in(vector<iovec>& iov) { return map_in(iov, length_in()); }
+
     template <typename T>
     size_t copy_out(const vector<T>& data, size_t offset = 0);
 
@@ -260,6 +271,28 @@ protected:
     virtual virtio_status do_get(vq_message& msg) = 0;
     virtual virtio_status do_put(vq_message& msg) = 0;
 
+    // makes all used buffers visible to the driver, returns true if the
+    // driver wants to be notified about them
+    virtual bool do_publish() = 0;
+
+    // resolves indirect descriptor tables through a small direct mapped
+    // cache, whose host pointers stay valid until invalidate hits them
+    u8* lookup_table(u64 addr, u64 len, vcml_access acs);
+    void invalidate_tables(const range& mem);
+
+private:
+    enum : size_t { TABLE_CACHE_SIZE = 16 };
+
+    struct table_entry {
+        u64 addr;
+        u64 len;
+        vcml_access acs;
+        u8* ptr;
+    };
+
+    u32 m_unpublished;
+    table_entry m_tables[TABLE_CACHE_SIZE];
+
 public:
     const u32 id;
     const u32 limit;
@@ -273,6 +306,14 @@ public:
 
     bool notify;
 
+    // deferred queues only fill in the used ring during put, the driver
+    // gets to see those buffers with the next call to publish
+    bool deferred;
+
+    u64 num_notify;     // notifications requested by the driver
+    u64 num_suppressed; // used buffers that went without a notification
+    u64 num_table_hits; // indirect tables found in the pointer cache
+
     u16 vector;
 
     virtio_dmifn dmi;
@@ -289,8 +330,11 @@ public:
     virtual bool validate() = 0;
     virtual void invalidate(const range& mem) = 0;
 
+    u32 unpublished() const { return m_unpublished; }
+
     bool get(vq_message& msg);
     bool put(vq_message& msg);
+    bool publish();
 };
 
 class split_virtqueue : public virtqueue
@@ -346,6 +390,7 @@ private:
     static_assert(sizeof(vq_used) == 4, "used area size mismatch");
 
     u16 m_last_avail_idx;
+    u16 m_used_pending;
 
     vq_desc* m_desc;
     vq_avail* m_avail;
@@ -359,6 +404,11 @@ private:
                    desc->is_write() ? VCML_ACCESS_WRITE : VCML_ACCESS_READ);
     }
 
+    vq_desc* lookup_indirect(vq_desc* desc) {
+        return (vq_desc*)lookup_table(desc->addr, desc->len,
+                                      VCML_ACCESS_READ);
+    }
+
     u64 descsz() const { return sizeof(vq_desc) * size; }
 
     u64 drvsz() const {
@@ -371,8 +421,14 @@ private:
         return has_event_idx ? usedsz + sizeof(*m_avail_ev) : usedsz;
     }
 
+    // true if the driver asked to be notified once used_event was passed
+    static bool need_event(u16 event, u16 new_idx, u16 old_idx) {
+        return (u16)(new_idx - event - 1) < (u16)(new_idx - old_idx);
+    }
+
     virtual virtio_status do_get(vq_message& msg) override;
     virtual virtio_status do_put(vq_message& msg) override;
+    virtual bool do_publish() override;
 
 public:
     split_virtqueue() = delete;
@@ -430,14 +486,21 @@ private:
             F_EVENT_DESC = 2,
         };
 
-        bool should_notify(u32 index) const {
+        u16 offset() const { return off_wrap & 0x7fff; }
+        bool wrap() const { return off_wrap & 0x8000; }
+
+        // descriptor events are only valid with VIRTIO_F_RING_EVENT_IDX
+        bool should_notify(u32 index, bool wrap_counter,
+                           bool event_idx) const {
             switch (flags) {
             case F_EVENT_ENABLE:
                 return true;
             case F_EVENT_DISABLE:
                 return false;
             case F_EVENT_DESC:
-                return index == off_wrap;
+                if (!event_idx)
+                    return true;
+                return index == offset() && wrap_counter == wrap();
             default:
                 VCML_ERROR("illegal virtio event flags: 0x%04hx", flags);
             }
@@ -455,18 +518,29 @@ private:
 
     bool m_wrap_get;
     bool m_wrap_put;
+    bool m_notify_pending;
 
     u8* lookup_desc_ptr(vq_desc* desc) {
         return dmi(desc->addr, desc->len,
                    desc->is_write() ? VCML_ACCESS_WRITE : VCML_ACCESS_READ);
     }
 
+    vq_desc* lookup_indirect(vq_desc* desc) {
+        return (vq_desc*)lookup_table(desc->addr, desc->len,
+                                      VCML_ACCESS_READ);
+    }
+
     u64 dscsz() const { return sizeof(vq_desc) * size; }
     u64 drvsz() const { return sizeof(vq_event); }
     u64 devsz() const { return sizeof(vq_event); }
 
+    bool should_notify(u32 index, bool wrap_counter) const {
+        return m_driver->should_notify(index, wrap_counter, has_event_idx);
+    }
+
     virtual virtio_status do_get(vq_message& msg) override;
     virtual virtio_status do_put(vq_message& msg) override;
+    virtual bool do_publish() override;
 
 public:
     packed_virtqueue() = delete;
@@ -501,9 +575,19 @@ public:
     virtual bool put(u32 vqid, vq_message& msg) = 0;
     virtual bool get(u32 vqid, vq_message& msg) = 0;
 
+    // hands back several buffers at once, notifying the driver only once
+    virtual bool put_batch(u32 vqid, vector<vq_message>& msgs);
+
     virtual bool notify() = 0;
 };
 
+inline bool virtio_controller::put_batch(u32 vqid, vector<vq_message>& m) {
+    for (vq_message& msg : m)
+        if (!put(vqid, msg))
+            return false;
+    return true;
+}
+
 class virtio_fw_transport_if : public sc_core::sc_interface
 {
 public:
@@ -533,6 +617,13 @@ public:
     virtual bool put(u32 vqid, vq_message& msg) = 0;
     virtual bool get(u32 vqid, vq_message& msg) = 0;
 
+    virtual bool put_batch(u32 vqid, vector<vq_message>& msgs) {
+        for (vq_message& msg : msgs)
+            if (!put(vqid, msg))
+                return false;
+        return true;
+    }
+
     virtual bool notify() = 0;
 };
 
@@ -591,6 +682,10 @@ private:
             return parent->get(vqid, msg);
         }
 
+        virtual bool put_batch(u32 vqid, vector<vq_message>& m) override {
+            return parent->put_batch(vqid, m);
+        }
+
         virtual bool notify() override { return parent->notify(); }
     } m_transport;
 
@@ -152,6 +152,13 @@ class tracer
 private:
     mutable mutex m_mtx;
 
+    // number of live tracers, allows sockets to skip all tracing checks
+    // using a single relaxed load while nobody is tracing
+    static atomic<size_t> s_active;
+
+    // set while tracing is suspended, e.g. outside a region of interest
+    static atomic<bool> s_paused;
+
 public:
     template <typename PAYLOAD>
     struct activity {
@@ -198,6 +205,11 @@ public:
     virtual void trace(const activity<eth_frame>&) = 0;
     virtual void trace(const activity<can_frame>&) = 0;
 
+    // marks a span of simulation time spent by obj, e.g. a processor
+    // quantum, tracers without a timeline view may ignore these
+    virtual void trace_slice(const sc_object& obj, const char* name,
+                             const sc_time& start, const sc_time& end) {}
+
     tracer();
     virtual ~tracer();
 
@@ -213,7 +225,7 @@ public:
                        const sc_time& t = SC_ZERO_TIME) {
         auto& tracers = tracer::all();
         dir = activity<PAYLOAD>::translate(dir);
-        if (!tracers.empty() && dir != TRACE_NONE) {
+        if (!tracers.empty() && dir != TRACE_NONE && !paused()) {
             const activity<PAYLOAD> msg = {
                 protocol<PAYLOAD>::KIND,
                 dir,
@@ -229,7 +241,16 @@ public:
         }
     }
 
-    static bool any() { return !all().empty(); }
+    static void record_slice(const sc_object& obj, const char* name,
+                             const sc_time& start, const sc_time& end);
+
+    static bool any() {
+        return s_active.load(std::memory_order_relaxed) && !paused();
+    }
+
+    static bool paused() { return s_paused.load(std::memory_order_relaxed); }
+    static void pause() { s_paused = true; }
+    static void resume() { s_paused = false; }
 
 protected:
     template <typename PAYLOAD>
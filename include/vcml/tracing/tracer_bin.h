@@ -0,0 +1,98 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_TRACER_BIN_H
+#define VCML_TRACER_BIN_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/tracing/tracer.h"
+
+namespace vcml {
+
+// writes fixed-layout binary trace records into a ring buffer that gets
+// drained to disk by a background thread; use tracer_bin::decode or the
+// vcml-tracedec utility to render a trace in the format of tracer_file
+class tracer_bin : public tracer
+{
+public:
+    enum record_type : u8 {
+        RECORD_PORT = 0,  // introduces a port id, payload is its name
+        RECORD_TLM = 1,   // payload holds the fields of a tlm transaction
+        RECORD_GPIO = 2,  // payload holds vector and state
+        RECORD_CLK = 3,   // payload holds old and new frequency
+        RECORD_TEXT = 4,  // payload holds the formatted transaction text
+    };
+
+    struct record {
+        u32 size; // including this header
+        u32 port;
+        u8 type;
+        u8 kind;
+        i8 dir;
+        u8 error;
+        u32 reserved;
+        u64 time_ns;
+        u64 delta;
+    };
+
+    static constexpr u32 MAGIC = 0x43525456; // "VTRC"
+    static constexpr u32 VERSION = 1;
+
+private:
+    string m_filename;
+    unordered_map<const sc_object*, u32> m_ports;
+
+    vector<u8> m_ring;
+    atomic<u64> m_head;
+    atomic<u64> m_tail;
+    atomic<bool> m_running;
+    thread m_writer;
+
+    void push(const void* data, size_t size);
+    void push_record(const record& rec, const void* data, size_t size);
+
+    u32 port_id(const sc_object& port);
+
+    template <typename PAYLOAD>
+    record make_record(const activity<PAYLOAD>& msg, record_type type);
+
+    template <typename PAYLOAD>
+    void trace_text(const activity<PAYLOAD>& msg);
+
+    void write_thread();
+
+public:
+    const char* filename() const { return m_filename.c_str(); }
+
+    virtual void trace(const activity<tlm_generic_payload>&) override;
+    virtual void trace(const activity<gpio_payload>&) override;
+    virtual void trace(const activity<clk_payload>&) override;
+    virtual void trace(const activity<pci_payload>&) override;
+    virtual void trace(const activity<i2c_payload>&) override;
+    virtual void trace(const activity<spi_payload>&) override;
+    virtual void trace(const activity<sd_command>&) override;
+    virtual void trace(const activity<sd_data>&) override;
+    virtual void trace(const activity<vq_message>&) override;
+    virtual void trace(const activity<serial_payload>&) override;
+    virtual void trace(const activity<eth_frame>&) override;
+    virtual void trace(const activity<can_frame>&) override;
+
+    tracer_bin(const string& filename, size_t ring_size = 16 * MiB);
+    virtual ~tracer_bin();
+
+    // renders a binary trace file as text, returns the number of records
+    static size_t decode(const string& filename, ostream& os);
+};
+
+} // namespace vcml
+
+#endif
@@ -0,0 +1,89 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_TRACER_CHROME_H
+#define VCML_TRACER_CHROME_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/tracing/tracer.h"
+
+namespace vcml {
+
+// emits trace events in the chrome json format, which can be viewed using
+// ui.perfetto.dev or chrome://tracing; every port becomes a track of its
+// own and events are formatted and written by a background thread
+class tracer_chrome : public tracer
+{
+private:
+    struct event {
+        char phase;
+        u32 track;
+        u64 time_ns;
+        u64 duration_ns;
+        u64 value;
+        protocol_kind kind;
+        bool error;
+        string name;
+        string args;
+    };
+
+    string m_filename;
+    ofstream m_stream;
+    unordered_map<const sc_object*, u32> m_tracks;
+    vector<event> m_events;
+    bool m_first;
+
+    mutex m_batch_mtx;
+    condition_variable m_cv;
+    deque<vector<event>> m_batches;
+    bool m_running;
+    thread m_writer;
+
+    u32 track_id(const sc_object& obj);
+    void push(event&& ev);
+    void flush();
+
+    void write_event(const event& ev);
+    void write_thread();
+
+    template <typename PAYLOAD>
+    void do_trace(const activity<PAYLOAD>& msg);
+
+public:
+    static constexpr size_t BATCH_SIZE = 4096;
+
+    const char* filename() const { return m_filename.c_str(); }
+
+    virtual void trace(const activity<tlm_generic_payload>&) override;
+    virtual void trace(const activity<gpio_payload>&) override;
+    virtual void trace(const activity<clk_payload>&) override;
+    virtual void trace(const activity<pci_payload>&) override;
+    virtual void trace(const activity<i2c_payload>&) override;
+    virtual void trace(const activity<spi_payload>&) override;
+    virtual void trace(const activity<sd_command>&) override;
+    virtual void trace(const activity<sd_data>&) override;
+    virtual void trace(const activity<vq_message>&) override;
+    virtual void trace(const activity<serial_payload>&) override;
+    virtual void trace(const activity<eth_frame>&) override;
+    virtual void trace(const activity<can_frame>&) override;
+
+    virtual void trace_slice(const sc_object& obj, const char* name,
+                             const sc_time& start,
+                             const sc_time& end) override;
+
+    tracer_chrome(const string& filename);
+    virtual ~tracer_chrome();
+};
+
+} // namespace vcml
+
+#endif
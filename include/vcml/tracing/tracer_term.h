@@ -18,19 +18,47 @@
 
 namespace vcml {
 
+// prints trace messages to the terminal; in buffered mode, messages are
+// collected and formatted and written in batches by a background thread
 class tracer_term : public tracer
 {
 private:
+    struct entry {
+        protocol_kind kind;
+        trace_direction dir;
+        string sender;
+        string payload;
+        sc_time t;
+        u64 cycle;
+        size_t name_length;
+        size_t indent;
+    };
+
     bool m_colors;
+    bool m_buffered;
     ostream& m_os;
 
+    mutex m_mtx;
+    condition_variable m_cv;
+    vector<entry> m_entries;
+    bool m_running;
+    thread m_writer;
+
+    void print(ostream& os, const entry& e) const;
+    void write_thread();
+
     template <typename PAYLOAD>
     void do_trace(const activity<PAYLOAD>& msg);
 
 public:
+    static constexpr size_t BATCH_SIZE = 4096;
+    static constexpr u64 FLUSH_INTERVAL_MS = 100;
+
     bool has_colors() const { return m_colors; }
     void set_colors(bool set = true) { m_colors = set; }
 
+    bool is_buffered() const { return m_buffered; }
+
     virtual void trace(const activity<tlm_generic_payload>&) override;
     virtual void trace(const activity<gpio_payload>&) override;
     virtual void trace(const activity<clk_payload>&) override;
@@ -45,7 +73,7 @@ public:
     virtual void trace(const activity<can_frame>&) override;
 
     tracer_term(bool use_cerr = false);
-    tracer_term(bool use_cerr, bool use_colors);
+    tracer_term(bool use_cerr, bool use_colors, bool buffered = false);
     virtual ~tracer_term();
 
     static size_t trace_name_length;
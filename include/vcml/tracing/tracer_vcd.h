@@ -0,0 +1,101 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_TRACER_VCD_H
+#define VCML_TRACER_VCD_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/tracing/tracer.h"
+
+namespace vcml {
+
+// writes gpio and clock activity, and optionally tlm address and command,
+// as vcd waveforms; value changes are written by a background thread into
+// a temporary body file, the header is prepended once all signals are known
+class tracer_vcd : public tracer
+{
+private:
+    struct signal {
+        string scope;
+        string name;
+        unsigned int width;
+        bool real;
+    };
+
+    // carries everything needed for formatting, so that the writer thread
+    // never has to look at m_signals while new signals are being added
+    struct change {
+        u64 time_ps;
+        u32 signal;
+        u32 width; // zero for real signals
+        u64 value;
+        double real;
+    };
+
+    string m_filename;
+    string m_bodyname;
+    ofstream m_body;
+    bool m_trace_tlm;
+
+    vector<signal> m_signals;
+    std::map<pair<const sc_object*, u64>, u32> m_ids;
+    vector<change> m_changes;
+    u64 m_last_ps;
+
+    mutex m_batch_mtx;
+    condition_variable m_cv;
+    deque<vector<change>> m_batches;
+    bool m_running;
+    thread m_writer;
+
+    u32 signal_id(const sc_object& obj, u64 sub, const string& scope,
+                  const string& name, unsigned int width, bool real = false);
+
+    void push(const sc_time& t, u32 sig, u64 val, double real = 0.0);
+    void flush();
+
+    void write_change(ostream& os, const change& ch, u64& last);
+    void write_thread();
+    void write_header(ostream& os) const;
+
+public:
+    static constexpr size_t BATCH_SIZE = 4096;
+
+    enum tlm_command_state : u64 {
+        TLM_STATE_IDLE = 0,
+        TLM_STATE_READ = 1,
+        TLM_STATE_WRITE = 2,
+    };
+
+    const char* filename() const { return m_filename.c_str(); }
+    size_t num_signals() const { return m_signals.size(); }
+
+    virtual void trace(const activity<tlm_generic_payload>&) override;
+    virtual void trace(const activity<gpio_payload>&) override;
+    virtual void trace(const activity<clk_payload>&) override;
+    virtual void trace(const activity<pci_payload>&) override {}
+    virtual void trace(const activity<i2c_payload>&) override {}
+    virtual void trace(const activity<spi_payload>&) override {}
+    virtual void trace(const activity<sd_command>&) override {}
+    virtual void trace(const activity<sd_data>&) override {}
+    virtual void trace(const activity<vq_message>&) override {}
+    virtual void trace(const activity<serial_payload>&) override {}
+    virtual void trace(const activity<eth_frame>&) override {}
+    virtual void trace(const activity<can_frame>&) override {}
+
+    tracer_vcd(const string& filename, bool trace_tlm = false);
+    virtual ~tracer_vcd();
+};
+
+} // namespace vcml
+
+#endif
@@ -18,6 +18,8 @@
 #include "vcml/ui/keymap.h"
 #include "vcml/ui/input.h"
 #include "vcml/ui/display.h"
+#include "vcml/ui/damage.h"
+#include "vcml/ui/convert.h"
 
 #include "vcml/logging/logger.h"
 #include "vcml/properties/property.h"
@@ -32,6 +34,16 @@ private:
     unordered_set<pointer*> m_pointers;
     unordered_set<shared_ptr<display>> m_displays;
 
+    // with more than one display, damage detection and pixel conversion
+    // happen here once per frame and all displays consume the result
+    damage_tracker m_tracker;
+    vector<damage_rect> m_damage;
+    pixel_converter m_conv;
+    vector<u8> m_shared;
+
+    bool is_shared() const { return m_displays.size() > 1; }
+    void convert(const damage_rect& rect);
+
 public:
     property<vector<string>> displays;
 
@@ -0,0 +1,82 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef VCML_UI_CONVERT_H
+#define VCML_UI_CONVERT_H
+
+#include "vcml/core/types.h"
+#include "vcml/ui/video.h"
+
+namespace vcml {
+namespace ui {
+
+enum pixel_isa {
+    PIXEL_ISA_SCALAR,
+    PIXEL_ISA_SSE2,
+    PIXEL_ISA_AVX2,
+    PIXEL_ISA_NEON,
+};
+
+const char* pixel_isa_str(pixel_isa isa);
+bool pixel_isa_supported(pixel_isa isa);
+pixel_isa pixel_isa_host();
+
+// converts pixels of any videomode into one of the 32bit formats with
+// 8bit color channels, using the best vector unit the host offers; the
+// kernels operate on little endian modes, big endian input is converted
+// using the scalar fallback
+class pixel_converter
+{
+public:
+    typedef void (*kernel)(const pixel_converter& conv, u8* dst,
+                           const u8* src, size_t npix);
+
+private:
+    videomode m_src;
+    videomode m_dst;
+    pixel_isa m_isa;
+    kernel m_kernel;
+
+public:
+    const videomode& src() const { return m_src; }
+    const videomode& dst() const { return m_dst; }
+
+    pixel_isa isa() const { return m_isa; }
+    bool is_valid() const { return m_kernel != nullptr; }
+
+    pixel_converter();
+    pixel_converter(const videomode& src, pixelformat dst);
+    pixel_converter(const videomode& src, pixelformat dst, pixel_isa isa);
+    pixel_converter(const pixel_converter&) = default;
+    pixel_converter& operator=(const pixel_converter&) = default;
+
+    // converts npix consecutive pixels
+    void convert(u8* dst, const u8* src, size_t npix) const;
+
+    // converts a rectangle, both buffers use the strides of their modes
+    void convert(u8* dst, const u8* src, u32 x, u32 y, u32 w, u32 h) const;
+
+    // converts an entire frame
+    void convert(u8* dst, const u8* src) const;
+
+    // returns true if the format can be produced by a converter
+    static bool supported(pixelformat dst);
+};
+
+inline void pixel_converter::convert(u8* dst, const u8* src,
+                                     size_t npix) const {
+    (*m_kernel)(*this, dst, src, npix);
+}
+
+} // namespace ui
+} // namespace vcml
+
+#endif
@@ -0,0 +1,64 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef VCML_UI_DAMAGE_H
+#define VCML_UI_DAMAGE_H
+
+#include "vcml/core/types.h"
+#include "vcml/ui/video.h"
+
+namespace vcml {
+namespace ui {
+
+struct damage_rect {
+    u32 x;
+    u32 y;
+    u32 w;
+    u32 h;
+};
+
+// finds the regions of a framebuffer that changed since the last call to
+// update by hashing fixed size tiles and comparing against the previous
+// frame; neighboring changed tiles are merged into larger rectangles
+class damage_tracker
+{
+private:
+    videomode m_mode;
+    const u8* m_fb;
+    u32 m_tiles_x;
+    u32 m_tiles_y;
+    bool m_valid;
+    vector<u64> m_hashes;
+
+    u64 hash_tile(u32 tx, u32 ty) const;
+
+public:
+    static constexpr u32 TILE_W = 64;
+    static constexpr u32 TILE_H = 16;
+
+    const videomode& mode() const { return m_mode; }
+    const u8* framebuffer() const { return m_fb; }
+    size_t num_tiles() const { return m_hashes.size(); }
+
+    damage_tracker();
+    virtual ~damage_tracker() = default;
+
+    void setup(const videomode& mode, const u8* fb);
+    void invalidate() { m_valid = false; }
+
+    // returns the number of pixels covered by the damaged rectangles
+    size_t update(vector<damage_rect>& damage);
+};
+
+} // namespace ui
+} // namespace vcml
+
+#endif
@@ -19,6 +19,7 @@
 #include "vcml/ui/video.h"
 #include "vcml/ui/keymap.h"
 #include "vcml/ui/input.h"
+#include "vcml/ui/damage.h"
 
 namespace vcml {
 namespace ui {
@@ -63,8 +64,13 @@ public:
 
     virtual ~display();
 
+    // true if mode must be converted to FORMAT_X8R8G8B8 before it can be
+    // shown, consoles with several displays then convert once for all
+    virtual bool needs_conversion(const videomode& mode) const;
+
     virtual void init(const videomode& mode, u8* fbptr);
     virtual void render(u32 x, u32 y, u32 w, u32 h);
+    virtual void render(const vector<damage_rect>& damage);
     virtual void render();
     virtual void shutdown();
 
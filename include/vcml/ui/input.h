@@ -12,6 +12,7 @@
 #define VCML_UI_INPUT_H
 
 #include "vcml/core/types.h"
+#include "vcml/core/replay.h"
 #include "vcml/logging/logger.h"
 #include "vcml/ui/keymap.h"
 
@@ -57,13 +58,28 @@ struct input_event {
     bool is_rel() const { return type == EVTYPE_REL; }
 };
 
+// events travel from the ui threads to the simulation through a ring that
+// the consumer drains without taking any locks; producers only serialize
+// among themselves, which is uncontended with a single display thread
 class input
 {
 private:
     string m_name;
 
-    mutable mutex m_mutex;
-    queue<input_event> m_events;
+    vector<input_event> m_ring;
+    atomic<size_t> m_head;
+    atomic<size_t> m_tail;
+    mutex m_push_mtx;
+
+    atomic<bool> m_notified;
+    function<void(void)> m_notify;
+    atomic<u64> m_dropped;
+
+    replay_channel m_replay;
+
+    bool pop_ring(input_event& ev);
+    void insert_event(const input_event& ev);
+    void replay_event(const u8* data, size_t size);
 
 protected:
     void push_event(const input_event& ev);
@@ -71,11 +87,19 @@ protected:
     void push_rel(i32 x, i32 y, i32 w);
 
 public:
+    static constexpr size_t CAPACITY = 1024;
+
     const char* input_name() const { return m_name.c_str(); }
+    u64 num_dropped() const { return m_dropped; }
 
-    input(const char* name);
+    input(const char* name, const char* kind);
     virtual ~input();
 
+    // invoked from the producing thread once new events arrive, it is not
+    // called again until pop_event has found the queue empty; needs to be
+    // set before the input gets attached to a display
+    void set_notify(function<void(void)> notify);
+
     bool has_events() const;
     bool pop_event(input_event& ev);
 };
@@ -119,9 +143,6 @@ public:
 class pointer : public input
 {
 private:
-    mutable mutex m_mutex;
-    queue<input_event> m_events;
-
     u32 m_buttons;
     u32 m_abs_x;
     u32 m_abs_y;
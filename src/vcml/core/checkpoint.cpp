@@ -0,0 +1,462 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "vcml/core/checkpoint.h"
+#include "vcml/logging/logger.h"
+#include "vcml/properties/property_base.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace vcml {
+
+struct checkpoint_header {
+    char magic[8];
+    u32 version;
+    u32 reserved;
+    u64 time_ns;
+};
+
+struct checkpoint_record {
+    char magic[4];
+    u32 namelen;
+    u32 flags;
+    u32 reserved;
+    u64 offset;
+    u64 size;
+    u64 stored;
+};
+
+static_assert(sizeof(checkpoint_header) == 24, "unexpected header layout");
+static_assert(sizeof(checkpoint_record) == 40, "unexpected record layout");
+
+static const char CHECKPOINT_MAGIC[8] = "vcmlckp";
+static const char RECORD_MAGIC[4] = "rec";
+static const u32 CHECKPOINT_VERSION = 1;
+
+enum record_flags : u32 {
+    RECORD_MEMORY = 1u << 0,
+    RECORD_COMPRESSED = 1u << 1,
+    RECORD_ALIGNED = 1u << 2,
+    RECORD_DELTA = 1u << 3,
+};
+
+static const char* const PROPERTIES = ".properties";
+static const char* const PARENT = ".parent";
+
+static bool is_zero(const u8* data, size_t size) {
+    return size == 0 || (data[0] == 0 && !memcmp(data, data + 1, size - 1));
+}
+
+static u64 align_page(u64 pos) {
+    return (pos + checkpoint::PAGE_BYTES - 1) & ~(checkpoint::PAGE_BYTES - 1);
+}
+
+static void put_string(vector<u8>& buf, const string& str) {
+    u32 len = str.length();
+    const u8* ptr = (const u8*)&len;
+    buf.insert(buf.end(), ptr, ptr + sizeof(len));
+    buf.insert(buf.end(), str.begin(), str.end());
+}
+
+static bool get_string(const u8*& ptr, const u8* end, string& str) {
+    u32 len = 0;
+    if (end - ptr < (ptrdiff_t)sizeof(len))
+        return false;
+
+    memcpy(&len, ptr, sizeof(len));
+    ptr += sizeof(len);
+    if (end - ptr < (ptrdiff_t)len)
+        return false;
+
+    str.assign((const char*)ptr, len);
+    ptr += len;
+    return true;
+}
+
+static void collect_properties(const sc_object& obj, const sc_object* skip,
+                               vector<property_base*>& props) {
+    if (&obj != skip) {
+        for (sc_attr_base* attr : obj.attr_cltn()) {
+            property_base* prop = dynamic_cast<property_base*>(attr);
+            if (prop != nullptr)
+                props.push_back(prop);
+        }
+    }
+
+    for (const sc_object* child : obj.get_child_objects())
+        collect_properties(*child, skip, props);
+}
+
+void checkpoint::write_header() {
+    checkpoint_header hdr = {};
+    memcpy(hdr.magic, CHECKPOINT_MAGIC, sizeof(hdr.magic));
+    hdr.version = CHECKPOINT_VERSION;
+    hdr.time_ns = time_to_ns(m_time);
+
+    m_file.write((const char*)&hdr, sizeof(hdr));
+    VCML_REPORT_ON(!m_file, "error writing %s", path());
+}
+
+void checkpoint::read_header() {
+    m_file.seekg(0, std::ios::end);
+    u64 filesize = m_file.tellg();
+    m_file.seekg(0, std::ios::beg);
+
+    checkpoint_header hdr;
+    m_file.read((char*)&hdr, sizeof(hdr));
+    if (!m_file || memcmp(hdr.magic, CHECKPOINT_MAGIC, sizeof(hdr.magic)) ||
+        hdr.version != CHECKPOINT_VERSION) {
+        VCML_REPORT("%s is not a checkpoint", path());
+    }
+
+    m_time = sc_time((double)hdr.time_ns, SC_NS);
+
+    u64 pos = sizeof(hdr);
+    while (pos < filesize) {
+        checkpoint_record rec;
+        m_file.seekg(pos);
+        m_file.read((char*)&rec, sizeof(rec));
+        if (!m_file || memcmp(rec.magic, RECORD_MAGIC, sizeof(rec.magic)))
+            VCML_REPORT("%s is corrupted", path());
+
+        string name(rec.namelen, '\0');
+        m_file.read(&name[0], rec.namelen);
+        VCML_REPORT_ON(!m_file, "%s is corrupted", path());
+
+        pos += sizeof(rec) + rec.namelen;
+        if (rec.flags & RECORD_ALIGNED)
+            pos = align_page(pos);
+
+        VCML_REPORT_ON(pos + rec.stored > filesize, "%s is truncated",
+                       path());
+
+        record entry = { rec.flags, rec.offset, rec.size, rec.stored, pos };
+        m_index.insert({ name, entry });
+        pos += rec.stored;
+    }
+}
+
+void checkpoint::write_record(const string& name, u32 flags, u64 offset,
+                              const void* data, size_t size) {
+    VCML_ERROR_ON(!m_writing, "checkpoint %s is read-only", path());
+
+    vector<u8> packed;
+#ifdef HAVE_ZLIB
+    if (m_compress && (flags & RECORD_MEMORY) && size > 0) {
+        uLongf len = compressBound(size);
+        packed.resize(len);
+        int res = compress2(packed.data(), &len, (const Bytef*)data, size, 1);
+        if (res == Z_OK && len < size) {
+            packed.resize(len);
+            flags |= RECORD_COMPRESSED;
+        } else {
+            packed.clear();
+        }
+    }
+#endif
+
+    // uncompressed memory is stored page aligned so it can be mapped later
+    if ((flags & RECORD_MEMORY) && !(flags & RECORD_COMPRESSED))
+        flags |= RECORD_ALIGNED;
+
+    checkpoint_record rec = {};
+    memcpy(rec.magic, RECORD_MAGIC, sizeof(rec.magic));
+    rec.namelen = name.length();
+    rec.flags = flags;
+    rec.offset = offset;
+    rec.size = size;
+    rec.stored = packed.empty() ? size : packed.size();
+
+    m_file.write((const char*)&rec, sizeof(rec));
+    m_file.write(name.c_str(), name.length());
+    if (flags & RECORD_ALIGNED)
+        m_file.seekp(align_page(m_file.tellp()));
+
+    const void* payload = packed.empty() ? data : packed.data();
+    m_file.write((const char*)payload, rec.stored);
+    VCML_REPORT_ON(!m_file, "error writing %s", path());
+}
+
+void checkpoint::read_record(const record& rec, void* data) {
+    VCML_ERROR_ON(m_writing, "checkpoint %s is write-only", path());
+
+    m_file.seekg(rec.pos);
+    if (!(rec.flags & RECORD_COMPRESSED)) {
+        m_file.read((char*)data, rec.size);
+        VCML_REPORT_ON(!m_file, "error reading %s", path());
+        return;
+    }
+
+#ifdef HAVE_ZLIB
+    vector<u8> packed(rec.stored);
+    m_file.read((char*)packed.data(), packed.size());
+    VCML_REPORT_ON(!m_file, "error reading %s", path());
+
+    uLongf len = rec.size;
+    int res = uncompress((Bytef*)data, &len, packed.data(), packed.size());
+    VCML_REPORT_ON(res != Z_OK || len != rec.size, "%s is corrupted",
+                   path());
+#else
+    VCML_REPORT("%s is compressed, but zlib is not available", path());
+#endif
+}
+
+checkpoint::checkpoint(const string& path, bool write, bool compress,
+                       const string& parent):
+    m_path(path),
+    m_parent(write ? parent : ""),
+    m_writing(write),
+    m_compress(compress),
+    m_time(write ? sc_time_stamp() : SC_ZERO_TIME),
+    m_file(),
+    m_index() {
+    auto mode = write ? std::ios::out | std::ios::trunc : std::ios::in;
+    m_file.open(path, mode | std::ios::binary);
+    VCML_REPORT_ON(!m_file, "cannot open checkpoint %s: %s", path.c_str(),
+                   strerror(errno));
+
+#ifndef HAVE_ZLIB
+    if (m_compress) {
+        log_warn("compressing checkpoints requires zlib");
+        m_compress = false;
+    }
+#endif
+
+    if (write) {
+        write_header();
+        if (!m_parent.empty())
+            save(PARENT, m_parent.c_str(), m_parent.length());
+        return;
+    }
+
+    read_header();
+    auto it = m_index.find(PARENT);
+    if (it != m_index.end()) {
+        m_parent.resize(it->second.size);
+        read_record(it->second, &m_parent[0]);
+    }
+}
+
+checkpoint::~checkpoint() {
+    m_file.close();
+}
+
+bool checkpoint::has(const string& name) const {
+    return m_index.find(name) != m_index.end();
+}
+
+void checkpoint::save(const string& name, const void* data, size_t size,
+                      u64 offset) {
+    write_record(name, 0, offset, data, size);
+}
+
+bool checkpoint::load(const string& name, void* data, size_t size) {
+    auto it = m_index.find(name);
+    if (it == m_index.end())
+        return false;
+
+    const record& rec = it->second;
+    VCML_REPORT_ON(rec.size != size, "record %s has %llu bytes, expected %zu",
+                   name.c_str(), rec.size, size);
+    read_record(rec, data);
+    return true;
+}
+
+size_t checkpoint::load_all(const string& name,
+                            const function<void(u64, const u8*, size_t)>& fn) {
+    size_t count = 0;
+    vector<u8> buffer;
+    auto records = m_index.equal_range(name);
+    for (auto it = records.first; it != records.second; it++, count++) {
+        const record& rec = it->second;
+        buffer.resize(rec.size);
+        read_record(rec, buffer.data());
+        fn(rec.offset, buffer.data(), rec.size);
+    }
+
+    return count;
+}
+
+void checkpoint::save_properties(const sc_object& root, const sc_object* skip,
+                                 unordered_map<string, string>* prev) {
+    vector<property_base*> props;
+    collect_properties(root, skip, props);
+
+    vector<u8> buffer;
+    for (property_base* prop : props) {
+        string value = prop->str();
+        if (prev != nullptr) {
+            auto it = prev->find(prop->fullname());
+            if (it != prev->end() && it->second == value)
+                continue;
+            (*prev)[prop->fullname()] = value;
+        }
+
+        put_string(buffer, prop->fullname());
+        put_string(buffer, value);
+    }
+
+    save(PROPERTIES, buffer.data(), buffer.size());
+}
+
+void checkpoint::load_properties(const sc_object& root,
+                                 const sc_object* skip) {
+    auto it = m_index.find(PROPERTIES);
+    VCML_REPORT_ON(it == m_index.end(), "%s holds no properties", path());
+
+    vector<u8> buffer(it->second.size);
+    read_record(it->second, buffer.data());
+
+    unordered_map<string, string> values;
+    const u8* ptr = buffer.data();
+    const u8* end = ptr + buffer.size();
+    while (ptr < end) {
+        string name, value;
+        if (!get_string(ptr, end, name) || !get_string(ptr, end, value))
+            VCML_REPORT("%s is corrupted", path());
+        values[name] = value;
+    }
+
+    vector<property_base*> props;
+    collect_properties(root, skip, props);
+    for (property_base* prop : props) {
+        auto value = values.find(prop->fullname());
+        if (value == values.end()) {
+            log_debug("property %s not in checkpoint", prop->fullname());
+            continue;
+        }
+
+        if (value->second != prop->str())
+            prop->str(value->second);
+    }
+}
+
+void checkpoint::save_delta(const string& name, tlm_memory& mem) {
+    const u8* base = mem.data();
+    const size_t size = mem.size();
+    const size_t pgsz = mem.dirty_page_size();
+    const size_t npages = (size + pgsz - 1) / pgsz;
+    const vector<u64> dirty = mem.fetch_dirty({ 0, size - 1 });
+
+    auto is_dirty = [&](size_t page) -> bool {
+        return dirty[page / 64] & bit(page % 64);
+    };
+
+    // pages that became zero again must be saved as well, so do not skip
+    // zero pages here and mark the memory as delta for restoring
+    write_record(name, RECORD_MEMORY | RECORD_DELTA, 0, nullptr, 0);
+
+    for (size_t page = 0; page < npages;) {
+        if (!is_dirty(page)) {
+            page++;
+            continue;
+        }
+
+        size_t first = page;
+        while (page < npages && is_dirty(page) &&
+               (page - first) * pgsz < MAX_EXTENT)
+            page++;
+
+        size_t start = first * pgsz;
+        size_t end = min(page * pgsz, size);
+        write_record(name, RECORD_MEMORY, start, base + start, end - start);
+    }
+}
+
+void checkpoint::save_memory(const string& name, tlm_memory& mem) {
+    if (mem.is_tracking_dirty()) {
+        if (is_incremental()) {
+            save_delta(name, mem);
+            return;
+        }
+
+        // later incremental checkpoints start from this one
+        mem.fetch_dirty({ 0, mem.size() - 1 });
+    }
+
+    const u8* base = mem.data();
+    const size_t size = mem.size();
+
+    // an empty record first, so that all zero memories are restored as well
+    write_record(name, RECORD_MEMORY, 0, nullptr, 0);
+
+    size_t off = 0;
+    while (off < size) {
+        size_t len = min<size_t>(PAGE_BYTES, size - off);
+        if (is_zero(base + off, len)) {
+            off += len;
+            continue;
+        }
+
+        size_t start = off;
+        while (off < size && off - start < MAX_EXTENT) {
+            len = min<size_t>(PAGE_BYTES, size - off);
+            if (is_zero(base + off, len))
+                break;
+            off += len;
+        }
+
+        write_record(name, RECORD_MEMORY, start, base + start, off - start);
+    }
+}
+
+void checkpoint::load_memory(const string& name, tlm_memory& mem) {
+    auto records = m_index.equal_range(name);
+    VCML_REPORT_ON(records.first == records.second,
+                   "%s holds no memory %s", path(), name.c_str());
+
+    u8* base = mem.data();
+    const size_t size = mem.size();
+    const bool delta = records.first->second.flags & RECORD_DELTA;
+
+    // reading untouched pages does not allocate them, so only clear those
+    // pages that actually hold data; deltas leave unchanged pages alone
+    auto clear = [&](size_t from, size_t to) -> void {
+        if (delta)
+            return;
+
+        for (size_t off = from; off < to; off += PAGE_BYTES) {
+            size_t len = min<size_t>(PAGE_BYTES, to - off);
+            if (!is_zero(base + off, len)) {
+                memset(base + off, 0, len);
+                mem.mark_dirty({ off, off + len - 1 });
+            }
+        }
+    };
+
+    size_t pos = 0;
+    for (auto it = records.first; it != records.second; it++) {
+        const record& rec = it->second;
+        VCML_REPORT_ON(!(rec.flags & RECORD_MEMORY),
+                       "record %s does not hold memory", name.c_str());
+        VCML_REPORT_ON(rec.offset < pos || rec.offset + rec.size > size,
+                       "memory %s does not match checkpoint", name.c_str());
+
+        if (rec.size == 0)
+            continue;
+
+        clear(pos, rec.offset);
+        pos = rec.offset + rec.size;
+
+        bool aligned = rec.flags & RECORD_ALIGNED;
+        if (aligned && mem.map_file(m_path, rec.offset, rec.pos, rec.size))
+            continue;
+
+        read_record(rec, base + rec.offset);
+        mem.mark_dirty({ rec.offset, rec.offset + rec.size - 1 });
+    }
+
+    clear(pos, size);
+}
+
+} // namespace vcml
@@ -18,6 +18,11 @@ bool component::cmd_reset(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool component::cmd_tlm_stats(const vector<string>& args, ostream& os) {
+    tlm_print_stats(os, this);
+    return true;
+}
+
 void component::do_reset() {
     for (auto socket : get_tlm_target_sockets())
         socket->invalidate_dmi();
@@ -35,6 +40,9 @@ component::component(const sc_module_name& nm, bool dmi, unsigned int bus):
     rst("rst") {
     register_command("reset", 0, &component::cmd_reset,
                      "resets this component");
+    register_command("tlm_stats", 0, &component::cmd_tlm_stats,
+                     "lists transaction counters of all tlm sockets of "
+                     "this component");
 }
 
 component::~component() {
@@ -0,0 +1,303 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/crc.h"
+
+#if defined(__x86_64__)
+#define VCML_CRC_X86
+#define VCML_TARGET_PCLMUL __attribute__((target("sse4.2,pclmul")))
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define VCML_CRC_ARMV8
+#define VCML_TARGET_CRC __attribute__((target("arch=armv8-a+crc")))
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+#endif
+
+namespace vcml {
+
+const char* crc_isa_str(crc_isa isa) {
+    switch (isa) {
+    case CRC_ISA_BYTEWISE:
+        return "bytewise";
+    case CRC_ISA_SLICED:
+        return "sliced";
+    case CRC_ISA_PCLMUL:
+        return "pclmul";
+    case CRC_ISA_ARMV8:
+        return "armv8";
+    default:
+        return "unknown";
+    }
+}
+
+bool crc_isa_supported(crc_isa isa) {
+    switch (isa) {
+    case CRC_ISA_BYTEWISE:
+    case CRC_ISA_SLICED:
+        return true;
+#ifdef VCML_CRC_X86
+    case CRC_ISA_PCLMUL:
+        return __builtin_cpu_supports("sse4.2") &&
+               __builtin_cpu_supports("pclmul");
+#endif
+#ifdef VCML_CRC_ARMV8
+    case CRC_ISA_ARMV8:
+#if defined(__linux__)
+        return getauxval(AT_HWCAP) & HWCAP_CRC32;
+#else
+        return true;
+#endif
+#endif
+    default:
+        return false;
+    }
+}
+
+crc_isa crc_isa_host() {
+    static const crc_isa best = []() -> crc_isa {
+        const crc_isa isas[] = {
+            CRC_ISA_ARMV8,
+            CRC_ISA_PCLMUL,
+        };
+
+        for (crc_isa isa : isas)
+            if (crc_isa_supported(isa))
+                return isa;
+        return CRC_ISA_SLICED;
+    }();
+
+    return best;
+}
+
+// table k holds the crc of a byte followed by k zero bytes, so that eight
+// bytes can be processed with independent lookups
+struct crc_tables {
+    u8 crc7[256];
+    u16 crc16[8][256];
+    u32 crc32[8][256];
+
+    crc_tables();
+};
+
+crc_tables::crc_tables() {
+    for (u32 i = 0; i < 256; i++) {
+        u8 c7 = (u8)i;
+        for (int bit = 0; bit < 8; bit++)
+            c7 = (c7 & 0x80) ? (c7 << 1) ^ (0x09 << 1) : c7 << 1;
+        crc7[i] = c7;
+
+        u16 c16 = (u16)(i << 8);
+        for (int bit = 0; bit < 8; bit++)
+            c16 = (c16 & 0x8000) ? (c16 << 1) ^ 0x1021 : c16 << 1;
+        crc16[0][i] = c16;
+
+        u32 c32 = i;
+        for (int bit = 0; bit < 8; bit++)
+            c32 = (c32 & 1) ? (c32 >> 1) ^ 0xedb88320 : c32 >> 1;
+        crc32[0][i] = c32;
+    }
+
+    for (u32 i = 0; i < 256; i++) {
+        for (size_t k = 1; k < 8; k++) {
+            u16 c16 = crc16[k - 1][i];
+            crc16[k][i] = (c16 << 8) ^ crc16[0][c16 >> 8];
+            u32 c32 = crc32[k - 1][i];
+            crc32[k][i] = (c32 >> 8) ^ crc32[0][c32 & 0xff];
+        }
+    }
+}
+
+static const crc_tables& tables() {
+    static const crc_tables singleton;
+    return singleton;
+}
+
+u8 crc7_sd(const u8* data, size_t len, u8 crc) {
+    const crc_tables& t = tables();
+    while (len--)
+        crc = t.crc7[crc ^ *data++];
+    return crc;
+}
+
+static u16 crc16_bytewise(const u8* data, size_t len, u16 crc) {
+    const crc_tables& t = tables();
+    while (len--)
+        crc = (crc << 8) ^ t.crc16[0][(crc >> 8) ^ *data++];
+    return crc;
+}
+
+static u16 crc16_sliced(const u8* data, size_t len, u16 crc) {
+    const crc_tables& t = tables();
+    for (; len >= 8; len -= 8, data += 8) {
+        crc = t.crc16[7][data[0] ^ (crc >> 8)] ^
+              t.crc16[6][data[1] ^ (crc & 0xff)] ^ t.crc16[5][data[2]] ^
+              t.crc16[4][data[3]] ^ t.crc16[3][data[4]] ^
+              t.crc16[2][data[5]] ^ t.crc16[1][data[6]] ^
+              t.crc16[0][data[7]];
+    }
+
+    return crc16_bytewise(data, len, crc);
+}
+
+u16 crc16_sd(const u8* data, size_t len, u16 crc) {
+    return crc16_sliced(data, len, crc);
+}
+
+u16 crc16_sd(const u8* data, size_t len, u16 crc, crc_isa isa) {
+    if (isa == CRC_ISA_BYTEWISE)
+        return crc16_bytewise(data, len, crc);
+    return crc16_sliced(data, len, crc);
+}
+
+// the crc32 helpers below work on the raw register, callers invert it
+static u32 crc32_bytewise(const u8* data, size_t len, u32 crc) {
+    const crc_tables& t = tables();
+    while (len--)
+        crc = (crc >> 8) ^ t.crc32[0][(crc ^ *data++) & 0xff];
+    return crc;
+}
+
+static inline u32 load_le32(const u8* p) {
+    return (u32)p[0] | (u32)p[1] << 8 | (u32)p[2] << 16 | (u32)p[3] << 24;
+}
+
+static u32 crc32_sliced(const u8* data, size_t len, u32 crc) {
+    const crc_tables& t = tables();
+    for (; len >= 8; len -= 8, data += 8) {
+        u32 lo = load_le32(data) ^ crc;
+        u32 hi = load_le32(data + 4);
+        crc = t.crc32[7][lo & 0xff] ^ t.crc32[6][(lo >> 8) & 0xff] ^
+              t.crc32[5][(lo >> 16) & 0xff] ^ t.crc32[4][lo >> 24] ^
+              t.crc32[3][hi & 0xff] ^ t.crc32[2][(hi >> 8) & 0xff] ^
+              t.crc32[1][(hi >> 16) & 0xff] ^ t.crc32[0][hi >> 24];
+    }
+
+    return crc32_bytewise(data, len, crc);
+}
+
+#ifdef VCML_CRC_X86
+// folding constants x^n mod p (bit-reflected) for the ethernet polynomial,
+// see "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ"
+enum : u64 {
+    CRC32_K1 = 0x154442bd4, // fold by four, x^(4*128+32) and x^(4*128-32)
+    CRC32_K2 = 0x1c6e41596,
+    CRC32_K3 = 0x1751997d0, // fold by one, x^(128+32) and x^(128-32)
+    CRC32_K4 = 0x0ccaa009e,
+    CRC32_K5 = 0x163cd6124, // 64 to 32 bits, x^64
+    CRC32_P = 0x1db710641,  // polynomial for barrett reduction
+    CRC32_U = 0x1f7011641,  // x^64 / p
+};
+
+VCML_TARGET_PCLMUL
+static inline __m128i crc32_fold(__m128i a, __m128i b, __m128i k) {
+    __m128i lo = _mm_clmulepi64_si128(a, k, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(a, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(b, lo), hi);
+}
+
+VCML_TARGET_PCLMUL
+static u32 crc32_pclmul(const u8* data, size_t len, u32 crc) {
+    if (len < 64)
+        return crc32_sliced(data, len, crc);
+
+    const __m128i* p = (const __m128i*)data;
+    __m128i x0 = _mm_loadu_si128(p + 0);
+    __m128i x1 = _mm_loadu_si128(p + 1);
+    __m128i x2 = _mm_loadu_si128(p + 2);
+    __m128i x3 = _mm_loadu_si128(p + 3);
+    x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128((int)crc));
+    data += 64;
+    len -= 64;
+
+    __m128i k = _mm_set_epi64x(CRC32_K2, CRC32_K1);
+    for (; len >= 64; len -= 64, data += 64) {
+        p = (const __m128i*)data;
+        x0 = crc32_fold(x0, _mm_loadu_si128(p + 0), k);
+        x1 = crc32_fold(x1, _mm_loadu_si128(p + 1), k);
+        x2 = crc32_fold(x2, _mm_loadu_si128(p + 2), k);
+        x3 = crc32_fold(x3, _mm_loadu_si128(p + 3), k);
+    }
+
+    k = _mm_set_epi64x(CRC32_K4, CRC32_K3);
+    __m128i x = crc32_fold(x0, x1, k);
+    x = crc32_fold(x, x2, k);
+    x = crc32_fold(x, x3, k);
+    for (; len >= 16; len -= 16, data += 16)
+        x = crc32_fold(x, _mm_loadu_si128((const __m128i*)data), k);
+
+    // reduce 128 to 64 bits, then 64 to 32 bits
+    const __m128i mask = _mm_set_epi32(0, 0, 0, ~0);
+    x = _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x10), _mm_srli_si128(x, 8));
+    x = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x, mask),
+                                           _mm_set_epi64x(0, CRC32_K5), 0x00),
+                      _mm_srli_si128(x, 4));
+
+    // barrett reduction
+    const __m128i pu = _mm_set_epi64x(CRC32_U, CRC32_P);
+    __m128i t1 = _mm_clmulepi64_si128(_mm_and_si128(x, mask), pu, 0x10);
+    __m128i t2 = _mm_clmulepi64_si128(_mm_and_si128(t1, mask), pu, 0x00);
+    crc = (u32)_mm_extract_epi32(_mm_xor_si128(x, t2), 1);
+
+    return crc32_sliced(data, len, crc);
+}
+#endif
+
+#ifdef VCML_CRC_ARMV8
+VCML_TARGET_CRC
+static u32 crc32_armv8(const u8* data, size_t len, u32 crc) {
+    for (; len >= 8; len -= 8, data += 8) {
+        u64 val;
+        memcpy(&val, data, sizeof(val));
+        crc = __crc32d(crc, val);
+    }
+
+    while (len--)
+        crc = __crc32b(crc, *data++);
+    return crc;
+}
+#endif
+
+u32 crc32_eth(const u8* data, size_t len, u32 crc) {
+    return crc32_eth(data, len, crc, crc_isa_host());
+}
+
+u32 crc32_eth(const u8* data, size_t len, u32 crc, crc_isa isa) {
+    crc = ~crc;
+    switch (isa) {
+    case CRC_ISA_BYTEWISE:
+        crc = crc32_bytewise(data, len, crc);
+        break;
+#ifdef VCML_CRC_X86
+    case CRC_ISA_PCLMUL:
+        crc = crc32_pclmul(data, len, crc);
+        break;
+#endif
+#ifdef VCML_CRC_ARMV8
+    case CRC_ISA_ARMV8:
+        crc = crc32_armv8(data, len, crc);
+        break;
+#endif
+    default:
+        crc = crc32_sliced(data, len, crc);
+        break;
+    }
+
+    return ~crc;
+}
+
+} // namespace vcml
@@ -0,0 +1,105 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "vcml/core/entropy.h"
+
+namespace vcml {
+
+static u64 splitmix64(u64& x) {
+    u64 z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static inline u64 rotl(u64 x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+u64 entropy_pool::xoshiro() {
+    const u64 result = rotl(m_state[1] * 5, 7) * 9;
+    const u64 t = m_state[1] << 17;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotl(m_state[3], 45);
+
+    return result;
+}
+
+bool entropy_pool::generate(u8* buffer, size_t size) {
+    if (!m_pseudo)
+        return mwr::fill_random(buffer, size);
+
+    for (; size >= sizeof(u64); size -= sizeof(u64)) {
+        u64 val = xoshiro();
+        memcpy(buffer, &val, sizeof(val));
+        buffer += sizeof(val);
+    }
+
+    if (size > 0) {
+        u64 val = xoshiro();
+        memcpy(buffer, &val, size);
+    }
+
+    return true;
+}
+
+entropy_pool::entropy_pool(): entropy_pool(false, 0) {
+    // nothing to do
+}
+
+entropy_pool::entropy_pool(bool pseudo, u64 seed):
+    m_pseudo(), m_state(), m_pool(POOL_SIZE), m_pos() {
+    reset(pseudo, seed);
+}
+
+void entropy_pool::reset(bool pseudo, u64 seed) {
+    m_pseudo = pseudo;
+    for (u64& state : m_state)
+        state = splitmix64(seed);
+
+    // mark the pool as empty, it is refilled on the next request
+    m_pos = m_pool.size();
+}
+
+bool entropy_pool::fill(void* buffer, size_t size) {
+    u8* ptr = (u8*)buffer;
+    bool ok = true;
+
+    while (size > 0) {
+        if (m_pos == m_pool.size()) {
+            if (size >= m_pool.size()) {
+                size_t n = size - size % m_pool.size();
+                ok &= generate(ptr, n);
+                ptr += n;
+                size -= n;
+                continue;
+            }
+
+            ok &= generate(m_pool.data(), m_pool.size());
+            m_pos = 0;
+        }
+
+        size_t n = min(size, m_pool.size() - m_pos);
+        memcpy(ptr, m_pool.data() + m_pos, n);
+        m_pos += n;
+        ptr += n;
+        size -= n;
+    }
+
+    return ok;
+}
+
+} // namespace vcml
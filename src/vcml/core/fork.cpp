@@ -0,0 +1,187 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/fork.h"
+#include "vcml/logging/logger.h"
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+namespace vcml {
+
+struct fork_state {
+    mutex mtx;
+    vector<fork_handler*> handlers;
+    bool prepared = false;
+    int conn = -1;
+};
+
+static fork_state& state() {
+    static fork_state instance;
+    return instance;
+}
+
+fork_handler::fork_handler() {
+    fork_state& s = state();
+    lock_guard<mutex> guard(s.mtx);
+    s.handlers.push_back(this);
+}
+
+fork_handler::~fork_handler() {
+    fork_state& s = state();
+    lock_guard<mutex> guard(s.mtx);
+    stl_remove(s.handlers, this);
+}
+
+static void send_line(int fd, const string& line) {
+    string s = line + "\n";
+    for (size_t n = 0; n < s.length();) {
+        ssize_t res = ::send(fd, s.data() + n, s.length() - n, MSG_NOSIGNAL);
+        if (res < 0 && errno == EINTR)
+            continue;
+        if (res <= 0)
+            return; // client gone, nothing left to report to
+        n += res;
+    }
+}
+
+static bool recv_line(int fd, string& line) {
+    line.clear();
+    char c;
+    while (line.length() < 4096) {
+        ssize_t res = ::recv(fd, &c, 1, 0);
+        if (res < 0 && errno == EINTR)
+            continue;
+        if (res <= 0)
+            return !line.empty();
+        if (c == '\n')
+            return true;
+        if (c != '\r')
+            line += c;
+    }
+
+    return true;
+}
+
+static void reap_children() {
+    int status = 0;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        if (WIFEXITED(status))
+            log_debug("child %d exited with %d", pid, WEXITSTATUS(status));
+        else if (WIFSIGNALED(status))
+            log_warn("child %d killed by signal %d", pid, WTERMSIG(status));
+    }
+}
+
+static void prepare_handlers() {
+    fork_state& s = state();
+    lock_guard<mutex> guard(s.mtx);
+    if (s.prepared)
+        return;
+
+    for (fork_handler* handler : s.handlers)
+        handler->fork_prepare();
+    s.prepared = true;
+}
+
+static void resume_handlers(int conn) {
+    fork_state& s = state();
+    lock_guard<mutex> guard(s.mtx);
+    s.conn = conn;
+    for (fork_handler* handler : s.handlers)
+        handler->fork_child();
+}
+
+bool fork_serve(u16 port, string& request) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    VCML_REPORT_ON(fd < 0, "cannot create socket: %s", strerror(errno));
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+        ::listen(fd, SOMAXCONN) < 0) {
+        int err = errno;
+        close(fd);
+        VCML_REPORT("cannot listen on port %hu: %s", port, strerror(err));
+    }
+
+    // backend threads must be gone before the first fork, otherwise every
+    // child would inherit their locks in whatever state they were in
+    prepare_handlers();
+    log_info("fork server waiting for requests on port %hu", port);
+
+    while (true) {
+        reap_children();
+
+        int conn = ::accept(fd, nullptr, nullptr);
+        if (conn < 0 && errno == EINTR)
+            continue;
+        if (conn < 0) {
+            log_error("fork server: %s", strerror(errno));
+            close(fd);
+            return false;
+        }
+
+        string line;
+        if (!recv_line(conn, line)) {
+            close(conn);
+            continue;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            log_error("cannot fork for '%s': %s", line.c_str(),
+                      strerror(errno));
+            send_line(conn, "error");
+            close(conn);
+            continue;
+        }
+
+        if (pid > 0) {
+            log_debug("forked child %d for '%s'", pid, line.c_str());
+            close(conn);
+            continue;
+        }
+
+        close(fd);
+        resume_handlers(conn);
+        send_line(conn, mkstr("pid %d", getpid()));
+        request = line;
+        return true;
+    }
+}
+
+bool fork_is_child() {
+    fork_state& s = state();
+    lock_guard<mutex> guard(s.mtx);
+    return s.conn >= 0;
+}
+
+void fork_exit(int code) {
+    fork_state& s = state();
+    lock_guard<mutex> guard(s.mtx);
+    if (s.conn < 0)
+        return;
+
+    send_line(s.conn, mkstr("exit %d", code));
+    close(s.conn);
+    s.conn = -1;
+}
+
+} // namespace vcml
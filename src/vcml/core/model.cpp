@@ -9,6 +9,8 @@
  ******************************************************************************/
 
 #include "vcml/core/model.h"
+#include "vcml/core/startup.h"
+#include "vcml/properties/broker.h"
 
 namespace vcml {
 
@@ -17,6 +19,21 @@ model::model(const sc_module_name& name, const string& kind):
     // nothing to do
 }
 
+static bool optional_enabled(const sc_module_name& name) {
+    sc_module* top = hierarchy_top();
+    string key = top ? mkstr("%s.%s.enabled", top->name(), (const char*)name)
+                     : mkstr("%s.enabled", (const char*)name);
+    return broker::get_or_default<bool>(key, false);
+}
+
+model::model(const sc_module_name& name, const string& kind, bool optional):
+    m_impl() {
+    if (!optional || optional_enabled(name))
+        m_impl.reset(create(kind, name));
+    else
+        m_impl.reset(new placeholder(name, kind));
+}
+
 module* model::create(const string& type, const sc_module_name& name) {
     vector<string> args = split(type);
     string kind = args[0];
@@ -24,7 +41,13 @@ module* model::create(const string& type, const sc_module_name& name) {
 
     auto it = modeldb().find(kind);
     if (it != modeldb().end()) {
+        double start = mwr::timestamp();
         module* mod(it->second(name, args));
+        if (startup_profiler::enabled() && mod) {
+            startup_profiler::record("construct", mod->name(),
+                                     mwr::timestamp() - start);
+        }
+
         VCML_ERROR_ON(!mod, "failed to create instance of %s", kind.c_str());
         if (kind != mod->kind()) {
             mod->log.warn("module kind mismatch, expected %s, is %s",
@@ -83,6 +83,14 @@ void module::session_resume() {
     // to be overloaded
 }
 
+void module::save_state(checkpoint& cp) {
+    // to be overloaded
+}
+
+void module::load_state(checkpoint& cp) {
+    // to be overloaded
+}
+
 bool module::execute(const string& name, const vector<string>& args,
                      ostream& os) {
     command_base* cmd = get_command(name);
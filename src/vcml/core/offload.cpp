@@ -0,0 +1,60 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/offload.h"
+
+namespace vcml {
+
+string offload::prop_name(const char* suffix) const {
+    return mkstr("%s_%s", m_name.c_str(), suffix);
+}
+
+offload::offload(sc_object* parent, const string& nm, bool use_async,
+                 const sc_time& lat, u64 tput):
+    m_name(nm),
+    m_num_jobs(0),
+    m_num_async(0),
+    async(parent, prop_name("async").c_str(), use_async),
+    latency(parent, prop_name("latency").c_str(), lat),
+    throughput(parent, prop_name("throughput").c_str(), tput) {
+    VCML_ERROR_ON(m_name.empty(), "offload needs a name");
+}
+
+sc_time offload::cost(size_t bytes) const {
+    sc_time t = latency;
+    if (throughput > 0 && bytes > 0)
+        t += sc_time((double)bytes / (double)throughput, SC_SEC);
+    return t;
+}
+
+void offload::run(function<void(void)> job, size_t bytes) {
+    sc_time t = cost(bytes);
+    bool in_thread = is_thread() && !sc_is_async();
+
+    m_num_jobs++;
+
+    if (!async || !in_thread) {
+        job();
+        if (in_thread && t > SC_ZERO_TIME)
+            sc_core::wait(t);
+        return;
+    }
+
+    // reporting the cost up front lets simulation advance while the job
+    // runs, the calling process still only resumes once it has finished
+    m_num_async++;
+    sc_async([&]() -> void {
+        if (t > SC_ZERO_TIME)
+            sc_progress(t);
+        job();
+    });
+}
+
+} // namespace vcml
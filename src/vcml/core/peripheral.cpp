@@ -13,6 +13,16 @@
 
 namespace vcml {
 
+// registers are kept sorted by address and never overlap, so the first
+// register that may overlap addr is the first one not ending before it
+static vector<reg_base*>::const_iterator find_first_reg(
+    const vector<reg_base*>& regs, const range& addr) {
+    return std::lower_bound(regs.begin(), regs.end(), addr.start,
+                            [](const reg_base* reg, u64 start) -> bool {
+                                return reg->get_range().end < start;
+                            });
+}
+
 bool peripheral::cmd_mmap(const vector<string>& args, ostream& os) {
     os << "Memory map of " << name();
 
@@ -42,6 +52,18 @@ bool peripheral::cmd_mmap(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool peripheral::cmd_regstats(const vector<string>& args, ostream& os) {
+    if (!register_stats) {
+        os << "register statistics disabled, set "
+           << register_stats.fullname() << " to enable them";
+        return false;
+    }
+
+    size_t limit = args.empty() ? 0 : from_string<size_t>(args[0]);
+    reg_print_stats(os, get_all_registers(), limit);
+    return true;
+}
+
 peripheral::peripheral(const sc_module_name& nm, endianess default_endian,
                        unsigned int rlatency, unsigned int wlatency):
     component(nm),
@@ -49,9 +71,13 @@ peripheral::peripheral(const sc_module_name& nm, endianess default_endian,
     m_registers(),
     endian("endian", default_endian),
     read_latency("read_latency", rlatency),
-    write_latency("write_latency", wlatency) {
+    write_latency("write_latency", wlatency),
+    register_stats("register_stats", false) {
     register_command("mmap", 0, &peripheral::cmd_mmap,
                      "shows the memory map of this peripheral");
+    register_command("regstats", 0, &peripheral::cmd_regstats,
+                     "lists registers sorted by number of accesses, "
+                     "optionally only the given number of top ones");
 }
 
 peripheral::~peripheral() {
@@ -67,22 +93,20 @@ void peripheral::reset() {
 }
 
 void peripheral::add_register(reg_base* reg) {
-    if (stl_contains(m_registers[reg->as], reg))
+    vector<reg_base*>& regs = m_registers[reg->as];
+    if (stl_contains(regs, reg))
         VCML_ERROR("register %s already assigned", reg->name());
 
-    for (auto r : m_registers[reg->as]) {
-        if (r->get_range().overlaps(reg->get_range()))
-            VCML_ERROR(
-                "address space of register %s (%d: %s) already in "
-                "use by register %s",
-                reg->name(), reg->as, to_string(reg->get_range()).c_str(),
-                r->name());
+    auto it = find_first_reg(regs, reg->get_range());
+    if (it != regs.end() && (*it)->get_range().overlaps(reg->get_range())) {
+        VCML_ERROR(
+            "address space of register %s (%d: %s) already in "
+            "use by register %s",
+            reg->name(), reg->as, to_string(reg->get_range()).c_str(),
+            (*it)->name());
     }
 
-    mwr::stl_insert_sorted(m_registers[reg->as], reg,
-                           [](const reg_base* a, const reg_base* b) -> bool {
-                               return a->get_address() < b->get_address();
-                           });
+    regs.insert(regs.begin() + (it - regs.begin()), reg);
 }
 
 void peripheral::remove_register(reg_base* reg) {
@@ -101,6 +125,13 @@ const vector<reg_base*>& peripheral::get_registers(address_space as) const {
     return it->second;
 }
 
+vector<const reg_base*> peripheral::get_all_registers() const {
+    vector<const reg_base*> regs;
+    for (const auto& [as, list] : m_registers)
+        regs.insert(regs.end(), list.begin(), list.end());
+    return regs;
+}
+
 void peripheral::map_dmi(const tlm_dmi& dmi) {
     tlm_dmi copy(dmi);
     copy.set_read_latency(read_cycles());
@@ -121,8 +152,6 @@ unsigned int peripheral::transport(tlm_generic_payload& tx,
     unsigned int swidth = tx.get_streaming_width();
     unsigned char* be_ptr = tx.get_byte_enable_ptr();
     unsigned int be_length = tx.get_byte_enable_length();
-    unsigned int be_index = 0;
-    unsigned int nbytes = 0;
 
     VCML_ERROR_ON(ptr == nullptr, "transaction data pointer cannot be null");
     VCML_ERROR_ON(length == 0, "transaction data length cannot be zero");
@@ -133,34 +162,15 @@ unsigned int peripheral::transport(tlm_generic_payload& tx,
     if (swidth == 0)
         swidth = length;
 
-    unsigned int npulses = length / swidth;
-    for (unsigned int pulse = 0; pulse < npulses && !failed(tx); pulse++) {
-        if (!info.is_debug) {
-            local_time() += tx.is_read() ? clock_cycles(read_latency)
-                                         : clock_cycles(write_latency);
-        }
-
-        if (be_ptr == nullptr) {
-            tx.set_data_ptr(ptr + pulse * swidth);
-            tx.set_data_length(swidth);
-            tx.set_response_status(TLM_INCOMPLETE_RESPONSE);
-            nbytes += receive(tx, info, as);
-        } else {
-            for (unsigned int byte = 0; byte < swidth && !failed(tx); byte++) {
-                if (be_ptr[be_index++ % be_length]) {
-                    tx.set_address(addr + byte);
-                    tx.set_data_ptr(ptr + pulse * swidth + byte);
-                    tx.set_data_length(1);
-                    tx.set_streaming_width(1);
-                    tx.set_byte_enable_ptr(nullptr);
-                    tx.set_byte_enable_length(0);
-                    tx.set_response_status(TLM_INCOMPLETE_RESPONSE);
-                    nbytes += receive(tx, info, as);
-                }
-            }
-        }
+    // beats are dispatched by receive, but latency is accounted for here
+    if (!info.is_debug) {
+        unsigned int npulses = length / swidth;
+        local_time() += tx.is_read() ? clock_cycles(read_latency) * npulses
+                                     : clock_cycles(write_latency) * npulses;
     }
 
+    unsigned int nbytes = receive(tx, info, as);
+
     if (tx.get_response_status() == TLM_INCOMPLETE_RESPONSE)
         VCML_ERROR("invalid out-bound transaction response status");
 
@@ -172,41 +182,35 @@ unsigned int peripheral::transport(tlm_generic_payload& tx,
     tx.set_byte_enable_length(be_length);
 
     // check for quantum overshoot
-    if (!info.is_debug && needs_sync())
+    if (!info.is_debug && needs_sync()) {
+        quantum_count_need_sync();
         sync();
+    }
 
     return nbytes;
 }
 
-unsigned int peripheral::receive(tlm_generic_payload& tx, const tlm_sbi& info,
-                                 address_space as) {
+unsigned int peripheral::receive_regs(tlm_generic_payload& tx,
+                                      const tlm_sbi& info, address_space as,
+                                      const vector<reg_base*>& regs,
+                                      reg_iter first) {
     unsigned int bytes = 0;
-    unsigned int width = tx.get_streaming_width();
-
-    // no streaming support
-    if (width && width != tx.get_data_length()) {
-        tx.set_response_status(TLM_BURST_ERROR_RESPONSE);
-        return 0;
-    }
-
-    // no byte-enable support
-    if (tx.get_byte_enable_ptr() || tx.get_byte_enable_length()) {
-        tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
-        return 0;
-    }
 
     set_current_cpu(info.cpuid);
 
-    for (auto* reg : m_registers[as]) {
-        if (reg->get_range().overlaps(tx)) {
-            bytes += reg->receive(tx, info);
+    const range span(tx);
+    for (auto it = first; it != regs.end(); it++) {
+        reg_base* reg = *it;
+        if (reg->get_range().start > span.end)
+            break;
 
-            if (success(tx) && reg->is_natural_accesses_only())
-                break;
+        bytes += reg->receive(tx, info);
 
-            if (failed(tx))
-                break;
-        }
+        if (success(tx) && reg->is_natural_accesses_only())
+            break;
+
+        if (failed(tx))
+            break;
     }
 
     set_current_cpu(SBI_NONE.cpuid);
@@ -226,6 +230,80 @@ unsigned int peripheral::receive(tlm_generic_payload& tx, const tlm_sbi& info,
     return tx.is_response_ok() ? addr.length() : 0;
 }
 
+// fixed-address bursts present the same address every beat, so registers
+// only get decoded once and their callbacks are invoked once per beat
+unsigned int peripheral::receive_burst(tlm_generic_payload& tx,
+                                       const tlm_sbi& info, address_space as) {
+    sc_dt::uint64 addr = tx.get_address();
+    unsigned char* ptr = tx.get_data_ptr();
+    unsigned int length = tx.get_data_length();
+    unsigned int width = tx.get_streaming_width();
+    unsigned int swidth = width;
+    unsigned char* be_ptr = tx.get_byte_enable_ptr();
+    unsigned int be_length = tx.get_byte_enable_length();
+    unsigned int be_index = 0;
+    unsigned int nbytes = 0;
+
+    if (be_ptr != nullptr && be_length == 0) {
+        tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        return 0;
+    }
+
+    if (swidth == 0 || swidth > length)
+        swidth = length;
+
+    const vector<reg_base*>& regs = get_registers(as);
+    reg_iter beat = find_first_reg(regs, range(addr, addr + swidth - 1));
+
+    unsigned int npulses = length / swidth;
+    for (unsigned int pulse = 0; pulse < npulses && !failed(tx); pulse++) {
+        if (be_ptr == nullptr) {
+            tx.set_address(addr);
+            tx.set_data_ptr(ptr + pulse * swidth);
+            tx.set_data_length(swidth);
+            tx.set_streaming_width(swidth);
+            tx.set_byte_enable_ptr(nullptr);
+            tx.set_byte_enable_length(0);
+            tx.set_response_status(TLM_INCOMPLETE_RESPONSE);
+            nbytes += receive_regs(tx, info, as, regs, beat);
+        } else {
+            for (unsigned int byte = 0; byte < swidth && !failed(tx); byte++) {
+                if (be_ptr[be_index++ % be_length]) {
+                    range span(addr + byte, addr + byte);
+                    tx.set_address(addr + byte);
+                    tx.set_data_ptr(ptr + pulse * swidth + byte);
+                    tx.set_data_length(1);
+                    tx.set_streaming_width(1);
+                    tx.set_byte_enable_ptr(nullptr);
+                    tx.set_byte_enable_length(0);
+                    tx.set_response_status(TLM_INCOMPLETE_RESPONSE);
+                    nbytes += receive_regs(tx, info, as, regs,
+                                           find_first_reg(regs, span));
+                }
+            }
+        }
+    }
+
+    tx.set_address(addr);
+    tx.set_data_ptr(ptr);
+    tx.set_data_length(length);
+    tx.set_streaming_width(width);
+    tx.set_byte_enable_ptr(be_ptr);
+    tx.set_byte_enable_length(be_length);
+
+    return nbytes;
+}
+
+unsigned int peripheral::receive(tlm_generic_payload& tx, const tlm_sbi& info,
+                                 address_space as) {
+    unsigned int width = tx.get_streaming_width();
+    if ((width && width < tx.get_data_length()) || tx.get_byte_enable_ptr())
+        return receive_burst(tx, info, as);
+
+    const vector<reg_base*>& regs = get_registers(as);
+    return receive_regs(tx, info, as, regs, find_first_reg(regs, range(tx)));
+}
+
 tlm_response_status peripheral::read(const range& addr, void* data,
                                      const tlm_sbi& info, address_space as) {
     return read(addr, data, info); // to be overloaded
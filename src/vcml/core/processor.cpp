@@ -19,6 +19,69 @@
 
 namespace vcml {
 
+class processor::regprop : public property<void>
+{
+private:
+    processor& m_cpu;
+    const debugging::cpureg& m_reg;
+    mutable u64 m_gen;
+    bool m_dirty;
+
+    void fetch_lazy() const {
+        if (m_gen == m_cpu.m_regprops_gen)
+            return;
+
+        m_gen = m_cpu.m_regprops_gen;
+        if (!m_dirty && m_reg.is_readable() &&
+            !m_reg.read(raw_ptr(), raw_len()))
+            m_cpu.log.warn("failed to fetch cpureg %s", m_reg.name.c_str());
+    }
+
+public:
+    regprop(processor& cpu, const debugging::cpureg& reg, size_t size,
+            size_t count, u64 defval):
+        property<void>(reg.name.c_str(), size, count, defval),
+        m_cpu(cpu),
+        m_reg(reg),
+        m_gen(cpu.m_regprops_gen),
+        m_dirty(false) {
+        // nothing to do
+    }
+
+    virtual ~regprop() = default;
+
+    virtual const char* str() const override {
+        fetch_lazy();
+        return property<void>::str();
+    }
+
+    virtual void str(const string& s) override {
+        fetch_lazy();
+        property<void>::str(s);
+        if (!m_dirty) {
+            m_dirty = true;
+            m_cpu.m_dirty_regprops.push_back(this);
+        }
+    }
+
+    void fetch() {
+        m_gen = m_cpu.m_regprops_gen;
+        if (m_reg.is_readable() && !m_reg.read(raw_ptr(), raw_len()))
+            m_cpu.log.warn("failed to fetch cpureg %s", m_reg.name.c_str());
+    }
+
+    void flush() {
+        m_dirty = false;
+        if (m_reg.is_writeable() && !m_reg.write(raw_ptr(), raw_len()))
+            m_cpu.log.warn("failed to flush cpureg %s", m_reg.name.c_str());
+    }
+
+    void update(const void* buf, size_t len) {
+        if (buf != raw_ptr()) // flush writes straight from our buffer
+            memcpy(raw_ptr(), buf, min(raw_len(), len));
+    }
+};
+
 bool processor::cmd_dump(const vector<string>& args, ostream& os) {
     os << "Registers:" << std::endl
        << "  PC 0x" << HEX(program_counter(), 16) << std::endl
@@ -46,6 +109,9 @@ bool processor::cmd_dump(const vector<string>& args, ostream& os) {
         }
     }
 
+    os << "Idle:" << std::endl
+       << "  " << m_idle_cycles << " cycles, " << m_idle_time << std::endl;
+
     return true;
 }
 
@@ -93,6 +159,7 @@ bool processor::cmd_symbols(const vector<string>& args, ostream& os) {
 
     try {
         u64 n = load_symbols_from_elf(args[0]);
+        invalidate_stack_cache();
         os << "Found " << n << " symbols in file '" << args[0] << "'";
         return true;
     } catch (std::exception& e) {
@@ -117,6 +184,84 @@ bool processor::cmd_lsym(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool processor::disassemble_cached(const range& addr,
+                                   vector<debugging::disassembly>& s) {
+    u64 size = (addr.length() + 7) & ~7ul; // want at least 8 bytes
+    vector<u8> mem(size);
+
+    size = read_vmem_dbg(addr.start, mem.data(), mem.size());
+    if (size == 0)
+        return false;
+
+    u64 pgsz;
+    bool virt = page_size(pgsz);
+
+    u64 pos = addr.start;
+    u8* ptr = mem.data();
+    u8* end = ptr + size;
+
+    while (pos < addr.start + size) {
+        debugging::disassembly disas = {};
+        disas.addr = pos;
+
+        u64 phys = pos;
+        bool cacheable = !virt || virt_to_phys(pos, phys);
+
+        auto it = m_disas_cache.end();
+        if (cacheable)
+            it = m_disas_cache.find(phys);
+
+        // guest stores through dmi bypass us, so compare the bytes
+        if (it != m_disas_cache.end() && it->second.size <= (u64)(end - ptr) &&
+            memcmp(it->second.insn, ptr, it->second.size) == 0) {
+            disas.code = it->second.code;
+            disas.size = it->second.size;
+            pos += disas.size;
+        } else {
+            if (!disassemble(ptr, pos, disas.code))
+                break;
+
+            disas.size = pos - disas.addr;
+            const u64 lim = sizeof(disas.insn);
+            VCML_ERROR_ON(disas.size == 0, "disassembler address stuck");
+            VCML_ERROR_ON(disas.size > lim, "insn size exceeds limit");
+
+            if (cacheable) {
+                if (m_disas_cache.size() >= DISAS_CACHE_ENTRIES)
+                    m_disas_cache.clear();
+
+                disas_entry& entry = m_disas_cache[phys];
+                memcpy(entry.insn, ptr, disas.size);
+                entry.size = disas.size;
+                entry.code = disas.code;
+            }
+        }
+
+        memcpy(disas.insn, ptr, disas.size);
+
+        disas.sym = target::symbols().find_function(disas.addr);
+        s.push_back(disas);
+        ptr += disas.size;
+    }
+
+    return ptr > mem.data();
+}
+
+void processor::invalidate_disas_cache(u64 start, u64 end) {
+    if (start > end)
+        return;
+
+    // entries starting below start may still overlap it
+    u64 lo = start > 16 ? start - 16 : 0;
+    auto it = m_disas_cache.lower_bound(lo);
+    while (it != m_disas_cache.end() && it->first <= end) {
+        if (it->first + it->second.size > start)
+            it = m_disas_cache.erase(it);
+        else
+            ++it;
+    }
+}
+
 bool processor::cmd_disas(const vector<string>& args, ostream& os) {
     u64 vstart = program_counter();
     if (args.size() > 0)
@@ -132,7 +277,7 @@ bool processor::cmd_disas(const vector<string>& args, ostream& os) {
     }
 
     vector<debugging::disassembly> disas;
-    if (!disassemble({ vstart, vend }, disas)) {
+    if (!disassemble_cached({ vstart, vend }, disas)) {
         os << "Disassembler reported error";
         return false;
     }
@@ -200,10 +345,20 @@ bool processor::cmd_v2p(const vector<string>& args, ostream& os) {
 
 bool processor::cmd_stack(const vector<string>& args, ostream& os) {
     stream_guard guard(os);
-    vector<debugging::stackframe> frames;
-    stacktrace(frames);
 
-    for (const auto& frame : frames) {
+    u64 pc = program_counter();
+    u64 sp = stack_pointer();
+    u64 fp = frame_pointer();
+    if (!m_stack_cache.valid || m_stack_cache.pc != pc ||
+        m_stack_cache.sp != sp || m_stack_cache.fp != fp) {
+        stacktrace(m_stack_cache.frames);
+        m_stack_cache.valid = true;
+        m_stack_cache.pc = pc;
+        m_stack_cache.sp = sp;
+        m_stack_cache.fp = fp;
+    }
+
+    for (const auto& frame : m_stack_cache.frames) {
         os << "[" << HEX(frame.program_counter, 16) << "]";
         if (frame.sym != nullptr) {
             os << " " << frame.sym->name() << " +0x" << std::hex
@@ -242,6 +397,22 @@ bool processor::cmd_gdb(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool processor::cmd_stats(const vector<string>& args, ostream& os) {
+    processor_stats stats = get_stats();
+    os << "quanta:      " << stats.num_quanta << std::endl
+       << "cycles:      " << stats.num_cycles << std::endl
+       << "idle cycles: " << stats.num_idle_cycles << std::endl
+       << "run time:    " << stats.run_time << "s" << std::endl
+       << "sync time:   " << stats.sync_time << "s" << std::endl
+       << "mips:        " << stats.mips << std::endl
+       << "bus errors:  " << stats.num_bus_errors << std::endl
+       << "insn dmi:    " << stats.insn_dmi_hits << " hits, "
+       << stats.insn_dmi_misses << " misses" << std::endl
+       << "data dmi:    " << stats.data_dmi_hits << " hits, "
+       << stats.data_dmi_misses << " misses";
+    return true;
+}
+
 u64 processor::simulate_cycles(size_t cycles) {
     u64 count = cycle_count();
     double start = mwr::timestamp();
@@ -252,6 +423,26 @@ u64 processor::simulate_cycles(size_t cycles) {
     return cycle_count() - count;
 }
 
+bool processor::cmd_profile(const vector<string>& args, ostream& os) {
+    if (m_profiler == nullptr) {
+        os << "Profiling disabled, set " << profile.basename() << " to enable";
+        return false;
+    }
+
+    os << m_profiler->samples() << " samples taken every "
+       << profile_interval.get() << std::endl;
+    m_profiler->write_flat(os);
+    return true;
+}
+
+bool processor::cmd_bus_errors(const vector<string>& args, ostream& os) {
+    os << "Bus errors of " << name() << ": ";
+    m_bus_errors.summary(os, [&](u64 source) -> string {
+        return source ? data.name() : insn.name();
+    });
+    return true;
+}
+
 void processor::processor_thread() {
     wait(SC_ZERO_TIME);
 
@@ -262,7 +453,9 @@ void processor::processor_thread() {
         // check for standby requests
         wait_clock_reset();
 
-        if (async && !is_stepping()) {
+        if (parallel && !is_stepping()) {
+            running = processor_thread_parallel();
+        } else if (async && !is_stepping()) {
             vcml::sc_async([&]() { running = processor_thread_async(); });
         } else {
             running = processor_thread_sync();
@@ -291,8 +484,9 @@ bool processor::processor_thread_async() {
 
         for (sc_time offset = async_time_offset(); offset < quantum;
              offset = async_time_offset()) {
-            u64 step_size = (quantum / clock_cycle()) / async_rate;
-            u64 cycles_left = (quantum - offset) / clock_cycle();
+            u64 cycle = max<u64>(clock_cycle_ticks(), 1);
+            u64 step_size = (quantum.value() / cycle) / async_rate;
+            u64 cycles_left = (quantum - offset).value() / cycle;
 
             // fall back to sequential simulation when single-stepping
             if (is_stepping())
@@ -307,15 +501,138 @@ bool processor::processor_thread_async() {
 
             simulate_cycles(min(cycles_left, step_size));
             update_local_time(lt, current_process());
+            m_idle = false; // idle fast-forward requires sync mode
             sc_progress(lt);
             lt = SC_ZERO_TIME;
         }
 
-        while (sim_running() && async_time_offset() >= quantum)
-            mwr::cpu_yield();
+        double start = mwr::timestamp();
+        async_wait_offset(quantum);
+        m_sync_time += mwr::timestamp() - start;
+        m_num_quanta++;
     }
 }
 
+struct platform_idle_state {
+    size_t processors = 0;
+    size_t sleeping = 0;
+};
+
+static platform_idle_state& idle_state() {
+    static platform_idle_state state;
+    return state;
+}
+
+static sc_event& wakeup_event() {
+    static sc_event ev;
+    return ev;
+}
+
+bool processor::platform_idle() {
+    const platform_idle_state& state = idle_state();
+    return state.processors > 0 && state.sleeping == state.processors;
+}
+
+const sc_event& processor::platform_wakeup() {
+    return wakeup_event();
+}
+
+bool processor::processor_idle() {
+    m_idle = false;
+
+    // wait-for-interrupt completes immediately if an irq is pending
+    for (const irq_stats& stats : m_irq_stats)
+        if (stats.irq_status)
+            return false;
+
+    sync();
+
+    sc_time start = sc_time_stamp();
+    m_sleeping = true;
+    idle_state().sleeping++;
+    wait(m_idle_ev);
+    if (platform_idle())
+        wakeup_event().notify(SC_ZERO_TIME);
+    idle_state().sleeping--;
+    m_sleeping = false;
+
+    sc_time delta = sc_time_stamp() - start;
+    if (delta == SC_ZERO_TIME)
+        return false;
+
+    m_idle_time += delta;
+    if (u64 cycle = clock_cycle_ticks())
+        m_idle_cycles += delta.value() / cycle;
+
+    return true;
+}
+
+void processor::trace_simulate(const sc_time& start) {
+    if (tracer::any())
+        tracer::record_slice(*this, "simulate", start, local_time_stamp());
+}
+
+void processor::processor_sample() {
+    if (m_profiler == nullptr)
+        return;
+
+    sc_time now = local_time_stamp();
+    if (now < m_next_sample)
+        return;
+
+    // samples are weighted by the number of intervals that have passed,
+    // since a single simulate call may cover several of them
+    const sc_time& interval = profile_interval.get();
+    u64 weight = (u64)((now - m_next_sample) / interval) + 1;
+    m_profiler->sample(weight);
+    m_next_sample += weight * interval;
+}
+
+void processor::processor_sync() {
+    double start = mwr::timestamp();
+    sync();
+    m_sync_time += mwr::timestamp() - start;
+
+    quantum_count_sync();
+    m_num_quanta++;
+    if (stats_interval > 0u && m_num_quanta % stats_interval == 0) {
+        processor_stats stats = get_stats();
+        for (const auto& hook : m_stats_hooks)
+            hook(*this, stats);
+    }
+}
+
+bool processor::processor_thread_parallel() {
+    debugging::suspender::handle_requests();
+    if (!sim_running())
+        return false;
+
+    // every parallel processor simulates its quantum on its own host thread
+    // while waiting for the next quantum boundary turns the systemc kernel
+    // into a barrier: no processor starts a new quantum before all others
+    // have finished the current one
+    sc_time quantum = tlm_global_quantum::instance().get();
+    u64 cycle = max<u64>(clock_cycle_ticks(), 1);
+    u64 num_cycles = max<u64>(quantum.value() / cycle, 1);
+
+    if (is_running()) {
+        sc_time start = local_time_stamp();
+        sc_async([&]() { simulate_cycles(num_cycles); }, deterministic);
+        update_local_time(local_time(), current_process());
+        trace_simulate(start);
+        processor_sample();
+    }
+
+    if (is_idle() && processor_idle())
+        return true;
+
+    if (local_time() == SC_ZERO_TIME)
+        local_time() = quantum;
+
+    processor_sync();
+    return true;
+}
+
 bool processor::processor_thread_sync() {
     do {
         debugging::suspender::handle_requests();
@@ -323,32 +640,39 @@ bool processor::processor_thread_sync() {
             return false;
 
         unsigned int num_cycles = 1;
+        u64 cycle = clock_cycle_ticks();
         sc_time quantum = tlm_global_quantum::instance().get();
-        if (quantum > clock_cycle() && quantum > local_time()) {
-            sc_time time_left = quantum - local_time();
-            num_cycles = time_left / clock_cycle();
+        if (cycle && quantum.value() > cycle && quantum > local_time()) {
+            u64 time_left = (quantum - local_time()).value();
+            num_cycles = time_left / cycle;
 
             // if there will be less than one clock_cycle left in the current
             // quantum -> do one more instruction
-            if (time_left % clock_cycle() != SC_ZERO_TIME)
+            if (time_left % cycle)
                 ++num_cycles;
         }
 
         if (is_stepping())
             num_cycles = 1;
 
-        if (is_running())
+        if (is_running()) {
+            sc_time start = local_time_stamp();
             num_cycles = simulate_cycles(num_cycles);
-        else
-            wait(num_cycles * clock_cycle());
+            trace_simulate(start);
+            processor_sample();
+        } else {
+            wait(clock_cycles(num_cycles));
+        }
 
         if (is_stepping() && num_cycles > 0)
             notify_singlestep();
+        if (is_idle() && !is_stepping() && processor_idle())
+            return true;
         if (is_running() && num_cycles == 0)
             wait(quantum - local_time());
     } while (!needs_sync());
 
-    sync();
+    processor_sync();
 
     return true;
 }
@@ -357,10 +681,31 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
     component(nm),
     target(),
     m_run_time(0),
+    m_sync_time(0),
     m_cycle_count(0),
+    m_cycle_base(0),
+    m_num_quanta(0),
+    m_num_bus_errors(0),
+    m_bus_errors(),
+    m_stats_hooks(),
+    m_idle(false),
+    m_sleeping(false),
+    m_idle_ev("idle_ev"),
+    m_idle_time(SC_ZERO_TIME),
+    m_idle_cycles(0),
     m_gdb(nullptr),
+    m_profiler(nullptr),
+    m_next_sample(SC_ZERO_TIME),
     m_irq_stats(),
+    m_irq_pending(),
+    m_irq_gen(0),
     m_regprops(),
+    m_dirty_regprops(),
+    m_regprops_gen(0),
+    m_disas_cache(),
+    m_stack_cache(),
+    m_fetch_block(),
+    m_fetch_epoch(0),
     cpuarch("arch", cpuarch),
     symbols("symbols"),
     gdb_wait("gdb_wait", false),
@@ -369,28 +714,25 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
     gdb_term("gdb_term", "gdbterm"),
     async("async", false),
     async_rate("async_rate", 5),
+    parallel("parallel", false),
+    deterministic("deterministic", false),
+    stats_interval("stats_interval", 0),
+    profile("profile", false),
+    profile_interval("profile_interval", sc_time(1, SC_MS)),
+    profile_output("profile_output", ""),
+    bus_error_limit("bus_error_limit", 4),
     irq("irq"),
     insn("insn"),
     data("data") {
     SC_HAS_PROCESS(processor);
     SC_THREAD(processor_thread);
 
-    if (!symbols.get().empty()) {
-        vector<string> symfiles = split(symbols);
-        for (auto symfile : symfiles) {
-            symfile = trim(symfile);
-            if (symfile.empty())
-                continue;
-
-            if (!mwr::file_exists(symfile)) {
-                log_warn("cannot open file '%s'", symfile.c_str());
-                continue;
-            }
+    idle_state().processors++;
+    wakeup_event(); // create during elaboration
 
-            u64 n = load_symbols_from_elf(symfile);
-            log_debug("loaded %llu symbols from '%s'", n, symfile.c_str());
-        }
-    }
+    // symbols get loaded at end_of_elaboration, parsing starts right away
+    for (const string& symfile : split(symbols))
+        debugging::symtab::prefetch_elf(trim(symfile));
 
     register_command("dump", 0, &processor::cmd_dump,
                      "dump internal state of the processor");
@@ -408,11 +750,22 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
                      "generates a stack trace for the current function");
     register_command("gdb", 0, &processor::cmd_gdb,
                      "opens a new gdb debug session");
+    register_command("stats", 0, &processor::cmd_stats,
+                     "prints runtime statistics of this processor");
+    register_command("profile", 0, &processor::cmd_profile,
+                     "prints the flat execution profile of this processor");
+    register_command("buserrors", 0, &processor::cmd_bus_errors,
+                     "prints bus errors counted per port and address");
 }
 
 processor::~processor() {
+    idle_state().processors--;
+    if (m_sleeping)
+        idle_state().sleeping--;
     if (m_gdb)
         delete m_gdb;
+    if (m_profiler)
+        delete m_profiler;
     for (auto reg : m_regprops)
         delete reg.second;
 }
@@ -421,7 +774,17 @@ void processor::reset() {
     component::reset();
 
     m_cycle_count = 0;
+    m_cycle_base = 0;
     m_run_time = 0.0;
+    m_sync_time = 0.0;
+    m_num_quanta = 0;
+    m_num_bus_errors = 0;
+    m_bus_errors.reset();
+
+    m_idle = false;
+    m_idle_time = SC_ZERO_TIME;
+    m_idle_cycles = 0;
+    m_idle_ev.notify(SC_ZERO_TIME);
 
     for (auto reg : m_regprops)
         reg.second->reset();
@@ -429,27 +792,122 @@ void processor::reset() {
     flush_cpuregs();
 }
 
+void processor::invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                          u64 start, u64 end) {
+    invalidate_disas_cache(start, end);
+
+    if (&origin == &insn && m_fetch_block.ptr &&
+        m_fetch_block.addr.overlaps({ start, end })) {
+        m_fetch_block.ptr = nullptr;
+        m_fetch_epoch++;
+    }
+
+    component::invalidate_direct_mem_ptr(origin, start, end);
+}
+
+const u8* processor::fetch_block(u64 addr, u64& size) {
+    if (!m_fetch_block.ptr || !m_fetch_block.addr.includes(addr)) {
+        // also asks the target for dmi if it is not cached already
+        if (!insn.lookup_dmi_ptr(addr, 1, VCML_ACCESS_READ))
+            return nullptr;
+
+        tlm_dmi dmi;
+        if (!insn.dmi_cache().lookup({ addr, addr }, VCML_ACCESS_READ, dmi))
+            return nullptr;
+
+        m_fetch_block.addr = range(dmi);
+        m_fetch_block.ptr = dmi.get_dmi_ptr();
+    }
+
+    size = m_fetch_block.addr.end - addr + 1;
+    return m_fetch_block.ptr + addr - m_fetch_block.addr.start;
+}
+
 void processor::session_suspend() {
     component::session_suspend();
-    fetch_cpuregs();
+    m_regprops_gen++;
 }
 
 void processor::session_resume() {
     component::session_resume();
+    flush_dirty_cpuregs();
+    invalidate_stack_cache();
+    m_regprops_gen++;
+}
+
+void processor::save_state(checkpoint& cp) {
+    component::save_state(cp);
+    fetch_cpuregs();
+}
+
+void processor::load_state(checkpoint& cp) {
+    component::load_state(cp);
     flush_cpuregs();
 }
 
-bool processor::get_irq_stats(size_t irq, irq_stats& stats) const {
-    if (m_irq_stats.find(irq) == m_irq_stats.end())
+bool processor::get_irq_stats(size_t irqno, irq_stats& stats) const {
+    if (irqno >= m_irq_stats.size() || !irq.exists(irqno))
         return false;
 
-    stats = m_irq_stats.at(irq);
+    stats = m_irq_stats[irqno];
     return true;
 }
+processor_stats processor::get_stats() const {
+    processor_stats stats;
+    stats.num_quanta = m_num_quanta;
+    stats.num_cycles = cycle_count() - m_cycle_base;
+    stats.num_idle_cycles = m_idle_cycles;
+    stats.num_bus_errors = m_num_bus_errors;
+    stats.insn_dmi_hits = insn.dmi_hits();
+    stats.insn_dmi_misses = insn.dmi_misses();
+    stats.data_dmi_hits = data.dmi_hits();
+    stats.data_dmi_misses = data.dmi_misses();
+    stats.run_time = m_run_time;
+    stats.sync_time = m_sync_time;
+    stats.mips = m_run_time > 0.0 ? stats.num_cycles / m_run_time / 1e6 : 0.0;
+    return stats;
+}
+
+void processor::reset_stats() {
+    m_cycle_base = cycle_count();
+    m_run_time = 0.0;
+    m_sync_time = 0.0;
+    m_num_quanta = 0;
+    m_num_bus_errors = 0;
+    m_bus_errors.reset();
+    m_idle_time = SC_ZERO_TIME;
+    m_idle_cycles = 0;
+
+    insn.reset_stats();
+    data.reset_stats();
+
+    for (irq_stats& stats : m_irq_stats) {
+        stats.irq_count = 0;
+        stats.irq_uptime = SC_ZERO_TIME;
+        stats.irq_longest = SC_ZERO_TIME;
+        if (stats.irq_status)
+            stats.irq_last = sc_time_stamp();
+    }
+
+    if (m_profiler)
+        m_profiler->reset();
+}
+
+void processor::add_stats_hook(stats_hook hook) {
+    m_stats_hooks.push_back(std::move(hook));
+}
 
 void processor::log_bus_error(const tlm_initiator_socket& socket,
                               vcml_access rwx, tlm_response_status rs,
                               u64 addr, u64 size) {
+    m_num_bus_errors++;
+
+    // repeated errors at the same address are only reported with back-off
+    // and not at all after bus_error_limit reports, see buserrors command
+    u64 source = &socket == &insn ? 0 : 1;
+    if (!m_bus_errors.record(source, addr, bus_error_limit))
+        return;
+
     string op;
     switch (rwx) {
     case VCML_ACCESS_READ:
@@ -470,14 +928,44 @@ void processor::log_bus_error(const tlm_initiator_socket& socket,
     log_debug("  lr   = 0x%016llx", link_register());
     log_debug("  sp   = 0x%016llx", stack_pointer());
     log_debug("  size = %llu bytes", size);
-    log_debug("  port = %s", data.name());
+    log_debug("  port = %s", socket.name());
     log_debug("  code = %s", status.c_str());
+
+    u64 count = m_bus_errors.count(source, addr);
+    if (count > 1)
+        log_debug("  seen = %llu times", count);
+}
+
+irq_stats& processor::lookup_irq_stats(size_t irqno) {
+    // only irqs bound after elaboration can end up here
+    if (irqno >= m_irq_stats.size()) {
+        size_t first = m_irq_stats.size();
+        m_irq_stats.resize(irqno + 1);
+        for (size_t i = first; i <= irqno; i++)
+            m_irq_stats[i].irq = i;
+    }
+
+    return m_irq_stats[irqno];
+}
+
+void processor::update_irq_pending(size_t irqno, bool state) {
+    if (irqno >= max_pending_irqs())
+        return;
+
+    u64 mask = 1ull << (irqno % 64);
+    atomic<u64>& word = m_irq_pending[irqno / 64];
+    if (state)
+        word.fetch_or(mask, std::memory_order_release);
+    else
+        word.fetch_and(~mask, std::memory_order_release);
+
+    m_irq_gen.fetch_add(1, std::memory_order_release);
 }
 
 void processor::gpio_notify(const gpio_target_socket& socket, bool state,
                             gpio_vector vector) {
     size_t irqno = irq.index_of(socket);
-    irq_stats& stats = m_irq_stats[irqno];
+    irq_stats& stats = lookup_irq_stats(irqno);
 
     if (state == stats.irq_status) {
         log_warn("irq %zu already %s", irqno, state ? "set" : "cleared");
@@ -485,10 +973,13 @@ void processor::gpio_notify(const gpio_target_socket& socket, bool state,
     }
 
     stats.irq_status = state;
+    update_irq_pending(irqno, state);
 
     if (state) {
         stats.irq_count++;
         stats.irq_last = sc_time_stamp();
+        m_idle_ev.notify(SC_ZERO_TIME);
+        quantum_count_irq();
     } else {
         sc_time delta = sc_time_stamp() - stats.irq_last;
         if (delta > stats.irq_longest)
@@ -517,19 +1008,54 @@ void processor::update_local_time(sc_time& local_time, sc_process_b* proc) {
     }
 }
 
+void processor::end_of_simulation() {
+    component::end_of_simulation();
+
+    processor_stats stats = get_stats();
+    for (const auto& hook : m_stats_hooks)
+        hook(*this, stats);
+
+    if (m_profiler && !profile_output.get().empty()) {
+        string flat = profile_output.get() + ".flat";
+        string folded = profile_output.get() + ".folded";
+
+        ofstream of(flat);
+        ofstream ff(folded);
+        if (!of || !ff) {
+            log_warn("cannot write profile to '%s'",
+                     profile_output.get().c_str());
+            return;
+        }
+
+        m_profiler->write_flat(of);
+        m_profiler->write_folded(ff);
+        log_debug("wrote profile with %llu samples to '%s' and '%s'",
+                  m_profiler->samples(), flat.c_str(), folded.c_str());
+    }
+}
+
 void processor::end_of_elaboration() {
     component::end_of_elaboration();
 
-    for (auto it : irq) {
-        irq_stats& stats = m_irq_stats[it.first];
-        stats.irq = it.first;
-        stats.irq_count = 0;
-        stats.irq_status = false;
-        stats.irq_last = SC_ZERO_TIME;
-        stats.irq_uptime = SC_ZERO_TIME;
-        stats.irq_longest = SC_ZERO_TIME;
+    for (auto symfile : split(symbols)) {
+        symfile = trim(symfile);
+        if (symfile.empty())
+            continue;
+
+        if (!mwr::file_exists(symfile)) {
+            log_warn("cannot open file '%s'", symfile.c_str());
+            continue;
+        }
+
+        u64 n = load_symbols_from_elf(symfile);
+        log_debug("loaded %llu symbols from '%s'", n, symfile.c_str());
     }
 
+    m_irq_stats.clear();
+    m_irq_stats.resize(irq.next_index());
+    for (size_t i = 0; i < m_irq_stats.size(); i++)
+        m_irq_stats[i].irq = i;
+
     if (gdb_port >= 0) {
         auto run = gdb_wait ? debugging::GDB_STOPPED : debugging::GDB_RUNNING;
         m_gdb = new debugging::gdbserver(gdb_port, *this, run);
@@ -541,38 +1067,32 @@ void processor::end_of_elaboration() {
         log_info("%s for GDB connection on port %hu",
                  gdb_wait ? "waiting" : "listening", m_gdb->port());
     }
+
+    if (profile) {
+        VCML_ERROR_ON(profile_interval.get() == SC_ZERO_TIME,
+                      "%s cannot be zero", profile_interval.basename());
+        if (async)
+            log_warn("profiling is not supported in async mode");
+        m_profiler = new debugging::profiler(*this);
+        m_next_sample = profile_interval;
+    }
 }
 
 void processor::fetch_cpuregs() {
-    for (auto it : m_regprops) {
-        const debugging::cpureg* reg = find_cpureg(it.first);
-        VCML_ERROR_ON(!reg, "no cpureg %llu", it.first);
-
-        auto* prop = it.second;
-        VCML_ERROR_ON(!prop, "no propery for cpureg %llu", it.first);
-
-        if (!reg->is_readable())
-            continue;
-
-        if (!reg->read(prop->raw_ptr(), prop->raw_len()))
-            log_warn("failed to fetch cpureg %s", reg->name.c_str());
-    }
+    for (auto it : m_regprops)
+        it.second->fetch();
 }
 
 void processor::flush_cpuregs() {
-    for (auto it : m_regprops) {
-        const debugging::cpureg* reg = find_cpureg(it.first);
-        VCML_ERROR_ON(!reg, "no cpureg %llu", it.first);
-
-        auto* prop = it.second;
-        VCML_ERROR_ON(!prop, "no propery for cpureg %llu", it.first);
-
-        if (!reg->is_writeable())
-            continue;
+    for (auto it : m_regprops)
+        it.second->flush();
+    m_dirty_regprops.clear();
+}
 
-        if (!reg->write(prop->raw_ptr(), prop->raw_len()))
-            log_warn("failed to flush cpureg %s", reg->name.c_str());
-    }
+void processor::flush_dirty_cpuregs() {
+    for (regprop* prop : m_dirty_regprops)
+        prop->flush();
+    m_dirty_regprops.clear();
 }
 
 void processor::define_cpureg(size_t regno, const string& name, size_t size,
@@ -587,7 +1107,7 @@ void processor::define_cpureg(size_t regno, const string& name, size_t size,
 
     auto*& prop = m_regprops[regno];
     VCML_ERROR_ON(prop, "property %s already exists", name.c_str());
-    prop = new property<void>(name.c_str(), size, nelem, defval);
+    prop = new regprop(*this, *find_cpureg(regno), size, nelem, defval);
 }
 
 void processor::define_cpureg_r(size_t regno, const string& name, size_t size,
@@ -624,10 +1144,8 @@ bool processor::write_cpureg_dbg(const debugging::cpureg& reg, const void* buf,
         return false;
 
     auto it = m_regprops.find(reg.regno);
-    if (it != m_regprops.end()) {
-        auto* prop = it->second;
-        memcpy(prop->raw_ptr(), buf, min(prop->raw_len(), len));
-    }
+    if (it != m_regprops.end())
+        it->second->update(buf, len);
 
     return true;
 }
@@ -647,6 +1165,9 @@ u64 processor::read_pmem_dbg(u64 addr, void* buffer, u64 size) {
 }
 
 u64 processor::write_pmem_dbg(u64 addr, const void* buffer, u64 size) {
+    invalidate_disas_cache(addr, addr + size - 1);
+    invalidate_stack_cache();
+
     try {
         if (success(data.write(addr, buffer, size, SBI_DEBUG)))
             return size;
@@ -31,6 +31,7 @@ reg_base::reg_base(address_space space, const string& regname, u64 addr,
     m_secure(0),
     m_privilege(0),
     m_host(hierarchy_search<peripheral>()),
+    m_stats(),
     as(space),
     tag() {
     VCML_ERROR_ON(m_cell_size == 0, "register cell size cannot be 0");
@@ -112,7 +113,19 @@ unsigned int reg_base::receive(tlm_generic_payload& tx, const tlm_sbi& info) {
     }
 
     m_host->trace_fw(*this, tx, m_host->local_time());
-    do_receive(tx, info);
+
+    if (m_host->register_stats && !info.is_debug) {
+        double start = mwr::timestamp();
+        do_receive(tx, info);
+        m_stats.time += mwr::timestamp() - start;
+        if (tx.is_read())
+            m_stats.num_reads++;
+        if (tx.is_write())
+            m_stats.num_writes++;
+    } else {
+        do_receive(tx, info);
+    }
+
     m_host->trace_bw(*this, tx, m_host->local_time());
 
     tx.set_address(addr);
@@ -123,4 +136,34 @@ unsigned int reg_base::receive(tlm_generic_payload& tx, const tlm_sbi& info) {
     return tx.is_response_ok() ? span.length() : 0;
 }
 
+void reg_print_stats(ostream& os, vector<const reg_base*> regs,
+                     size_t limit) {
+    std::stable_sort(regs.begin(), regs.end(),
+                     [](const reg_base* a, const reg_base* b) -> bool {
+                         return a->stats().num_accesses() >
+                                b->stats().num_accesses();
+                     });
+
+    if (limit > 0 && regs.size() > limit)
+        regs.resize(limit);
+
+    size_t width = 8;
+    for (const reg_base* reg : regs)
+        width = max(width, strlen(reg->name()));
+
+    stream_guard guard(os);
+    os << std::left << std::setw(width) << "register" << std::right
+       << std::setw(12) << "reads" << std::setw(12) << "writes"
+       << std::setw(12) << "time [us]";
+
+    for (const reg_base* reg : regs) {
+        const reg_stats& stats = reg->stats();
+        os << std::endl
+           << std::left << std::setw(width) << reg->name() << std::right
+           << std::setw(12) << stats.num_reads << std::setw(12)
+           << stats.num_writes << std::setw(12) << std::fixed
+           << std::setprecision(1) << stats.time * 1e6;
+    }
+}
+
 } // namespace vcml
@@ -0,0 +1,210 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/replay.h"
+#include "vcml/logging/logger.h"
+
+namespace vcml {
+
+struct replay_header {
+    char magic[8];
+    u32 version;
+    u32 reserved;
+    double resolution;
+};
+
+enum replay_entry : u8 {
+    ENTRY_CHANNEL = 1,
+    ENTRY_INPUT = 2,
+};
+
+static const char REPLAY_MAGIC[8] = "vcmlrpl";
+static const u32 REPLAY_VERSION = 1;
+
+struct replay_input {
+    u64 time;
+    vector<u8> data;
+};
+
+struct replay_stream {
+    mutex mtx;
+    string path;
+    ofstream os;
+    bool replaying = false;
+    unordered_map<string, u32> channels;
+    unordered_map<string, deque<replay_input>> inputs;
+};
+
+static replay_stream& stream() {
+    static replay_stream instance;
+    return instance;
+}
+
+template <typename T>
+static void put(ostream& os, const T& val) {
+    os.write((const char*)&val, sizeof(val));
+}
+
+template <typename T>
+static bool get(istream& is, T& val) {
+    return (bool)is.read((char*)&val, sizeof(val));
+}
+
+void replay_channel::deliver_inputs() {
+    deque<replay_input> inputs;
+    {
+        replay_stream& s = stream();
+        lock_guard<mutex> guard(s.mtx);
+        inputs.swap(s.inputs[m_name]);
+    }
+
+    for (const replay_input& input : inputs) {
+        sc_time t = time_from_value(input.time);
+        if (t > sc_time_stamp())
+            sc_core::wait(t - sc_time_stamp());
+        m_deliver(input.data.data(), input.data.size());
+    }
+}
+
+replay_channel::replay_channel(const string& name):
+    m_name(name), m_id(~0u), m_replaying(false), m_deliver() {
+    replay_stream& s = stream();
+    lock_guard<mutex> guard(s.mtx);
+    m_replaying = s.replaying;
+    if (!s.os.is_open())
+        return;
+
+    VCML_ERROR_ON(stl_contains(s.channels, name),
+                  "replay channel %s already exists", name.c_str());
+
+    m_id = s.channels.size();
+    s.channels[name] = m_id;
+
+    put(s.os, ENTRY_CHANNEL);
+    put(s.os, m_id);
+    put(s.os, (u32)name.length());
+    s.os.write(name.c_str(), name.length());
+}
+
+void replay_channel::record(const void* data, size_t size) {
+    if (!is_recording())
+        return;
+
+    replay_stream& s = stream();
+    lock_guard<mutex> guard(s.mtx);
+    put(s.os, ENTRY_INPUT);
+    put(s.os, m_id);
+    put(s.os, (u64)sc_time_stamp().value());
+    put(s.os, (u32)size);
+    s.os.write((const char*)data, size);
+    VCML_ERROR_ON(!s.os, "error writing %s", s.path.c_str());
+}
+
+void replay_channel::replay(const handler& deliver) {
+    if (!m_replaying || m_deliver)
+        return;
+
+    string nm = "replay_" + m_name;
+    std::replace(nm.begin(), nm.end(), '.', '_');
+
+    m_deliver = deliver;
+    sc_spawn([this]() -> void { deliver_inputs(); }, nm.c_str());
+}
+
+void replay_record(const string& path) {
+    replay_close();
+
+    replay_stream& s = stream();
+    lock_guard<mutex> guard(s.mtx);
+    s.os.open(path, std::ios::binary | std::ios::trunc);
+    VCML_REPORT_ON(!s.os, "cannot open %s: %s", path.c_str(),
+                   strerror(errno));
+
+    replay_header hdr = {};
+    memcpy(hdr.magic, REPLAY_MAGIC, sizeof(hdr.magic));
+    hdr.version = REPLAY_VERSION;
+    hdr.resolution = sc_get_time_resolution().to_seconds();
+    put(s.os, hdr);
+    s.path = path;
+}
+
+void replay_open(const string& path) {
+    replay_close();
+
+    ifstream is(path, std::ios::binary);
+    VCML_REPORT_ON(!is, "cannot open %s: %s", path.c_str(), strerror(errno));
+
+    replay_header hdr;
+    if (!get(is, hdr) || memcmp(hdr.magic, REPLAY_MAGIC, 8) != 0 ||
+        hdr.version != REPLAY_VERSION) {
+        VCML_REPORT("%s is not a replay file", path.c_str());
+    }
+
+    if (hdr.resolution != sc_get_time_resolution().to_seconds())
+        log_warn("%s was recorded with a different time resolution",
+                 path.c_str());
+
+    replay_stream& s = stream();
+    lock_guard<mutex> guard(s.mtx);
+    unordered_map<u32, string> names;
+
+    replay_entry type;
+    u32 id, size;
+    while (get(is, type) && get(is, id)) {
+        if (type == ENTRY_CHANNEL) {
+            VCML_REPORT_ON(!get(is, size), "%s truncated", path.c_str());
+            string& name = names[id];
+            name.resize(size);
+            is.read(&name[0], size);
+        } else if (type == ENTRY_INPUT) {
+            replay_input input;
+            if (!get(is, input.time) || !get(is, size))
+                VCML_REPORT("%s truncated", path.c_str());
+            input.data.resize(size);
+            is.read((char*)input.data.data(), size);
+            VCML_REPORT_ON(!stl_contains(names, id),
+                           "%s: unknown channel %u", path.c_str(), id);
+            s.inputs[names[id]].push_back(std::move(input));
+        } else {
+            VCML_REPORT("%s corrupted", path.c_str());
+        }
+
+        VCML_REPORT_ON(!is, "%s truncated", path.c_str());
+    }
+
+    s.path = path;
+    s.replaying = true;
+}
+
+void replay_close() {
+    replay_stream& s = stream();
+    lock_guard<mutex> guard(s.mtx);
+    if (s.os.is_open())
+        s.os.close();
+
+    s.path.clear();
+    s.replaying = false;
+    s.channels.clear();
+    s.inputs.clear();
+}
+
+bool replay_recording() {
+    replay_stream& s = stream();
+    lock_guard<mutex> guard(s.mtx);
+    return s.os.is_open();
+}
+
+bool replay_replaying() {
+    replay_stream& s = stream();
+    lock_guard<mutex> guard(s.mtx);
+    return s.replaying;
+}
+
+} // namespace vcml
@@ -0,0 +1,141 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/roi.h"
+#include "vcml/core/processor.h"
+#include "vcml/core/system.h"
+#include "vcml/tracing/tracer.h"
+
+namespace vcml {
+
+static bool g_roi_active = false;
+
+template <typename FN>
+static void for_each_object(const sc_object* root, FN fn) {
+    if (root) {
+        fn(root);
+        for (const sc_object* child : root->get_child_objects())
+            for_each_object(child, fn);
+        return;
+    }
+
+    for (const sc_object* obj : sc_core::sc_get_top_level_objects())
+        for_each_object(obj, fn);
+}
+
+template <typename FN>
+static void for_each_processor(const sc_object* root, FN fn) {
+    for_each_object(root, [&](const sc_object* obj) {
+        if (auto* proc = dynamic_cast<const processor*>(obj))
+            fn(const_cast<processor&>(*proc));
+    });
+}
+
+bool roi_active() {
+    return g_roi_active;
+}
+
+void roi_begin(bool tracing) {
+    if (g_roi_active)
+        log_warn("region of interest already active, restarting");
+
+    g_roi_active = true;
+    platform_reset_stats();
+    for_each_processor(nullptr, [](processor& proc) {
+        if (proc.get_profiler())
+            proc.get_profiler()->resume();
+    });
+
+    if (tracing)
+        tracer::resume();
+
+    log_info("entering region of interest at %s",
+             sc_time_stamp().to_string().c_str());
+}
+
+void roi_end(bool tracing) {
+    if (!g_roi_active)
+        log_warn("region of interest ended without having begun");
+
+    g_roi_active = false;
+    for_each_processor(nullptr, [](processor& proc) {
+        if (proc.get_profiler())
+            proc.get_profiler()->pause();
+    });
+
+    if (tracing)
+        tracer::pause();
+
+    log_info("leaving region of interest at %s",
+             sc_time_stamp().to_string().c_str());
+}
+
+void platform_reset_stats(sc_object* root) {
+    for_each_processor(root, [](processor& proc) { proc.reset_stats(); });
+    tlm_reset_stats(root);
+}
+
+void platform_print_stats(ostream& os, const sc_object* root) {
+    os << "processor,quanta,cycles,idle_cycles,bus_errors,run_time,"
+       << "sync_time,mips" << std::endl;
+    for_each_processor(root, [&](processor& proc) {
+        processor_stats stats = proc.get_stats();
+        os << proc.name() << "," << stats.num_quanta << ","
+           << stats.num_cycles << "," << stats.num_idle_cycles << ","
+           << stats.num_bus_errors << "," << stats.run_time << ","
+           << stats.sync_time << "," << stats.mips << std::endl;
+    });
+
+    os << std::endl;
+    tlm_print_stats(os, root);
+}
+
+void platform_dump_stats(const string& path, const string& title) {
+    stringstream ss;
+    platform_print_stats(ss);
+
+    if (path.empty()) {
+        log_info("%s\n%s", title.c_str(), ss.str().c_str());
+        return;
+    }
+
+    ofstream of(path, std::ios::app);
+    if (!of) {
+        log_warn("cannot open %s: %s", path.c_str(), strerror(errno));
+        return;
+    }
+
+    of << "# " << title << std::endl << ss.str() << std::endl;
+}
+
+bool platform_checkpoint(const string& path) {
+    system* sys = nullptr;
+    for (sc_object* obj : sc_core::sc_get_top_level_objects())
+        if ((sys = dynamic_cast<system*>(obj)) != nullptr)
+            break;
+
+    if (sys == nullptr)
+        return false;
+
+    // processors may be in the middle of their quantum right now, so wait
+    // for the update phase where all processes have yielded
+    on_next_update([sys, path]() -> void {
+        try {
+            sys->save_checkpoint(path, sys->checkpoint_compress);
+        } catch (std::exception& ex) {
+            log_error("error saving checkpoint to %s: %s", path.c_str(),
+                      ex.what());
+        }
+    });
+
+    return true;
+}
+
+} // namespace vcml
@@ -49,8 +49,15 @@ setup::setup(int argc, char** argv):
     m_log_debug("--log-debug", "Activate verbose debug logging"),
     m_log_stdout("--log-stdout", "Send log output to stdout"),
     m_log_files("--log-file", "-l", "Send log output to file"),
+    m_log_async("--log-async", "Write log output from a background thread"),
+    m_profile_startup("--profile-startup", "Report time spent during startup"),
     m_trace_stdout("--trace-stdout", "Send tracing output to stdout"),
+    m_trace_buffered("--trace-buffered", "Buffer terminal tracing output"),
     m_trace_files("--trace", "-t", "Send tracing output to file"),
+    m_trace_bin_files("--trace-bin", "Send binary tracing output to file"),
+    m_trace_chrome_files("--trace-chrome", "Send chrome trace events to file"),
+    m_trace_vcd_files("--trace-vcd", "Send gpio and clock waveforms to file"),
+    m_trace_vcd_tlm("--trace-vcd-tlm", "Add tlm address and command to vcd"),
     m_config_files("--file", "-f", "Load configuration from file"),
     m_config_options("--config", "-c", "Specify individual property values"),
     m_help("--help", "-h", "Prints this message", exit_usage),
@@ -65,6 +72,9 @@ setup::setup(int argc, char** argv):
     if (!mwr::options::parse(argc, argv))
         exit_usage();
 
+    if (m_profile_startup.value())
+        startup_profiler::enable();
+
 #ifdef VCML_DEBUG
     log_level min = LOG_ERROR;
     log_level max = LOG_DEBUG;
@@ -77,13 +87,21 @@ setup::setup(int argc, char** argv):
         max = m_log_debug ? LOG_DEBUG : LOG_INFO;
 
     for (const string& file : m_log_files.values()) {
-        mwr::publisher* pub = new mwr::publishers::file(file);
+        mwr::publisher* pub = nullptr;
+        if (m_log_async.value())
+            pub = new async_publisher(file);
+        else
+            pub = new mwr::publishers::file(file);
         pub->set_level(min, max);
         m_publishers.push_back(pub);
     }
 
     if (m_log_stdout.value() || !m_log_files.has_value()) {
-        mwr::publisher* pub = new mwr::publishers::terminal(true);
+        mwr::publisher* pub = nullptr;
+        if (m_log_async.value())
+            pub = new async_publisher(std::cout);
+        else
+            pub = new mwr::publishers::terminal(true);
         pub->set_level(min, max);
         m_publishers.push_back(pub);
     }
@@ -93,8 +111,25 @@ setup::setup(int argc, char** argv):
         m_tracers.push_back(t);
     }
 
+    for (const string& file : m_trace_bin_files.values()) {
+        tracer* t = new tracer_bin(file);
+        m_tracers.push_back(t);
+    }
+
+    for (const string& file : m_trace_chrome_files.values()) {
+        tracer* t = new tracer_chrome(file);
+        m_tracers.push_back(t);
+    }
+
+    for (const string& file : m_trace_vcd_files.values()) {
+        tracer* t = new tracer_vcd(file, m_trace_vcd_tlm.value());
+        m_tracers.push_back(t);
+    }
+
     if (m_trace_stdout) {
-        tracer* t = new tracer_term(true);
+        bool buffered = m_trace_buffered.value();
+        tracer* t = new tracer_term(true, mwr::is_tty(mwr::STDERR_FDNO),
+                                    buffered);
         m_tracers.push_back(t);
     }
 
@@ -0,0 +1,109 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/startup.h"
+#include "vcml/logging/logger.h"
+
+namespace vcml {
+
+bool startup_profiler::s_enabled = false;
+
+struct startup_data {
+    mutex mtx;
+    double start = 0.0;
+    std::map<pair<string, string>, startup_profiler::entry> entries;
+};
+
+static startup_data& startup() {
+    static startup_data data;
+    return data;
+}
+
+void startup_profiler::enable(bool on) {
+    startup_data& data = startup();
+    lock_guard<mutex> guard(data.mtx);
+    if (on && !s_enabled)
+        data.start = mwr::timestamp();
+    s_enabled = on;
+}
+
+void startup_profiler::record(const char* phase, const string& name,
+                              double secs) {
+    startup_data& data = startup();
+    lock_guard<mutex> guard(data.mtx);
+    entry& e = data.entries[{ phase, name }];
+    if (e.count++ == 0) {
+        e.phase = phase;
+        e.name = name;
+    }
+
+    e.seconds += secs;
+}
+
+vector<startup_profiler::entry> startup_profiler::entries() {
+    startup_data& data = startup();
+    lock_guard<mutex> guard(data.mtx);
+
+    vector<entry> result;
+    for (const auto& it : data.entries)
+        result.push_back(it.second);
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](const entry& a, const entry& b) {
+                         return a.seconds > b.seconds;
+                     });
+    return result;
+}
+
+double startup_profiler::elapsed() {
+    startup_data& data = startup();
+    lock_guard<mutex> guard(data.mtx);
+    return data.start > 0.0 ? mwr::timestamp() - data.start : 0.0;
+}
+
+void startup_profiler::reset() {
+    startup_data& data = startup();
+    lock_guard<mutex> guard(data.mtx);
+    data.entries.clear();
+    data.start = s_enabled ? mwr::timestamp() : 0.0;
+}
+
+void startup_profiler::report(ostream& os, size_t limit) {
+    vector<entry> all = entries();
+    size_t w = 0;
+    for (const entry& e : all)
+        w = max(w, e.phase.length());
+
+    stream_guard guard(os);
+    os << "startup took " << std::fixed << std::setprecision(1)
+       << elapsed() * 1e3 << "ms";
+
+    size_t n = 0;
+    for (const entry& e : all) {
+        if (limit > 0 && n++ >= limit) {
+            os << "\n  ... " << all.size() - limit << " more";
+            break;
+        }
+
+        os << "\n  " << std::setw(8) << e.seconds * 1e3 << "ms "
+           << mwr::pad(e.phase, w) << " " << e.name;
+        if (e.count > 1)
+            os << " (" << e.count << "x)";
+    }
+}
+
+void startup_profiler::log_report() {
+    stringstream ss;
+    report(ss, 50);
+    for (const string& line : split(ss.str(), '\n'))
+        log_info("%s", line.c_str());
+}
+
+} // namespace vcml
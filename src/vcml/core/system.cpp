@@ -9,6 +9,11 @@
  ******************************************************************************/
 
 #include "vcml/core/system.h"
+#include "vcml/core/component.h"
+#include "vcml/core/processor.h"
+#include "vcml/core/peripheral.h"
+#include "vcml/core/checkpoint.h"
+#include "vcml/core/replay.h"
 
 namespace vcml {
 
@@ -31,6 +36,53 @@ static void list_object_properties(sc_object* obj) {
         list_object_properties(child);
 }
 
+static void save_module_state(checkpoint& cp, sc_object* obj) {
+    module* mod = dynamic_cast<module*>(obj);
+    if (mod != nullptr)
+        mod->save_state(cp);
+
+    for (auto child : obj->get_child_objects())
+        save_module_state(cp, child);
+}
+
+static void load_module_state(checkpoint& cp, sc_object* obj) {
+    module* mod = dynamic_cast<module*>(obj);
+    if (mod != nullptr)
+        mod->load_state(cp);
+
+    for (auto child : obj->get_child_objects())
+        load_module_state(cp, child);
+}
+
+static void collect_processors(sc_object* obj, vector<processor*>& procs) {
+    processor* proc = dynamic_cast<processor*>(obj);
+    if (proc != nullptr)
+        procs.push_back(proc);
+
+    for (auto child : obj->get_child_objects())
+        collect_processors(child, procs);
+}
+
+static void collect_registers(sc_object* obj, vector<const reg_base*>& regs) {
+    peripheral* periph = dynamic_cast<peripheral*>(obj);
+    if (periph != nullptr && periph->register_stats) {
+        vector<const reg_base*> list = periph->get_all_registers();
+        regs.insert(regs.end(), list.begin(), list.end());
+    }
+
+    for (auto child : obj->get_child_objects())
+        collect_registers(child, regs);
+}
+
+static void reset_components(sc_object* obj) {
+    component* comp = dynamic_cast<component*>(obj);
+    if (comp != nullptr)
+        comp->do_reset();
+
+    for (auto child : obj->get_child_objects())
+        reset_components(child);
+}
+
 SC_HAS_PROCESS(system);
 
 void system::timeout() {
@@ -41,8 +93,225 @@ void system::timeout() {
     }
 }
 
+void system::adapt_quantum() {
+    VCML_ERROR_ON(quantum_period == SC_ZERO_TIME, "zero quantum period");
+    VCML_ERROR_ON(quantum_min > quantum_max, "invalid quantum bounds");
+
+    quantum_stats prev = get_quantum_stats();
+    while (true) {
+        // there is nothing to adapt to while all processors sleep, so do
+        // not wake up the kernel every period until one of them resumes
+        if (processor::platform_idle())
+            wait(processor::platform_wakeup());
+
+        wait(quantum_period);
+
+        quantum_stats curr = get_quantum_stats();
+        u64 irqs = curr.num_irqs - prev.num_irqs;
+        u64 syncs = curr.num_syncs - prev.num_syncs;
+        u64 forced = curr.num_need_syncs - prev.num_need_syncs;
+        prev = curr;
+
+        // shrink when more than one interrupt or forced sync arrives every
+        // other quantum on average, grow when there was no activity at all
+        sc_time curr_quantum = tlm_global_quantum::instance().get();
+        double quanta = max(quantum_period.get() / curr_quantum, 1.0);
+        double activity = (irqs + forced) / quanta;
+
+        sc_time next_quantum = curr_quantum;
+        if (activity > 0.5)
+            next_quantum = max(curr_quantum / 2, quantum_min.get());
+        else if (irqs + forced == 0)
+            next_quantum = min(curr_quantum * 2, quantum_max.get());
+
+        if (next_quantum == curr_quantum)
+            continue;
+
+        m_quantum_changes++;
+        tlm_global_quantum::instance().set(next_quantum);
+        log_debug("quantum %s -> %s (%llu irqs, %llu forced syncs, "
+                  "%llu syncs)",
+                  curr_quantum.to_string().c_str(),
+                  next_quantum.to_string().c_str(), irqs, forced, syncs);
+    }
+}
+
+void system::checkpoint_thread() {
+    wait(checkpoint_at);
+    save_checkpoint(checkpoint_file, checkpoint_compress);
+    if (checkpoint_period == SC_ZERO_TIME)
+        return;
+
+    // every checkpoint_full checkpoints, start over with a full one to keep
+    // the chain that needs to be replayed on restore short
+    for (size_t n = 1; true; n++) {
+        wait(checkpoint_period);
+        bool full = checkpoint_full > 0u && n % checkpoint_full == 0;
+        string path = mkstr("%s.%zu", checkpoint_file.get().c_str(), n);
+        save_checkpoint(path, checkpoint_compress, !full);
+    }
+}
+
+void system::take_sample(monitor_sample& sample) const {
+    sample.host = mwr::timestamp_us();
+    sample.sim = sc_time_stamp();
+    sample.deltas = sc_delta_count();
+    sample.events = get_update_queue_stats().num_jobs;
+    sample.cycles.clear();
+    for (const processor* proc : m_processors)
+        sample.cycles.push_back(proc->cycle_count());
+}
+
+void system::report_sample(const monitor_sample& prev,
+                           const monitor_sample& curr, bool summary) {
+    double host = (curr.host - prev.host) / 1e6;
+    if (host <= 0.0)
+        return;
+
+    double rtf = (curr.sim - prev.sim).to_seconds() / host;
+    double deltas = (curr.deltas - prev.deltas) / host;
+    double events = (curr.events - prev.events) / host;
+
+    double total = 0.0;
+    vector<double> mips(m_processors.size());
+    for (size_t i = 0; i < m_processors.size(); i++) {
+        mips[i] = (curr.cycles[i] - prev.cycles[i]) / host / 1e6;
+        total += mips[i];
+    }
+
+    const char* kind = summary ? "summary" : "progress";
+    if (m_monitor_file.is_open()) {
+        m_monitor_file << kind << "," << host << "," << curr.sim.to_seconds()
+                       << "," << rtf << "," << total << "," << deltas << ","
+                       << events;
+        for (double val : mips)
+            m_monitor_file << "," << val;
+        m_monitor_file << std::endl;
+        return;
+    }
+
+    stringstream ss;
+    for (size_t i = 0; i < m_processors.size(); i++)
+        ss << ", " << m_processors[i]->name() << " " << mips[i];
+
+    log_info("%s: real-time factor %.3f, %.1f MIPS%s, %.0f deltas/s, "
+             "%.0f events/s", kind, rtf, total, ss.str().c_str(), deltas,
+             events);
+}
+
+void system::report_progress() {
+    monitor_sample curr;
+    take_sample(curr);
+    report_sample(m_last_sample, curr, false);
+    m_last_sample = std::move(curr);
+}
+
+void system::monitor_host() {
+    mwr::set_thread_name("vcml_monitor");
+    auto period = std::chrono::microseconds(time_to_us(monitor_period));
+    auto stopped = [&]() -> bool { return m_monitor_stop; };
+
+    std::unique_lock<mutex> lock(m_monitor_mtx);
+    while (!m_monitor_cv.wait_for(lock, period, stopped))
+        on_next_update([this]() -> void { report_progress(); });
+}
+
+void system::start_monitor() {
+    collect_processors(this, m_processors);
+
+    if (!monitor_file.get().empty()) {
+        m_monitor_file.open(monitor_file);
+        if (!m_monitor_file)
+            log_warn("cannot open %s", monitor_file.get().c_str());
+
+        m_monitor_file << "kind,host,sim,rtf,mips,deltas,events";
+        for (const processor* proc : m_processors)
+            m_monitor_file << "," << proc->name();
+        m_monitor_file << std::endl;
+    }
+
+    take_sample(m_first_sample);
+    m_last_sample = m_first_sample;
+    m_monitor_stop = false;
+    m_monitor_thread = thread(&system::monitor_host, this);
+}
+
+void system::stop_monitor() {
+    if (!m_monitor_thread.joinable())
+        return;
+
+    {
+        lock_guard<mutex> guard(m_monitor_mtx);
+        m_monitor_stop = true;
+    }
+
+    m_monitor_cv.notify_all();
+    m_monitor_thread.join();
+
+    monitor_sample curr;
+    take_sample(curr);
+    report_sample(m_first_sample, curr, true);
+    m_monitor_file.close();
+}
+
+bool system::cmd_checkpoint(const vector<string>& args, ostream& os) {
+    try {
+        save_checkpoint(args[0], checkpoint_compress);
+        os << "checkpoint saved to " << args[0];
+        return true;
+    } catch (std::exception& ex) {
+        os << "error saving checkpoint: " << ex.what();
+        return false;
+    }
+}
+
+bool system::cmd_reset(const vector<string>& args, ostream& os) {
+    reset_platform();
+    os << "platform reset";
+    return true;
+}
+
+bool system::cmd_tlm_stats(const vector<string>& args, ostream& os) {
+    if (args.empty()) {
+        tlm_print_stats(os);
+        return true;
+    }
+
+    ofstream of(args[0]);
+    if (!of) {
+        os << "cannot open " << args[0] << ": " << strerror(errno);
+        return false;
+    }
+
+    tlm_print_stats(of);
+    os << "tlm statistics written to " << args[0];
+    return true;
+}
+
+bool system::cmd_regstats(const vector<string>& args, ostream& os) {
+    vector<const reg_base*> regs;
+    for (sc_object* obj : sc_core::sc_get_top_level_objects())
+        collect_registers(obj, regs);
+
+    size_t limit = args.empty() ? 20 : from_string<size_t>(args[0]);
+    reg_print_stats(os, regs, limit);
+    return true;
+}
+
 system::system(const sc_module_name& nm):
     module(nm),
+    m_quantum_changes(0),
+    m_last_checkpoint(),
+    m_saved_properties(),
+    m_processors(),
+    m_first_sample(),
+    m_last_sample(),
+    m_monitor_file(),
+    m_monitor_thread(),
+    m_monitor_mtx(),
+    m_monitor_cv(),
+    m_monitor_stop(false),
+    m_metrics(),
     name("name", mwr::progname()),
     desc("desc", mwr::progname()),
     config("config", ""),
@@ -50,19 +319,144 @@ system::system(const sc_module_name& nm):
     session("session", -1),
     session_debug("session_debug", false),
     quantum("quantum", sc_time(1, SC_US)),
-    duration("duration", SC_ZERO_TIME) {
+    duration("duration", SC_ZERO_TIME),
+    adaptive_quantum("adaptive_quantum", false),
+    quantum_min("quantum_min", sc_time(100, SC_NS)),
+    quantum_max("quantum_max", sc_time(100, SC_US)),
+    quantum_period("quantum_period", sc_time(1, SC_MS)),
+    async_pool("async_pool", 0),
+    restore("restore", ""),
+    checkpoint_file("checkpoint_file", ""),
+    checkpoint_at("checkpoint_at", SC_ZERO_TIME),
+    checkpoint_period("checkpoint_period", SC_ZERO_TIME),
+    checkpoint_full("checkpoint_full", 0),
+    checkpoint_compress("checkpoint_compress", false),
+    monitor_period("monitor_period", SC_ZERO_TIME),
+    monitor_file("monitor_file", ""),
+    metrics_port("metrics_port", 0),
+    record("record", ""),
+    replay("replay", ""),
+    fork_server("fork_server", 0),
+    fork_at("fork_at", SC_ZERO_TIME) {
     if (backtrace)
         mwr::report_segfaults();
 
+    if (async_pool > 0u)
+        sc_async_pool(async_pool);
+
+    if (!replay.get().empty()) {
+        if (!record.get().empty())
+            log_warn("cannot record while replaying, ignoring %s",
+                     record.basename());
+        replay_open(replay);
+    } else if (!record.get().empty()) {
+        replay_record(record);
+    }
+
     if (duration > SC_ZERO_TIME)
         SC_THREAD(timeout);
 
+    if (adaptive_quantum)
+        SC_THREAD(adapt_quantum);
+
+    if (!checkpoint_file.get().empty()) {
+        if (checkpoint_at > SC_ZERO_TIME || checkpoint_period > SC_ZERO_TIME)
+            SC_THREAD(checkpoint_thread);
+        else
+            log_warn("%s requires %s or %s to be set",
+                     checkpoint_file.basename(), checkpoint_at.basename(),
+                     checkpoint_period.basename());
+    }
+
+    register_command("checkpoint", 1, &system::cmd_checkpoint,
+                     "saves a checkpoint of the whole platform to the "
+                     "given file, use restore to start from it later");
+    register_command("reset", 0, &system::cmd_reset,
+                     "resets all components of the platform in place");
+    register_command("tlm_stats", 0, &system::cmd_tlm_stats,
+                     "lists transaction counters of all tlm sockets of the "
+                     "platform, optionally writes them to the given file");
+    register_command("regstats", 0, &system::cmd_regstats,
+                     "lists the most accessed registers of all peripherals "
+                     "with register_stats enabled, 20 unless specified");
+
     if (config.get().empty())
         log_warn("no configuration specified, use -f <config>");
 }
 
 system::~system() {
-    // nothing to do
+    stop_monitor();
+    m_metrics.reset();
+    replay_close();
+}
+
+void system::save_checkpoint(const string& path, bool compress,
+                             bool incremental) {
+    if (m_last_checkpoint.empty())
+        incremental = false;
+    if (!incremental)
+        m_saved_properties.clear();
+
+    string parent = incremental ? m_last_checkpoint : "";
+    checkpoint cp(path, true, compress, parent);
+    save_module_state(cp, this);
+    cp.save_properties(*this, this, &m_saved_properties);
+    m_last_checkpoint = path;
+
+    const char* kind = incremental ? "incremental" : "full";
+    log_info("saved %s checkpoint to %s at %s", kind, path.c_str(),
+             sc_time_stamp().to_string().c_str());
+}
+
+void system::load_checkpoint(const string& path) {
+    checkpoint cp(path, false);
+    if (cp.is_incremental())
+        load_checkpoint(cp.parent());
+
+    cp.load_properties(*this, this);
+    load_module_state(cp, this);
+    log_info("restored checkpoint %s taken at %s", path.c_str(),
+             cp.time().to_string().c_str());
+}
+
+void system::reset_platform() {
+    reset_components(this);
+    log_info("platform reset at %s", sc_time_stamp().to_string().c_str());
+}
+
+void system::start_of_simulation() {
+    module::start_of_simulation();
+    if (!restore.get().empty())
+        load_checkpoint(restore);
+
+    if (monitor_period > SC_ZERO_TIME)
+        start_monitor();
+
+    if (metrics_port > 0) {
+        m_metrics.reset(new debugging::metrics_server(metrics_port));
+        m_metrics->start();
+    }
+}
+
+void system::fork_prepare() {
+    stop_monitor();
+    m_metrics.reset();
+}
+
+void system::fork_child() {
+    if (monitor_period > SC_ZERO_TIME)
+        start_monitor();
+
+    if (metrics_port > 0) {
+        m_metrics.reset(new debugging::metrics_server(metrics_port));
+        m_metrics->start();
+    }
+}
+
+void system::end_of_simulation() {
+    module::end_of_simulation();
+    stop_monitor();
+    m_metrics.reset();
 }
 
 int system::run() {
@@ -74,7 +468,18 @@ int system::run() {
     broker::report_unused();
     tlm::tlm_global_quantum::instance().set(quantum);
 
+    int result = EXIT_SUCCESS;
+
     try {
+        if (fork_server > 0) {
+            sc_core::sc_start(fork_at);
+            string request;
+            if (!fork_serve(fork_server, request))
+                return EXIT_FAILURE;
+            log_info("serving request '%s' from %s", request.c_str(),
+                     sc_time_stamp().to_string().c_str());
+        }
+
         if (session >= 0) {
             vcml::debugging::vspserver vspsession(session);
             vspsession.echo(session_debug);
@@ -93,16 +498,17 @@ int system::run() {
         }
     } catch (sc_report& rep) {
         log_error("%s", rep.what());
-        return EXIT_FAILURE;
+        result = EXIT_FAILURE;
     } catch (std::exception& ex) {
         log_error("Caught c++ exception: %s", ex.what());
-        return EXIT_FAILURE;
+        result = EXIT_FAILURE;
     } catch (...) {
         log_error("Caught unknown exception");
-        return EXIT_FAILURE;
+        result = EXIT_FAILURE;
     }
 
-    return EXIT_SUCCESS;
+    fork_exit(result);
+    return result;
 }
 
 } // namespace vcml
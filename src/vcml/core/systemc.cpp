@@ -11,6 +11,7 @@
 #include "vcml/core/version.h"
 #include "vcml/core/systemc.h"
 #include "vcml/core/thctl.h"
+#include "vcml/core/startup.h"
 
 namespace vcml {
 
@@ -211,6 +212,125 @@ bool kernel_has_phase_callbacks() {
 #endif
 }
 
+// hierarchical timing wheel over simulation time ticks: every level holds
+// 256 slots, an event lives on the level of the highest tick byte in which
+// its timeout differs from the current time and is cascaded down to lower
+// levels once time reaches the start of its slot; inserting is O(1) and
+// cancelled events are dropped whenever their slot gets processed
+class timer_wheel
+{
+private:
+    static constexpr size_t BITS = 8;
+    static constexpr size_t SLOTS = 1ull << BITS;
+    static constexpr size_t LEVELS = 64 / BITS;
+    static constexpr size_t WORDS = SLOTS / 64;
+
+    u64 m_now;
+    size_t m_count;
+    vector<async_timer::event*> m_slots[LEVELS][SLOTS];
+    u64 m_used[LEVELS][WORDS];
+
+    static size_t slot_index(u64 ticks, size_t level) {
+        return (ticks >> (level * BITS)) & (SLOTS - 1);
+    }
+
+    void place(async_timer::event* ev) {
+        u64 ticks = max<u64>(ev->timeout.value(), m_now);
+        u64 diff = ticks ^ m_now;
+        size_t level = diff ? fls(diff) / BITS : 0;
+        size_t idx = slot_index(ticks, level);
+        m_slots[level][idx].push_back(ev);
+        m_used[level][idx / 64] |= 1ull << (idx % 64);
+        m_count++;
+    }
+
+    bool find_slot(size_t level, size_t start, size_t& idx) const {
+        for (size_t word = start / 64; word < WORDS; word++) {
+            u64 mask = m_used[level][word];
+            if (word == start / 64)
+                mask &= ~0ull << (start % 64);
+            if (mask) {
+                idx = word * 64 + ctz(mask);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // earliest non-empty slot and the first tick it covers
+    bool next_slot(size_t& level, size_t& idx, u64& bound) const {
+        for (level = 0; level < LEVELS; level++) {
+            size_t start = slot_index(m_now, level) + (level ? 1 : 0);
+            if (start >= SLOTS || !find_slot(level, start, idx))
+                continue;
+
+            size_t shift = level * BITS;
+            u64 upper = shift + BITS < 64 ? ~0ull << (shift + BITS) : 0;
+            bound = (m_now & upper) | ((u64)idx << shift);
+            return true;
+        }
+
+        return false;
+    }
+
+public:
+    bool empty() const { return m_count == 0; }
+
+    timer_wheel(): m_now(0), m_count(0), m_slots(), m_used() {}
+    ~timer_wheel() { clear(); }
+
+    void insert(async_timer::event* ev) { place(ev); }
+
+    u64 next_bound() const {
+        size_t level, idx;
+        u64 bound = m_now;
+        next_slot(level, idx, bound);
+        return bound;
+    }
+
+    void advance(u64 now, vector<async_timer::event*>& expired) {
+        size_t level, idx;
+        u64 bound;
+
+        while (next_slot(level, idx, bound) && bound <= now) {
+            m_now = bound;
+
+            vector<async_timer::event*> slot;
+            slot.swap(m_slots[level][idx]);
+            m_used[level][idx / 64] &= ~(1ull << (idx % 64));
+            m_count -= slot.size();
+
+            for (async_timer::event* ev : slot) {
+                if (ev->owner == nullptr)
+                    delete ev;
+                else if (ev->timeout.value() <= m_now)
+                    expired.push_back(ev);
+                else
+                    place(ev);
+            }
+        }
+
+        m_now = max(m_now, now);
+    }
+
+    void clear() {
+        for (auto& level : m_slots) {
+            for (auto& slot : level) {
+                for (async_timer::event* ev : slot)
+                    delete ev;
+                slot.clear();
+            }
+        }
+
+        for (auto& level : m_used)
+            for (u64& word : level)
+                word = 0;
+
+        m_count = 0;
+    }
+};
+
 // we just need this class to have something that is called every cycle...
 class helper_module : public sc_core::sc_trace_file,
                       public sc_core::sc_prim_channel
@@ -272,41 +392,47 @@ public:
 
     mutex mtx;
 
-    vector<function<void(void)>> next_update;
+    // lock-free multi-producer single-consumer stack of pending update
+    // jobs, the consumer takes all jobs at once and restores their order
+    struct update_job {
+        function<void(void)> func;
+        update_job* next;
+    };
+
+    atomic<update_job*> next_update;
+    atomic<size_t> update_depth;
+    atomic<size_t> update_max_depth;
+    atomic<u64> update_jobs;
+    atomic<u64> update_batches;
+
+    void push_update(function<void(void)> func) {
+        update_depth++;
+        update_job* job = new update_job{ std::move(func), next_update };
+        while (!next_update.compare_exchange_weak(job->next, job)) {
+            // job->next has been updated to the current head, retry
+        }
+    }
+
+    // phase callbacks remember who registered them for startup profiling
+    struct phase_callback {
+        string owner;
+        function<void(void)> func;
+    };
 
-    vector<function<void(void)>> end_of_elab;
-    vector<function<void(void)>> start_of_sim;
+    vector<phase_callback> end_of_elab;
+    vector<phase_callback> start_of_sim;
     vector<function<void(void)>> end_of_sim;
 
     vector<function<void(void)>> deltas;
     vector<function<void(void)>> tsteps;
 
-    struct timer_compare {
-        inline bool operator()(const async_timer::event* a,
-                               const async_timer::event* b) const {
-            return a->timeout > b->timeout;
-        }
-    };
-
     sc_event timeout_event;
-    priority_queue<async_timer::event*, vector<async_timer::event*>,
-                   timer_compare>
-        timers;
+    timer_wheel timers;
 
     vector<async_timer::event*> pending_timers() {
         lock_guard<mutex> guard(mtx);
         vector<async_timer::event*> pending;
-        sc_time now = sc_time_stamp();
-
-        while (!timers.empty()) {
-            async_timer::event* event = timers.top();
-            if (event->timeout > now)
-                break;
-
-            timers.pop();
-            pending.push_back(event);
-        }
-
+        timers.advance(sc_time_stamp().value(), pending);
         return pending;
     }
 
@@ -318,7 +444,7 @@ public:
             return;
         }
 
-        sc_time next_timeout = timers.top()->timeout;
+        sc_time next_timeout = time_from_value(timers.next_bound());
         if (next_timeout < sc_time_stamp())
             timeout_event.notify(SC_ZERO_TIME);
         else
@@ -336,23 +462,147 @@ public:
         update_timer();
     }
 
+    // binary min-heap of pending deadline timers, each of them knows its
+    // own position so that it can be re-armed or cancelled in place
+    vector<deadline_timer*> deadlines;
+    sc_event deadline_event;
+    sc_time deadline_armed;
+    u64 deadline_seq;
+
+    // deadlines expiring at the same time fire in the order they were set
+    static bool earlier(const deadline_timer* a, const deadline_timer* b) {
+        if (a->m_timeout != b->m_timeout)
+            return a->m_timeout < b->m_timeout;
+        return a->m_seq < b->m_seq;
+    }
+
+    void place_deadline(deadline_timer* dt, size_t pos) {
+        deadlines[pos] = dt;
+        dt->m_pos = pos;
+    }
+
+    void sift_deadline(size_t pos) {
+        deadline_timer* dt = deadlines[pos];
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (!earlier(dt, deadlines[parent]))
+                break;
+            place_deadline(deadlines[parent], pos);
+            pos = parent;
+        }
+
+        size_t n = deadlines.size();
+        while (2 * pos + 1 < n) {
+            size_t child = 2 * pos + 1;
+            size_t right = child + 1;
+            if (right < n && earlier(deadlines[right], deadlines[child]))
+                child = right;
+            if (!earlier(deadlines[child], dt))
+                break;
+            place_deadline(deadlines[child], pos);
+            pos = child;
+        }
+
+        place_deadline(dt, pos);
+    }
+
+    void arm_deadlines() {
+        if (deadlines.empty()) {
+            deadline_event.cancel();
+            deadline_armed = SC_MAX_TIME;
+            return;
+        }
+
+        const sc_time& next = deadlines.front()->m_timeout;
+        if (next == deadline_armed)
+            return;
+
+        sc_time now = sc_time_stamp();
+        deadline_armed = next;
+        deadline_event.cancel();
+        deadline_event.notify(next > now ? next - now : SC_ZERO_TIME);
+    }
+
+    void insert_deadline(deadline_timer* dt) {
+        dt->m_seq = deadline_seq++;
+        if (dt->is_pending()) {
+            sift_deadline(dt->m_pos);
+        } else {
+            deadlines.push_back(dt);
+            dt->m_pos = deadlines.size() - 1;
+            sift_deadline(dt->m_pos);
+        }
+
+        arm_deadlines();
+    }
+
+    void remove_deadline(deadline_timer* dt, bool rearm = true) {
+        size_t pos = dt->m_pos;
+        deadline_timer* last = deadlines.back();
+        deadlines.pop_back();
+        dt->m_pos = deadline_timer::NPOS;
+
+        if (last != dt) {
+            place_deadline(last, pos);
+            sift_deadline(pos);
+        }
+
+        if (rearm)
+            arm_deadlines();
+    }
+
+    void run_deadlines() {
+        // deadlines set by the callbacks themselves for the current time
+        // only fire in the next delta cycle
+        sc_time now = sc_time_stamp();
+        u64 seq = deadline_seq;
+        deadline_armed = SC_MAX_TIME;
+        while (!deadlines.empty() && deadlines.front()->m_timeout <= now &&
+               deadlines.front()->m_seq < seq) {
+            deadline_timer* dt = deadlines.front();
+            remove_deadline(dt, false);
+            dt->m_cb();
+        }
+
+        arm_deadlines();
+    }
+
     void add_timer(async_timer::event* ev) {
         lock_guard<mutex> guard(mtx);
-        timers.push(ev);
+        timers.insert(ev);
         async_request_update();
     }
 
     void update() override {
         update_timer();
 
-        vector<function<void(void)>> curr_update;
+        update_job* head = next_update.exchange(nullptr);
+        if (head == nullptr)
+            return;
 
-        mtx.lock();
-        std::swap(curr_update, next_update);
-        mtx.unlock();
+        // reverse the stack to run jobs in submission order
+        update_job* jobs = nullptr;
+        size_t count = 0;
+        while (head != nullptr) {
+            update_job* next = head->next;
+            head->next = jobs;
+            jobs = head;
+            head = next;
+            count++;
+        }
 
-        for (auto& fn : curr_update)
-            fn();
+        update_depth -= count;
+        update_jobs += count;
+        update_batches++;
+        if (count > update_max_depth)
+            update_max_depth = count;
+
+        while (jobs != nullptr) {
+            update_job* next = jobs->next;
+            jobs->func();
+            delete jobs;
+            jobs = next;
+        }
     }
 
     VCML_KIND(helper_module);
@@ -363,13 +613,22 @@ public:
         sim_running(true),
         use_phase_callbacks(kernel_has_phase_callbacks()),
         mtx(),
+        next_update(nullptr),
+        update_depth(0),
+        update_max_depth(0),
+        update_jobs(0),
+        update_batches(0),
         end_of_elab(),
         start_of_sim(),
         end_of_sim(),
         deltas(),
         tsteps(),
         timeout_event("timeout_ev"),
-        timers() {
+        timers(),
+        deadlines(),
+        deadline_event("deadline_ev"),
+        deadline_armed(SC_MAX_TIME),
+        deadline_seq(0) {
 #if SYSTEMC_VERSION >= SYSTEMC_VERSION_2_3_1a
         if (use_phase_callbacks) {
             register_simulation_phase_callback(sc_core::SC_END_OF_UPDATE |
@@ -384,6 +643,13 @@ public:
         opts.set_sensitivity(&timeout_event);
         opts.dont_initialize();
         sc_spawn([&]() -> void { run_timer(); }, "$$$$vcml_timer$$$$", &opts);
+
+        sc_spawn_options dlopts;
+        dlopts.spawn_method();
+        dlopts.set_sensitivity(&deadline_event);
+        dlopts.dont_initialize();
+        sc_spawn([&]() -> void { run_deadlines(); }, "$$$$vcml_deadlines$$$$",
+                 &dlopts);
     }
 
 #if SYSTEMC_VERSION >= SYSTEMC_VERSION_2_3_1a
@@ -407,9 +673,11 @@ public:
         if (!use_phase_callbacks)
             sc_get_curr_simcontext()->remove_trace_file(this);
 #endif
-        while (!timers.empty()) {
-            delete timers.top();
-            timers.pop();
+        update_job* job = next_update.exchange(nullptr);
+        while (job != nullptr) {
+            update_job* next = job->next;
+            delete job;
+            job = next;
         }
     }
 
@@ -432,13 +700,20 @@ protected:
     virtual void end_of_elaboration() override {
         sim_running = true;
 
-        for (auto& func : end_of_elab)
-            func();
+        for (auto& cb : end_of_elab) {
+            startup_profiler::scope profile("end_of_elaboration", cb.owner);
+            cb.func();
+        }
     }
 
     virtual void start_of_simulation() override {
-        for (auto& func : start_of_sim)
-            func();
+        for (auto& cb : start_of_sim) {
+            startup_profiler::scope profile("start_of_simulation", cb.owner);
+            cb.func();
+        }
+
+        if (startup_profiler::enabled())
+            startup_profiler::log_report();
     }
 
     virtual void end_of_simulation() override {
@@ -455,21 +730,59 @@ helper_module& g_helper = helper_module::instance();
 
 void on_next_update(function<void(void)> callback) {
     helper_module& helper = helper_module::instance();
-    lock_guard<mutex> guard(helper.mtx);
-    helper.next_update.push_back(std::move(callback));
+    helper.push_update(std::move(callback));
     helper.async_request_update();
 }
 
+update_queue_stats get_update_queue_stats() {
+    helper_module& helper = helper_module::instance();
+    update_queue_stats stats;
+    stats.depth = helper.update_depth;
+    stats.max_depth = helper.update_max_depth;
+    stats.num_jobs = helper.update_jobs;
+    stats.num_batches = helper.update_batches;
+    return stats;
+}
+
+static atomic<u64> g_quantum_syncs(0);
+static atomic<u64> g_quantum_need_syncs(0);
+static atomic<u64> g_quantum_irqs(0);
+
+void quantum_count_sync() {
+    g_quantum_syncs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void quantum_count_need_sync() {
+    g_quantum_need_syncs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void quantum_count_irq() {
+    g_quantum_irqs.fetch_add(1, std::memory_order_relaxed);
+}
+
+quantum_stats get_quantum_stats() {
+    quantum_stats stats;
+    stats.num_syncs = g_quantum_syncs;
+    stats.num_need_syncs = g_quantum_need_syncs;
+    stats.num_irqs = g_quantum_irqs;
+    return stats;
+}
+
+static string callback_owner() {
+    sc_module* top = hierarchy_top();
+    return top ? top->name() : "global";
+}
+
 void on_end_of_elaboration(function<void(void)> callback) {
     helper_module& helper = helper_module::instance();
     lock_guard<mutex> guard(helper.mtx);
-    helper.end_of_elab.push_back(std::move(callback));
+    helper.end_of_elab.push_back({ callback_owner(), std::move(callback) });
 }
 
 void on_start_of_simulation(function<void(void)> callback) {
     helper_module& helper = helper_module::instance();
     lock_guard<mutex> guard(helper.mtx);
-    helper.start_of_sim.push_back(std::move(callback));
+    helper.start_of_sim.push_back({ callback_owner(), std::move(callback) });
 }
 
 void on_each_delta_cycle(function<void(void)> callback) {
@@ -515,14 +828,54 @@ void async_timer::reset(const sc_time& delta) {
     g_helper.add_timer(m_event);
 }
 
+deadline_timer::deadline_timer(function<void(void)> cb):
+    m_pos(NPOS), m_seq(0), m_timeout(), m_cb(std::move(cb)) {
+    VCML_ERROR_ON(!m_cb, "no deadline callback given");
+}
+
+deadline_timer::~deadline_timer() {
+    cancel();
+}
+
+sc_time deadline_timer::remaining() const {
+    sc_time now = sc_time_stamp();
+    if (!is_pending() || m_timeout <= now)
+        return SC_ZERO_TIME;
+    return m_timeout - now;
+}
+
+void deadline_timer::reset(const sc_time& delta) {
+    reset_at(sc_time_stamp() + delta);
+}
+
+void deadline_timer::reset_at(const sc_time& timeout) {
+    m_timeout = timeout;
+    g_helper.insert_deadline(this);
+}
+
+void deadline_timer::cancel() {
+    if (is_pending())
+        g_helper.remove_deadline(this);
+}
+
+sc_time next_deadline() {
+    const auto& deadlines = g_helper.deadlines;
+    return deadlines.empty() ? SC_MAX_TIME : deadlines.front()->timeout();
+}
+
 thread_local struct async_worker* g_async = nullptr;
 
+static bool async_pool_enabled();
+static void async_pool_submit(struct async_worker* worker);
+
 struct async_worker {
     const size_t id;
     sc_process_b* const process;
+    const bool pooled;
 
     atomic<bool> alive;
     atomic<bool> working;
+    atomic<bool> ordered;
     function<void(void)> task;
 
     atomic<u64> progress;
@@ -534,20 +887,39 @@ struct async_worker {
 
     sc_time sc_thread_pos;
 
+    // handshake for waking the async thread when systemc time advances
+    enum : size_t {
+        SPIN_MIN = 16,
+        SPIN_MAX = 4096,
+    };
+
+    atomic<u64> epoch;
+    atomic<size_t> sleepers;
+    size_t spin_limit;
+    mutex sync_mtx;
+    condition_variable_any sync_notify;
+
     struct sim_terminated_exception {};
 
     async_worker(size_t worker_id, sc_process_b* worker_proc):
         id(worker_id),
         process(worker_proc),
+        pooled(async_pool_enabled()),
         alive(true),
         working(false),
+        ordered(false),
         task(),
         progress(0),
         request(nullptr),
         mtx(),
         notify(),
-        worker(&async_worker::work, this),
-        sc_thread_pos(sc_time_stamp()) {
+        worker(pooled ? thread() : thread(&async_worker::work, this)),
+        sc_thread_pos(sc_time_stamp()),
+        epoch(0),
+        sleepers(0),
+        spin_limit(SPIN_MIN),
+        sync_mtx(),
+        sync_notify() {
         VCML_ERROR_ON(!process, "invalid parent process");
     }
 
@@ -560,7 +932,6 @@ struct async_worker {
     }
 
     void work() {
-        g_async = this;
         mwr::set_thread_name(mkstr("vcml_async:%zu", id));
 
         mtx.lock();
@@ -571,33 +942,107 @@ struct async_worker {
             if (!alive)
                 break;
 
-            try {
-                task();
-            } catch (sim_terminated_exception& ex) {
-                (void)ex;
-                alive = false;
-            }
-
-            working = false;
+            execute();
         }
 
         mtx.unlock();
+    }
+
+    // runs the current task on the calling host thread
+    void execute() {
+        g_async = this;
+
+        try {
+            task();
+        } catch (sim_terminated_exception& ex) {
+            (void)ex;
+            alive = false;
+        }
+
         g_async = nullptr;
+        working = false;
     }
 
-    void run_async(function<void(void)>& job) {
+    void advance() {
+        epoch++;
+        if (sleepers > 0) {
+            lock_guard<mutex> guard(sync_mtx);
+            sync_notify.notify_all();
+        }
+    }
+
+    void wait_offset(const sc_time& limit) {
+        auto done = [&]() -> bool {
+            return !sim_running() || timestamp() - sc_time_stamp() < limit;
+        };
+
+        // systemc usually catches up quickly, so spin for a while and
+        // adapt the spin phase to how long we had to wait last time
+        for (size_t i = 0; i < spin_limit; i++) {
+            if (done()) {
+                spin_limit = min<size_t>(spin_limit * 2, SPIN_MAX);
+                return;
+            }
+
+            mwr::cpu_yield();
+        }
+
+        spin_limit = max<size_t>(spin_limit / 2, SPIN_MIN);
+
+        std::unique_lock<mutex> lock(sync_mtx);
+        sleepers++;
+        while (!done()) {
+            // timeout guards against missing the end of simulation
+            u64 ep = epoch;
+            sync_notify.wait_for(lock, std::chrono::milliseconds(1),
+                                 [&]() -> bool { return epoch != ep; });
+        }
+        sleepers--;
+    }
+
+    // ordered workers only get their sync requests served once all other
+    // busy ordered workers are also blocked on a request, then the request
+    // with the earliest timestamp (and lowest id on ties) goes first
+    bool may_serve() {
+        if (!ordered)
+            return true;
+
+        sc_time ts = timestamp();
+        for (auto& it : workers()) {
+            async_worker* other = it.second.get();
+            if (other == this || !other->ordered || !other->working)
+                continue;
+            if (other->request == nullptr)
+                return false;
+
+            sc_time other_ts = other->timestamp();
+            if (other_ts < ts || (other_ts == ts && other->id < id))
+                return false;
+        }
+
+        return true;
+    }
+
+    void run_async(function<void(void)>& job, bool in_order) {
         mtx.lock();
         task = job;
+        ordered = in_order;
         working = true;
         mtx.unlock();
-        notify.notify_one();
+
+        if (pooled)
+            async_pool_submit(this);
+        else
+            notify.notify_one();
 
         while (working) {
             u64 p = progress.exchange(0);
             sc_thread_pos = sc_time_stamp() + time_from_value(p);
             sc_core::wait(time_from_value(p));
+            if (p > 0)
+                advance();
 
-            if (request) {
+            if (request && may_serve()) {
                 p = progress.exchange(0);
                 if (p > 0) {
                     sc_thread_pos = sc_time_stamp() + time_from_value(p);
@@ -609,6 +1054,8 @@ struct async_worker {
             }
         }
 
+        ordered = false;
+
         u64 p = progress.exchange(0);
         if (p > 0)
             sc_core::wait(time_from_value(p));
@@ -625,27 +1072,151 @@ struct async_worker {
 
     sc_time timestamp() { return sc_thread_pos + time_from_value(progress); }
 
+    typedef unordered_map<sc_process_b*, shared_ptr<async_worker>> map;
+
+    static map& workers() {
+        static map instances;
+        return instances;
+    }
+
     static async_worker& lookup(sc_process_b* thread) {
         VCML_ERROR_ON(!thread, "invalid thread");
 
-        typedef unordered_map<sc_process_b*, shared_ptr<async_worker>> map;
-        static map workers;
-
-        auto it = workers.find(thread);
-        if (it != workers.end())
+        auto it = workers().find(thread);
+        if (it != workers().end())
             return *it->second;
 
-        size_t id = workers.size();
+        size_t id = workers().size();
         auto worker = std::make_shared<async_worker>(id, thread);
-        return *(workers[thread] = worker);
+        return *(workers()[thread] = worker);
+    }
+};
+
+// Bounded pool of host threads executing sc_async jobs. Jobs are queued
+// round-robin to per-thread deques; idle threads steal from the back of
+// other deques before going to sleep.
+struct async_pool {
+    struct queue {
+        mutex mtx;
+        deque<async_worker*> jobs;
+    };
+
+    atomic<bool> alive;
+    atomic<size_t> pending;
+    atomic<size_t> next;
+
+    vector<unique_ptr<queue>> queues;
+    vector<thread> threads;
+
+    mutex mtx;
+    condition_variable_any notify;
+
+    async_pool():
+        alive(true),
+        pending(0),
+        next(0),
+        queues(),
+        threads(),
+        mtx(),
+        notify() {}
+
+    ~async_pool() { stop(); }
+
+    bool enabled() const { return !threads.empty(); }
+
+    void start(size_t nthreads) {
+        VCML_ERROR_ON(enabled(), "async pool already started");
+        for (size_t i = 0; i < nthreads; i++)
+            queues.push_back(std::make_unique<queue>());
+        for (size_t i = 0; i < nthreads; i++)
+            threads.emplace_back(&async_pool::work, this, i);
+    }
+
+    void stop() {
+        alive = false;
+        {
+            lock_guard<mutex> guard(mtx);
+            notify.notify_all();
+        }
+
+        for (thread& t : threads)
+            if (t.joinable())
+                t.join();
+    }
+
+    void submit(async_worker* job) {
+        queue& q = *queues[next++ % queues.size()];
+        {
+            lock_guard<mutex> guard(q.mtx);
+            q.jobs.push_back(job);
+        }
+
+        lock_guard<mutex> guard(mtx);
+        pending++;
+        notify.notify_one();
+    }
+
+    async_worker* take(size_t self) {
+        for (size_t i = 0; i < queues.size(); i++) {
+            queue& q = *queues[(self + i) % queues.size()];
+            lock_guard<mutex> guard(q.mtx);
+            if (q.jobs.empty())
+                continue;
+
+            async_worker* job = nullptr;
+            if (i == 0) {
+                job = q.jobs.front();
+                q.jobs.pop_front();
+            } else {
+                job = q.jobs.back();
+                q.jobs.pop_back();
+            }
+
+            pending--;
+            return job;
+        }
+
+        return nullptr;
+    }
+
+    void work(size_t self) {
+        mwr::set_thread_name(mkstr("vcml_pool:%zu", self));
+
+        while (alive) {
+            if (async_worker* job = take(self)) {
+                job->execute();
+                continue;
+            }
+
+            std::unique_lock<mutex> lock(mtx);
+            notify.wait(lock, [&]() -> bool { return !alive || pending > 0; });
+        }
+    }
+
+    static async_pool& instance() {
+        static async_pool singleton;
+        return singleton;
     }
 };
 
-void sc_async(function<void(void)> job) {
+static bool async_pool_enabled() {
+    return async_pool::instance().enabled();
+}
+
+static void async_pool_submit(async_worker* worker) {
+    async_pool::instance().submit(worker);
+}
+
+void sc_async_pool(size_t nthreads) {
+    VCML_ERROR_ON(nthreads == 0, "async pool needs at least one thread");
+    async_pool::instance().start(nthreads);
+}
+
+void sc_async(function<void(void)> job, bool ordered) {
     auto thread = current_thread();
     VCML_ERROR_ON(!thread, "sc_async must be called from SC_THREAD");
     async_worker& worker = async_worker::lookup(thread);
-    worker.run_async(job);
+    worker.run_async(job, ordered);
 }
 
 void sc_progress(const sc_time& delta) {
@@ -677,6 +1248,11 @@ sc_time async_time_offset() {
     return async_time_stamp() - sc_time_stamp();
 }
 
+void async_wait_offset(const sc_time& limit) {
+    VCML_ERROR_ON(!g_async, "not on async thread");
+    g_async->wait_offset(limit);
+}
+
 bool is_thread(sc_process_b* proc) {
     if (!thctl_is_sysc_thread())
         return false;
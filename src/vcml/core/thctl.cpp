@@ -13,6 +13,11 @@
 
 namespace vcml {
 
+// number of try_lock attempts before parking on the kernel mutex
+constexpr size_t THCTL_SPIN_LIMIT = 1024;
+
+static thread_local thctl_stats g_thctl_stats;
+
 struct thctl {
     thread::id sysc_thread;
     atomic<thread::id> curr_owner;
@@ -80,11 +85,26 @@ void thctl::enter_critical() {
     if (!sim_running())
         return;
 
+    g_thctl_stats.num_entries++;
+
     int prev = nwaiting++;
     if (!sysc_mutex.try_lock()) {
+        double start = mwr::timestamp();
         if (prev == 0)
             on_next_update([]() -> void { thctl_suspend(); });
-        sysc_mutex.lock();
+
+        size_t spin = 0;
+        while (spin < THCTL_SPIN_LIMIT && !sysc_mutex.try_lock()) {
+            mwr::cpu_yield();
+            spin++;
+        }
+
+        if (spin == THCTL_SPIN_LIMIT) {
+            g_thctl_stats.num_parked++;
+            sysc_mutex.lock();
+        }
+
+        g_thctl_stats.wait_time += mwr::timestamp() - start;
     }
 
     curr_owner = std::this_thread::get_id();
@@ -99,10 +119,13 @@ void thctl::exit_critical() {
     if (!sim_running())
         return;
 
+    // decrement while still holding the mutex, so that the kernel cannot
+    // observe a stale count and miss the notification below
     curr_owner = thread::id();
+    bool last = --nwaiting == 0;
     sysc_mutex.unlock();
 
-    if (--nwaiting == 0)
+    if (last)
         notify();
 }
 
@@ -110,9 +133,15 @@ void thctl::suspend() {
     VCML_ERROR_ON(!is_sysc_thread(), "this is not the SystemC thread");
     VCML_ERROR_ON(!is_in_critical(), "thread not in critical section");
 
-    do {
+    // short critical sections finish while we spin, so we can skip the
+    // condition variable round trip for them
+    sysc_mutex.unlock();
+    for (size_t spin = 0; spin < THCTL_SPIN_LIMIT && nwaiting > 0; spin++)
+        mwr::cpu_yield();
+    sysc_mutex.lock();
+
+    while (nwaiting > 0)
         cvar.wait(sysc_mutex);
-    } while (nwaiting > 0);
 
     curr_owner = sysc_thread;
 }
@@ -170,4 +199,24 @@ void thctl_set_sysc_thread(thread::id id) {
     thctl::instance().set_sysc_thread(id);
 }
 
+const thctl_stats& thctl_get_stats() {
+    return g_thctl_stats;
+}
+
+void thctl_batch::add(function<void(void)> job) {
+    m_jobs.push_back(std::move(job));
+}
+
+void thctl_batch::commit() {
+    if (m_jobs.empty())
+        return;
+
+    vector<function<void(void)>> jobs;
+    jobs.swap(m_jobs);
+
+    thctl_guard guard;
+    for (auto& job : jobs)
+        job();
+}
+
 } // namespace vcml
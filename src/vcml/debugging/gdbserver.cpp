@@ -54,24 +54,140 @@ gdbserver::gdb_target* gdbserver::find_target(target& tgt) {
 }
 
 string gdbserver::create_stop_reply() {
+    string reply = create_stop_reply(*m_c_target, GDBSIG_TRAP, m_hit_wp_addr,
+                                     m_hit_wp_type);
+    m_hit_wp_addr = nullptr;
+    m_hit_wp_type = VCML_ACCESS_NONE;
+    return reply;
+}
+
+string gdbserver::create_stop_reply(const gdb_target& gtgt, int signal,
+                                    const range* wp_addr,
+                                    vcml_access wp_type) {
     stringstream ss;
-    ss << mkstr("T%02xthread:%llx;", GDBSIG_TRAP, m_c_target->tid);
+    ss << mkstr("T%02xthread:%llx;", signal, gtgt.tid);
 
-    if (m_hit_wp_addr && m_hit_wp_type != VCML_ACCESS_NONE) {
-        const char wp_type = m_hit_wp_type == VCML_ACCESS_READ ? 'r' : 'a';
-        ss << mkstr("%cwatch:%llx;", wp_type, m_hit_wp_addr->start);
+    if (wp_addr && wp_type != VCML_ACCESS_NONE) {
+        const char type = wp_type == VCML_ACCESS_READ ? 'r' : 'a';
+        ss << mkstr("%cwatch:%llx;", type, wp_addr->start);
     }
-    m_hit_wp_addr = nullptr;
-    m_hit_wp_type = VCML_ACCESS_NONE;
 
     return ss.str();
 }
 
+void gdbserver::stop_target(gdb_target& gtgt, int signal,
+                            const range* wp_addr, vcml_access wp_type) {
+    lock_guard<mutex> guard(m_mtx);
+    if (gtgt.stopped)
+        return;
+
+    gtgt.stopped = true;
+    gtgt.stop_reply = create_stop_reply(gtgt, signal, wp_addr, wp_type);
+    gtgt.tgt.set_running(false);
+    gtgt.tgt.cancel_singlestep(this);
+
+    // only the oldest pending stop is announced, gdb then picks up all
+    // others one after another using vStopped
+    m_stop_replies.push_back(gtgt.stop_reply);
+    if (m_stop_replies.size() > 1 || !is_connected())
+        return;
+
+    try {
+        send_notification("Stop:" + m_stop_replies.front());
+    } catch (vcml::report& r) {
+        log_debug("%s", r.message());
+    }
+}
+
+void gdbserver::resume_target(gdb_target& gtgt, bool step) {
+    flush_regcache(gtgt);
+    gtgt.regvals.clear();
+    gtgt.regcache.clear();
+
+    lock_guard<mutex> guard(m_mtx);
+    gtgt.stopped = false;
+    gtgt.tgt.set_running(true);
+    if (step)
+        gtgt.tgt.request_singlestep(this);
+}
+
+void gdbserver::set_nonstop(bool nonstop) {
+    if (m_nonstop == nonstop)
+        return;
+
+    if (nonstop) {
+        // all targets stay halted, but the simulation around them resumes
+        cancel_singlestep();
+        for (auto& gtgt : m_targets) {
+            gtgt.stopped = true;
+            gtgt.stop_reply = create_stop_reply(gtgt, GDBSIG_TRAP);
+            gtgt.tgt.set_running(false);
+        }
+
+        m_nonstop = true;
+        update_status(GDB_RUNNING);
+    } else {
+        m_nonstop = false;
+        update_status(GDB_STOPPED);
+
+        lock_guard<mutex> guard(m_mtx);
+        m_stop_replies.clear();
+        for (auto& gtgt : m_targets) {
+            gtgt.stopped = false;
+            gtgt.tgt.set_running(true);
+        }
+    }
+}
+
 void gdbserver::cancel_singlestep() {
     for (auto& gtgt : m_targets)
         gtgt.tgt.cancel_singlestep(this);
 }
 
+void gdbserver::invalidate_regcache() {
+    flush_regcache();
+    for (auto& gtgt : m_targets) {
+        gtgt.regvals.clear();
+        gtgt.regcache.clear();
+    }
+}
+
+void gdbserver::flush_regcache() {
+    for (auto& gtgt : m_targets)
+        flush_regcache(gtgt);
+}
+
+void gdbserver::flush_regcache(gdb_target& gtgt) {
+    for (const cpureg* reg : gtgt.regdirty) {
+        const vector<u8>& val = gtgt.regvals[reg->regno];
+        if (!reg->write(val.data(), val.size()))
+            log_warn("failed to write register %s", reg->name.c_str());
+    }
+
+    gtgt.regdirty.clear();
+}
+
+const vector<u8>* gdbserver::read_cached(gdb_target& gtgt,
+                                         const cpureg& reg) {
+    auto it = gtgt.regvals.find(reg.regno);
+    if (it != gtgt.regvals.end())
+        return &it->second;
+
+    vector<u8> val(reg.total_size());
+    if (!reg.read(val.data(), val.size()))
+        return nullptr;
+
+    return &(gtgt.regvals[reg.regno] = std::move(val));
+}
+
+void gdbserver::write_cached(gdb_target& gtgt, const cpureg& reg,
+                             vector<u8>& val) {
+    if (!stl_contains(gtgt.regdirty, &reg))
+        gtgt.regdirty.push_back(&reg);
+    gtgt.regvals[reg.regno] = std::move(val);
+    gtgt.regcache.clear();
+}
+
 void gdbserver::update_status(gdb_status status, gdb_target* gtgt,
                               const range* wp_addr, vcml_access wp_type) {
     lock_guard<mutex> guard(m_mtx);
@@ -101,10 +217,12 @@ void gdbserver::update_status(gdb_status status, gdb_target* gtgt,
 
     case GDB_RUNNING:
     case GDB_STEPPING:
+        invalidate_regcache();
         resume();
         break;
 
     case GDB_KILLED:
+        invalidate_regcache();
         stop();
         disconnect();
         if (prev_status == GDB_STOPPED)
@@ -117,23 +235,37 @@ void gdbserver::update_status(gdb_status status, gdb_target* gtgt,
 }
 
 void gdbserver::notify_step_complete(target& tgt) {
-    update_status(GDB_STOPPED, find_target(tgt));
+    gdb_target* gtgt = find_target(tgt);
+    if (m_nonstop && gtgt)
+        stop_target(*gtgt, GDBSIG_TRAP);
+    else
+        update_status(GDB_STOPPED, gtgt);
 }
 
 void gdbserver::notify_breakpoint_hit(const breakpoint& bp) {
-    update_status(GDB_STOPPED, find_target(bp.owner()));
+    gdb_target* gtgt = find_target(bp.owner());
+    if (m_nonstop && gtgt)
+        stop_target(*gtgt, GDBSIG_TRAP);
+    else
+        update_status(GDB_STOPPED, gtgt);
 }
 
 void gdbserver::notify_watchpoint_read(const watchpoint& wp,
                                        const range& addr) {
-    update_status(GDB_STOPPED, find_target(wp.owner()), &wp.address(),
-                  VCML_ACCESS_READ);
+    gdb_target* gtgt = find_target(wp.owner());
+    if (m_nonstop && gtgt)
+        stop_target(*gtgt, GDBSIG_TRAP, &wp.address(), VCML_ACCESS_READ);
+    else
+        update_status(GDB_STOPPED, gtgt, &wp.address(), VCML_ACCESS_READ);
 }
 
 void gdbserver::notify_watchpoint_write(const watchpoint& wp,
                                         const range& addr, u64 newval) {
-    update_status(GDB_STOPPED, find_target(wp.owner()), &wp.address(),
-                  VCML_ACCESS_WRITE);
+    gdb_target* gtgt = find_target(wp.owner());
+    if (m_nonstop && gtgt)
+        stop_target(*gtgt, GDBSIG_TRAP, &wp.address(), VCML_ACCESS_WRITE);
+    else
+        update_status(GDB_STOPPED, gtgt, &wp.address(), VCML_ACCESS_WRITE);
 }
 
 bool gdbserver::check_suspension_point() {
@@ -160,6 +292,11 @@ string gdbserver::handle_step(const string& cmd) {
         return ERR_INTERNAL;
     }
 
+    if (m_nonstop) {
+        resume_target(*m_c_target, true);
+        return "OK";
+    }
+
     cancel_singlestep();
 
     for (auto& gtgt : m_targets)
@@ -200,6 +337,11 @@ string gdbserver::handle_continue(const string& cmd) {
         return ERR_INTERNAL;
     }
 
+    if (m_nonstop) {
+        resume_target(*m_c_target, false);
+        return "OK";
+    }
+
     cancel_singlestep();
 
     for (auto& gtgt : m_targets)
@@ -239,11 +381,6 @@ string gdbserver::handle_kill(const string& cmd) {
 }
 
 string gdbserver::handle_query(const string& cmd) {
-    if (!simulation_suspended()) {
-        log_warn("simulation is not suspended");
-        return ERR_INTERNAL;
-    }
-
     if (m_targets.size() == 0) {
         log_warn("no available target");
         return ERR_INTERNAL;
@@ -255,11 +392,16 @@ string gdbserver::handle_query(const string& cmd) {
         return ERR_INTERNAL;
     }
 
+    // these queries only use static target information and can therefore
+    // be answered while the simulation is still running
     if (starts_with(cmd, "qSupported")) {
         string features = mkstr("PacketSize=%zx;", PACKET_SIZE);
         if (m_q_target->arch != nullptr)
             features += "qXfer:features:read+;";
         features += "vContSupported+;";
+        features += "QStartNoAckMode+;";
+        features += "QNonStop+;";
+        features += "binary-upload+;";
         return features;
     }
 
@@ -267,8 +409,6 @@ string gdbserver::handle_query(const string& cmd) {
         return "1";
     if (starts_with(cmd, "qOffsets"))
         return "Text=0;Data=0;Bss=0";
-    if (starts_with(cmd, "qRcmd"))
-        return handle_rcmd(cmd);
     if (starts_with(cmd, "qXfer"))
         return handle_xfer(cmd);
 
@@ -284,6 +424,16 @@ string gdbserver::handle_query(const string& cmd) {
     if (starts_with(cmd, "qC"))
         return mkstr("QC%llx", m_q_target->tid);
 
+    if (starts_with(cmd, "qRcmd")) {
+        if (!simulation_suspended()) {
+            log_warn("simulation is not suspended");
+            return ERR_INTERNAL;
+        }
+
+        invalidate_regcache();
+        return handle_rcmd(cmd);
+    }
+
     return handle_unknown(cmd);
 }
 
@@ -403,10 +553,11 @@ string gdbserver::handle_reg_read(const string& cmd) {
                       'x'); // respond with "contents unknown"
     }
 
-    vector<u8> val(reg->total_size());
-    if (!reg->read(val.data(), val.size()))
+    const vector<u8>* cached = read_cached(*m_g_target, *reg);
+    if (cached == nullptr)
         return ERR_INTERNAL;
 
+    vector<u8> val(*cached);
     stringstream ss;
     ss << std::hex << std::setfill('0');
     if (!m_g_target->tgt.is_host_endian()) {
@@ -443,6 +594,9 @@ string gdbserver::handle_reg_write(const string& cmd) {
         return "OK";
     }
 
+    if (!reg->is_writeable())
+        return ERR_INTERNAL;
+
     vector<u8> val(reg->total_size());
     const char* str = strrchr(cmd.c_str(), '=');
     if (str == nullptr || strlen(str + 1) != reg->total_size() * 2) {
@@ -463,9 +617,7 @@ string gdbserver::handle_reg_write(const string& cmd) {
             memswap(val.data() + i, reg->size);
     }
 
-    if (!reg->write(val.data(), val.size()))
-        return ERR_INTERNAL;
-
+    write_cached(*m_g_target, *reg, val);
     return "OK";
 }
 
@@ -475,22 +627,27 @@ string gdbserver::handle_reg_read_all(const string& cmd) {
         return ERR_INTERNAL;
     }
 
-    stringstream ss;
-    ss << std::hex << std::setfill('0');
-
     if (!m_g_target) {
         log_warn("no specified target");
         return ERR_INTERNAL;
     }
 
+    // registers cannot change until the simulation resumes
+    if (!m_g_target->regcache.empty())
+        return m_g_target->regcache;
+
+    stringstream ss;
+    ss << std::hex << std::setfill('0');
+
     for (const cpureg* reg : m_g_target->cpuregs) {
         if (!reg->is_readable())
             continue;
 
-        vector<u8> val(reg->total_size());
-        if (!reg->read(val.data(), val.size()))
+        const vector<u8>* cached = read_cached(*m_g_target, *reg);
+        if (cached == nullptr)
             return ERR_INTERNAL;
 
+        vector<u8> val(*cached);
         if (!m_g_target->tgt.is_host_endian()) {
             for (size_t i = 0; i < val.size(); i += reg->size)
                 memswap(val.data() + i, reg->size);
@@ -500,7 +657,8 @@ string gdbserver::handle_reg_read_all(const string& cmd) {
             ss << mkstr("%02hhx", v);
     }
 
-    return ss.str();
+    m_g_target->regcache = ss.str();
+    return m_g_target->regcache;
 }
 
 string gdbserver::handle_reg_write_all(const string& cmd) {
@@ -533,8 +691,7 @@ string gdbserver::handle_reg_write_all(const string& cmd) {
                 memswap(val.data() + i, reg->size);
         }
 
-        if (!reg->write(val.data(), val.size()))
-            return ERR_INTERNAL;
+        write_cached(*m_g_target, *reg, val);
     }
 
     return "OK";
@@ -568,15 +725,50 @@ string gdbserver::handle_mem_read(const string& cmd) {
         return ERR_INTERNAL;
     }
 
-    stringstream ss;
-    ss << std::hex << std::setfill('0');
+    // address translation may depend on pending register writes
+    flush_regcache();
     if (m_g_target->tgt.read_vmem_dbg(addr, buffer.data(), size) != size)
         log_debug("failed to read 0x%llx..0x%llx", addr, addr + size - 1);
 
-    for (unsigned long long i = 0; i < size; i++)
-        ss << std::setw(2) << (int)buffer[i];
+    string hex;
+    hex.reserve(2 * size);
+    for (u8 val : buffer) {
+        hex += to_hex_ascii(val >> 4);
+        hex += to_hex_ascii(val);
+    }
 
-    return ss.str();
+    return hex;
+}
+
+string gdbserver::handle_mem_read_bin(const string& cmd) {
+    if (!simulation_suspended()) {
+        log_warn("simulation is not suspended");
+        return ERR_INTERNAL;
+    }
+
+    unsigned long long addr = 0, size = 0;
+    if (sscanf(cmd.c_str(), "x%llx,%llx", &addr, &size) != 2) {
+        log_warn("malformed command '%s'", cmd.c_str());
+        return ERR_COMMAND;
+    }
+
+    if (!m_g_target) {
+        log_warn("no specified target");
+        return ERR_INTERNAL;
+    }
+
+    // replies may be shorter than requested, worst case escaping doubles
+    // the size of the binary data
+    size = min<unsigned long long>(size, BUFFER_SIZE);
+
+    // read straight into the response, debug reads use DMI where possible
+    string data(size + 1, '\0');
+    data[0] = 'b';
+    flush_regcache();
+    if (m_g_target->tgt.read_vmem_dbg(addr, &data[1], size) != size)
+        log_debug("failed to read 0x%llx..0x%llx", addr, addr + size - 1);
+
+    return data;
 }
 
 string gdbserver::handle_mem_write(const string& cmd) {
@@ -619,6 +811,7 @@ string gdbserver::handle_mem_write(const string& cmd) {
         return ERR_INTERNAL;
     }
 
+    flush_regcache();
     if (m_g_target->tgt.write_vmem_dbg(addr, buffer.data(), size) != size)
         return ERR_UNKNOWN;
 
@@ -664,6 +857,7 @@ string gdbserver::handle_mem_write_bin(const string& cmd) {
         return ERR_INTERNAL;
     }
 
+    flush_regcache();
     if (m_g_target->tgt.write_vmem_dbg(addr, data, size) != size)
         return ERR_UNKNOWN;
 
@@ -783,6 +977,16 @@ string gdbserver::handle_exception(const string& cmd) {
         return ERR_INTERNAL;
     }
 
+    if (m_nonstop) {
+        // report every halted target again, the first one right away
+        lock_guard<mutex> guard(m_mtx);
+        m_stop_replies.clear();
+        for (const auto& gtgt : m_targets)
+            if (gtgt.stopped)
+                m_stop_replies.push_back(gtgt.stop_reply);
+        return m_stop_replies.empty() ? "OK" : m_stop_replies.front();
+    }
+
     return mkstr("T%02uthread:%llx;", GDBSIG_TRAP, m_c_target->tid);
 }
 
@@ -838,6 +1042,9 @@ string gdbserver::handle_thread_alive(const string& cmd) {
 }
 
 string gdbserver::handle_vcont(const string& cmd) {
+    if (cmd == "vStopped")
+        return handle_vstopped(cmd);
+
     if (!simulation_suspended()) {
         log_warn("simulation is not suspended");
         return ERR_INTERNAL;
@@ -846,6 +1053,9 @@ string gdbserver::handle_vcont(const string& cmd) {
     if (!starts_with(cmd, "vCont"))
         return "";
 
+    if (m_nonstop)
+        return handle_vcont_nonstop(cmd);
+
     if (cmd == "vCont?")
         return "s;S;c;C";
 
@@ -963,6 +1173,84 @@ string gdbserver::handle_vcont(const string& cmd) {
     return create_stop_reply();
 }
 
+string gdbserver::handle_vcont_nonstop(const string& cmd) {
+    if (cmd == "vCont?")
+        return "vCont;c;C;s;S;t";
+
+    vector<string> args = split(cmd, ';');
+    if (args.size() <= 1) {
+        log_warn("malformed command %s", cmd.c_str());
+        return ERR_COMMAND;
+    }
+    args.erase(args.begin());
+
+    vector<gdb_target*> unused(m_targets.size());
+    for (size_t i = 0; i < m_targets.size(); i++)
+        unused[i] = &m_targets[i];
+
+    // targets not mentioned keep their state, the leftmost action that
+    // matches a target wins; signals for "C" and "S" are ignored
+    for (const auto& a : args) {
+        char action = a.empty() ? 0 : a[0];
+        if (action == 0 || !strchr("cCsSt", action)) {
+            log_warn("malformed command %s", cmd.c_str());
+            return ERR_COMMAND;
+        }
+
+        vector<gdb_target*> targets = unused;
+        if (contains(a, ":")) {
+            int pid = 0, tid = 0;
+            auto s = split(a, ':');
+            if (!parse_ids(s[1], pid, tid)) {
+                log_warn("malformed command %s", cmd.c_str());
+                return ERR_COMMAND;
+            }
+
+            if (tid != GDB_ALL_TARGETS) {
+                auto gtgt = find_target(pid, tid);
+                if (!gtgt) {
+                    log_warn("unknown target ids %d.%d", pid, tid);
+                    return ERR_PARAM;
+                }
+
+                targets.clear();
+                if (stl_contains(unused, gtgt))
+                    targets.push_back(gtgt);
+            }
+        }
+
+        for (auto gtgt : targets) {
+            if (action == 't')
+                stop_target(*gtgt, GDBSIG_NONE);
+            else if (gtgt->stopped)
+                resume_target(*gtgt, action == 's' || action == 'S');
+            stl_remove(unused, gtgt);
+        }
+    }
+
+    return "OK";
+}
+
+string gdbserver::handle_vstopped(const string& cmd) {
+    lock_guard<mutex> guard(m_mtx);
+    if (!m_stop_replies.empty())
+        m_stop_replies.pop_front();
+    return m_stop_replies.empty() ? "OK" : m_stop_replies.front();
+}
+
+string gdbserver::handle_nonstop(const string& cmd) {
+    if (cmd == "QNonStop:1")
+        set_nonstop(true);
+    else if (cmd == "QNonStop:0")
+        set_nonstop(false);
+    else {
+        log_warn("malformed command %s", cmd.c_str());
+        return ERR_COMMAND;
+    }
+
+    return "OK";
+}
+
 gdbserver::gdbserver(u16 port, const vector<target*>& stubs,
                      gdb_status status):
     rspserver(port),
@@ -979,6 +1267,8 @@ gdbserver::gdbserver(u16 port, const vector<target*>& stubs,
     m_next_tid(1),
     m_hit_wp_addr(),
     m_hit_wp_type(VCML_ACCESS_NONE),
+    m_nonstop(false),
+    m_stop_replies(),
     m_cpuregs(),
     m_mtx() {
     if (stubs.size() == 0)
@@ -1004,6 +1294,7 @@ gdbserver::gdbserver(u16 port, const vector<target*>& stubs,
     register_handler("G", &gdbserver::handle_reg_write_all);
 
     register_handler("m", &gdbserver::handle_mem_read);
+    register_handler("x", &gdbserver::handle_mem_read_bin);
     register_handler("M", &gdbserver::handle_mem_write);
     register_handler("X", &gdbserver::handle_mem_write_bin);
 
@@ -1014,6 +1305,7 @@ gdbserver::gdbserver(u16 port, const vector<target*>& stubs,
     register_handler("T", &gdbserver::handle_thread_alive);
     register_handler("v", &gdbserver::handle_vcont);
     register_handler("?", &gdbserver::handle_exception);
+    register_handler("QNonStop", &gdbserver::handle_nonstop);
 
     if (m_status == GDB_STOPPED)
         suspend();
@@ -1025,8 +1317,24 @@ gdbserver::~gdbserver() {
     shutdown();
 }
 
+string gdbserver::handle_command(const string& command) {
+    // in non-stop mode the simulation keeps running while gdb talks to us,
+    // so every command briefly suspends it to safely access the targets
+    bool brief = m_nonstop && sim_running();
+    if (brief)
+        suspend(true);
+
+    string response = rspserver::handle_command(command);
+
+    if (brief)
+        resume();
+
+    return response;
+}
+
 void gdbserver::handle_connect(const char* peer) {
     log_debug("gdb connected to %s", peer);
+    invalidate_regcache();
     update_status(GDB_STOPPED);
 
     if (sim_running()) {
@@ -1038,6 +1346,17 @@ void gdbserver::handle_connect(const char* peer) {
 
 void gdbserver::handle_disconnect() {
     log_debug("gdb disconnected");
+    if (m_nonstop) {
+        lock_guard<mutex> guard(m_mtx);
+        m_nonstop = false;
+        m_stop_replies.clear();
+        for (auto& gtgt : m_targets) {
+            gtgt.stopped = false;
+            gtgt.tgt.set_running(true);
+        }
+    }
+
+    invalidate_regcache();
     if (sim_running())
         update_status(m_default);
 }
@@ -9,11 +9,206 @@
  ******************************************************************************/
 
 #include "vcml/core/module.h"
+#include "vcml/core/startup.h"
 #include "vcml/debugging/loader.h"
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 namespace vcml {
 namespace debugging {
 
+enum image_compression {
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,
+    COMPRESSION_ZSTD,
+};
+
+static image_compression detect_compression(const string& filename) {
+    ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file)
+        return COMPRESSION_NONE;
+
+    u32 head = 0;
+    file.read((char*)&head, sizeof(head));
+    if (!file)
+        return COMPRESSION_NONE;
+
+    if ((head & 0xffff) == 0x8b1f)
+        return COMPRESSION_GZIP;
+
+    if (head == 0xfd2fb528)
+        return COMPRESSION_ZSTD;
+
+    return COMPRESSION_NONE;
+}
+
+bool is_compressed_image(const string& filename) {
+    return detect_compression(filename) != COMPRESSION_NONE;
+}
+
+// reads the contents of a raw or compressed binary image in sequence
+class image_stream
+{
+private:
+    ifstream m_file;
+    image_compression m_type;
+    vector<u8> m_input;
+    bool m_done;
+
+#ifdef HAVE_ZLIB
+    z_stream m_gzip;
+#endif
+
+#ifdef HAVE_ZSTD
+    ZSTD_DStream* m_zstd;
+    ZSTD_inBuffer m_zin;
+    size_t m_zret;
+#endif
+
+    size_t fill();
+
+    size_t read_raw(u8* buf, size_t len);
+    size_t read_gzip(u8* buf, size_t len);
+    size_t read_zstd(u8* buf, size_t len);
+
+public:
+    image_stream(const string& filename);
+    ~image_stream();
+
+    size_t read(u8* buf, size_t len);
+};
+
+size_t image_stream::fill() {
+    m_file.read((char*)m_input.data(), m_input.size());
+    return m_file.gcount();
+}
+
+size_t image_stream::read_raw(u8* buf, size_t len) {
+    m_file.read((char*)buf, len);
+    size_t n = m_file.gcount();
+    m_done = n < len;
+    return n;
+}
+
+size_t image_stream::read_gzip(u8* buf, size_t len) {
+#ifdef HAVE_ZLIB
+    m_gzip.next_out = buf;
+    m_gzip.avail_out = len;
+
+    while (m_gzip.avail_out > 0 && !m_done) {
+        if (m_gzip.avail_in == 0) {
+            m_gzip.next_in = m_input.data();
+            m_gzip.avail_in = fill();
+            VCML_REPORT_ON(m_gzip.avail_in == 0, "gzip stream truncated");
+        }
+
+        int ret = inflate(&m_gzip, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            // gzip files may consist of multiple concatenated members
+            if (m_gzip.avail_in == 0) {
+                m_gzip.next_in = m_input.data();
+                m_gzip.avail_in = fill();
+            }
+
+            if (m_gzip.avail_in == 0)
+                m_done = true;
+            else
+                inflateReset(&m_gzip);
+        } else if (ret != Z_OK) {
+            VCML_REPORT("gzip error: %s", m_gzip.msg ? m_gzip.msg : "?");
+        }
+    }
+
+    return len - m_gzip.avail_out;
+#else
+    VCML_REPORT("gzip support not available");
+#endif
+}
+
+size_t image_stream::read_zstd(u8* buf, size_t len) {
+#ifdef HAVE_ZSTD
+    ZSTD_outBuffer out = { buf, len, 0 };
+    while (out.pos < out.size && !m_done) {
+        if (m_zin.pos == m_zin.size) {
+            m_zin.src = m_input.data();
+            m_zin.size = fill();
+            m_zin.pos = 0;
+            if (m_zin.size == 0 && m_zret == 0) {
+                m_done = true;
+                break;
+            }
+        }
+
+        size_t pos = out.pos;
+        m_zret = ZSTD_decompressStream(m_zstd, &out, &m_zin);
+        if (ZSTD_isError(m_zret))
+            VCML_REPORT("zstd error: %s", ZSTD_getErrorName(m_zret));
+        VCML_REPORT_ON(m_zin.size == 0 && out.pos == pos,
+                       "zstd stream truncated");
+    }
+
+    return out.pos;
+#else
+    VCML_REPORT("zstd support not available");
+#endif
+}
+
+image_stream::image_stream(const string& filename):
+    m_file(filename, std::ios::in | std::ios::binary),
+    m_type(detect_compression(filename)),
+    m_input(),
+    m_done(false) {
+    VCML_REPORT_ON(!m_file, "cannot open file");
+    if (m_type != COMPRESSION_NONE)
+        m_input.resize(256 * KiB);
+
+#ifdef HAVE_ZLIB
+    memset(&m_gzip, 0, sizeof(m_gzip));
+    if (m_type == COMPRESSION_GZIP && inflateInit2(&m_gzip, 15 + 32) != Z_OK)
+        VCML_REPORT("failed to initialize gzip decoder");
+#endif
+
+#ifdef HAVE_ZSTD
+    m_zstd = nullptr;
+    m_zin = { nullptr, 0, 0 };
+    m_zret = 1;
+    if (m_type == COMPRESSION_ZSTD && !(m_zstd = ZSTD_createDStream()))
+        VCML_REPORT("failed to initialize zstd decoder");
+#endif
+}
+
+image_stream::~image_stream() {
+#ifdef HAVE_ZLIB
+    if (m_type == COMPRESSION_GZIP)
+        inflateEnd(&m_gzip);
+#endif
+
+#ifdef HAVE_ZSTD
+    if (m_zstd)
+        ZSTD_freeDStream(m_zstd);
+#endif
+}
+
+size_t image_stream::read(u8* buf, size_t len) {
+    if (m_done)
+        return 0;
+
+    switch (m_type) {
+    case COMPRESSION_GZIP:
+        return read_gzip(buf, len);
+    case COMPRESSION_ZSTD:
+        return read_zstd(buf, len);
+    default:
+        return read_raw(buf, len);
+    }
+}
+
 const char* image_type_to_str(image_type type) {
     switch (type) {
     case IMAGE_ELF:
@@ -142,11 +337,17 @@ bool loader::cmd_load_uimage(const vector<string>& args, ostream& os) {
 }
 
 void loader::load_bin(const string& filename, u64 offset) {
+    if (is_compressed_image(filename)) {
+        load_stream(filename, offset);
+        return;
+    }
+
     ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
     VCML_REPORT_ON(!file, "cannot open file");
 
     size_t size = file.tellg();
     file.seekg(0, std::ios::beg);
+    m_image_bytes += size;
 
     m_log.debug("loading binary file '%s' (%zu bytes) to offset 0x%llx",
                 filename.c_str(), size, offset);
@@ -164,13 +365,25 @@ void loader::load_bin(const string& filename, u64 offset) {
             u64 nbytes = min(buffer.size(), size);
             file.read((char*)buffer.data(), nbytes);
             VCML_REPORT_ON(!file, "cannot read file");
-            copy_image(buffer.data(), nbytes, offset);
+            copy_pages(buffer.data(), nbytes, offset);
             size -= nbytes;
             offset += nbytes;
         }
     }
 }
 
+void loader::load_stream(const string& filename, u64 offset) {
+    m_log.debug("loading compressed file '%s' to offset 0x%llx",
+                filename.c_str(), offset);
+
+    image_stream stream(filename);
+    vector<u8> buffer(IMAGE_CHUNK_SIZE);
+    while (size_t n = stream.read(buffer.data(), buffer.size())) {
+        copy_chunk(buffer.data(), n, offset);
+        offset += n;
+    }
+}
+
 void loader::load_elf(const string& filename, u64 offset) {
     mwr::elf reader(filename);
     m_log.debug("loading elf file '%s' with %zu segments to offset 0x%016llx",
@@ -185,8 +398,10 @@ void loader::load_elf(const string& filename, u64 offset) {
         } else {
             vector<u8> buffer(seg.size);
             reader.read_segment(seg, buffer.data());
-            copy_image(buffer.data(), seg, offset);
+            copy_pages(buffer.data(), seg, offset);
         }
+
+        m_image_bytes += seg.size;
     }
 }
 
@@ -201,6 +416,7 @@ void loader::load_srec(const string& filename, u64 offset) {
             memcpy(image, rec.data.data(), rec.data.size());
         else
             copy_image(rec.data.data(), rec.data.size(), rec.addr + offset);
+        m_image_bytes += rec.data.size();
     }
 }
 
@@ -215,8 +431,10 @@ void loader::load_uimage(const string& filename, u64 offset) {
     else {
         vector<u8> buffer(reader.size());
         reader.read(buffer.data(), buffer.size());
-        copy_image(buffer.data(), buffer.size(), offset);
+        copy_pages(buffer.data(), buffer.size(), offset);
     }
+
+    m_image_bytes += reader.size();
 }
 
 u8* loader::allocate_image(u64 size, u64 offset) {
@@ -231,9 +449,58 @@ void loader::copy_image(const u8* img, const elf_segment& seg, u64 off) {
     copy_image(img, seg.size, seg.phys + off);
 }
 
+void loader::copy_pages(const u8* img, u64 size, u64 offset) {
+    while (size > 0) {
+        u64 n = min(size, IMAGE_PAGE_SIZE - offset % IMAGE_PAGE_SIZE);
+        if (u8* ptr = allocate_image(n, offset))
+            memcpy(ptr, img, n);
+        else
+            copy_image(img, n, offset);
+
+        img += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+void loader::copy_chunk(const u8* img, u64 size, u64 offset) {
+    if (u8* ptr = allocate_image(size, offset))
+        memcpy(ptr, img, size);
+    else
+        copy_pages(img, size, offset);
+    m_image_bytes += size;
+}
+
+void loader::copy_pages(const u8* img, const elf_segment& seg, u64 off) {
+    elf_segment page = seg;
+    for (u64 done = 0; done < seg.size; done += page.size) {
+        page.phys = seg.phys + done;
+        page.size = min(seg.size - done,
+                        IMAGE_PAGE_SIZE - (page.phys + off) % IMAGE_PAGE_SIZE);
+        if (u8* ptr = allocate_image(page, off))
+            memcpy(ptr, img + done, page.size);
+        else
+            copy_image(img + done, page, off);
+    }
+}
+
 unordered_map<string, loader*> loader::s_loaders;
 
-loader::loader(module& mod, bool reg_cmds): m_owner(mod), m_log(mod.log) {
+void loader::report_image(const image_info& image, u64 bytes, u64 micros) {
+    double mib = (double)bytes / MiB;
+    double secs = max<u64>(micros, 1) * 1e-6;
+    m_log.debug("loaded %s image '%s' (%llu bytes) in %.1fms (%.1f MiB/s)",
+                image_type_to_str(image.type), image.filename.c_str(), bytes,
+                micros * 1e-3, mib / secs);
+
+    if (startup_profiler::enabled()) {
+        string name = mkstr("%s %s", m_owner.name(), image.filename.c_str());
+        startup_profiler::record("load", name, micros * 1e-6);
+    }
+}
+
+loader::loader(module& mod, bool reg_cmds):
+    m_owner(mod), m_log(mod.log), m_image_bytes(0) {
     if (stl_contains(s_loaders, string(loader_name())))
         VCML_ERROR("image loader '%s' already exists", loader_name());
 
@@ -275,6 +542,9 @@ void loader::load_image(const image_info& image) {
     if (!mwr::file_exists(image.filename))
         VCML_REPORT("file not found");
 
+    u64 start = mwr::timestamp_us();
+    m_image_bytes = 0;
+
     switch (image.type) {
     case IMAGE_ELF:
         load_elf(image.filename, image.offset);
@@ -291,15 +561,24 @@ void loader::load_image(const image_info& image) {
     default:
         VCML_REPORT("unknown image type %d", (int)image.type);
     }
+
+    report_image(image, m_image_bytes, mwr::timestamp_us() - start);
 }
 
-void loader::load_images(const vector<string>& files) {
+void loader::load_images(const vector<string>& files, bool parallel) {
     auto images = images_from_string(files);
-    load_images(images);
+    load_images(images, parallel);
 }
 
-void loader::load_images(const vector<image_info>& images) {
+void loader::load_images(const vector<image_info>& images, bool parallel) {
+    vector<image_info> streams;
     for (const auto& image : images) {
+        if (parallel && image.type == IMAGE_BIN &&
+            mwr::file_exists(image.filename)) {
+            streams.push_back(image);
+            continue;
+        }
+
         try {
             load_image(image);
         } catch (std::exception& ex) {
@@ -310,6 +589,110 @@ void loader::load_images(const vector<image_info>& images) {
                        image.filename.c_str());
         }
     }
+
+    if (!streams.empty())
+        load_streams(streams);
+}
+
+// binary images are read and decompressed by one host thread each, while
+// the calling thread copies the resulting chunks to memory
+void loader::load_streams(const vector<image_info>& images) {
+    struct chunk {
+        size_t index;
+        u64 offset;
+        vector<u8> data;
+        string error;
+    };
+
+    mutex mtx;
+    condition_variable cv;
+    deque<chunk> chunks;
+    const size_t capacity = 4 * images.size();
+
+    auto push = [&](chunk&& c) {
+        std::unique_lock<mutex> lock(mtx);
+        cv.wait(lock, [&]() { return chunks.size() < capacity; });
+        chunks.push_back(std::move(c));
+        cv.notify_all();
+    };
+
+    auto stream = [&](size_t index) {
+        const image_info& image = images[index];
+        u64 offset = image.offset;
+        string error;
+
+        try {
+            image_stream reader(image.filename);
+            while (true) {
+                vector<u8> data(IMAGE_CHUNK_SIZE);
+                size_t n = reader.read(data.data(), data.size());
+                if (n == 0)
+                    break;
+
+                data.resize(n);
+                push({ index, offset, std::move(data), "" });
+                offset += n;
+            }
+        } catch (std::exception& ex) {
+            error = ex.what();
+        } catch (...) {
+            error = "unknown error";
+        }
+
+        // an empty chunk marks the end of the image
+        push({ index, offset, {}, error });
+    };
+
+    vector<thread> workers;
+    vector<u64> starts(images.size(), mwr::timestamp_us());
+    vector<u64> bytes(images.size(), 0);
+    vector<bool> failed(images.size(), false);
+    for (size_t i = 0; i < images.size(); i++) {
+        m_log.debug("streaming binary file '%s' to offset 0x%llx",
+                    images[i].filename.c_str(), images[i].offset);
+        workers.emplace_back(stream, i);
+        mwr::set_thread_name(workers.back(), mkstr("loader_%zu", i));
+    }
+
+    for (size_t pending = images.size(); pending > 0;) {
+        chunk c;
+        {
+            std::unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [&]() { return !chunks.empty(); });
+            c = std::move(chunks.front());
+            chunks.pop_front();
+            cv.notify_all();
+        }
+
+        const image_info& image = images[c.index];
+        if (c.data.empty()) {
+            pending--;
+            if (!c.error.empty()) {
+                m_log.warn("failed to load image '%s': %s",
+                           image.filename.c_str(), c.error.c_str());
+            } else if (!failed[c.index]) {
+                u64 micros = mwr::timestamp_us() - starts[c.index];
+                report_image(image, bytes[c.index], micros);
+            }
+
+            continue;
+        }
+
+        if (failed[c.index])
+            continue;
+
+        try {
+            copy_chunk(c.data.data(), c.data.size(), c.offset);
+            bytes[c.index] += c.data.size();
+        } catch (std::exception& ex) {
+            m_log.warn("failed to load image '%s': %s",
+                       image.filename.c_str(), ex.what());
+            failed[c.index] = true;
+        }
+    }
+
+    for (thread& worker : workers)
+        worker.join();
 }
 
 loader* loader::find(const string& name) {
@@ -0,0 +1,380 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/debugging/metrics_server.h"
+
+#include "vcml/core/processor.h"
+#include "vcml/protocols/tlm_sockets.h"
+#include "vcml/protocols/eth.h"
+#include "vcml/models/block/disk.h"
+
+namespace vcml {
+namespace debugging {
+
+static const char* const CONTENT_TYPE =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+static const size_t MAX_REQUEST_SIZE = 8 * KiB;
+static const time_t REQUEST_TIMEOUT_MS = 1000;
+static const auto SNAPSHOT_TIMEOUT = std::chrono::milliseconds(200);
+
+// counts published log messages; only listens up to LOG_INFO so that it
+// does not make loggers format debug messages nobody else asked for
+class log_counter : public mwr::publisher
+{
+private:
+    atomic<u64> m_counts[LOG_DEBUG + 1];
+
+public:
+    u64 count(log_level lvl) const { return m_counts[lvl]; }
+
+    log_counter(): mwr::publisher(LOG_ERROR, LOG_INFO), m_counts() {}
+    virtual ~log_counter() = default;
+
+    virtual void publish(const mwr::logmsg& msg) override {
+        if (msg.level >= LOG_ERROR && msg.level <= LOG_DEBUG)
+            m_counts[msg.level]++;
+    }
+};
+
+struct metrics_objects {
+    vector<processor*> processors;
+    vector<tlm_initiator_socket*> tlm_initiators;
+    vector<tlm_target_socket*> tlm_targets;
+    vector<eth_initiator_socket*> eth_initiators;
+    vector<eth_target_socket*> eth_targets;
+    vector<block::disk*> disks;
+};
+
+// shared with pending update callbacks, which may outlive the server
+struct metrics_server::snapshot_state {
+    log_counter logs;
+
+    mutex mtx;
+    condition_variable cv;
+    u64 generation;
+    bool pending;
+
+    shared_ptr<const string> text;
+
+    u64 last_host;
+    sc_time last_sim;
+    unordered_map<const processor*, u64> last_cycles;
+
+    snapshot_state();
+    void render();
+};
+
+template <typename T>
+static void collect(sc_object* obj, vector<T*>& list) {
+    if (T* t = dynamic_cast<T*>(obj))
+        list.push_back(t);
+}
+
+static void collect(sc_object* obj, metrics_objects& objs) {
+    collect(obj, objs.processors);
+    collect(obj, objs.tlm_initiators);
+    collect(obj, objs.tlm_targets);
+    collect(obj, objs.eth_initiators);
+    collect(obj, objs.eth_targets);
+    collect(obj, objs.disks);
+
+    for (sc_object* child : obj->get_child_objects())
+        collect(child, objs);
+}
+
+static string label(const char* value) {
+    string s;
+    for (const char* c = value; *c; c++) {
+        if (*c == '\\' || *c == '"')
+            s += '\\';
+        s += *c == '\n' ? 'n' : *c;
+    }
+
+    return s;
+}
+
+static void family(ostream& os, const char* name, const char* type,
+                   const char* help) {
+    os << "# TYPE " << name << " " << type << "\n";
+    os << "# HELP " << name << " " << help << "\n";
+}
+
+template <typename T, typename V>
+static void samples(ostream& os, const char* name, const char* key,
+                    const vector<T*>& list, V value) {
+    for (T* obj : list) {
+        os << name << "{" << key << "=\"" << label(obj->name()) << "\"} "
+           << value(obj) << "\n";
+    }
+}
+
+template <typename T, typename V>
+static void counter(ostream& os, const char* name, const char* help,
+                    const char* key, const vector<T*>& list, V value) {
+    if (list.empty())
+        return;
+
+    family(os, name, "counter", help);
+    samples(os, strcat(name, "_total").c_str(), key, list, value);
+}
+
+metrics_server::snapshot_state::snapshot_state():
+    logs(),
+    mtx(),
+    cv(),
+    generation(0),
+    pending(false),
+    text(),
+    last_host(mwr::timestamp_us()),
+    last_sim(sc_time_stamp()),
+    last_cycles() {
+    // nothing to do
+}
+
+void metrics_server::snapshot_state::render() {
+    metrics_objects objs;
+    for (sc_object* obj : sc_core::sc_get_top_level_objects())
+        collect(obj, objs);
+
+    u64 host_now = mwr::timestamp_us();
+    sc_time sim_now = sc_time_stamp();
+    double host = (host_now - last_host) / 1e6;
+
+    ostringstream os;
+    family(os, "vcml_sim_time_seconds", "gauge", "Simulation time.");
+    os << "vcml_sim_time_seconds " << sim_now.to_seconds() << "\n";
+    family(os, "vcml_delta_cycles", "counter", "Delta cycles executed.");
+    os << "vcml_delta_cycles_total " << sc_core::sc_delta_count() << "\n";
+    family(os, "vcml_rtf", "gauge",
+           "Real-time factor since the previous scrape.");
+    if (host > 0.0)
+        os << "vcml_rtf " << (sim_now - last_sim).to_seconds() / host << "\n";
+
+    counter(os, "vcml_processor_cycles", "Cycles simulated per processor.",
+            "processor", objs.processors,
+            [](processor* p) { return p->cycle_count(); });
+
+    if (!objs.processors.empty() && host > 0.0) {
+        family(os, "vcml_processor_mips", "gauge",
+               "Million cycles per host second since the previous scrape.");
+        samples(os, "vcml_processor_mips", "processor", objs.processors,
+                [&](processor* p) -> double {
+                    u64 prev = stl_contains(last_cycles, p) ? last_cycles[p]
+                                                            : 0;
+                    return (p->cycle_count() - prev) / host / 1e6;
+                });
+    }
+
+    counter(os, "vcml_tlm_initiator_transactions",
+            "Transactions sent via b_transport.", "socket",
+            objs.tlm_initiators, [](tlm_initiator_socket* s) {
+                return s->stats().num_transactions;
+            });
+    counter(os, "vcml_tlm_initiator_bytes",
+            "Bytes moved by non-debug accesses.", "socket",
+            objs.tlm_initiators,
+            [](tlm_initiator_socket* s) { return s->stats().num_bytes; });
+    counter(os, "vcml_tlm_initiator_dmi", "Accesses served via DMI.",
+            "socket", objs.tlm_initiators,
+            [](tlm_initiator_socket* s) { return s->stats().num_dmi; });
+    counter(os, "vcml_tlm_initiator_debug", "Debug accesses.", "socket",
+            objs.tlm_initiators,
+            [](tlm_initiator_socket* s) { return s->stats().num_debug; });
+    counter(os, "vcml_tlm_initiator_errors", "Failed transactions.",
+            "socket", objs.tlm_initiators,
+            [](tlm_initiator_socket* s) { return s->stats().num_errors; });
+
+    counter(os, "vcml_tlm_target_transactions",
+            "Transactions received via b_transport.", "socket",
+            objs.tlm_targets, [](tlm_target_socket* s) {
+                return s->stats().num_transactions;
+            });
+    counter(os, "vcml_tlm_target_bytes", "Bytes moved by transactions.",
+            "socket", objs.tlm_targets,
+            [](tlm_target_socket* s) { return s->stats().num_bytes; });
+    counter(os, "vcml_tlm_target_dmi", "DMI pointers granted.", "socket",
+            objs.tlm_targets,
+            [](tlm_target_socket* s) { return s->stats().num_dmi; });
+    counter(os, "vcml_tlm_target_debug", "Debug accesses.", "socket",
+            objs.tlm_targets,
+            [](tlm_target_socket* s) { return s->stats().num_debug; });
+    counter(os, "vcml_tlm_target_errors", "Failed transactions.", "socket",
+            objs.tlm_targets,
+            [](tlm_target_socket* s) { return s->stats().num_errors; });
+
+    counter(os, "vcml_eth_tx_frames", "Ethernet frames sent.", "socket",
+            objs.eth_initiators,
+            [](eth_initiator_socket* s) { return s->num_frames(); });
+    counter(os, "vcml_eth_tx_bytes", "Ethernet bytes sent.", "socket",
+            objs.eth_initiators,
+            [](eth_initiator_socket* s) { return s->num_bytes(); });
+    counter(os, "vcml_eth_rx_frames", "Ethernet frames received.", "socket",
+            objs.eth_targets,
+            [](eth_target_socket* s) { return s->num_frames(); });
+    counter(os, "vcml_eth_rx_bytes", "Ethernet bytes received.", "socket",
+            objs.eth_targets,
+            [](eth_target_socket* s) { return s->num_bytes(); });
+
+    counter(os, "vcml_disk_read_bytes", "Bytes read from disk.", "disk",
+            objs.disks,
+            [](block::disk* d) { return d->stats.num_bytes_read; });
+    counter(os, "vcml_disk_written_bytes", "Bytes written to disk.", "disk",
+            objs.disks,
+            [](block::disk* d) { return d->stats.num_bytes_written; });
+    counter(os, "vcml_disk_requests", "Disk requests.", "disk", objs.disks,
+            [](block::disk* d) { return d->stats.num_req; });
+    counter(os, "vcml_disk_errors", "Failed disk requests.", "disk",
+            objs.disks, [](block::disk* d) { return d->stats.num_err; });
+
+    family(os, "vcml_log_messages", "counter", "Log messages published.");
+    const pair<log_level, const char*> levels[] = {
+        { LOG_ERROR, "error" },
+        { LOG_WARN, "warning" },
+        { LOG_INFO, "info" },
+    };
+
+    for (const auto& lvl : levels) {
+        os << "vcml_log_messages_total{level=\"" << lvl.second << "\"} "
+           << logs.count(lvl.first) << "\n";
+    }
+
+    os << "# EOF\n";
+
+    last_host = host_now;
+    last_sim = sim_now;
+    for (processor* p : objs.processors)
+        last_cycles[p] = p->cycle_count();
+
+    std::atomic_store(&text, std::make_shared<const string>(os.str()));
+
+    lock_guard<mutex> guard(mtx);
+    generation++;
+    pending = false;
+    cv.notify_all();
+}
+
+void metrics_server::request_snapshot() {
+    shared_ptr<snapshot_state> state = m_state;
+    std::unique_lock<mutex> lock(state->mtx);
+    u64 generation = state->generation;
+    if (!state->pending) {
+        state->pending = true;
+        lock.unlock();
+        on_next_update([state]() -> void { state->render(); });
+        lock.lock();
+    }
+
+    // a stopped simulation never renders, serve the old snapshot instead
+    state->cv.wait_for(lock, SNAPSHOT_TIMEOUT, [&]() -> bool {
+        return state->generation != generation || !m_running;
+    });
+}
+
+void metrics_server::handle_request() {
+    string request;
+    while (!ends_with(request, "\r\n\r\n")) {
+        if (request.size() > MAX_REQUEST_SIZE)
+            return;
+        if (!m_sock.peek(REQUEST_TIMEOUT_MS))
+            return;
+        request += m_sock.recv_char();
+    }
+
+    vector<string> words = split(request.substr(0, request.find('\r')), ' ');
+    string path = words.size() > 1 ? words[1] : "";
+    path = path.substr(0, path.find('?'));
+
+    int code = 200;
+    string status = "OK";
+    string body;
+
+    if (words.empty() || words[0] != "GET") {
+        code = 405;
+        status = "Method Not Allowed";
+    } else if (path != "/metrics" && path != "/") {
+        code = 404;
+        status = "Not Found";
+    } else {
+        request_snapshot();
+        body = snapshot();
+        if (body.empty()) {
+            code = 503;
+            status = "Service Unavailable";
+        }
+    }
+
+    m_sock.send(mkstr("HTTP/1.1 %d %s\r\n"
+                      "Content-Type: %s\r\n"
+                      "Content-Length: %zu\r\n"
+                      "Connection: close\r\n\r\n",
+                      code, status.c_str(), CONTENT_TYPE, body.length()));
+    if (!body.empty())
+        m_sock.send(body);
+}
+
+void metrics_server::run() {
+    mwr::set_thread_name(mkstr("metrics_%hu", m_port));
+    while (m_running) {
+        try {
+            if (m_sock.accept())
+                handle_request();
+        } catch (report& rep) {
+            log_debug("%s", rep.message()); // not an error, e.g. disconnect
+        } catch (std::exception& ex) {
+            log_debug("%s", ex.what());
+        }
+
+        if (m_sock.is_connected())
+            m_sock.disconnect();
+    }
+}
+
+metrics_server::metrics_server(u16 port):
+    m_sock(port),
+    m_port(m_sock.port()),
+    m_running(false),
+    m_thread(),
+    m_state(new snapshot_state()),
+    log(mkstr("metrics_%hu", m_port)) {
+    // nothing to do
+}
+
+metrics_server::~metrics_server() {
+    shutdown();
+}
+
+void metrics_server::start() {
+    VCML_ERROR_ON(m_running, "metrics server already running");
+    m_running = true;
+    m_thread = thread(&metrics_server::run, this);
+    log_info("serving metrics on port %hu", m_port);
+}
+
+void metrics_server::shutdown() {
+    m_running = false;
+    m_state->cv.notify_all();
+
+    if (m_sock.is_listening())
+        m_sock.unlisten();
+    if (m_sock.is_connected())
+        m_sock.disconnect();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+string metrics_server::snapshot() const {
+    shared_ptr<const string> text = std::atomic_load(&m_state->text);
+    return text ? *text : string();
+}
+
+} // namespace debugging
+} // namespace vcml
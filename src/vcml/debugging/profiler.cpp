@@ -0,0 +1,110 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/debugging/profiler.h"
+
+namespace vcml {
+namespace debugging {
+
+const char* profiler::frame_name(const stackframe& frame) const {
+    const symbol* sym = frame.sym;
+    if (sym == nullptr)
+        sym = m_target.symbols().find_function(frame.program_counter);
+    return sym ? sym->name() : "[unknown]";
+}
+
+profiler::profiler(target& t, size_t depth):
+    m_target(t),
+    m_depth(depth),
+    m_samples(0),
+    m_paused(false),
+    m_flat(),
+    m_folded() {
+    VCML_ERROR_ON(depth == 0, "profiler stack depth cannot be zero");
+    m_trace.reserve(depth);
+}
+
+void profiler::reset() {
+    m_samples = 0;
+    m_flat.clear();
+    m_folded.clear();
+}
+
+void profiler::sample(u64 weight) {
+    if (weight == 0 || m_paused)
+        return;
+
+    m_target.stacktrace(m_trace, m_depth);
+    if (m_trace.empty())
+        return;
+
+    m_samples += weight;
+
+    // frames are ordered innermost first, folded stacks start at the root
+    string folded;
+    unordered_set<string> seen;
+    for (size_t i = m_trace.size(); i-- > 0;) {
+        string name = frame_name(m_trace[i]);
+        if (!folded.empty())
+            folded += ';';
+        folded += name;
+
+        profile_entry& entry = m_flat[name];
+        if (entry.function.empty())
+            entry.function = name;
+        if (i == 0)
+            entry.self += weight;
+        if (seen.insert(name).second)
+            entry.total += weight;
+    }
+
+    m_folded[folded] += weight;
+}
+
+vector<profile_entry> profiler::flat_profile() const {
+    vector<profile_entry> profile;
+    profile.reserve(m_flat.size());
+    for (const auto& it : m_flat)
+        profile.push_back(it.second);
+
+    std::sort(profile.begin(), profile.end(),
+              [](const profile_entry& a, const profile_entry& b) {
+                  if (a.self != b.self)
+                      return a.self > b.self;
+                  if (a.total != b.total)
+                      return a.total > b.total;
+                  return a.function < b.function;
+              });
+
+    return profile;
+}
+
+void profiler::write_flat(ostream& os) const {
+    os << "  self%  total%     self    total  function" << std::endl;
+    double scale = m_samples ? 100.0 / m_samples : 0.0;
+    for (const profile_entry& entry : flat_profile()) {
+        os << std::fixed << std::setprecision(2)
+           << std::setw(7) << entry.self * scale << " "
+           << std::setw(7) << entry.total * scale << " "
+           << std::setw(8) << entry.self << " "
+           << std::setw(8) << entry.total << "  "
+           << entry.function << std::endl;
+    }
+}
+
+void profiler::write_folded(ostream& os) const {
+    vector<pair<string, u64>> stacks(m_folded.begin(), m_folded.end());
+    std::sort(stacks.begin(), stacks.end());
+    for (const auto& stack : stacks)
+        os << stack.first << " " << stack.second << std::endl;
+}
+
+} // namespace debugging
+} // namespace vcml
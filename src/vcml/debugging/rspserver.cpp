@@ -19,23 +19,24 @@ static bool needs_escape(char c) {
 }
 
 static string rsp_escape(const string& s) {
-    stringstream ss;
+    string esc;
+    esc.reserve(s.size());
     for (char c : s) {
         if (needs_escape(c)) {
-            c ^= 0x20;
-            ss << '}' << c;
+            esc += '}';
+            esc += c ^ 0x20;
         } else {
-            ss << c;
+            esc += c;
         }
     }
 
-    return ss.str();
+    return esc;
 }
 
-static u8 checksum(const char* str) {
+static u8 checksum(const string& str) {
     u8 result = 0;
-    while (str && *str)
-        result += static_cast<u8>(*str++);
+    for (char c : str)
+        result += static_cast<u8>(c);
     return result;
 }
 
@@ -44,11 +45,17 @@ rspserver::rspserver(u16 port):
     m_port(m_sock.port()),
     m_name(mkstr("rsp_%hu", m_port)),
     m_echo(false),
+    m_noack(false),
     m_running(false),
+    m_resume(false),
     m_mutex(),
+    m_tx_mutex(),
     m_thread(),
     m_handlers(),
     log(m_name) {
+    register_handler("QStartNoAckMode", [](const string& cmd) -> string {
+        return "OK"; // acks are disabled once this response got acked
+    });
 }
 
 rspserver::~rspserver() {
@@ -63,13 +70,23 @@ void rspserver::send_packet(const char* format, ...) {
     va_end(args);
 }
 
-void rspserver::send_packet(const string& s) {
-    VCML_ERROR_ON(!is_connected(), "no connection established");
+static string rsp_frame(char start, const string& s) {
     string esc = rsp_escape(s);
 
-    stringstream ss;
-    u8 sum = checksum(esc.c_str());
-    ss << "$" << esc << "#" << to_hex_ascii(sum >> 4) << to_hex_ascii(sum);
+    u8 sum = checksum(esc);
+    string packet;
+    packet.reserve(esc.size() + 4);
+    packet += start;
+    packet += esc;
+    packet += '#';
+    packet += to_hex_ascii(sum >> 4);
+    packet += to_hex_ascii(sum);
+    return packet;
+}
+
+void rspserver::send_packet(const string& s) {
+    VCML_ERROR_ON(!is_connected(), "no connection established");
+    string packet = rsp_frame('$', s);
 
     char ack;
     size_t attempts = 10;
@@ -83,9 +100,15 @@ void rspserver::send_packet(const string& s) {
         }
 
         if (m_echo)
-            log_debug("sending packet '%s'", ss.str().c_str());
+            log_debug("sending packet '%s'", packet.c_str());
 
-        m_sock.send(ss.str());
+        {
+            lock_guard<mutex> tx(m_tx_mutex);
+            m_sock.send(packet);
+        }
+
+        if (m_noack)
+            return;
 
         do {
             ack = m_sock.recv_char();
@@ -96,24 +119,35 @@ void rspserver::send_packet(const string& s) {
     } while (ack != '+');
 }
 
+void rspserver::send_notification(const string& s) {
+    VCML_ERROR_ON(!is_connected(), "no connection established");
+    string packet = rsp_frame('%', s);
+
+    if (m_echo)
+        log_debug("sending notification '%s'", packet.c_str());
+
+    lock_guard<mutex> tx(m_tx_mutex);
+    m_sock.send(packet);
+}
+
 string rspserver::recv_packet() {
     lock_guard<mutex> lock(m_mutex);
     VCML_ERROR_ON(!is_connected(), "no connection established");
 
     u8 checksum = 0;
-    stringstream ss;
+    string packet;
 
     while (true) {
         char ch = m_sock.recv_char();
         switch (ch) {
         case '$':
             checksum = 0;
-            ss.str("");
+            packet.clear();
             break;
 
         case '#': {
             if (m_echo)
-                log_debug("received packet '%s'", ss.str().c_str());
+                log_debug("received packet '%s'", packet.c_str());
 
             u8 refsum = 0;
             refsum |= from_hex_ascii(m_sock.recv_char()) << 4;
@@ -121,17 +155,24 @@ string rspserver::recv_packet() {
 
             if (refsum != checksum) {
                 log_warn("checksum mismatch %02x != %02x", refsum, checksum);
-                m_sock.send_char('-');
+                if (!m_noack) {
+                    lock_guard<mutex> tx(m_tx_mutex);
+                    m_sock.send_char('-');
+                }
                 checksum = 0;
-                ss.str("");
+                packet.clear();
                 break;
             }
 
+            if (m_noack)
+                return packet;
+
             if (m_echo)
                 log_debug("sending ack '+'");
 
+            lock_guard<mutex> tx(m_tx_mutex);
             m_sock.send_char('+');
-            return ss.str();
+            return packet;
         }
 
         case '}':
@@ -141,12 +182,12 @@ string rspserver::recv_packet() {
             ch ^= 0x20;
             if (!needs_escape(ch))
                 log_warn("escaped invalid char 0x%02hhx", ch);
-            ss << ch;
+            packet += ch;
             break;
 
         default:
             checksum += ch;
-            ss << ch;
+            packet += ch;
             break;
         }
     }
@@ -179,6 +220,7 @@ void rspserver::listen() {
 }
 
 void rspserver::disconnect() {
+    m_noack = false;
     if (m_sock.is_connected()) {
         m_sock.disconnect();
         if (m_running)
@@ -186,6 +228,17 @@ void rspserver::disconnect() {
     }
 }
 
+void rspserver::fork_prepare() {
+    m_resume = m_running;
+    if (m_resume)
+        shutdown();
+}
+
+void rspserver::fork_child() {
+    if (m_resume)
+        run_async();
+}
+
 void rspserver::run_async() {
     m_running = true;
     m_thread = thread(&rspserver::run, this);
@@ -203,6 +256,8 @@ void rspserver::run() {
                     string response = handle_command(command);
                     if (is_connected())
                         send_packet(response);
+                    if (command == "QStartNoAckMode" && response == "OK")
+                        m_noack = true;
                 } catch (vcml::report& r) {
                     log_debug("%s", r.message());
                     break; // not an error, e.g. disconnect
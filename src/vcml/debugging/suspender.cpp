@@ -56,13 +56,16 @@ void suspend_manager::request_pause(suspender* s) {
     if (suspenders.empty())
         on_next_update([&]() -> void { handle_requests(); });
     stl_add_unique(suspenders, s);
+    suspender::requests_pending = true;
 }
 
 void suspend_manager::request_resume(suspender* s) {
     lock_guard<mutex> guard(suspender_lock);
     stl_remove(suspenders, s);
-    if (suspenders.empty())
+    if (suspenders.empty()) {
+        suspender::requests_pending = false;
         thctl_notify();
+    }
 }
 
 bool suspend_manager::is_suspending(const suspender* s) const {
@@ -93,6 +96,7 @@ void suspend_manager::quit() {
 
     is_quitting = true;
     suspenders.clear();
+    suspender::requests_pending = false;
     thctl_notify();
 }
 
@@ -194,7 +198,9 @@ bool suspender::simulation_suspended() {
     return suspend_manager::instance().is_suspended;
 }
 
-void suspender::handle_requests() {
+atomic<bool> suspender::requests_pending(false);
+
+void suspender::handle_pending() {
     suspend_manager::instance().handle_requests();
 }
 
@@ -10,6 +10,9 @@
 
 #include "vcml/debugging/symtab.h"
 
+#include <filesystem>
+#include <future>
+
 namespace vcml {
 namespace debugging {
 
@@ -32,15 +35,122 @@ symbol::symbol(const string& name, symkind kind, endianess endian, u64 sz,
     m_phys(phys_addr) {
 }
 
+void symtab::update_index() const {
+    if (m_indexed)
+        return;
+
+    lock_guard<mutex> guard(m_mtx);
+    if (m_indexed)
+        return;
+
+    m_function_names.clear();
+    m_function_names.reserve(m_functions->size());
+    for (const symbol& func : *m_functions)
+        m_function_names[func.name()] = &func;
+
+    m_object_names.clear();
+    m_object_names.reserve(m_objects->size());
+    for (const symbol& obj : *m_objects)
+        m_object_names[obj.name()] = &obj;
+
+    m_indexed = true;
+}
+
+void symtab::invalidate_index() {
+    lock_guard<mutex> guard(m_mtx);
+    m_function_names.clear();
+    m_object_names.clear();
+    m_indexed = false;
+}
+
+symtab::symset& symtab::unshare(shared_ptr<symset>& syms) {
+    if (syms.use_count() > 1)
+        syms = std::make_shared<symset>(*syms);
+    return *syms;
+}
+
+void symtab::insert_sorted(symset& syms, const symbol& sym) {
+    auto it = std::lower_bound(syms.begin(), syms.end(), sym,
+                               symbol_compare());
+    if (it == syms.end() || it->virt_addr() != sym.virt_addr())
+        syms.insert(it, sym);
+}
+
+void symtab::remove_sorted(symset& syms, const symbol& sym) {
+    auto it = std::lower_bound(syms.begin(), syms.end(), sym,
+                               symbol_compare());
+    if (it != syms.end() && it->virt_addr() == sym.virt_addr())
+        syms.erase(it);
+}
+
+void symtab::sort_unique(symset& syms) {
+    // stable, so that the first symbol given for an address is kept
+    std::stable_sort(syms.begin(), syms.end(), symbol_compare());
+    auto last = std::unique(syms.begin(), syms.end(),
+                            [](const symbol& a, const symbol& b) -> bool {
+                                return a.virt_addr() == b.virt_addr();
+                            });
+    syms.erase(last, syms.end());
+    syms.shrink_to_fit();
+}
+
+const symbol* symtab::find_sorted(const symset& syms, u64 addr) {
+    if (syms.empty())
+        return nullptr;
+    if (addr < syms.front().virt_addr())
+        return nullptr;
+    if (addr > syms.back().memory().end)
+        return nullptr;
+
+    auto it = std::upper_bound(syms.begin(), syms.end(), addr,
+                               [](u64 a, const symbol& sym) -> bool {
+                                   return a < sym.virt_addr();
+                               });
+
+    // find first that is not greater than addr
+    const symbol& sym = *--it;
+    return sym.memory().includes(addr) ? &sym : nullptr;
+}
+
+symtab::symtab():
+    m_functions(std::make_shared<symset>()),
+    m_objects(std::make_shared<symset>()),
+    m_mtx(),
+    m_indexed(false),
+    m_function_names(),
+    m_object_names() {
+}
+
+symtab::symtab(const symtab& other):
+    m_functions(other.m_functions),
+    m_objects(other.m_objects),
+    m_mtx(),
+    m_indexed(false),
+    m_function_names(),
+    m_object_names() {
+}
+
+symtab& symtab::operator=(const symtab& other) {
+    if (this != &other) {
+        m_functions = other.m_functions;
+        m_objects = other.m_objects;
+        invalidate_index();
+    }
+
+    return *this;
+}
+
 void symtab::insert(const symbol& sym) {
     if (!sym.is_function() && !sym.is_object())
         VCML_ERROR("symbol '%s' has no known type", sym.name());
 
     if (sym.is_function())
-        insert_function(sym);
+        insert_sorted(unshare(m_functions), sym);
 
     if (sym.is_object())
-        insert_object(sym);
+        insert_sorted(unshare(m_objects), sym);
+
+    invalidate_index();
 }
 
 void symtab::remove(const symbol& sym) {
@@ -48,17 +158,26 @@ void symtab::remove(const symbol& sym) {
         VCML_ERROR("symbol '%s' has no known type", sym.name());
 
     if (sym.is_function())
-        remove_function(sym);
+        remove_sorted(unshare(m_functions), sym);
 
     if (sym.is_object())
-        remove_object(sym);
+        remove_sorted(unshare(m_objects), sym);
+
+    invalidate_index();
 }
 
 void symtab::clear() {
-    m_functions.clear();
-    m_objects.clear();
-    m_function_names.clear();
-    m_object_names.clear();
+    m_functions = std::make_shared<symset>();
+    m_objects = std::make_shared<symset>();
+    invalidate_index();
+}
+
+void symtab::assign(symset&& functions, symset&& objects) {
+    m_functions = std::make_shared<symset>(std::move(functions));
+    m_objects = std::make_shared<symset>(std::move(objects));
+    sort_unique(*m_functions);
+    sort_unique(*m_objects);
+    invalidate_index();
 }
 
 const symbol* symtab::find_symbol(const string& name) const {
@@ -76,73 +195,71 @@ const symbol* symtab::find_symbol(u64 addr) const {
 }
 
 const symbol* symtab::find_function(const string& name) const {
+    update_index();
     const auto it = m_function_names.find(name);
     return it != m_function_names.end() ? it->second : nullptr;
 }
 
 const symbol* symtab::find_function(u64 addr) const {
-    if (m_functions.empty())
-        return nullptr;
-    if (addr < m_functions.begin()->virt_addr())
-        return nullptr;
-    if (addr > m_functions.rbegin()->memory().end)
-        return nullptr;
-
-    symbol upper("", SYMKIND_FUNCTION, ENDIAN_LITTLE, 0, addr, addr);
-    auto it = m_functions.upper_bound(upper);
-
-    // find first that is not greater than addr
-    const symbol& sym = *--it;
-    return sym.memory().includes(addr) ? &sym : nullptr;
+    return find_sorted(*m_functions, addr);
 }
 
 const symbol* symtab::find_object(const string& name) const {
+    update_index();
     const auto it = m_object_names.find(name);
     return it != m_object_names.end() ? it->second : nullptr;
 }
 
 const symbol* symtab::find_object(u64 addr) const {
-    if (m_objects.empty())
-        return nullptr;
-    if (addr < m_objects.begin()->virt_addr())
-        return nullptr;
-    if (addr > m_objects.rbegin()->memory().end)
-        return nullptr;
-
-    symbol upper("", SYMKIND_OBJECT, ENDIAN_LITTLE, 0, addr, addr);
-    auto it = m_objects.upper_bound(upper);
-
-    // find first that is not greater than addr
-    const symbol& sym = *--it;
-    return sym.memory().includes(addr) ? &sym : nullptr;
+    return find_sorted(*m_objects, addr);
 }
 
 void symtab::merge(const symtab& other) {
-    for (const auto& func : other.m_functions)
-        insert_function(func);
-    for (const auto& obj : other.m_objects)
-        insert_object(obj);
+    if (empty()) {
+        *this = other;
+        return;
+    }
+
+    // symbols already present take precedence over those being merged
+    symset& functions = unshare(m_functions);
+    symset& objects = unshare(m_objects);
+    functions.insert(functions.end(), other.m_functions->begin(),
+                     other.m_functions->end());
+    objects.insert(objects.end(), other.m_objects->begin(),
+                   other.m_objects->end());
+
+    sort_unique(functions);
+    sort_unique(objects);
+    invalidate_index();
 }
 
-u64 symtab::load_elf(const string& filename) {
-    if (!mwr::file_exists(filename))
-        return 0;
+struct elf_symbols {
+    u64 count;
+    symtab syms;
+};
 
-    mwr::elf reader(filename);
+typedef std::shared_future<shared_ptr<const elf_symbols>> elf_future;
+
+static shared_ptr<const elf_symbols> read_elf(const string& path) {
+    mwr::elf reader(path);
     endianess endian = reader.is_big_endian() ? ENDIAN_BIG : ENDIAN_LITTLE;
 
+    auto parsed = std::make_shared<elf_symbols>();
+    parsed->count = reader.symbols().size();
+
+    symtab::symset functions, objects;
     for (const auto& symbol : reader.symbols()) {
         switch (symbol.kind) {
         case mwr::elf::KIND_OBJECT:
         case mwr::elf::KIND_COMMON:
         case mwr::elf::KIND_TLS:
-            insert({ symbol.name, SYMKIND_OBJECT, endian, symbol.size,
-                     symbol.virt, symbol.phys });
+            objects.emplace_back(symbol.name, SYMKIND_OBJECT, endian,
+                                 symbol.size, symbol.virt, symbol.phys);
             break;
 
         case mwr::elf::KIND_FUNC:
-            insert({ symbol.name, SYMKIND_FUNCTION, endian, symbol.size,
-                     symbol.virt, symbol.phys });
+            functions.emplace_back(symbol.name, SYMKIND_FUNCTION, endian,
+                                   symbol.size, symbol.virt, symbol.phys);
             break;
 
         case mwr::elf::KIND_UNKNOWN:
@@ -152,33 +269,49 @@ u64 symtab::load_elf(const string& filename) {
         }
     }
 
-    return reader.symbols().size();
+    parsed->syms.assign(std::move(functions), std::move(objects));
+    return parsed;
 }
 
-void symtab::insert_function(const symbol& sym) {
-    auto insert = m_functions.insert(sym);
-    if (insert.second)
-        m_function_names[sym.name()] = &(*insert.first);
+// files are cached by canonical path and modification time, the lock is
+// only held to look up the entry, parsing itself happens outside of it on
+// a host thread for prefetches or the first thread waiting for the result
+static elf_future parse_elf(const string& filename, bool async) {
+    static mutex mtx;
+    static unordered_map<string, pair<std::filesystem::file_time_type,
+                                      elf_future>>
+        cache;
+
+    std::error_code ec;
+    string path = std::filesystem::canonical(filename, ec).string();
+    if (ec)
+        path = filename;
+
+    auto mtime = std::filesystem::last_write_time(path, ec);
+
+    lock_guard<mutex> guard(mtx);
+    auto it = cache.find(path);
+    if (it != cache.end() && it->second.first == mtime)
+        return it->second.second;
+
+    auto policy = async ? std::launch::async : std::launch::deferred;
+    elf_future parsed = std::async(policy, read_elf, path).share();
+    cache[path] = { mtime, parsed };
+    return parsed;
 }
 
-void symtab::insert_object(const symbol& sym) {
-    auto insert = m_objects.insert(sym);
-    if (insert.second)
-        m_object_names[sym.name()] = &(*insert.first);
+void symtab::prefetch_elf(const string& filename) {
+    if (mwr::file_exists(filename))
+        parse_elf(filename, true);
 }
 
-void symtab::remove_function(const symbol& sym) {
-    auto func = m_function_names.find(sym.name());
-    if (func != m_function_names.end())
-        m_function_names.erase(func);
-    m_functions.erase(sym);
-}
+u64 symtab::load_elf(const string& filename) {
+    if (!mwr::file_exists(filename))
+        return 0;
 
-void symtab::remove_object(const symbol& sym) {
-    auto obj = m_object_names.find(sym.name());
-    if (obj != m_object_names.end())
-        m_object_names.erase(obj);
-    m_objects.erase(sym);
+    shared_ptr<const elf_symbols> parsed = parse_elf(filename, false).get();
+    merge(parsed->syms);
+    return parsed->count;
 }
 
 } // namespace debugging
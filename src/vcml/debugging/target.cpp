@@ -63,7 +63,9 @@ target::target():
     m_symbols(),
     m_steppers(),
     m_breakpoints(),
-    m_watchpoints() {
+    m_watchpoints(),
+    m_breakpoint_index(),
+    m_watched_pages() {
     module* host = hierarchy_search<module>();
     VCML_ERROR_ON(!host, "debug target declared outside module");
     m_name = host->name();
@@ -305,37 +307,68 @@ bool target::remove_watchpoint(const range& addr, vcml_access a) {
     return false; // to be overloaded
 }
 
+void target::index_watchpoint(const range& addr, bool insert) {
+    u64 first = addr.start >> WATCH_PAGE_BITS;
+    u64 last = addr.end >> WATCH_PAGE_BITS;
+    for (u64 page = first; page <= last; page++) {
+        if (insert) {
+            m_watched_pages[page]++;
+        } else {
+            auto it = m_watched_pages.find(page);
+            if (it != m_watched_pages.end() && --it->second == 0)
+                m_watched_pages.erase(it);
+        }
+    }
+}
+
+bool target::is_watched(const range& mem) const {
+    if (m_watched_pages.empty())
+        return false;
+
+    u64 first = mem.start >> WATCH_PAGE_BITS;
+    u64 last = mem.end >> WATCH_PAGE_BITS;
+    for (u64 page = first; page <= last; page++)
+        if (stl_contains(m_watched_pages, page))
+            return true;
+
+    return false;
+}
+
 void target::notify_breakpoint_hit(u64 pc) {
-    for (auto& bp : m_breakpoints)
-        if (bp->address() == pc)
-            bp->notify();
+    auto it = m_breakpoint_index.find(pc);
+    if (it != m_breakpoint_index.end())
+        it->second->notify();
 }
 
 void target::notify_watchpoint_read(const range& addr) {
+    if (!is_watched(addr))
+        return;
+
     for (auto& wp : m_watchpoints)
         if (wp->address().overlaps(addr))
             wp->notify_read(addr);
 }
 
 void target::notify_watchpoint_write(const range& addr, u64 newval) {
+    if (!is_watched(addr))
+        return;
+
     for (auto& wp : m_watchpoints)
         if (wp->address().overlaps(addr))
             wp->notify_write(addr, newval);
 }
 
 const breakpoint* target::lookup_breakpoint(u64 addr) {
-    for (auto& bp : m_breakpoints)
-        if (bp->address() == addr)
-            return bp;
-    return nullptr;
+    auto it = m_breakpoint_index.find(addr);
+    return it != m_breakpoint_index.end() ? it->second : nullptr;
 }
 
 const breakpoint* target::insert_breakpoint(u64 addr, subscriber* subscr) {
-    for (auto& bp : m_breakpoints)
-        if (bp->address() == addr) {
-            bp->subscribe(subscr);
-            return bp;
-        }
+    auto it = m_breakpoint_index.find(addr);
+    if (it != m_breakpoint_index.end()) {
+        it->second->subscribe(subscr);
+        return it->second;
+    }
 
     if (!insert_breakpoint(addr))
         return nullptr;
@@ -344,6 +377,7 @@ const breakpoint* target::insert_breakpoint(u64 addr, subscriber* subscr) {
     breakpoint* newbp = new breakpoint(*this, addr, func);
     newbp->subscribe(subscr);
     m_breakpoints.push_back(newbp);
+    m_breakpoint_index[addr] = newbp;
     return newbp;
 }
 
@@ -364,6 +398,7 @@ bool target::remove_breakpoint(const breakpoint* bp, subscriber* subscr) {
     if (!remove_breakpoint((*it)->address()))
         return false;
 
+    m_breakpoint_index.erase((*it)->address());
     delete *it;
     m_breakpoints.erase(it);
     return true;
@@ -384,6 +419,7 @@ bool target::remove_breakpoint(u64 addr, subscriber* subscr) {
     if ((*it)->has_subscribers())
         return true;
 
+    m_breakpoint_index.erase(addr);
     delete *it;
     m_breakpoints.erase(it);
 
@@ -401,6 +437,7 @@ bool target::insert_watchpoint(const range& addr, vcml_access prot,
         const symbol* obj = m_symbols.find_object(addr.start);
         watchpoint* newwp = new watchpoint(*this, addr, obj);
         m_watchpoints.push_back(newwp);
+        index_watchpoint(addr, true);
         wp = m_watchpoints.end() - 1;
     }
 
@@ -446,6 +483,7 @@ bool target::remove_watchpoint(const range& addr, vcml_access prot,
     }
 
     if (!(*wp)->has_any_subscribers()) {
+        index_watchpoint(addr, false);
         delete *wp;
         m_watchpoints.erase(wp);
     }
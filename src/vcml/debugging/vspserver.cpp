@@ -92,19 +92,26 @@ static const char* obj_version(sc_object* obj) {
     return starts_with(kind, "vcml::") ? VCML_VERSION_STRING : SC_VERSION;
 }
 
-static void list_object(ostream& os, sc_object* obj) {
+static bool is_hidden(sc_object* obj) {
     // hide object names starting with $$$
-    if (starts_with(obj->basename(), "$$$"))
-        return;
+    return starts_with(obj->basename(), "$$$");
+}
 
-    os << "<object"
+static string list_tag(sc_object* obj) {
+    stringstream ss;
+    ss << "<object"
        << " name=\"" << xml_escape(obj->basename()) << "\""
        << " kind=\"" << xml_escape(obj->kind()) << "\""
-       << " version=\"" << xml_escape(obj_version(obj)) << "\">";
+       << " version=\"" << xml_escape(obj_version(obj)) << "\"";
+    return ss.str();
+}
+
+static string list_body(sc_object* obj) {
+    stringstream ss;
 
     // list object attributes
     for (const sc_attr_base* attr : obj->attr_cltn()) {
-        os << "<attribute"
+        ss << "<attribute"
            << " name=\"" << xml_escape(attr_name(attr)) << "\""
            << " type=\"" << xml_escape(attr_type(attr)) << "\""
            << " count=\"" << attr_count(attr) << "\""
@@ -115,7 +122,7 @@ static void list_object(ostream& os, sc_object* obj) {
     module* mod = dynamic_cast<module*>(obj);
     if (mod != nullptr) {
         for (const command_base* cmd : mod->get_commands()) {
-            os << "<command"
+            ss << "<command"
                << " name=\"" << xml_escape(cmd->name()) << "\""
                << " argc=\"" << cmd->argc() << "\""
                << " desc=\"" << xml_escape(cmd->desc()) << "\""
@@ -123,9 +130,77 @@ static void list_object(ostream& os, sc_object* obj) {
         }
     }
 
-    // list object children
-    for (sc_object* child : obj->get_child_objects())
-        list_object(os, child); // recursive call
+    return ss.str();
+}
+
+size_t vspserver::index_object(sc_object* obj) {
+    size_t idx = m_index.size();
+    m_index.push_back({ obj, list_tag(obj), list_body(obj), {} });
+    m_index_names[obj->name()] = idx;
+
+    for (sc_object* child : obj->get_child_objects()) {
+        if (!is_hidden(child)) {
+            size_t sub = index_object(child); // recursive call
+            m_index[idx].children.push_back(sub);
+        }
+    }
+
+    return idx;
+}
+
+void vspserver::build_index() {
+    m_index.clear();
+    m_index_roots.clear();
+    m_index_names.clear();
+
+    for (sc_object* obj : sc_core::sc_get_top_level_objects())
+        if (!is_hidden(obj))
+            m_index_roots.push_back(index_object(obj));
+}
+
+// objects are only created or destroyed while the simulation runs, so
+// after each run we compare the tree against the index by pointer alone
+bool vspserver::index_matches(const vector<sc_object*>& objs,
+                              size_t& pos) const {
+    for (sc_object* obj : objs) {
+        if (is_hidden(obj))
+            continue;
+        if (pos >= m_index.size() || m_index[pos++].obj != obj)
+            return false;
+        if (!index_matches(obj->get_child_objects(), pos))
+            return false;
+    }
+
+    return true;
+}
+
+void vspserver::update_index() {
+    if (m_index.empty() || m_index_check) {
+        size_t pos = 0;
+        const auto& roots = sc_core::sc_get_top_level_objects();
+        if (m_index.empty() || !index_matches(roots, pos) ||
+            pos != m_index.size()) {
+            build_index();
+        }
+
+        m_index_check = false;
+    }
+}
+
+void vspserver::list_index(ostream& os, size_t idx, size_t depth) const {
+    const index_entry& entry = m_index[idx];
+    os << entry.tag;
+
+    // tell the front-end how much is left to fetch with a subtree query
+    if (depth == 0 && !entry.children.empty())
+        os << " children=\"" << entry.children.size() << "\"";
+
+    os << ">" << entry.body;
+
+    if (depth > 0) {
+        for (size_t child : entry.children)
+            list_index(os, child, depth - 1); // recursive call
+    }
 
     os << "</object>";
 }
@@ -207,11 +282,28 @@ string vspserver::handle_list(const string& cmd) {
     if (format != "xml")
         return mkstr("E,unknown hierarchy format '%s'", format.c_str());
 
+    update_index();
+
+    size_t depth = SIZE_MAX;
+    if (args.size() > 3)
+        depth = from_string<size_t>(args[3]);
+
     stringstream ss;
     ss << "OK,<?xml version=\"1.0\" ?><hierarchy>";
 
-    for (auto obj : sc_core::sc_get_top_level_objects())
-        list_object(ss, obj);
+    // subtree query: only list the given object and its children
+    if (args.size() > 2 && !args[2].empty()) {
+        auto it = m_index_names.find(args[2]);
+        if (it == m_index_names.end())
+            return mkstr("E,object '%s' not found", args[2].c_str());
+
+        list_index(ss, it->second, depth);
+        ss << "</hierarchy>";
+        return ss.str();
+    }
+
+    for (size_t root : m_index_roots)
+        list_index(ss, root, depth);
 
     for (auto tgt : debugging::target::all())
         ss << "<target>" << xml_escape(tgt->target_name()) << "</target>";
@@ -292,7 +384,7 @@ string vspserver::handle_geta(const string& cmd) {
         return mkstr("E,insufficient arguments %zu", args.size());
 
     string name = args[1];
-    sc_attr_base* attr = find_attribute(name);
+    sc_attr_base* attr = lookup_attribute(name);
     if (attr == nullptr)
         return mkstr("E,attribute '%s' not found", name.c_str());
 
@@ -314,7 +406,7 @@ string vspserver::handle_seta(const string& cmd) {
     string name = args[1];
     vector<string> values(args.begin() + 2, args.end());
 
-    sc_attr_base* attr = find_attribute(name);
+    sc_attr_base* attr = lookup_attribute(name);
     if (attr == nullptr)
         return mkstr("E,attribute '%s' not found", name.c_str());
 
@@ -336,6 +428,113 @@ string vspserver::handle_seta(const string& cmd) {
     return "OK";
 }
 
+string vspserver::handle_getm(const string& cmd) {
+    if (is_running())
+        return "E,simulation running";
+
+    vector<string> args = split(cmd, ',');
+    if (args.size() < 2)
+        return mkstr("E,insufficient arguments %zu", args.size());
+
+    stringstream ss;
+    ss << "OK";
+
+    for (size_t i = 1; i < args.size(); i++) {
+        sc_attr_base* attr = lookup_attribute(args[i]);
+        if (attr == nullptr)
+            return mkstr("E,attribute '%s' not found", args[i].c_str());
+
+        property_base* prop = dynamic_cast<property_base*>(attr);
+        ss << "," << escape(prop ? prop->str() : attr->name(), ",");
+    }
+
+    return ss.str();
+}
+
+string vspserver::handle_setm(const string& cmd) {
+    if (is_running())
+        return "E,simulation running";
+
+    vector<string> args = split(cmd, ',');
+    if (args.size() < 3 || args.size() % 2 == 0)
+        return mkstr("E,invalid number of arguments %zu", args.size());
+
+    // resolve everything first so that no attribute is set on error
+    vector<property_base*> props;
+    for (size_t i = 1; i < args.size(); i += 2) {
+        sc_attr_base* attr = lookup_attribute(args[i]);
+        if (attr == nullptr)
+            return mkstr("E,attribute '%s' not found", args[i].c_str());
+
+        property_base* prop = dynamic_cast<property_base*>(attr);
+        if (prop == nullptr)
+            return mkstr("E,attribute '%s' not writable", args[i].c_str());
+
+        props.push_back(prop);
+    }
+
+    for (size_t i = 0; i < props.size(); i++)
+        props[i]->str(args[2 * i + 2]);
+
+    return "OK";
+}
+
+string vspserver::handle_subs(const string& cmd) {
+    vector<string> args = split(cmd, ',');
+    if (args.size() < 2)
+        return mkstr("E,insufficient arguments %zu", args.size());
+
+    for (size_t i = 1; i < args.size(); i++) {
+        sc_attr_base* attr = lookup_attribute(args[i]);
+        if (attr == nullptr)
+            return mkstr("E,attribute '%s' not found", args[i].c_str());
+        if (dynamic_cast<property_base*>(attr) == nullptr)
+            return mkstr("E,attribute '%s' not a property", args[i].c_str());
+    }
+
+    // an empty last value makes the next poll report the current one
+    for (size_t i = 1; i < args.size(); i++)
+        m_subscriptions.emplace(args[i], string());
+
+    return "OK";
+}
+
+string vspserver::handle_unsub(const string& cmd) {
+    vector<string> args = split(cmd, ',');
+    if (args.size() < 2) {
+        m_subscriptions.clear();
+        return "OK";
+    }
+
+    for (size_t i = 1; i < args.size(); i++)
+        m_subscriptions.erase(args[i]);
+
+    return "OK";
+}
+
+string vspserver::handle_poll(const string& cmd) {
+    if (is_running())
+        return "E,simulation running";
+
+    stringstream ss;
+    ss << "OK";
+
+    for (auto& sub : m_subscriptions) {
+        auto* prop = dynamic_cast<property_base*>(lookup_attribute(sub.first));
+        if (prop == nullptr)
+            continue;
+
+        string value = prop->str();
+        if (value == sub.second)
+            continue;
+
+        sub.second = value;
+        ss << "," << escape(sub.first, ",") << "," << escape(value, ",");
+    }
+
+    return ss.str();
+}
+
 string vspserver::handle_mkbp(const string& cmd) {
     if (is_running())
         return "E,simulation running";
@@ -391,6 +590,7 @@ void vspserver::resume_simulation(const sc_time& duration) {
     if (is_suspending()) {
         m_stop_reason.clear();
         m_duration = duration;
+        m_index_check = true;
         resume();
     }
 }
@@ -429,13 +629,32 @@ void vspserver::notify_watchpoint_write(const watchpoint& wp,
     pause_simulation(mkstr("wwatchpoint:%llu", wp.id()));
 }
 
+sc_attr_base* vspserver::lookup_attribute(const string& name) {
+    auto it = m_attributes.find(name);
+    if (it != m_attributes.end())
+        return it->second;
+
+    sc_attr_base* attr = find_attribute(name);
+    if (attr != nullptr)
+        m_attributes[name] = attr;
+
+    return attr;
+}
+
 vspserver::vspserver(u16 server_port):
     rspserver(server_port),
     suspender("vspserver"),
     subscriber(),
     m_announce(mwr::temp_dir() + mkstr("/vcml_session_%hu", port())),
     m_stop_reason("elaboration"),
-    m_duration() {
+    m_duration(),
+    m_breakpoints(),
+    m_attributes(),
+    m_subscriptions(),
+    m_index(),
+    m_index_roots(),
+    m_index_names(),
+    m_index_check(false) {
     VCML_ERROR_ON(session != nullptr, "vspserver already created");
     session = this;
     atexit(&cleanup_session);
@@ -452,6 +671,11 @@ vspserver::vspserver(u16 server_port):
     register_handler("setq", &vspserver::handle_setq);
     register_handler("geta", &vspserver::handle_geta);
     register_handler("seta", &vspserver::handle_seta);
+    register_handler("getm", &vspserver::handle_getm);
+    register_handler("setm", &vspserver::handle_setm);
+    register_handler("subs", &vspserver::handle_subs);
+    register_handler("unsub", &vspserver::handle_unsub);
+    register_handler("poll", &vspserver::handle_poll);
     register_handler("mkbp", &vspserver::handle_mkbp);
     register_handler("rmbp", &vspserver::handle_rmbp);
 
@@ -508,6 +732,7 @@ void vspserver::handle_connect(const char* peer) {
 }
 
 void vspserver::handle_disconnect() {
+    m_subscriptions.clear();
     if (sim_running())
         log_info("vspserver waiting on port %hu", port());
 }
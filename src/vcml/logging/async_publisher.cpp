@@ -0,0 +1,195 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/logging/async_publisher.h"
+
+namespace vcml {
+
+static char level_char(log_level lvl) {
+    switch (lvl) {
+    case LOG_ERROR:
+        return 'E';
+    case LOG_WARN:
+        return 'W';
+    case LOG_INFO:
+        return 'I';
+    case LOG_DEBUG:
+        return 'D';
+    default:
+        return 'T';
+    }
+}
+
+static u64 next_publisher_id() {
+    static atomic<u64> id(0);
+    return ++id;
+}
+
+async_publisher::ring::ring(size_t capacity):
+    entries(capacity), head(0), tail(0), dropped(0) {
+}
+
+async_publisher::ring* async_publisher::local_ring() {
+    // every thread gets its own ring per publisher, so producers never
+    // contend with each other and only need to synchronize with the writer
+    thread_local unordered_map<u64, ring*> rings;
+    auto it = rings.find(m_id);
+    if (it != rings.end())
+        return it->second;
+
+    lock_guard<mutex> guard(m_rings_mtx);
+    m_rings.push_back(std::make_unique<ring>(m_capacity));
+    return rings[m_id] = m_rings.back().get();
+}
+
+bool async_publisher::same_message(const entry& a, const entry& b) const {
+    return a.msg.level == b.msg.level && a.msg.sender == b.msg.sender &&
+           a.msg.lines == b.msg.lines;
+}
+
+void async_publisher::write_repeats() {
+    if (m_repeats == 0)
+        return;
+
+    m_os << "[" << level_char(m_last.msg.level) << " ";
+    mwr::publisher::print_timing(m_os, m_last.time_ns);
+    m_os << "] " << m_last.msg.sender << ": (" << m_repeats << " repeats)"
+         << std::endl;
+
+    m_repeats = 0;
+}
+
+void async_publisher::write_entry(const entry& e) {
+    for (const string& line : e.msg.lines) {
+        m_os << "[" << level_char(e.msg.level) << " ";
+        mwr::publisher::print_timing(m_os, e.time_ns);
+        m_os << "] " << e.msg.sender << ": " << line << "\n";
+    }
+}
+
+void async_publisher::write_dropped(size_t count) {
+    write_repeats();
+    m_os << "[W ";
+    mwr::publisher::print_timing(m_os, m_last.time_ns);
+    m_os << "] " << count << " log messages dropped" << std::endl;
+}
+
+bool async_publisher::drain() {
+    vector<ring*> rings;
+    {
+        lock_guard<mutex> guard(m_rings_mtx);
+        for (auto& r : m_rings)
+            rings.push_back(r.get());
+    }
+
+    bool working = false;
+    for (ring* r : rings) {
+        size_t tail = r->tail.load(std::memory_order_relaxed);
+        while (tail != r->head.load(std::memory_order_acquire)) {
+            entry e = std::move(r->entries[tail]);
+            tail = (tail + 1) % m_capacity;
+            r->tail.store(tail, std::memory_order_release);
+            working = true;
+
+            if (!m_last.msg.lines.empty() && same_message(e, m_last)) {
+                m_last.time_ns = e.time_ns;
+                m_repeats++;
+                continue;
+            }
+
+            write_repeats();
+            write_entry(e);
+            m_last = std::move(e);
+        }
+
+        size_t dropped = r->dropped.exchange(0);
+        if (dropped > 0)
+            write_dropped(dropped);
+    }
+
+    return working;
+}
+
+void async_publisher::write_thread() {
+    while (m_running) {
+        if (drain())
+            continue;
+
+        // report repeats whenever we become idle, so that endlessly
+        // repeating messages still show up in the log once in a while
+        write_repeats();
+        m_os.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    drain();
+    write_repeats();
+    m_os.flush();
+}
+
+async_publisher::async_publisher(const string& filename, size_t capacity):
+    mwr::publisher(LOG_ERROR, LOG_INFO),
+    m_id(next_publisher_id()),
+    m_capacity(capacity),
+    m_file(filename.c_str()),
+    m_os(m_file),
+    m_rings_mtx(),
+    m_rings(),
+    m_running(true),
+    m_writer(),
+    m_last(),
+    m_repeats(0) {
+    VCML_ERROR_ON(capacity < 2, "async log capacity too small: %zu", capacity);
+    VCML_ERROR_ON(!m_file.is_open(), "failed to open %s", filename.c_str());
+    m_writer = thread(&async_publisher::write_thread, this);
+    mwr::set_thread_name(m_writer, "log_writer");
+}
+
+async_publisher::async_publisher(ostream& os, size_t capacity):
+    mwr::publisher(LOG_ERROR, LOG_INFO),
+    m_id(next_publisher_id()),
+    m_capacity(capacity),
+    m_file(),
+    m_os(os),
+    m_rings_mtx(),
+    m_rings(),
+    m_running(true),
+    m_writer(),
+    m_last(),
+    m_repeats(0) {
+    VCML_ERROR_ON(capacity < 2, "async log capacity too small: %zu", capacity);
+    m_writer = thread(&async_publisher::write_thread, this);
+    mwr::set_thread_name(m_writer, "log_writer");
+}
+
+async_publisher::~async_publisher() {
+    m_running = false;
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
+void async_publisher::publish(const mwr::logmsg& msg) {
+    ring* r = local_ring();
+    size_t head = r->head.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % m_capacity;
+
+    // never block the simulation, drop messages instead if the ring is full
+    if (next == r->tail.load(std::memory_order_acquire)) {
+        r->dropped++;
+        return;
+    }
+
+    entry& e = r->entries[head];
+    e.msg = msg;
+    e.time_ns = mwr::publisher::current_timestamp();
+    r->head.store(next, std::memory_order_release);
+}
+
+} // namespace vcml
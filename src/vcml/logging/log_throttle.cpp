@@ -0,0 +1,72 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/logging/log_throttle.h"
+
+namespace vcml {
+
+log_throttle::log_throttle(size_t capacity):
+    m_entries(), m_capacity(capacity), m_total(0), m_untracked(0) {
+}
+
+bool log_throttle::record(u64 source, u64 addr, u64 limit) {
+    m_total++;
+
+    auto key = std::make_pair(source, addr);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        // once the cache is full, new addresses are only counted
+        if (m_entries.size() >= m_capacity) {
+            m_untracked++;
+            return limit == 0;
+        }
+
+        it = m_entries.insert({ key, { source, addr, 0, 0 } }).first;
+    }
+
+    entry& e = it->second;
+    e.count++;
+
+    if (limit == 0)
+        return true;
+    if (e.reported >= limit || !is_pow2(e.count))
+        return false;
+
+    e.reported++;
+    return true;
+}
+
+u64 log_throttle::count(u64 source, u64 addr) const {
+    auto it = m_entries.find(std::make_pair(source, addr));
+    return it != m_entries.end() ? it->second.count : 0;
+}
+
+void log_throttle::reset() {
+    m_entries.clear();
+    m_total = 0;
+    m_untracked = 0;
+}
+
+void log_throttle::summary(ostream& os,
+                           const function<string(u64)>& source_name) const {
+    stream_guard guard(os);
+    os << m_total << " errors at " << m_entries.size() << " addresses";
+    for (const auto& it : m_entries) {
+        const entry& e = it.second;
+        os << "\n"
+           << source_name(e.source) << " 0x" << std::hex << std::setw(16)
+           << std::setfill('0') << e.addr << std::dec << ": " << e.count;
+    }
+
+    if (m_untracked > 0)
+        os << "\n" << m_untracked << " errors at untracked addresses";
+}
+
+} // namespace vcml
@@ -14,20 +14,29 @@
 
 namespace vcml {
 
-logger::logger(): mwr::logger(), m_parent(nullptr) {
+static const log_level* parent_level(module* parent) {
+    return parent ? &parent->loglvl.get() : nullptr;
+}
+
+logger::logger(): mwr::logger(), m_parent(nullptr), m_level(nullptr) {
 }
 
 logger::logger(sc_object* parent):
-    mwr::logger(parent->name()), m_parent(hierarchy_search<module>(parent)) {
+    mwr::logger(parent->name()),
+    m_parent(hierarchy_search<module>(parent)),
+    m_level(parent_level(m_parent)) {
 }
 
 logger::logger(const string& name):
-    mwr::logger(name), m_parent(hierarchy_search<module>()) {
+    mwr::logger(name),
+    m_parent(hierarchy_search<module>()),
+    m_level(parent_level(m_parent)) {
 }
 
 bool logger::can_log(log_level lvl) const {
-    log_level mylvl = m_parent ? m_parent->loglvl : level();
-    return lvl <= mylvl;
+    if (!compiled_in(lvl))
+        return false;
+    return lvl <= (m_level ? *m_level : level());
 }
 
 logger log; // global default logger
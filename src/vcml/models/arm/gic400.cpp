@@ -1209,7 +1209,8 @@ gic400::gic400(const sc_module_name& nm):
     virq_out("virq_out", NVCPU),
     m_irq_num(NPRIV),
     m_cpu_num(0),
-    m_irq_state() {
+    m_irq_state(),
+    m_pending_map() {
     clk.bind(distif.clk);
     clk.bind(cpuif.clk);
     clk.bind(vifctrl.clk);
@@ -1231,43 +1232,26 @@ pair<size_t, u32> gic400::get_highest_pend_irq(size_t cpu, bool virt) {
 
     if (!virt) {
         u32 ctlr = distif.ctlr;
-        // check SGIs
-        for (size_t irq = 0; irq < NSGI; irq++) {
-            bool group_enabled = ctlr &
-                                 bit(get_irq_group(irq, mask) == GRP0 ? 0 : 1);
-            if (is_irq_enabled(irq, mask) && test_pending(irq, mask) &&
-                !is_irq_active(irq, mask) && group_enabled) {
-                if (distif.ipriority_sgi.bank(cpu, irq) < best_prio) {
-                    best_prio = distif.ipriority_sgi.bank(cpu, irq);
-                    best_irq = irq;
-                }
-            }
-        }
-
-        // check PPIs
-        for (size_t irq = NSGI; irq < NPRIV; irq++) {
-            bool group_enabled = ctlr &
-                                 bit(get_irq_group(irq, mask) == GRP0 ? 0 : 1);
-            if (is_irq_enabled(irq, mask) && test_pending(irq, mask) &&
-                !is_irq_active(irq, mask) && group_enabled) {
-                int idx = irq - NSGI;
-                if (distif.ipriority_ppi.bank(cpu, idx) < best_prio) {
-                    best_prio = distif.ipriority_ppi.bank(cpu, idx);
-                    best_irq = irq;
-                }
-            }
-        }
-
-        // check SPIs
-        for (size_t irq = NPRIV; irq < m_irq_num; irq++) {
-            bool group_enabled = ctlr &
-                                 bit(get_irq_group(irq, mask) == GRP0 ? 0 : 1);
-            int idx = irq - NPRIV;
-            if (is_irq_enabled(irq, mask) && test_pending(irq, mask) &&
-                (distif.itargets_spi[idx] & mask) &&
-                !is_irq_active(irq, mask) && group_enabled) {
-                if (distif.ipriority_spi[idx] < best_prio) {
-                    best_prio = distif.ipriority_spi[idx];
+        u64 grp0 = (ctlr & bit(GRP0)) ? ~0ull : 0;
+        u64 grp1 = (ctlr & bit(GRP1)) ? ~0ull : 0;
+
+        // candidates are visited in ascending order, so on equal priority
+        // the lowest irq number wins
+        for (size_t word = 0; word < (m_irq_num + 63) / 64; word++) {
+            u64 bits = (m_pending_map[cpu][GRP0][word] & grp0) |
+                       (m_pending_map[cpu][GRP1][word] & grp1);
+            for (; bits; bits &= bits - 1) {
+                size_t irq = word * 64 + ctz(bits);
+                if (irq >= m_irq_num)
+                    break;
+
+                if (irq >= NPRIV &&
+                    !(distif.itargets_spi[irq - NPRIV] & mask))
+                    continue;
+
+                size_t prio = get_irq_priority(cpu, irq);
+                if (prio < best_prio) {
+                    best_prio = prio;
                     best_irq = irq;
                 }
             }
@@ -1287,6 +1271,27 @@ pair<size_t, u32> gic400::get_highest_pend_irq(size_t cpu, bool virt) {
     return { best_irq, best_prio };
 }
 
+void gic400::refresh_irq(size_t irq) {
+    const size_t word = irq / 64;
+    const u64 mask = 1ull << (irq % 64);
+
+    for (size_t cpu = 0; cpu < NCPU; cpu++) {
+        cpu_mask_t cpu_mask = bit(cpu);
+        u64* grp0 = &m_pending_map[cpu][GRP0][word];
+        u64* grp1 = &m_pending_map[cpu][GRP1][word];
+        *grp0 &= ~mask;
+        *grp1 &= ~mask;
+
+        if (is_irq_enabled(irq, cpu_mask) && test_pending(irq, cpu_mask) &&
+            !is_irq_active(irq, cpu_mask)) {
+            if (get_irq_group(irq, cpu_mask) == GRP0)
+                *grp0 |= mask;
+            else
+                *grp1 |= mask;
+        }
+    }
+}
+
 u8 gic400::get_prio_mask(u32 n, bool alias, bool virt) {
     VCML_ERROR_ON(n < 0 || n > 7, "invalid mask range %d", n);
 
@@ -1347,54 +1352,57 @@ pair<bool, bool> gic400::update_excp_state(size_t cpu, size_t& irq,
 }
 
 void gic400::update(bool virt) {
-    for (int cpu = 0; cpu < m_cpu_num; cpu++) {
-        size_t irq;
-        auto [next_irq, next_grp0] = update_excp_state(cpu, irq, virt);
-
-        u32 group_mask = bit(next_grp0 ? 0 : 1);
-        if (!virt && !((distif.ctlr.bank(cpu) & group_mask) &&
-                       (cpuif.ctlr.bank(cpu) & group_mask))) {
-            log_debug("disabling cpu%u irq", cpu);
-            cpuif.hppir.bank(cpu) = SPURIOUS_IRQ;
-            irq_out[cpu] = false;
-            fiq_out[cpu] = false;
-            continue;
-        }
+    for (int cpu = 0; cpu < m_cpu_num; cpu++)
+        update_cpu(cpu, virt);
+}
 
-        if (virt && !(vifctrl.hcr.bank(cpu) & group_mask)) {
-            log_debug("disabling cpu%u virq", cpu);
-            vcpuif.hppir.bank(cpu) = SPURIOUS_IRQ;
-            virq_out[cpu] = false;
-            vfiq_out[cpu] = false;
-            continue;
-        }
+void gic400::update_cpu(size_t cpu, bool virt) {
+    size_t irq;
+    auto [next_irq, next_grp0] = update_excp_state(cpu, irq, virt);
 
-        bool cpu_irq = false;
-        bool cpu_fiq = false;
-        size_t hppir = irq;
-        if (next_irq) {
-            u32 ctlr = virt ? vcpuif.ctlr.bank(cpu) : cpuif.ctlr.bank(cpu);
-            if (next_grp0 && (GICC_CTLR_FIQ_ENABLE & ctlr)) {
-                if (GICC_CTLR_ENABLE_GROUP0 & ctlr) {
-                    cpu_fiq = true;
-                }
-            } else if ((next_grp0 && (GICC_CTLR_ENABLE_GROUP0 & ctlr)) ||
-                       (!next_grp0 && (GICC_CTLR_ENABLE_GROUP1 & ctlr))) {
-                cpu_irq = true;
+    u32 group_mask = bit(next_grp0 ? 0 : 1);
+    if (!virt && !((distif.ctlr.bank(cpu) & group_mask) &&
+                   (cpuif.ctlr.bank(cpu) & group_mask))) {
+        log_debug("disabling cpu%zu irq", cpu);
+        cpuif.hppir.bank(cpu) = SPURIOUS_IRQ;
+        irq_out[cpu] = false;
+        fiq_out[cpu] = false;
+        return;
+    }
+
+    if (virt && !(vifctrl.hcr.bank(cpu) & group_mask)) {
+        log_debug("disabling cpu%zu virq", cpu);
+        vcpuif.hppir.bank(cpu) = SPURIOUS_IRQ;
+        virq_out[cpu] = false;
+        vfiq_out[cpu] = false;
+        return;
+    }
+
+    bool cpu_irq = false;
+    bool cpu_fiq = false;
+    size_t hppir = irq;
+    if (next_irq) {
+        u32 ctlr = virt ? vcpuif.ctlr.bank(cpu) : cpuif.ctlr.bank(cpu);
+        if (next_grp0 && (GICC_CTLR_FIQ_ENABLE & ctlr)) {
+            if (GICC_CTLR_ENABLE_GROUP0 & ctlr) {
+                cpu_fiq = true;
             }
+        } else if ((next_grp0 && (GICC_CTLR_ENABLE_GROUP0 & ctlr)) ||
+                   (!next_grp0 && (GICC_CTLR_ENABLE_GROUP1 & ctlr))) {
+            cpu_irq = true;
         }
+    }
 
-        if (!virt) {
-            cpuif.hppir.bank(cpu) = next_grp0 ? hppir : SPURIOUS_IRQ;
-            cpuif.ahppir.bank(cpu) = next_grp0 ? SPURIOUS_IRQ : hppir;
-            fiq_out[cpu] = cpu_fiq;
-            irq_out[cpu] = cpu_irq;
-        } else {
-            vcpuif.hppir.bank(cpu) = next_grp0 ? hppir : SPURIOUS_IRQ;
-            vcpuif.ahppir.bank(cpu) = next_grp0 ? SPURIOUS_IRQ : hppir;
-            vfiq_out[cpu] = cpu_fiq;
-            virq_out[cpu] = cpu_irq;
-        }
+    if (!virt) {
+        cpuif.hppir.bank(cpu) = next_grp0 ? hppir : SPURIOUS_IRQ;
+        cpuif.ahppir.bank(cpu) = next_grp0 ? SPURIOUS_IRQ : hppir;
+        fiq_out[cpu] = cpu_fiq;
+        irq_out[cpu] = cpu_irq;
+    } else {
+        vcpuif.hppir.bank(cpu) = next_grp0 ? hppir : SPURIOUS_IRQ;
+        vcpuif.ahppir.bank(cpu) = next_grp0 ? SPURIOUS_IRQ : hppir;
+        vfiq_out[cpu] = cpu_fiq;
+        virq_out[cpu] = cpu_irq;
     }
 }
 
@@ -1475,6 +1483,29 @@ void gic400::handle_spi(size_t idx, bool state) {
     update();
 }
 
+void gic400::signal_spi(size_t idx) {
+    size_t irq = NPRIV + idx;
+    cpu_mask_t target_cpu = distif.itargets_spi[idx];
+
+    // level triggered spis only see the transient level of the pulse
+    if (get_irq_trigger(irq) != EDGE) {
+        handle_spi(idx, true);
+        handle_spi(idx, false);
+        return;
+    }
+
+    set_irq_signaled(irq, false, gic400::ALL_CPU);
+    if ((m_irq_state[irq].pending & target_cpu) == target_cpu)
+        return; // already pending everywhere, nothing changes
+
+    set_irq_pending(irq, true, target_cpu);
+
+    for (size_t cpu = 0; cpu < m_cpu_num; cpu++) {
+        if (target_cpu & bit(cpu))
+            update_cpu(cpu);
+    }
+}
+
 VCML_EXPORT_MODEL(vcml::arm::gic400, name, args) {
     return new gic400(name);
 }
@@ -15,7 +15,12 @@ namespace arm {
 
 void gicv2m::write_setspi(u32 val) {
     val &= SETSPI_SPI::MASK;
-    if (val >= base_spi && val < base_spi + num_spi)
+    if (val < base_spi || val >= base_spi + num_spi)
+        return;
+
+    if (m_gic)
+        m_gic->signal_spi(val - gic400::NPRIV);
+    else
         out[val].pulse();
 }
 
@@ -25,6 +30,7 @@ u32 gicv2m::read_typer() {
 
 gicv2m::gicv2m(const sc_module_name& nm):
     peripheral(nm),
+    m_gic(nullptr),
     base_spi("base_spi", 64),
     num_spi("num_spi", 64),
     typer("typer", TYPER_ADDR),
@@ -51,6 +57,15 @@ gicv2m::~gicv2m() {
     // nothing to do
 }
 
+void gicv2m::connect(gic400& gic) {
+    if (base_spi < gic400::NPRIV)
+        VCML_ERROR("base_spi %zu is not an spi", base_spi.get());
+    if (base_spi + num_spi > gic400::NPRIV + gic400::NSPI)
+        VCML_ERROR("spis %zu..%zu out of range for %s", base_spi.get(),
+                   base_spi + num_spi - 1, gic.name());
+    m_gic = &gic;
+}
+
 VCML_EXPORT_MODEL(vcml::arm::gicv2m, name, args) {
     return new gicv2m(name);
 }
@@ -24,15 +24,31 @@ void pl190vic::update() {
     for (auto fiq : fiq_out)
         fiq.second->write(fiqs != 0u);
 
+    u32 vect = irqs & m_vect_srcs;
+    if (vect == 0)
+        return;
+
+    u32 slots = 0;
+    for (; vect; vect &= vect - 1)
+        slots |= m_src_slots[ctz(vect)];
+
+    // vector slot 0 has the highest priority
+    unsigned int l = ctz(slots);
+    addr = vaddr[l];
+    m_current_irq = vctrl[l] & VCTRL_SOURCE_M;
+    m_vect_int = true;
+}
+
+void pl190vic::update_vectors() {
+    m_vect_srcs = 0;
+    for (u16& slots : m_src_slots)
+        slots = 0;
+
     for (unsigned int l = 0; l < vctrl.count(); l++) {
         if (vctrl[l] & VCTRL_ENABLED) {
             u32 source = vctrl[l] & VCTRL_SOURCE_M;
-            u32 srcmsk = 1 << source;
-            if (irqs & srcmsk) {
-                addr = vaddr[l];
-                m_current_irq = source;
-                m_vect_int = true;
-            }
+            m_vect_srcs |= 1u << source;
+            m_src_slots[source] |= 1u << l;
         }
     }
 }
@@ -68,7 +84,8 @@ void pl190vic::write_addr(u32 val) {
 }
 
 void pl190vic::write_vctrl(u32 val, size_t idx) {
-    vctrl = val & VCTRL_M;
+    vctrl[idx] = val & VCTRL_M;
+    update_vectors();
 }
 
 pl190vic::pl190vic(const sc_module_name& nm):
@@ -76,6 +93,8 @@ pl190vic::pl190vic(const sc_module_name& nm):
     m_ext_irq(0),
     m_current_irq(0xff),
     m_vect_int(false),
+    m_vect_srcs(0),
+    m_src_slots(),
     irqs("irqs", 0x000),
     fiqs("fiqs", 0x004),
     risr("risr", 0x008),
@@ -139,6 +158,8 @@ void pl190vic::reset() {
 
     for (unsigned int i = 0; i < cid.count(); i++)
         cid[i] = (AMBA_CID >> (i * 8)) & 0xff;
+
+    update_vectors();
 }
 
 void pl190vic::gpio_notify(const gpio_target_socket& socket) {
@@ -11,6 +11,9 @@
 #include "vcml/models/block/backend.h"
 #include "vcml/models/block/backend_ram.h"
 #include "vcml/models/block/backend_file.h"
+#include "vcml/models/block/backend_pio.h"
+#include "vcml/models/block/backend_cow.h"
+#include "vcml/models/block/backend_mmap.h"
 
 namespace vcml {
 namespace block {
@@ -42,6 +45,38 @@ void backend::flush() {
     // nothing to do
 }
 
+void backend::read_at(size_t offset, u8* buffer, size_t size) {
+    size_t cur = pos();
+    seek(offset);
+    read(buffer, size);
+    seek(cur);
+}
+
+void backend::write_at(size_t offset, const u8* buffer, size_t size) {
+    size_t cur = pos();
+    seek(offset);
+    write(buffer, size);
+    seek(cur);
+}
+
+bool backend::delta(vector<range>& extents) {
+    return false;
+}
+
+void backend::readv_at(size_t offset, const vector<iovec>& iov) {
+    for (const iovec& vec : iov) {
+        read_at(offset, (u8*)vec.iov_base, vec.iov_len);
+        offset += vec.iov_len;
+    }
+}
+
+void backend::writev_at(size_t offset, const vector<iovec>& iov) {
+    for (const iovec& vec : iov) {
+        write_at(offset, (const u8*)vec.iov_base, vec.iov_len);
+        offset += vec.iov_len;
+    }
+}
+
 static size_t parse_capacity(const string& desc) {
     string s = to_lower(desc);
     char* endptr = nullptr;
@@ -68,6 +103,24 @@ backend* backend::create(const string& image, bool readonly) {
         return new backend_ram(cap, readonly);
     }
 
+    if (starts_with(image, "pio:"))
+        return new backend_pio(image.substr(4), readonly);
+
+    if (starts_with(image, "direct:"))
+        return new backend_pio(image.substr(7), readonly, true);
+
+    if (starts_with(image, "mmap:"))
+        return new backend_mmap(image.substr(5), readonly);
+
+    if (starts_with(image, "cow:")) {
+        string desc = image.substr(4);
+        size_t sep = desc.rfind(',');
+        if (sep == string::npos)
+            return new backend_cow(desc, "", readonly);
+        return new backend_cow(desc.substr(0, sep), desc.substr(sep + 1),
+                               readonly);
+    }
+
     // if no image specification is given we test if its just a path
     return new backend_file(image, readonly);
 }
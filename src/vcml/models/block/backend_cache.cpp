@@ -0,0 +1,294 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/block/backend_cache.h"
+#include "vcml/logging/logger.h"
+
+namespace vcml {
+namespace block {
+
+size_t backend_cache::page_length(size_t index) const {
+    return min(PAGE_SIZE, m_capacity - index * PAGE_SIZE);
+}
+
+backend_cache::page* backend_cache::lookup(size_t index) {
+    auto it = m_pages.find(index);
+    if (it == m_pages.end())
+        return nullptr;
+
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return &m_lru.front();
+}
+
+backend_cache::page& backend_cache::insert(size_t index) {
+    if (m_pages.size() < m_max_pages) {
+        m_lru.push_front({ index, false, vector<u8>(page_length(index)) });
+    } else {
+        // recycle the least recently used page and its buffer
+        auto it = std::prev(m_lru.end());
+        write_back(*it);
+        m_pages.erase(it->index);
+        m_stats.num_evictions++;
+
+        m_lru.splice(m_lru.begin(), m_lru, it);
+        it->index = index;
+        it->dirty = false;
+        it->data.resize(page_length(index));
+    }
+
+    m_pages[index] = m_lru.begin();
+    return m_lru.front();
+}
+
+void backend_cache::fill(size_t first, size_t last) {
+    size_t offset = first * PAGE_SIZE;
+    size_t size = min((last + 1) * PAGE_SIZE, m_capacity) - offset;
+
+    vector<u8> buffer(size);
+    m_base->read_at(offset, buffer.data(), size);
+
+    for (size_t index = first; index <= last; index++) {
+        page& pg = insert(index);
+        const u8* src = buffer.data() + (index - first) * PAGE_SIZE;
+        memcpy(pg.data.data(), src, pg.data.size());
+    }
+}
+
+void backend_cache::drop(size_t offset, size_t size) {
+    if (size == 0)
+        return;
+
+    size_t first = offset / PAGE_SIZE;
+    size_t last = (offset + size - 1) / PAGE_SIZE;
+    for (size_t index = first; index <= last; index++) {
+        auto it = m_pages.find(index);
+        if (it == m_pages.end())
+            continue;
+
+        // partially covered pages must not lose their other contents
+        write_back(*it->second);
+        m_lru.erase(it->second);
+        m_pages.erase(it);
+    }
+}
+
+void backend_cache::write_back(page& pg) {
+    if (!pg.dirty)
+        return;
+
+    m_base->write_at(pg.index * PAGE_SIZE, pg.data.data(), pg.data.size());
+    m_stats.num_writebacks++;
+    pg.dirty = false;
+}
+
+void backend_cache::write_back_all() {
+    vector<page*> dirty;
+    for (page& pg : m_lru)
+        if (pg.dirty)
+            dirty.push_back(&pg);
+
+    std::sort(dirty.begin(), dirty.end(), [](page* a, page* b) -> bool {
+        return a->index < b->index;
+    });
+
+    // adjacent dirty pages go to the base in a single write
+    vector<u8> buffer;
+    for (size_t i = 0; i < dirty.size();) {
+        size_t j = i + 1;
+        while (j < dirty.size() && dirty[j]->index == dirty[j - 1]->index + 1)
+            j++;
+
+        if (j - i == 1) {
+            write_back(*dirty[i++]);
+            continue;
+        }
+
+        buffer.clear();
+        for (size_t k = i; k < j; k++) {
+            buffer.insert(buffer.end(), dirty[k]->data.begin(),
+                          dirty[k]->data.end());
+            dirty[k]->dirty = false;
+        }
+
+        m_base->write_at(dirty[i]->index * PAGE_SIZE, buffer.data(),
+                         buffer.size());
+        m_stats.num_writebacks += j - i;
+        i = j;
+    }
+}
+
+size_t backend_cache::num_dirty() const {
+    size_t n = 0;
+    for (const page& pg : m_lru)
+        if (pg.dirty)
+            n++;
+    return n;
+}
+
+backend_cache::backend_cache(backend* base, size_t size, size_t readahead):
+    backend("cache", base->readonly()),
+    m_base(base),
+    m_pos(0),
+    m_capacity(base->capacity()),
+    m_max_pages(max<size_t>(size / PAGE_SIZE, 1)),
+    m_readahead(readahead / PAGE_SIZE),
+    m_next_offset(0),
+    m_lru(),
+    m_pages(),
+    m_stats() {
+    m_type = mkstr("%s+cache", base->type());
+}
+
+backend_cache::~backend_cache() {
+    try {
+        write_back_all();
+    } catch (std::exception& ex) {
+        log_warn("%s", ex.what());
+    }
+
+    delete m_base;
+}
+
+size_t backend_cache::capacity() {
+    return m_capacity;
+}
+
+size_t backend_cache::pos() {
+    return m_pos;
+}
+
+void backend_cache::seek(size_t pos) {
+    VCML_REPORT_ON(pos > capacity(), "attempt to seek beyond end of buffer");
+    m_pos = pos;
+}
+
+void backend_cache::read(u8* buffer, size_t size) {
+    read_at(m_pos, buffer, size);
+    m_pos += size;
+}
+
+void backend_cache::write(const u8* buffer, size_t size) {
+    write_at(m_pos, buffer, size);
+    m_pos += size;
+}
+
+void backend_cache::save(ostream& os) {
+    write_back_all();
+    m_base->save(os);
+}
+
+void backend_cache::wzero(size_t size, bool may_unmap) {
+    VCML_REPORT_ON(size > remaining(), "writing beyond end of image");
+    drop(m_pos, size);
+    m_base->seek(m_pos);
+    m_base->wzero(size, may_unmap);
+    m_pos += size;
+}
+
+void backend_cache::discard(size_t size) {
+    VCML_REPORT_ON(size > remaining(), "discarding beyond end of image");
+    drop(m_pos, size);
+    m_base->seek(m_pos);
+    m_base->discard(size);
+    m_pos += size;
+}
+
+void backend_cache::flush() {
+    write_back_all();
+    m_base->flush();
+}
+
+void backend_cache::read_at(size_t offset, u8* buffer, size_t size) {
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "reading beyond end of image");
+    if (size == 0)
+        return;
+
+    bool sequential = offset > 0 && offset == m_next_offset;
+    m_next_offset = offset + size;
+
+    size_t npages = (m_capacity + PAGE_SIZE - 1) / PAGE_SIZE;
+    size_t tail = (offset + size - 1) / PAGE_SIZE;
+
+    while (size > 0) {
+        size_t index = offset / PAGE_SIZE;
+        size_t off = offset % PAGE_SIZE;
+        size_t n = min(size, PAGE_SIZE - off);
+
+        page* pg = lookup(index);
+        if (pg != nullptr) {
+            m_stats.num_hits++;
+        } else {
+            m_stats.num_misses++;
+
+            // fetch all missing pages up to the end of this request, plus
+            // the readahead window for sequential accesses, at once
+            size_t last = tail + (sequential ? m_readahead : 0);
+            last = min(last, npages - 1);
+            last = min(last, index + m_max_pages - 1);
+
+            size_t end = index;
+            while (end < last && !stl_contains(m_pages, end + 1))
+                end++;
+
+            fill(index, end);
+            if (end > tail)
+                m_stats.num_readahead += end - tail;
+
+            pg = lookup(index);
+        }
+
+        memcpy(buffer, pg->data.data() + off, n);
+
+        buffer += n;
+        offset += n;
+        size -= n;
+    }
+}
+
+void backend_cache::write_at(size_t offset, const u8* buffer, size_t size) {
+    VCML_REPORT_ON(m_readonly, "attempt to write read-only image");
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "writing beyond end of image");
+
+    while (size > 0) {
+        size_t index = offset / PAGE_SIZE;
+        size_t off = offset % PAGE_SIZE;
+        size_t n = min(size, PAGE_SIZE - off);
+
+        page* pg = lookup(index);
+        if (pg != nullptr) {
+            m_stats.num_hits++;
+        } else {
+            m_stats.num_misses++;
+            if (off == 0 && n == page_length(index)) {
+                pg = &insert(index);
+            } else {
+                fill(index, index);
+                pg = lookup(index);
+            }
+        }
+
+        memcpy(pg->data.data() + off, buffer, n);
+        pg->dirty = true;
+
+        buffer += n;
+        offset += n;
+        size -= n;
+    }
+}
+
+bool backend_cache::delta(vector<range>& extents) {
+    write_back_all();
+    return m_base->delta(extents);
+}
+
+} // namespace block
+} // namespace vcml
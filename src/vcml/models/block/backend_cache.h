@@ -0,0 +1,99 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_BLOCK_BACKEND_CACHE_H
+#define VCML_BLOCK_BACKEND_CACHE_H
+
+#include "vcml/core/types.h"
+
+#include "vcml/models/block/backend.h"
+
+namespace vcml {
+namespace block {
+
+// keeps recently used pages of another backend in memory and evicts the
+// least recently used ones once full; writes stay in the cache until the
+// page is evicted or the cache gets flushed. Misses that continue where
+// the previous access ended are considered sequential and read ahead
+class backend_cache : public backend
+{
+public:
+    static constexpr size_t PAGE_SIZE = 4 * KiB;
+
+    struct cache_stats {
+        size_t num_hits;
+        size_t num_misses;
+        size_t num_readahead;
+        size_t num_evictions;
+        size_t num_writebacks;
+    };
+
+private:
+    struct page {
+        size_t index;
+        bool dirty;
+        vector<u8> data;
+    };
+
+    backend* m_base;
+    size_t m_pos;
+    size_t m_capacity;
+    size_t m_max_pages;
+    size_t m_readahead;
+    size_t m_next_offset;
+
+    list<page> m_lru; // most recently used pages first
+    unordered_map<size_t, list<page>::iterator> m_pages;
+
+    cache_stats m_stats;
+
+    size_t page_length(size_t index) const;
+
+    page* lookup(size_t index);
+    page& insert(size_t index);
+
+    void fill(size_t first, size_t last);
+    void drop(size_t offset, size_t size);
+    void write_back(page& pg);
+    void write_back_all();
+
+public:
+    const cache_stats& stats() const { return m_stats; }
+    size_t num_pages() const { return m_pages.size(); }
+    size_t max_pages() const { return m_max_pages; }
+    size_t num_dirty() const;
+
+    // takes ownership of base
+    backend_cache(backend* base, size_t size, size_t readahead);
+    virtual ~backend_cache();
+
+    virtual size_t capacity() override;
+    virtual size_t pos() override;
+
+    virtual void seek(size_t pos) override;
+    virtual void read(u8* buffer, size_t size) override;
+    virtual void write(const u8* buffer, size_t size) override;
+    virtual void save(ostream& os) override;
+
+    virtual void wzero(size_t size, bool may_unmap) override;
+    virtual void discard(size_t size) override;
+    virtual void flush() override;
+
+    virtual void read_at(size_t offset, u8* buffer, size_t size) override;
+    virtual void write_at(size_t offset, const u8* buffer,
+                          size_t size) override;
+
+    virtual bool delta(vector<range>& extents) override;
+};
+
+} // namespace block
+} // namespace vcml
+
+#endif
@@ -0,0 +1,296 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/block/backend_cow.h"
+#include "vcml/logging/logger.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace vcml {
+namespace block {
+
+struct cow_header {
+    char magic[8];
+    u32 version;
+    u32 cluster_size;
+    u64 capacity;
+    u64 bitmap_offset;
+    u64 data_offset;
+};
+
+static const char COW_MAGIC[8] = "vcmlcow";
+static const u32 COW_VERSION = 1;
+static const u64 COW_BITMAP_OFFSET = 512;
+
+static void pread_all(int fd, void* buffer, size_t size, size_t offset) {
+    u8* ptr = (u8*)buffer;
+    while (size > 0) {
+        ssize_t n = ::pread(fd, ptr, size, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        VCML_REPORT_ON(n < 0, "error reading delta: %s", strerror(errno));
+        if (n == 0) { // sparse tail that has never been written
+            memset(ptr, 0, size);
+            return;
+        }
+
+        ptr += n;
+        offset += n;
+        size -= n;
+    }
+}
+
+static void pwrite_all(int fd, const void* buffer, size_t size,
+                       size_t offset) {
+    const u8* ptr = (const u8*)buffer;
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, ptr, size, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        VCML_REPORT_ON(n <= 0, "error writing delta: %s", strerror(errno));
+
+        ptr += n;
+        offset += n;
+        size -= n;
+    }
+}
+
+bool backend_cow::allocated(size_t cluster) const {
+    return m_bitmap[cluster / 64] & bit(cluster % 64);
+}
+
+size_t backend_cow::cluster_length(size_t cluster) const {
+    return min(CLUSTER_SIZE, m_capacity - cluster * CLUSTER_SIZE);
+}
+
+void backend_cow::open_delta() {
+    int flags = m_readonly ? O_RDONLY : O_RDWR | O_CREAT;
+    m_fd = ::open(m_path.c_str(), flags, 0644);
+    if (m_fd < 0)
+        VCML_REPORT("error opening %s: %s", m_path.c_str(), strerror(errno));
+
+    struct stat info;
+    if (::fstat(m_fd, &info) < 0)
+        VCML_REPORT("error accessing %s: %s", m_path.c_str(), strerror(errno));
+
+    size_t bitmap_size = m_bitmap.size() * sizeof(m_bitmap[0]);
+    m_data_offset = (COW_BITMAP_OFFSET + bitmap_size + CLUSTER_SIZE - 1) &
+                    ~(CLUSTER_SIZE - 1);
+
+    if (info.st_size == 0) {
+        VCML_REPORT_ON(m_readonly, "delta %s is empty", m_path.c_str());
+        write_header();
+        if (::ftruncate(m_fd, m_data_offset + m_capacity) < 0)
+            VCML_REPORT("error resizing %s: %s", m_path.c_str(),
+                        strerror(errno));
+        return;
+    }
+
+    cow_header hdr;
+    pread_all(m_fd, &hdr, sizeof(hdr), 0);
+
+    if (memcmp(hdr.magic, COW_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != COW_VERSION) {
+        VCML_REPORT("%s is not a cow delta", m_path.c_str());
+    }
+
+    if (hdr.cluster_size != CLUSTER_SIZE || hdr.capacity != m_capacity ||
+        hdr.bitmap_offset != COW_BITMAP_OFFSET ||
+        hdr.data_offset != m_data_offset) {
+        VCML_REPORT("%s does not match its base image", m_path.c_str());
+    }
+
+    pread_all(m_fd, m_bitmap.data(), bitmap_size, COW_BITMAP_OFFSET);
+}
+
+void backend_cow::write_header() {
+    cow_header hdr = {};
+    memcpy(hdr.magic, COW_MAGIC, sizeof(hdr.magic));
+    hdr.version = COW_VERSION;
+    hdr.cluster_size = CLUSTER_SIZE;
+    hdr.capacity = m_capacity;
+    hdr.bitmap_offset = COW_BITMAP_OFFSET;
+    hdr.data_offset = m_data_offset;
+
+    pwrite_all(m_fd, &hdr, sizeof(hdr), 0);
+    pwrite_all(m_fd, m_bitmap.data(), m_bitmap.size() * sizeof(m_bitmap[0]),
+               COW_BITMAP_OFFSET);
+    m_dirty = false;
+}
+
+void backend_cow::read_cluster(size_t cluster, size_t off, u8* buffer,
+                               size_t size) {
+    size_t addr = cluster * CLUSTER_SIZE + off;
+    if (!allocated(cluster))
+        m_base->read_at(addr, buffer, size);
+    else if (m_fd >= 0)
+        pread_all(m_fd, buffer, size, m_data_offset + addr);
+    else
+        memcpy(buffer, m_clusters[cluster].data() + off, size);
+}
+
+void backend_cow::write_cluster(size_t cluster, size_t off,
+                                const u8* buffer, size_t size) {
+    size_t addr = cluster * CLUSTER_SIZE + off;
+    if (allocated(cluster)) {
+        if (m_fd >= 0)
+            pwrite_all(m_fd, buffer, size, m_data_offset + addr);
+        else
+            memcpy(m_clusters[cluster].data() + off, buffer, size);
+        return;
+    }
+
+    // first write to this cluster, copy whatever is not overwritten
+    size_t len = cluster_length(cluster);
+    vector<u8> data(len);
+    if (off > 0 || size < len)
+        m_base->read_at(cluster * CLUSTER_SIZE, data.data(), len);
+    memcpy(data.data() + off, buffer, size);
+
+    if (m_fd >= 0)
+        pwrite_all(m_fd, data.data(), len,
+                   m_data_offset + cluster * CLUSTER_SIZE);
+    else
+        m_clusters[cluster] = std::move(data);
+
+    m_bitmap[cluster / 64] |= bit(cluster % 64);
+    m_dirty = true;
+}
+
+size_t backend_cow::num_allocated() const {
+    size_t n = 0;
+    for (u64 word : m_bitmap)
+        n += __builtin_popcountll(word);
+    return n;
+}
+
+backend_cow::backend_cow(const string& base, const string& delta, bool ro):
+    backend("cow", ro),
+    m_base(backend::create(base, true)),
+    m_path(delta),
+    m_fd(-1),
+    m_pos(0),
+    m_capacity(m_base->capacity()),
+    m_data_offset(0),
+    m_dirty(false),
+    m_bitmap(),
+    m_clusters() {
+    size_t nclusters = (m_capacity + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    m_bitmap.resize((nclusters + 63) / 64, 0);
+
+    try {
+        if (!m_path.empty())
+            open_delta();
+    } catch (...) {
+        if (m_fd >= 0)
+            ::close(m_fd);
+        delete m_base;
+        throw;
+    }
+}
+
+backend_cow::~backend_cow() {
+    try {
+        flush();
+    } catch (std::exception& ex) {
+        log_warn("%s", ex.what());
+    }
+
+    if (m_fd >= 0)
+        ::close(m_fd);
+    delete m_base;
+}
+
+size_t backend_cow::capacity() {
+    return m_capacity;
+}
+
+size_t backend_cow::pos() {
+    return m_pos;
+}
+
+void backend_cow::seek(size_t pos) {
+    VCML_REPORT_ON(pos > capacity(), "attempt to seek beyond end of buffer");
+    m_pos = pos;
+}
+
+void backend_cow::read(u8* buffer, size_t size) {
+    VCML_REPORT_ON(size > remaining(), "reading beyond end of image");
+    while (size > 0) {
+        size_t cluster = m_pos / CLUSTER_SIZE;
+        size_t off = m_pos % CLUSTER_SIZE;
+        size_t n = min(size, CLUSTER_SIZE - off);
+
+        read_cluster(cluster, off, buffer, n);
+
+        buffer += n;
+        m_pos += n;
+        size -= n;
+    }
+}
+
+void backend_cow::write(const u8* buffer, size_t size) {
+    VCML_REPORT_ON(m_readonly, "attempt to write read-only image");
+    VCML_REPORT_ON(size > remaining(), "writing beyond end of image");
+    while (size > 0) {
+        size_t cluster = m_pos / CLUSTER_SIZE;
+        size_t off = m_pos % CLUSTER_SIZE;
+        size_t n = min(size, CLUSTER_SIZE - off);
+
+        write_cluster(cluster, off, buffer, n);
+
+        buffer += n;
+        m_pos += n;
+        size -= n;
+    }
+}
+
+void backend_cow::save(ostream& os) {
+    vector<u8> buffer(CLUSTER_SIZE);
+    for (size_t off = 0; off < m_capacity; off += CLUSTER_SIZE) {
+        size_t n = cluster_length(off / CLUSTER_SIZE);
+        read_cluster(off / CLUSTER_SIZE, 0, buffer.data(), n);
+        os.write((const char*)buffer.data(), n);
+        VCML_REPORT_ON(!os, "error saving disk: %s", strerror(errno));
+    }
+}
+
+void backend_cow::flush() {
+    if (m_fd < 0 || m_readonly)
+        return;
+
+    if (m_dirty)
+        write_header();
+
+    VCML_REPORT_ON(::fdatasync(m_fd) < 0, "error flushing %s: %s",
+                   m_path.c_str(), strerror(errno));
+}
+
+bool backend_cow::delta(vector<range>& extents) {
+    size_t nclusters = (m_capacity + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    for (size_t cluster = 0; cluster < nclusters; cluster++) {
+        if (!allocated(cluster))
+            continue;
+
+        size_t start = cluster * CLUSTER_SIZE;
+        size_t end = start + cluster_length(cluster) - 1;
+        if (!extents.empty() && extents.back().end + 1 == start)
+            extents.back().end = end;
+        else
+            extents.emplace_back(start, end);
+    }
+
+    return true;
+}
+
+} // namespace block
+} // namespace vcml
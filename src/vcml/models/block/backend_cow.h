@@ -0,0 +1,74 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_BLOCK_BACKEND_COW_H
+#define VCML_BLOCK_BACKEND_COW_H
+
+#include "vcml/core/types.h"
+
+#include "vcml/models/block/backend.h"
+
+namespace vcml {
+namespace block {
+
+// overlays a read-only base image with a sparse delta that holds all
+// clusters written so far; clusters that have not been written are read
+// straight from the base. The delta is either kept in memory or stored in
+// a file holding a header, the cluster bitmap and the cluster data at the
+// same offsets as in the base, so that only written clusters take up space
+class backend_cow : public backend
+{
+private:
+    backend* m_base;
+    string m_path;
+    int m_fd;
+    size_t m_pos;
+    size_t m_capacity;
+    size_t m_data_offset;
+    bool m_dirty;
+
+    vector<u64> m_bitmap;
+    unordered_map<size_t, vector<u8>> m_clusters;
+
+    bool allocated(size_t cluster) const;
+    size_t cluster_length(size_t cluster) const;
+
+    void open_delta();
+    void write_header();
+
+    void read_cluster(size_t cluster, size_t off, u8* buffer, size_t size);
+    void write_cluster(size_t cluster, size_t off, const u8* buffer,
+                       size_t size);
+
+public:
+    static constexpr size_t CLUSTER_SIZE = 64 * KiB;
+
+    const char* path() const { return m_path.c_str(); }
+    size_t num_allocated() const;
+
+    backend_cow(const string& base, const string& delta, bool readonly);
+    virtual ~backend_cow();
+
+    virtual size_t capacity() override;
+    virtual size_t pos() override;
+
+    virtual void seek(size_t pos) override;
+    virtual void read(u8* buffer, size_t size) override;
+    virtual void write(const u8* buffer, size_t size) override;
+    virtual void save(ostream& os) override;
+
+    virtual void flush() override;
+    virtual bool delta(vector<range>& extents) override;
+};
+
+} // namespace block
+} // namespace vcml
+
+#endif
@@ -0,0 +1,188 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/block/backend_mmap.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace vcml {
+namespace block {
+
+static size_t iov_size(const vector<iovec>& iov) {
+    size_t size = 0;
+    for (const iovec& vec : iov)
+        size += vec.iov_len;
+    return size;
+}
+
+static size_t page_size() {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+// releases the pages fully covered by the range, returns false if some
+// of them could not be released and still hold their old contents
+bool backend_mmap::unmap(size_t offset, size_t size) {
+#ifdef MADV_REMOVE
+    size_t pgsz = page_size();
+    size_t start = (offset + pgsz - 1) & ~(pgsz - 1);
+    size_t end = (offset + size) & ~(pgsz - 1);
+    if (start >= end)
+        return true;
+
+    return ::madvise(m_data + start, end - start, MADV_REMOVE) == 0;
+#else
+    return false;
+#endif
+}
+
+backend_mmap::backend_mmap(const string& path, bool readonly):
+    backend("mmap", readonly),
+    m_path(path),
+    m_fd(-1),
+    m_data(nullptr),
+    m_pos(0),
+    m_capacity(0) {
+    m_fd = ::open(m_path.c_str(), readonly ? O_RDONLY : O_RDWR);
+    if (m_fd < 0)
+        VCML_REPORT("error opening %s: %s", m_path.c_str(), strerror(errno));
+
+    struct stat info;
+    if (::fstat(m_fd, &info) < 0) {
+        ::close(m_fd);
+        VCML_REPORT("error accessing %s: %s", m_path.c_str(), strerror(errno));
+    }
+
+    m_capacity = info.st_size;
+    if (m_capacity == 0) // empty images cannot be mapped
+        return;
+
+    int prot = readonly ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* ptr = ::mmap(nullptr, m_capacity, prot, MAP_SHARED, m_fd, 0);
+    if (ptr == MAP_FAILED) {
+        ::close(m_fd);
+        VCML_REPORT("error mapping %s: %s", m_path.c_str(), strerror(errno));
+    }
+
+    m_data = (u8*)ptr;
+}
+
+backend_mmap::~backend_mmap() {
+    if (m_data != nullptr)
+        ::munmap(m_data, m_capacity);
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+size_t backend_mmap::capacity() {
+    return m_capacity;
+}
+
+size_t backend_mmap::pos() {
+    return m_pos;
+}
+
+void backend_mmap::seek(size_t pos) {
+    VCML_REPORT_ON(pos > capacity(), "attempt to seek beyond end of buffer");
+    m_pos = pos;
+}
+
+void backend_mmap::read(u8* buffer, size_t size) {
+    read_at(m_pos, buffer, size);
+    m_pos += size;
+}
+
+void backend_mmap::write(const u8* buffer, size_t size) {
+    write_at(m_pos, buffer, size);
+    m_pos += size;
+}
+
+void backend_mmap::read_at(size_t offset, u8* buffer, size_t size) {
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "reading beyond end of file");
+    if (size > 0)
+        memcpy(buffer, m_data + offset, size);
+}
+
+void backend_mmap::write_at(size_t offset, const u8* buffer, size_t size) {
+    VCML_REPORT_ON(m_readonly, "attempt to write read-only image");
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "writing beyond end of file");
+    if (size > 0)
+        memcpy(m_data + offset, buffer, size);
+}
+
+void backend_mmap::readv_at(size_t offset, const vector<iovec>& iov) {
+    size_t size = iov_size(iov);
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "reading beyond end of file");
+    for (const iovec& vec : iov) {
+        if (vec.iov_len > 0)
+            memcpy(vec.iov_base, m_data + offset, vec.iov_len);
+        offset += vec.iov_len;
+    }
+}
+
+void backend_mmap::writev_at(size_t offset, const vector<iovec>& iov) {
+    size_t size = iov_size(iov);
+    VCML_REPORT_ON(m_readonly, "attempt to write read-only image");
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "writing beyond end of file");
+    for (const iovec& vec : iov) {
+        if (vec.iov_len > 0)
+            memcpy(m_data + offset, vec.iov_base, vec.iov_len);
+        offset += vec.iov_len;
+    }
+}
+
+void backend_mmap::save(ostream& os) {
+    os.write((const char*)m_data, m_capacity);
+    VCML_REPORT_ON(!os, "error saving disk: %s", strerror(errno));
+}
+
+void backend_mmap::wzero(size_t size, bool may_unmap) {
+    VCML_REPORT_ON(m_readonly, "attempt to write read-only image");
+    VCML_REPORT_ON(size > remaining(), "writing beyond end of file");
+    if (size == 0)
+        return;
+
+    // removed pages read back as zero, only their edges need clearing
+    if (may_unmap && unmap(m_pos, size)) {
+        size_t pgsz = page_size();
+        size_t start = min((m_pos + pgsz - 1) & ~(pgsz - 1), m_pos + size);
+        size_t end = max((m_pos + size) & ~(pgsz - 1), start);
+        memset(m_data + m_pos, 0, start - m_pos);
+        memset(m_data + end, 0, m_pos + size - end);
+    } else {
+        memset(m_data + m_pos, 0, size);
+    }
+
+    m_pos += size;
+}
+
+void backend_mmap::discard(size_t size) {
+    VCML_REPORT_ON(size > remaining(), "discarding beyond end of file");
+    if (!m_readonly && size > 0)
+        unmap(m_pos, size); // discarding is only a hint, ignore errors
+    m_pos += size;
+}
+
+void backend_mmap::flush() {
+    if (m_data == nullptr || m_readonly)
+        return;
+
+    VCML_REPORT_ON(::msync(m_data, m_capacity, MS_SYNC) < 0,
+                   "error flushing %s: %s", m_path.c_str(), strerror(errno));
+}
+
+} // namespace block
+} // namespace vcml
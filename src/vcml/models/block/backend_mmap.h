@@ -0,0 +1,66 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_BLOCK_BACKEND_MMAP_H
+#define VCML_BLOCK_BACKEND_MMAP_H
+
+#include "vcml/core/types.h"
+
+#include "vcml/models/block/backend.h"
+
+namespace vcml {
+namespace block {
+
+// maps the entire image file into memory and serves all accesses with
+// plain copies from and to that mapping; the host page cache does the
+// rest, so this is best suited for images on fast local storage
+class backend_mmap : public backend
+{
+private:
+    string m_path;
+    int m_fd;
+    u8* m_data;
+    size_t m_pos;
+    size_t m_capacity;
+
+    bool unmap(size_t offset, size_t size);
+
+public:
+    const char* path() const { return m_path.c_str(); }
+    const u8* data() const { return m_data; }
+
+    backend_mmap(const string& path, bool readonly);
+    virtual ~backend_mmap();
+
+    virtual size_t capacity() override;
+    virtual size_t pos() override;
+
+    virtual void seek(size_t pos) override;
+    virtual void read(u8* buffer, size_t size) override;
+    virtual void write(const u8* buffer, size_t size) override;
+    virtual void save(ostream& os) override;
+
+    virtual void wzero(size_t size, bool may_unmap) override;
+    virtual void discard(size_t size) override;
+    virtual void flush() override;
+
+    virtual bool concurrent() const override { return true; }
+    virtual void read_at(size_t offset, u8* buffer, size_t size) override;
+    virtual void write_at(size_t offset, const u8* buffer,
+                          size_t size) override;
+
+    virtual void readv_at(size_t offset, const vector<iovec>& iov) override;
+    virtual void writev_at(size_t offset, const vector<iovec>& iov) override;
+};
+
+} // namespace block
+} // namespace vcml
+
+#endif
@@ -0,0 +1,329 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/block/backend_pio.h"
+#include "vcml/logging/logger.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+
+namespace vcml {
+namespace block {
+
+static size_t align_down(size_t n, size_t a) {
+    return n & ~(a - 1);
+}
+
+static size_t align_up(size_t n, size_t a) {
+    return align_down(n + a - 1, a);
+}
+
+u8* backend_pio::bounce(size_t size) {
+    if (size <= m_bounce_size)
+        return m_bounce;
+
+    free(m_bounce);
+    m_bounce = nullptr;
+    m_bounce_size = 0;
+
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, DIRECT_ALIGN, size) != 0)
+        VCML_REPORT("cannot allocate %zu bytes bounce buffer", size);
+
+    m_bounce = (u8*)ptr;
+    m_bounce_size = size;
+    return m_bounce;
+}
+
+void backend_pio::pread_all(u8* buffer, size_t size, size_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pread(m_fd, buffer, size, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        VCML_REPORT_ON(n < 0, "error reading: %s", strerror(errno));
+        if (n == 0) { // beyond end of file, can only happen with O_DIRECT
+            memset(buffer, 0, size);
+            return;
+        }
+
+        buffer += n;
+        offset += n;
+        size -= n;
+    }
+}
+
+void backend_pio::pwrite_all(const u8* buffer, size_t size, size_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pwrite(m_fd, buffer, size, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        VCML_REPORT_ON(n <= 0, "error writing: %s", strerror(errno));
+
+        buffer += n;
+        offset += n;
+        size -= n;
+    }
+}
+
+static size_t iov_size(const vector<iovec>& iov) {
+    size_t size = 0;
+    for (const iovec& vec : iov)
+        size += vec.iov_len;
+    return size;
+}
+
+static void iov_advance(vector<iovec>& iov, size_t& idx, size_t n) {
+    while (idx < iov.size() && (n > 0 || iov[idx].iov_len == 0)) {
+        size_t k = min(n, iov[idx].iov_len);
+        iov[idx].iov_base = (u8*)iov[idx].iov_base + k;
+        iov[idx].iov_len -= k;
+        n -= k;
+        if (iov[idx].iov_len == 0)
+            idx++;
+    }
+}
+
+void backend_pio::preadv_all(vector<iovec> iov, size_t offset) {
+    size_t idx = 0;
+    iov_advance(iov, idx, 0);
+    while (idx < iov.size()) {
+        int cnt = (int)min<size_t>(iov.size() - idx, IOV_MAX);
+        ssize_t n = ::preadv(m_fd, iov.data() + idx, cnt, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        VCML_REPORT_ON(n < 0, "error reading: %s", strerror(errno));
+        if (n == 0) { // beyond end of file
+            for (; idx < iov.size(); idx++)
+                memset(iov[idx].iov_base, 0, iov[idx].iov_len);
+            return;
+        }
+
+        offset += n;
+        iov_advance(iov, idx, n);
+    }
+}
+
+void backend_pio::pwritev_all(vector<iovec> iov, size_t offset) {
+    size_t idx = 0;
+    iov_advance(iov, idx, 0);
+    while (idx < iov.size()) {
+        int cnt = (int)min<size_t>(iov.size() - idx, IOV_MAX);
+        ssize_t n = ::pwritev(m_fd, iov.data() + idx, cnt, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        VCML_REPORT_ON(n <= 0, "error writing: %s", strerror(errno));
+
+        offset += n;
+        iov_advance(iov, idx, n);
+    }
+}
+
+void backend_pio::read_direct(u8* buffer, size_t size) {
+    size_t start = align_down(m_pos, DIRECT_ALIGN);
+    size_t end = align_up(m_pos + size, DIRECT_ALIGN);
+    u8* buf = bounce(end - start);
+
+    pread_all(buf, end - start, start);
+    memcpy(buffer, buf + m_pos - start, size);
+}
+
+void backend_pio::write_direct(const u8* buffer, size_t size) {
+    size_t start = align_down(m_pos, DIRECT_ALIGN);
+    size_t end = align_up(m_pos + size, DIRECT_ALIGN);
+    u8* buf = bounce(end - start);
+
+    // partial blocks at either end need a read-modify-write cycle
+    if (start != m_pos)
+        pread_all(buf, DIRECT_ALIGN, start);
+    if (end != m_pos + size)
+        pread_all(buf + end - start - DIRECT_ALIGN, DIRECT_ALIGN,
+                  end - DIRECT_ALIGN);
+
+    memcpy(buf + m_pos - start, buffer, size);
+    pwrite_all(buf, end - start, start);
+}
+
+bool backend_pio::punch_hole(size_t size) {
+#ifdef FALLOC_FL_PUNCH_HOLE
+    int mode = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+    return ::fallocate(m_fd, mode, m_pos, size) == 0;
+#else
+    return false;
+#endif
+}
+
+backend_pio::backend_pio(const string& path, bool readonly, bool direct):
+    backend("pio", readonly),
+    m_path(path),
+    m_fd(-1),
+    m_direct(direct),
+    m_pos(0),
+    m_capacity(0),
+    m_bounce(nullptr),
+    m_bounce_size(0) {
+    int flags = readonly ? O_RDONLY : O_RDWR;
+
+#ifdef O_DIRECT
+    if (m_direct) {
+        m_fd = ::open(m_path.c_str(), flags | O_DIRECT);
+        if (m_fd < 0 && errno == EINVAL) {
+            log_warn("%s does not support O_DIRECT", m_path.c_str());
+            m_direct = false;
+        }
+    }
+#else
+    m_direct = false;
+#endif
+
+    if (m_fd < 0)
+        m_fd = ::open(m_path.c_str(), flags);
+    if (m_fd < 0)
+        VCML_REPORT("error opening %s: %s", m_path.c_str(), strerror(errno));
+
+    struct stat info;
+    if (::fstat(m_fd, &info) < 0) {
+        ::close(m_fd);
+        VCML_REPORT("error accessing %s: %s", m_path.c_str(), strerror(errno));
+    }
+
+    m_capacity = info.st_size;
+
+    // unaligned images would be extended by direct writes of their tail
+    if (m_direct && m_capacity % DIRECT_ALIGN) {
+        log_warn("%s size is not a multiple of %zu, disabling O_DIRECT",
+                 m_path.c_str(), DIRECT_ALIGN);
+        ::close(m_fd);
+        m_fd = ::open(m_path.c_str(), flags);
+        m_direct = false;
+        VCML_REPORT_ON(m_fd < 0, "error opening %s: %s", m_path.c_str(),
+                       strerror(errno));
+    }
+
+    if (m_direct)
+        m_type = "pio-direct";
+}
+
+backend_pio::~backend_pio() {
+    if (m_fd >= 0)
+        ::close(m_fd);
+    free(m_bounce);
+}
+
+size_t backend_pio::capacity() {
+    return m_capacity;
+}
+
+size_t backend_pio::pos() {
+    return m_pos;
+}
+
+void backend_pio::seek(size_t pos) {
+    VCML_REPORT_ON(pos > capacity(), "attempt to seek beyond end of buffer");
+    m_pos = pos;
+}
+
+void backend_pio::read(u8* buffer, size_t size) {
+    VCML_REPORT_ON(size > remaining(), "reading beyond end of file");
+    if (m_direct)
+        read_direct(buffer, size);
+    else
+        pread_all(buffer, size, m_pos);
+    m_pos += size;
+}
+
+void backend_pio::write(const u8* buffer, size_t size) {
+    VCML_REPORT_ON(size > remaining(), "writing beyond end of file");
+    if (m_direct)
+        write_direct(buffer, size);
+    else
+        pwrite_all(buffer, size, m_pos);
+    m_pos += size;
+}
+
+void backend_pio::read_at(size_t offset, u8* buffer, size_t size) {
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "reading beyond end of file");
+    if (m_direct) // bounce buffer cannot be shared between threads
+        backend::read_at(offset, buffer, size);
+    else
+        pread_all(buffer, size, offset);
+}
+
+void backend_pio::write_at(size_t offset, const u8* buffer, size_t size) {
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "writing beyond end of file");
+    if (m_direct)
+        backend::write_at(offset, buffer, size);
+    else
+        pwrite_all(buffer, size, offset);
+}
+
+void backend_pio::readv_at(size_t offset, const vector<iovec>& iov) {
+    size_t size = iov_size(iov);
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "reading beyond end of file");
+    if (m_direct)
+        backend::readv_at(offset, iov);
+    else
+        preadv_all(iov, offset);
+}
+
+void backend_pio::writev_at(size_t offset, const vector<iovec>& iov) {
+    size_t size = iov_size(iov);
+    VCML_REPORT_ON(offset > m_capacity || size > m_capacity - offset,
+                   "writing beyond end of file");
+    if (m_direct)
+        backend::writev_at(offset, iov);
+    else
+        pwritev_all(iov, offset);
+}
+
+void backend_pio::save(ostream& os) {
+    vector<u8> buffer(MiB);
+    size_t saved = m_pos;
+    for (size_t off = 0; off < m_capacity; off += buffer.size()) {
+        size_t n = min(buffer.size(), m_capacity - off);
+        m_pos = off;
+        if (m_direct)
+            read_direct(buffer.data(), n);
+        else
+            pread_all(buffer.data(), n, off);
+        os.write((const char*)buffer.data(), n);
+        VCML_REPORT_ON(!os, "error saving disk: %s", strerror(errno));
+    }
+
+    m_pos = saved;
+}
+
+void backend_pio::wzero(size_t size, bool may_unmap) {
+    VCML_REPORT_ON(size > remaining(), "writing beyond end of file");
+    if (may_unmap && punch_hole(size)) {
+        m_pos += size;
+        return;
+    }
+
+    backend::wzero(size, may_unmap);
+}
+
+void backend_pio::discard(size_t size) {
+    VCML_REPORT_ON(size > remaining(), "discarding beyond end of file");
+    punch_hole(size); // discarding is only a hint, ignore errors
+    m_pos += size;
+}
+
+void backend_pio::flush() {
+    VCML_REPORT_ON(::fdatasync(m_fd) < 0, "error flushing %s: %s",
+                   m_path.c_str(), strerror(errno));
+}
+
+} // namespace block
+} // namespace vcml
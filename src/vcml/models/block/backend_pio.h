@@ -0,0 +1,84 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_BLOCK_BACKEND_PIO_H
+#define VCML_BLOCK_BACKEND_PIO_H
+
+#include "vcml/core/types.h"
+
+#include "vcml/models/block/backend.h"
+
+namespace vcml {
+namespace block {
+
+// accesses image files using positional i/o on a plain file descriptor,
+// optionally bypassing the page cache using O_DIRECT; in that case all
+// accesses go through an aligned bounce buffer
+class backend_pio : public backend
+{
+private:
+    string m_path;
+    int m_fd;
+    bool m_direct;
+    size_t m_pos;
+    size_t m_capacity;
+
+    u8* m_bounce;
+    size_t m_bounce_size;
+
+    u8* bounce(size_t size);
+
+    void pread_all(u8* buffer, size_t size, size_t offset);
+    void pwrite_all(const u8* buffer, size_t size, size_t offset);
+
+    void preadv_all(vector<iovec> iov, size_t offset);
+    void pwritev_all(vector<iovec> iov, size_t offset);
+
+    void read_direct(u8* buffer, size_t size);
+    void write_direct(const u8* buffer, size_t size);
+
+    bool punch_hole(size_t size);
+
+public:
+    static constexpr size_t DIRECT_ALIGN = 4096;
+
+    const char* path() const { return m_path.c_str(); }
+    bool direct() const { return m_direct; }
+
+    backend_pio(const string& path, bool readonly, bool direct = false);
+    virtual ~backend_pio();
+
+    virtual size_t capacity() override;
+    virtual size_t pos() override;
+
+    virtual void seek(size_t pos) override;
+    virtual void read(u8* buffer, size_t size) override;
+    virtual void write(const u8* buffer, size_t size) override;
+    virtual void save(ostream& os) override;
+
+    virtual void wzero(size_t size, bool may_unmap) override;
+    virtual void discard(size_t size) override;
+    virtual void flush() override;
+
+    virtual bool concurrent() const override { return !m_direct; }
+    virtual void read_at(size_t offset, u8* buffer, size_t size) override;
+    virtual void write_at(size_t offset, const u8* buffer,
+                          size_t size) override;
+
+    virtual void readv_at(size_t offset, const vector<iovec>& iov) override;
+    virtual void writev_at(size_t offset, const vector<iovec>& iov) override;
+
+    virtual int fd() const override { return m_direct ? -1 : m_fd; }
+};
+
+} // namespace block
+} // namespace vcml
+
+#endif
@@ -13,13 +13,48 @@
 namespace vcml {
 namespace block {
 
+u8* backend_ram::lookup(size_t chunk) const {
+    u8** table = m_tables[chunk >> TABLE_BITS];
+    return table ? table[chunk & (TABLE_SIZE - 1)] : nullptr;
+}
+
+u8* backend_ram::allocate(size_t chunk) {
+    u8**& table = m_tables[chunk >> TABLE_BITS];
+    if (table == nullptr)
+        table = new u8*[TABLE_SIZE]();
+
+    u8*& data = table[chunk & (TABLE_SIZE - 1)];
+    if (data == nullptr)
+        data = new u8[CHUNK_SIZE]();
+
+    return data;
+}
+
+void backend_ram::release(size_t chunk) {
+    u8** table = m_tables[chunk >> TABLE_BITS];
+    if (table == nullptr)
+        return;
+
+    u8*& data = table[chunk & (TABLE_SIZE - 1)];
+    delete[] data;
+    data = nullptr;
+}
+
 backend_ram::backend_ram(size_t cap, bool readonly):
-    backend("ramdisk", readonly), m_pos(), m_cap(cap), m_sectors() {
+    backend("ramdisk", readonly), m_pos(), m_cap(cap), m_tables() {
+    size_t nchunks = (m_cap + CHUNK_SIZE - 1) >> CHUNK_BITS;
+    m_tables.resize((nchunks + TABLE_SIZE - 1) >> TABLE_BITS, nullptr);
 }
 
 backend_ram::~backend_ram() {
-    for (const auto& sector : m_sectors)
-        delete[] sector.second;
+    for (u8** table : m_tables) {
+        if (table == nullptr)
+            continue;
+
+        for (size_t i = 0; i < TABLE_SIZE; i++)
+            delete[] table[i];
+        delete[] table;
+    }
 }
 
 size_t backend_ram::capacity() {
@@ -41,13 +76,13 @@ void backend_ram::read(u8* buffer, size_t size) {
 
     size_t done = 0;
     while (done < size) {
-        size_t off = m_pos % SECTOR_SIZE;
-        size_t num = min(SECTOR_SIZE - off, size - done);
-        auto it = m_sectors.find(m_pos / SECTOR_SIZE);
-        if (it == m_sectors.end())
+        size_t off = m_pos % CHUNK_SIZE;
+        size_t num = min(CHUNK_SIZE - off, size - done);
+        const u8* data = lookup(m_pos >> CHUNK_BITS);
+        if (data == nullptr)
             memset(buffer + done, 0, num);
         else
-            memcpy(buffer + done, it->second + off, num);
+            memcpy(buffer + done, data + off, num);
 
         done += num;
         m_pos += num;
@@ -60,15 +95,13 @@ void backend_ram::write(const u8* buffer, size_t size) {
 
     size_t done = 0;
     while (done < size) {
-        size_t off = m_pos % SECTOR_SIZE;
-        size_t num = min(SECTOR_SIZE - off, size - done);
-        u8*& sector = m_sectors[m_pos / SECTOR_SIZE];
-        if (!sector)
-            sector = new u8[SECTOR_SIZE]();
+        size_t off = m_pos % CHUNK_SIZE;
+        size_t num = min(CHUNK_SIZE - off, size - done);
+        u8* data = allocate(m_pos >> CHUNK_BITS);
+        memcpy(data + off, buffer + done, num);
 
-        memcpy(sector + off, buffer + done, num);
-        m_pos += num;
         done += num;
+        m_pos += num;
     }
 }
 
@@ -78,23 +111,18 @@ void backend_ram::wzero(size_t size, bool may_unmap) {
 
     size_t done = 0;
     while (done < size) {
-        size_t off = m_pos % SECTOR_SIZE;
-        size_t num = min(SECTOR_SIZE - off, size - done);
+        size_t off = m_pos % CHUNK_SIZE;
+        size_t num = min(CHUNK_SIZE - off, size - done);
 
-        if (num == SECTOR_SIZE && may_unmap) {
-            discard(SECTOR_SIZE);
-            done += SECTOR_SIZE;
-            continue;
-        }
-
-        u8*& sector = m_sectors[m_pos / SECTOR_SIZE];
-        if (!sector)
-            sector = new u8[SECTOR_SIZE]();
-        else
-            memset(sector + off, 0, num);
+        // chunks that were never written already read as zero
+        u8* data = lookup(m_pos >> CHUNK_BITS);
+        if (data && num == CHUNK_SIZE && may_unmap)
+            release(m_pos >> CHUNK_BITS);
+        else if (data)
+            memset(data + off, 0, num);
 
-        m_pos += size;
-        done += size;
+        done += num;
+        m_pos += num;
     }
 }
 
@@ -104,25 +132,33 @@ void backend_ram::discard(size_t size) {
 
     size_t done = 0;
     while (done < size) {
-        size_t off = m_pos % SECTOR_SIZE;
-        size_t num = min(SECTOR_SIZE - off, size - done);
-
-        auto it = m_sectors.find(m_pos / SECTOR_SIZE);
-        if (it != m_sectors.end() && num == SECTOR_SIZE) {
-            delete[] it->second;
-            m_sectors.erase(it);
-        }
+        size_t off = m_pos % CHUNK_SIZE;
+        size_t num = min(CHUNK_SIZE - off, size - done);
+        if (num == CHUNK_SIZE) // partial discards are only a hint
+            release(m_pos >> CHUNK_BITS);
 
-        m_pos += size;
-        done += size;
+        done += num;
+        m_pos += num;
     }
 }
 
 void backend_ram::save(ostream& os) {
-    for (const auto& sector : m_sectors) {
-        os.seekp(sector.first * SECTOR_SIZE);
-        os.write((char*)sector.second, SECTOR_SIZE);
+    size_t nchunks = (m_cap + CHUNK_SIZE - 1) >> CHUNK_BITS;
+    bool contiguous = false;
+    for (size_t chunk = 0; chunk < nchunks; chunk++) {
+        const u8* data = lookup(chunk);
+        if (data == nullptr) {
+            contiguous = false;
+            continue;
+        }
+
+        size_t addr = chunk << CHUNK_BITS;
+        if (!contiguous)
+            os.seekp(addr);
+
+        os.write((const char*)data, min<size_t>(CHUNK_SIZE, m_cap - addr));
         VCML_REPORT_ON(!os, "error saving disk: %s", strerror(errno));
+        contiguous = true;
     }
 }
 
@@ -130,5 +166,29 @@ void backend_ram::flush() {
     // nothing to do
 }
 
+bool backend_ram::delta(vector<range>& extents) {
+    size_t nchunks = (m_cap + CHUNK_SIZE - 1) >> CHUNK_BITS;
+    for (size_t chunk = 0; chunk < nchunks; chunk++) {
+        if (lookup(chunk) == nullptr)
+            continue;
+
+        size_t start = chunk << CHUNK_BITS;
+        size_t end = min<size_t>(start + CHUNK_SIZE, m_cap) - 1;
+        if (!extents.empty() && extents.back().end + 1 == start)
+            extents.back().end = end;
+        else
+            extents.emplace_back(start, end);
+    }
+
+    return true;
+}
+
+size_t backend_ram::num_chunks() const {
+    size_t n = 0;
+    for (size_t chunk = 0; chunk < m_tables.size() * TABLE_SIZE; chunk++)
+        n += lookup(chunk) ? 1 : 0;
+    return n;
+}
+
 } // namespace block
 } // namespace vcml
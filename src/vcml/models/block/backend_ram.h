@@ -18,18 +18,25 @@
 namespace vcml {
 namespace block {
 
+// keeps disk contents in chunks that are allocated on first write and
+// looked up through a two-level radix table indexed by chunk number
 class backend_ram : public backend
 {
 protected:
     enum : size_t {
-        SECTOR_SIZE = 512,
+        CHUNK_BITS = 16,
+        CHUNK_SIZE = 1ull << CHUNK_BITS,
+        TABLE_BITS = 9,
+        TABLE_SIZE = 1ull << TABLE_BITS,
     };
 
     size_t m_pos;
     size_t m_cap;
-    std::map<u64, u8*> m_sectors;
+    vector<u8**> m_tables;
 
-    u8* get_page(u64 addr);
+    u8* lookup(size_t chunk) const;
+    u8* allocate(size_t chunk);
+    void release(size_t chunk);
 
 public:
     backend_ram(size_t cap, bool readonly);
@@ -45,6 +52,9 @@ public:
     virtual void discard(size_t size) override;
     virtual void save(ostream& os) override;
     virtual void flush() override;
+    virtual bool delta(vector<range>& extents) override;
+
+    size_t num_chunks() const;
 };
 
 } // namespace block
@@ -9,17 +9,100 @@
  ******************************************************************************/
 
 #include "vcml/models/block/disk.h"
+#include "vcml/models/block/io_engine.h"
+#include "vcml/models/block/backend_cache.h"
+#include "vcml/core/checkpoint.h"
+
+#include <chrono>
 
 namespace vcml {
 namespace block {
 
+struct disk_timing {
+    const char* name;
+    u64 read_ns;  // fixed cost per read request
+    u64 write_ns; // fixed cost per write request
+    u64 flush_ns; // cost of a flush
+    u64 seek_ns;  // extra cost of non-sequential accesses
+    double read_bw;
+    double write_bw;
+};
+
+static const disk_timing TIMINGS[] = {
+    { "ssd", 60000, 20000, 200000, 0, 2500.0 * MiB, 1500.0 * MiB },
+    { "emmc", 150000, 300000, 3000000, 0, 300.0 * MiB, 100.0 * MiB },
+    { "hdd", 100000, 100000, 10000000, 8000000, 180.0 * MiB, 180.0 * MiB },
+};
+
+static const disk_timing* find_timing(const string& name) {
+    for (const disk_timing& t : TIMINGS)
+        if (name == t.name)
+            return &t;
+    return nullptr;
+}
+
+static u64 host_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+void disk::counter::update_max(size_t v) {
+    size_t curr = get();
+    while (curr < v && !m_val.compare_exchange_weak(curr, v,
+                                                    std::memory_order_relaxed))
+        continue;
+}
+
+void disk::latency_hist::record(u64 ns) {
+    if (ns < 10000)
+        buckets[LAT_10US]++;
+    else if (ns < 100000)
+        buckets[LAT_100US]++;
+    else if (ns < 1000000)
+        buckets[LAT_1MS]++;
+    else if (ns < 10000000)
+        buckets[LAT_10MS]++;
+    else if (ns < 100000000)
+        buckets[LAT_100MS]++;
+    else
+        buckets[LAT_MORE]++;
+
+    count++;
+    total_ns += ns;
+    max_ns.update_max(ns);
+}
+
+u64 disk::latency_hist::avg_ns() const {
+    size_t n = count;
+    return n ? total_ns / n : 0;
+}
+
+static void print_latency(ostream& os, const char* op,
+                          const disk::latency_hist& hist) {
+    static const char* const names[disk::NUM_LAT_BUCKETS] = {
+        "<10us", "<100us", "<1ms", "<10ms", "<100ms", ">=100ms",
+    };
+
+    os << op << " latency     avg " << hist.avg_ns() << "ns, max "
+       << hist.max_ns << "ns" << std::endl;
+    for (size_t i = 0; i < disk::NUM_LAT_BUCKETS; i++) {
+        if (hist.buckets[i] > 0)
+            os << "  " << names[i] << ": " << hist.buckets[i] << std::endl;
+    }
+}
+
 bool disk::cmd_show_stats(const vector<string>& args, ostream& os) {
+    if (m_cache) {
+        lock_guard<mutex> guard(m_backend_mtx);
+        update_cache_stats();
+    }
+
     os << "bytes read       " << stats.num_bytes_read << std::endl;
     os << "bytes written    " << stats.num_bytes_written << std::endl;
     os << "seek requests    " << stats.num_seek_req << std::endl;
     os << "read requests    " << stats.num_read_req << std::endl;
     os << "write requests   " << stats.num_write_req << std::endl;
-    os << "flush requests   " << stats.num_write_req << std::endl;
+    os << "flush requests   " << stats.num_flush_req << std::endl;
     os << "discard requests " << stats.num_discard_req << std::endl;
     os << "total requests   " << stats.num_req << std::endl;
     os << "seek errors      " << stats.num_seek_err << std::endl;
@@ -28,6 +111,19 @@ bool disk::cmd_show_stats(const vector<string>& args, ostream& os) {
     os << "flush errors     " << stats.num_flush_err << std::endl;
     os << "discard errors   " << stats.num_discard_err << std::endl;
     os << "total errors     " << stats.num_err << std::endl;
+    if (m_cache) {
+        os << "cache hits       " << stats.num_cache_hits << std::endl;
+        os << "cache misses     " << stats.num_cache_misses << std::endl;
+        os << "cache readahead  " << stats.num_cache_readahead << std::endl;
+        os << "cache evictions  " << stats.num_cache_evictions << std::endl;
+    }
+
+    print_latency(os, "read ", stats.read_latency);
+    print_latency(os, "write", stats.write_latency);
+    print_latency(os, "flush", stats.flush_latency);
+
+    if (m_timing)
+        os << "busy until       " << m_busy_until << std::endl;
     return true;
 }
 
@@ -40,6 +136,7 @@ bool disk::cmd_save_image(const vector<string>& args, ostream& os) {
     }
 
     try {
+        lock_guard<mutex> guard(m_backend_mtx);
         m_backend->save(stream);
         return true;
     } catch (std::exception& ex) {
@@ -53,22 +150,289 @@ static string default_serial() {
     return mkstr("vcml-disk-%zu", n++);
 }
 
+sc_time disk::schedule(int op, size_t offset, size_t size) {
+    // positional accesses may come from other threads, but only without
+    // timing, since the device model itself is not thread-safe
+    if (m_timing == nullptr)
+        return SC_ZERO_TIME;
+
+    sc_time now = sc_time_stamp();
+
+    u64 ns = 0;
+    double bw = 0.0;
+    switch (op) {
+    case IO_READ:
+        ns = m_timing->read_ns;
+        bw = m_timing->read_bw;
+        break;
+    case IO_WRITE:
+        ns = m_timing->write_ns;
+        bw = m_timing->write_bw;
+        break;
+    default:
+        ns = m_timing->flush_ns;
+        break;
+    }
+
+    if (op != IO_FLUSH) {
+        if (offset != m_next_offset)
+            ns += m_timing->seek_ns;
+        if (bw > 0.0)
+            ns += (u64)(size * 1e9 / bw);
+        m_next_offset = offset + size;
+    }
+
+    // the device serves one request at a time
+    m_busy_until = max(m_busy_until, now) + sc_time((double)ns, SC_NS);
+    return m_busy_until;
+}
+
+void disk::submit(io_request* req) {
+    req->start_ns = host_ns();
+
+    size_t cap = capacity();
+    bool rw = req->op != IO_FLUSH;
+    if (!m_backend || (rw && (req->offset > cap ||
+                              req->size > cap - req->offset))) {
+        req->success = false;
+        finish(req);
+        return;
+    }
+
+    req->due = schedule(req->op, req->offset, req->size);
+
+    if (io_threads == 0u) {
+        execute(req);
+        finish(req);
+        return;
+    }
+
+    if (m_engine == nullptr) {
+        m_engine = io_engine::create(
+            m_backend, io_threads, io_depth,
+            [&](io_request* r) -> void { execute(r); },
+            [&](io_request* r) -> void { complete(r); });
+        log_debug("using %s for asynchronous i/o", m_engine->type());
+    }
+
+    m_inflight++;
+    m_engine->submit(req);
+}
+
+void disk::execute(io_request* req) {
+    std::unique_lock<mutex> lock(m_backend_mtx, std::defer_lock);
+    if (!m_backend->concurrent())
+        lock.lock();
+
+    try {
+        switch (req->op) {
+        case IO_READ:
+            if (!req->iov.empty())
+                m_backend->readv_at(req->offset, req->iov);
+            else
+                m_backend->read_at(req->offset, req->buffer, req->size);
+            break;
+        case IO_WRITE:
+            if (m_backend->readonly())
+                break;
+            if (!req->iov.empty())
+                m_backend->writev_at(req->offset, req->iov);
+            else
+                m_backend->write_at(req->offset, req->buffer, req->size);
+            break;
+        case IO_FLUSH:
+            m_backend->flush();
+            break;
+        }
+
+        req->success = true;
+    } catch (std::exception& ex) {
+        log.warn(ex);
+        req->success = false;
+    }
+}
+
+void disk::complete(io_request* req) {
+    bool first = false;
+
+    {
+        lock_guard<mutex> guard(m_done_mtx);
+        first = m_done.empty();
+        m_done.push_back(req);
+    }
+
+    if (first)
+        on_next_update([&]() -> void { m_done_ev.notify(SC_ZERO_TIME); });
+}
+
+void disk::finish(io_request* req) {
+    u64 latency = host_ns() - req->start_ns;
+
+    switch (req->op) {
+    case IO_READ:
+        stats.read_latency.record(latency);
+        stats.num_read_req++;
+        if (req->success)
+            stats.num_bytes_read += req->size;
+        else
+            stats.num_read_err++;
+        break;
+
+    case IO_WRITE:
+        stats.write_latency.record(latency);
+        stats.num_write_req++;
+        if (req->success && !readonly)
+            stats.num_bytes_written += req->size;
+        if (!req->success)
+            stats.num_write_err++;
+        break;
+
+    case IO_FLUSH:
+        stats.flush_latency.record(latency);
+        stats.num_flush_req++;
+        if (!req->success)
+            stats.num_flush_err++;
+        break;
+    }
+
+    stats.num_req++;
+    if (!req->success)
+        stats.num_err++;
+
+    if (m_cache) {
+        lock_guard<mutex> guard(m_backend_mtx);
+        update_cache_stats();
+    }
+
+    // hold back the completion until the modeled device is done with it
+    sc_time now = sc_time_stamp();
+    if (req->due > now) {
+        m_inflight++;
+        m_timed.emplace(req->due, req);
+        m_timed_ev.notify(req->due - now);
+        return;
+    }
+
+    deliver(req);
+}
+
+void disk::deliver(io_request* req) {
+    std::unique_ptr<io_request> guard(req);
+    if (req->done)
+        req->done(req->success);
+}
+
+void disk::update_cache_stats() {
+    if (m_cache == nullptr)
+        return;
+
+    // caller must hold m_backend_mtx
+    const backend_cache::cache_stats& cs = m_cache->stats();
+    stats.num_cache_hits = cs.num_hits;
+    stats.num_cache_misses = cs.num_misses;
+    stats.num_cache_readahead = cs.num_readahead;
+    stats.num_cache_evictions = cs.num_evictions;
+}
+
+void disk::completion_thread() {
+    vector<io_request*> done;
+    while (true) {
+        {
+            lock_guard<mutex> guard(m_done_mtx);
+            done.swap(m_done);
+        }
+
+        // callbacks may wait, so check again for requests that completed
+        // in the meantime before going to sleep
+        if (done.empty()) {
+            wait(m_done_ev);
+            continue;
+        }
+
+        for (io_request* req : done) {
+            m_inflight--;
+            finish(req);
+        }
+
+        done.clear();
+    }
+}
+
+void disk::timing_thread() {
+    while (true) {
+        if (m_timed.empty()) {
+            wait(m_timed_ev);
+            continue;
+        }
+
+        auto it = m_timed.begin();
+        sc_time now = sc_time_stamp();
+        if (it->first > now) {
+            wait(it->first - now, m_timed_ev);
+            continue;
+        }
+
+        io_request* req = it->second;
+        m_timed.erase(it);
+        m_inflight--;
+        deliver(req);
+    }
+}
+
 disk::disk(const sc_module_name& nm, const string& img, bool ro):
     module(nm),
     m_backend(nullptr),
+    m_cache(nullptr),
+    m_engine(nullptr),
+    m_timing(nullptr),
+    m_busy_until(SC_ZERO_TIME),
+    m_next_offset(0),
+    m_timed(),
+    m_timed_ev("timed_ev"),
+    m_backend_mtx(),
+    m_done_mtx(),
+    m_done(),
+    m_done_ev("done_ev"),
+    m_inflight(0),
     stats(),
     image("image", img),
     serial("serial", default_serial()),
-    readonly("readonly", ro) {
+    readonly("readonly", ro),
+    io_threads("io_threads", 4),
+    io_depth("io_depth", 64),
+    cache_size("cache_size", 0),
+    cache_readahead("cache_readahead", 128 * KiB),
+    timing("timing", "none") {
+    SC_HAS_PROCESS(disk);
+    SC_THREAD(completion_thread);
+    SC_THREAD(timing_thread);
+
+    if (timing.get() != "none" && !timing.get().empty()) {
+        m_timing = find_timing(to_lower(timing));
+        if (m_timing == nullptr)
+            log_warn("unknown timing profile: %s", timing.get().c_str());
+    }
+
     try {
         m_backend = backend::create(image, readonly);
         readonly = !m_backend || m_backend->readonly();
     } catch (std::exception& ex) {
         log_warn("%s", ex.what());
     }
+
+    if (m_backend && cache_size > 0u) {
+        m_cache = new backend_cache(m_backend, cache_size, cache_readahead);
+        m_backend = m_cache;
+    }
 }
 
 disk::~disk() {
+    if (m_engine)
+        delete m_engine;
+    for (io_request* req : m_done)
+        delete req;
+    for (auto& it : m_timed)
+        delete it.second;
     if (m_backend)
         delete m_backend;
 }
@@ -78,10 +442,12 @@ size_t disk::capacity() {
 }
 
 size_t disk::pos() {
+    lock_guard<mutex> guard(m_backend_mtx);
     return m_backend ? m_backend->pos() : 0;
 }
 
 size_t disk::remaining() {
+    lock_guard<mutex> guard(m_backend_mtx);
     return m_backend ? m_backend->remaining() : 0;
 }
 
@@ -91,6 +457,7 @@ bool disk::seek(size_t pos) {
 
     if (m_backend) {
         try {
+            lock_guard<mutex> guard(m_backend_mtx);
             m_backend->seek(pos);
             return true;
         } catch (std::exception& ex) {
@@ -109,8 +476,14 @@ bool disk::read(u8* buffer, size_t size) {
 
     if (m_backend) {
         try {
+            lock_guard<mutex> guard(m_backend_mtx);
+            u64 start = host_ns();
+            size_t offset = m_backend->pos();
             m_backend->read(buffer, size);
+            stats.read_latency.record(host_ns() - start);
+            schedule(IO_READ, offset, size);
             stats.num_bytes_read += size;
+            update_cache_stats();
             return true;
         } catch (std::exception& ex) {
             log.warn(ex);
@@ -128,10 +501,77 @@ bool disk::write(const u8* buffer, size_t size) {
 
     if (m_backend) {
         try {
+            lock_guard<mutex> guard(m_backend_mtx);
             if (!m_backend->readonly()) {
+                u64 start = host_ns();
+                size_t offset = m_backend->pos();
                 m_backend->write(buffer, size);
+                stats.write_latency.record(host_ns() - start);
+                schedule(IO_WRITE, offset, size);
+                stats.num_bytes_written += size;
+            }
+            update_cache_stats();
+            return true;
+        } catch (std::exception& ex) {
+            log.warn(ex);
+        }
+    }
+
+    stats.num_write_err++;
+    stats.num_err++;
+    return false;
+}
+
+bool disk::read_at(size_t offset, u8* buffer, size_t size) {
+    stats.num_read_req++;
+    stats.num_req++;
+
+    size_t cap = capacity();
+    if (m_backend && offset <= cap && size <= cap - offset) {
+        try {
+            std::unique_lock<mutex> lock(m_backend_mtx, std::defer_lock);
+            if (!m_backend->concurrent())
+                lock.lock();
+
+            u64 start = host_ns();
+            m_backend->read_at(offset, buffer, size);
+            stats.read_latency.record(host_ns() - start);
+            stats.num_bytes_read += size;
+            schedule(IO_READ, offset, size);
+            if (lock.owns_lock())
+                update_cache_stats();
+            return true;
+        } catch (std::exception& ex) {
+            log.warn(ex);
+        }
+    }
+
+    stats.num_read_err++;
+    stats.num_err++;
+    return false;
+}
+
+bool disk::write_at(size_t offset, const u8* buffer, size_t size) {
+    stats.num_write_req++;
+    stats.num_req++;
+
+    size_t cap = capacity();
+    if (m_backend && offset <= cap && size <= cap - offset) {
+        try {
+            std::unique_lock<mutex> lock(m_backend_mtx, std::defer_lock);
+            if (!m_backend->concurrent())
+                lock.lock();
+
+            if (!m_backend->readonly()) {
+                u64 start = host_ns();
+                m_backend->write_at(offset, buffer, size);
+                stats.write_latency.record(host_ns() - start);
                 stats.num_bytes_written += size;
+                schedule(IO_WRITE, offset, size);
             }
+
+            if (lock.owns_lock())
+                update_cache_stats();
             return true;
         } catch (std::exception& ex) {
             log.warn(ex);
@@ -149,10 +589,16 @@ bool disk::wzero(size_t size, bool may_unmap) {
 
     if (m_backend) {
         try {
+            lock_guard<mutex> guard(m_backend_mtx);
             if (!m_backend->readonly()) {
+                u64 start = host_ns();
+                size_t offset = m_backend->pos();
                 m_backend->wzero(size, may_unmap);
+                stats.write_latency.record(host_ns() - start);
+                schedule(IO_WRITE, offset, size);
                 stats.num_bytes_written += size;
             }
+            update_cache_stats();
             return true;
         } catch (std::exception& ex) {
             log.warn(ex);
@@ -170,7 +616,9 @@ bool disk::discard(size_t size) {
 
     if (m_backend) {
         try {
+            lock_guard<mutex> guard(m_backend_mtx);
             m_backend->discard(size);
+            update_cache_stats();
             return true;
         } catch (std::exception& ex) {
             log.warn(ex);
@@ -188,7 +636,12 @@ bool disk::flush() {
 
     if (m_backend) {
         try {
+            lock_guard<mutex> guard(m_backend_mtx);
+            u64 start = host_ns();
             m_backend->flush();
+            stats.flush_latency.record(host_ns() - start);
+            schedule(IO_FLUSH, 0, 0);
+            update_cache_stats();
             return true;
         } catch (std::exception& ex) {
             log.warn(ex);
@@ -200,5 +653,91 @@ bool disk::flush() {
     return false;
 }
 
+void disk::save_state(checkpoint& cp) {
+    module::save_state(cp);
+    if (!m_backend || m_backend->readonly())
+        return;
+
+    if (m_inflight > 0)
+        log_warn("checkpoint taken with %zu requests in flight", m_inflight);
+
+    lock_guard<mutex> guard(m_backend_mtx);
+    vector<range> extents;
+    if (!m_backend->delta(extents)) {
+        log_debug("%s image not part of checkpoint", m_backend->type());
+        return;
+    }
+
+    // an empty record marks the disk even if nothing has been written yet
+    cp.save(name(), nullptr, 0);
+
+    vector<u8> buffer;
+    const u64 maxlen = checkpoint::MAX_EXTENT;
+    for (const range& extent : extents) {
+        for (u64 off = extent.start; off <= extent.end;) {
+            size_t len = min<u64>(maxlen, extent.end - off + 1);
+            buffer.resize(len);
+            m_backend->read_at(off, buffer.data(), len);
+            cp.save(name(), buffer.data(), len, off);
+            off += len;
+        }
+    }
+}
+
+void disk::load_state(checkpoint& cp) {
+    module::load_state(cp);
+    if (!m_backend || m_backend->readonly() || !cp.has(name()))
+        return;
+
+    lock_guard<mutex> guard(m_backend_mtx);
+    vector<range> extents;
+    // incremental checkpoints are restored on top of their parent
+    if (!cp.is_incremental() && m_backend->delta(extents) &&
+        !extents.empty()) {
+        log_warn("image was written before restoring the checkpoint");
+    }
+
+    cp.load_all(name(), [&](u64 off, const u8* data, size_t len) -> void {
+        if (len > 0)
+            m_backend->write_at(off, data, len);
+    });
+}
+
+void disk::read_async(size_t offset, u8* buffer, size_t size,
+                      function<void(bool)> done) {
+    submit(new io_request{ IO_READ, offset, buffer, size, false,
+                           std::move(done), {} });
+}
+
+void disk::write_async(size_t offset, const u8* buffer, size_t size,
+                       function<void(bool)> done) {
+    submit(new io_request{ IO_WRITE, offset, const_cast<u8*>(buffer), size,
+                           false, std::move(done), {} });
+}
+
+static size_t iov_size(const vector<iovec>& iov) {
+    size_t size = 0;
+    for (const iovec& vec : iov)
+        size += vec.iov_len;
+    return size;
+}
+
+void disk::readv_async(size_t offset, const vector<iovec>& iov,
+                       function<void(bool)> done) {
+    submit(new io_request{ IO_READ, offset, nullptr, iov_size(iov), false,
+                           std::move(done), iov });
+}
+
+void disk::writev_async(size_t offset, const vector<iovec>& iov,
+                        function<void(bool)> done) {
+    submit(new io_request{ IO_WRITE, offset, nullptr, iov_size(iov), false,
+                           std::move(done), iov });
+}
+
+void disk::flush_async(function<void(bool)> done) {
+    submit(new io_request{ IO_FLUSH, 0, nullptr, 0, false, std::move(done),
+                           {} });
+}
+
 } // namespace block
 } // namespace vcml
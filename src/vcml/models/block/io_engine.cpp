@@ -0,0 +1,225 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/block/io_engine.h"
+#include "vcml/logging/logger.h"
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+namespace vcml {
+namespace block {
+
+io_engine::io_engine(const string& type, const handler& exec,
+                     const handler& done):
+    m_type(type), m_execute(exec), m_complete(done) {
+    // nothing to do
+}
+
+class io_engine_threads : public io_engine
+{
+private:
+    bool m_running;
+    mutex m_mtx;
+    condition_variable m_cv;
+    deque<io_request*> m_queue;
+    vector<thread> m_workers;
+
+    void work(size_t id) {
+        mwr::set_thread_name(mkstr("vcml_io_%zu", id));
+        while (true) {
+            io_request* req = nullptr;
+
+            {
+                std::unique_lock<mutex> lock(m_mtx);
+                m_cv.wait(lock, [&] { return !m_running || m_queue.size(); });
+                if (m_queue.empty())
+                    return;
+
+                req = m_queue.front();
+                m_queue.pop_front();
+            }
+
+            m_execute(req);
+            m_complete(req);
+        }
+    }
+
+public:
+    io_engine_threads(size_t nthreads, const handler& exec,
+                      const handler& done):
+        io_engine("threads", exec, done),
+        m_running(true),
+        m_mtx(),
+        m_cv(),
+        m_queue(),
+        m_workers() {
+        for (size_t i = 0; i < max<size_t>(nthreads, 1); i++)
+            m_workers.emplace_back(&io_engine_threads::work, this, i);
+    }
+
+    virtual ~io_engine_threads() {
+        {
+            lock_guard<mutex> guard(m_mtx);
+            m_running = false;
+        }
+
+        m_cv.notify_all();
+        for (thread& worker : m_workers)
+            worker.join();
+    }
+
+    virtual void submit(io_request* req) override {
+        {
+            lock_guard<mutex> guard(m_mtx);
+            m_queue.push_back(req);
+        }
+
+        m_cv.notify_one();
+    }
+};
+
+#ifdef HAVE_LIBURING
+class io_engine_uring : public io_engine
+{
+private:
+    int m_fd;
+    size_t m_depth;
+    size_t m_inflight;
+    mutex m_mtx;
+    condition_variable m_cv;
+    struct io_uring m_ring;
+    thread m_reaper;
+
+    void prepare(io_request* req) {
+        io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+        VCML_ERROR_ON(!sqe, "io_uring submission queue full");
+
+        switch (req ? req->op : IO_FLUSH) {
+        case IO_READ:
+            if (!req->iov.empty())
+                io_uring_prep_readv(sqe, m_fd, req->iov.data(),
+                                    req->iov.size(), req->offset);
+            else
+                io_uring_prep_read(sqe, m_fd, req->buffer, req->size,
+                                   req->offset);
+            break;
+        case IO_WRITE:
+            if (!req->iov.empty())
+                io_uring_prep_writev(sqe, m_fd, req->iov.data(),
+                                     req->iov.size(), req->offset);
+            else
+                io_uring_prep_write(sqe, m_fd, req->buffer, req->size,
+                                    req->offset);
+            break;
+        case IO_FLUSH:
+            if (req)
+                io_uring_prep_fsync(sqe, m_fd, IORING_FSYNC_DATASYNC);
+            else
+                io_uring_prep_nop(sqe);
+            break;
+        }
+
+        io_uring_sqe_set_data(sqe, req);
+        io_uring_submit(&m_ring);
+    }
+
+    void reap() {
+        mwr::set_thread_name("vcml_io_uring");
+        while (true) {
+            io_uring_cqe* cqe = nullptr;
+            int err = io_uring_wait_cqe(&m_ring, &cqe);
+            if (err == -EINTR)
+                continue;
+
+            VCML_ERROR_ON(err < 0, "io_uring: %s", strerror(-err));
+
+            io_request* req = (io_request*)io_uring_cqe_get_data(cqe);
+            int res = cqe->res;
+            io_uring_cqe_seen(&m_ring, cqe);
+
+            if (req == nullptr) // shutdown marker
+                return;
+
+            // short transfers are rare, just redo those synchronously
+            if (req->op != IO_FLUSH && res >= 0 && (size_t)res != req->size)
+                m_execute(req);
+            else
+                req->success = res >= 0;
+
+            m_complete(req);
+
+            {
+                lock_guard<mutex> guard(m_mtx);
+                m_inflight--;
+            }
+
+            m_cv.notify_all();
+        }
+    }
+
+public:
+    io_engine_uring(int fd, size_t depth, const handler& exec,
+                    const handler& done):
+        io_engine("io_uring", exec, done),
+        m_fd(fd),
+        m_depth(max<size_t>(depth, 1)),
+        m_inflight(0),
+        m_mtx(),
+        m_cv(),
+        m_ring(),
+        m_reaper() {
+        int err = io_uring_queue_init(m_depth + 1, &m_ring, 0);
+        VCML_REPORT_ON(err < 0, "io_uring: %s", strerror(-err));
+        m_reaper = thread(&io_engine_uring::reap, this);
+    }
+
+    virtual ~io_engine_uring() {
+        {
+            std::unique_lock<mutex> lock(m_mtx);
+            m_cv.wait(lock, [&] { return m_inflight == 0; });
+            prepare(nullptr);
+        }
+
+        m_reaper.join();
+        io_uring_queue_exit(&m_ring);
+    }
+
+    virtual void submit(io_request* req) override {
+        std::unique_lock<mutex> lock(m_mtx);
+        m_cv.wait(lock, [&] { return m_inflight < m_depth; });
+        m_inflight++;
+        prepare(req);
+    }
+};
+#endif
+
+io_engine* io_engine::create(backend* be, size_t nthreads, size_t depth,
+                             const handler& exec, const handler& done) {
+#ifdef HAVE_LIBURING
+    if (be->fd() >= 0) {
+        try {
+            return new io_engine_uring(be->fd(), depth, exec, done);
+        } catch (std::exception& ex) {
+            log_debug("falling back to i/o threads: %s", ex.what());
+        }
+    }
+#endif
+
+    // backends that seek internally can only serve one request at a time
+    if (!be->concurrent())
+        nthreads = 1;
+
+    return new io_engine_threads(nthreads, exec, done);
+}
+
+} // namespace block
+} // namespace vcml
@@ -0,0 +1,72 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_BLOCK_IO_ENGINE_H
+#define VCML_BLOCK_IO_ENGINE_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+#include "vcml/models/block/backend.h"
+
+namespace vcml {
+namespace block {
+
+enum io_op {
+    IO_READ,
+    IO_WRITE,
+    IO_FLUSH,
+};
+
+struct io_request {
+    io_op op;
+    size_t offset;
+    u8* buffer;
+    size_t size;
+    bool success;
+    function<void(bool)> done;
+    vector<iovec> iov; // used instead of buffer if not empty
+    u64 start_ns;      // host time of submission
+    sc_time due;       // simulated completion time of the timing model
+};
+
+// executes block requests outside of the systemc thread; finished requests
+// are handed to the completion callback from within the engine threads
+class io_engine
+{
+public:
+    typedef function<void(io_request*)> handler;
+
+protected:
+    string m_type;
+    handler m_execute;
+    handler m_complete;
+
+public:
+    const char* type() const { return m_type.c_str(); }
+
+    io_engine(const string& type, const handler& exec, const handler& done);
+    virtual ~io_engine() = default;
+
+    io_engine() = delete;
+    io_engine(const io_engine&) = delete;
+
+    virtual void submit(io_request* req) = 0;
+
+    // uses io_uring if supported by host and backend, otherwise falls back
+    // to a pool of threads that call exec for each request; destroying the
+    // engine waits for all requests still in flight
+    static io_engine* create(backend* be, size_t nthreads, size_t depth,
+                             const handler& exec, const handler& done);
+};
+
+} // namespace block
+} // namespace vcml
+
+#endif
@@ -11,6 +11,7 @@
 #include "vcml/models/can/bridge.h"
 #include "vcml/models/can/backend.h"
 #include "vcml/models/can/backend_file.h"
+#include "vcml/models/can/backend_shm.h"
 #include "vcml/models/can/backend_socket.h"
 
 namespace vcml {
@@ -25,15 +26,29 @@ backend::~backend() {
         m_parent->detach(this);
 }
 
+void backend::send_batch_to_host(const vector<can_frame>& frames) {
+    for (const can_frame& frame : frames)
+        send_to_host(frame);
+}
+
 void backend::send_to_guest(can_frame frame) {
     m_parent->send_to_guest(frame);
 }
 
+void backend::send_batch_to_guest(const can_frame* frames, size_t count) {
+    m_parent->send_to_guest(frames, count);
+}
+
+void backend::send_to_guest(can_frame frame, const sc_time& delivery) {
+    m_parent->send_to_guest(frame, delivery);
+}
+
 backend* backend::create(bridge* br, const string& type) {
     string kind = type.substr(0, type.find(':'));
     typedef function<backend*(bridge*, const string&)> construct;
     static const unordered_map<string, construct> backends = {
         { "file", backend_file::create },
+        { "shm", backend_shm::create },
         { "socket", backend_socket::create },
     };
 
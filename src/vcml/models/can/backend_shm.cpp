@@ -0,0 +1,332 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/can/backend_shm.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <climits>
+
+namespace vcml {
+namespace can {
+
+enum : size_t {
+    SHM_MAX_NODES = 8,
+    SHM_RING_SLOTS = 512,
+};
+
+static const u64 SHM_NO_TIME = ~0ull; // node does not take part in lock-step
+
+struct shm_slot {
+    u64 stamp; // simulation time of the sender in ns
+    can_frame frame;
+};
+
+struct shm_ring {
+    alignas(64) atomic<u64> head; // number of frames ever published
+    alignas(64) atomic<u64> now;  // simulation time of the owner in ns
+    atomic<u32> pid;
+    shm_slot slots[SHM_RING_SLOTS];
+};
+
+// zero-filled memory is a valid idle bus, so a freshly truncated shared
+// memory object needs no further initialization by whoever comes first
+struct shm_bus {
+    alignas(64) atomic<u32> users;   // bit n is set while node n is attached
+    alignas(64) atomic<u32> frames;  // bumped whenever frames get published
+    atomic<u32> readers;             // readers sleeping on frames
+    alignas(64) atomic<u32> clock;   // bumped whenever a node advances
+    atomic<u32> waiters;             // nodes sleeping on clock
+    shm_ring rings[SHM_MAX_NODES];
+};
+
+static_assert(atomic<u32>::is_always_lock_free, "shm bus needs lock-free");
+static_assert(atomic<u64>::is_always_lock_free, "shm bus needs lock-free");
+static_assert(sizeof(atomic<u32>) == sizeof(u32), "unexpected atomic size");
+
+static void futex_wait(atomic<u32>& addr, u32 val, u64 timeout_ns) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ns / 1000000000;
+    ts.tv_nsec = timeout_ns % 1000000000;
+    // deliberately not FUTEX_PRIVATE, the other nodes are other processes
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAIT, val, &ts, nullptr, 0);
+}
+
+static void futex_wake_all(atomic<u32>& addr) {
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void backend_shm::open_bus() {
+    string path = "/vcml-can-" + m_name;
+    m_fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    VCML_REPORT_ON(m_fd < 0, "cannot open %s: %s", path.c_str(),
+                   strerror(errno));
+
+    struct stat info;
+    if (fstat(m_fd, &info) < 0)
+        VCML_REPORT("cannot access %s: %s", path.c_str(), strerror(errno));
+
+    if (info.st_size == 0 && ftruncate(m_fd, sizeof(shm_bus)) < 0)
+        VCML_REPORT("cannot resize %s: %s", path.c_str(), strerror(errno));
+    else if (info.st_size != 0 && (size_t)info.st_size != sizeof(shm_bus))
+        VCML_REPORT("%s is not a compatible bus", path.c_str());
+
+    void* mem = mmap(nullptr, sizeof(shm_bus), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, m_fd, 0);
+    VCML_REPORT_ON(mem == MAP_FAILED, "cannot map %s: %s", path.c_str(),
+                   strerror(errno));
+
+    m_bus = (shm_bus*)mem;
+
+    u32 users = m_bus->users.load();
+    do {
+        for (m_node = 0; m_node < SHM_MAX_NODES; m_node++)
+            if (!(users & (u32)bit(m_node)))
+                break;
+        if (m_node == SHM_MAX_NODES) {
+            m_bus = nullptr;
+            munmap(mem, sizeof(shm_bus));
+            VCML_REPORT("bus %s already has %zu nodes", m_name.c_str(),
+                        (size_t)SHM_MAX_NODES);
+        }
+    } while (!m_bus->users.compare_exchange_weak(users,
+                                                 users | (u32)bit(m_node)));
+
+    m_tx = &m_bus->rings[m_node];
+    m_tx->pid = (u32)getpid();
+    m_tx->now = m_sync ? time_stamp_ns() : SHM_NO_TIME;
+
+    // only frames published from now on are of interest to us
+    for (size_t i = 0; i < SHM_MAX_NODES; i++)
+        m_tails[i] = m_bus->rings[i].head.load();
+}
+
+void backend_shm::close_bus() {
+    if (m_bus != nullptr) {
+        // never keep anyone waiting for a node that is gone
+        publish_time(SHM_NO_TIME);
+
+        u32 users = m_bus->users.fetch_and(~(u32)bit(m_node));
+        if ((users & ~(u32)bit(m_node)) == 0)
+            shm_unlink(("/vcml-can-" + m_name).c_str());
+        munmap(m_bus, sizeof(shm_bus));
+        m_bus = nullptr;
+    }
+
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool backend_shm::receive() {
+    bool received = false;
+    for (size_t i = 0; i < SHM_MAX_NODES; i++) {
+        if (i == m_node)
+            continue;
+
+        shm_ring& ring = m_bus->rings[i];
+        u64 head = ring.head.load(std::memory_order_acquire);
+        u64& tail = m_tails[i];
+
+        // senders never wait for slow readers, they overwrite old frames
+        if (head - tail > SHM_RING_SLOTS) {
+            m_dropped += head - tail - SHM_RING_SLOTS;
+            tail = head - SHM_RING_SLOTS;
+        }
+
+        while (tail != head) {
+            shm_slot slot = ring.slots[tail % SHM_RING_SLOTS];
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // the sender may have lapped us while we were copying the slot
+            head = ring.head.load(std::memory_order_relaxed);
+            if (head - tail >= SHM_RING_SLOTS) {
+                m_dropped++;
+                tail++;
+                continue;
+            }
+
+            tail++;
+            received = true;
+
+            if (m_sync) {
+                sc_time stamp((double)slot.stamp, SC_NS);
+                send_to_guest(slot.frame, stamp + m_quantum);
+            } else {
+                send_to_guest(slot.frame);
+            }
+        }
+    }
+
+    return received;
+}
+
+void backend_shm::reader() {
+    mwr::set_thread_name(mkstr("shm_%s", m_name.c_str()));
+    while (m_running) {
+        if (receive())
+            continue;
+
+        // announce that we are about to sleep, then look again so that
+        // frames published in between can never be missed
+        m_bus->readers++;
+        u32 seq = m_bus->frames.load();
+        if (!receive())
+            futex_wait(m_bus->frames, seq, 100000000); // 100ms
+        m_bus->readers--;
+    }
+}
+
+void backend_shm::publish(const can_frame* frames, size_t count) {
+    u64 head = m_tx->head.load(std::memory_order_relaxed);
+    u64 stamp = time_stamp_ns();
+    for (size_t i = 0; i < count; i++) {
+        shm_slot& slot = m_tx->slots[head % SHM_RING_SLOTS];
+        slot.stamp = stamp;
+        slot.frame = frames[i];
+        m_tx->head.store(++head, std::memory_order_release);
+    }
+
+    m_bus->frames++; // must be ordered before reading readers
+    if (m_bus->readers.load())
+        futex_wake_all(m_bus->frames);
+}
+
+void backend_shm::publish_time(u64 now) {
+    m_tx->now.store(now);
+    m_bus->clock++; // must be ordered before reading waiters
+    if (m_bus->waiters.load())
+        futex_wake_all(m_bus->clock);
+}
+
+void backend_shm::wait_for_peers(u64 now) {
+    u32 pid = (u32)getpid();
+    u64 start = mwr::timestamp_us();
+    bool warned = false;
+
+    while (m_running) {
+        u32 seq = m_bus->clock.load();
+        u32 users = m_bus->users.load();
+
+        bool behind = false;
+        for (size_t i = 0; i < SHM_MAX_NODES && !behind; i++) {
+            const shm_ring& ring = m_bus->rings[i];
+            if (i == m_node || !(users & (u32)bit(i)))
+                continue;
+
+            // nodes inside this process share our simulation time anyway
+            if (ring.pid.load() == pid)
+                continue;
+
+            behind = ring.now.load() < now;
+        }
+
+        if (!behind)
+            return;
+
+        m_bus->waiters++;
+        futex_wait(m_bus->clock, seq, 100000000); // 100ms
+        m_bus->waiters--;
+
+        if (!warned && mwr::timestamp_us() - start > 10000000) {
+            log_warn("shm bus %s: waiting for peers to reach %s",
+                     m_name.c_str(), sc_time_stamp().to_string().c_str());
+            warned = true;
+        }
+    }
+}
+
+void backend_shm::lockstep(shared_ptr<atomic<bool>> alive) {
+    while (*alive) {
+        u64 now = time_stamp_ns();
+        publish_time(now);
+        wait_for_peers(now);
+        sc_core::wait(m_quantum);
+    }
+}
+
+backend_shm::backend_shm(bridge* br, const string& name, bool sync,
+                         const sc_time& quantum):
+    backend(br),
+    m_name(name),
+    m_sync(sync),
+    m_quantum(quantum),
+    m_fd(-1),
+    m_node(0),
+    m_bus(nullptr),
+    m_tx(nullptr),
+    m_tails(),
+    m_dropped(0),
+    m_running(true),
+    m_reader(),
+    m_alive(new atomic<bool>(true)) {
+    VCML_REPORT_ON(m_name.empty(), "no bus name given");
+    VCML_REPORT_ON(m_sync && m_quantum == SC_ZERO_TIME,
+                   "lock-step needs a quantum");
+
+    try {
+        open_bus();
+    } catch (...) {
+        close_bus();
+        throw;
+    }
+
+    m_type = mkstr("shm:%s", m_name.c_str());
+    log_debug("attached to shm bus %s as node %zu", m_name.c_str(), m_node);
+    m_reader = thread(&backend_shm::reader, this);
+
+    if (m_sync) {
+        shared_ptr<atomic<bool>> alive = m_alive;
+        sc_spawn([this, alive]() -> void { lockstep(alive); },
+                 sc_gen_unique_name("shm_lockstep"));
+    }
+}
+
+backend_shm::~backend_shm() {
+    *m_alive = false;
+    m_running = false;
+    if (m_reader.joinable()) {
+        futex_wake_all(m_bus->frames);
+        m_reader.join();
+    }
+
+    close_bus();
+}
+
+void backend_shm::send_to_host(const can_frame& frame) {
+    publish(&frame, 1);
+}
+
+void backend_shm::send_batch_to_host(const vector<can_frame>& frames) {
+    publish(frames.data(), frames.size());
+}
+
+backend* backend_shm::create(bridge* br, const string& type) {
+    // shm:<name>[:sync[:<quantum>]]
+    vector<string> args = split(type, ':');
+    string name = args.size() > 1 ? args[1] : "0";
+    bool sync = args.size() > 2 && args[2] == "sync";
+
+    sc_time quantum = tlm::tlm_global_quantum::instance().get();
+    if (args.size() > 3)
+        quantum = from_string<sc_time>(args[3]);
+    if (quantum == SC_ZERO_TIME)
+        quantum = sc_time(10, SC_US);
+
+    return new backend_shm(br, name, sync, quantum);
+}
+
+} // namespace can
+} // namespace vcml
@@ -0,0 +1,81 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_CAN_BACKEND_SHM_H
+#define VCML_CAN_BACKEND_SHM_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/logging/logger.h"
+
+#include "vcml/models/can/backend.h"
+#include "vcml/models/can/bridge.h"
+
+namespace vcml {
+namespace can {
+
+struct shm_bus;
+struct shm_ring;
+
+// virtual can bus shared by up to eight simulations on the same host; every
+// node owns one broadcast ring inside a posix shared memory object, which
+// all other nodes read at their own pace. In sync mode, nodes also publish
+// their simulation time and advance in lock-step one quantum at a time, and
+// frames reach the guests exactly one quantum after they were sent
+class backend_shm : public backend
+{
+private:
+    string m_name;
+    bool m_sync;
+    sc_time m_quantum;
+    int m_fd;
+    size_t m_node;
+    shm_bus* m_bus;
+    shm_ring* m_tx;
+
+    u64 m_tails[8];
+    atomic<size_t> m_dropped;
+
+    atomic<bool> m_running;
+    thread m_reader;
+    shared_ptr<atomic<bool>> m_alive;
+
+    void open_bus();
+    void close_bus();
+    bool receive();
+    void reader();
+    void publish(const can_frame* frames, size_t count);
+
+    void publish_time(u64 now);
+    void wait_for_peers(u64 now);
+    void lockstep(shared_ptr<atomic<bool>> alive);
+
+public:
+    const char* bus_name() const { return m_name.c_str(); }
+    size_t node() const { return m_node; }
+    size_t num_dropped() const { return m_dropped; }
+    bool is_synchronized() const { return m_sync; }
+    const sc_time& quantum() const { return m_quantum; }
+
+    backend_shm(bridge* br, const string& name, bool sync,
+                const sc_time& quantum);
+    virtual ~backend_shm();
+
+    virtual void send_to_host(const can_frame& frame) override;
+    virtual void send_batch_to_host(const vector<can_frame>& fr) override;
+
+    static backend* create(bridge* br, const string& type);
+};
+
+} // namespace can
+} // namespace vcml
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <linux/if.h>
 #include <linux/can.h>
@@ -39,14 +40,63 @@ static int can_iface_mtu(int socket, const char* ifname) {
     return req.ifr_mtu;
 }
 
+// maximum number of frames read or written per system call
+static const size_t CAN_BATCH = 32;
+
+void backend_socket::receive_batch(int fd) {
+    can_frame frames[CAN_BATCH] = {}; // classic frames leave the tail alone
+    struct iovec iov[CAN_BATCH];
+    struct mmsghdr msgs[CAN_BATCH] = {};
+    for (size_t i = 0; i < CAN_BATCH; i++) {
+        iov[i].iov_base = &frames[i];
+        iov[i].iov_len = sizeof(frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int n = recvmmsg(fd, msgs, CAN_BATCH, MSG_DONTWAIT, nullptr);
+    if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+            return;
+
+        log_error("error reading %s: %s", m_name.c_str(), strerror(errno));
+        mwr::aio_cancel(fd);
+        return;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < n; i++) {
+        size_t len = msgs[i].msg_len;
+        if (len != CAN_MTU && len != CANFD_MTU) {
+            log_warn("dropping invalid frame from %s", m_name.c_str());
+            continue;
+        }
+
+        can_frame& frame = frames[count++];
+        if (&frame != &frames[i])
+            frame = frames[i];
+
+        // Linux VCAN has already translated DLC to length in bytes, undo that
+        // before we forward the frame to the devices.
+        frame.dlc = len2dlc(frame.dlc);
+
+        // CANFD_FDF allows dual-use of the can_frame for FD and non-FD frames
+        if (m_canfd)
+            frame.flags |= CANFD_FDF;
+    }
+
+    send_batch_to_guest(frames, count);
+}
+
 backend_socket::backend_socket(bridge* br, const string& ifname):
-    backend(br), m_name(ifname), m_socket(-1) {
+    backend(br), m_name(ifname), m_socket(-1), m_canfd(false) {
     m_socket = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
     if (m_socket < 0)
         VCML_REPORT("error creating can socket: %s", strerror(errno));
 
     size_t mtu = can_iface_mtu(m_socket, m_name.c_str());
-    if (mtu >= CANFD_MTU) {
+    m_canfd = mtu >= CANFD_MTU;
+    if (m_canfd) {
         int enable = 1;
         if (setsockopt(m_socket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable,
                        sizeof(enable))) {
@@ -62,24 +112,7 @@ backend_socket::backend_socket(bridge* br, const string& ifname):
     if (bind(m_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0)
         VCML_REPORT("failed to bind %s: %s", m_name.c_str(), strerror(errno));
 
-    mwr::aio_notify(m_socket, [=](int fd) -> void {
-        can_frame frame;
-        if (mwr::fd_read(fd, &frame, sizeof(frame)) != sizeof(frame)) {
-            log_error("error reading %s: %s", m_name.c_str(), strerror(errno));
-            mwr::aio_cancel(fd);
-            return;
-        }
-
-        // Linux VCAN has already translated DLC to length in bytes, undo that
-        // before we forward the frame to the devices.
-        frame.dlc = len2dlc(frame.dlc);
-
-        // CANFD_FDF allows dual-use of the can_frame for FD and non-FD frames
-        if (mtu >= CANFD_MTU)
-            frame.flags |= CANFD_FDF;
-
-        send_to_guest(frame);
-    });
+    mwr::aio_notify(m_socket, [&](int fd) -> void { receive_batch(fd); });
 
     m_type = mkstr("socket:%s", ifname.c_str());
 }
@@ -100,6 +133,41 @@ void backend_socket::send_to_host(const can_frame& frame) {
     }
 }
 
+void backend_socket::send_batch_to_host(const vector<can_frame>& frames) {
+    if (m_socket < 0)
+        return;
+
+    for (size_t off = 0; off < frames.size(); off += CAN_BATCH) {
+        size_t n = min(frames.size() - off, CAN_BATCH);
+
+        can_frame copies[CAN_BATCH];
+        struct iovec iov[CAN_BATCH];
+        struct mmsghdr msgs[CAN_BATCH] = {};
+        for (size_t i = 0; i < n; i++) {
+            copies[i] = frames[off + i];
+            copies[i].dlc = dlc2len(copies[i].dlc);
+            iov[i].iov_base = &copies[i];
+            iov[i].iov_len = sizeof(copies[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        size_t sent = 0;
+        while (sent < n) {
+            int r = sendmmsg(m_socket, msgs + sent, n - sent, 0);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0) {
+                log_warn("error writing %s: %s", m_name.c_str(),
+                         strerror(errno));
+                return;
+            }
+
+            sent += r;
+        }
+    }
+}
+
 backend* backend_socket::create(bridge* br, const string& type) {
     string tx = mkstr("%s.tx", br->name());
     vector<string> args = split(type, ':');
@@ -26,12 +26,16 @@ class backend_socket : public backend
 private:
     string m_name;
     int m_socket;
+    bool m_canfd;
+
+    void receive_batch(int fd);
 
 public:
     backend_socket(bridge* br, const string& ifname);
     virtual ~backend_socket();
 
     virtual void send_to_host(const can_frame& frame) override;
+    virtual void send_batch_to_host(const vector<can_frame>& frames) override;
 
     static backend* create(bridge* br, const string& type);
 };
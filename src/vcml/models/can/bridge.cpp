@@ -13,6 +13,58 @@
 namespace vcml {
 namespace can {
 
+static u64 next_bridge_id() {
+    static atomic<u64> id(0);
+    return ++id;
+}
+
+bridge::rx_ring::rx_ring(size_t capacity):
+    frames(capacity), head(0), tail(0) {
+}
+
+bridge::rx_ring* bridge::local_ring() {
+    // one ring per sending thread and bridge keeps every ring single
+    // producer, the mutex is only needed when a new thread shows up
+    thread_local unordered_map<u64, rx_ring*> rings;
+    auto it = rings.find(m_id);
+    if (it != rings.end())
+        return it->second;
+
+    lock_guard<mutex> guard(m_rings_mtx);
+    m_rings.push_back(std::make_unique<rx_ring>(max<size_t>(rx_capacity, 2)));
+    return rings[m_id] = m_rings.back().get();
+}
+
+size_t bridge::drain_rings() {
+    vector<rx_ring*> rings;
+    {
+        lock_guard<mutex> guard(m_rings_mtx);
+        for (auto& r : m_rings)
+            rings.push_back(r.get());
+    }
+
+    size_t count = 0;
+    for (rx_ring* r : rings) {
+        size_t tail = r->tail.load(std::memory_order_relaxed);
+        while (tail != r->head.load(std::memory_order_acquire)) {
+            can_frame frame = r->frames[tail].frame;
+            sc_time delivery = r->frames[tail].delivery;
+            tail = (tail + 1) % r->frames.size();
+            r->tail.store(tail, std::memory_order_release);
+
+            // frames from time-synchronized peers never arrive early
+            if (delivery > sc_time_stamp())
+                wait(delivery - sc_time_stamp());
+
+            m_replay.record(&frame, sizeof(frame));
+            can_tx.send(frame);
+            count++;
+        }
+    }
+
+    return count;
+}
+
 bool bridge::cmd_create_backend(const vector<string>& args, ostream& os) {
     try {
         size_t id = create_backend(args[0]);
@@ -61,22 +113,34 @@ bool bridge::cmd_list_backends(const vector<string>& args, ostream& os) {
 }
 
 void bridge::can_receive(can_frame& frame) {
-    send_to_host(frame);
+    if (m_tx.empty())
+        m_tx_ev.notify(SC_ZERO_TIME);
+    m_tx.push_back(frame);
 }
 
 void bridge::can_transmit() {
+    size_t dropped = 0;
     while (true) {
         wait(m_ev);
 
-        lock_guard<mutex> guard(m_mtx);
-        while (!m_rx.empty()) {
-            can_frame frame = m_rx.front();
-            m_rx.pop();
-            can_tx.send(frame);
+        // clear first, so that frames arriving during draining notify again
+        m_rx_pending = false;
+        drain_rings();
+
+        if (dropped != m_rx_dropped) {
+            log_warn("dropped %zu frames due to full rx rings",
+                     m_rx_dropped - dropped);
+            dropped = m_rx_dropped;
         }
     }
 }
 
+void bridge::flush_host() {
+    vector<can_frame> frames;
+    frames.swap(m_tx);
+    send_to_host(frames);
+}
+
 unordered_map<string, bridge*>& bridge::bridges() {
     static unordered_map<string, bridge*> instances;
     return instances;
@@ -88,10 +152,17 @@ bridge::bridge(const sc_module_name& nm):
     m_next_id(),
     m_dynamic_backends(),
     m_backends(),
-    m_mtx(),
-    m_rx(),
+    m_id(next_bridge_id()),
+    m_rings_mtx(),
+    m_rings(),
+    m_rx_pending(false),
+    m_rx_dropped(0),
     m_ev("rxev"),
+    m_tx(),
+    m_tx_ev("txev"),
+    m_replay(name()),
     backends("backends", ""),
+    rx_capacity("rx_capacity", 256),
     can_tx("can_tx"),
     can_rx("can_rx") {
     bridges()[name()] = this;
@@ -105,9 +176,20 @@ bridge::bridge(const sc_module_name& nm):
         }
     }
 
+    m_replay.replay([this](const u8* data, size_t size) -> void {
+        can_frame frame;
+        VCML_ERROR_ON(size != sizeof(frame), "invalid replay can frame");
+        memcpy(&frame, data, sizeof(frame));
+        can_tx.send(frame);
+    });
+
     SC_HAS_PROCESS(bridge);
     SC_THREAD(can_transmit);
 
+    SC_METHOD(flush_host);
+    sensitive << m_tx_ev;
+    dont_initialize();
+
     register_command("create_backend", 1, this, &bridge::cmd_create_backend,
                      "creates a new backend for this gateway of the given "
                      "type, usage: create_backend <type>");
@@ -130,10 +212,61 @@ void bridge::send_to_host(const can_frame& frame) {
         b->send_to_host(frame);
 }
 
+void bridge::send_to_host(const vector<can_frame>& frames) {
+    for (backend* b : m_backends)
+        b->send_batch_to_host(frames);
+}
+
 void bridge::send_to_guest(can_frame frame) {
-    lock_guard<mutex> guard(m_mtx);
-    m_rx.push(frame);
-    on_next_update([&]() -> void { m_ev.notify(SC_ZERO_TIME); });
+    send_to_guest(&frame, 1);
+}
+
+void bridge::send_to_guest(const can_frame* frames, size_t count) {
+    if (m_replay.is_replaying() || count == 0)
+        return; // frames are replayed from the recording instead
+
+    rx_ring* r = local_ring();
+    size_t head = r->head.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        size_t next = (head + 1) % r->frames.size();
+
+        // never block the backend threads, drop frames if the ring is full
+        if (next == r->tail.load(std::memory_order_acquire)) {
+            m_rx_dropped += count - i;
+            break;
+        }
+
+        r->frames[head].frame = frames[i];
+        r->frames[head].delivery = SC_ZERO_TIME;
+        head = next;
+    }
+
+    r->head.store(head, std::memory_order_release);
+
+    if (!m_rx_pending.exchange(true))
+        on_next_update([this]() -> void { m_ev.notify(SC_ZERO_TIME); });
+}
+
+void bridge::send_to_guest(can_frame frame, const sc_time& delivery) {
+    if (m_replay.is_replaying())
+        return; // frames are replayed from the recording instead
+
+    rx_ring* r = local_ring();
+    size_t head = r->head.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % r->frames.size();
+
+    // never block the backend threads, drop frames if the ring is full
+    if (next == r->tail.load(std::memory_order_acquire)) {
+        m_rx_dropped++;
+        return;
+    }
+
+    r->frames[head].frame = frame;
+    r->frames[head].delivery = delivery;
+    r->head.store(next, std::memory_order_release);
+
+    if (!m_rx_pending.exchange(true))
+        on_next_update([this]() -> void { m_ev.notify(SC_ZERO_TIME); });
 }
 
 void bridge::attach(backend* b) {
@@ -13,16 +13,57 @@
 namespace vcml {
 namespace can {
 
-void bus::can_receive(const can_target_socket& rx, can_frame& frame) {
-    const can_initiator_socket& sender = peer_of(rx);
+bool bus::accepts(const port& p, const can_frame& frame) const {
+    if (p.filters.empty())
+        return true;
+
+    for (const can_filter& filter : p.filters)
+        if (filter.matches(frame))
+            return true;
+
+    return false;
+}
+
+void bus::build_ports() {
+    m_ports.clear();
     for (auto& tx : can_tx) {
-        if (tx.second != &sender)
-            tx.second->send(frame);
+        port p;
+        p.id = tx.first;
+        p.tx = tx.second;
+        auto it = m_filters.find(tx.first);
+        if (it != m_filters.end())
+            p.filters = it->second;
+        m_ports.push_back(std::move(p));
     }
+
+    std::sort(m_ports.begin(), m_ports.end(),
+              [](const port& a, const port& b) { return a.id < b.id; });
+}
+
+void bus::can_receive(const can_target_socket& rx, can_frame& frame) {
+    if (m_ports.empty())
+        build_ports();
+
+    size_t sender = can_rx.index_of(rx);
+    for (const port& p : m_ports) {
+        if (p.id != sender && accepts(p, frame))
+            p.tx->send(frame);
+    }
+}
+
+void bus::end_of_elaboration() {
+    module::end_of_elaboration();
+    build_ports();
 }
 
 bus::bus(const sc_module_name& nm):
-    module(nm), can_host(), m_next_id(0), can_tx("can_tx"), can_rx("can_rx") {
+    module(nm),
+    can_host(),
+    m_next_id(0),
+    m_ports(),
+    m_filters(),
+    can_tx("can_tx"),
+    can_rx("can_rx") {
     // nothing to do
 }
 
@@ -35,6 +76,21 @@ void bus::bind(can_initiator_socket& tx, can_target_socket& rx) {
     m_next_id++;
 }
 
+void bus::add_filter(size_t id, u32 msgid, u32 mask) {
+    can_filter filter{ msgid, mask };
+    m_filters[id].push_back(filter);
+    for (port& p : m_ports)
+        if (p.id == id)
+            p.filters.push_back(filter);
+}
+
+void bus::clear_filters(size_t id) {
+    m_filters.erase(id);
+    for (port& p : m_ports)
+        if (p.id == id)
+            p.filters.clear();
+}
+
 VCML_EXPORT_MODEL(vcml::can::bus, name, args) {
     return new bus(name);
 }
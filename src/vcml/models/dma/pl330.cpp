@@ -14,6 +14,7 @@ namespace vcml::dma {
 
 enum pl330_configs : u32 {
     PL330_INSN_MAXSIZE = 6,
+    PL330_BURST_MAXSIZE = 16 * 128,
     PL330_WD_TIMEOUT = 1024,
 };
 
@@ -195,6 +196,11 @@ static void pl330_handle_mn_fault(pl330& dma, ftrd_bits fault) {
         dma.irq_abort = true;
 }
 
+static void pl330_wake_channels(pl330& dma) {
+    for (auto& channel : dma.channels)
+        channel.wakeup.notify(SC_ZERO_TIME);
+}
+
 static void pl330_insn_dmaadxh(pl330::channel* ch, u8* args, bool ra,
                                bool neg) {
     u32 im = (args[1] << 8) | args[0];
@@ -288,8 +294,10 @@ static void pl330_insn_dmago(pl330* dma, pl330::channel* ch, u8 opcode,
         return;
     }
     set_bit<CSR_CNS>(channel.csr, ns);
+    channel.icache.clear();
     channel.cpc = pc;
     channel.set_state(CHS_EXECUTING);
+    channel.wakeup.notify(SC_ZERO_TIME);
 }
 
 static void pl330_insn_dmakill(pl330* dma, pl330::channel* ch, u8 opcode,
@@ -303,6 +311,7 @@ static void pl330_insn_dmakill(pl330* dma, pl330::channel* ch, u8 opcode,
             dma->irq_abort = false;
     }
     ch->set_state(CHS_KILLING);
+    ch->icache.clear();
     dma->mfifo.remove_tagged(ch->chid);
     dma->read_queue.remove_tagged(ch->chid);
     dma->write_queue.remove_tagged(ch->chid);
@@ -466,6 +475,7 @@ static void pl330_insn_dmasev(pl330* dma, pl330::channel* ch, u8 opcode,
         dma->irq[ev_id] = true;
     }
     dma->int_event_ris |= bit(ev_id);
+    pl330_wake_channels(*dma);
 }
 
 static void pl330_mn_insn_dmasev(pl330* dma, pl330::channel* ch, u8 opcode,
@@ -490,6 +500,7 @@ static void pl330_mn_insn_dmasev(pl330* dma, pl330::channel* ch, u8 opcode,
         dma->irq[ev_id] = true;
     }
     dma->int_event_ris |= bit(ev_id);
+    pl330_wake_channels(*dma);
 }
 
 static void pl330_insn_dmast(pl330* dma, pl330::channel* ch, u8 opcode,
@@ -668,7 +679,7 @@ static void pl330_insn_dmawmb(pl330* dma, pl330::channel* ch, u8 opcode,
     }
 }
 
-struct insn_descr {
+struct pl330::insn_descr {
     u8 opcode;
     u8 opmask;
     u32 size;
@@ -676,6 +687,8 @@ struct insn_descr {
 };
 
 // Instructions which can be issued via channel threads.
+typedef pl330::insn_descr insn_descr;
+
 static const insn_descr CH_INSN_DESCR[] = {
     { 0x54, 0xfd, 3, pl330_insn_dmaaddh },
     { 0x5c, 0xfd, 3, pl330_insn_dmaadnh },
@@ -714,13 +727,29 @@ static const insn_descr DEBUG_INSN_DESC[] = {
     { 0x34, 0xff, 2, pl330_insn_dmasev },
 };
 
-static const insn_descr* fetch_ch_insn(pl330* dma, pl330::channel& channel) {
-    u8 opcode;
-    dma->dma.read(channel.cpc, &opcode, 1);
-    for (auto& insn_candidate : CH_INSN_DESCR)
-        if (insn_candidate.opcode == (opcode & insn_candidate.opmask))
-            return &insn_candidate;
-    return nullptr;
+static const pl330::decoded_insn* fetch_ch_insn(pl330* dma,
+                                                pl330::channel& channel) {
+    auto it = channel.icache.find(channel.cpc);
+    if (it != channel.icache.end())
+        return &it->second;
+
+    pl330::decoded_insn insn = {};
+    if (failed(dma->dma.read(channel.cpc, insn.code, 1)))
+        return nullptr;
+
+    for (auto& insn_candidate : CH_INSN_DESCR) {
+        if (insn_candidate.opcode == (insn.code[0] & insn_candidate.opmask)) {
+            insn.descr = &insn_candidate;
+            break;
+        }
+    }
+
+    if (!insn.descr || failed(dma->dma.read(channel.cpc + 1, insn.code + 1,
+                                            insn.descr->size - 1))) {
+        return nullptr;
+    }
+
+    return &(channel.icache[channel.cpc] = insn);
 }
 
 static const insn_descr* fetch_mn_insn(pl330* dma) {
@@ -733,10 +762,17 @@ static const insn_descr* fetch_mn_insn(pl330* dma) {
 }
 
 static void execute_insn(pl330& dma, pl330::channel& channel,
-                         const insn_descr* insn) {
+                         const pl330::decoded_insn* insn) {
+    // copy, executing may invalidate the cache entry
     u8 buffer[PL330_INSN_MAXSIZE];
-    dma.dma.read(channel.cpc, (void*)buffer, insn->size);
-    insn->exec(&dma, &channel, buffer[0], &buffer[1], insn->size - 1);
+    const insn_descr* descr = insn->descr;
+    memcpy(buffer, insn->code, descr->size);
+    descr->exec(&dma, &channel, buffer[0], &buffer[1], descr->size - 1);
+}
+
+static void invalidate_insns(pl330& dma, u64 addr, u64 size) {
+    for (auto& channel : dma.channels)
+        channel.invalidate_icache(addr, addr + size - 1);
 }
 
 static int channel_execute_one_insn(pl330& dma, pl330::channel& channel) {
@@ -748,15 +784,16 @@ static int channel_execute_one_insn(pl330& dma, pl330::channel& channel) {
         return 0;
     }
     channel.stall = false;
-    const insn_descr* insn = fetch_ch_insn(&dma, channel);
+    const pl330::decoded_insn* insn = fetch_ch_insn(&dma, channel);
     if (!insn) {
         pl330_handle_ch_fault(dma, channel, FTR_INSTR_FETCH_ERR);
         return 0;
     }
 
+    u32 size = insn->descr->size;
     execute_insn(dma, channel, insn);
     if (!channel.stall && !channel.is_state(CHS_STOPPED)) {
-        channel.cpc += insn->size;
+        channel.cpc += size;
         channel.watchdog_timer = 0;
         return 1;
     } else if (channel.is_state(CHS_EXECUTING)) {
@@ -771,44 +808,61 @@ static int channel_execute_cycle(pl330& dma, pl330::channel& channel) {
     u32 num_exec = 0;
     num_exec += channel_execute_one_insn(dma, channel);
 
-    // one insn form read queue
+    // one burst from read queue, incrementing bursts are moved in one go
     if (!dma.read_queue.empty() &&
         dma.read_queue.front().data_len <= dma.mfifo.num_free()) {
         auto& insn = dma.read_queue.front_mut();
         // crop length otherwise in case of an unaligned address the first read
         // would be too long
         u32 len = insn.data_len - (insn.data_addr & (insn.data_len - 1));
-        u8 buffer[PL330_INSN_MAXSIZE];
-        if (failed(dma.dma.read(insn.data_addr, (void*)buffer, len))) {
-            dma.log.error("Dma channel read failed");
-            VCML_ERROR("PL33 DMA read failed");
+        u32 beats = 1;
+        if (insn.inc && insn.burst_len_counter > 1) {
+            u32 total = len + (insn.burst_len_counter - 1) * insn.data_len;
+            if (total <= dma.mfifo.num_free()) {
+                len = total;
+                beats = insn.burst_len_counter;
+            }
         }
 
         if (dma.mfifo.num_free() >= len) {
+            u8 buffer[PL330_BURST_MAXSIZE];
+            if (failed(dma.dma.read(insn.data_addr, (void*)buffer, len))) {
+                dma.log.error("Dma channel read failed");
+                VCML_ERROR("PL33 DMA read failed");
+            }
+
             for (u32 i = 0; i < len; i++) {
                 dma.mfifo.push(
                     pl330::mfifo_entry{ buffer[i], (u8)channel.chid });
             }
             if (insn.inc)
                 insn.data_addr += len;
-            insn.burst_len_counter--;
+            insn.burst_len_counter -= beats;
             if (!insn.burst_len_counter)
                 dma.read_queue.pop();
             num_exec++;
         }
     }
-    // one insn from write queue
+    // one burst from write queue
     if (!dma.write_queue.empty() && dma.mfifo.front().tag == channel.chid) {
         auto& insn = dma.write_queue.front_mut();
         // crop length otherwise in case of an unaligned address the first read
         // would be too long
-        int len = insn.data_len - (insn.data_addr & (insn.data_len - 1));
-        u8 buffer[PL330_INSN_MAXSIZE];
+        u32 len = insn.data_len - (insn.data_addr & (insn.data_len - 1));
+        u32 beats = 1;
+        if (insn.inc && insn.burst_len_counter > 1) {
+            u32 total = len + (insn.burst_len_counter - 1) * insn.data_len;
+            if (insn.zero_flag || total <= dma.mfifo.size()) {
+                len = total;
+                beats = insn.burst_len_counter;
+            }
+        }
+
+        u8 buffer[PL330_BURST_MAXSIZE];
         if (insn.zero_flag)
-            for (int i = 0; i < len; i++)
-                buffer[i] = 0;
+            memset(buffer, 0, len);
         else
-            for (int i = 0; i < len; i++) {
+            for (u32 i = 0; i < len; i++) {
                 assert(!dma.mfifo.empty());
                 buffer[i] = dma.mfifo.pop().value().buf;
             }
@@ -817,9 +871,11 @@ static int channel_execute_cycle(pl330& dma, pl330::channel& channel) {
             dma.log.error("Dma channel write failed");
             VCML_ERROR("PL33 DMA write failed");
         }
+
+        invalidate_insns(dma, insn.data_addr, len);
         if (insn.inc)
             insn.data_addr += len;
-        insn.burst_len_counter--;
+        insn.burst_len_counter -= beats;
         if (!insn.burst_len_counter)
             dma.write_queue.pop();
         num_exec++;
@@ -827,16 +883,42 @@ static int channel_execute_cycle(pl330& dma, pl330::channel& channel) {
     return num_exec;
 }
 
-void pl330::run_channels() {
-    for (auto& channel : channels) {
-        if (!(channel.is_state(CHS_STOPPED))) {
-            while (channel_execute_cycle(*this, channel) > 0) {
-                // nothing to do
-            }
+void pl330::run_channel(channel& ch) {
+    while (true) {
+        wait(ch.wakeup);
+
+        // channels share the queues and the mfifo, so progress made here
+        // may unblock the others; stalled channels sleep until woken up
+        size_t progress = 0;
+        while (!ch.is_state(CHS_STOPPED)) {
+            int n = channel_execute_cycle(*this, ch);
+            if (n == 0)
+                break;
+
+            progress += n;
+            if (needs_sync())
+                sync();
+        }
+
+        if (progress > 0) {
+            for (auto& other : channels)
+                if (&other != &ch && !other.is_state(CHS_STOPPED))
+                    other.wakeup.notify(SC_ZERO_TIME);
         }
     }
 }
 
+void pl330::gpio_notify(const gpio_target_socket& socket) {
+    if (!periph_irq.contains(socket))
+        return;
+
+    // a peripheral asserts its request line once it can take a transfer
+    size_t id = periph_irq.index_of(socket);
+    if (id < sizeof(periph_busy))
+        periph_busy[id] = !socket.read();
+    pl330_wake_channels(*this);
+}
+
 void pl330::run_manager() {
     if (!manager.is_state(MNS_EXECUTING) &&
         !manager.is_state(MNS_WAITING_FOR_EVENT)) {
@@ -912,7 +994,19 @@ void pl330::pl330_thread() {
             m_execute_debug = false;
         }
         run_manager();
-        run_channels();
+    }
+}
+
+void pl330::channel::invalidate_icache(u64 start, u64 end) {
+    if (icache.empty())
+        return;
+
+    for (auto it = icache.begin(); it != icache.end();) {
+        u64 addr = it->first;
+        if (addr <= end && addr + it->second.descr->size > start)
+            it = icache.erase(it);
+        else
+            it++;
     }
 }
 
@@ -927,7 +1021,8 @@ pl330::channel::channel(const sc_module_name& nm, mwr::u32 chid):
     lc0("lc0", 0x40c + chid * 0x20),
     lc1("lc1", 0x410 + chid * 0x20),
     chid(chid),
-    stall(false) {
+    stall(false),
+    icache() {
     auto reg_setter = [&](reg<mwr::u32>& reg) {
         reg.tag = chid;
         reg.allow_read_only();
@@ -983,8 +1078,13 @@ void pl330::reset() {
         ch.set_state(CHS_STOPPED);
         ch.watchdog_timer = 0;
         ch.stall = false;
+        ch.icache.clear();
     }
 
+    // unconnected request lines never hold up a channel
+    for (size_t i = 0; i < sizeof(periph_busy); i++)
+        periph_busy[i] = periph_irq.exists(i) && !periph_irq[i].read();
+
     // reset queues
     read_queue.reset();
     write_queue.reset();
@@ -1028,6 +1128,7 @@ pl330::pl330(const sc_module_name& nm):
     wd("wd", 0xe80),
     periph_id("periph_id", 0xfe0, 0x00000000),
     pcell_id("pcell_id", 0xff0, 0x00000000),
+    periph_busy(),
     periph_irq("periph_irq", (size_t)32),
     in("in"),
     dma("dma"),
@@ -1056,6 +1157,7 @@ pl330::pl330(const sc_module_name& nm):
         int_event_ris &= ~irq_clear_mask;
         intmis &= ~irq_clear_mask;
         m_dma.notify(SC_ZERO_TIME);
+        pl330_wake_channels(*this);
     });
 
     dbgstatus.allow_read_only();
@@ -1104,6 +1206,11 @@ pl330::pl330(const sc_module_name& nm):
 
     SC_HAS_PROCESS(pl330);
     SC_THREAD(pl330_thread);
+
+    for (auto& ch : channels) {
+        hierarchy_guard guard(&ch);
+        sc_spawn([this, &ch]() -> void { run_channel(ch); }, "thread");
+    }
 }
 
 } // namespace vcml::dma
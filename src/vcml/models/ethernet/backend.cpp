@@ -11,6 +11,8 @@
 #include "vcml/models/ethernet/bridge.h"
 #include "vcml/models/ethernet/backend.h"
 #include "vcml/models/ethernet/backend_file.h"
+#include "vcml/models/ethernet/backend_shm.h"
+#include "vcml/models/ethernet/backend_udp.h"
 
 #ifdef HAVE_TAP
 #include "vcml/models/ethernet/backend_tap.h"
@@ -36,11 +38,17 @@ void backend::send_to_guest(eth_frame frame) {
     m_parent->send_to_guest(std::move(frame));
 }
 
+void backend::send_to_guest(eth_frame frame, const sc_time& delivery) {
+    m_parent->send_to_guest(std::move(frame), delivery);
+}
+
 backend* backend::create(bridge* br, const string& type) {
     string kind = type.substr(0, type.find(':'));
     typedef function<backend*(bridge*, const string&)> construct;
     static const unordered_map<string, construct> backends = {
         { "file", backend_file::create },
+        { "shm", backend_shm::create },
+        { "udp", backend_udp::create },
 #ifdef HAVE_TAP
         { "tap", backend_tap::create },
 #endif
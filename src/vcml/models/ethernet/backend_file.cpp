@@ -13,29 +13,251 @@
 namespace vcml {
 namespace ethernet {
 
-backend_file::backend_file(bridge* br, const string& tx):
-    backend(br), m_count(0), m_tx(tx) {
-    if (!m_tx.good())
-        log_warn("failed to open file '%s'", tx.c_str());
-    m_type = mkstr("file:%s", tx.c_str());
+enum : u32 {
+    PCAP_MAGIC_NS = 0xa1b23c4d,
+    PCAP_LINKTYPE_ETHERNET = 1,
+    PCAPNG_SHB = 0x0a0d0d0a,
+    PCAPNG_IDB = 0x00000001,
+    PCAPNG_EPB = 0x00000006,
+    PCAPNG_BYTE_ORDER = 0x1a2b3c4d,
+};
+
+// how long buffered records may stay in memory before being written
+static const auto FLUSH_INTERVAL = std::chrono::milliseconds(100);
+
+template <typename T>
+static void put(vector<u8>& buffer, T val) {
+    const u8* ptr = (const u8*)&val;
+    buffer.insert(buffer.end(), ptr, ptr + sizeof(val));
+}
+
+static void put(vector<u8>& buffer, const void* data, size_t len) {
+    const u8* ptr = (const u8*)data;
+    buffer.insert(buffer.end(), ptr, ptr + len);
+    buffer.resize(buffer.size() + ((4 - len % 4) % 4), 0);
+}
+
+static size_t parse_size(string s) {
+    size_t unit = 1;
+    switch (s.empty() ? 0 : tolower(s.back())) {
+    case 'k':
+        unit = KiB;
+        break;
+    case 'm':
+        unit = MiB;
+        break;
+    case 'g':
+        unit = GiB;
+        break;
+    default:
+        return from_string<size_t>(s);
+    }
+
+    s.pop_back();
+    return from_string<size_t>(s) * unit;
+}
+
+string backend_file::file_name(size_t index) const {
+    return index ? mkstr("%s.%zu", m_path.c_str(), index) : m_path;
+}
+
+void backend_file::file_header(vector<u8>& buffer) const {
+    if (m_format == FORMAT_PCAP) {
+        put<u32>(buffer, PCAP_MAGIC_NS);
+        put<u16>(buffer, 2); // version major
+        put<u16>(buffer, 4); // version minor
+        put<i32>(buffer, 0); // thiszone
+        put<u32>(buffer, 0); // sigfigs
+        put<u32>(buffer, m_snaplen);
+        put<u32>(buffer, PCAP_LINKTYPE_ETHERNET);
+        return;
+    }
+
+    // section header block
+    put<u32>(buffer, PCAPNG_SHB);
+    put<u32>(buffer, 28);
+    put<u32>(buffer, PCAPNG_BYTE_ORDER);
+    put<u16>(buffer, 1); // version major
+    put<u16>(buffer, 0); // version minor
+    put<i64>(buffer, -1); // section length unknown
+    put<u32>(buffer, 28);
+
+    // interface description block with if_tsresol = 10^-9
+    put<u32>(buffer, PCAPNG_IDB);
+    put<u32>(buffer, 32);
+    put<u16>(buffer, PCAP_LINKTYPE_ETHERNET);
+    put<u16>(buffer, 0);
+    put<u32>(buffer, m_snaplen);
+    put<u16>(buffer, 9); // if_tsresol
+    put<u16>(buffer, 1);
+    put<u32>(buffer, 9);
+    put<u32>(buffer, 0); // opt_endofopt
+    put<u32>(buffer, 32);
+}
+
+void backend_file::append(const eth_frame& frame) {
+    u64 stamp = time_stamp_ns();
+    u32 len = min(frame.size(), m_snaplen);
+    u32 padded = (len + 3) & ~3u;
+    size_t size = m_format == FORMAT_PCAP ? 16 + len : 32 + padded;
+
+    lock_guard<mutex> guard(m_mtx);
+
+    // rotated files start with a fresh header written by the writer thread
+    if (m_rotate && m_file_size && m_file_size + size > m_rotate) {
+        if (!m_current.data.empty())
+            m_full.push_back(std::move(m_current));
+        m_current.file = ++m_file;
+        m_current.data.clear();
+        m_file_size = 0;
+    }
+
+    if (m_current.data.capacity() < CHUNK_SIZE)
+        m_current.data.reserve(CHUNK_SIZE);
+
+    vector<u8>& buffer = m_current.data;
+    if (m_format == FORMAT_PCAP) {
+        put<u32>(buffer, stamp / 1000000000ull);
+        put<u32>(buffer, stamp % 1000000000ull);
+        put<u32>(buffer, len);
+        put<u32>(buffer, frame.size());
+        buffer.insert(buffer.end(), frame.data(), frame.data() + len);
+    } else {
+        put<u32>(buffer, PCAPNG_EPB);
+        put<u32>(buffer, size);
+        put<u32>(buffer, 0); // interface id
+        put<u32>(buffer, stamp >> 32);
+        put<u32>(buffer, stamp);
+        put<u32>(buffer, len);
+        put<u32>(buffer, frame.size());
+        put(buffer, frame.data(), len);
+        put<u32>(buffer, size);
+    }
+
+    m_file_size += size;
+    if (buffer.size() >= CHUNK_SIZE) {
+        m_full.push_back(std::move(m_current));
+        m_current.file = m_file;
+        m_current.data.clear();
+        m_cv.notify_one();
+    }
+}
+
+void backend_file::write_chunks(deque<chunk>& chunks, ofstream& os,
+                                size_t& file) {
+    for (chunk& c : chunks) {
+        if (!os.is_open() || c.file != file) {
+            vector<u8> header;
+            file_header(header);
+
+            file = c.file;
+            string name = file_name(file);
+            os.close();
+            os.clear();
+            os.open(name, std::ios::binary | std::ios::trunc);
+            os.write((const char*)header.data(), header.size());
+            if (!os.good())
+                log_warn("failed to open file '%s'", name.c_str());
+        }
+
+        os.write((const char*)c.data.data(), c.data.size());
+    }
+
+    os.flush();
+    chunks.clear();
+}
+
+void backend_file::writer() {
+    mwr::set_thread_name("vcml_pcap");
+
+    ofstream os;
+    size_t file = 0;
+    deque<chunk> chunks;
+
+    // the first file is created up front, even if nothing is captured
+    chunks.push_back({ 0, {} });
+    write_chunks(chunks, os, file);
+
+    std::unique_lock<mutex> lock(m_mtx);
+    while (true) {
+        m_cv.wait_for(lock, FLUSH_INTERVAL,
+                      [&] { return !m_running || !m_full.empty(); });
+
+        chunks.swap(m_full);
+        if (!m_current.data.empty()) {
+            chunks.push_back(std::move(m_current));
+            m_current.file = m_file;
+            m_current.data.clear();
+        }
+
+        bool running = m_running;
+        if (!chunks.empty()) {
+            lock.unlock();
+            write_chunks(chunks, os, file);
+            lock.lock();
+        }
+
+        if (!running)
+            return;
+    }
+}
+
+backend_file::backend_file(bridge* br, const string& path, size_t snaplen,
+                           size_t rotate):
+    backend(br),
+    m_path(path),
+    m_format(ends_with(path, ".pcapng") ? FORMAT_PCAPNG : FORMAT_PCAP),
+    m_snaplen(snaplen ? min(snaplen, MAX_SNAPLEN) : MAX_SNAPLEN),
+    m_rotate(rotate),
+    m_count(0),
+    m_file(0),
+    m_file_size(0),
+    m_mtx(),
+    m_cv(),
+    m_current(),
+    m_full(),
+    m_running(true),
+    m_writer() {
+    m_type = mkstr("file:%s", path.c_str());
+    m_current.file = 0;
+    m_writer = thread(&backend_file::writer, this);
 }
 
 backend_file::~backend_file() {
-    // nothing to do
+    {
+        lock_guard<mutex> guard(m_mtx);
+        m_running = false;
+    }
+
+    m_cv.notify_one();
+    if (m_writer.joinable())
+        m_writer.join();
 }
 
 void backend_file::send_to_host(const eth_frame& frame) {
-    m_tx << "[" << sc_time_stamp() << "] packet #" << ++m_count << " " << frame
-         << std::endl;
+    append(frame);
+    m_count++;
 }
 
 backend* backend_file::create(bridge* br, const string& type) {
-    string tx = mkstr("%s.tx", br->name());
+    string path = mkstr("%s.pcap", br->name());
+    size_t snaplen = 0;
+    size_t rotate = 0;
+
     vector<string> args = split(type, ':');
-    if (args.size() > 1)
-        tx = args[1];
+    if (args.size() > 1 && !args[1].empty())
+        path = args[1];
+
+    for (size_t i = 2; i < args.size(); i++) {
+        if (starts_with(args[i], "snaplen="))
+            snaplen = parse_size(args[i].substr(8));
+        else if (starts_with(args[i], "rotate="))
+            rotate = parse_size(args[i].substr(7));
+        else
+            VCML_REPORT("unknown file option: %s", args[i].c_str());
+    }
 
-    return new backend_file(br, tx);
+    return new backend_file(br, path, snaplen, rotate);
 }
 
 } // namespace ethernet
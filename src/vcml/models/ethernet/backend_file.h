@@ -22,14 +22,57 @@
 namespace vcml {
 namespace ethernet {
 
+// captures all frames sent by the guest into a pcap or pcapng file (chosen
+// by file extension) with nanosecond simulation timestamps; records are
+// collected in memory and written to disk by a background thread
 class backend_file : public backend
 {
+public:
+    enum capture_format {
+        FORMAT_PCAP,
+        FORMAT_PCAPNG,
+    };
+
+    static constexpr size_t CHUNK_SIZE = 256 * KiB;
+    static constexpr size_t MAX_SNAPLEN = 256 * KiB;
+
 private:
+    struct chunk {
+        size_t file;
+        vector<u8> data;
+    };
+
+    string m_path;
+    capture_format m_format;
+    size_t m_snaplen;
+    size_t m_rotate;
+
     size_t m_count;
-    ofstream m_tx;
+    size_t m_file;
+    size_t m_file_size;
+
+    mutex m_mtx;
+    condition_variable m_cv;
+    chunk m_current;
+    deque<chunk> m_full;
+    bool m_running;
+    thread m_writer;
+
+    string file_name(size_t index) const;
+    void file_header(vector<u8>& buffer) const;
+    void append(const eth_frame& frame);
+
+    void write_chunks(deque<chunk>& chunks, ofstream& os, size_t& file);
+    void writer();
 
 public:
-    backend_file(bridge* br, const string& tx);
+    const char* path() const { return m_path.c_str(); }
+    capture_format format() const { return m_format; }
+    size_t snaplen() const { return m_snaplen; }
+    size_t count() const { return m_count; }
+
+    backend_file(bridge* br, const string& path, size_t snaplen = 0,
+                 size_t rotate = 0);
     virtual ~backend_file();
 
     virtual void send_to_host(const eth_frame& frame) override;
@@ -0,0 +1,213 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/ethernet/backend_shm.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace vcml {
+namespace ethernet {
+
+enum : size_t {
+    SHM_SLOT_SIZE = 2 * KiB,
+    SHM_RING_SLOTS = 256,
+};
+
+struct shm_slot {
+    u64 stamp; // simulation time of the sender in ns
+    u32 length;
+    u32 reserved;
+    u8 data[SHM_SLOT_SIZE - 16];
+};
+
+// zero-filled memory is a valid empty ring, so a freshly truncated shared
+// memory object needs no further initialization by whoever comes first
+struct shm_ring {
+    alignas(64) atomic<u32> head;
+    alignas(64) atomic<u32> tail;
+    alignas(64) atomic<u32> waiting;
+    shm_slot slots[SHM_RING_SLOTS];
+};
+
+struct shm_link {
+    atomic<u32> users; // bit n is set while side n is attached
+    shm_ring rings[2];
+};
+
+static_assert(atomic<u32>::is_always_lock_free, "shm rings need lock-free");
+static_assert(sizeof(atomic<u32>) == sizeof(u32), "unexpected atomic size");
+
+static void futex_wait(atomic<u32>& addr, u32 val, u64 timeout_ns) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ns / 1000000000;
+    ts.tv_nsec = timeout_ns % 1000000000;
+    // deliberately not FUTEX_PRIVATE, the other side is another process
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAIT, val, &ts, nullptr, 0);
+}
+
+static void futex_wake(atomic<u32>& addr) {
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+void backend_shm::open_link() {
+    string path = "/vcml-eth-" + m_name;
+    m_fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    VCML_REPORT_ON(m_fd < 0, "cannot open %s: %s", path.c_str(),
+                   strerror(errno));
+
+    struct stat info;
+    if (fstat(m_fd, &info) < 0)
+        VCML_REPORT("cannot access %s: %s", path.c_str(), strerror(errno));
+
+    if (info.st_size == 0 && ftruncate(m_fd, sizeof(shm_link)) < 0)
+        VCML_REPORT("cannot resize %s: %s", path.c_str(), strerror(errno));
+    else if (info.st_size != 0 && (size_t)info.st_size != sizeof(shm_link))
+        VCML_REPORT("%s is not a compatible link", path.c_str());
+
+    void* mem = mmap(nullptr, sizeof(shm_link), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, m_fd, 0);
+    VCML_REPORT_ON(mem == MAP_FAILED, "cannot map %s: %s", path.c_str(),
+                   strerror(errno));
+
+    m_link = (shm_link*)mem;
+
+    u32 users = m_link->users.load();
+    do {
+        if ((users & 3u) == 3u)
+            VCML_REPORT("link %s already has two peers", m_name.c_str());
+        m_side = (users & 1u) ? 1 : 0;
+    } while (!m_link->users.compare_exchange_weak(users,
+                                                  users | (u32)bit(m_side)));
+
+    m_tx = &m_link->rings[m_side];
+    m_rx = &m_link->rings[1 - m_side];
+}
+
+void backend_shm::close_link() {
+    if (m_link != nullptr) {
+        u32 users = m_link->users.fetch_and(~(u32)bit(m_side));
+        if ((users & ~(u32)bit(m_side)) == 0)
+            shm_unlink(("/vcml-eth-" + m_name).c_str());
+        munmap(m_link, sizeof(shm_link));
+        m_link = nullptr;
+    }
+
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool backend_shm::receive() {
+    u32 tail = m_rx->tail.load(std::memory_order_relaxed);
+    if (tail == m_rx->head.load(std::memory_order_acquire))
+        return false;
+
+    const shm_slot& slot = m_rx->slots[tail % SHM_RING_SLOTS];
+    size_t len = min<size_t>(slot.length, sizeof(slot.data));
+    eth_frame frame(len);
+    memcpy(frame.data(), slot.data, len);
+    u64 stamp = slot.stamp;
+    m_rx->tail.store(tail + 1, std::memory_order_release);
+
+    if (m_sync)
+        send_to_guest(std::move(frame), sc_time((double)stamp, SC_NS));
+    else
+        send_to_guest(std::move(frame));
+
+    return true;
+}
+
+void backend_shm::reader() {
+    mwr::set_thread_name(mkstr("shm_%s", m_name.c_str()));
+    while (m_running) {
+        if (receive())
+            continue;
+
+        // announce that we are about to sleep, then look again so that
+        // a frame published in between can never be missed
+        m_rx->waiting.store(1);
+        u32 head = m_rx->head.load();
+        if (head == m_rx->tail.load(std::memory_order_relaxed))
+            futex_wait(m_rx->head, head, 100000000); // 100ms
+        m_rx->waiting.store(0);
+    }
+}
+
+backend_shm::backend_shm(bridge* br, const string& name, bool sync):
+    backend(br),
+    m_name(name),
+    m_sync(sync),
+    m_fd(-1),
+    m_side(0),
+    m_link(nullptr),
+    m_tx(nullptr),
+    m_rx(nullptr),
+    m_dropped(0),
+    m_running(true),
+    m_reader() {
+    VCML_REPORT_ON(m_name.empty(), "no link name given");
+
+    try {
+        open_link();
+    } catch (...) {
+        close_link();
+        throw;
+    }
+
+    m_type = mkstr("shm:%s", m_name.c_str());
+    log_debug("attached to shm link %s as side %zu", m_name.c_str(), m_side);
+    m_reader = thread(&backend_shm::reader, this);
+}
+
+backend_shm::~backend_shm() {
+    m_running = false;
+    if (m_reader.joinable()) {
+        futex_wake(m_rx->head);
+        m_reader.join();
+    }
+
+    close_link();
+}
+
+void backend_shm::send_to_host(const eth_frame& frame) {
+    u32 head = m_tx->head.load(std::memory_order_relaxed);
+    u32 tail = m_tx->tail.load(std::memory_order_acquire);
+
+    shm_slot& slot = m_tx->slots[head % SHM_RING_SLOTS];
+    if (head - tail >= SHM_RING_SLOTS || frame.size() > sizeof(slot.data)) {
+        if (m_dropped++ == 0)
+            log_warn("shm link %s: dropping frames", m_name.c_str());
+        return;
+    }
+
+    memcpy(slot.data, frame.data(), frame.size());
+    slot.length = frame.size();
+    slot.stamp = time_stamp_ns();
+    m_tx->head.store(head + 1); // must be ordered before reading waiting
+    if (m_tx->waiting.load())
+        futex_wake(m_tx->head);
+}
+
+backend* backend_shm::create(bridge* br, const string& type) {
+    // shm:<name>[:sync]
+    vector<string> args = split(type, ':');
+    string name = args.size() > 1 ? args[1] : "0";
+    bool sync = args.size() > 2 && args[2] == "sync";
+    return new backend_shm(br, name, sync);
+}
+
+} // namespace ethernet
+} // namespace vcml
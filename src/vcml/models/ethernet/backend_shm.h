@@ -0,0 +1,68 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_ETHERNET_BACKEND_SHM_H
+#define VCML_ETHERNET_BACKEND_SHM_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/logging/logger.h"
+
+#include "vcml/models/ethernet/backend.h"
+#include "vcml/models/ethernet/bridge.h"
+
+namespace vcml {
+namespace ethernet {
+
+struct shm_link;
+struct shm_ring;
+
+// point-to-point link between two simulations on the same host; both
+// sides map the same posix shared memory object, which holds one lock-free
+// ring per direction; readers sleep on a futex inside the ring while idle
+class backend_shm : public backend
+{
+private:
+    string m_name;
+    bool m_sync;
+    int m_fd;
+    size_t m_side;
+    shm_link* m_link;
+    shm_ring* m_tx;
+    shm_ring* m_rx;
+
+    size_t m_dropped;
+
+    atomic<bool> m_running;
+    thread m_reader;
+
+    void open_link();
+    void close_link();
+    bool receive();
+    void reader();
+
+public:
+    const char* link_name() const { return m_name.c_str(); }
+    size_t side() const { return m_side; }
+    size_t num_dropped() const { return m_dropped; }
+
+    backend_shm(bridge* br, const string& name, bool sync);
+    virtual ~backend_shm();
+
+    virtual void send_to_host(const eth_frame& frame) override;
+
+    static backend* create(bridge* br, const string& type);
+};
+
+} // namespace ethernet
+} // namespace vcml
+
+#endif
@@ -10,7 +10,10 @@
 
 #include "vcml/models/ethernet/backend_slirp.h"
 
-#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 namespace vcml {
 namespace ethernet {
@@ -38,41 +41,11 @@ static struct in6_addr ipaddr6(const string& format, int val) {
 }
 
 static int slirp_add_poll_fd(int fd, int events, void* opaque) {
-    pollfd request;
-    request.fd = fd;
-    request.events = 0;
-    request.revents = 0;
-
-    if (events & SLIRP_POLL_IN)
-        request.events |= POLLIN;
-    if (events & SLIRP_POLL_OUT)
-        request.events |= POLLOUT;
-    if (events & SLIRP_POLL_PRI)
-        request.events |= POLLPRI;
-    if (events & SLIRP_POLL_ERR)
-        request.events |= POLLERR;
-    if (events & SLIRP_POLL_HUP)
-        request.events |= POLLHUP;
-
-    vector<pollfd>* requests = (vector<pollfd>*)opaque;
-    requests->push_back(request);
-    return requests->size() - 1;
+    return ((slirp_network*)opaque)->add_poll_fd(fd, events);
 }
 
 static int slirp_get_events(int idx, void* opaque) {
-    vector<pollfd>* requests = (vector<pollfd>*)opaque;
-    int events = 0, revents = requests->at(idx).revents;
-    if (revents & POLLIN)
-        events |= SLIRP_POLL_IN;
-    if (revents & POLLOUT)
-        events |= SLIRP_POLL_OUT;
-    if (revents & POLLPRI)
-        events |= SLIRP_POLL_PRI;
-    if (revents & POLLERR)
-        events |= SLIRP_POLL_ERR;
-    if (revents & POLLHUP)
-        events |= SLIRP_POLL_HUP;
-    return events;
+    return ((slirp_network*)opaque)->get_events(idx);
 }
 
 static ssize_t slirp_send(const void* buf, size_t len, void* opaque) {
@@ -85,33 +58,39 @@ static void slirp_error(const char* msg, void* opaque) {
     log_error("%s", msg);
 }
 
+static i64 host_clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (i64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
 static int64_t slirp_clock_ns(void* opaque) {
-    return time_stamp_ns();
+    // slirp talks to the host network, so it runs on host time
+    return host_clock_ns();
 }
 
 static void* slirp_timer_new(SlirpTimerCb cb, void* obj, void* opaque) {
-    return new async_timer([cb, obj](async_timer& t) -> void { (*cb)(obj); });
+    return ((slirp_network*)opaque)->timer_new(cb, obj);
 }
 
 static void slirp_timer_free(void* t, void* opaque) {
-    if (t)
-        delete (async_timer*)t;
+    ((slirp_network*)opaque)->timer_free(t);
 }
 
 static void slirp_timer_mod(void* t, int64_t expire_time, void* opaque) {
-    ((async_timer*)t)->reset(expire_time, SC_MS);
+    ((slirp_network*)opaque)->timer_mod(t, expire_time);
 }
 
 static void slirp_register_poll_fd(int fd, void* opaque) {
-    // nothing to do
+    ((slirp_network*)opaque)->register_poll_fd(fd);
 }
 
 static void slirp_unregister_poll_fd(int fd, void* opaque) {
-    // nothing to do
+    ((slirp_network*)opaque)->unregister_poll_fd(fd);
 }
 
 static void slirp_notify(void* opaque) {
-    // nothing to do
+    ((slirp_network*)opaque)->notify();
 }
 
 static const SlirpCb SLIRP_CBS = {
@@ -126,27 +105,222 @@ static const SlirpCb SLIRP_CBS = {
     /* notify             = */ slirp_notify,
 };
 
+static u32 epoll_events(int events) {
+    u32 result = 0;
+    if (events & SLIRP_POLL_IN)
+        result |= EPOLLIN;
+    if (events & SLIRP_POLL_OUT)
+        result |= EPOLLOUT;
+    if (events & SLIRP_POLL_PRI)
+        result |= EPOLLPRI;
+    return result; // EPOLLERR and EPOLLHUP are always reported
+}
+
+static int slirp_events(u32 events) {
+    int result = 0;
+    if (events & EPOLLIN)
+        result |= SLIRP_POLL_IN;
+    if (events & EPOLLOUT)
+        result |= SLIRP_POLL_OUT;
+    if (events & EPOLLPRI)
+        result |= SLIRP_POLL_PRI;
+    if (events & EPOLLERR)
+        result |= SLIRP_POLL_ERR;
+    if (events & EPOLLHUP)
+        result |= SLIRP_POLL_HUP;
+    return result;
+}
+
+void slirp_network::epoll_update(int fd, poll_entry& entry, u32 events) {
+    if (entry.events == events)
+        return;
+
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+
+    int op = EPOLL_CTL_MOD;
+    if (events == 0)
+        op = EPOLL_CTL_DEL;
+    else if (entry.events == 0)
+        op = EPOLL_CTL_ADD;
+
+    // the kernel drops registrations of closed descriptors by itself, so
+    // the descriptor may have been reused without us noticing
+    int err = epoll_ctl(m_epfd, op, fd, &ev);
+    if (err < 0 && errno == ENOENT && op == EPOLL_CTL_MOD)
+        err = epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev);
+    if (err < 0 && errno == EEXIST && op == EPOLL_CTL_ADD)
+        err = epoll_ctl(m_epfd, EPOLL_CTL_MOD, fd, &ev);
+    if (err < 0 && op != EPOLL_CTL_DEL)
+        log_debug("slirp: epoll_ctl(%d): %s", fd, strerror(errno));
+
+    entry.events = events;
+}
+
+int slirp_network::add_poll_fd(int fd, int events) {
+    poll_entry& entry = m_fds[fd];
+    entry.round = m_round;
+    epoll_update(fd, entry, epoll_events(events));
+    return fd; // slirp passes this back to get_events
+}
+
+int slirp_network::get_events(int fd) {
+    auto it = m_fds.find(fd);
+    return it != m_fds.end() ? slirp_events(it->second.revents) : 0;
+}
+
+void slirp_network::register_poll_fd(int fd) {
+    m_fds[fd] = poll_entry();
+}
+
+void slirp_network::unregister_poll_fd(int fd) {
+    auto it = m_fds.find(fd);
+    if (it == m_fds.end())
+        return;
+
+    epoll_update(fd, it->second, 0);
+    m_fds.erase(it);
+}
+
+void* slirp_network::timer_new(SlirpTimerCb cb, void* obj) {
+    slirp_timer* t = new slirp_timer{ cb, obj, -1 };
+    m_timers.push_back(t);
+    return t;
+}
+
+void slirp_network::timer_free(void* t) {
+    if (t == nullptr)
+        return;
+
+    stl_remove(m_timers, (slirp_timer*)t);
+    delete (slirp_timer*)t;
+    timer_rearm();
+}
+
+void slirp_network::timer_mod(void* t, i64 expire_ms) {
+    ((slirp_timer*)t)->expire = expire_ms;
+    timer_rearm();
+}
+
+void slirp_network::timer_rearm() {
+    i64 next = -1;
+    for (slirp_timer* t : m_timers) {
+        if (t->expire >= 0 && (next < 0 || t->expire < next))
+            next = t->expire;
+    }
+
+    // a zero itimerspec disarms the timer, so never pass zero when armed
+    struct itimerspec its = {};
+    if (next >= 0) {
+        i64 delta = max<i64>(next * 1000000 - host_clock_ns(), 1);
+        its.it_value.tv_sec = delta / 1000000000;
+        its.it_value.tv_nsec = delta % 1000000000;
+    }
+
+    if (timerfd_settime(m_timerfd, 0, &its, nullptr) < 0)
+        log_warn("slirp: cannot arm timer: %s", strerror(errno));
+}
+
+void slirp_network::timer_expire() {
+    u64 ticks;
+    if (read(m_timerfd, &ticks, sizeof(ticks)) < 0 && errno != EAGAIN)
+        log_debug("slirp: timerfd: %s", strerror(errno));
+
+    // callbacks may modify or free timers, so only run those that are
+    // still registered and have not been moved in the meantime
+    i64 now = host_clock_ns() / 1000000;
+    vector<slirp_timer*> expired;
+    for (slirp_timer* t : m_timers) {
+        if (t->expire >= 0 && t->expire <= now)
+            expired.push_back(t);
+    }
+
+    for (slirp_timer* t : expired) {
+        if (stl_contains(m_timers, t) && t->expire >= 0 && t->expire <= now) {
+            t->expire = -1;
+            t->cb(t->obj);
+        }
+    }
+
+    timer_rearm();
+}
+
+void slirp_network::notify() {
+    u64 one = 1;
+    if (write(m_eventfd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        log_debug("slirp: eventfd: %s", strerror(errno));
+}
+
+void slirp_network::flush_packets() {
+    // hand everything slirp produced in one go to the guest side
+    for (const eth_frame& frame : m_pending) {
+        for (auto client : m_clients)
+            client->send_to_guest(frame);
+    }
+
+    m_pending.clear();
+}
+
 void slirp_network::slirp_thread() {
     mwr::set_thread_name(mkstr("slirp_%u", m_id));
 
+    vector<struct epoll_event> events(64);
     while (m_running) {
         unsigned int timeout = 10; // ms
-        vector<pollfd> fds;
 
         m_mtx.lock();
-        slirp_pollfds_fill(m_slirp, &timeout, &slirp_add_poll_fd, &fds);
+        m_round++;
+        slirp_pollfds_fill(m_slirp, &timeout, &slirp_add_poll_fd, this);
+
+        // descriptors slirp did not ask for this round leave the epoll set
+        for (auto it = m_fds.begin(); it != m_fds.end();) {
+            if (it->second.round == m_round) {
+                it++;
+                continue;
+            }
+
+            epoll_update(it->first, it->second, 0);
+            it = m_fds.erase(it);
+        }
+
         m_mtx.unlock();
 
-        if (fds.empty()) {
-            mwr::usleep(timeout * 1000);
-            continue;
+        int n = epoll_wait(m_epfd, events.data(), events.size(), timeout);
+        bool error = n < 0 && errno != EINTR;
+
+        lock_guard<mutex> guard(m_mtx);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == m_timerfd) {
+                timer_expire();
+            } else if (fd == m_eventfd) {
+                u64 count;
+                if (read(m_eventfd, &count, sizeof(count)) < 0)
+                    log_debug("slirp: eventfd: %s", strerror(errno));
+            } else {
+                auto it = m_fds.find(fd);
+                if (it != m_fds.end()) {
+                    it->second.revents = events[i].events;
+                    m_ready.push_back(fd);
+                }
+            }
         }
 
-        int ret = poll(fds.data(), fds.size(), timeout);
-        if (ret != 0) {
-            lock_guard<mutex> guard(m_mtx);
-            slirp_pollfds_poll(m_slirp, ret < 0, &slirp_get_events, &fds);
+        // also needed after timeouts, slirp runs its tcp timers from here
+        slirp_pollfds_poll(m_slirp, error, &slirp_get_events, this);
+
+        for (int fd : m_ready) {
+            auto it = m_fds.find(fd);
+            if (it != m_fds.end())
+                it->second.revents = 0;
         }
+
+        m_ready.clear();
+        flush_packets();
+
+        if (n == (int)events.size())
+            events.resize(events.size() * 2);
     }
 }
 
@@ -155,9 +329,32 @@ slirp_network::slirp_network(unsigned int id):
     m_config(),
     m_slirp(),
     m_clients(),
+    m_epfd(-1),
+    m_timerfd(-1),
+    m_eventfd(-1),
+    m_round(0),
+    m_fds(),
+    m_ready(),
+    m_timers(),
+    m_pending(),
     m_mtx(),
     m_running(true),
     m_thread() {
+    m_epfd = epoll_create1(EPOLL_CLOEXEC);
+    VCML_REPORT_ON(m_epfd < 0, "epoll_create1: %s", strerror(errno));
+    m_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    VCML_REPORT_ON(m_timerfd < 0, "timerfd_create: %s", strerror(errno));
+    m_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    VCML_REPORT_ON(m_eventfd < 0, "eventfd: %s", strerror(errno));
+
+    for (int fd : { m_timerfd, m_eventfd }) {
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+            VCML_REPORT("epoll_ctl: %s", strerror(errno));
+    }
+
     m_config.version = 1;
 
     m_config.in_enabled = true;
@@ -199,25 +396,34 @@ slirp_network::slirp_network(unsigned int id):
 
 slirp_network::~slirp_network() {
     m_running = false;
-    if (m_thread.joinable())
+    if (m_thread.joinable()) {
+        notify();
         m_thread.join();
+    }
 
     for (auto client : m_clients)
         client->disconnect();
 
     if (m_slirp)
         slirp_cleanup(m_slirp);
+
+    for (slirp_timer* t : m_timers)
+        delete t;
+
+    for (int fd : { m_eventfd, m_timerfd, m_epfd }) {
+        if (fd >= 0)
+            close(fd);
+    }
 }
 
 void slirp_network::send_packet(const u8* ptr, size_t len) {
-    eth_frame frame(ptr, len);
-    for (auto client : m_clients)
-        client->send_to_guest(frame);
+    m_pending.emplace_back(ptr, len);
 }
 
 void slirp_network::recv_packet(const u8* ptr, size_t len) {
     lock_guard<mutex> guard(m_mtx);
     slirp_input(m_slirp, ptr, len);
+    flush_packets();
 }
 
 void slirp_network::register_client(backend_slirp* client) {
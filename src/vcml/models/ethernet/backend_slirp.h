@@ -35,16 +35,57 @@ private:
 
     set<backend_slirp*> m_clients;
 
+    // epoll registrations persist across rounds and are only updated when
+    // slirp changes its interest in a descriptor
+    struct poll_entry {
+        u32 events;
+        u32 revents;
+        u64 round;
+    };
+
+    struct slirp_timer {
+        SlirpTimerCb cb;
+        void* obj;
+        i64 expire; // host time in ms, negative when inactive
+    };
+
+    int m_epfd;
+    int m_timerfd;
+    int m_eventfd;
+    u64 m_round;
+
+    unordered_map<int, poll_entry> m_fds;
+    vector<int> m_ready;
+    vector<slirp_timer*> m_timers;
+    vector<eth_frame> m_pending;
+
     mutex m_mtx;
     atomic<bool> m_running;
     thread m_thread;
 
+    void epoll_update(int fd, poll_entry& entry, u32 events);
+    void timer_rearm();
+    void timer_expire();
+    void flush_packets();
+
     void slirp_thread();
 
 public:
     slirp_network(unsigned int id);
     virtual ~slirp_network();
 
+    // libslirp callbacks, always invoked with m_mtx held
+    int add_poll_fd(int fd, int events);
+    int get_events(int fd);
+    void register_poll_fd(int fd);
+    void unregister_poll_fd(int fd);
+
+    void* timer_new(SlirpTimerCb cb, void* obj);
+    void timer_free(void* t);
+    void timer_mod(void* t, i64 expire_ms);
+
+    void notify();
+
     void send_packet(const u8* ptr, size_t len);
     void recv_packet(const u8* ptr, size_t len);
 
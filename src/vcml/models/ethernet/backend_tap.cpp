@@ -12,6 +12,8 @@
 #include <sys/stat.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <unistd.h>
@@ -23,70 +25,243 @@
 namespace vcml {
 namespace ethernet {
 
-static bool tap_read(int fd, vector<u8>& buf) {
-    size_t len;
-    buf.resize(eth_frame::FRAME_MAX_SIZE);
+// struct virtio_net_hdr as exchanged with the kernel using IFF_VNET_HDR
+struct tap_vnet_hdr {
+    u8 flags;
+    u8 gso_type;
+    u16 hdr_len;
+    u16 gso_size;
+    u16 csum_start;
+    u16 csum_offset;
+};
 
+enum tap_vnet_flags : u8 {
+    TAP_VNET_F_NEEDS_CSUM = bit(0),
+    TAP_VNET_F_DATA_VALID = bit(1),
+};
+
+// gso frames from the kernel can be up to 64KiB in size
+static const size_t TAP_MAX_FRAME = 64 * KiB + eth_frame::FRAME_HEADER_SIZE;
+
+// maximum number of frames read from the device per wake-up
+static const size_t TAP_RX_BATCH = 64;
+
+static bool tap_read(int fd, eth_frame& frame) {
+    // read into scratch space first, so that regular sized frames do not
+    // hold on to a large pool buffer
+    static thread_local vector<u8> buffer(TAP_MAX_FRAME);
+    tap_vnet_hdr hdr{};
+
+    struct iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = buffer.data();
+    iov[1].iov_len = buffer.size();
+
+    ssize_t len;
     do {
-        len = read(fd, buf.data(), buf.size());
+        len = readv(fd, iov, 2);
     } while (len < 0 && errno == EINTR);
 
     if (len < 0)
         return false;
 
-    buf.resize(len);
+    if (len < (ssize_t)iov[0].iov_len) {
+        errno = EIO;
+        return false;
+    }
+
+    frame.resize(len - iov[0].iov_len);
+    memcpy(frame.data(), buffer.data(), frame.size());
+    frame.csum_partial = hdr.flags & TAP_VNET_F_NEEDS_CSUM;
+    frame.csum_valid = hdr.flags & TAP_VNET_F_DATA_VALID;
+    frame.csum_start = hdr.csum_start;
+    frame.csum_offset = hdr.csum_offset;
+    frame.gso_type = hdr.gso_type;
+    frame.gso_size = hdr.gso_size;
+
+    // drop anything we cannot hand on, e.g. udp fragmentation offload
+    if (frame.gso_type != eth_frame::GSO_NONE &&
+        frame.gso_type != eth_frame::GSO_TCPV4 &&
+        frame.gso_type != eth_frame::GSO_TCPV6) {
+        frame.clear();
+    }
+
     return true;
 }
 
-void backend_tap::close_tap() {
-    if (m_fd >= 0) {
-        mwr::aio_cancel(m_fd);
-        close(m_fd);
-        m_fd = -1;
-    }
+static bool tap_write(int fd, const eth_frame& frame) {
+    tap_vnet_hdr hdr{};
+    if (frame.csum_partial)
+        hdr.flags |= TAP_VNET_F_NEEDS_CSUM;
+    else if (frame.csum_valid)
+        hdr.flags |= TAP_VNET_F_DATA_VALID;
+
+    hdr.gso_type = frame.gso_type;
+    hdr.gso_size = frame.gso_size;
+    hdr.csum_start = frame.csum_start;
+    hdr.csum_offset = frame.csum_offset;
+
+    struct iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = (void*)frame.data();
+    iov[1].iov_len = frame.size();
+
+    ssize_t len;
+    do {
+        len = writev(fd, iov, 2);
+    } while (len < 0 && errno == EINTR);
+
+    return len == (ssize_t)(sizeof(hdr) + frame.size());
 }
 
-backend_tap::backend_tap(bridge* br, int devno): backend(br) {
-    m_fd = open("/dev/net/tun", O_RDWR);
-    VCML_REPORT_ON(m_fd < 0, "error opening tundev: %s", strerror(errno));
+int backend_tap::open_queue(int devno, size_t queues) {
+    int fd = open("/dev/net/tun", O_RDWR);
+    VCML_REPORT_ON(fd < 0, "error opening tundev: %s", strerror(errno));
 
     struct ifreq ifr;
     memset(&ifr, 0, sizeof(ifr));
-    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI | IFF_VNET_HDR;
+    if (queues > 1)
+        ifr.ifr_flags |= IFF_MULTI_QUEUE;
     snprintf(ifr.ifr_name, IFNAMSIZ, "tap%d", devno);
 
-    int err = ioctl(m_fd, TUNSETIFF, (void*)&ifr);
-    VCML_REPORT_ON(err < 0, "error creating tapdev: %s", strerror(errno));
-    log_info("using tap device %s", ifr.ifr_name);
+    if (ioctl(fd, TUNSETIFF, (void*)&ifr) < 0) {
+        close(fd);
+        VCML_REPORT("error creating tapdev: %s", strerror(errno));
+    }
+
+    // the kernel finishes checksums and segmentation of outgoing frames
+    // based on their vnet header, this also allows it to send us frames
+    // with partial checksums and without segmentation
+    unsigned int offl = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+    if (ioctl(fd, TUNSETOFFLOAD, offl) < 0)
+        log_debug("tap receive offloads disabled: %s", strerror(errno));
+
+    // reads are non-blocking so that each wake-up drains the device
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(fd);
+        VCML_REPORT("error configuring tapdev: %s", strerror(errno));
+    }
+
+    return fd;
+}
+
+void backend_tap::close_tap() {
+    m_running = false;
+    for (thread& t : m_readers)
+        if (t.joinable())
+            t.join();
+    m_readers.clear();
+
+    for (int fd : m_fds) {
+        if (m_fds.size() == 1)
+            mwr::aio_cancel(fd);
+        close(fd);
+    }
+
+    m_fds.clear();
+}
+
+backend_tap::backend_tap(bridge* br, int devno, size_t queues):
+    backend(br), m_fds(), m_readers(), m_running(true) {
+    VCML_REPORT_ON(queues == 0, "tap device needs at least one queue");
+
+    try {
+        for (size_t q = 0; q < queues; q++)
+            m_fds.push_back(open_queue(devno, queues));
+    } catch (...) {
+        close_tap();
+        throw;
+    }
 
-    m_type = mkstr("tap:%d", devno);
+    if (queues > 1) {
+        log_info("using tap device tap%d with %zu queues", devno, queues);
+        m_type = mkstr("tap:%d,%zu", devno, queues);
+    } else {
+        log_info("using tap device tap%d", devno);
+        m_type = mkstr("tap:%d", devno);
+    }
 
-    mwr::aio_notify(m_fd, [&](int fd) -> void {
+    // a single queue is served by the aio thread, multiple queues use one
+    // reader thread each so that receiving scales with the queues
+    if (queues == 1) {
+        mwr::aio_notify(m_fds[0], [&](int fd) -> void {
+            if (!receive_batch(fd))
+                mwr::aio_cancel(fd);
+        });
+    } else {
+        for (size_t q = 0; q < queues; q++)
+            m_readers.emplace_back(&backend_tap::reader, this, q);
+    }
+}
+
+bool backend_tap::receive_batch(int fd) {
+    // tap devices are no sockets, so recvmmsg is not available; we read
+    // until the device runs dry instead, but stop after a batch to let
+    // the aio thread serve other file descriptors too
+    for (size_t i = 0; i < TAP_RX_BATCH; i++) {
         eth_frame frame;
         if (!tap_read(fd, frame)) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true;
+
             log_error("error reading tap device: %s", strerror(errno));
-            mwr::aio_cancel(fd);
+            return false;
+        }
+
+        if (!frame.empty())
+            send_to_guest(std::move(frame));
+    }
+
+    return true;
+}
+
+void backend_tap::reader(size_t queue) {
+    mwr::set_thread_name(mkstr("tap_rx%zu", queue));
+    int fd = m_fds[queue];
+    while (m_running) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int n = poll(&pfd, 1, 100); // 100ms, to notice shutdown
+        if (n < 0 && errno != EINTR) {
+            log_error("error polling tap device: %s", strerror(errno));
             return;
         }
 
-        send_to_guest(std::move(frame));
-    });
+        if (n > 0 && !receive_batch(fd))
+            return;
+    }
 }
 
 backend_tap::~backend_tap() {
     close_tap();
 }
 
+u32 backend_tap::offloads() const {
+    return ETH_OFFLOAD_ALL;
+}
+
 void backend_tap::send_to_host(const eth_frame& frame) {
-    if (m_fd >= 0)
-        mwr::fd_write(m_fd, frame.data(), frame.size());
+    if (m_fds.empty())
+        return;
+
+    // keep each flow on one queue, so the host sees it in order
+    int fd = m_fds[0];
+    if (m_fds.size() > 1)
+        fd = m_fds[frame.flow_hash() % m_fds.size()];
+
+    if (!tap_write(fd, frame))
+        log_warn("error writing tap device: %s", strerror(errno));
 }
 
 backend* backend_tap::create(bridge* br, const string& type) {
     unsigned int devno = 0;
-    if (sscanf(type.c_str(), "tap:%u", &devno) != 1)
+    unsigned int queues = 1;
+    if (sscanf(type.c_str(), "tap:%u,%u", &devno, &queues) < 1)
         devno = 0;
-    return new backend_tap(br, devno);
+    return new backend_tap(br, devno, queues);
 }
 
 } // namespace ethernet
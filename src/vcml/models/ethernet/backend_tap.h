@@ -20,17 +20,30 @@
 namespace vcml {
 namespace ethernet {
 
+// tap:<devno>[,<queues>] attaches to the host tap device tap<devno>; with
+// more than one queue, the device is opened with IFF_MULTI_QUEUE, each
+// queue gets its own reader thread and frames for the host are spread
+// over the queues by their flow
 class backend_tap : public backend
 {
 private:
-    int m_fd;
+    vector<int> m_fds;
+    vector<thread> m_readers;
+    atomic<bool> m_running;
 
+    int open_queue(int devno, size_t queues);
     void close_tap();
+    bool receive_batch(int fd);
+    void reader(size_t queue);
 
 public:
-    backend_tap(bridge* br, int devno);
+    size_t num_queues() const { return m_fds.size(); }
+
+    backend_tap(bridge* br, int devno, size_t queues = 1);
     virtual ~backend_tap();
 
+    virtual u32 offloads() const override;
+
     virtual void send_to_host(const eth_frame& frame) override;
 
     static backend* create(bridge* br, const string& type);
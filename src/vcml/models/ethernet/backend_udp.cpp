@@ -0,0 +1,165 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/ethernet/backend_udp.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <endian.h>
+
+namespace vcml {
+namespace ethernet {
+
+struct udp_header {
+    u64 stamp; // simulation time of the sender in ns, big endian
+};
+
+// maximum number of datagrams read per wake-up
+static const size_t UDP_RX_BATCH = 64;
+
+void backend_udp::receive_batch(int fd) {
+    static thread_local vector<u8> buffer(64 * KiB);
+    for (size_t i = 0; i < UDP_RX_BATCH; i++) {
+        udp_header hdr;
+        struct iovec iov[2];
+        iov[0].iov_base = &hdr;
+        iov[0].iov_len = sizeof(hdr);
+        iov[1].iov_base = buffer.data();
+        iov[1].iov_len = buffer.size();
+
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+
+        ssize_t len = recvmsg(fd, &msg, MSG_DONTWAIT);
+        if (len < 0) {
+            // refused means the peer is not up yet, try again later
+            if (errno == EINTR || errno == ECONNREFUSED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                log_warn("error receiving from %s: %s", m_peer.c_str(),
+                         strerror(errno));
+            return;
+        }
+
+        if (len <= (ssize_t)sizeof(hdr) || (msg.msg_flags & MSG_TRUNC))
+            continue;
+
+        eth_frame frame(len - sizeof(hdr));
+        memcpy(frame.data(), buffer.data(), frame.size());
+
+        if (m_sync) {
+            double stamp = (double)be64toh(hdr.stamp);
+            send_to_guest(std::move(frame), sc_time(stamp, SC_NS));
+        } else {
+            send_to_guest(std::move(frame));
+        }
+    }
+}
+
+backend_udp::backend_udp(bridge* br, u16 port, const string& host,
+                         u16 peer_port, bool sync):
+    backend(br), m_fd(-1), m_sync(sync), m_peer() {
+    m_peer = mkstr("%s:%hu", host.c_str(), peer_port);
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    struct addrinfo* ai = nullptr;
+    string service = std::to_string(peer_port);
+    int err = getaddrinfo(host.c_str(), service.c_str(), &hints, &ai);
+    VCML_REPORT_ON(err, "cannot resolve %s: %s", host.c_str(),
+                   gai_strerror(err));
+
+    m_fd = socket(ai->ai_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        freeaddrinfo(ai);
+        VCML_REPORT("cannot create socket: %s", strerror(errno));
+    }
+
+    struct sockaddr_storage local = {};
+    socklen_t locallen = 0;
+    if (ai->ai_family == AF_INET6) {
+        struct sockaddr_in6* in6 = (struct sockaddr_in6*)&local;
+        in6->sin6_family = AF_INET6;
+        in6->sin6_addr = in6addr_any;
+        in6->sin6_port = htons(port);
+        locallen = sizeof(*in6);
+    } else {
+        struct sockaddr_in* in = (struct sockaddr_in*)&local;
+        in->sin_family = AF_INET;
+        in->sin_addr.s_addr = htonl(INADDR_ANY);
+        in->sin_port = htons(port);
+        locallen = sizeof(*in);
+    }
+
+    // connecting makes the kernel drop datagrams from anyone but the peer
+    bool ok = ::bind(m_fd, (struct sockaddr*)&local, locallen) == 0 &&
+              ::connect(m_fd, ai->ai_addr, ai->ai_addrlen) == 0;
+    freeaddrinfo(ai);
+
+    if (!ok) {
+        int error = errno;
+        close(m_fd);
+        m_fd = -1;
+        VCML_REPORT("cannot connect port %hu to %s: %s", port,
+                    m_peer.c_str(), strerror(error));
+    }
+
+    m_type = mkstr("udp:%hu:%s", port, m_peer.c_str());
+    log_debug("tunneling frames from port %hu to %s", port, m_peer.c_str());
+
+    mwr::aio_notify(m_fd, [&](int fd) -> void { receive_batch(fd); });
+}
+
+backend_udp::~backend_udp() {
+    if (m_fd >= 0) {
+        mwr::aio_cancel(m_fd);
+        close(m_fd);
+    }
+}
+
+void backend_udp::send_to_host(const eth_frame& frame) {
+    udp_header hdr;
+    hdr.stamp = htobe64(time_stamp_ns());
+
+    struct iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = (void*)frame.data();
+    iov[1].iov_len = frame.size();
+
+    ssize_t len;
+    do {
+        len = writev(m_fd, iov, 2);
+    } while (len < 0 && errno == EINTR);
+
+    // an unreachable peer is not an error, it may just not be started yet
+    if (len < 0 && errno != ECONNREFUSED)
+        log_debug("error sending to %s: %s", m_peer.c_str(), strerror(errno));
+}
+
+backend* backend_udp::create(bridge* br, const string& type) {
+    // udp:<port>:<host>:<peer_port>[:sync]
+    vector<string> args = split(type, ':');
+    VCML_REPORT_ON(args.size() < 4, "usage: udp:<port>:<host>:<port>[:sync]");
+
+    u16 port = from_string<u16>(args[1]);
+    u16 peer_port = from_string<u16>(args[3]);
+    bool sync = args.size() > 4 && args[4] == "sync";
+    return new backend_udp(br, port, args[2], peer_port, sync);
+}
+
+} // namespace ethernet
+} // namespace vcml
@@ -0,0 +1,51 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_ETHERNET_BACKEND_UDP_H
+#define VCML_ETHERNET_BACKEND_UDP_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/logging/logger.h"
+
+#include "vcml/models/ethernet/backend.h"
+#include "vcml/models/ethernet/bridge.h"
+
+namespace vcml {
+namespace ethernet {
+
+// tunnels frames to a peer simulation on another host, each frame is sent
+// as one udp datagram prefixed with the simulation time of the sender
+class backend_udp : public backend
+{
+private:
+    int m_fd;
+    bool m_sync;
+    string m_peer;
+
+    void receive_batch(int fd);
+
+public:
+    const char* peer() const { return m_peer.c_str(); }
+
+    backend_udp(bridge* br, u16 port, const string& host, u16 peer_port,
+                bool sync);
+    virtual ~backend_udp();
+
+    virtual void send_to_host(const eth_frame& frame) override;
+
+    static backend* create(bridge* br, const string& type);
+};
+
+} // namespace ethernet
+} // namespace vcml
+
+#endif
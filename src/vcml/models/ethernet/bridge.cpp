@@ -13,6 +13,103 @@
 namespace vcml {
 namespace ethernet {
 
+static u64 next_bridge_id() {
+    static atomic<u64> id(0);
+    return ++id;
+}
+
+// offload metadata is recorded along with the frame data
+struct replay_meta {
+    u8 csum_partial;
+    u8 csum_valid;
+    u16 csum_start;
+    u16 csum_offset;
+    u8 gso_type;
+    u8 reserved;
+    u16 gso_size;
+};
+
+void bridge::record_frame(const eth_frame& frame) {
+    if (!m_replay.is_recording())
+        return;
+
+    replay_meta meta = {};
+    meta.csum_partial = frame.csum_partial;
+    meta.csum_valid = frame.csum_valid;
+    meta.csum_start = frame.csum_start;
+    meta.csum_offset = frame.csum_offset;
+    meta.gso_type = frame.gso_type;
+    meta.gso_size = frame.gso_size;
+
+    vector<u8> data(sizeof(meta) + frame.size());
+    memcpy(data.data(), &meta, sizeof(meta));
+    memcpy(data.data() + sizeof(meta), frame.data(), frame.size());
+    m_replay.record(data.data(), data.size());
+}
+
+void bridge::replay_frame(const u8* data, size_t size) {
+    replay_meta meta;
+    VCML_ERROR_ON(size < sizeof(meta), "invalid replay frame");
+    memcpy(&meta, data, sizeof(meta));
+
+    eth_frame frame(data + sizeof(meta), size - sizeof(meta));
+    frame.csum_partial = meta.csum_partial;
+    frame.csum_valid = meta.csum_valid;
+    frame.csum_start = meta.csum_start;
+    frame.csum_offset = meta.csum_offset;
+    frame.gso_type = meta.gso_type;
+    frame.gso_size = meta.gso_size;
+    eth_tx.send(frame);
+}
+
+bridge::rx_ring::rx_ring(size_t capacity):
+    frames(capacity), head(0), tail(0) {
+}
+
+bridge::rx_ring* bridge::local_ring() {
+    // one ring per sending thread and bridge keeps every ring single
+    // producer, the mutex is only needed when a new thread shows up
+    thread_local unordered_map<u64, rx_ring*> rings;
+    auto it = rings.find(m_id);
+    if (it != rings.end())
+        return it->second;
+
+    lock_guard<mutex> guard(m_rings_mtx);
+    m_rings.push_back(std::make_unique<rx_ring>(max<size_t>(rx_capacity, 2)));
+    return rings[m_id] = m_rings.back().get();
+}
+
+size_t bridge::drain_rings() {
+    vector<rx_ring*> rings;
+    {
+        lock_guard<mutex> guard(m_rings_mtx);
+        for (auto& r : m_rings)
+            rings.push_back(r.get());
+    }
+
+    size_t count = 0;
+    for (rx_ring* r : rings) {
+        size_t tail = r->tail.load(std::memory_order_relaxed);
+        while (tail != r->head.load(std::memory_order_acquire)) {
+            rx_entry& entry = r->frames[tail];
+            eth_frame frame(std::move(entry.frame));
+            sc_time delivery = entry.delivery;
+            tail = (tail + 1) % r->frames.size();
+            r->tail.store(tail, std::memory_order_release);
+
+            // frames from time-synchronized peers never arrive early
+            if (delivery > sc_time_stamp())
+                wait(delivery - sc_time_stamp());
+
+            record_frame(frame);
+            eth_tx.send(frame);
+            count++;
+        }
+    }
+
+    return count;
+}
+
 bool bridge::cmd_create_backend(const vector<string>& args, ostream& os) {
     try {
         size_t id = create_backend(args[0]);
@@ -60,19 +157,27 @@ bool bridge::cmd_list_backends(const vector<string>& args, ostream& os) {
     return true;
 }
 
+u32 bridge::eth_rx_offloads() const {
+    return ETH_OFFLOAD_ALL; // resolved per backend in send_to_host
+}
+
 void bridge::eth_receive(const eth_frame& frame) {
     send_to_host(frame);
 }
 
 void bridge::eth_transmit() {
+    size_t dropped = 0;
     while (true) {
         wait(m_ev);
 
-        lock_guard<mutex> guard(m_mtx);
-        while (!m_rx.empty()) {
-            eth_frame frame = std::move(m_rx.front());
-            m_rx.pop();
-            eth_tx.send(frame);
+        // clear first, so that frames arriving during draining notify again
+        m_rx_pending = false;
+        drain_rings();
+
+        if (dropped != m_rx_dropped) {
+            log_warn("dropped %zu frames due to full rx rings",
+                     m_rx_dropped - dropped);
+            dropped = m_rx_dropped;
         }
     }
 }
@@ -88,10 +193,15 @@ bridge::bridge(const sc_module_name& nm):
     m_next_id(),
     m_dynamic_backends(),
     m_backends(),
-    m_mtx(),
-    m_rx(),
+    m_id(next_bridge_id()),
+    m_rings_mtx(),
+    m_rings(),
+    m_rx_pending(false),
+    m_rx_dropped(0),
     m_ev("rxev"),
+    m_replay(name()),
     backends("backends", ""),
+    rx_capacity("rx_capacity", 1024),
     eth_tx("eth_tx"),
     eth_rx("eth_rx") {
     bridges()[name()] = this;
@@ -105,6 +215,10 @@ bridge::bridge(const sc_module_name& nm):
         }
     }
 
+    m_replay.replay([this](const u8* data, size_t size) -> void {
+        replay_frame(data, size);
+    });
+
     SC_HAS_PROCESS(bridge);
     SC_THREAD(eth_transmit);
 
@@ -126,14 +240,47 @@ bridge::~bridge() {
 }
 
 void bridge::send_to_host(const eth_frame& frame) {
-    for (backend* b : m_backends)
-        b->send_to_host(frame);
+    vector<eth_frame> resolved;
+    for (backend* b : m_backends) {
+        if (!(frame.offloads() & ~b->offloads())) {
+            b->send_to_host(frame);
+            continue;
+        }
+
+        if (resolved.empty() && !frame.resolve_offloads(resolved)) {
+            log_warn("dropping malformed offload frame");
+            return;
+        }
+
+        for (const eth_frame& f : resolved)
+            b->send_to_host(f);
+    }
 }
 
 void bridge::send_to_guest(eth_frame frame) {
-    lock_guard<mutex> guard(m_mtx);
-    m_rx.push(std::move(frame));
-    on_next_update([&]() -> void { m_ev.notify(SC_ZERO_TIME); });
+    send_to_guest(std::move(frame), SC_ZERO_TIME);
+}
+
+void bridge::send_to_guest(eth_frame frame, const sc_time& delivery) {
+    if (m_replay.is_replaying())
+        return; // frames are replayed from the recording instead
+
+    rx_ring* r = local_ring();
+    size_t head = r->head.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % r->frames.size();
+
+    // never block the backend threads, drop frames if the ring is full
+    if (next == r->tail.load(std::memory_order_acquire)) {
+        m_rx_dropped++;
+        return;
+    }
+
+    r->frames[head].frame = std::move(frame);
+    r->frames[head].delivery = delivery;
+    r->head.store(next, std::memory_order_release);
+
+    if (!m_rx_pending.exchange(true))
+        on_next_update([this]() -> void { m_ev.notify(SC_ZERO_TIME); });
 }
 
 void bridge::attach(backend* b) {
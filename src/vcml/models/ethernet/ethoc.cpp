@@ -200,44 +200,58 @@ void ethoc::rx_poll() {
         m_rx_idx = num_txbd();
 }
 
+static string hexdump(const u8* data, size_t size) {
+    stringstream ss;
+    for (size_t i = 0; i < size; i++) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << (int)data[i]
+           << " ";
+    }
+
+    return ss.str();
+}
+
 bool ethoc::tx_packet(u32 addr, u32 length) {
     if (length > ETH_MAX_PACKET_LEN) {
         log_warn("packet size %d exceeds max, ignored", length);
         return false;
     }
 
-    vector<u8> buffer(length);
-    tlm_response_status rs = out.read(addr, buffer.data(), buffer.size());
-    if (failed(rs)) {
-        log_warn("tx error  %s while reading from 0x%08x",
-                 tlm_response_to_str(rs), addr);
-        return false;
+    // copy straight out of guest memory if possible, the frame buffer is
+    // taken from the pool, so no further copies are needed to send it
+    eth_frame frame(length);
+    const u8* ptr = out.lookup_dmi_ptr(addr, length, VCML_ACCESS_READ);
+    if (ptr && length > 0) {
+        memcpy(frame.data(), ptr, length);
+    } else if (length > 0) {
+        tlm_response_status rs = out.read(addr, frame.data(), length);
+        if (failed(rs)) {
+            log_warn("tx error  %s while reading from 0x%08x",
+                     tlm_response_to_str(rs), addr);
+            return false;
+        }
     }
 
-    stringstream ss;
-    for (unsigned int i = 0; i < length; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)buffer[i]
-           << " ";
+    if (log.can_log(LOG_DEBUG)) {
+        const eth_frame& cf = frame;
+        log_debug("sending packet:\n%s", hexdump(cf.data(), length).c_str());
     }
 
-    log_debug("sending packet:\n%s", ss.str().c_str());
-    eth_tx.send(buffer);
-
+    eth_tx.send(frame);
     return true;
 }
 
 bool ethoc::rx_packet(u32 addr, u32& size) {
-    eth_frame frame;
-    if (!eth_rx_pop(frame))
+    eth_frame rx;
+    if (!eth_rx_pop(rx))
         return true;
 
-    stringstream ss;
-    for (u8 data : frame) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)data
-           << " ";
-    }
+    // read-only access, other receivers may still share the frame data
+    const eth_frame& frame = rx;
 
-    log_debug("received packet:\n%s", ss.str().c_str());
+    if (log.can_log(LOG_DEBUG)) {
+        log_debug("received packet:\n%s",
+                  hexdump(frame.data(), frame.size()).c_str());
+    }
 
     // promiscuous mode disabled, check destination HW address
     if (!(moder & MODER_PRO)) {
@@ -248,11 +262,16 @@ bool ethoc::rx_packet(u32 addr, u32& size) {
         }
     }
 
-    tlm_response_status rs = out.write(addr, frame.data(), frame.size());
-    if (failed(rs)) {
-        log_warn("rx error %s while writing to 0x%08x",
-                 tlm_response_to_str(rs), addr);
-        return false;
+    u8* ptr = out.lookup_dmi_ptr(addr, frame.size(), VCML_ACCESS_WRITE);
+    if (ptr) {
+        memcpy(ptr, frame.data(), frame.size());
+    } else {
+        tlm_response_status rs = out.write(addr, frame.data(), frame.size());
+        if (failed(rs)) {
+            log_warn("rx error %s while writing to 0x%08x",
+                     tlm_response_to_str(rs), addr);
+            return false;
+        }
     }
 
     size = (u32)frame.size();
@@ -260,11 +279,35 @@ bool ethoc::rx_packet(u32 addr, u32& size) {
 }
 
 void ethoc::interrupt(int source) {
+    // only per-frame completions are coalesced, errors are signaled now
+    bool frame_done = source == INT_SOURCE_TXB || source == INT_SOURCE_RXB;
+    if (frame_done && irq_batch > 1) {
+        m_irq_held |= source;
+        if (++m_irq_pending >= irq_batch)
+            flush_interrupts();
+        else if (m_irq_pending == 1)
+            m_irq_flush_ev.notify(irq_delay);
+        return;
+    }
+
     int_source |= source;
     if (int_mask & source)
         irq = true;
 }
 
+void ethoc::flush_interrupts() {
+    u32 held = m_irq_held;
+    m_irq_held = 0;
+    m_irq_pending = 0;
+    m_irq_flush_ev.cancel();
+
+    if (held) {
+        int_source |= held;
+        if (int_mask & held)
+            irq = true;
+    }
+}
+
 void ethoc::write_moder(u32 val) {
     if ((val & MODER_TXEN) && !m_tx_enabled) {
         log_debug("ethoc transmitter enabled");
@@ -461,6 +504,9 @@ ethoc::ethoc(const sc_module_name& nm):
     m_rx_enabled(false),
     m_tx_event("tx_ev"),
     m_rx_event("rx_ev"),
+    m_irq_held(0),
+    m_irq_pending(0),
+    m_irq_flush_ev("irq_flush_ev"),
     moder("MODER", 0x00, 0xa000),
     int_source("int_source", 0x04, 0),
     int_mask("int_mask", 0x08, 0),
@@ -484,6 +530,8 @@ ethoc::ethoc(const sc_module_name& nm):
     eth_txctrl("eth_txctrl", 0x50, 0),
     clock("clock", 20 * MHz), // input polling frequency
     mac("mac", "12:34:56:78:9a:bc"),
+    irq_batch("irq_batch", 0),
+    irq_delay("irq_delay", sc_time(100, SC_US)),
     irq("irq"),
     in("in"),
     out("out"),
@@ -496,6 +544,10 @@ ethoc::ethoc(const sc_module_name& nm):
     SC_THREAD(tx_process);
     SC_THREAD(rx_process);
 
+    SC_METHOD(flush_interrupts);
+    sensitive << m_irq_flush_ev;
+    dont_initialize();
+
     moder.allow_read_write();
     moder.on_write(&ethoc::write_moder);
 
@@ -567,6 +619,10 @@ void ethoc::reset() {
     m_tx_idx = 0;
     m_rx_idx = num_txbd();
 
+    m_irq_held = 0;
+    m_irq_pending = 0;
+    m_irq_flush_ev.cancel();
+
     irq = false;
 }
 
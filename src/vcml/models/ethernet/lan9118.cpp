@@ -597,10 +597,9 @@ bool lan9118_mac::filter(const mac_addr& dest) const {
 }
 
 void lan9118::reset_fifo_size(size_t txff_size) {
-    size_t sram_size = 16 * KiB;
-    size_t rxff_size = sram_size - txff_size;
+    size_t rxff_size = SRAM_SIZE - txff_size;
 
-    m_tx_status_fifo_size = 512;
+    m_tx_status_fifo_size = TX_STATUS_FIFO_SIZE;
     m_tx_data_fifo_size = txff_size - m_tx_status_fifo_size;
 
     m_rx_status_fifo_size = rxff_size / 16;
@@ -660,60 +659,110 @@ static size_t calc_rx_padding(u32 rxcfg, u32 len, u32 off) {
     }
 }
 
-bool lan9118::rx_enqueue(const vector<u8>& pkt) {
+lan9118::word_fifo::word_fifo(size_t bytes):
+    m_buf(bytes / 4), m_mask(bytes / 4 - 1), m_head(0), m_count(0) {
+    VCML_ERROR_ON(!is_pow2(bytes / 4), "fifo size must be a power of two");
+}
+
+void lan9118::word_fifo::push(u32 val) {
+    VCML_ERROR_ON(m_count == capacity(), "fifo overflow");
+    m_buf[(m_head + m_count++) & m_mask] = val;
+}
+
+void lan9118::word_fifo::push(const void* words, size_t count) {
+    VCML_ERROR_ON(m_count + count > capacity(), "fifo overflow");
+    const u8* src = (const u8*)words;
+    size_t tail = (m_head + m_count) & m_mask;
+    size_t first = min(count, capacity() - tail);
+    memcpy(m_buf.data() + tail, src, first * 4);
+    memcpy(m_buf.data(), src + first * 4, (count - first) * 4);
+    m_count += count;
+}
+
+void lan9118::word_fifo::push_zeros(size_t count) {
+    VCML_ERROR_ON(m_count + count > capacity(), "fifo overflow");
+    for (size_t i = 0; i < count; i++)
+        m_buf[(m_head + m_count + i) & m_mask] = 0;
+    m_count += count;
+}
+
+u32 lan9118::word_fifo::pop() {
+    VCML_ERROR_ON(m_count == 0, "fifo underflow");
+    u32 val = m_buf[m_head];
+    m_head = (m_head + 1) & m_mask;
+    m_count--;
+    return val;
+}
+
+size_t lan9118::word_fifo::pop(u32* words, size_t count) {
+    count = min(count, m_count);
+    size_t first = min(count, capacity() - m_head);
+    memcpy(words, m_buf.data() + m_head, first * 4);
+    memcpy(words + first, m_buf.data(), (count - first) * 4);
+    m_head = (m_head + count) & m_mask;
+    m_count -= count;
+    return count;
+}
+
+void lan9118::coalesce_irq() {
+    if (irq_batch <= 1) {
+        update_irq();
+        return;
+    }
+
+    if (++m_irq_pending >= irq_batch)
+        flush_irq();
+    else if (m_irq_pending == 1)
+        m_irq_flush_ev.notify(irq_delay);
+}
+
+void lan9118::flush_irq() {
+    m_irq_pending = 0;
+    m_irq_flush_ev.cancel();
+    update_irq();
+}
+
+bool lan9118::rx_enqueue(const u8* pkt, size_t size) {
     if (!(mac.cr & CR_RXEN))
         return false;
 
-    if (pkt.size() > 2048) {
+    if (size > 2048) {
         irq_sts |= IRQ_RWT;
         return false;
     }
 
-    if (pkt.size() < 14) {
-        log_warn("received short Ethernet frame: %zu bytes", pkt.size());
+    if (size < 14) {
+        log_warn("received short Ethernet frame: %zu bytes", size);
         return false;
     }
 
-    mac_addr dest(pkt);
-    bool filter = mac.filter(pkt);
+    mac_addr dest(pkt[0], pkt[1], pkt[2], pkt[3], pkt[4], pkt[5]);
+    bool filter = mac.filter(dest);
     if (!filter && (mac.cr & CR_RXALL) == 0)
         return true;
 
-    // not sure if this is the correct crc32 to use
-    u32 crc = crc32(pkt.data(), pkt.size());
+    // frame check sequence, as the mac appends it to every frame
+    u32 crc = crc32_eth(pkt, size);
 
     size_t offset = extract(rx_cfg.get(), 8, 5);
-    size_t padding = calc_rx_padding(rx_cfg, pkt.size(), offset);
-    size_t length = pkt.size() + sizeof(crc) + offset + padding * 4;
+    size_t padding = calc_rx_padding(rx_cfg, size, offset);
+    size_t length = size + sizeof(crc) + offset + padding * 4;
     if (rx_data_free() < length)
         return false;
 
-    while (offset > 4) {
-        m_rx_data_fifo.push_back(0);
-        offset -= 4;
-    }
+    m_rx_data_fifo.push_zeros(offset / 4);
 
-    u32 val = 0;
-    for (u8 src : pkt) {
-        val = (val >> 8) | (src << 24);
-        if (++offset == 4) {
-            m_rx_data_fifo.push_back(val);
-            val = offset = 0;
-        }
-    }
+    // stage the frame as the fifo sees it: offset bytes, data, crc and
+    // zero fill up to the next word, then move it over in whole words
+    size_t lead = offset % 4;
+    size_t nwords = (lead + size + sizeof(crc) + 3) / 4;
+    m_rx_stage.assign(nwords * 4, 0);
+    memcpy(m_rx_stage.data() + lead, pkt, size);
+    for (size_t i = 0; i < sizeof(crc); i++)
+        m_rx_stage[lead + size + i] = (crc >> (i * 8)) & 0xff;
 
-    if (offset > 0) {
-        val >>= (4 - offset) * 8;
-        val |= crc << (offset * 8);
-        m_rx_data_fifo.push_back(val);
-        val = crc >> (4 - offset) * 8;
-        m_rx_data_fifo.push_back(val);
-    } else {
-        m_rx_data_fifo.push_back(crc);
-    }
-
-    while (padding--)
-        m_rx_data_fifo.push_back(0);
+    m_rx_data_fifo.push(m_rx_stage.data(), nwords);
+    m_rx_data_fifo.push_zeros(padding);
 
     u32 status = (length << 16) & PKT_RXSTS_LEN_MASK;
     if (!filter)
@@ -722,7 +771,7 @@ bool lan9118::rx_enqueue(const vector<u8>& pkt) {
         status |= PKT_RXSTS_BROADCAST;
     else if (dest.is_multicast())
         status |= PKT_RXSTS_MULTICAST;
-    m_rx_status_fifo.push_back(status);
+    m_rx_status_fifo.push(status);
 
     return true;
 }
@@ -734,16 +783,21 @@ void lan9118::rx_thread() {
 
         sc_time delay = tlm_global_quantum::instance().get();
 
-        eth_frame frame;
-        if (eth_rx_pop(frame)) {
+        eth_frame rx;
+        if (eth_rx_pop(rx)) {
+            const eth_frame& frame = rx; // avoid unsharing the frame data
             delay = phy.rxtx_delay(frame.size());
-            if (!rx_enqueue(frame)) {
+            if (!rx_enqueue(frame.data(), frame.size())) {
                 irq_sts |= IRQ_RXDF;
                 rx_drop++;
+                update_irq();
+            } else {
+                coalesce_irq();
             }
+        } else if (m_irq_pending == 0) {
+            update_irq();
         }
 
-        update_irq();
         wait(delay);
     }
 }
@@ -756,7 +810,7 @@ void lan9118::tx_thread() {
             wait(m_txev);
         }
 
-        packet pkt = m_tx_packets.front();
+        packet pkt = std::move(m_tx_packets.front());
         m_tx_packets.pop_front();
 
         if (pkt.length < 64 && !(pkt.cmdb & CMDB_PAD_DIS)) {
@@ -765,7 +819,7 @@ void lan9118::tx_thread() {
         }
 
         if (phy.control & PHY_CONTROL_LOOPBACK)
-            rx_enqueue(pkt.data);
+            rx_enqueue(pkt.data.data(), pkt.data.size());
         else
             eth_tx.send(pkt.data);
 
@@ -775,12 +829,12 @@ void lan9118::tx_thread() {
         // status |= PKT_STS_ERROR;
 
         if (!tx_status_full())
-            m_tx_status_fifo.push_back(status);
+            m_tx_status_fifo.push(status);
 
         if (pkt.cmda & CMDA_TX_IOC)
             irq_sts |= IRQ_TXIOC;
 
-        update_irq();
+        coalesce_irq();
     }
 }
 
@@ -790,8 +844,7 @@ u32 lan9118::read_rx_data_fifo() {
         return 0;
     }
 
-    u32 val = m_rx_data_fifo.front();
-    m_rx_data_fifo.pop_front();
+    u32 val = m_rx_data_fifo.pop();
 
     u32 dma = rx_cfg.get_field<RX_CFG_DMA_COUNT>();
     if (dma > 0) {
@@ -805,6 +858,24 @@ u32 lan9118::read_rx_data_fifo() {
     return val;
 }
 
+void lan9118::read_rx_data_burst(u32* words, size_t count) {
+    size_t n = m_rx_data_fifo.pop(words, count);
+    if (n < count) {
+        memset(words + n, 0, (count - n) * 4);
+        irq_sts |= IRQ_RXE;
+    }
+
+    u32 dma = rx_cfg.get_field<RX_CFG_DMA_COUNT>();
+    if (dma > 0 && n > 0) {
+        dma -= min<size_t>(dma, n);
+        rx_cfg.set_field<RX_CFG_DMA_COUNT>(dma);
+        if (dma == 0) {
+            irq_sts |= IRQ_RXD;
+            update_irq();
+        }
+    }
+}
+
 static size_t calc_tx_padding(u32 cmda, size_t off, size_t length) {
     size_t ndw = (off + length) / 4;
     switch (cmda & CMDA_END_ALIGN_MASK) {
@@ -845,6 +916,9 @@ void lan9118::write_tx_data_fifo(u32 val) {
             m_tx_pkt.length = extract(val, 0, 11);
         }
 
+        if (m_tx_pkt.cmda & CMDA_FIRST)
+            m_tx_pkt.data.reserve(m_tx_pkt.length);
+
         if (val != m_tx_pkt.cmdb) {
             log_warn("TX error: CMDB mismatch");
             m_tx_pkt.reset();
@@ -860,6 +934,13 @@ void lan9118::write_tx_data_fifo(u32 val) {
     case packet::DATA:
         if (m_tx_pkt.offset >= 4) {
             m_tx_pkt.offset -= 4;
+        } else if (m_tx_pkt.offset == 0 && m_tx_pkt.remain >= 4) {
+            // whole words are the common case, append them in one go
+            m_tx_pkt.used_dw++;
+            u8 bytes[4] = { (u8)val, (u8)(val >> 8), (u8)(val >> 16),
+                            (u8)(val >> 24) };
+            m_tx_pkt.data.insert(m_tx_pkt.data.end(), bytes, bytes + 4);
+            m_tx_pkt.remain -= 4;
         } else if (m_tx_pkt.remain > 0) {
             m_tx_pkt.used_dw++;
             for (int i = 0; i < 4; i++, val >>= 8) {
@@ -896,15 +977,21 @@ void lan9118::write_tx_data_fifo(u32 val) {
     }
 }
 
+void lan9118::write_tx_data_burst(const u8* data, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        u32 val;
+        memcpy(&val, data + i * 4, sizeof(val));
+        write_tx_data_fifo(val);
+    }
+}
+
 u32 lan9118::read_rx_status_fifo() {
     if (m_rx_status_fifo.empty()) {
         irq_sts |= IRQ_RXE;
         return 0;
     }
 
-    u32 val = m_rx_status_fifo.front();
-    m_rx_status_fifo.pop_front();
-    return val;
+    return m_rx_status_fifo.pop();
 }
 
 u32 lan9118::read_rx_status_peek() {
@@ -920,9 +1007,7 @@ u32 lan9118::read_tx_status_fifo() {
     if (tx_status_full())
         m_txev.notify();
 
-    u32 val = m_tx_status_fifo.front();
-    m_tx_status_fifo.pop_front();
-    return val;
+    return m_tx_status_fifo.pop();
 }
 
 u32 lan9118::read_tx_status_peek() {
@@ -1157,10 +1242,15 @@ lan9118::lan9118(const sc_module_name& nm):
     m_tx_status_fifo_size(),
     m_tx_pkt(),
     m_tx_packets(),
-    m_tx_status_fifo(),
-    m_rx_data_fifo(),
-    m_rx_status_fifo(),
+    m_tx_status_fifo(TX_STATUS_FIFO_SIZE),
+    m_rx_data_fifo(SRAM_SIZE),
+    m_rx_stage(),
+    m_irq_pending(0),
+    m_irq_flush_ev("irq_flush_ev"),
+    m_rx_status_fifo(RX_STATUS_RING_SIZE),
     eeprom_mac("eeprom_mac", "12:34:56:78:9a:bc"),
+    irq_batch("irq_batch", 0),
+    irq_delay("irq_delay", sc_time(100, SC_US)),
     rx_data_fifo("rx_data_fifo", 0x00, 0x00000000),
     tx_data_fifo("tx_data_fifo", 0x20, 0x00000000),
     rx_status_fifo("rx_status_fifo", 0x40, 0x00000000),
@@ -1314,6 +1404,10 @@ lan9118::lan9118(const sc_module_name& nm):
     sensitive << m_deas_ev;
     dont_initialize();
 
+    SC_METHOD(flush_irq);
+    sensitive << m_irq_flush_ev;
+    dont_initialize();
+
     rst.bind(mac.rst);
     rst.bind(phy.rst);
     clk.bind(mac.clk);
@@ -1334,12 +1428,46 @@ lan9118::~lan9118() {
     // nothing to do
 }
 
+unsigned int lan9118::receive(tlm_generic_payload& tx, const tlm_sbi& info,
+                              address_space as) {
+    // streaming bursts into the data fifo ports move all their words in a
+    // single ring update instead of going through the registers per word
+    u64 addr = tx.get_address();
+    unsigned int length = tx.get_data_length();
+    unsigned int width = tx.get_streaming_width();
+    bool burst = !info.is_debug && as == VCML_AS_DEFAULT && width == 4 &&
+                 length > width && length % width == 0 && addr % 4 == 0 &&
+                 !tx.get_byte_enable_ptr() && endian == host_endian();
+
+    if (burst && tx.is_read() && rx_data_fifo.get_range().includes(addr)) {
+        sync();
+        read_rx_data_burst((u32*)tx.get_data_ptr(), length / 4);
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return length;
+    }
+
+    if (burst && tx.is_write() && tx_data_fifo.get_range().includes(addr)) {
+        sync();
+        write_tx_data_burst(tx.get_data_ptr(), length / 4);
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return length;
+    }
+
+    return peripheral::receive(tx, info, as);
+}
+
 void lan9118::reset() {
     m_eeprom.allow_read_only();
     m_last_reset = sc_time_stamp();
 
     m_tx_pkt.reset();
     m_tx_packets.clear();
+    m_tx_status_fifo.clear();
+    m_rx_data_fifo.clear();
+    m_rx_status_fifo.clear();
+
+    m_irq_pending = 0;
+    m_irq_flush_ev.cancel();
 
     reset_fifo_size(5 * KiB);
 
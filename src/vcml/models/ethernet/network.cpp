@@ -13,17 +13,135 @@
 namespace vcml {
 namespace ethernet {
 
+u16 network::vlan_of(const eth_frame& frame) const {
+    if (!vlans || frame.size() < eth_frame::FRAME_HEADER_SIZE + 4)
+        return 0;
+    if (bswap(frame.read<u16>(12)) != eth_frame::ETHER_TYPE_VLAN)
+        return 0;
+    return bswap(frame.read<u16>(14)) & 0xfff;
+}
+
+u64 network::table_key(const mac_addr& addr, u16 vlan) const {
+    return (u64)vlan << 48 | (u64)addr;
+}
+
+bool network::lookup(const mac_addr& dest, u16 vlan, size_t& port) {
+    auto it = m_table.find(table_key(dest, vlan));
+    if (it == m_table.end())
+        return false;
+
+    const sc_time& age = aging.get();
+    if (age != SC_ZERO_TIME && sc_time_stamp() - it->second.stamp > age) {
+        m_table.erase(it);
+        return false;
+    }
+
+    port = it->second.port;
+    return eth_tx.exists(port);
+}
+
+void network::learn(const mac_addr& src, u16 vlan, size_t port) {
+    if (!src.is_unicast())
+        return;
+
+    mac_entry& entry = m_table[table_key(src, vlan)];
+    entry.port = port;
+    entry.stamp = sc_time_stamp();
+}
+
+void network::forward(size_t port, const eth_frame& frame, bool flooded) {
+    port_stats& stats = m_stats[port];
+    stats.tx_frames++;
+    stats.tx_bytes += frame.size();
+    if (flooded)
+        stats.tx_flooded++;
+
+    // copies share the frame data, offloads are finished by each receiver
+    eth_frame copy(frame);
+    eth_tx[port].send(copy);
+}
+
 void network::eth_receive(const eth_target_socket& rx, const eth_frame& fr) {
-    const eth_initiator_socket& sender = peer_of(rx);
+    size_t sender = eth_rx.index_of(rx);
+    port_stats& stats = m_stats[sender];
+    stats.rx_frames++;
+    stats.rx_bytes += fr.size();
+
+    if (learning && fr.size() >= eth_frame::FRAME_HEADER_SIZE) {
+        u16 vlan = vlan_of(fr);
+        mac_addr dest = fr.destination();
+        learn(fr.source(), vlan, sender);
+
+        size_t port = 0;
+        if (dest.is_unicast() && lookup(dest, vlan, port)) {
+            if (port == sender)
+                stats.filtered++;
+            else
+                forward(port, fr, false);
+            return;
+        }
+    }
+
+    const eth_initiator_socket& peer = peer_of(rx);
     for (auto& tx : eth_tx) {
-        if (tx.second != &sender)
-            tx.second->send(fr);
+        if (tx.second != &peer)
+            forward(tx.first, fr, learning);
+    }
+}
+
+bool network::cmd_show_ports(const vector<string>& args, ostream& os) {
+    os << "ports: " << eth_tx.count();
+    for (const auto& tx : eth_tx) {
+        const port_stats& stats = m_stats[tx.first];
+        os << std::endl
+           << "port " << tx.first << ": "
+           << "rx " << stats.rx_frames << " frames, " << stats.rx_bytes
+           << " bytes, " << stats.filtered << " filtered; "
+           << "tx " << stats.tx_frames << " frames, " << stats.tx_bytes
+           << " bytes, " << stats.tx_flooded << " flooded";
     }
+
+    return true;
+}
+
+bool network::cmd_show_macs(const vector<string>& args, ostream& os) {
+    os << "learned addresses: " << m_table.size();
+    for (const auto& it : m_table) {
+        mac_addr addr((u8)(it.first >> 40), (u8)(it.first >> 32),
+                      (u8)(it.first >> 24), (u8)(it.first >> 16),
+                      (u8)(it.first >> 8), (u8)(it.first >> 0));
+        os << std::endl
+           << addr << " vlan " << (it.first >> 48) << " port "
+           << it.second.port << " age "
+           << (sc_time_stamp() - it.second.stamp);
+    }
+
+    return true;
+}
+
+bool network::cmd_flush_macs(const vector<string>& args, ostream& os) {
+    os << "flushed " << m_table.size() << " addresses";
+    m_table.clear();
+    return true;
 }
 
 network::network(const sc_module_name& nm):
-    module(nm), eth_host(), m_next_id(0), eth_tx("eth_tx"), eth_rx("eth_rx") {
-    // nothing to do
+    module(nm),
+    eth_host(),
+    m_next_id(0),
+    m_stats(),
+    m_table(),
+    learning("learning", false),
+    aging("aging", sc_time(300, SC_SEC)),
+    vlans("vlans", false),
+    eth_tx("eth_tx"),
+    eth_rx("eth_rx") {
+    register_command("show_ports", 0, &network::cmd_show_ports,
+                     "shows per-port rx and tx statistics");
+    register_command("show_macs", 0, &network::cmd_show_macs,
+                     "shows all addresses learned by the switch");
+    register_command("flush_macs", 0, &network::cmd_flush_macs,
+                     "forgets all addresses learned by the switch");
 }
 
 void network::bind(eth_initiator_socket& tx, eth_target_socket& rx) {
@@ -71,38 +71,273 @@ bool bus::cmd_mmap(const vector<string>& args, ostream& os) {
     if (m_default.target != TARGET_NONE)
         os << "\ndefault route -> " << target_peer_name(m_default.target);
 
+    os << "\nDMI invalidations:";
+    for (size_t port : in.all_keys()) {
+        size_t n = port < m_routes.size() ? m_routes[port].invalidations : 0;
+        os << "\n" << port << ": " << source_peer_name(port) << " " << n;
+    }
+
     return true;
 }
 
+bool bus::cmd_dmi_map(const vector<string>& args, ostream& os) {
+    size_t port = strtoull(args[0].c_str(), NULL, 0);
+    if (!in.exists(port)) {
+        os << "invalid source port: " << args[0];
+        return false;
+    }
+
+    stream_guard guard(os);
+    os << "DMI map of " << name() << " for " << source_peer_name(port);
+    for (const tlm_dmi& dmi : dmi_map(port)) {
+        os << "\n" << range(dmi) << " -> " << (void*)dmi.get_dmi_ptr() << " "
+           << (dmi.is_read_write_allowed() ? "rw"
+               : dmi.is_read_allowed()     ? "r"
+                                           : "w")
+           << " " << dmi.get_read_latency() << " "
+           << dmi.get_write_latency();
+    }
+
+    return true;
+}
+
+bool bus::cmd_bus_errors(const vector<string>& args, ostream& os) {
+    os << "Bus errors of " << name() << ": ";
+    m_bus_errors.summary(os, [&](u64 port) -> string {
+        return source_peer_name(port);
+    });
+    return true;
+}
+
+void bus::rebuild_decoder() const {
+    m_decode_any.clear();
+    if (m_routes.size() < in.next_index())
+        m_routes.resize(in.next_index(), { {}, nullptr, {}, 0 });
+
+    for (route& r : m_routes) {
+        r.decode.clear();
+        r.hint = nullptr;
+    }
+
+    // m_mappings is ordered by start address, so all tables end up sorted
+    for (const mapping& m : m_mappings) {
+        if (m.source == SOURCE_ANY)
+            m_decode_any.push_back(&m);
+        else if (m.source < m_routes.size())
+            m_routes[m.source].decode.push_back(&m);
+    }
+
+    m_dirty = false;
+}
+
+const bus::mapping* bus::decode(const vector<const mapping*>& maps,
+                                const range& mem) const {
+    // mappings within one table never overlap, so only the last mapping
+    // starting at or below mem.start can possibly contain it
+    auto it = std::upper_bound(maps.begin(), maps.end(), mem.start,
+                               [](u64 addr, const mapping* m) -> bool {
+                                   return addr < m->addr.start;
+                               });
+    if (it == maps.begin())
+        return nullptr;
+
+    const mapping* m = *(--it);
+    return m->addr.includes(mem) ? m : nullptr;
+}
+
 const bus::mapping& bus::lookup(tlm_target_socket& s, const range& mem) const {
+    if (m_dirty)
+        rebuild_decoder();
+
     size_t port = in.index_of(s);
+    if (port >= m_routes.size())
+        m_routes.resize(port + 1, { {}, nullptr, {}, 0 });
 
-    for (const auto& m : m_mappings) {
-        if (m.addr.includes(mem) && m.source == port)
-            return m;
+    route& r = m_routes[port];
+    if (r.hint && r.hint->addr.includes(mem))
+        return *r.hint;
+
+    const mapping* m = decode(r.decode, mem);
+    if (m) {
+        r.hint = m;
+        return *m;
     }
 
-    for (const auto& m : m_mappings) {
-        if (m.addr.includes(mem) && m.source == SOURCE_ANY)
-            return m;
+    m = decode(m_decode_any, mem);
+    if (m == nullptr)
+        return m_default;
+
+    // only remember global mappings if no source specific mapping shadows
+    // parts of them, otherwise the hint might bypass the specific mapping
+    auto it = std::upper_bound(r.decode.begin(), r.decode.end(), m->addr.end,
+                               [](u64 addr, const mapping* sm) -> bool {
+                                   return addr < sm->addr.start;
+                               });
+    if (it == r.decode.begin() || (*(it - 1))->addr.end < m->addr.start)
+        r.hint = m;
+
+    return *m;
+}
+
+void bus::track_dmi(size_t port, const range& mem) {
+    if (port >= m_routes.size())
+        m_routes.resize(port + 1, { {}, nullptr, {}, 0 });
+
+    vector<range>& granted = m_routes[port].dmi;
+    range merged = mem;
+    while (true) {
+        auto it = std::find_if(granted.begin(), granted.end(),
+                               [merged](const range& r) -> bool {
+                                   return r.overlaps(merged) ||
+                                          r.connects(merged);
+                               });
+        if (it == granted.end())
+            break;
+
+        merged.start = min(merged.start, it->start);
+        merged.end = max(merged.end, it->end);
+        granted.erase(it);
     }
 
-    return m_default;
+    granted.push_back(merged);
 }
 
-void bus::handle_bus_error(tlm_generic_payload& tx) const {
+bool bus::untrack_dmi(size_t port, const range& mem) {
+    if (port >= m_routes.size())
+        return false;
+
+    vector<range> remaining;
+    bool overlap = false;
+    for (const range& r : m_routes[port].dmi) {
+        if (!r.overlaps(mem)) {
+            remaining.push_back(r);
+            continue;
+        }
+
+        overlap = true;
+        if (r.start < mem.start)
+            remaining.emplace_back(r.start, mem.start - 1);
+        if (r.end > mem.end)
+            remaining.emplace_back(mem.end + 1, r.end);
+    }
+
+    if (overlap) {
+        m_routes[port].dmi.swap(remaining);
+        m_routes[port].invalidations++;
+    }
+
+    return overlap;
+}
+
+void bus::handle_bus_error(tlm_target_socket& origin,
+                           tlm_generic_payload& tx) {
+    size_t port = in.index_of(origin);
+    bool report = m_bus_errors.record(port, tx.get_address(), bus_error_limit);
+
     if (lenient) {
         if (tx.is_read())
             memset(tx.get_data_ptr(), 0, tx.get_data_length());
         tx.set_response_status(TLM_OK_RESPONSE);
-        log_warn("ignoring %s access to unmapped area [%llx..%llx]",
-                 tx.is_read() ? "read" : "write", tx.get_address(),
-                 tx.get_address() + tx_size(tx) - 1);
+        if (report)
+            log_warn("ignoring %s access to unmapped area [%llx..%llx]",
+                     tx.is_read() ? "read" : "write", tx.get_address(),
+                     tx.get_address() + tx_size(tx) - 1);
     } else {
         tx.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
     }
 }
 
+void bus::collect_dmi(const mapping& m, size_t source,
+                      const vector<range>& shadowed, vector<tlm_dmi>& dmis) {
+    u8 data = 0;
+    tlm_generic_payload tx;
+    tx_setup(tx, TLM_READ_COMMAND, 0, &data, sizeof(data));
+
+    u64 addr = m.offset;
+    u64 last = m.offset + m.addr.length() - 1;
+    while (addr <= last) {
+        tlm_dmi dmi;
+        tx.set_address(addr);
+        tx.set_response_status(TLM_INCOMPLETE_RESPONSE);
+        bool use_dmi = out[m.target]->get_direct_mem_ptr(tx, dmi);
+
+        // denied regions that do not cover addr tell us nothing, so the
+        // rest of the mapping is assumed to be denied as well
+        u64 lo = dmi.get_start_address();
+        u64 hi = dmi.get_end_address();
+        if (lo > addr || hi < addr)
+            break;
+
+        if (use_dmi) {
+            // move dmi into bus address space and clip it to the mapping
+            dmi.set_start_address(lo - m.offset + m.addr.start);
+            dmi.set_end_address(hi - m.offset + m.addr.start);
+            if (lo < m.offset)
+                dmi_set_start_address(dmi, m.addr.start);
+            if (hi > last)
+                dmi.set_end_address(m.addr.end);
+
+            // cut out regions shadowed by mappings specific to source
+            vector<range> pieces = { range(dmi) };
+            for (const range& shadow : shadowed) {
+                vector<range> remaining;
+                for (const range& r : pieces) {
+                    if (!r.overlaps(shadow)) {
+                        remaining.push_back(r);
+                        continue;
+                    }
+
+                    if (r.start < shadow.start)
+                        remaining.emplace_back(r.start, shadow.start - 1);
+                    if (r.end > shadow.end)
+                        remaining.emplace_back(shadow.end + 1, r.end);
+                }
+
+                pieces.swap(remaining);
+            }
+
+            for (const range& r : pieces) {
+                tlm_dmi piece(dmi);
+                dmi_set_start_address(piece, r.start);
+                piece.set_end_address(r.end);
+                dmis.push_back(piece);
+                track_dmi(source, r);
+            }
+        }
+
+        if (hi >= last)
+            break;
+
+        addr = hi + 1;
+    }
+}
+
+vector<tlm_dmi> bus::dmi_map(size_t source) {
+    VCML_ERROR_ON(!in.exists(source), "invalid source port %zu", source);
+
+    if (m_dirty)
+        rebuild_decoder();
+    if (source >= m_routes.size())
+        m_routes.resize(source + 1, { {}, nullptr, {}, 0 });
+
+    vector<tlm_dmi> dmis;
+    vector<range> specific;
+    for (const mapping* m : m_routes[source].decode) {
+        collect_dmi(*m, source, {}, dmis);
+        specific.push_back(m->addr);
+    }
+
+    for (const mapping* m : m_decode_any)
+        collect_dmi(*m, source, specific, dmis);
+
+    std::sort(dmis.begin(), dmis.end(),
+              [](const tlm_dmi& a, const tlm_dmi& b) -> bool {
+                  return a.get_start_address() < b.get_start_address();
+              });
+
+    return dmis;
+}
+
 void bus::map(size_t target, const range& addr, u64 offset, size_t source) {
     for (const auto& m : m_mappings) {
         if (!m.addr.overlaps(addr))
@@ -124,6 +359,7 @@ void bus::map(size_t target, const range& addr, u64 offset, size_t source) {
     m.addr = addr;
     m.offset = offset;
     m_mappings.insert(m);
+    m_dirty = true;
 }
 
 void bus::map_default(size_t target, u64 offset) {
@@ -140,7 +376,7 @@ void bus::b_transport(tlm_target_socket& socket, tlm_generic_payload& tx,
                       sc_time& dt) {
     const mapping& m = lookup(socket, tx);
     if (m.target == TARGET_NONE) {
-        handle_bus_error(tx);
+        handle_bus_error(socket, tx);
         return;
     }
 
@@ -154,7 +390,7 @@ unsigned int bus::transport_dbg(tlm_target_socket& origin,
                                 tlm_generic_payload& tx) {
     const mapping& m = lookup(origin, tx);
     if (m.target == TARGET_NONE) {
-        handle_bus_error(tx);
+        handle_bus_error(origin, tx);
         return 0;
     }
 
@@ -195,6 +431,8 @@ bool bus::get_direct_mem_ptr(tlm_target_socket& origin,
 
         dmi.set_start_address(s);
         dmi.set_end_address(e);
+
+        track_dmi(in.index_of(origin), range(s, e));
     }
 
     return use_dmi;
@@ -223,18 +461,31 @@ void bus::invalidate_direct_mem_ptr(tlm_initiator_socket& origin, u64 start,
         s += m.addr.start;
         e += m.addr.start;
 
+        // only forward to source ports that were granted DMI for this range
         for (auto& it : in) {
-            if (m.source == SOURCE_ANY || it.first == m.source)
+            if (m.source != SOURCE_ANY && it.first != m.source)
+                continue;
+            if (untrack_dmi(it.first, range(s, e)))
                 (*it.second)->invalidate_direct_mem_ptr(s, e);
         }
     }
 }
 
+void bus::end_of_elaboration() {
+    component::end_of_elaboration();
+    rebuild_decoder();
+}
+
 bus::bus(const sc_module_name& nm):
     component(nm),
     m_mappings(),
     m_default(),
+    m_dirty(true),
+    m_decode_any(),
+    m_routes(),
+    m_bus_errors(),
     lenient("lenient", false),
+    bus_error_limit("bus_error_limit", 4),
     in("in"),
     out("out") {
     m_default.target = -1;
@@ -242,6 +493,10 @@ bus::bus(const sc_module_name& nm):
     m_default.addr = range(0ull, ~0ull);
     m_default.offset = 0;
     register_command("mmap", 0, &bus::cmd_mmap, "shows the bus memory map");
+    register_command("dmimap", 1, &bus::cmd_dmi_map,
+                     "dmimap <port> shows all DMI regions of a source port");
+    register_command("buserrors", 0, &bus::cmd_bus_errors,
+                     "prints unmapped accesses per source and address");
 }
 
 bus::~bus() {
@@ -14,9 +14,24 @@ namespace vcml {
 namespace generic {
 
 void fbdev::update() {
+    vector<ui::damage_rect> damage;
+    size_t screen = (size_t)m_mode.xres * m_mode.yres;
+
     while (true) {
         wait_clock_cycle();
-        m_console.render();
+
+        // skip unchanged frames, redraw everything if most of it changed
+        size_t area = m_damage.update(damage);
+        if (area == 0)
+            continue;
+
+        if (area * 2 >= screen) {
+            m_console.render();
+            continue;
+        }
+
+        for (const ui::damage_rect& rect : damage)
+            m_console.render(rect.x, rect.y, rect.w, rect.h);
     }
 }
 
@@ -24,6 +39,7 @@ fbdev::fbdev(const sc_module_name& nm, u32 defx, u32 defy):
     component(nm),
     m_console(),
     m_mode(),
+    m_damage(),
     m_vptr(nullptr),
     addr("addr", 0),
     xres("xres", defx),
@@ -88,6 +104,7 @@ void fbdev::end_of_elaboration() {
 
     log_debug("using DMI pointer %p", m_vptr);
     m_console.setup(m_mode, m_vptr);
+    m_damage.setup(m_mode, m_vptr);
 }
 
 void fbdev::end_of_simulation() {
@@ -14,11 +14,8 @@ namespace vcml {
 namespace generic {
 
 u32 hwrng::read_rng() {
-    if (pseudo)
-        return (u32)rand();
-
     u32 data = 0;
-    if (!mwr::fill_random(&data, sizeof(data)))
+    if (!m_pool.fill(&data, sizeof(data)))
         log_warn("failed to get random data");
 
     return data;
@@ -26,6 +23,7 @@ u32 hwrng::read_rng() {
 
 hwrng::hwrng(const sc_module_name& nm):
     peripheral(nm),
+    m_pool(),
     rng("rng", 0x0),
     in("in"),
     pseudo("pseudo", false),
@@ -33,6 +31,7 @@ hwrng::hwrng(const sc_module_name& nm):
     rng.allow_read_only();
     rng.sync_never();
     rng.on_read(&hwrng::read_rng);
+    m_pool.reset(pseudo, seed);
 }
 
 hwrng::~hwrng() {
@@ -40,8 +39,7 @@ hwrng::~hwrng() {
 }
 
 void hwrng::reset() {
-    if (pseudo)
-        srand(seed);
+    m_pool.reset(pseudo, seed);
 }
 
 VCML_EXPORT_MODEL(vcml::generic::hwrng, name, args) {
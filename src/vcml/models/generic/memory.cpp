@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/models/generic/memory.h"
+#include "vcml/core/checkpoint.h"
 
 namespace vcml {
 namespace generic {
@@ -41,6 +42,38 @@ bool memory::cmd_show(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool memory::cmd_heatmap(const vector<string>& args, ostream& os) {
+    const tlm_heatmap* hm = in.heatmap();
+    if (hm == nullptr) {
+        os << "heatmap not enabled";
+        return false;
+    }
+
+    size_t limit = 16;
+    if (!args.empty())
+        limit = strtoull(args[0].c_str(), NULL, 0);
+
+    os << hm->pages().size() << " pages accessed, " << hm->num_samples()
+       << " dmi samples taken";
+    for (const auto& page : hm->hottest(limit)) {
+        os << mkstr("\n0x%016llx: %llu reads, %llu writes, %llu fetches",
+                    page.first, page.second.reads, page.second.writes,
+                    page.second.fetches);
+    }
+
+    return true;
+}
+
+void memory::load_bin(const string& filename, u64 offset) {
+    bool mappable = map_images && !debugging::is_compressed_image(filename);
+    if (mappable && m_memory.map_file(filename, offset)) {
+        log_debug("mapped %s to offset 0x%llx", filename.c_str(), offset);
+        return;
+    }
+
+    loader::load_bin(filename, offset);
+}
+
 u8* memory::allocate_image(u64 sz, u64 off) {
     if (off >= size)
         VCML_REPORT("offset 0x%llx exceeds memory size", off);
@@ -66,6 +99,11 @@ memory::memory(const sc_module_name& nm, u64 sz, bool read_only, alignment al,
     peripheral(nm, host_endian(), rl, wl),
     debugging::loader(*this, true),
     m_memory(),
+    m_has_pristine(false),
+    m_pristine(),
+    m_channel(),
+    m_local_locks(),
+    m_remote_locks(),
     size("size", sz),
     align("align", al),
     discard_writes("discard_writes", false),
@@ -73,11 +111,29 @@ memory::memory(const sc_module_name& nm, u64 sz, bool read_only, alignment al,
     shared("shared", ""),
     images("images"),
     poison("poison", 0x00),
+    hugepages("hugepages", false),
+    hugetlb("hugetlb", false),
+    prefault("prefault", false),
+    numa_node("numa_node", -1),
+    map_images("map_images", false),
+    track_dirty("track_dirty", false),
+    pristine("pristine", false),
+    clear_on_reset("clear_on_reset", false),
+    heatmap("heatmap", false),
+    heatmap_period("heatmap_period", sc_time(10.0, SC_MS)),
+    heatmap_file("heatmap_file", ""),
     in("in") {
     VCML_ERROR_ON(size == 0u, "memory size cannot be 0");
     VCML_ERROR_ON(al > VCML_ALIGN_1G, "requested alignment too big");
 
+    m_memory.use_transparent_hugepages(hugepages);
+    m_memory.use_explicit_hugepages(hugetlb);
+    m_memory.prefault(prefault);
+    m_memory.bind_numa_node(numa_node);
+
     m_memory.init(shared, size, align);
+    log_debug("allocated %llu bytes using %zu byte pages", size.get(),
+              m_memory.page_size());
     m_memory.set_read_latency(read_cycles());
     m_memory.set_write_latency(write_cycles());
 
@@ -86,31 +142,269 @@ memory::memory(const sc_module_name& nm, u64 sz, bool read_only, alignment al,
     if (discard_writes)
         m_memory.discard_writes();
 
-    map_dmi(m_memory);
+    if (track_dirty)
+        m_memory.track_dirty();
+
+    map_memory_dmi();
+
+    if (!shared.get().empty()) {
+        // peers must see exclusive reads to revoke their dmi
+        in.exmon().allow_excl_dmi(false);
+        m_channel = std::make_unique<tlm_shared_channel>(
+            shared, [this](tlm_shared_channel::message msg,
+                           const range& addr) { handle_message(msg, addr); });
+    }
 
     register_command("show", 2, &memory::cmd_show,
                      "show [start] [end] to print memory contents");
+    register_command("heatmap", 0, &memory::cmd_heatmap,
+                     "heatmap [n] to print the n most accessed pages");
 }
 
 memory::~memory() {
-    // nothing to do
+    // stop receiving messages before our sockets go away
+    m_channel.reset();
+}
+
+void memory::map_memory_dmi() {
+    // writes must pass through transport to be tracked, so only grant
+    // read access via DMI while dirty tracking is active
+    if (track_dirty) {
+        tlm_dmi dmi(m_memory);
+        dmi.allow_read();
+        map_dmi(dmi);
+    } else {
+        map_dmi(m_memory);
+    }
+}
+
+void memory::invalidate_peers() {
+    // all contents have changed behind the back of our peers
+    if (m_channel) {
+        range all(0, m_memory.size() - 1);
+        m_channel->broadcast(tlm_shared_channel::MSG_INVALIDATE, all);
+        m_channel->broadcast(tlm_shared_channel::MSG_DIRTY, all);
+    }
+}
+
+static bool drop_overlapping(vector<range>& locks, const range& addr) {
+    size_t n = locks.size();
+    stl_remove_if(locks, [&](const range& r) { return r.overlaps(addr); });
+    return locks.size() != n;
+}
+
+void memory::notify_peers(const range& addr, const tlm_sbi& info) {
+    if (!m_channel || info.is_debug)
+        return;
+
+    // peers drop dmi to locked ranges, so that their writes pass through
+    // transport where they can break our lock
+    if (info.is_excl) {
+        m_local_locks.push_back(addr);
+        m_channel->broadcast(tlm_shared_channel::MSG_LOCK, addr);
+    }
+}
+
+void memory::notify_write(const range& addr, const tlm_sbi& info) {
+    if (!m_channel || info.is_debug)
+        return;
+
+    if (drop_overlapping(m_local_locks, addr))
+        m_channel->broadcast(tlm_shared_channel::MSG_UNLOCK, addr);
+
+    if (drop_overlapping(m_remote_locks, addr)) {
+        m_channel->broadcast(tlm_shared_channel::MSG_BREAK, addr);
+        if (m_remote_locks.empty())
+            map_memory_dmi();
+    }
+
+    if (track_dirty)
+        m_channel->broadcast(tlm_shared_channel::MSG_DIRTY, addr);
+}
+
+void memory::handle_message(tlm_shared_channel::message msg,
+                            const range& addr) {
+    switch (msg) {
+    case tlm_shared_channel::MSG_INVALIDATE:
+        in.unmap_dmi(addr);
+        if (m_remote_locks.empty())
+            map_memory_dmi();
+        break;
+
+    case tlm_shared_channel::MSG_LOCK:
+        in.unmap_dmi(addr);
+        m_remote_locks.push_back(addr);
+        break;
+
+    case tlm_shared_channel::MSG_UNLOCK:
+        if (drop_overlapping(m_remote_locks, addr) && m_remote_locks.empty())
+            map_memory_dmi();
+        break;
+
+    case tlm_shared_channel::MSG_BREAK:
+        in.exmon().break_locks(addr);
+        drop_overlapping(m_local_locks, addr);
+        if (drop_overlapping(m_remote_locks, addr) && m_remote_locks.empty())
+            map_memory_dmi();
+        break;
+
+    case tlm_shared_channel::MSG_DIRTY:
+        if (track_dirty && addr.start < m_memory.size())
+            m_memory.mark_dirty(addr.intersect({ 0, m_memory.size() - 1 }));
+        break;
+
+    default:
+        log_warn("unknown shared memory message %u", (unsigned int)msg);
+    }
+}
+
+static constexpr size_t PRISTINE_PAGE = 4 * KiB;
+
+static bool is_zero(const u8* data, size_t size) {
+    return size == 0 || (data[0] == 0 && !memcmp(data, data + 1, size - 1));
+}
+
+void memory::save_pristine() {
+    const u8* base = m_memory.data();
+    for (size_t off = 0; off < m_memory.size(); off += PRISTINE_PAGE) {
+        size_t len = min(PRISTINE_PAGE, m_memory.size() - off);
+        if (!is_zero(base + off, len))
+            m_pristine[off].assign(base + off, base + off + len);
+    }
+
+    m_has_pristine = true;
+    log_debug("saved %zu pristine pages", m_pristine.size());
+}
+
+void memory::restore_pristine() {
+    // without dirty tracking, there is no need to find the pages that have
+    // changed, so just drop everything and copy back the non-zero pages
+    u8* base = m_memory.data();
+    if (!track_dirty && !m_memory.is_shared()) {
+        m_memory.clear();
+        for (const auto& page : m_pristine)
+            memcpy(base + page.first, page.second.data(), page.second.size());
+        return;
+    }
+
+    // only touch pages that actually differ, so that pages that have never
+    // been accessed stay unallocated and dirty tracking stays accurate
+    for (size_t off = 0; off < m_memory.size(); off += PRISTINE_PAGE) {
+        size_t len = min(PRISTINE_PAGE, m_memory.size() - off);
+        auto it = m_pristine.find(off);
+        if (it != m_pristine.end()) {
+            if (memcmp(base + off, it->second.data(), len) == 0)
+                continue;
+            memcpy(base + off, it->second.data(), len);
+        } else {
+            if (is_zero(base + off, len))
+                continue;
+            memset(base + off, 0, len);
+        }
+
+        m_memory.mark_dirty({ off, off + len - 1 });
+    }
+}
+
+void memory::start_of_simulation() {
+    peripheral::start_of_simulation();
+    if (pristine && !m_has_pristine)
+        save_pristine();
+    if (heatmap && !in.heatmap())
+        in.enable_heatmap(heatmap_period, m_memory.page_size());
+}
+
+void memory::end_of_simulation() {
+    peripheral::end_of_simulation();
+    if (in.heatmap() && !heatmap_file.get().empty()) {
+        in.heatmap()->save(heatmap_file);
+        log_debug("wrote heatmap to %s", heatmap_file.get().c_str());
+    }
 }
 
 void memory::reset() {
-    if (poison > 0)
-        m_memory.fill(poison);
+    // pages beneath our dmi pointers may get replaced, so initiators must
+    // drop them and request new ones once we are done
+    bool remap = clear_on_reset || (m_has_pristine && !track_dirty);
+    remap &= in.get_base_port().bind_count() > 0;
+    if (remap)
+        in.unmap_dmi(0, m_memory.size() - 1);
+
+    if (m_has_pristine)
+        restore_pristine();
+    else {
+        if (poison > 0)
+            m_memory.fill(poison);
+        else if (clear_on_reset)
+            m_memory.clear();
+        load_images(images);
+    }
+
+    m_local_locks.clear();
+    invalidate_peers();
+
+    if (remap && m_remote_locks.empty())
+        map_memory_dmi();
+}
 
-    load_images(images);
+void memory::save_state(checkpoint& cp) {
+    peripheral::save_state(cp);
+    cp.save_memory(name(), m_memory);
+}
+
+void memory::load_state(checkpoint& cp) {
+    peripheral::load_state(cp);
+    if (cp.has(name()))
+        cp.load_memory(name(), m_memory);
+    else
+        log_warn("memory contents not found in %s", cp.path());
+
+    invalidate_peers();
 }
 
 tlm_response_status memory::read(const range& addr, void* data,
                                  const tlm_sbi& info) {
-    return m_memory.read(addr, data, info.is_debug);
+    tlm_response_status rs = m_memory.read(addr, data, info.is_debug);
+    if (rs == TLM_OK_RESPONSE)
+        notify_peers(addr, info);
+    return rs;
 }
 
 tlm_response_status memory::write(const range& addr, const void* data,
                                   const tlm_sbi& info) {
-    return m_memory.write(addr, data, info.is_debug);
+    tlm_response_status rs = m_memory.write(addr, data, info.is_debug);
+    if (rs == TLM_OK_RESPONSE)
+        notify_write(addr, info);
+    return rs;
+}
+
+unsigned int memory::receive(tlm_generic_payload& tx, const tlm_sbi& info,
+                             address_space as) {
+    const tlm_gather* gather = tx_get_gather(tx);
+    unsigned int width = tx.get_streaming_width();
+    unsigned int length = tx.get_data_length();
+    bool burst = width && width < length;
+    if (!gather && !burst && !tx.get_byte_enable_ptr())
+        return peripheral::receive(tx, info, as);
+
+    // bursts and gather lists are served in one go instead of beat by beat
+    m_memory.transport(tx, info);
+    if (!tx.is_response_ok())
+        return 0;
+
+    u64 addr = tx.get_address();
+    range span = gather ? gather->footprint(addr)
+                        : range(addr, addr + (burst ? width : length) - 1);
+    if (tx.is_read())
+        notify_peers(span, info);
+    if (tx.is_write())
+        notify_write(span, info);
+
+    // the socket monitor only saw the transaction range, not the gather list
+    if (gather && tx.is_write() && !info.is_debug)
+        in.exmon().break_locks(span);
+
+    return length;
 }
 
 VCML_EXPORT_MODEL(vcml::generic::memory, name, args) {
@@ -0,0 +1,609 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/generic/remote.h"
+#include "vcml/models/generic/memory.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <climits>
+
+namespace vcml {
+namespace generic {
+
+enum : size_t {
+    REMOTE_SLOTS = 16,
+    REMOTE_MAX_DATA = 4096,
+    REMOTE_INVALIDATIONS = 16,
+    REMOTE_SPIN_US = 20, // busy wait this long before going to sleep
+};
+
+enum remote_peer : u32 {
+    PEER_TARGET = 1u << 0,
+    PEER_INITIATOR = 1u << 1,
+};
+
+enum remote_op : u32 {
+    OP_TRANSPORT = 0,
+    OP_DEBUG = 1,
+    OP_DMI = 2,
+};
+
+// every slot passes through three phases per lap around the ring, so that
+// seq = 3 * lap + phase tells whose turn it is without any locking
+enum remote_phase : u64 {
+    PHASE_FREE = 0,
+    PHASE_REQUEST = 1,
+    PHASE_RESPONSE = 2,
+};
+
+struct remote_slot {
+    alignas(64) atomic<u64> seq;
+    u32 op;
+    u32 command;
+    u64 addr;
+    u32 size;
+    i32 response;
+    u64 delay; // in picoseconds
+    u32 dmi_allowed;
+    u32 dmi_access;
+    u64 dmi_start;
+    u64 dmi_end;
+    u64 dmi_offset;
+    u64 dmi_size;
+    u64 dmi_rdlat; // in picoseconds
+    u64 dmi_wrlat; // in picoseconds
+    char dmi_shared[64];
+    u8 data[REMOTE_MAX_DATA];
+};
+
+struct remote_range {
+    u64 start;
+    u64 end;
+};
+
+// zero-filled memory is a valid empty channel, so a freshly truncated
+// shared memory object needs no further initialization by whoever is first
+struct remote_channel {
+    alignas(64) atomic<u32> peers;
+    alignas(64) atomic<u64> head;     // number of requests ever posted
+    atomic<u32> doorbell;             // bumped whenever a request is posted
+    atomic<u32> sleeping;             // initiators sleeping on doorbell
+    alignas(64) atomic<u32> done;     // bumped whenever a response is ready
+    atomic<u32> waiters;              // targets sleeping on done
+    alignas(64) atomic<u64> inv_head; // number of invalidations ever posted
+    atomic<u32> inv_seq;              // bumped whenever dmi gets invalidated
+    remote_range inv[REMOTE_INVALIDATIONS];
+    remote_slot slots[REMOTE_SLOTS];
+};
+
+static_assert(atomic<u32>::is_always_lock_free, "remote needs lock-free");
+static_assert(atomic<u64>::is_always_lock_free, "remote needs lock-free");
+static_assert(sizeof(atomic<u32>) == sizeof(u32), "unexpected atomic size");
+
+static void futex_wait(atomic<u32>& addr, u32 val, u64 timeout_ns) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ns / 1000000000;
+    ts.tv_nsec = timeout_ns % 1000000000;
+    // deliberately not FUTEX_PRIVATE, the peer is another process
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAIT, val, &ts, nullptr, 0);
+}
+
+static void futex_wake_all(atomic<u32>& addr) {
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static u64 to_ps(const sc_time& t) {
+    return (u64)(t.to_seconds() * 1e12 + 0.5);
+}
+
+static sc_time from_ps(u64 ps) {
+    return sc_time((double)ps, SC_PS);
+}
+
+static string channel_path(const string& name) {
+    return "/vcml-remote-" + name;
+}
+
+static remote_channel* map_channel(const string& name, u32 peer, int fd) {
+    string path = channel_path(name);
+    struct stat info;
+    if (fstat(fd, &info) < 0)
+        VCML_REPORT("cannot access %s: %s", path.c_str(), strerror(errno));
+
+    if (info.st_size == 0 && ftruncate(fd, sizeof(remote_channel)) < 0)
+        VCML_REPORT("cannot resize %s: %s", path.c_str(), strerror(errno));
+    else if (info.st_size != 0 &&
+             (size_t)info.st_size != sizeof(remote_channel))
+        VCML_REPORT("%s is not a compatible channel", path.c_str());
+
+    void* mem = mmap(nullptr, sizeof(remote_channel), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    VCML_REPORT_ON(mem == MAP_FAILED, "cannot map %s: %s", path.c_str(),
+                   strerror(errno));
+
+    remote_channel* chan = (remote_channel*)mem;
+    if (chan->peers.fetch_or(peer) & peer) {
+        munmap(mem, sizeof(remote_channel));
+        VCML_REPORT("channel %s already has a remote %s", name.c_str(),
+                    peer == PEER_TARGET ? "target" : "initiator");
+    }
+
+    return chan;
+}
+
+static remote_channel* attach_channel(const string& name, u32 peer,
+                                      int& fd) {
+    string path = channel_path(name);
+    fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    VCML_REPORT_ON(fd < 0, "cannot open %s: %s", path.c_str(),
+                   strerror(errno));
+
+    try {
+        return map_channel(name, peer, fd);
+    } catch (...) {
+        close(fd);
+        fd = -1;
+        throw;
+    }
+}
+
+static void detach_channel(const string& name, u32 peer,
+                           remote_channel*& chan, int& fd) {
+    if (chan != nullptr) {
+        // never keep the peer waiting for someone that is gone
+        u32 peers = chan->peers.fetch_and(~peer) & ~peer;
+        chan->done++;
+        chan->doorbell++;
+        futex_wake_all(chan->done);
+        futex_wake_all(chan->doorbell);
+        if (peers == 0)
+            shm_unlink(channel_path(name).c_str());
+        munmap(chan, sizeof(remote_channel));
+        chan = nullptr;
+    }
+
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+u8* remote_target::map_shared(const string& name, size_t size) {
+    lock_guard<mutex> guard(m_maps_mtx);
+    auto it = m_maps.find(name);
+    if (it != m_maps.end())
+        return it->second.second >= size ? it->second.first : nullptr;
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        log_warn("cannot open shared memory %s: %s", name.c_str(),
+                 strerror(errno));
+        return nullptr;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || (size_t)info.st_size < size) {
+        log_warn("shared memory %s has unexpected size", name.c_str());
+        close(fd);
+        return nullptr;
+    }
+
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                     0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        log_warn("cannot map %s: %s", name.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    m_maps[name] = { (u8*)mem, size };
+    return (u8*)mem;
+}
+
+void remote_target::watch_invalidations() {
+    mwr::set_thread_name(mkstr("remote_%s", m_name.c_str()));
+    u64 tail = m_chan->inv_head.load(std::memory_order_acquire);
+    while (m_running) {
+        u32 seq = m_chan->inv_seq.load();
+        u64 head = m_chan->inv_head.load(std::memory_order_acquire);
+        if (head == tail) {
+            futex_wait(m_chan->inv_seq, seq, 100000000); // 100ms
+            continue;
+        }
+
+        vector<remote_range> ranges;
+        u64 first = tail;
+        if (head - tail > REMOTE_INVALIDATIONS)
+            first = head - REMOTE_INVALIDATIONS;
+        for (u64 i = first; i < head; i++)
+            ranges.push_back(m_chan->inv[i % REMOTE_INVALIDATIONS]);
+
+        // drop everything if the initiator lapped us while copying
+        u64 now = m_chan->inv_head.load(std::memory_order_acquire);
+        if (now - tail > REMOTE_INVALIDATIONS)
+            ranges.assign(1, { 0, ~0ull });
+        tail = head;
+
+        on_next_update([this, ranges]() -> void {
+            for (const remote_range& r : ranges)
+                in->invalidate_direct_mem_ptr(r.start, r.end);
+        });
+    }
+}
+
+remote_slot& remote_target::post(u64& idx) {
+    idx = m_chan->head.fetch_add(1);
+    remote_slot& slot = m_chan->slots[idx % REMOTE_SLOTS];
+    u64 lap = idx / REMOTE_SLOTS;
+
+    // the previous user of the slot may still be picking up its response
+    while (slot.seq.load(std::memory_order_acquire) != 3 * lap + PHASE_FREE)
+        std::this_thread::yield();
+
+    return slot;
+}
+
+bool remote_target::await(remote_slot& slot, u64 idx) {
+    u64 done = 3 * (idx / REMOTE_SLOTS) + PHASE_RESPONSE;
+    slot.seq.store(done - 1, std::memory_order_release);
+
+    m_chan->doorbell++; // must be ordered before reading sleeping
+    if (m_chan->sleeping.load())
+        futex_wake_all(m_chan->doorbell);
+
+    // remote accesses usually complete within microseconds, so spin for a
+    // while before paying for a round trip through the kernel
+    u64 start = mwr::timestamp_us();
+    while (slot.seq.load(std::memory_order_acquire) != done) {
+        if (mwr::timestamp_us() - start < REMOTE_SPIN_US)
+            continue;
+
+        m_chan->waiters++;
+        u32 seq = m_chan->done.load();
+        if (slot.seq.load(std::memory_order_acquire) != done)
+            futex_wait(m_chan->done, seq, 100000000); // 100ms
+        m_chan->waiters--;
+
+        if (!(m_chan->peers.load() & PEER_INITIATOR))
+            return slot.seq.load(std::memory_order_acquire) == done;
+    }
+
+    return true;
+}
+
+void remote_target::release(remote_slot& slot, u64 idx) {
+    u64 lap = idx / REMOTE_SLOTS;
+    slot.seq.store(3 * (lap + 1) + PHASE_FREE, std::memory_order_release);
+}
+
+void remote_target::forward(tlm_generic_payload& tx, sc_time& dt,
+                            bool debug) {
+    if (tx.get_byte_enable_ptr() != nullptr) {
+        tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        return;
+    }
+
+    if (tx.get_streaming_width() < tx.get_data_length()) {
+        tx.set_response_status(TLM_BURST_ERROR_RESPONSE);
+        return;
+    }
+
+    if (!(m_chan->peers.load() & PEER_INITIATOR)) {
+        log_debug("no remote initiator attached to %s", m_name.c_str());
+        tx.set_response_status(TLM_GENERIC_ERROR_RESPONSE);
+        return;
+    }
+
+    u8* data = tx.get_data_ptr();
+    u64 length = tx.get_data_length();
+    u64 delay = to_ps(dt);
+    bool dmi = true;
+
+    tlm_response_status rs = TLM_OK_RESPONSE;
+    for (u64 offset = 0; offset < length && success(rs);) {
+        u32 size = (u32)min<u64>(length - offset, REMOTE_MAX_DATA);
+
+        u64 idx;
+        remote_slot& slot = post(idx);
+        slot.op = debug ? OP_DEBUG : OP_TRANSPORT;
+        slot.command = tx.get_command();
+        slot.addr = tx.get_address() + offset;
+        slot.size = size;
+        slot.delay = delay;
+        if (tx.is_write())
+            memcpy(slot.data, data + offset, size);
+
+        if (await(slot, idx)) {
+            rs = (tlm_response_status)slot.response;
+            if (tx.is_read())
+                memcpy(data + offset, slot.data, size);
+            delay = slot.delay;
+            dmi = dmi && slot.dmi_allowed;
+        } else {
+            rs = TLM_GENERIC_ERROR_RESPONSE;
+        }
+
+        release(slot, idx);
+        offset += size;
+    }
+
+    if (!debug)
+        dt = from_ps(delay);
+
+    tx.set_dmi_allowed(dmi && success(rs));
+    tx.set_response_status(rs);
+}
+
+remote_target::remote_target(const sc_module_name& nm, const string& chan):
+    component(nm),
+    m_name(),
+    m_fd(-1),
+    m_chan(nullptr),
+    m_maps_mtx(),
+    m_maps(),
+    m_running(true),
+    m_watcher(),
+    channel("channel", chan.empty() ? string(basename()) : chan),
+    in("in") {
+    m_name = channel;
+    m_chan = attach_channel(m_name, PEER_TARGET, m_fd);
+    m_watcher = thread(&remote_target::watch_invalidations, this);
+}
+
+remote_target::~remote_target() {
+    m_running = false;
+    if (m_watcher.joinable()) {
+        futex_wake_all(m_chan->inv_seq);
+        m_watcher.join();
+    }
+
+    detach_channel(m_name, PEER_TARGET, m_chan, m_fd);
+
+    for (const auto& it : m_maps)
+        munmap(it.second.first, it.second.second);
+}
+
+void remote_target::b_transport(tlm_target_socket& origin,
+                                tlm_generic_payload& tx, sc_time& dt) {
+    forward(tx, dt, false);
+}
+
+unsigned int remote_target::transport_dbg(tlm_target_socket& origin,
+                                          tlm_generic_payload& tx) {
+    sc_time dt = SC_ZERO_TIME;
+    forward(tx, dt, true);
+    return tx.is_response_ok() ? tx.get_data_length() : 0;
+}
+
+bool remote_target::get_direct_mem_ptr(tlm_target_socket& origin,
+                                       tlm_generic_payload& tx,
+                                       tlm_dmi& dmi) {
+    if (!(m_chan->peers.load() & PEER_INITIATOR))
+        return false;
+
+    u64 idx;
+    remote_slot& slot = post(idx);
+    slot.op = OP_DMI;
+    slot.command = tx.get_command();
+    slot.addr = tx.get_address();
+    slot.size = 0;
+
+    bool granted = await(slot, idx) && slot.dmi_allowed;
+    string name(slot.dmi_shared, strnlen(slot.dmi_shared, 64));
+    u64 offset = slot.dmi_offset;
+    u64 size = slot.dmi_size;
+
+    if (granted) {
+        dmi.set_start_address(slot.dmi_start);
+        dmi.set_end_address(slot.dmi_end);
+        dmi.set_granted_access((tlm_dmi::dmi_access_e)slot.dmi_access);
+        dmi.set_read_latency(from_ps(slot.dmi_rdlat));
+        dmi.set_write_latency(from_ps(slot.dmi_wrlat));
+    }
+
+    release(slot, idx);
+    if (!granted)
+        return false;
+
+    u8* base = map_shared(name, size);
+    if (base == nullptr)
+        return false;
+
+    dmi.set_dmi_ptr(base + offset);
+    return true;
+}
+
+bool remote_initiator::has_request() const {
+    u64 tail = m_tail.load();
+    const remote_slot& slot = m_chan->slots[tail % REMOTE_SLOTS];
+    u64 seq = slot.seq.load(std::memory_order_acquire);
+    return seq == 3 * (tail / REMOTE_SLOTS) + PHASE_REQUEST;
+}
+
+void remote_initiator::listen() {
+    mwr::set_thread_name(mkstr("remote_%s", m_name.c_str()));
+    while (m_running) {
+        u64 start = mwr::timestamp_us();
+        while (!has_request() && mwr::timestamp_us() - start < REMOTE_SPIN_US)
+            std::this_thread::yield();
+
+        if (has_request() && !m_pending.exchange(true))
+            on_next_update([this]() -> void { m_ev.notify(SC_ZERO_TIME); });
+
+        // announce that we are about to sleep, then look again so that a
+        // request posted in between can never be missed
+        m_chan->sleeping++;
+        u32 seq = m_chan->doorbell.load();
+        if (m_pending || !has_request())
+            futex_wait(m_chan->doorbell, seq, 100000000); // 100ms
+        m_chan->sleeping--;
+    }
+}
+
+void remote_initiator::serve() {
+    while (true) {
+        wait(m_ev);
+
+        do {
+            while (has_request()) {
+                u64 tail = m_tail.load();
+                remote_slot& slot = m_chan->slots[tail % REMOTE_SLOTS];
+                serve_request(slot);
+
+                u64 lap = tail / REMOTE_SLOTS;
+                slot.seq.store(3 * lap + PHASE_RESPONSE,
+                               std::memory_order_release);
+                m_tail = tail + 1;
+
+                m_chan->done++; // must be ordered before reading waiters
+                if (m_chan->waiters.load())
+                    futex_wake_all(m_chan->done);
+            }
+
+            m_pending = false;
+        } while (has_request() && !m_pending.exchange(true));
+    }
+}
+
+void remote_initiator::serve_request(remote_slot& slot) {
+    tlm_generic_payload tx;
+    tx_setup(tx, (tlm_command)slot.command, slot.addr, slot.data, slot.size);
+
+    if (slot.op == OP_DMI) {
+        serve_dmi(slot, tx);
+        return;
+    }
+
+    if (slot.op == OP_DEBUG) {
+        out->transport_dbg(tx);
+    } else {
+        sc_time dt = from_ps(slot.delay);
+        out.b_transport(tx, dt);
+        slot.delay = to_ps(dt);
+    }
+
+    slot.response = tx.get_response_status();
+    if (tx.is_dmi_allowed())
+        serve_dmi(slot, tx);
+    else
+        slot.dmi_allowed = 0;
+}
+
+void remote_initiator::serve_dmi(remote_slot& slot, tlm_generic_payload& tx) {
+    slot.dmi_allowed = 0;
+
+    tlm_dmi dmi;
+    if (!out->get_direct_mem_ptr(tx, dmi))
+        return;
+
+    for (const memory* mem : m_shared) {
+        u8* base = mem->data();
+        u64 size = mem->size;
+        u8* ptr = dmi.get_dmi_ptr();
+        if (ptr < base || ptr >= base + size)
+            continue;
+
+        const string& name = mem->shared;
+        if (name.length() >= sizeof(slot.dmi_shared))
+            continue;
+
+        u64 offset = ptr - base;
+        u64 end = dmi.get_end_address() - dmi.get_start_address();
+        end = min(end, size - offset - 1);
+
+        memset(slot.dmi_shared, 0, sizeof(slot.dmi_shared));
+        memcpy(slot.dmi_shared, name.c_str(), name.length());
+        slot.dmi_offset = offset;
+        slot.dmi_size = size;
+        slot.dmi_start = dmi.get_start_address();
+        slot.dmi_end = dmi.get_start_address() + end;
+        slot.dmi_access = dmi.get_granted_access();
+        slot.dmi_rdlat = to_ps(dmi.get_read_latency());
+        slot.dmi_wrlat = to_ps(dmi.get_write_latency());
+        slot.dmi_allowed = 1;
+        return;
+    }
+}
+
+static void collect_shared(sc_object* obj, vector<const memory*>& mems) {
+    memory* mem = dynamic_cast<memory*>(obj);
+    if (mem != nullptr && !mem->shared.get().empty())
+        mems.push_back(mem);
+
+    for (sc_object* child : obj->get_child_objects())
+        collect_shared(child, mems);
+}
+
+remote_initiator::remote_initiator(const sc_module_name& nm,
+                                   const string& chan):
+    component(nm),
+    m_name(),
+    m_fd(-1),
+    m_chan(nullptr),
+    m_tail(0),
+    m_running(true),
+    m_pending(false),
+    m_listener(),
+    m_ev("ev"),
+    m_shared(),
+    channel("channel", chan.empty() ? string(basename()) : chan),
+    out("out") {
+    m_name = channel;
+    m_chan = attach_channel(m_name, PEER_INITIATOR, m_fd);
+
+    // requests left behind by a previous initiator can never be answered
+    m_tail = m_chan->head.load();
+
+    SC_HAS_PROCESS(remote_initiator);
+    SC_THREAD(serve);
+
+    m_listener = thread(&remote_initiator::listen, this);
+}
+
+remote_initiator::~remote_initiator() {
+    m_running = false;
+    if (m_listener.joinable()) {
+        futex_wake_all(m_chan->doorbell);
+        m_listener.join();
+    }
+
+    detach_channel(m_name, PEER_INITIATOR, m_chan, m_fd);
+}
+
+void remote_initiator::invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                                 u64 start, u64 end) {
+    u64 head = m_chan->inv_head.load(std::memory_order_relaxed);
+    m_chan->inv[head % REMOTE_INVALIDATIONS] = { start, end };
+    m_chan->inv_head.store(head + 1, std::memory_order_release);
+    m_chan->inv_seq++;
+    futex_wake_all(m_chan->inv_seq);
+}
+
+void remote_initiator::end_of_elaboration() {
+    component::end_of_elaboration();
+    for (sc_object* obj : sc_core::sc_get_top_level_objects())
+        collect_shared(obj, m_shared);
+}
+
+VCML_EXPORT_MODEL(vcml::generic::remote_target, name, args) {
+    return new remote_target(name, args.empty() ? "" : args[0]);
+}
+
+VCML_EXPORT_MODEL(vcml::generic::remote_initiator, name, args) {
+    return new remote_initiator(name, args.empty() ? "" : args[0]);
+}
+
+} // namespace generic
+} // namespace vcml
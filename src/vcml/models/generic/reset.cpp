@@ -13,8 +13,16 @@
 namespace vcml {
 namespace generic {
 
+bool reset::cmd_pulse(const vector<string>& args, ostream& os) {
+    pulse();
+    os << "OK";
+    return true;
+}
+
 reset::reset(const sc_module_name& nm, bool init_state):
     module(nm), state("state", init_state), rst("rst") {
+    register_command("pulse", 0, &reset::cmd_pulse,
+                     "resets all components connected to this reset");
 }
 
 reset::~reset() {
@@ -22,7 +30,7 @@ reset::~reset() {
 }
 
 void reset::end_of_elaboration() {
-    rst.pulse();
+    pulse();
     rst = state;
 }
 
@@ -216,6 +216,28 @@ i2c_response lm75::i2c_write(const i2c_target_socket& socket, u8 data) {
     return I2C_ACK;
 }
 
+void lm75::i2c_transport(const i2c_target_socket& socket,
+                         i2c_message& msg) {
+    msg.resp = i2c_start(socket, msg.cmd);
+    if (msg.cmd == TLM_READ_COMMAND) {
+        for (size_t i = 0; i < msg.size; i++)
+            msg.data[i] = i < sizeof(m_buf) ? m_buf[i] : 0xff;
+    } else if (msg.size > 0) {
+        // update the register once with all bytes of the message
+        pointer = msg.data[0];
+        size_t n = min(msg.size - 1, sizeof(m_buf));
+        memcpy(m_buf, msg.data + 1, n);
+        if (n > 0)
+            save_buffer();
+    }
+
+    m_len = msg.size;
+    if (msg.acks) {
+        for (size_t i = 0; i < msg.size; i++)
+            msg.acks[i] = I2C_ACK;
+    }
+}
+
 VCML_EXPORT_MODEL(vcml::i2c::lm75, name, args) {
     return new lm75(name);
 }
@@ -16,7 +16,10 @@ namespace meta {
 loader::loader(const sc_module_name& nm):
     component(nm),
     debugging::loader(*this, true),
+    m_loaded(false),
     images("images"),
+    parallel("parallel", false),
+    reload("reload", true),
     insn("insn"),
     data("data") {
 }
@@ -24,7 +27,10 @@ loader::loader(const sc_module_name& nm):
 loader::loader(const sc_module_name& nm, const vector<string>& imginit):
     component(nm),
     debugging::loader(*this, true),
+    m_loaded(false),
     images("images", imginit),
+    parallel("parallel", false),
+    reload("reload", true),
     insn("insn"),
     data("data") {
 }
@@ -35,7 +41,11 @@ loader::~loader() {
 
 void loader::reset() {
     component::reset();
-    load_images(images);
+    if (m_loaded && !reload)
+        return;
+
+    load_images(images, parallel);
+    m_loaded = true;
 }
 
 u8* loader::allocate_image(u64 size, u64 offset) {
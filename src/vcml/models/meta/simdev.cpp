@@ -9,6 +9,8 @@
  ******************************************************************************/
 
 #include "vcml/models/meta/simdev.h"
+#include "vcml/core/roi.h"
+#include "vcml/tracing/tracer.h"
 
 namespace vcml {
 namespace meta {
@@ -51,6 +53,38 @@ u32 simdev::read_prng() {
     return rand();
 }
 
+u32 simdev::read_roib() {
+    return roi_active() ? 1 : 0;
+}
+
+void simdev::write_roib(u32 val) {
+    roi_begin(roi_tracing);
+}
+
+void simdev::write_roie(u32 val) {
+    roi_end(roi_tracing);
+    platform_dump_stats(stats_file, mkstr("region of interest %u", val));
+}
+
+void simdev::write_srst(u32 val) {
+    log_debug("resetting statistics upon request (%u)", val);
+    platform_reset_stats();
+}
+
+void simdev::write_sdmp(u32 val) {
+    string now = sc_time_stamp().to_string();
+    string title = mkstr("statistics dump %u at %s", val, now.c_str());
+    platform_dump_stats(stats_file, title);
+}
+
+void simdev::write_ckpt(u32 val) {
+    string path = checkpoint_file;
+    if (val != 0)
+        path = mkstr("%s.%u", path.c_str(), val);
+    if (!platform_checkpoint(path))
+        log_warn("cannot save checkpoint %s: no system", path.c_str());
+}
+
 simdev::simdev(const sc_module_name& nm):
     peripheral(nm),
     stop("stop", 0x00, 0),
@@ -61,6 +95,14 @@ simdev::simdev(const sc_module_name& nm):
     sout("sout", 0x28, 0),
     serr("serr", 0x30, 0),
     prng("prng", 0x38, 0),
+    roib("roib", 0x40, 0),
+    roie("roie", 0x48, 0),
+    srst("srst", 0x50, 0),
+    sdmp("sdmp", 0x58, 0),
+    ckpt("ckpt", 0x60, 0),
+    roi_tracing("roi_tracing", false),
+    stats_file("stats_file", ""),
+    checkpoint_file("checkpoint_file", "simdev.ckpt"),
     in("in") {
     stop.allow_read_write();
     stop.on_write(&simdev::write_stop);
@@ -85,6 +127,27 @@ simdev::simdev(const sc_module_name& nm):
 
     prng.allow_read_write();
     prng.on_read(&simdev::read_prng);
+
+    // sync so that the statistics match the time of the access
+    roib.sync_always();
+    roib.allow_read_write();
+    roib.on_read(&simdev::read_roib);
+    roib.on_write(&simdev::write_roib);
+
+    roie.sync_always();
+    roie.allow_read_write();
+    roie.on_write(&simdev::write_roie);
+
+    srst.sync_always();
+    srst.allow_read_write();
+    srst.on_write(&simdev::write_srst);
+
+    sdmp.sync_always();
+    sdmp.allow_read_write();
+    sdmp.on_write(&simdev::write_sdmp);
+
+    ckpt.allow_read_write();
+    ckpt.on_write(&simdev::write_ckpt);
 }
 
 simdev::~simdev() {
@@ -95,6 +158,14 @@ void simdev::reset() {
     // nothing to do
 }
 
+void simdev::start_of_simulation() {
+    peripheral::start_of_simulation();
+
+    // with roi_tracing, nothing gets traced until the guest begins its roi
+    if (roi_tracing)
+        tracer::pause();
+}
+
 VCML_EXPORT_MODEL(vcml::meta::simdev, name, args) {
     return new simdev(name);
 }
@@ -9,6 +9,11 @@
  ******************************************************************************/
 
 #include "vcml/models/meta/throttle.h"
+#include "vcml/core/processor.h"
+
+#ifdef MWR_LINUX
+#include <time.h>
+#endif
 
 namespace vcml {
 namespace meta {
@@ -23,49 +28,221 @@ static u64 do_usleep(u64 delta) {
     return d > delta ? d - delta : 0;
 }
 
-void throttle::update() {
+static u64 host_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+static void sleep_until(u64 deadline) {
+#ifdef MWR_LINUX
+    // steady_clock is based on CLOCK_MONOTONIC on linux
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000ull;
+    ts.tv_nsec = deadline % 1000000000ull;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+           EINTR) {
+        // interrupted, sleep again until the same deadline
+    }
+#else
+    u64 now = host_ns();
+    if (deadline > now)
+        mwr::usleep((deadline - now) / 1000);
+#endif
+}
+
+void throttle::record_slack(i64 slack_ns) {
+    if (slack_ns < 0)
+        m_slack[SLACK_LATE]++;
+    else if (slack_ns < 10000)
+        m_slack[SLACK_10US]++;
+    else if (slack_ns < 100000)
+        m_slack[SLACK_100US]++;
+    else if (slack_ns < 1000000)
+        m_slack[SLACK_1MS]++;
+    else if (slack_ns < 10000000)
+        m_slack[SLACK_10MS]++;
+    else
+        m_slack[SLACK_MORE]++;
+}
+
+void throttle::adapt_interval(bool missed) {
+    if (!adaptive)
+        return;
+
+    // back off quickly when missing deadlines, but only creep towards
+    // shorter intervals to avoid oscillating around the limit
     sc_time quantum = tlm::tlm_global_quantum::instance().get();
-    sc_time interval = max<sc_time>(quantum, update_interval);
-    next_trigger(interval);
+    if (missed)
+        m_interval = min<sc_time>(m_interval * 2.0, update_interval.get());
+    else
+        m_interval = max<sc_time>(m_interval * 0.875, quantum);
+}
 
-    if (rtf > 0.0) {
-        u64 actual = mwr::timestamp_us() - m_start + m_extra;
-        u64 target = time_to_us(interval) / rtf;
-
-        if (actual < target) {
-            m_extra = do_usleep(target - actual);
-            if (!m_throttling)
-                log_debug("throttling started");
-            m_throttling = true;
-        } else {
-            m_extra = actual - target;
-            if (m_throttling)
-                log_debug("throttling stopped");
-            m_throttling = false;
-        }
+void throttle::pace_coarse(const sc_time& interval) {
+    u64 actual = mwr::timestamp_us() - m_start + m_extra;
+    u64 target = time_to_us(interval) / rtf;
+    record_slack(((i64)target - (i64)actual) * 1000);
+
+    if (actual < target) {
+        m_extra = do_usleep(target - actual);
+        if (!m_throttling)
+            log_debug("throttling started");
+        m_throttling = true;
+    } else {
+        m_extra = actual - target;
+        if (m_throttling)
+            log_debug("throttling stopped");
+        m_throttling = false;
     }
 
+    adapt_interval(actual >= target);
     m_start = mwr::timestamp_us();
 }
 
+void throttle::pace_precise(const sc_time& interval) {
+    u64 now = host_ns();
+    u64 target = time_to_ns(interval) / rtf;
+    if (m_deadline == 0)
+        m_deadline = now;
+
+    // deadlines are absolute, so sleeping too long in one interval is made
+    // up for in the next ones; falling behind by more than one interval
+    // resynchronizes instead of running unthrottled to catch up
+    m_deadline += target;
+    i64 slack = (i64)(m_deadline - now);
+    record_slack(slack);
+
+    if (slack <= 0) {
+        if ((u64)-slack > target)
+            m_deadline = now;
+        if (m_throttling)
+            log_debug("throttling stopped");
+        m_throttling = false;
+        adapt_interval(true);
+        return;
+    }
+
+    u64 spin = time_to_ns(spin_time);
+    if ((u64)slack > spin)
+        sleep_until(m_deadline - spin);
+
+    // spin for the remainder
+    do {
+        now = host_ns();
+    } while (now < m_deadline);
+
+    if (!m_throttling)
+        log_debug("throttling started");
+    m_throttling = true;
+    adapt_interval(now - m_deadline > spin);
+}
+
+void throttle::update() {
+    if (m_host_start == 0)
+        m_host_start = host_ns();
+
+    sc_time quantum = tlm::tlm_global_quantum::instance().get();
+    sc_time interval = adaptive ? m_interval : update_interval.get();
+    interval = max<sc_time>(quantum, interval);
+
+    // pace what got simulated since the last update, which is less than
+    // an interval when a sleeping platform woke up early
+    sc_time elapsed = sc_time_stamp() - m_last;
+    m_last = sc_time_stamp();
+
+    // do not keep the kernel ticking while all processors sleep, but skip
+    // to the next event and catch up with the host clock once it is there
+    if (!processor::platform_idle())
+        next_trigger(interval);
+    else if (sc_core::sc_pending_activity_at_future_time())
+        next_trigger(max(interval, sc_core::sc_time_to_pending_activity()),
+                     processor::platform_wakeup());
+    else
+        next_trigger(processor::platform_wakeup());
+
+    if (rtf <= 0.0) {
+        m_start = mwr::timestamp_us();
+        return;
+    }
+
+    if (elapsed == SC_ZERO_TIME) {
+        m_start = mwr::timestamp_us();
+        if (precise && m_deadline == 0)
+            m_deadline = host_ns();
+        return;
+    }
+
+    if (precise)
+        pace_precise(elapsed);
+    else
+        pace_coarse(elapsed);
+}
+
+bool throttle::cmd_stats(const vector<string>& args, ostream& os) {
+    static const char* const names[NUM_SLACK_BUCKETS] = {
+        "late", "<10us", "<100us", "<1ms", "<10ms", ">=10ms",
+    };
+
+    os << "target rtf: " << rtf << std::endl;
+    os << "actual rtf: " << actual_rtf() << std::endl;
+    os << "interval:   " << m_interval << std::endl;
+    for (size_t i = 0; i < NUM_SLACK_BUCKETS; i++)
+        os << "slack " << names[i] << ": " << m_slack[i] << std::endl;
+    return true;
+}
+
 throttle::throttle(const sc_module_name& nm):
     module(nm),
     m_throttling(false),
     m_start(mwr::timestamp_us()),
     m_extra(0),
+    m_deadline(0),
+    m_interval(),
+    m_last(),
+    m_host_start(0),
+    m_host_suspended(0),
+    m_slack(),
     update_interval("update_interval", sc_time(10.0, SC_MS)),
-    rtf("rtf", 0.0) {
+    rtf("rtf", 0.0),
+    precise("precise", false),
+    spin_time("spin_time", sc_time(100.0, SC_US)),
+    adaptive("adaptive", false) {
+    m_interval = update_interval;
+
     SC_HAS_PROCESS(throttle);
     SC_METHOD(update);
+
+    register_command("stats", 0, this, &throttle::cmd_stats,
+                     "reports actual versus target realtime factor and the "
+                     "distribution of slack per interval");
+}
+
+double throttle::actual_rtf() const {
+    if (m_host_start == 0)
+        return 0.0;
+
+    u64 host = host_ns() - m_host_start - m_host_suspended;
+    return host ? sc_time_stamp().to_seconds() / (host * 1e-9) : 0.0;
+}
+
+void throttle::end_of_simulation() {
+    module::end_of_simulation();
+    if (rtf > 0.0) {
+        log_debug("target rtf %.3f, actual rtf %.3f, %zu late intervals",
+                  rtf.get(), actual_rtf(), (size_t)m_slack[SLACK_LATE]);
+    }
 }
 
 void throttle::session_suspend() {
     m_start -= mwr::timestamp_us();
+    m_host_suspended -= host_ns();
 }
 
 void throttle::session_resume() {
     m_start += mwr::timestamp_us();
     m_extra = 0;
+    m_host_suspended += host_ns();
+    m_deadline = 0;
 }
 
 VCML_EXPORT_MODEL(vcml::meta::throttle, name, args) {
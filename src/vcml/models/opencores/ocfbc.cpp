@@ -138,15 +138,6 @@ void ocfbc::create() {
     if (!m_console.has_display())
         return;
 
-    u32 base = (stat & STAT_AVMP) ? vbarb : vbara;
-    u32 size = m_xres * m_yres * m_bpp;
-    u8* vram = nullptr;
-
-    if (allow_dmi) {
-        const range area(base, base + size - 1);
-        vram = out.lookup_dmi_ptr(area, VCML_ACCESS_READ);
-    }
-
     ui::videomode mode;
     // Below we should ideally just select the mode that suits our
     // display mode and pass our own model endianess. However, some
@@ -189,69 +180,82 @@ void ocfbc::create() {
         VCML_ERROR("unknown mode: %ubpp", m_bpp * 8);
     }
 
+    // the copy is kept around in case dmi becomes unavailable later on
+    if (m_fb != nullptr)
+        delete[] m_fb;
+    m_fb = new u8[mode.size]();
+    m_linebuf.assign(m_pc ? m_xres * m_yres : 0, 0);
+
+    m_mode = mode;
+    m_scanout = nullptr;
+    scanout();
+}
+
+void ocfbc::scanout() {
     // cannot use DMI with pseudocolor
-    if (!vram || m_pc) {
-        log_debug("copying vnc framebuffer from vram");
-        m_fb = new u8[mode.size];
-        m_console.setup(mode, m_fb);
-    } else {
-        log_debug("mapping vnc framebuffer into vram");
-        m_console.setup(mode, vram);
-        m_fb = nullptr;
+    u8* vram = nullptr;
+    if (allow_dmi && !m_pc) {
+        const range area(vram_base(), vram_base() + m_mode.size - 1);
+        vram = out.lookup_dmi_ptr(area, VCML_ACCESS_READ);
     }
-}
 
-void ocfbc::render() {
-    if (m_fb != nullptr) { // need to copy data to framebuffer manually
-        tlm_response_status rs;
+    // follows bank switches and dmi grants or invalidations
+    u8* fb = vram ? vram : m_fb;
+    if (fb == m_scanout)
+        return;
 
-        u32 burstsz = OCFBC_VBL(ctlr);
-        u32 linesz = m_xres * m_bpp;
+    if (vram)
+        log_debug("mapping framebuffer into vram at 0x%08x", vram_base());
+    else
+        log_debug("copying framebuffer from vram at 0x%08x", vram_base());
 
-        u8* linebuf = new u8[linesz];
-        memset(linebuf, 0, linesz);
+    m_console.setup(m_mode, fb);
+    m_damage.setup(m_mode, fb);
+    m_scanout = fb;
+}
 
-        u8* fb = m_fb;
+void ocfbc::fetch() {
+    // read the entire frame in one go instead of one burst at a time
+    u32 base = vram_base();
+    u8* dest = m_pc ? m_linebuf.data() : m_fb;
+    size_t size = m_pc ? m_linebuf.size() : m_mode.size;
+
+    tlm_response_status rs = out.read(base, dest, size);
+    if (failed(rs)) {
+        log_debug("failed to read vmem at 0x%08x: %s", base,
+                  tlm_response_to_str(rs));
+        stat |= STAT_SINT;
+        irq = true;
+    }
+
+    if (m_pc) {
+        u32* palette = m_palette;
+        if (stat & STAT_ACMP)
+            palette = m_palette + 0x100;
 
-        for (u32 y = 0; y < m_yres; y++) {
-            // burst-read one horizontal line of pixels into buffer
-            for (u32 x = 0; x < linesz; x += burstsz) {
-                u32 base = (stat & STAT_AVMP) ? vbarb : vbara;
-                u32 addr = base + y * linesz + x;
-                u8* dest = m_pc ? linebuf : fb;
-                if (failed(rs = out.read(addr, dest + x, burstsz))) {
-                    log_debug("failed to read vmem at 0x%08x: %s", addr,
-                              tlm_response_to_str(rs));
-                    stat |= STAT_SINT;
-                    irq = true;
-                }
-            }
-
-            if (!m_pc) {
-                fb += linesz; // done, data is already copied
-            } else {
-                u32* palette = m_palette;
-                if (stat & STAT_ACMP)
-                    palette = m_palette + 0x100;
-
-                for (u32 x = 0; x < linesz; x++) {
-                    u32 color = to_host_endian(palette[linebuf[x]]);
-                    *fb++ = (color >> 0) & 0xff;  // b
-                    *fb++ = (color >> 8) & 0xff;  // g
-                    *fb++ = (color >> 16) & 0xff; // r
-                    *fb++ = 0xff;                 // a
-                }
-            }
-
-            // Note that the HSYNC interrupt will only be triggered when
-            // DMI is not used. Otherwise, this is never executed
-            if (ctlr & CTLR_HIE) {
-                stat |= STAT_HINT;
-                irq = true;
-            }
+        u8* fb = m_fb;
+        for (u8 index : m_linebuf) {
+            u32 color = to_host_endian(palette[index]);
+            *fb++ = (color >> 0) & 0xff;  // b
+            *fb++ = (color >> 8) & 0xff;  // g
+            *fb++ = (color >> 16) & 0xff; // r
+            *fb++ = 0xff;                 // a
         }
+    }
 
-        delete[] linebuf;
+    // Note that the HSYNC interrupt will only be triggered when
+    // DMI is not used. Otherwise, this is never executed
+    if (ctlr & CTLR_HIE) {
+        stat |= STAT_HINT;
+        irq = true;
+    }
+}
+
+void ocfbc::render() {
+    if (m_console.has_display()) {
+        scanout();
+        if (m_scanout == m_fb)
+            fetch();
     }
 
     if (ctlr & CTLR_CBSWE) {
@@ -273,7 +277,19 @@ void ocfbc::render() {
         irq = true; // VSYNC interrupt
     }
 
-    m_console.render(); // output image
+    // only output what changed, redraw everything if most of it did
+    vector<ui::damage_rect> damage;
+    size_t area = m_damage.update(damage);
+    if (area == 0)
+        return;
+
+    if (area * 2 >= (size_t)m_xres * m_yres) {
+        m_console.render();
+        return;
+    }
+
+    for (const ui::damage_rect& rect : damage)
+        m_console.render(rect.x, rect.y, rect.w, rect.h);
 }
 
 void ocfbc::update() {
@@ -300,7 +316,8 @@ void ocfbc::update() {
 bool ocfbc::cmd_info(const vector<string>& args, ostream& os) {
     os << "resolution:  " << m_xres << "x" << m_yres << "@" << clock.get()
        << "Hz" << std::endl
-       << "framebuffer: " << (m_fb ? "copied" : "mapped") << std::endl
+       << "framebuffer: " << (m_scanout == m_fb ? "copied" : "mapped")
+       << std::endl
        << "interrupt:   " << (irq.read() ? "set" : "cleared") << std::endl;
     return true;
 }
@@ -310,6 +327,10 @@ ocfbc::ocfbc(const sc_module_name& nm):
     m_palette_addr(PALETTE_ADDR, PALETTE_ADDR + sizeof(m_palette)),
     m_palette(),
     m_fb(nullptr),
+    m_scanout(nullptr),
+    m_linebuf(),
+    m_mode(),
+    m_damage(),
     m_xres(0),
     m_yres(0),
     m_bpp(0),
@@ -35,9 +35,6 @@ void ockbd::update() {
         log_debug("setting IRQ");
 
     irq = !m_key_fifo.empty();
-
-    sc_time quantum = tlm_global_quantum::instance().get();
-    next_trigger(max(clock_cycle(), quantum));
 }
 
 u8 ockbd::read_khr() {
@@ -65,6 +62,7 @@ ockbd::ockbd(const sc_module_name& nm):
     m_key_fifo(),
     m_keyboard(name()),
     m_console(),
+    m_update_ev("update_ev"),
     khr("khr", 0x0, 0),
     irq("irq"),
     in("in"),
@@ -76,9 +74,15 @@ ockbd::ockbd(const sc_module_name& nm):
     khr.on_read(&ockbd::read_khr);
 
     if (m_console.has_display()) {
+        m_keyboard.set_notify([this]() {
+            on_next_update([this]() { m_update_ev.notify(SC_ZERO_TIME); });
+        });
+
         m_console.notify(m_keyboard);
         SC_HAS_PROCESS(ockbd);
         SC_METHOD(update);
+        sensitive << m_update_ev;
+        dont_initialize();
     }
 }
 
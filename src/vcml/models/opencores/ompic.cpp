@@ -16,10 +16,30 @@
 namespace vcml {
 namespace opencores {
 
+void ompic::set_pending(size_t core, bool pending) {
+    if (is_pending(core) == pending)
+        return;
+
+    m_pending[core / 64] ^= 1ull << (core % 64);
+    irq[core] = pending;
+}
+
+bool ompic::cmd_stats(const vector<string>& args, ostream& os) {
+    os << "core sent received coalesced pending";
+    for (size_t core = 0; core < m_num_cores; core++) {
+        os << std::endl
+           << "cpu" << core << " " << m_num_sent[core] << " "
+           << m_num_received[core] << " " << m_num_coalesced[core] << " "
+           << (is_pending(core) ? "yes" : "no");
+    }
+
+    return true;
+}
+
 u32 ompic::read_status(size_t core_idx) {
     VCML_ERROR_ON(core_idx >= m_num_cores, "core_id >= num_cores");
     u32 val = m_status[core_idx];
-    if (irq[core_idx].read())
+    if (is_pending(core_idx))
         val |= CTRL_IRQ_GEN;
     return val;
 }
@@ -49,16 +69,23 @@ void ompic::write_control(u32 val, size_t core_idx) {
         m_status[dest] = self << 16 | data;
         log_debug("cpu%d triggers interrupt on cpu%d (data: 0x%04x)", self,
                   dest, data);
-        if (irq[dest].read())
+        m_num_sent[self]++;
+        m_num_received[dest]++;
+        if (is_pending(dest)) {
             log_debug("interrupt already pending for cpu%d", dest);
-        irq[dest] = true;
+            m_num_coalesced[dest]++;
+        }
+
+        // raising the line wakes up the core right away, even if it is
+        // currently fast-forwarding through an idle period
+        set_pending(dest, true);
     }
 
     if (val & CTRL_IRQ_ACK) {
         log_debug("cpu%d acknowledges interrupt", self);
-        if (!irq[self].read())
+        if (!is_pending(self))
             log_debug("no pending interrupt for cpu%d", self);
-        irq[self] = false;
+        set_pending(self, false);
     }
 }
 
@@ -67,6 +94,10 @@ ompic::ompic(const sc_core::sc_module_name& nm, unsigned int num_cores):
     m_num_cores(num_cores),
     m_control(nullptr),
     m_status(nullptr),
+    m_pending((num_cores + 63) / 64),
+    m_num_sent(num_cores),
+    m_num_received(num_cores),
+    m_num_coalesced(num_cores),
     control(nullptr),
     status(nullptr),
     irq("irq"),
@@ -91,6 +122,10 @@ ompic::ompic(const sc_core::sc_module_name& nm, unsigned int num_cores):
         status[core]->on_read(&ompic::read_status);
         status[core]->tag = core;
     }
+
+    register_command("stats", 0, &ompic::cmd_stats,
+                     "reports the number of ipis sent, received and "
+                     "coalesced per core");
 }
 
 ompic::~ompic() {
@@ -105,6 +140,16 @@ ompic::~ompic() {
     delete[] m_status;
 }
 
+void ompic::reset() {
+    peripheral::reset();
+
+    for (unsigned int core = 0; core < m_num_cores; core++) {
+        m_control[core] = 0;
+        m_status[core] = 0;
+        set_pending(core, false);
+    }
+}
+
 VCML_EXPORT_MODEL(vcml::opencores::ompic, name, args) {
     VCML_ERROR_ON(args.empty(), "usage: vcml::opencores::ompic <ncpus>");
     unsigned int ncpus = from_string<unsigned int>(args[0]);
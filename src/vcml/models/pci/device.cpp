@@ -209,7 +209,10 @@ device::device(const sc_module_name& nm, const pci_config& cfg):
     m_msi(nullptr),
     m_msix(nullptr),
     m_msi_notify("msi_notify"),
-    m_msix_notify("msix_notify") {
+    m_msix_notify("msix_notify"),
+    m_moderation(),
+    m_cfg_index(),
+    m_cfg_regs() {
     pci_vendor_id.allow_read_only();
     pci_vendor_id.sync_never();
 
@@ -289,12 +292,21 @@ void device::reset() {
 
     if (m_msix)
         m_msix->reset();
+
+    for (auto& mod : m_moderation)
+        mod.events = 0;
 }
 
 tlm_response_status device::read(const range& addr, void* data,
                                  const tlm_sbi& info, address_space as) {
     if (m_msix && m_msix->bar_as == as && addr.overlaps(m_msix->tbl))
         return m_msix->read_table(addr, data);
+
+    if (u8* mem = bar_memory(as, addr)) {
+        memcpy(data, mem, addr.length());
+        return TLM_OK_RESPONSE;
+    }
+
     return peripheral::read(addr, data, info, as);
 }
 
@@ -302,10 +314,16 @@ tlm_response_status device::write(const range& addr, const void* data,
                                   const tlm_sbi& info, address_space as) {
     if (m_msix && m_msix->bar_as == as && addr.overlaps(m_msix->tbl))
         return m_msix->write_table(addr, data);
+
+    if (u8* mem = bar_memory(as, addr)) {
+        memcpy(mem, data, addr.length());
+        return TLM_OK_RESPONSE;
+    }
+
     return peripheral::write(addr, data, info, as);
 }
 
-void device::pci_declare_bar(int barno, u64 size, u32 type) {
+void device::pci_declare_bar(int barno, u64 size, u32 type, u8* memory) {
     bool is_io = type & PCI_BAR_IO;
     bool is_64 = type & PCI_BAR_64;
     bool is_prefetch = type & PCI_BAR_PREFETCH;
@@ -314,8 +332,10 @@ void device::pci_declare_bar(int barno, u64 size, u32 type) {
     VCML_ERROR_ON(is_io && is_64, "IO BAR cannot be 64 bit");
     VCML_ERROR_ON(is_io && is_prefetch, "cannot prefetch IO BAR");
     VCML_ERROR_ON(barno >= maxbar, "barno %d out of bounds", barno);
+    VCML_ERROR_ON(memory && !is_prefetch, "BAR%d must be prefetchable", barno);
 
     m_bars[barno].size = size;
+    m_bars[barno].memory = memory;
     m_bars[barno].is_io = is_io;
     m_bars[barno].is_64bit = is_64;
     m_bars[barno].is_prefetch = is_prefetch;
@@ -360,9 +380,11 @@ void device::msi_interrupt(bool state, unsigned int vector) {
         return;
 
     m_msi->set_pending(vector, state);
+    if (state)
+        moderate_irq(vector);
 
     if (!m_msi->is_masked(vector) && m_msi->is_pending(vector))
-        m_msi_notify.notify(SC_ZERO_TIME);
+        m_msi_notify.notify(moderation_delay(vector));
 }
 
 void device::msix_interrupt(bool state, unsigned int vector) {
@@ -371,9 +393,11 @@ void device::msix_interrupt(bool state, unsigned int vector) {
         return;
 
     m_msix->set_pending(vector, state);
+    if (state)
+        moderate_irq(vector);
 
     if (!m_msix->is_masked(vector) && m_msix->is_pending(vector))
-        m_msix_notify.notify(SC_ZERO_TIME);
+        m_msix_notify.notify(moderation_delay(vector));
 }
 
 void device::pci_legacy_interrupt(bool state) {
@@ -385,11 +409,98 @@ void device::pci_legacy_interrupt(bool state) {
     update_irqs();
 }
 
+void device::pci_moderate_irq(unsigned int vector, size_t count,
+                              const sc_time& delay) {
+    if (vector >= m_moderation.size())
+        m_moderation.resize(vector + 1, { 0, SC_ZERO_TIME, 0, SC_ZERO_TIME });
+
+    irq_moderation& mod = m_moderation[vector];
+    mod.count = count;
+    mod.delay = delay;
+}
+
+void device::moderate_irq(unsigned int vector) {
+    if (vector >= m_moderation.size())
+        return;
+
+    irq_moderation& mod = m_moderation[vector];
+    if (mod.events++ == 0)
+        mod.due = sc_time_stamp() + mod.delay;
+}
+
+sc_time device::moderation_delay(unsigned int vector) const {
+    if (vector >= m_moderation.size())
+        return SC_ZERO_TIME;
+
+    const irq_moderation& mod = m_moderation[vector];
+    if (mod.count && mod.events >= mod.count)
+        return SC_ZERO_TIME;
+
+    sc_time now = sc_time_stamp();
+    return mod.due > now ? mod.due - now : SC_ZERO_TIME;
+}
+
+void device::moderation_done(unsigned int vector) {
+    if (vector < m_moderation.size())
+        m_moderation[vector].events = 0;
+}
+
+void device::build_cfg_map() {
+    const vector<reg_base*>& regs = get_registers(PCI_AS_CFG);
+    VCML_ERROR_ON(regs.size() >= 256, "too many PCI config registers");
+
+    m_cfg_index.assign(pcie ? PCIE_CFG_SIZE : PCI_CFG_SIZE, 0);
+    m_cfg_regs.assign(1, nullptr);
+
+    for (reg_base* reg : regs) {
+        m_cfg_regs.push_back(reg);
+        const range& addr = reg->get_range();
+        for (u64 off = addr.start; off <= addr.end; off++) {
+            if (off < m_cfg_index.size())
+                m_cfg_index[off] = m_cfg_regs.size() - 1;
+        }
+    }
+}
+
+bool device::receive_cfg(tlm_generic_payload& tx, const tlm_sbi& info) {
+    // config registers are only ever added while capabilities get declared
+    if (m_cfg_regs.size() != get_registers(PCI_AS_CFG).size() + 1)
+        build_cfg_map();
+
+    const range span(tx);
+    if (span.end >= m_cfg_index.size())
+        return false;
+
+    set_current_cpu(info.cpuid);
+    for (u64 addr = span.start; addr <= span.end; addr++) {
+        reg_base* reg = m_cfg_regs[m_cfg_index[addr]];
+        if (reg == nullptr)
+            continue;
+
+        reg->receive(tx, info);
+
+        if (success(tx) && reg->is_natural_accesses_only())
+            break;
+
+        if (failed(tx))
+            break;
+
+        addr = reg->get_range().end;
+    }
+
+    set_current_cpu(SBI_NONE.cpuid);
+    return success(tx) || failed(tx);
+}
+
 void device::pci_transport(const pci_target_socket& sck, pci_payload& pci) {
     tlm_generic_payload tx;
     tlm_command cmd = pci_translate_command(pci.command);
     tx_setup(tx, cmd, pci.addr, &pci.data, pci.size);
-    peripheral::receive(tx, pci.debug ? SBI_DEBUG : SBI_NONE, pci.space);
+
+    const tlm_sbi& info = pci.debug ? SBI_DEBUG : SBI_NONE;
+    if (pci.space != PCI_AS_CFG || !receive_cfg(tx, info))
+        peripheral::receive(tx, info, pci.space);
+
     pci.response = pci_translate_response(tx.get_response_status());
 }
 
@@ -401,7 +512,7 @@ void device::msi_send(unsigned int vector) {
     if (m_msi->is_64bit())
         msi_addr |= (u64)(u32)*m_msi->msi_addr_hi << 32;
 
-    if (!pci_dma_write(msi_addr, sizeof(msi_data), &msi_data))
+    if (!pci_msi(msi_addr, msi_data))
         log_warn("DMA error while sending MSI%u", vector);
 }
 
@@ -410,7 +521,14 @@ void device::msi_process() {
         wait(m_msi_notify);
         for (unsigned int vec = 0; vec < m_msi->num_vectors(); vec++) {
             if (m_msi->is_pending(vec) && !m_msi->is_masked(vec)) {
+                sc_time delay = moderation_delay(vec);
+                if (delay != SC_ZERO_TIME) {
+                    m_msi_notify.notify(delay);
+                    continue;
+                }
+
                 m_msi->set_pending(vec, false);
+                moderation_done(vec);
                 msi_send(vec);
             }
         }
@@ -424,7 +542,7 @@ void device::msix_send(unsigned int vector) {
     u32 msix_data = m_msix->msix_table[vector].data;
     u64 msix_addr = m_msix->msix_table[vector].addr;
 
-    if (!pci_dma_write(msix_addr, sizeof(msix_data), &msix_data))
+    if (!pci_msi(msix_addr, msix_data))
         log_warn("DMA error while sending MSIX%u", vector);
 }
 
@@ -433,13 +551,31 @@ void device::msix_process() {
         wait(m_msix_notify);
         for (unsigned int vec = 0; vec < m_msix->num_vectors; vec++) {
             if (m_msix->is_pending(vec) && !m_msix->is_masked(vec)) {
+                sc_time delay = moderation_delay(vec);
+                if (delay != SC_ZERO_TIME) {
+                    m_msix_notify.notify(delay);
+                    continue;
+                }
+
                 m_msix->set_pending(vec, false);
+                moderation_done(vec);
                 msix_send(vec);
             }
         }
     }
 }
 
+u8* device::bar_memory(address_space as, const range& addr) const {
+    if (as < PCI_AS_BAR0 || as > PCI_AS_BAR5)
+        return nullptr;
+
+    const pci_bar& bar = m_bars[as - PCI_AS_BAR0];
+    if (!bar.memory || addr.end >= bar.size)
+        return nullptr;
+
+    return bar.memory + addr.start;
+}
+
 void device::write_bars(u32 val, size_t barno) {
     pci_bars[barno] = val;
     update_bars();
@@ -40,15 +40,38 @@ const host::pci_mapping host::MAP_NONE = {
     /* barno = */ -1,
     /* space = */ PCI_AS_CFG,
     /* addr  = */ { 0, ~0ull },
+    /* mem   = */ nullptr,
 };
 
 const host::pci_mapping& host::lookup(const pci_payload& tx, bool io) const {
     const vector<pci_mapping>& map = io ? m_map_io : m_map_mmio;
     const range addr(tx.addr, tx.addr + tx.size - 1);
-    for (auto& entry : map)
-        if (entry.addr.includes(addr))
-            return entry;
-    return MAP_NONE;
+
+    auto it = std::upper_bound(map.begin(), map.end(), addr.start,
+                               [](u64 a, const pci_mapping& entry) {
+                                   return a < entry.addr.start;
+                               });
+
+    if (it == map.begin() || !(--it)->addr.includes(addr))
+        return MAP_NONE;
+
+    return *it;
+}
+
+void host::map_bar_dmi(const pci_mapping& mapping) {
+    tlm_dmi dmi;
+    dmi.set_dmi_ptr(mapping.memory);
+    dmi.set_start_address(mapping.addr.start);
+    dmi.set_end_address(mapping.addr.end);
+    dmi.allow_read_write();
+
+    for (auto& socket : mmio_in)
+        socket.second->map_dmi(dmi);
+}
+
+void host::unmap_bar_dmi(const pci_mapping& mapping) {
+    for (auto& socket : mmio_in)
+        socket.second->unmap_dmi(mapping.addr.start, mapping.addr.end);
 }
 
 host::host(const sc_module_name& nm, bool express):
@@ -63,7 +86,9 @@ host::host(const sc_module_name& nm, bool express):
     irq_a("irq_a"),
     irq_b("irq_b"),
     irq_c("irq_c"),
-    irq_d("irq_d") {
+    irq_d("irq_d"),
+    m_msi_endpoints(),
+    m_cfg_targets() {
 }
 
 host::~host() {
@@ -77,6 +102,22 @@ const char* host::kind() const {
         return "vcml::pci::host";
 }
 
+void host::map_msi(const range& addr, const msi_handler& handler) {
+    for (const msi_endpoint& ep : m_msi_endpoints)
+        if (ep.addr.overlaps(addr))
+            VCML_ERROR("msi endpoint overlaps 0x%llx..0x%llx", ep.addr.start,
+                       ep.addr.end);
+    m_msi_endpoints.push_back({ addr, handler });
+}
+
+void host::build_cfg_targets() {
+    m_cfg_targets.assign(256, nullptr);
+    for (auto& socket : pci_out) {
+        if (socket.first < m_cfg_targets.size())
+            m_cfg_targets[socket.first] = socket.second;
+    }
+}
+
 unsigned int host::transport(tlm_generic_payload& tx, const tlm_sbi& sideband,
                              address_space space) {
     if (tx.get_command() == TLM_IGNORE_COMMAND)
@@ -162,15 +203,19 @@ void host::pci_transport_cfg(pci_payload& tx) {
     else
         cam_decode_cfg(addr, bus, devno, offset);
 
+    if (m_cfg_targets.empty())
+        build_cfg_targets();
+
     // not an error to access nonexistent devices or buses
-    if (bus != 0 || !pci_out.exists(devno)) {
+    pci_initiator_socket* target = bus ? nullptr : m_cfg_targets[devno];
+    if (target == nullptr) {
         tx.response = PCI_RESP_SUCCESS;
         tx.data = ~0u;
         return;
     }
 
     tx.addr = offset;
-    pci_out[devno].transport(tx);
+    target->transport(tx);
     tx.addr = addr;
 
     // treat nonexistent registers as reserved memory
@@ -186,12 +231,18 @@ void host::pci_bar_map(const pci_initiator_socket& s, const pci_bar& bar) {
 
     u32 devno = pci_devno(s);
     range addr(bar.addr, bar.addr + bar.size - 1);
-    pci_mapping mapping{ devno, bar.barno, space, addr };
-
-    if (bar.is_io)
-        m_map_io.push_back(mapping);
-    else
-        m_map_mmio.push_back(mapping);
+    u8* mem = bar.is_io ? nullptr : bar.memory;
+    pci_mapping mapping{ devno, bar.barno, space, addr, mem };
+
+    vector<pci_mapping>& map = bar.is_io ? m_map_io : m_map_mmio;
+    auto pos = std::upper_bound(map.begin(), map.end(), addr.start,
+                                [](u64 a, const pci_mapping& entry) {
+                                    return a < entry.addr.start;
+                                });
+    map.insert(pos, mapping);
+
+    if (mapping.memory)
+        map_bar_dmi(mapping);
 }
 
 void host::pci_bar_unmap(const pci_initiator_socket& socket, int barno) {
@@ -200,6 +251,10 @@ void host::pci_bar_unmap(const pci_initiator_socket& socket, int barno) {
         return entry.devno == devno && entry.barno == barno;
     };
 
+    for (const pci_mapping& entry : m_map_mmio)
+        if (match(entry) && entry.memory)
+            unmap_bar_dmi(entry);
+
     stl_remove_if(m_map_mmio, match);
     stl_remove_if(m_map_io, match);
 }
@@ -246,6 +301,13 @@ void host::pci_interrupt(const pci_initiator_socket& socket, pci_irq irq,
     }
 }
 
+bool host::pci_msi(const pci_initiator_socket& socket, u64 addr, u32 data) {
+    for (const msi_endpoint& ep : m_msi_endpoints)
+        if (ep.addr.includes(addr))
+            return ep.handler(addr, data);
+    return pci_dma_write(socket, addr, sizeof(data), &data);
+}
+
 VCML_EXPORT_MODEL(vcml::pci::host, name, args) {
     return new host(name, false);
 }
@@ -27,7 +27,7 @@ void aclint::write_mtimecmp(u64 val, size_t hart) {
         return;
 
     mtimecmp[hart] = val;
-    update_timer();
+    update_timer(hart);
 }
 
 u32 aclint::read_msip(size_t hart) {
@@ -70,24 +70,25 @@ void aclint::write_ssip(u32 val, size_t hart) {
     irq_sswi[hart].write(val != 0);
 }
 
-void aclint::update_timer() {
+void aclint::update_timer(size_t hart) {
     u64 mtime = get_cycles();
-
-    for (auto& [hart, port] : irq_mtimer) {
-        u64 mcomp = mtimecmp.get(hart);
-        port->write(mtime >= mcomp);
-
-        if (mtime >= mcomp)
-            log_debug("triggering hart %zu timer interrupt", hart);
-        else if (mcomp != ~0ull)
-            m_trigger.notify(clock_cycles(mcomp - mtime));
+    u64 mcomp = mtimecmp.get(hart);
+    irq_mtimer[hart].write(mtime >= mcomp);
+
+    if (mtime >= mcomp) {
+        log_debug("triggering hart %zu timer interrupt", hart);
+        m_timers.cancel(hart);
+    } else if (mcomp != ~0ull) {
+        m_timers.arm(hart, clock_cycles(mcomp - mtime));
+    } else {
+        m_timers.cancel(hart);
     }
 }
 
 aclint::aclint(const sc_module_name& nm):
     peripheral(nm),
     m_time_reset(),
-    m_trigger("triggerev"),
+    m_timers([this](size_t hart) { update_timer(hart); }),
     comp_base("comp_base", 0x0000),
     time_base("time_base", 0x7ff8),
     mtimecmp(ACLINT_AS_MTIMER, "mtimecmp", comp_base, 0),
@@ -117,11 +118,6 @@ aclint::aclint(const sc_module_name& nm):
     ssip.allow_read_write();
     ssip.on_read(&aclint::read_ssip);
     ssip.on_write(&aclint::write_ssip);
-
-    SC_HAS_PROCESS(aclint);
-    SC_METHOD(update_timer);
-    sensitive << m_trigger;
-    dont_initialize();
 }
 
 aclint::~aclint() {
@@ -132,6 +128,7 @@ void aclint::reset() {
     peripheral::reset();
 
     m_time_reset = sc_time_stamp();
+    m_timers.cancel_all();
 }
 
 VCML_EXPORT_MODEL(vcml::riscv::aclint, name, args) {
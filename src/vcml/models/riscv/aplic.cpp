@@ -94,6 +94,7 @@ void aplic::set_pending(irqinfo* irq, bool pending) {
         return;
 
     irq->pending = pending;
+    set_ready(irq);
     update(irq);
 }
 
@@ -105,9 +106,18 @@ void aplic::set_enabled(irqinfo* irq, bool enabled) {
         return;
 
     irq->enabled = enabled;
+    set_ready(irq);
     update(irq);
 }
 
+void aplic::set_ready(irqinfo* irq) {
+    size_t pos = irq - m_irqs;
+    if (irq->enabled && irq->pending)
+        m_ready[pos / 64] |= 1ull << (pos % 64);
+    else
+        m_ready[pos / 64] &= ~(1ull << (pos % 64));
+}
+
 u32 aplic::read_sourcecfg(size_t idx) {
     irqinfo* irq = m_irqs + idx;
     return irq->sourcecfg;
@@ -162,13 +172,16 @@ u32 aplic::read_topi(size_t idx) {
     u32 best_prio = -1;
     u32 threshold = idcs[idx]->ithreshold;
 
-    for (irqinfo& irq : m_irqs) {
-        u32 hart = get_field<TARGETCFG_HART>(irq.targetcfg);
-        u32 prio = get_field<TARGETCFG_PRIO>(irq.targetcfg);
-        if (irq.enabled && irq.pending && hart == idx && prio <= best_prio &&
-            (threshold == 0 || prio < threshold)) {
-            best_irq = irq.idx;
-            best_prio = prio;
+    for (size_t word = 0; word < NIRQ / 64 + 1; word++) {
+        for (u64 bits = m_ready[word]; bits; bits &= bits - 1) {
+            irqinfo& irq = m_irqs[word * 64 + ctz(bits)];
+            u32 hart = get_field<TARGETCFG_HART>(irq.targetcfg);
+            u32 prio = get_field<TARGETCFG_PRIO>(irq.targetcfg);
+            if (hart == idx && prio <= best_prio &&
+                (threshold == 0 || prio < threshold)) {
+                best_irq = irq.idx;
+                best_prio = prio;
+            }
         }
     }
 
@@ -190,6 +203,7 @@ u32 aplic::read_claimi(size_t idx) {
 
     u32 eiid = get_field<TOPI_EIID>(topi);
     m_irqs[eiid - 1].pending = false;
+    set_ready(m_irqs + eiid - 1);
     send_irq(idx);
     return topi;
 }
@@ -362,23 +376,23 @@ void aplic::write_genmsi(u32 val) {
     u32 eiid = genmsi.get_field<GENMSI_EIID>();
 
     genmsi |= GENMSI_BUSY;
-    send_msi(hart, 0, eiid);
+    send_msi(msi_address(hart, 0), eiid);
     genmsi &= ~GENMSI_BUSY;
 }
 
 void aplic::write_idelivery(u32 val, size_t idx) {
     idcs[idx]->idelivery = val & 1;
-    update();
+    send_irq(idx);
 }
 
 void aplic::write_iforce(u32 val, size_t idx) {
     idcs[idx]->iforce = val & 1;
-    update();
+    send_irq(idx);
 }
 
 void aplic::write_ithreshold(u32 val, size_t idx) {
     idcs[idx]->ithreshold = val & 0xff;
-    update();
+    send_irq(idx);
 }
 
 void aplic::notify(size_t idx, bool level) {
@@ -402,6 +416,7 @@ void aplic::notify(size_t idx, bool level) {
     case SM_LEVEL_HI:
         if (level) {
             irq->pending = true;
+            set_ready(irq);
             update(irq);
         }
         break;
@@ -410,6 +425,7 @@ void aplic::notify(size_t idx, bool level) {
     case SM_LEVEL_LO:
         if (!level) {
             irq->pending = true;
+            set_ready(irq);
             update(irq);
         }
         break;
@@ -420,9 +436,13 @@ void aplic::notify(size_t idx, bool level) {
 }
 
 void aplic::update() {
-    for (irqinfo& irq : m_irqs) {
-        if (irq.connected)
-            update(&irq);
+    // only sources that are enabled and pending can have an effect
+    for (size_t word = 0; word < NIRQ / 64 + 1; word++) {
+        for (u64 bits = m_ready[word]; bits; bits &= bits - 1) {
+            irqinfo* irq = m_irqs + word * 64 + ctz(bits);
+            if (irq->connected)
+                update(irq);
+        }
     }
 }
 
@@ -432,19 +452,20 @@ void aplic::update(irqinfo* irq) {
 
     if (is_msi()) {
         irq->pending = false;
+        set_ready(irq);
 
         u32 hart = get_field<TARGETCFG_HART>(irq->targetcfg);
         u32 gidx = get_field<TARGETCFG_GIDX>(irq->targetcfg);
         u32 eiid = get_field<TARGETCFG_EIID>(irq->targetcfg);
 
-        send_msi(hart, gidx, eiid);
+        queue_msi(hart, gidx, eiid);
     } else {
         u32 hart = get_field<TARGETCFG_HART>(irq->targetcfg);
         send_irq(hart);
     }
 }
 
-void aplic::send_msi(u32 target, u32 guest, u32 eiid) {
+u64 aplic::msi_address(u32 target, u32 guest) {
     aplic* r = root();
 
     u32 msicfglo, msicfghi;
@@ -475,11 +496,34 @@ void aplic::send_msi(u32 target, u32 guest, u32 eiid) {
     ppn |= (u64)hart << lhxs;
     ppn |= (u64)guest;
 
-    u64 addr = ppn << 12;
+    return ppn << 12;
+}
+
+void aplic::send_msi(u64 addr, u32 eiid) {
+    if (failed(msi.writew(addr, eiid)))
+        log_warn("error sending msi %u to 0x%llx", eiid, addr);
+}
+
+void aplic::queue_msi(u32 hart, u32 guest, u32 eiid) {
+    // an msi that is still queued need not be signaled twice
+    pair<u64, u32> msi(msi_address(hart, guest), eiid);
+    if (stl_contains(m_msis, msi))
+        return;
 
-    if (failed(msi.writew(addr, eiid))) {
-        log_warn("error sending msi %u to 0x%llx (group:%u hart:%u guest:%u)",
-                 eiid, addr, group, hart, guest);
+    if (m_msis.empty())
+        m_msi_ev.notify(SC_ZERO_TIME);
+    m_msis.push_back(msi);
+}
+
+void aplic::msi_thread() {
+    vector<pair<u64, u32>> msis;
+    while (true) {
+        wait(m_msi_ev);
+
+        msis.swap(m_msis);
+        for (const auto& [addr, eiid] : msis)
+            send_msi(addr, eiid);
+        msis.clear();
     }
 }
 
@@ -537,6 +581,9 @@ aplic::aplic(const sc_module_name& nm, aplic* parent):
     m_parent(parent),
     m_children(),
     m_irqs(),
+    m_ready(),
+    m_msis(),
+    m_msi_ev("msi_ev"),
     mmode("mmode", parent == nullptr),
     domaincfg("domaincfg", 0x0000, 0x80000000),
     sourcecfg("sourcecfg", 0x0004, 0),
@@ -674,6 +721,9 @@ aplic::aplic(const sc_module_name& nm, aplic* parent):
 
     if (m_parent)
         m_parent->m_children.push_back(this);
+
+    SC_HAS_PROCESS(aplic);
+    SC_THREAD(msi_thread);
 }
 
 aplic::~aplic() {
@@ -692,6 +742,9 @@ void aplic::reset() {
         m_irqs[i].enabled = false;
         m_irqs[i].pending = false;
     }
+
+    memset(m_ready, 0, sizeof(m_ready));
+    m_msis.clear();
 }
 
 void aplic::end_of_elaboration() {
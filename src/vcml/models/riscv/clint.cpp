@@ -43,34 +43,32 @@ void clint::write_mtimecmp(u64 val, size_t hart) {
         return;
 
     mtimecmp[hart] = val;
-    update_timer();
+    update_timer(hart);
 }
 
 u64 clint::read_mtime() {
     return get_cycles();
 }
 
-void clint::update_timer() {
+void clint::update_timer(size_t hart) {
     u64 mtime = get_cycles();
-
-    for (auto it : irq_timer) {
-        auto hart = it.first;
-        auto port = it.second;
-
-        u64 mcomp = mtimecmp.get(hart);
-        port->write(mtime >= mcomp);
-
-        if (mtime >= mcomp)
-            log_debug("triggering hart %zu timer interrupt", it.first);
-        else if (mcomp != ~0ull)
-            m_trigger.notify(clock_cycles(mcomp - mtime));
+    u64 mcomp = mtimecmp.get(hart);
+    irq_timer[hart].write(mtime >= mcomp);
+
+    if (mtime >= mcomp) {
+        log_debug("triggering hart %zu timer interrupt", hart);
+        m_timers.cancel(hart);
+    } else if (mcomp != ~0ull) {
+        m_timers.arm(hart, clock_cycles(mcomp - mtime));
+    } else {
+        m_timers.cancel(hart);
     }
 }
 
 clint::clint(const sc_module_name& nm):
     peripheral(nm),
     m_time_reset(),
-    m_trigger("triggerev"),
+    m_timers([this](size_t hart) { update_timer(hart); }),
     msip("msip", 0x0000, 0),
     mtimecmp("mtimecmp", 0x4000, 0),
     mtime("mtime", 0xbff8, 0),
@@ -89,11 +87,6 @@ clint::clint(const sc_module_name& nm):
     mtime.sync_on_read();
     mtime.allow_read_only();
     mtime.on_read(&clint::read_mtime);
-
-    SC_HAS_PROCESS(clint);
-    SC_METHOD(update_timer);
-    sensitive << m_trigger;
-    dont_initialize();
 }
 
 clint::~clint() {
@@ -104,6 +97,7 @@ void clint::reset() {
     peripheral::reset();
 
     m_time_reset = sc_time_stamp();
+    m_timers.cancel_all();
 }
 
 VCML_EXPORT_MODEL(vcml::riscv::clint, name, args) {
@@ -0,0 +1,59 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/riscv/mtimer.h"
+
+namespace vcml {
+namespace riscv {
+
+deadline_timer* mtimer::lookup(size_t hart) {
+    auto& timer = m_harts[hart];
+    if (!timer) {
+        auto expire = [this, hart]() -> void { m_expire(hart); };
+        timer = std::make_unique<deadline_timer>(expire);
+    }
+
+    return timer.get();
+}
+
+mtimer::mtimer(const handler& expire): m_expire(expire), m_harts() {
+    VCML_ERROR_ON(!m_expire, "no timer expiry handler given");
+}
+
+bool mtimer::is_armed(size_t hart) const {
+    auto it = m_harts.find(hart);
+    return it != m_harts.end() && it->second->is_pending();
+}
+
+void mtimer::arm(size_t hart, const sc_time& delay) {
+    lookup(hart)->reset(delay);
+}
+
+void mtimer::cancel(size_t hart) {
+    auto it = m_harts.find(hart);
+    if (it != m_harts.end())
+        it->second->cancel();
+}
+
+void mtimer::cancel_all() {
+    for (auto& [hart, timer] : m_harts)
+        timer->cancel();
+}
+
+sc_time mtimer::next_deadline() const {
+    sc_time next = SC_MAX_TIME;
+    for (const auto& [hart, timer] : m_harts)
+        if (timer->is_pending() && timer->timeout() < next)
+            next = timer->timeout();
+    return next;
+}
+
+} // namespace riscv
+} // namespace vcml
@@ -16,7 +16,9 @@ namespace riscv {
 plic::context::context(size_t no):
     enabled(),
     threshold(mkstr("ctx%zu_threshold", no), BASE + no * SIZE + 0),
-    claim(mkstr("ctx%zu_claim", no), BASE + no * SIZE + 4) {
+    claim(mkstr("ctx%zu_claim", no), BASE + no * SIZE + 4),
+    eligible(),
+    stale(true) {
     threshold.allow_read_write();
     threshold.on_write(&plic::write_threshold);
     threshold.tag = no;
@@ -59,22 +61,6 @@ bool plic::is_claimed(size_t irqno) const {
     return m_claims[irqno] < NCTX;
 }
 
-bool plic::is_enabled(size_t irqno, size_t ctxno) const {
-    VCML_ERROR_ON(irqno >= NIRQ, "invalid irq %zu", irqno);
-    VCML_ERROR_ON(ctxno >= NCTX, "invalid context %zu", ctxno);
-
-    if (irqno == 0)
-        return false;
-
-    if (m_contexts[ctxno] == nullptr)
-        return false;
-
-    unsigned int regno = irqno / 32;
-    unsigned int shift = irqno % 32;
-
-    return (m_contexts[ctxno]->enabled[regno]->get() >> shift) & 0b1;
-}
-
 u32 plic::irq_priority(size_t irqno) const {
     if (irqno == 0) {
         log_debug("attempt to read priority of invalid irq%zu\n", irqno);
@@ -84,13 +70,6 @@ u32 plic::irq_priority(size_t irqno) const {
     return priority.get(irqno);
 }
 
-u32 plic::ctx_threshold(size_t ctxno) const {
-    context* ctx = m_contexts[ctxno];
-    if (ctx == nullptr)
-        return 0u;
-    return ctx->threshold;
-}
-
 u32 plic::read_pending(size_t regno) {
     unsigned int irqbase = regno * 32;
 
@@ -107,19 +86,11 @@ u32 plic::read_pending(size_t regno) {
 }
 
 u32 plic::read_claim(size_t ctxno) {
-    unsigned int irq = 0;
-    unsigned int threshold = ctx_threshold(ctxno);
-
-    for (unsigned int irqno = 0; irqno < NIRQ; irqno++) {
-        if (is_pending(irqno) && is_enabled(irqno, ctxno) &&
-            !is_claimed(irqno) && irq_priority(irqno) > threshold) {
-            irq = irqno;
-            threshold = irq_priority(irqno);
-        }
-    }
-
-    if (irq > 0)
+    unsigned int irq = best_irq(ctxno);
+    if (irq > 0) {
         m_claims[irq] = ctxno;
+        update_pending(irq);
+    }
 
     log_debug("context %zu claims irq %u", ctxno, irq);
 
@@ -130,6 +101,7 @@ u32 plic::read_claim(size_t ctxno) {
 
 void plic::write_priority(u32 value, size_t irqno) {
     priority[irqno] = value;
+    invalidate_contexts();
     update();
 }
 
@@ -137,12 +109,14 @@ void plic::write_enabled(u32 value, size_t regno) {
     unsigned int ctxno = regno / (NIRQ / 32);
     unsigned int subno = regno % (NIRQ / 32);
     m_contexts[ctxno]->enabled[subno]->set(value);
-    update();
+    m_contexts[ctxno]->stale = true;
+    update(ctxno);
 }
 
 void plic::write_threshold(u32 value, size_t ctxno) {
     m_contexts[ctxno]->threshold = value;
-    update();
+    m_contexts[ctxno]->stale = true;
+    update(ctxno);
 }
 
 void plic::write_complete(u32 value, size_t ctxno) {
@@ -156,28 +130,96 @@ void plic::write_complete(u32 value, size_t ctxno) {
         log_debug("context %zu completes unclaimed irq %u", ctxno, value);
 
     m_claims[irq] = ~0u;
+    update_pending(irq);
     update();
 }
 
-void plic::update() {
-    for (auto ctx : irqt) {
-        ctx.second->write(false);
-        u32 th = ctx_threshold(ctx.first);
-
-        for (auto irq : irqs) {
-            if (is_pending(irq.first) && is_enabled(irq.first, ctx.first) &&
-                !is_claimed(irq.first) && irq_priority(irq.first) > th) {
-                ctx.second->write(true);
-                log_debug("forwarding irq %zu to context %zu", irq.first,
-                          ctx.first);
+void plic::update_pending(size_t irqno) {
+    u64 mask = 1ull << (irqno % 64);
+    if (is_pending(irqno) && !is_claimed(irqno))
+        m_pending[irqno / 64] |= mask;
+    else
+        m_pending[irqno / 64] &= ~mask;
+}
+
+void plic::update_eligible(context* ctx) {
+    if (!ctx->stale)
+        return;
+
+    u32 th = ctx->threshold;
+    for (size_t word = 0; word < NIRQ / 64; word++) {
+        u64 bits = ((u64)ctx->enabled[2 * word + 1]->get() << 32) |
+                   ctx->enabled[2 * word]->get();
+        if (word == 0)
+            bits &= ~1ull; // irq0 does not exist
+
+        for (u64 todo = bits; todo; todo &= todo - 1) {
+            size_t irqno = word * 64 + ctz(todo);
+            if (irq_priority(irqno) <= th)
+                bits &= ~(1ull << (irqno % 64));
+        }
+
+        ctx->eligible[word] = bits;
+    }
+
+    ctx->stale = false;
+}
+
+void plic::invalidate_contexts() {
+    for (context* ctx : m_contexts)
+        if (ctx != nullptr)
+            ctx->stale = true;
+}
+
+size_t plic::best_irq(size_t ctxno) {
+    context* ctx = m_contexts[ctxno];
+    if (ctx == nullptr)
+        return 0;
+
+    update_eligible(ctx);
+
+    // lowest irq number wins among equal priorities
+    size_t irq = 0;
+    u32 prio = 0;
+    for (size_t word = 0; word < NIRQ / 64; word++) {
+        u64 bits = ctx->eligible[word] & m_pending[word];
+        for (; bits; bits &= bits - 1) {
+            size_t irqno = word * 64 + ctz(bits);
+            if (irq == 0 || irq_priority(irqno) > prio) {
+                irq = irqno;
+                prio = irq_priority(irqno);
             }
         }
     }
+
+    return irq;
+}
+
+void plic::update(size_t ctxno) {
+    context* ctx = m_contexts[ctxno];
+    if (ctx == nullptr)
+        return;
+
+    update_eligible(ctx);
+
+    bool irq = false;
+    for (size_t word = 0; word < NIRQ / 64 && !irq; word++)
+        irq = ctx->eligible[word] & m_pending[word];
+
+    if (irq)
+        log_debug("forwarding irq to context %zu", ctxno);
+    irqt[ctxno].write(irq);
+}
+
+void plic::update() {
+    for (auto ctx : irqt)
+        update(ctx.first);
 }
 
 plic::plic(const sc_module_name& nm):
     peripheral(nm),
     m_claims(),
+    m_pending(),
     m_contexts(),
     priority("priority", 0x0, 0),
     pending("pending", 0x1000, 0),
@@ -205,8 +247,12 @@ plic::~plic() {
 void plic::reset() {
     peripheral::reset();
 
-    for (unsigned int irq = 0; irq < NIRQ; irq++)
+    for (unsigned int irq = 0; irq < NIRQ; irq++) {
         m_claims[irq] = ~0u;
+        update_pending(irq);
+    }
+
+    invalidate_contexts();
 }
 
 void plic::end_of_elaboration() {
@@ -219,6 +265,7 @@ void plic::end_of_elaboration() {
 void plic::gpio_notify(const gpio_target_socket& socket) {
     unsigned int irqno = irqs.index_of(socket);
     log_debug("irq %u %s", irqno, socket.read() ? "set" : "cleared");
+    update_pending(irqno);
     update();
 }
 
@@ -9,6 +9,8 @@
  ******************************************************************************/
 
 #include "vcml/models/riscv/simdev.h"
+#include "vcml/core/roi.h"
+#include "vcml/tracing/tracer.h"
 
 namespace vcml {
 namespace riscv {
@@ -41,17 +43,85 @@ void simdev::write_finish(u32 val) {
     }
 }
 
+u32 simdev::read_roib() {
+    return roi_active() ? 1 : 0;
+}
+
+void simdev::write_roib(u32 val) {
+    roi_begin(roi_tracing);
+}
+
+void simdev::write_roie(u32 val) {
+    roi_end(roi_tracing);
+    platform_dump_stats(stats_file, mkstr("region of interest %u", val));
+}
+
+void simdev::write_srst(u32 val) {
+    log_debug("statistics reset requested by cpu %d", current_cpu());
+    platform_reset_stats();
+}
+
+void simdev::write_sdmp(u32 val) {
+    string now = sc_time_stamp().to_string();
+    string title = mkstr("statistics dump %u at %s", val, now.c_str());
+    platform_dump_stats(stats_file, title);
+}
+
+void simdev::write_ckpt(u32 val) {
+    string path = checkpoint_file;
+    if (val != 0)
+        path = mkstr("%s.%u", path.c_str(), val);
+    if (!platform_checkpoint(path))
+        log_warn("cannot save checkpoint %s: no system", path.c_str());
+}
+
 simdev::simdev(const sc_module_name& nm):
-    peripheral(nm), finish("finish", 0x0, 0), in("in") {
+    peripheral(nm),
+    finish("finish", 0x0, 0),
+    roib("roib", 0x10, 0),
+    roie("roie", 0x14, 0),
+    srst("srst", 0x18, 0),
+    sdmp("sdmp", 0x1c, 0),
+    ckpt("ckpt", 0x20, 0),
+    roi_tracing("roi_tracing", false),
+    stats_file("stats_file", ""),
+    checkpoint_file("checkpoint_file", "simdev.ckpt"),
+    in("in") {
     finish.sync_always();
     finish.allow_read_write();
     finish.on_write(&simdev::write_finish);
+
+    roib.sync_always();
+    roib.allow_read_write();
+    roib.on_read(&simdev::read_roib);
+    roib.on_write(&simdev::write_roib);
+
+    roie.sync_always();
+    roie.allow_read_write();
+    roie.on_write(&simdev::write_roie);
+
+    srst.sync_always();
+    srst.allow_read_write();
+    srst.on_write(&simdev::write_srst);
+
+    sdmp.sync_always();
+    sdmp.allow_read_write();
+    sdmp.on_write(&simdev::write_sdmp);
+
+    ckpt.allow_read_write();
+    ckpt.on_write(&simdev::write_ckpt);
 }
 
 simdev::~simdev() {
     // nothing to do
 }
 
+void simdev::start_of_simulation() {
+    peripheral::start_of_simulation();
+    if (roi_tracing)
+        tracer::pause();
+}
+
 VCML_EXPORT_MODEL(vcml::riscv::simdev, name, args) {
     return new simdev(name);
 }
@@ -12,6 +12,9 @@
 
 #define SDHC_BLKLEN 512
 
+#define SD_BULK_MINBLK 8
+#define SD_BULK_MAXSIZE (128 * KiB)
+
 namespace vcml {
 namespace sd {
 
@@ -22,7 +25,7 @@ static bool check_crc7(const sd_command& tx) {
         (u8)(tx.argument >> 8),  (u8)(tx.argument >> 0),
     };
 
-    return (crc7(buffer, sizeof(buffer)) | 1) == tx.crc;
+    return (crc7_sd(buffer, sizeof(buffer)) | 1) == tx.crc;
 }
 
 void card::make_r0(sd_command& tx) {
@@ -41,7 +44,7 @@ void card::make_r1(sd_command& tx) {
     tx.response[2] = m_status >> 16;
     tx.response[3] = m_status >> 8;
     tx.response[4] = m_status >> 0;
-    tx.response[5] = crc7(tx.response, 5) | 1;
+    tx.response[5] = crc7_sd(tx.response, 5) | 1;
     tx.resp_len = 6;
 
     m_status &= ~(OUT_OF_RANGE | ADDRESS_ERROR | BLOCK_LEN_ERROR |
@@ -108,7 +111,7 @@ void card::make_r6(sd_command& tx) {
         tx.response[4] |= APP_CMD;
     if (m_status & AKE_SEQ_ERROR)
         tx.response[4] |= AKE_SEQ_ERROR;
-    tx.response[5] = crc7(tx.response, 5) | 1;
+    tx.response[5] = crc7_sd(tx.response, 5) | 1;
     tx.resp_len = 6;
 }
 
@@ -123,7 +126,7 @@ void card::make_r7(sd_command& tx) {
     tx.response[2] = m_hvs >> 16;
     tx.response[3] = m_hvs >> 8;
     tx.response[4] = m_hvs >> 0;
-    tx.response[5] = crc7(tx.response, 5) | 1;
+    tx.response[5] = crc7_sd(tx.response, 5) | 1;
     tx.resp_len = 6;
 }
 
@@ -221,6 +224,82 @@ void card::setup_rx(u8* data, size_t len) {
     m_state = RECEIVING;
 }
 
+bool card::use_prefetch(size_t offset) {
+    std::shared_ptr<prefetch> pf = std::move(m_prefetch);
+    if (!pf || !pf->ready || !pf->success || pf->offset != offset)
+        return false;
+
+    m_bulk.swap(pf->data);
+    m_bulkoff = offset;
+    return true;
+}
+
+void card::prefetch_bulk(size_t offset, size_t size) {
+    if (offset >= disk.capacity())
+        return;
+
+    auto pf = std::make_shared<prefetch>();
+    pf->offset = offset;
+    pf->ready = false;
+    pf->success = false;
+    pf->data.resize(min(size, disk.capacity() - offset));
+    m_prefetch = pf;
+
+    disk.read_async(offset, pf->data.data(), pf->data.size(),
+                    [pf](bool success) -> void {
+                        pf->success = success;
+                        pf->ready = true;
+                    });
+}
+
+bool card::in_bulk(size_t offset, size_t blklen) const {
+    return !m_bulkwr && offset >= m_bulkoff &&
+           offset + blklen <= m_bulkoff + m_bulk.size();
+}
+
+void card::load_bulk(size_t offset, size_t blklen) {
+    // windows grow with the transfer, so that short reads stay cheap
+    size_t size = max<size_t>(m_numblk, SD_BULK_MINBLK) * blklen * 2;
+    size = min<size_t>(size, SD_BULK_MAXSIZE);
+    size = min(size, disk.capacity() - offset);
+    size -= size % blklen;
+
+    if (!use_prefetch(offset) || m_bulk.size() < blklen) {
+        m_bulk.resize(size);
+        m_bulkoff = offset;
+        disk.read_at(offset, m_bulk.data(), size);
+    }
+
+    size = min<size_t>(m_bulk.size() * 2, SD_BULK_MAXSIZE);
+    prefetch_bulk(m_bulkoff + m_bulk.size(), size - size % blklen);
+}
+
+void card::queue_bulk(size_t offset, size_t blklen) {
+    if (!m_bulkwr || offset != m_bulkoff + m_bulk.size()) {
+        flush_bulk();
+        m_bulk.clear();
+        m_bulkoff = offset;
+        m_bulkwr = true;
+    }
+
+    m_bulk.insert(m_bulk.end(), m_buffer, m_buffer + blklen);
+    if (m_bulk.size() >= SD_BULK_MAXSIZE)
+        flush_bulk();
+}
+
+void card::flush_bulk() {
+    if (!m_bulkwr)
+        return;
+
+    if (!m_bulk.empty()) {
+        disk.write_at(m_bulkoff, m_bulk.data(), m_bulk.size());
+        disk.flush();
+    }
+
+    m_bulk.clear();
+    m_bulkwr = false;
+}
+
 void card::setup_tx_blk(size_t offset) {
     size_t blklen = is_sdhc() ? SDHC_BLKLEN : m_blklen;
     if (offset % blklen) {
@@ -234,13 +313,20 @@ void card::setup_tx_blk(size_t offset) {
     }
 
     m_curoff = offset;
-    disk.seek(m_curoff);
-    disk.read(m_buffer, blklen);
+    if (m_curcmd == 18 && !in_bulk(offset, blklen)) // READ_MULTIPLE_BLOCK
+        load_bulk(offset, blklen);
+
+    if (in_bulk(offset, blklen)) {
+        memcpy(m_buffer, m_bulk.data() + offset - m_bulkoff, blklen);
+    } else {
+        disk.read_at(m_curoff, m_buffer, blklen);
+    }
 
     if (m_do_crc) {
-        u16 crc = crc16(m_buffer, m_blklen);
-        m_buffer[blklen + 0] = (u8)(crc >> 8);
-        m_buffer[blklen + 1] = (u8)(crc >> 0);
+        u16 sum = 0;
+        crc.run([&]() -> void { sum = crc16_sd(m_buffer, m_blklen); }, blklen);
+        m_buffer[blklen + 0] = (u8)(sum >> 8);
+        m_buffer[blklen + 1] = (u8)(sum >> 0);
     } else {
         m_buffer[blklen + 0] = 0xdc; /* don't care */
         m_buffer[blklen + 1] = 0xdc;
@@ -306,7 +392,7 @@ void card::init_cid() {
                       // reserved)
     m_cid[14] = 0x21; // year: 0x12 = 18, month: 0x1 = 1
 
-    m_cid[15] = crc7(m_cid, sizeof(m_cid) - 1);
+    m_cid[15] = crc7_sd(m_cid, sizeof(m_cid) - 1);
 }
 
 void card::init_csd_sdsc() {
@@ -341,7 +427,7 @@ void card::init_csd_sdsc() {
     m_csd[12] = (1 << 7) | ((read_bl_len >> 2) & 3); // R2W -> 1:1
     m_csd[13] = ((read_bl_len & 3) << 6) | (1 << 5); // part. WR OK
     m_csd[14] = 0x00; // hard disk type, original data, no protect
-    m_csd[15] = crc7(m_csd, sizeof(m_csd) - 1) | 1;
+    m_csd[15] = crc7_sd(m_csd, sizeof(m_csd) - 1) | 1;
 }
 
 void card::init_csd_sdhc() {
@@ -373,7 +459,7 @@ void card::init_csd_sdhc() {
     m_csd[12] = 0x0a; // WP_GRP_EN | R2W_FACTOR | WRITE_BL_LEN[3:2]
     m_csd[13] = 0x40; // WRITE_BL_LEN[1:0] | WRITE_BL_PARTIAL
     m_csd[14] = 0x00; // FORMAT_GRP | CPY | PRM_WP | TMP_WP | FORMAT
-    m_csd[15] = crc7(m_csd, sizeof(m_csd) - 1) | 1;
+    m_csd[15] = crc7_sd(m_csd, sizeof(m_csd) - 1) | 1;
 }
 
 void card::init_csd() {
@@ -459,9 +545,9 @@ void card::switch_function(u32 arg) {
     m_swf[17] = 0; // 0: structure version (first 17 bytes present)
                    // 1: extended version (12 more bytes present)
 
-    u16 crc = crc16(m_swf, 64);
-    m_swf[64] = crc >> 8;
-    m_swf[65] = crc & 0xff;
+    u16 sum = crc16_sd(m_swf, 64);
+    m_swf[64] = sum >> 8;
+    m_swf[65] = sum & 0xff;
 }
 
 sd_status card::do_normal_command(sd_command& tx) {
@@ -756,8 +842,8 @@ sd_status card::do_application_command(sd_command& tx) {
         m_buffer[1] = (u8)(m_numblk >> 16);
         m_buffer[2] = (u8)(m_numblk >> 8);
         m_buffer[3] = (u8)(m_numblk >> 0);
-        m_buffer[4] = (u8)(crc16(m_buffer, 4) >> 8);
-        m_buffer[5] = (u8)(crc16(m_buffer, 4) >> 0);
+        m_buffer[4] = (u8)(crc16_sd(m_buffer, 4) >> 8);
+        m_buffer[5] = (u8)(crc16_sd(m_buffer, 4) >> 0);
         setup_tx(m_buffer, 6);
         make_r1(tx);
         return SD_OK_TX_RDY;
@@ -856,24 +942,31 @@ sd_status_rx card::do_data_write(u8 val) {
         VCML_ERROR("unsupported write CMD%hhu", m_curcmd);
 
     size_t blklen = is_sdhc() ? SDHC_BLKLEN : m_blklen;
-    u16 crc = (u16)m_buffer[blklen] << 8 | (u16)m_buffer[blklen + 1];
-    if (crc != crc16(m_buffer, blklen)) {
+    u16 sum = 0;
+    crc.run([&]() -> void { sum = crc16_sd(m_buffer, blklen); }, blklen);
+    if (sum != ((u16)m_buffer[blklen] << 8 | (u16)m_buffer[blklen + 1])) {
         log_debug("CRC mismatch on received data");
         return SDRX_ERR_CRC;
     }
 
-    disk.seek(m_curoff);
-    disk.write(m_buffer, blklen);
-    disk.flush();
-
+    m_prefetch = nullptr;
     m_numblk++;
 
-    if (m_curcmd == 24) // writing only single block?
+    if (m_curcmd == 24) { // writing only single block?
+        flush_bulk();
+        m_bulk.clear();
+        disk.write_at(m_curoff, m_buffer, blklen);
+        disk.flush();
         return SDRX_OK_COMPLETE;
+    }
+
+    queue_bulk(m_curoff, blklen);
 
     size_t offset = m_curoff + blklen;
-    if (offset + blklen > disk.capacity()) // reached end of card memory?
+    if (offset + blklen > disk.capacity()) { // reached end of card memory?
+        flush_bulk();
         return SDRX_OK_COMPLETE;
+    }
 
     setup_rx_blk(offset); // continue writing
     return SDRX_OK_BLK_DONE;
@@ -900,9 +993,14 @@ card::card(const sc_module_name& nm, const string& img, bool ro):
     m_curcmd(),
     m_curoff(),
     m_numblk(),
+    m_bulk(),
+    m_bulkoff(),
+    m_bulkwr(false),
+    m_prefetch(),
     m_state(IDLE),
     image("image", img),
     readonly("readonly", ro),
+    crc(this, "crc"),
     disk("disk", image, readonly),
     sd_in("sd_in") {
     if (disk.capacity() % 1024)
@@ -916,12 +1014,16 @@ card::card(const sc_module_name& nm, const string& img, bool ro):
 }
 
 card::~card() {
-    // nothing to do
+    flush_bulk();
 }
 
 void card::reset() {
+    flush_bulk();
+
     m_status = 0;
     m_state = IDLE;
+    m_bulk.clear();
+    m_prefetch = nullptr;
 
     init_ocr();
     init_cid();
@@ -946,6 +1048,9 @@ void card::sd_transport(const sd_target_socket& socket, sd_command& tx) {
     tx.appcmd = (m_status & APP_CMD);
     tx.resp_len = 0;
 
+    // any command ends a multi-block write, so its data must be on disk
+    flush_bulk();
+
     if (m_state == SENDING || m_state == RECEIVING) {
         m_state = TRANSFER;
         update_status();
@@ -296,7 +296,7 @@ void sdhci::write_buffer_data_port(u32 val) {
         block_count_16_bit -= 1;
         m_bufptr = 0;
 
-        u16 crc = crc16(m_buffer, (block_size & 0x0fff));
+        u16 crc = crc16_sd(m_buffer, (block_size & 0x0fff));
         m_buffer[blksz + 0] = (u8)(crc >> 8);
         m_buffer[blksz + 1] = (u8)(crc >> 0);
 
@@ -365,8 +365,18 @@ void sdhci::write_error_int_stat(u16 val) {
 }
 
 u32 sdhci::read_capabilities() {
-    u32 caps = capabilities;
-    return dma_enabled ? (caps | 0x00400000) : (caps & ~0x00400000);
+    u32 caps = capabilities & ~(CAPABILITY_SDMA | CAPABILITY_ADMA2);
+    if (dma_enabled)
+        caps |= CAPABILITY_SDMA;
+    if (dma_enabled && adma_enabled)
+        caps |= CAPABILITY_ADMA2;
+    return caps;
+}
+
+void sdhci::write_block_gap_ctrl(u8 val) {
+    block_gap_ctrl = val & ~BLOCK_GAP_CONTINUE;
+    if (val & BLOCK_GAP_CONTINUE)
+        m_dma_continue.notify(SC_ZERO_TIME);
 }
 
 void sdhci::dma_thread() {
@@ -376,6 +386,21 @@ void sdhci::dma_thread() {
     while (true) {
         wait(m_dma_start);
 
+        if (adma_selected()) {
+            // descriptor interrupts are collected and signalled together
+            // with transfer complete instead of one irq per descriptor
+            if (!adma_transfer()) {
+                present_state &= ~(DAT_LINE_ACTIVE | COMMAND_INHIBIT_DAT);
+                irq.write(true);
+                continue;
+            }
+
+            set_present_state(~DAT_LINE_ACTIVE);
+            normal_int_stat |= INT_TRANSFER_COMPLETE;
+            irq.write(true);
+            continue;
+        }
+
         // normally the boundary should be 512K-12 bytes, i.e. 524276 bytes
         boundary = (4096 << ((block_size & 0x7000) >> 12)) - 12;
 
@@ -443,7 +468,7 @@ tlm_response_status sdhci::dma_write(u32 boundary) {
         sdma_system_address += blksz;
         offset += blksz;
 
-        crc = crc16(m_buffer, blksz);
+        crc = crc16_sd(m_buffer, blksz);
         m_buffer[blksz + 0] = (u8)(crc >> 8);
         m_buffer[blksz + 1] = (u8)(crc >> 0);
 
@@ -457,11 +482,142 @@ tlm_response_status sdhci::dma_write(u32 boundary) {
     return rs;
 }
 
+bool sdhci::adma_selected() const {
+    u8 dma = host_control_1 & HOST_CTRL_DMA_SELECT;
+    if (dma != HOST_CTRL_ADMA32 && dma != HOST_CTRL_ADMA64)
+        return false;
+    return adma_enabled;
+}
+
+bool sdhci::adma_error(u8 status) {
+    adma_err_stat = status;
+    error_int_stat |= ERR_ADMA;
+    normal_int_stat |= INT_ERROR;
+    return false;
+}
+
+bool sdhci::adma_segment(u64 addr, u32 len, bool to_card) {
+    u32 blksz = block_size & 0xfff;
+    vcml_access rw = to_card ? VCML_ACCESS_READ : VCML_ACCESS_WRITE;
+    vector<u8> bounce;
+
+    // move the whole segment with one memcpy via dmi, or with a single bus
+    // transaction if memory does not offer dmi
+    u8* ptr = out.lookup_dmi_ptr(addr, len, rw);
+    if (ptr == nullptr) {
+        bounce.resize(len);
+        ptr = bounce.data();
+        if (to_card && failed(out.read(addr, ptr, len)))
+            return false;
+    }
+
+    u32 pos = 0;
+    while (pos < len && block_count_16_bit > 0) {
+        u32 n = min(len - pos, blksz - m_bufptr);
+        if (to_card)
+            memcpy(m_buffer + m_bufptr, ptr + pos, n);
+        else
+            memcpy(ptr + pos, m_buffer + m_bufptr, n);
+
+        pos += n;
+        m_bufptr += n;
+        if (m_bufptr < blksz)
+            continue;
+
+        m_bufptr = 0;
+        block_count_16_bit -= 1;
+
+        if (to_card) {
+            u16 crc = crc16_sd(m_buffer, blksz);
+            m_buffer[blksz + 0] = (u8)(crc >> 8);
+            m_buffer[blksz + 1] = (u8)(crc >> 0);
+            transfer_data_to_sd();
+        } else if (block_count_16_bit > 0) {
+            transfer_data_from_sd();
+        }
+    }
+
+    if (!bounce.empty() && !to_card && pos > 0)
+        return success(out.write(addr, ptr, pos));
+
+    return true;
+}
+
+bool sdhci::adma_transfer() {
+    bool to_card = m_cmd.status == SD_OK_RX_RDY;
+    bool adma64 = (host_control_1 & HOST_CTRL_DMA_SELECT) == HOST_CTRL_ADMA64;
+    size_t descsz = adma64 ? 12 : 8;
+
+    adma_err_stat = 0;
+    m_bufptr = 0;
+
+    while (block_count_16_bit > 0) {
+        u64 desc = adma_system_address[0];
+        if (adma64)
+            desc |= (u64)adma_system_address[1] << 32;
+
+        u8 buf[12] = {};
+        if (failed(out.read(desc, buf, descsz)))
+            return adma_error(ADMA_ERR_ST_FDS);
+
+        u16 attr = buf[0] | buf[1] << 8;
+        u32 len = buf[2] | buf[3] << 8;
+        u64 addr = 0;
+        for (size_t i = descsz; i > 4; i--)
+            addr = addr << 8 | buf[i - 1];
+
+        if (!(attr & ADMA_VALID))
+            return adma_error(ADMA_ERR_ST_FDS);
+
+        u64 next = desc + descsz;
+        switch (attr & ADMA_ACT) {
+        case ADMA_ACT_TRAN:
+            if (!adma_segment(addr, len ? len : 65536, to_card))
+                return adma_error(ADMA_ERR_ST_TFR);
+            break;
+
+        case ADMA_ACT_LINK:
+            if (addr == desc)
+                return adma_error(ADMA_ERR_ST_FDS);
+            next = addr;
+            break;
+
+        default: // nop
+            break;
+        }
+
+        adma_system_address[0] = (u32)next;
+        if (adma64)
+            adma_system_address[1] = (u32)(next >> 32);
+
+        if (attr & ADMA_INT)
+            normal_int_stat |= INT_DMA_INTERRUPT;
+
+        if (attr & ADMA_END)
+            break;
+
+        if ((block_gap_ctrl & BLOCK_GAP_STOP) && m_bufptr == 0 &&
+            block_count_16_bit > 0) {
+            normal_int_stat |= INT_BLOCK_GAP_EVENT;
+            irq.write(true);
+            wait(m_dma_continue);
+        }
+    }
+
+    if (block_count_16_bit > 0) {
+        log_warn("ADMA ended with %hu blocks left", (u16)block_count_16_bit);
+        return adma_error(ADMA_ERR_ST_TFR | ADMA_ERR_LENGTH);
+    }
+
+    return true;
+}
+
 sdhci::sdhci(const sc_module_name& nm):
     peripheral(nm),
     m_cmd(),
     m_bufptr(0),
     m_dma_start("dma_start"),
+    m_dma_continue("dma_continue"),
     sdma_system_address("sdma_system_address", 0x000, 0x00000000),
     block_size("block_size", 0x004, 0x0000),
     block_count_16_bit("block_count_16_bit", 0x006, 0x0000),
@@ -473,6 +629,7 @@ sdhci::sdhci(const sc_module_name& nm):
     present_state("present_state", 0x024, CARD_INSERTED),
     host_control_1("host_control_1", 0x028, 0x00),
     power_ctrl("power_ctrl", 0x029, 0x0E),
+    block_gap_ctrl("block_gap_ctrl", 0x02a, 0x00),
     clock_ctrl("clock_ctrl", 0x02c, 0x0000),
     timeout_ctrl("timeout_ctrl", 0x02e, 0x00),
     software_reset("software_reset", 0x02f, 0x00),
@@ -484,10 +641,13 @@ sdhci::sdhci(const sc_module_name& nm):
     error_int_sig_enable("error_int_sig_enable", 0x03a, 0x0000),
     capabilities("capabilities", 0x040, 0x00000000),
     max_curr_cap("max_curr_cap", 0x048, 0x00000001),
-    host_controller_version("host_controller_version", 0x0fe, 0x0000),
+    adma_err_stat("adma_err_stat", 0x054, 0x00),
+    adma_system_address("adma_system_address", 0x058, 0x00000000),
+    host_controller_version("host_controller_version", 0x0fe, 0x0001),
     f_sd_h30_ahb_config("f_sd_h30_ahb_config", 0x100, 0x00),
     f_sd_h30_esd_control("f_sd_h30_esd_control", 0x124, 0x00),
     dma_enabled("dma_enabled", true),
+    adma_enabled("adma_enabled", true),
     irq("irq"),
     in("in"),
     out("out"),
@@ -528,6 +688,10 @@ sdhci::sdhci(const sc_module_name& nm):
     power_ctrl.sync_never();
     power_ctrl.allow_read_write();
 
+    block_gap_ctrl.sync_on_write();
+    block_gap_ctrl.allow_read_write();
+    block_gap_ctrl.on_write(&sdhci::write_block_gap_ctrl);
+
     clock_ctrl.sync_on_write();
     clock_ctrl.allow_read_write();
     clock_ctrl.on_write(&sdhci::write_clock_ctrl);
@@ -567,6 +731,12 @@ sdhci::sdhci(const sc_module_name& nm):
     max_curr_cap.sync_never();
     max_curr_cap.allow_read_only();
 
+    adma_err_stat.sync_never();
+    adma_err_stat.allow_read_only();
+
+    adma_system_address.sync_never();
+    adma_system_address.allow_read_write();
+
     host_controller_version.sync_never();
     host_controller_version.allow_read_only();
 
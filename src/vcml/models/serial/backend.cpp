@@ -20,16 +20,127 @@
 namespace vcml {
 namespace serial {
 
+void backend::queue_thread() {
+    mwr::set_thread_name(mkstr("serial_%s", m_type.c_str()));
+
+    vector<u8> batch;
+    batch.reserve(m_queue_cap);
+
+    std::unique_lock<mutex> lock(m_queue_mtx);
+    while (true) {
+        m_queue_cv.wait(lock, [&] {
+            return !m_queue.empty() || !m_queue_running;
+        });
+        if (m_queue.empty())
+            break; // stopped and fully drained
+
+        batch.swap(m_queue);
+        m_space_cv.notify_all();
+
+        lock.unlock();
+        write(batch.data(), batch.size());
+        batch.clear();
+        lock.lock();
+    }
+}
+
 backend::backend(terminal* term, const string& type):
-    m_term(term), m_type(type), log(term->log) {
+    m_queue_mtx(),
+    m_queue_cv(),
+    m_space_cv(),
+    m_queue(),
+    m_queue_cap(0),
+    m_queue_drop(false),
+    m_queue_running(false),
+    m_queue_stats(),
+    m_queue_thread(),
+    m_term(term),
+    m_type(type),
+    log(term->log) {
     m_term->attach(this);
 }
 
 backend::~backend() {
+    stop_queue();
     if (m_term)
         m_term->detach(this);
 }
 
+backend::queue_stats backend::get_queue_stats() const {
+    lock_guard<mutex> guard(m_queue_mtx);
+    return m_queue_stats;
+}
+
+void backend::start_queue(size_t capacity, bool drop) {
+    VCML_ERROR_ON(capacity == 0, "output queue capacity cannot be zero");
+    stop_queue();
+
+    m_queue_cap = capacity;
+    m_queue_drop = drop;
+    m_queue_running = true;
+    m_queue.reserve(capacity);
+    m_queue_thread = thread(&backend::queue_thread, this);
+}
+
+void backend::stop_queue() {
+    if (!m_queue_thread.joinable())
+        return;
+
+    {
+        lock_guard<mutex> guard(m_queue_mtx);
+        m_queue_running = false;
+        m_queue_cv.notify_all();
+    }
+
+    m_queue_thread.join();
+}
+
+void backend::send(const u8* data, size_t size) {
+    if (!m_queue_thread.joinable()) {
+        m_queue_stats.num_bytes += size;
+        write(data, size);
+        return;
+    }
+
+    std::unique_lock<mutex> lock(m_queue_mtx);
+    while (size > 0) {
+        size_t space = m_queue_cap - m_queue.size();
+        if (space == 0 && m_queue_drop) {
+            m_queue_stats.num_dropped += size;
+            break;
+        }
+
+        if (space == 0) {
+            m_queue_stats.num_stalls++;
+            m_space_cv.wait(lock, [&] {
+                return m_queue.size() < m_queue_cap;
+            });
+            continue;
+        }
+
+        size_t n = min(space, size);
+        m_queue.insert(m_queue.end(), data, data + n);
+        m_queue_stats.num_bytes += n;
+        m_queue_stats.peak_level = max(m_queue_stats.peak_level,
+                                       m_queue.size());
+        m_queue_cv.notify_one();
+        data += n;
+        size -= n;
+    }
+}
+
+size_t backend::read(u8* data, size_t size) {
+    size_t n = 0;
+    while (n < size && read(data[n]))
+        n++;
+    return n;
+}
+
+void backend::write(const u8* data, size_t size) {
+    for (size_t i = 0; i < size; i++)
+        write(data[i]);
+}
+
 static backend* stdin_owner = nullptr;
 
 void backend::capture_stdin() {
@@ -29,6 +29,10 @@ void backend_fd::write(u8 val) {
     mwr::fd_write(m_fd, &val, sizeof(val));
 }
 
+void backend_fd::write(const u8* data, size_t size) {
+    mwr::fd_write(m_fd, data, size);
+}
+
 backend* backend_fd::create(terminal* term, const string& type) {
     if (starts_with(type, "stdout"))
         return new backend_fd(term, STDOUT_FDNO);
@@ -31,6 +31,7 @@ public:
 
     virtual bool read(u8& val) override;
     virtual void write(u8 val) override;
+    virtual void write(const u8* data, size_t size) override;
 
     static backend* create(terminal* term, const string& type);
 };
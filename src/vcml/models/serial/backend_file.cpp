@@ -37,16 +37,24 @@ backend_file::~backend_file() {
 }
 
 bool backend_file::read(u8& val) {
+    return read(&val, sizeof(val)) > 0;
+}
+
+size_t backend_file::read(u8* data, size_t size) {
     if (!m_rx.is_open() || !m_rx.good())
-        return false;
+        return 0;
 
-    m_rx.read(reinterpret_cast<char*>(&val), sizeof(val));
-    return m_rx.gcount() > 0u;
+    m_rx.read(reinterpret_cast<char*>(data), size);
+    return m_rx.gcount();
 }
 
 void backend_file::write(u8 val) {
+    write(&val, sizeof(val));
+}
+
+void backend_file::write(const u8* data, size_t size) {
     if (m_tx.is_open() && m_tx.good()) {
-        m_tx.write(reinterpret_cast<const char*>(&val), sizeof(val));
+        m_tx.write(reinterpret_cast<const char*>(data), size);
         m_tx.flush();
     }
 }
@@ -29,7 +29,9 @@ public:
     virtual ~backend_file();
 
     virtual bool read(u8& val) override;
+    virtual size_t read(u8* data, size_t size) override;
     virtual void write(u8 val) override;
+    virtual void write(const u8* data, size_t size) override;
 
     static backend* create(terminal* term, const string& type);
 };
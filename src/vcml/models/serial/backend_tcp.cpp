@@ -31,10 +31,15 @@ void backend_tcp::receive() {
         return;
 
     while (m_socket.is_connected()) {
-        u8 data;
-        m_socket.recv(data);
+        // block for one byte, then pick up whatever else has arrived
+        u8 data[256];
+        m_socket.recv(data[0]);
+        size_t n = 1 + min(m_socket.peek(), sizeof(data) - 1);
+        if (n > 1)
+            m_socket.recv(data + 1, n - 1);
+
         m_mtx.lock();
-        m_fifo.push(data);
+        m_fifo.insert(m_fifo.end(), data, data + n);
         m_mtx.unlock();
         m_term->notify(this);
     }
@@ -66,19 +71,25 @@ backend_tcp::~backend_tcp() {
 }
 
 bool backend_tcp::read(u8& val) {
-    lock_guard<mutex> guard(m_mtx);
-    if (m_fifo.empty())
-        return false;
+    return read(&val, sizeof(val)) > 0;
+}
 
-    val = m_fifo.front();
-    m_fifo.pop();
-    return true;
+size_t backend_tcp::read(u8* data, size_t size) {
+    lock_guard<mutex> guard(m_mtx);
+    size_t n = min(size, m_fifo.size());
+    std::copy_n(m_fifo.begin(), n, data);
+    m_fifo.erase(m_fifo.begin(), m_fifo.begin() + n);
+    return n;
 }
 
 void backend_tcp::write(u8 val) {
+    write(&val, sizeof(val));
+}
+
+void backend_tcp::write(const u8* data, size_t size) {
     try {
         if (m_socket.is_connected())
-            m_socket.send(val);
+            m_socket.send(data, size);
     } catch (...) {
         // nothing to do
     }
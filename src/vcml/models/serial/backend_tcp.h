@@ -25,7 +25,7 @@ private:
 
     thread m_thread;
     mutex m_mtx;
-    queue<u8> m_fifo;
+    deque<u8> m_fifo;
     atomic<bool> m_running;
 
     void iothread();
@@ -38,7 +38,9 @@ public:
     virtual ~backend_tcp();
 
     virtual bool read(u8& val) override;
+    virtual size_t read(u8* data, size_t size) override;
     virtual void write(u8 val) override;
+    virtual void write(const u8* data, size_t size) override;
 
     static backend* create(terminal* term, const string& type);
 };
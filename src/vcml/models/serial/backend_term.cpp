@@ -13,6 +13,8 @@
 
 #include "vcml/debugging/suspender.h"
 
+#include <unistd.h>
+
 namespace vcml {
 namespace serial {
 
@@ -32,33 +34,46 @@ void backend_term::terminate() {
     debugging::suspender::quit();
 }
 
-void backend_term::iothread() {
-    mwr::set_thread_name("term_iothread");
-    while (m_backend_active && sim_running()) {
-        if (mwr::fd_peek(m_fdin, 100)) {
-            u8 ch;
-            if (!mwr::fd_read(m_fdin, &ch, sizeof(ch))) {
-                log_warn("eof while reading stdin");
-                return; // EOF
-            }
+void backend_term::receive(int fd) {
+    u8 buf[256];
+    ssize_t len = ::read(fd, buf, sizeof(buf));
+    if (len < 0 && (errno == EINTR || errno == EAGAIN))
+        return;
 
-            if (ch == CTRL_A) { // ctrl-a
-                mwr::fd_read(m_fdin, &ch, sizeof(ch));
-                if (ch == 'x' || ch == 'X' || ch == CTRL_X) {
-                    terminate();
-                    continue;
-                }
+    if (len <= 0) {
+        log_warn("eof while reading stdin");
+        mwr::aio_cancel(fd);
+        return;
+    }
 
-                if (ch == 'a')
-                    ch = CTRL_A;
+    // ctrl-a may be split from the key it escapes across two reads
+    size_t n = 0;
+    for (ssize_t i = 0; i < len; i++) {
+        u8 ch = buf[i];
+        if (m_escape) {
+            m_escape = false;
+            if (ch == 'x' || ch == 'X' || ch == CTRL_X) {
+                terminate();
+                continue;
             }
 
-            m_mtx.lock();
-            m_fifo.push(ch);
-            m_mtx.unlock();
-            m_term->notify(this);
+            if (ch == 'a')
+                ch = CTRL_A;
+        } else if (ch == CTRL_A) {
+            m_escape = true;
+            continue;
         }
+
+        buf[n++] = ch;
     }
+
+    if (n == 0)
+        return;
+
+    m_mtx.lock();
+    m_fifo.insert(m_fifo.end(), buf, buf + n);
+    m_mtx.unlock();
+    m_term->notify(this);
 }
 
 backend_term::backend_term(terminal* term):
@@ -66,40 +81,42 @@ backend_term::backend_term(terminal* term):
     m_fdin(STDIN_FDNO),
     m_fdout(STDOUT_FDNO),
     m_exit_requested(false),
-    m_backend_active(true),
-    m_iothread(),
+    m_escape(false),
     m_mtx(),
     m_fifo() {
     capture_stdin();
     VCML_REPORT_ON(!mwr::is_tty(m_fdin), "not a terminal");
     mwr::tty_push(m_fdin, true);
     mwr::tty_set(m_fdin, false, false);
-    m_iothread = thread(&backend_term::iothread, this);
+    mwr::aio_notify(m_fdin, [&](int fd) -> void { receive(fd); });
 }
 
 backend_term::~backend_term() {
-    m_backend_active = false;
-    if (m_iothread.joinable())
-        m_iothread.join();
-
+    mwr::aio_cancel(m_fdin);
     mwr::tty_pop(m_fdin);
     release_stdin();
 }
 
 bool backend_term::read(u8& value) {
-    lock_guard<mutex> lock(m_mtx);
-    if (m_fifo.empty())
-        return false;
+    return read(&value, sizeof(value)) > 0;
+}
 
-    value = m_fifo.front();
-    m_fifo.pop();
-    return true;
+size_t backend_term::read(u8* data, size_t size) {
+    lock_guard<mutex> lock(m_mtx);
+    size_t n = min(size, m_fifo.size());
+    std::copy_n(m_fifo.begin(), n, data);
+    m_fifo.erase(m_fifo.begin(), m_fifo.begin() + n);
+    return n;
 }
 
 void backend_term::write(u8 val) {
     mwr::fd_write(m_fdout, &val, sizeof(val));
 }
 
+void backend_term::write(const u8* data, size_t size) {
+    mwr::fd_write(m_fdout, data, size);
+}
+
 backend* backend_term::create(terminal* term, const string& type) {
     return new backend_term(term);
 }
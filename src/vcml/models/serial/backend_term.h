@@ -25,13 +25,12 @@ private:
     int m_fdout;
 
     atomic<bool> m_exit_requested;
-    atomic<bool> m_backend_active;
+    bool m_escape;
 
-    thread m_iothread;
     mutable mutex m_mtx;
-    queue<u8> m_fifo;
+    deque<u8> m_fifo;
 
-    void iothread();
+    void receive(int fd);
     void terminate();
 
 public:
@@ -39,7 +38,9 @@ public:
     virtual ~backend_term();
 
     virtual bool read(u8& val) override;
+    virtual size_t read(u8* data, size_t size) override;
     virtual void write(u8 val) override;
+    virtual void write(const u8* data, size_t size) override;
 
     static backend* create(terminal* term, const string& type);
 };
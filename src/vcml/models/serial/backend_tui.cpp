@@ -53,21 +53,23 @@ void backend_tui::iothread() {
     while (m_backend_active && sim_running()) {
         u64 now_host = mwr::timestamp_us();
         u64 now_sim = time_to_us(sc_time_stamp());
-        if (now_host > m_time_host) {
+        if (now_host > m_time_host + 500000) {
             m_rtf = (double)(now_sim - m_time_sim) / (now_host - m_time_host);
             m_time_host = now_host;
             m_time_sim = now_sim;
         }
 
-        m_mtx.lock();
-        draw_statusbar();
-        m_mtx.unlock();
+        drain_output();
+        if (now_host >= m_last_frame + FRAME_MS * 1000) {
+            m_last_frame = now_host;
+            redraw();
+        }
 
-        if (mwr::fd_peek(m_fdin, 500)) {
+        if (mwr::fd_peek(m_fdin, FRAME_MS)) {
             u8 ch;
             if (!mwr::fd_read(m_fdin, &ch, sizeof(ch))) {
                 log_warn("eof while reading stdin");
-                return; // EOF
+                break; // EOF
             }
 
             if (ch == CTRL_A) { // ctrl-a
@@ -82,17 +84,19 @@ void backend_tui::iothread() {
             }
 
             m_mtx.lock();
-            m_fifo.push(ch);
+            m_fifo.push_back(ch);
             m_mtx.unlock();
             m_term->notify(this);
         }
     }
-}
 
-void backend_tui::draw_statusbar() {
-    if (!sc_core::sc_start_of_simulation_invoked())
-        return;
+    // from here on, writers draw their output themselves
+    drain_output();
+    redraw();
+    m_drawing = false;
+}
 
+string backend_tui::statusbar() {
     const u64 now = time_to_us(sc_time_stamp());
     const size_t millis = (now % 1000000) / 1000;
     const size_t times = now / 1000000;
@@ -108,7 +112,30 @@ void backend_tui::draw_statusbar() {
     else
         text = text.substr(0, max_cols);
 
-    const string statusbar = mkstr(
+    return text;
+}
+
+void backend_tui::drain_output() {
+    size_t tail = m_outtail.load(std::memory_order_relaxed);
+    size_t head = m_outhead.load(std::memory_order_acquire);
+    for (; tail != head; tail++)
+        putchar(m_outbuf[tail % OUTBUF_SIZE]);
+    m_outtail.store(tail, std::memory_order_release);
+}
+
+// only draws what changed since the last frame: completed lines, the
+// status bar if its text differs and the current line if it was modified
+void backend_tui::redraw() {
+    if (!sc_core::sc_start_of_simulation_invoked())
+        return;
+
+    string status = statusbar();
+    if (m_pending.empty() && !m_line_dirty && status == m_status)
+        return;
+
+    m_status = status;
+    m_line_dirty = false;
+    m_pending += mkstr(
         "\n"      // begin status bar
         "\x1b[7m" // invert colors
         "%s"      // print status bar
@@ -116,9 +143,10 @@ void backend_tui::draw_statusbar() {
         "\x1b[F"  // return to previous line
         "\x1b[K"  // clear line
         "%s",     // print line buffer
-        text.c_str(), m_linebuf.c_str());
+        m_status.c_str(), m_linebuf.c_str());
 
-    mwr::fd_write(m_fdout, statusbar.c_str(), statusbar.length());
+    mwr::fd_write(m_fdout, m_pending.data(), m_pending.length());
+    m_pending.clear();
 }
 
 backend_tui::backend_tui(terminal* term):
@@ -127,13 +155,21 @@ backend_tui::backend_tui(terminal* term):
     m_fdout(STDOUT_FDNO),
     m_exit_requested(false),
     m_backend_active(true),
+    m_drawing(true),
     m_iothread(),
     m_mtx(),
     m_fifo(),
+    m_outbuf(OUTBUF_SIZE),
+    m_outhead(0),
+    m_outtail(0),
     m_time_sim(time_to_us(sc_time_stamp())),
     m_time_host(mwr::timestamp_us()),
     m_rtf(),
-    m_linebuf() {
+    m_linebuf(),
+    m_pending(),
+    m_status(),
+    m_line_dirty(false),
+    m_last_frame(0) {
     VCML_REPORT_ON(!mwr::is_tty(m_fdin), "not a terminal");
     capture_stdin();
     mwr::tty_push(m_fdin, true);
@@ -152,31 +188,64 @@ backend_tui::~backend_tui() {
     if (m_iothread.joinable())
         m_iothread.join();
 
+    drain_output();
+    redraw();
+
     mwr::tty_pop(m_fdin);
     release_stdin();
 }
 
 bool backend_tui::read(u8& value) {
-    lock_guard<mutex> lock(m_mtx);
-    if (m_fifo.empty())
-        return false;
-
-    value = m_fifo.front();
-    m_fifo.pop();
-    return true;
+    return read(&value, sizeof(value)) > 0;
 }
 
-void backend_tui::write(u8 val) {
+size_t backend_tui::read(u8* data, size_t size) {
     lock_guard<mutex> lock(m_mtx);
+    size_t n = min(size, m_fifo.size());
+    std::copy_n(m_fifo.begin(), n, data);
+    m_fifo.erase(m_fifo.begin(), m_fifo.begin() + n);
+    return n;
+}
+
+void backend_tui::putchar(u8 val) {
     if (val == '\n' || m_linebuf.length() >= max_cols) {
-        string line = mkstr("\r\x1b[K%s\n", m_linebuf.c_str());
-        mwr::fd_write(m_fdout, line.data(), line.size());
+        m_pending += mkstr("\r\x1b[K%s\n", m_linebuf.c_str());
         m_linebuf.clear();
     } else {
         m_linebuf.push_back(val);
     }
 
-    draw_statusbar();
+    m_line_dirty = true;
+}
+
+void backend_tui::write(u8 val) {
+    write(&val, sizeof(val));
+}
+
+void backend_tui::write(const u8* data, size_t size) {
+    size_t head = m_outhead.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < size; i++, head++) {
+        // wait for the iothread to make room, unless it is gone already
+        while (head - m_outtail.load(std::memory_order_acquire) >=
+               OUTBUF_SIZE) {
+            m_outhead.store(head, std::memory_order_release);
+            if (!m_drawing) {
+                drain_output();
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        m_outbuf[head % OUTBUF_SIZE] = data[i];
+    }
+
+    m_outhead.store(head, std::memory_order_release);
+
+    if (!m_drawing) {
+        drain_output();
+        redraw();
+    }
 }
 
 backend* backend_tui::create(terminal* term, const string& type) {
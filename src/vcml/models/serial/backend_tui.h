@@ -21,32 +21,56 @@ namespace serial {
 class backend_tui : public backend
 {
 private:
+    enum : size_t {
+        OUTBUF_SIZE = 64 * KiB,
+        FRAME_MS = 33, // redraw at most ~30 times per second
+    };
+
     int m_fdin;
     int m_fdout;
 
     atomic<bool> m_exit_requested;
     atomic<bool> m_backend_active;
+    atomic<bool> m_drawing;
 
     thread m_iothread;
     mutable mutex m_mtx;
-    queue<u8> m_fifo;
+    deque<u8> m_fifo;
+
+    // output bytes are handed from the simulation to the iothread through
+    // a single producer, single consumer ring without taking m_mtx
+    vector<u8> m_outbuf;
+    atomic<size_t> m_outhead;
+    atomic<size_t> m_outtail;
 
     atomic<u64> m_time_sim;
     atomic<u64> m_time_host;
     double m_rtf;
+
+    // screen state, only touched by whoever is drawing: lines completed
+    // since the last frame, the current line and the last status bar
     string m_linebuf;
+    string m_pending;
+    string m_status;
+    bool m_line_dirty;
+    u64 m_last_frame;
 
     void iothread();
     void terminate();
 
-    void draw_statusbar();
+    string statusbar();
+    void drain_output();
+    void redraw();
+    void putchar(u8 val);
 
 public:
     backend_tui(terminal* term);
     virtual ~backend_tui();
 
     virtual bool read(u8& val) override;
+    virtual size_t read(u8* data, size_t size) override;
     virtual void write(u8 val) override;
+    virtual void write(const u8* data, size_t size) override;
 
     static backend* create(terminal* term, const string& type);
 };
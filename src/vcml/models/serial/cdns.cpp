@@ -126,28 +126,14 @@ static serial_stop decode_stop_bits(u32 mr) {
         return SERIAL_STOP_2;
 }
 
-static void clear_fifo(queue<u8>& ff) {
-    while (!ff.empty())
-        ff.pop();
-}
-
 void cdns::push_rxff(u8 val) {
     if ((cr & CR_RD) || !(cr & CR_RE))
         return;
 
-    if (m_rxff.size() < rxff_size)
-        m_rxff.push(val);
-    else
+    if (!m_rxff.push(val))
         isr |= IRQ_RO;
 
-    // we are supposed to wait for a rtor * baud cycles after we have received
-    // a character before raising the receiver timeout interrupt in order to
-    // allow the rxfifo to collect some data first and to prevent spamming the
-    // cpu with interrupts; but since we do not know how fast the simulation
-    // will be running in the end, we just notify the cpu directly.
-    if (rtor > 0u)
-        isr |= IRQ_RT;
-
+    restart_timeout();
     update_irq();
 }
 
@@ -155,9 +141,7 @@ void cdns::push_txff(u8 val) {
     if ((cr & CR_TD) || !(cr & CR_TE))
         return;
 
-    if (m_txff.size() < txff_size)
-        m_txff.push(val);
-    else
+    if (!m_txff.push(val))
         isr |= IRQ_TO;
 
     update_irq();
@@ -165,11 +149,29 @@ void cdns::push_txff(u8 val) {
     m_txev.notify(SC_ZERO_TIME);
 }
 
+// the receiver timeout counts rtor times four bit periods of silence
+void cdns::restart_timeout() {
+    m_rtev.cancel();
+    if (rtor > 0u && !m_rxff.empty())
+        m_rtev.notify(m_bit_time * 4 * (double)rtor);
+}
+
+void cdns::rx_timeout() {
+    if (!m_rxff.empty()) {
+        isr |= IRQ_RT;
+        update_irq();
+    }
+}
+
 void cdns::write_cr(u32 val) {
     if (val & CR_SRR)
-        clear_fifo(m_rxff);
+        m_rxff.clear();
     if (val & CR_SRT)
-        clear_fifo(m_txff);
+        m_txff.clear();
+
+    // writing CR_RT restarts the receiver timeout counter
+    if (val & CR_RT)
+        restart_timeout();
 
     cr = (val & CR_MASK) | (cr & ~CR_MASK);
 }
@@ -223,8 +225,7 @@ u32 cdns::read_txrx() {
     if (m_rxff.empty())
         return 0;
 
-    u8 data = m_rxff.front();
-    m_rxff.pop();
+    u8 data = m_rxff.pop();
     update_irq();
 
     return data;
@@ -236,8 +237,7 @@ void cdns::tx_thread() {
             wait(m_txev);
 
         do {
-            serial_tx.send(m_txff.front());
-            m_txff.pop();
+            serial_tx.send(m_txff.pop());
             update_irq();
         } while (!m_txff.empty());
     }
@@ -246,11 +246,11 @@ void cdns::tx_thread() {
 void cdns::update_irq() {
     sr.set_bit<SR_RES>(m_rxff.empty());
     sr.set_bit<SR_RTS>(m_rxff.size() >= rtrig);
-    sr.set_bit<SR_RFS>(m_rxff.size() == rxff_size);
+    sr.set_bit<SR_RFS>(m_rxff.full());
 
     sr.set_bit<SR_TES>(m_txff.empty());
     sr.set_bit<SR_FTS>(m_txff.size() >= ttrig);
-    sr.set_bit<SR_TFS>(m_txff.size() == txff_size);
+    sr.set_bit<SR_TFS>(m_txff.full());
 
     if (sr & SR_RTS)
         isr |= IRQ_RTR;
@@ -268,6 +268,26 @@ void cdns::update_irq() {
     irq = isr & imr;
 }
 
+void cdns::serial_receive(const serial_target_socket& socket,
+                          serial_payload& tx) {
+    m_bit_time = sc_time(1.0 / max<baud_t>(tx.baud, 1), SC_SEC);
+
+    u32 mode = mr.get_field<MR_CM>();
+    bool rx_enabled = !(cr & CR_RD) && (cr & CR_RE);
+    if (!tx.is_bulk() || mode != CM_NORMAL || !rx_enabled) {
+        serial_host::serial_receive(socket, tx);
+        return;
+    }
+
+    // fast path: fill the receive fifo with the entire burst at once
+    size_t n = m_rxff.push(tx.buffer, tx.count, tx.mask);
+    if (n < tx.count)
+        isr |= IRQ_RO;
+
+    restart_timeout();
+    update_irq();
+}
+
 void cdns::serial_receive(u8 data) {
     u32 mode = mr.get_field<MR_CM>();
     if (mode == CM_NORMAL || mode == CM_ECHO)
@@ -281,6 +301,8 @@ cdns::cdns(const sc_module_name& nm):
     m_rxff(),
     m_txff(),
     m_txev("txev"),
+    m_rtev("rtev"),
+    m_bit_time(),
     rxff_size("rxff_size", 16),
     txff_size("txff_size", 16),
     cr("cr", 0x0, CR_RESET),
@@ -370,9 +392,16 @@ cdns::cdns(const sc_module_name& nm):
     ttrig.sync_always();
     ttrig.allow_read_only();
 
+    m_rxff.resize(rxff_size);
+    m_txff.resize(txff_size);
+
     SC_HAS_PROCESS(cdns);
     SC_THREAD(tx_thread);
     sensitive << m_txev;
+
+    SC_METHOD(rx_timeout);
+    sensitive << m_rtev;
+    dont_initialize();
 }
 
 cdns::~cdns() {
@@ -382,8 +411,9 @@ cdns::~cdns() {
 void cdns::reset() {
     peripheral::reset();
 
-    clear_fifo(m_rxff);
-    clear_fifo(m_txff);
+    m_rxff.clear();
+    m_txff.clear();
+    m_rtev.cancel();
 
     update_irq();
 }
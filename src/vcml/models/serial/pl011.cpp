@@ -13,33 +13,71 @@
 namespace vcml {
 namespace serial {
 
-void pl011::serial_receive(u8 data) {
-    if (is_enabled() || is_rx_enabled()) {
-        if (m_fifo.size() < m_fifo_size)
-            m_fifo.push(data);
-        else {
-            ris |= RIS_OE;
-            log_warn("FIFO buffer overflow, data dropped");
-        }
+size_t pl011::rx_trigger() const {
+    if (!(lcr & LCR_FEN))
+        return 1;
+
+    // receive interrupt trigger at 1/8, 1/4, 1/2, 3/4 or 7/8 full
+    static const size_t levels[] = { 2, 4, 8, 12, 14 };
+    size_t sel = (ifls >> IFLS_RX_O) & IFLS_LVL_M;
+    return sel < 5 ? levels[sel] : levels[2];
+}
+
+void pl011::rx_push(u16 val) {
+    if (m_fifo.push(val))
+        return;
+
+    ris |= RIS_OE;
+    log_warn("FIFO buffer overflow, data dropped");
+}
 
+void pl011::rx_timeout() {
+    if (!m_fifo.empty()) {
+        ris |= RIS_RT;
         update();
     }
 }
 
+void pl011::serial_receive(const serial_target_socket& socket,
+                           serial_payload& tx) {
+    if (!is_enabled() && !is_rx_enabled())
+        return;
+
+    if (tx.is_bulk()) {
+        size_t n = m_fifo.push(tx.buffer, tx.count, tx.mask);
+        if (n < tx.count) {
+            ris |= RIS_OE;
+            log_warn("FIFO buffer overflow, %zu bytes dropped", tx.count - n);
+        }
+    } else {
+        rx_push(tx.data & tx.mask);
+    }
+
+    // timeout fires if no more data arrives for 32 bit periods
+    double timeout = (double)RX_TIMEOUT_BITS / max<baud_t>(tx.baud, 1);
+    m_rx_timeout_ev.cancel();
+    m_rx_timeout_ev.notify(sc_time(timeout, SC_SEC));
+
+    update();
+}
+
 void pl011::update() {
     // update flags
     fr &= ~(FR_RXFE | FR_RXFF | FR_TXFF);
     fr |= FR_TXFE; // tx FIFO is always empty
     if (m_fifo.empty())
         fr |= FR_RXFE;
-    if (m_fifo.size() >= m_fifo_size)
+    if (m_fifo.full())
         fr |= FR_RXFF;
 
     // update interrupts
-    if (m_fifo.empty())
-        ris &= ~RIS_RX;
-    else
+    if (m_fifo.size() >= rx_trigger())
         ris |= RIS_RX;
+    else
+        ris &= ~RIS_RX;
+    if (m_fifo.empty())
+        ris &= ~RIS_RT;
+
     mis = ris & imsc;
     if (mis != 0 && !irq.read())
         log_debug("raising interrupt");
@@ -49,11 +87,7 @@ void pl011::update() {
 }
 
 u16 pl011::read_dr() {
-    u16 val = 0;
-    if (!m_fifo.empty()) {
-        val = m_fifo.front();
-        m_fifo.pop();
-    }
+    u16 val = m_fifo.pop();
 
     dr = val;
     rsr = (val >> RSR_O) & RSR_M;
@@ -95,9 +129,11 @@ void pl011::write_lcr(u8 val) {
     if (!(val & LCR_FEN) && (lcr & LCR_FEN))
         log_debug("FIFO disabled");
 
-    m_fifo_size = (val & LCR_FEN) ? FIFOSIZE : 1;
+    if ((val ^ lcr) & LCR_FEN)
+        m_fifo.resize((val & LCR_FEN) ? FIFOSIZE : 1);
 
     lcr = val & LCR_H_M;
+    update();
 }
 
 void pl011::write_cr(u16 val) {
@@ -118,7 +154,8 @@ void pl011::write_cr(u16 val) {
 }
 
 void pl011::write_ifls(u16 val) {
-    ifls = val & 0x3f; // TODO implement interrupt FIFO level select
+    ifls = val & IFLS_M;
+    update();
 }
 
 void pl011::write_imsc(u16 val) {
@@ -135,8 +172,8 @@ void pl011::write_icr(u16 val) {
 pl011::pl011(const sc_module_name& nm):
     peripheral(nm),
     serial_host(),
-    m_fifo_size(),
-    m_fifo(),
+    m_fifo(1),
+    m_rx_timeout_ev("rx_timeout_ev"),
     dr("dr", 0x000, 0x0),
     rsr("rsr", 0x004, 0x0),
     fr("fr", 0x018, FR_TXFE | FR_RXFE),
@@ -145,7 +182,7 @@ pl011::pl011(const sc_module_name& nm):
     fbrd("fbrd", 0x028, 0x0),
     lcr("lcr", 0x02C, 0x0),
     cr("cr", 0x030, CR_TXE | CR_RXE),
-    ifls("ifls", 0x034, 0x0),
+    ifls("ifls", 0x034, 0x12),
     imsc("imsc", 0x038, 0x0),
     ris("ris", 0x03C, 0x0),
     mis("mis", 0x040, 0x0),
@@ -214,6 +251,11 @@ pl011::pl011(const sc_module_name& nm):
 
     cid.sync_never();
     cid.allow_read_only();
+
+    SC_HAS_PROCESS(pl011);
+    SC_METHOD(rx_timeout);
+    sensitive << m_rx_timeout_ev;
+    dont_initialize();
 }
 
 pl011::~pl011() {
@@ -229,8 +271,8 @@ void pl011::reset() {
     for (unsigned int i = 0; i < cid.count(); i++)
         cid[i] = (AMBA_CID >> (i * 8)) & 0xff;
 
-    while (!m_fifo.empty())
-        m_fifo.pop();
+    m_fifo.resize(1);
+    m_rx_timeout_ev.cancel();
 
     irq = false;
 }
@@ -71,6 +71,7 @@ bool terminal::cmd_create_backend(const vector<string>& args, ostream& os) {
 bool terminal::cmd_destroy_backend(const vector<string>& args, ostream& os) {
     for (const string& arg : args) {
         if (to_lower(arg) == "all") {
+            flush();
             for (auto it : m_backends)
                 delete it.second;
             m_backends.clear();
@@ -116,14 +117,43 @@ bool terminal::cmd_history(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool terminal::cmd_queue_stats(const vector<string>& args, ostream& os) {
+    for (auto it : m_backends) {
+        backend::queue_stats stats = it.second->get_queue_stats();
+        os << it.first << ": " << it.second->type();
+        if (it.second->is_queued()) {
+            os << " (" << (it.second->drops_output() ? "drop" : "block")
+               << ", " << it.second->queue_capacity() << " bytes)";
+        }
+
+        os << " sent " << stats.num_bytes << " dropped " << stats.num_dropped
+           << " stalls " << stats.num_stalls << " peak " << stats.peak_level
+           << ",";
+    }
+
+    return true;
+}
+
 void terminal::serial_transmit() {
+    // recorded input is sent from the replay thread instead
+    if (m_replay.is_replaying())
+        return;
+
     while (true) {
         for (backend* b : m_listeners) {
-            u8 data = 0xff;
-            while (b->read(data)) {
-                serial_tx.send(data);
-                if (!untimed)
+            u8 data[64];
+            while (size_t n = b->read(data, sizeof(data))) {
+                if (untimed) {
+                    m_replay.record(data, n);
+                    serial_tx.send(data, n);
+                    continue;
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    m_replay.record(data + i, 1);
+                    serial_tx.send(data[i]);
                     wait(serial_tx.cycle());
+                }
             }
         }
 
@@ -131,10 +161,26 @@ void terminal::serial_transmit() {
     }
 }
 
+void terminal::flush_output() {
+    flush();
+}
+
 void terminal::serial_receive(u8 data) {
     m_hist.insert(data);
-    for (backend* b : m_listeners)
-        b->write(data);
+    if (m_listeners.empty())
+        return;
+
+    if (flush_size == 0) {
+        for (backend* b : m_listeners)
+            b->send(&data, 1);
+        return;
+    }
+
+    m_txbuf.push_back(data);
+    if (data == '\n' || m_txbuf.size() >= flush_size)
+        flush();
+    else if (m_txbuf.size() == 1)
+        m_flush_ev.notify(flush_delay);
 }
 
 unordered_map<string, terminal*>& terminal::terminals() {
@@ -149,9 +195,16 @@ terminal::terminal(const sc_module_name& nm):
     m_backends(),
     m_listeners(),
     m_async_ev("async_ev"),
+    m_txbuf(),
+    m_flush_ev("flush_ev"),
+    m_replay(name()),
     backends("backends", ""),
     config("config", "9600N8"),
     untimed("untimed", false),
+    flush_size("flush_size", 256),
+    flush_delay("flush_delay", sc_time(1, SC_MS)),
+    queue_size("queue_size", 0),
+    queue_drop("queue_drop", "tcp"),
     serial_tx("serial_tx"),
     serial_rx("serial_rx") {
     if (stl_contains(terminals(), string(name())))
@@ -190,18 +243,38 @@ terminal::terminal(const sc_module_name& nm):
                      "lists all known backends of this terminal");
     register_command("history", 0, this, &terminal::cmd_history,
                      "show previously transmitted data from this terminal");
+    register_command("queue_stats", 0, this, &terminal::cmd_queue_stats,
+                     "show output queue statistics of all backends");
+
+    m_txbuf.reserve(flush_size);
+
+    m_replay.replay([this](const u8* data, size_t size) -> void {
+        serial_tx.send(data, size);
+    });
 
     SC_HAS_PROCESS(terminal);
     SC_THREAD(serial_transmit);
+
+    SC_METHOD(flush_output);
+    sensitive << m_flush_ev;
+    dont_initialize();
 }
 
 terminal::~terminal() {
-    for (auto it : m_backends)
+    flush();
+    for (auto it : m_backends) {
+        it.second->stop_queue();
         delete it.second;
+    }
 
     terminals().erase(name());
 }
 
+void terminal::end_of_simulation() {
+    module::end_of_simulation();
+    flush();
+}
+
 void terminal::attach(backend* b) {
     if (stl_contains(m_listeners, b))
         VCML_ERROR("attempt to attach backend twice");
@@ -218,9 +291,25 @@ void terminal::notify(backend* b) {
     on_next_update([&] { m_async_ev.notify(SC_ZERO_TIME); });
 }
 
+void terminal::flush() {
+    if (m_txbuf.empty())
+        return;
+
+    for (backend* b : m_listeners)
+        b->send(m_txbuf.data(), m_txbuf.size());
+    m_txbuf.clear();
+}
+
 size_t terminal::create_backend(const string& type) {
     hierarchy_guard guard(this);
-    m_backends[m_next_id] = backend::create(this, type);
+    backend* b = backend::create(this, type);
+    if (queue_size > 0) {
+        string kind = type.substr(0, type.find(':'));
+        vector<string> drop = split(queue_drop);
+        b->start_queue(queue_size, stl_contains(drop, kind));
+    }
+
+    m_backends[m_next_id] = b;
     return m_next_id++;
 }
 
@@ -229,6 +318,8 @@ bool terminal::destroy_backend(size_t id) {
     if (it == m_backends.end())
         return false;
 
+    flush();
+    it->second->stop_queue();
     delete it->second;
     m_backends.erase(it);
     return true;
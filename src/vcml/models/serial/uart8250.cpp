@@ -53,17 +53,34 @@ void uart8250::calibrate() {
 }
 
 void uart8250::update() {
-    // update status
-    lsr.set_bit<LSR_TEMT>(m_tx_fifo.empty());
-    lsr.set_bit<LSR_THRE>(m_tx_fifo.size() < m_tx_size);
+    // transmission is instantaneous, so the transmitter is always empty
+    lsr |= LSR_TEMT | LSR_THRE;
     lsr.set_bit<LSR_DR>(!m_rx_fifo.empty());
 
+    // data is reported once the trigger level is reached or on timeout
+    bool rda = m_rx_fifo.size() >= m_rx_trigger;
+    bool cti = m_rx_timeout && !m_rx_fifo.empty();
+
     // update interrupt
     iir.set_bit<IRQ_RLS>(lsr & (LSR_OE | LSR_PE));
-    iir.set_bit<IRQ_RDA>(!m_rx_fifo.empty());
+    iir.set_bit<IRQ_RDA>(rda || cti);
     irq = iir & ier;
 }
 
+void uart8250::rx_restart_timeout() {
+    m_rx_timeout = false;
+    m_rx_timeout_ev.cancel();
+    if (!m_rx_fifo.empty())
+        m_rx_timeout_ev.notify(m_rx_symbol * RX_TIMEOUT_CHARS);
+}
+
+void uart8250::rx_timeout() {
+    if (!m_rx_fifo.empty()) {
+        m_rx_timeout = true;
+        update();
+    }
+}
+
 u8 uart8250::read_rbr() {
     if (lcr & LCR_DLAB)
         return m_divisor & 0xff;
@@ -71,8 +88,8 @@ u8 uart8250::read_rbr() {
     if (m_rx_fifo.empty())
         return 0;
 
-    u8 val = m_rx_fifo.front();
-    m_rx_fifo.pop();
+    u8 val = m_rx_fifo.pop();
+    rx_restart_timeout();
     update();
     return val;
 }
@@ -84,22 +101,27 @@ u8 uart8250::read_ier() {
 }
 
 u8 uart8250::read_iir() {
+    u8 fifo = m_fifo_enabled ? IIR_FIFO : 0;
+
     if (iir & IRQ_RLS)
-        return IIR_RLS;
+        return IIR_RLS | fifo;
 
-    if (iir & IRQ_RDA)
-        return IIR_RDA;
+    if (iir & IRQ_RDA) {
+        if (m_rx_fifo.size() < m_rx_trigger)
+            return IIR_CTI | fifo;
+        return IIR_RDA | fifo;
+    }
 
     if (iir & IRQ_THRE) {
         iir &= ~IRQ_THRE;
         update();
-        return IIR_THRE;
+        return IIR_THRE | fifo;
     }
 
     if (iir & IRQ_MST)
-        return IIR_MST;
+        return IIR_MST | fifo;
 
-    return IIR_NOIP;
+    return IIR_NOIP | fifo;
 }
 
 u8 uart8250::read_lsr() {
@@ -117,13 +139,11 @@ void uart8250::write_thr(u8 val) {
     }
 
     thr = val;
-    m_tx_fifo.push(thr);
     iir &= ~IRQ_THRE;
     update();
 
-    m_tx_fifo.pop();
     serial_tx.send(thr);
-    iir.set_bit<IRQ_THRE>(m_tx_fifo.empty());
+    iir |= IRQ_THRE;
     update();
 }
 
@@ -163,19 +183,20 @@ void uart8250::write_lcr(u8 val) {
 }
 
 void uart8250::write_fcr(u8 val) {
-    log_debug("FIFOs %sabled", val & FCR_FE ? "en" : "dis");
+    bool enable = val & FCR_FE;
+    if (enable != m_fifo_enabled) {
+        log_debug("FIFOs %sabled", enable ? "en" : "dis");
+        m_rx_fifo.resize(enable ? FIFO_SIZE : 1);
+        m_fifo_enabled = enable;
+    }
 
     if (val & FCR_CRF) {
-        while (!m_rx_fifo.empty())
-            m_rx_fifo.pop();
+        m_rx_fifo.clear();
         log_debug("receiver FIFO cleared");
     }
 
-    if (val & FCR_CTF) {
-        while (!m_tx_fifo.empty())
-            m_tx_fifo.pop();
+    if (val & FCR_CTF)
         log_debug("transmitter FIFO cleared");
-    }
 
     if (val & FCR_DMA)
         log_debug("FCR_DMA bit set");
@@ -183,25 +204,40 @@ void uart8250::write_fcr(u8 val) {
     switch (val & 0b11000000) {
     case FCR_IT1:
         log_debug("interrupt threshold 1 byte");
+        m_rx_trigger = 1;
         break;
     case FCR_IT4:
         log_debug("interrupt threshold 4 bytes");
+        m_rx_trigger = 4;
         break;
     case FCR_IT8:
         log_debug("interrupt threshold 8 bytes");
+        m_rx_trigger = 8;
         break;
     case FCR_IT14:
         log_debug("interrupt threshold 14 bytes");
+        m_rx_trigger = 14;
         break;
     default:
         break;
     }
+
+    if (!m_fifo_enabled)
+        m_rx_trigger = 1;
+
+    rx_restart_timeout();
+    update();
 }
 
 void uart8250::serial_receive(const serial_target_socket& socket,
                               serial_payload& tx) {
-    if (m_rx_fifo.size() < m_rx_size) {
-        m_rx_fifo.push(tx.data & tx.mask);
+    if (tx.is_bulk()) {
+        size_t n = m_rx_fifo.push(tx.buffer, tx.count, tx.mask);
+        if (n < tx.count) {
+            log_warn("rx fifo overflow, %zu bytes dropped", tx.count - n);
+            lsr |= LSR_OE;
+        }
+    } else if (m_rx_fifo.push(tx.data & tx.mask)) {
         if (!serial_test_parity(tx)) {
             log_warn("parity error detected");
             lsr |= LSR_PE;
@@ -211,16 +247,20 @@ void uart8250::serial_receive(const serial_target_socket& socket,
         lsr |= LSR_OE;
     }
 
+    m_rx_symbol = serial_symbol_time(tx);
+    rx_restart_timeout();
     update();
 }
 
 uart8250::uart8250(const sc_module_name& nm):
     peripheral(nm),
     serial_host(),
-    m_rx_size(1),
-    m_tx_size(1),
-    m_rx_fifo(),
-    m_tx_fifo(),
+    m_rx_fifo(1),
+    m_rx_trigger(1),
+    m_fifo_enabled(false),
+    m_rx_timeout(false),
+    m_rx_symbol(),
+    m_rx_timeout_ev("rx_timeout_ev"),
     m_divisor(1),
     thr("thr", 0x0, 0x00),
     ier("ier", 0x1, 0x00),
@@ -266,6 +306,11 @@ uart8250::uart8250(const sc_module_name& nm):
     serial_tx.set_data_width(uart8250_data_bits(lcr));
     serial_tx.set_stop_bits(uart8250_stop_bits(lcr));
     serial_tx.set_parity(uart8250_parity(lcr));
+
+    SC_HAS_PROCESS(uart8250);
+    SC_METHOD(rx_timeout);
+    sensitive << m_rx_timeout_ev;
+    dont_initialize();
 }
 
 uart8250::~uart8250() {
@@ -274,6 +319,12 @@ uart8250::~uart8250() {
 
 void uart8250::reset() {
     peripheral::reset();
+
+    m_rx_fifo.resize(1);
+    m_rx_trigger = 1;
+    m_fifo_enabled = false;
+    m_rx_timeout = false;
+    m_rx_timeout_ev.cancel();
     m_divisor = clock_hz() / (16 * DEFAULT_BAUD);
     calibrate();
 }
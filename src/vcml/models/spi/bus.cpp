@@ -58,6 +58,13 @@ void bus::spi_transport(const spi_target_socket&, spi_payload& spi) {
     }
 }
 
+void bus::spi_transport(const spi_target_socket&, spi_burst& burst) {
+    for (auto port : cs) {
+        if (is_active(port.first))
+            spi_out[port.first].transport(burst);
+    }
+}
+
 unsigned int bus::next_free() const {
     unsigned int idx = 0;
     while (spi_out.exists(idx) || cs.exists(idx))
@@ -41,7 +41,92 @@ enum sr_status_bits : u8 {
     SR_SRWD = bit(7), // status register write protect
 };
 
+void flash::xip_load(u64 addr, size_t size) {
+    if (size == 0 || addr >= this->size())
+        return;
+
+    size_t first = addr / XIP_CHUNK;
+    size_t last = min<u64>(addr + size - 1, this->size() - 1) / XIP_CHUNK;
+    for (size_t idx = first; idx <= last; idx++) {
+        if (m_xip_loaded[idx])
+            continue;
+
+        u64 off = idx * XIP_CHUNK;
+        size_t len = min<u64>(XIP_CHUNK, this->size() - off);
+        if (off < disk.capacity()) {
+            size_t n = min(len, disk.capacity() - off);
+            disk.read_at(off, m_xip.data() + off, n);
+        }
+
+        m_xip_loaded[idx] = true;
+        if (!m_xip_stale)
+            xip_map(off, len);
+    }
+}
+
+void flash::xip_map(u64 addr, size_t size) {
+    tlm_dmi dmi(m_xip);
+    dmi.set_dmi_ptr(m_xip.data() + addr);
+    dmi.set_start_address(addr);
+    dmi.set_end_address(addr + size - 1);
+    xip_in.map_dmi(dmi);
+}
+
+void flash::xip_update(u64 addr, const u8* data, size_t size) {
+    // chunks that were never paged in will pick up the data from disk
+    for (u64 off = addr; off < addr + size;) {
+        size_t idx = off / XIP_CHUNK;
+        u64 end = min<u64>((idx + 1) * XIP_CHUNK, addr + size);
+        if (!m_xip_loaded[idx]) {
+            off = end;
+            continue;
+        }
+
+        if (data == nullptr && off % XIP_CHUNK == 0 && end % XIP_CHUNK == 0)
+            m_xip_loaded[idx] = false; // erased completely, page in again
+        else if (data != nullptr)
+            memcpy(m_xip.data() + off, data + (off - addr), end - off);
+        else
+            memset(m_xip.data() + off, 0, end - off);
+
+        off = end;
+    }
+
+    xip_in.unmap_dmi(addr, addr + size - 1);
+    m_xip_stale = true;
+}
+
+void flash::xip_remap() {
+    if (!m_xip_stale)
+        return;
+
+    // chunks that are paged in next to each other share one dmi region
+    size_t n = m_xip_loaded.size();
+    for (size_t i = 0; i < n;) {
+        if (!m_xip_loaded[i]) {
+            i++;
+            continue;
+        }
+
+        size_t j = i;
+        while (j < n && m_xip_loaded[j])
+            j++;
+
+        u64 off = i * XIP_CHUNK;
+        xip_map(off, min<u64>(j * XIP_CHUNK, size()) - off);
+        i = j;
+    }
+
+    m_xip_stale = false;
+}
+
+size_t flash::xip_chunks_loaded() const {
+    return std::count(m_xip_loaded.begin(), m_xip_loaded.end(), true);
+}
+
 void flash::decode(u8 val) {
+    xip_remap();
+
     m_command = (command)val;
     switch (m_command) {
     case CMD_WRITE_ENABLE:
@@ -104,7 +189,8 @@ void flash::decode(u8 val) {
 
     case CMD_BULK_ERASE:
         disk.seek(0);
-        disk.wzero(size());
+        if (disk.wzero(size()))
+            xip_update(0, nullptr, size());
         m_state = STATE_IDLE;
         break;
 
@@ -136,7 +222,8 @@ void flash::complete() {
 
     case CMD_SECTOR_ERASE:
         disk.seek(m_address);
-        disk.wzero(sector_size());
+        if (disk.wzero(sector_size()))
+            xip_update(m_address, nullptr, sector_size());
         m_state = STATE_IDLE;
         break;
 
@@ -161,15 +248,14 @@ void flash::process(spi_payload& tx) {
 
     case STATE_PROGRAMMING:
         if (m_write_enable) {
-            disk.seek(m_address);
-            disk.write(&tx.mosi, 1);
+            if (disk.write_at(m_address, &tx.mosi, 1))
+                xip_update(m_address, &tx.mosi, 1);
             m_address = (m_address + 1) % size();
         }
         break;
 
     case STATE_READING_STORAGE:
-        disk.seek(m_address);
-        disk.read(&tx.miso, 1);
+        disk.read_at(m_address, &tx.miso, 1);
         m_address = (m_address + 1) % size();
         break;
 
@@ -191,6 +277,46 @@ void flash::spi_transport(const spi_target_socket& socket, spi_payload& tx) {
         process(tx);
 }
 
+void flash::spi_transport(const spi_target_socket& socket, spi_burst& burst) {
+    if (!cs_in)
+        return;
+
+    // reads and programs are served with one disk access per burst
+    for (size_t i = 0; i < burst.size;) {
+        size_t n = 0;
+        if (m_address < size())
+            n = min<size_t>(burst.size - i, size() - m_address);
+
+        if (n > 0 && m_state == STATE_READING_STORAGE) {
+            disk.read_at(m_address, burst.miso + i, n);
+        } else if (n > 0 && m_state == STATE_PROGRAMMING && m_write_enable) {
+            if (disk.write_at(m_address, burst.mosi + i, n))
+                xip_update(m_address, burst.mosi + i, n);
+            memset(burst.miso + i, 0, n);
+        } else {
+            spi_payload spi(burst.mosi[i]);
+            process(spi);
+            burst.miso[i++] = spi.miso;
+            continue;
+        }
+
+        m_address = (m_address + n) % size();
+        i += n;
+    }
+}
+
+void flash::gpio_notify(const gpio_target_socket& socket) {
+    if (&socket == &cs_in && !cs_in)
+        xip_remap();
+}
+
+unsigned int flash::transport(tlm_generic_payload& tx,
+                              const tlm_sbi& sideband, address_space as) {
+    xip_load(tx.get_address(), tx.get_data_length());
+    m_xip.transport(tx, sideband);
+    return tx.is_response_ok() ? tx.get_data_length() : 0;
+}
+
 flash::flash(const sc_module_name& nm, const string& dev):
     component(nm),
     spi_host(),
@@ -203,13 +329,21 @@ flash::flash(const sc_module_name& nm, const string& dev):
     m_write_enable(),
     m_address(),
     m_buffer(),
+    m_xip(),
+    m_xip_stale(false),
+    m_xip_loaded(),
     device("device", dev),
     image("image", ""),
     readonly("readonly", false),
     disk("disk", image, readonly),
     spi_in("spi_in"),
-    cs_in("cs_in") {
+    cs_in("cs_in"),
+    xip_in("xip_in") {
     m_info = lookup_device(device);
+
+    m_xip.init(size(), VCML_ALIGN_NONE);
+    m_xip.allow_read_only();
+    m_xip_loaded.assign((size() + XIP_CHUNK - 1) / XIP_CHUNK, false);
 }
 
 flash::~flash() {
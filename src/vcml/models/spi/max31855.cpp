@@ -75,6 +75,12 @@ void max31855::spi_transport(const spi_target_socket& socket,
     spi.miso = do_spi_transport(spi.mosi);
 }
 
+void max31855::spi_transport(const spi_target_socket& socket,
+                             spi_burst& burst) {
+    for (size_t i = 0; i < burst.size; i++)
+        burst.miso[i] = do_spi_transport(burst.mosi[i]);
+}
+
 void max31855::bind(gpio_initiator_socket& s, bool cs_active_high) {
     s.bind(cs);
     m_cs_mode = cs_active_high;
@@ -185,6 +185,14 @@ void spi2sd::spi_transport(const spi_target_socket& socket, spi_payload& spi) {
         spi.miso = do_spi_transport(spi.mosi);
 }
 
+void spi2sd::spi_transport(const spi_target_socket& socket, spi_burst& burst) {
+    if (cs != cs_active_high)
+        return;
+
+    for (size_t i = 0; i < burst.size; i++)
+        burst.miso[i] = do_spi_transport(burst.mosi[i]);
+}
+
 VCML_EXPORT_MODEL(vcml::spi::spi2sd, name, args) {
     return new spi2sd(name);
 }
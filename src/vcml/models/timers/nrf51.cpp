@@ -81,13 +81,12 @@ void nrf51::update() {
     }
 
     irq = doirq;
-    m_trigger.cancel();
 
-    if (is_timer_mode()) {
-        u32 deadline = next_deadline();
-        if (deadline)
-            m_trigger.notify(ticks_to_time(deadline));
-    }
+    u32 deadline = is_timer_mode() ? next_deadline() : 0;
+    if (deadline)
+        m_trigger.reset(ticks_to_time(deadline));
+    else
+        m_trigger.cancel();
 }
 
 void nrf51::write_start(u32 val) {
@@ -165,7 +164,7 @@ nrf51::nrf51(const sc_module_name& nm):
     peripheral(nm),
     m_running(),
     m_start(),
-    m_trigger("trigger"),
+    m_trigger([this]() -> void { update(); }),
     m_inten(),
     start("start", 0x0),
     stop("stop", 0x4),
@@ -228,11 +227,6 @@ nrf51::nrf51(const sc_module_name& nm):
     cc.sync_always();
     cc.allow_read_write();
     cc.on_write(&nrf51::write_cc);
-
-    SC_HAS_PROCESS(nrf51);
-    SC_METHOD(update);
-    sensitive << m_trigger;
-    dont_initialize();
 }
 
 nrf51::~nrf51() {
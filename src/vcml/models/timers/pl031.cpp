@@ -52,13 +52,12 @@ void pl031::write_icr(u32 val) {
 }
 
 void pl031::update() {
-    m_notify.cancel();
-
     u32 next = mr - read_dr();
     if (next == 0) {
         ris = 1;
+        m_match.cancel();
     } else {
-        m_notify.notify(next, SC_SEC);
+        m_match.reset(sc_time(next, SC_SEC));
     }
 
     irq = (ris & imsc) && (cr & CR_ENABLE);
@@ -67,7 +66,7 @@ void pl031::update() {
 pl031::pl031(const sc_module_name& nm):
     peripheral(nm),
     m_offset(time(NULL)),
-    m_notify("notify"),
+    m_match([this]() -> void { update(); }),
     dr("dr", 0x0),
     mr("mr", 0x4),
     lr("lr", 0x8),
@@ -110,11 +109,6 @@ pl031::pl031(const sc_module_name& nm):
     icr.sync_always();
     icr.allow_write_only();
     icr.on_write(&pl031::write_icr);
-
-    SC_HAS_PROCESS(pl031);
-    SC_METHOD(update);
-    sensitive << m_notify;
-    dont_initialize();
 }
 
 pl031::~pl031() {
@@ -28,10 +28,10 @@ void sp804::timer::trigger() {
 }
 
 void sp804::timer::schedule(u32 ticks) {
-    m_ev.cancel();
-
-    if (!is_enabled())
+    if (!is_enabled()) {
+        m_deadline.cancel();
         return;
+    }
 
     if (!is_32bit())
         ticks &= 0xffff;
@@ -41,7 +41,7 @@ void sp804::timer::schedule(u32 ticks) {
 
     m_prev = sc_time_stamp();
     m_next = m_prev + delta;
-    m_ev.notify(delta);
+    m_deadline.reset_at(m_next);
 }
 
 u32 sp804::timer::read_value() {
@@ -85,7 +85,7 @@ void sp804::timer::write_bgload(u32 val) {
 
 sp804::timer::timer(const sc_module_name& nm):
     peripheral(nm),
-    m_ev("event"),
+    m_deadline([this]() -> void { trigger(); }),
     m_prev(SC_ZERO_TIME),
     m_next(SC_ZERO_TIME),
     m_timer(dynamic_cast<sp804*>(get_parent_object())),
@@ -124,11 +124,6 @@ sp804::timer::timer(const sc_module_name& nm):
     bgload.sync_always();
     bgload.allow_read_write();
     bgload.on_write(&timer::write_bgload);
-
-    SC_HAS_PROCESS(timer);
-    SC_METHOD(trigger);
-    sensitive << m_ev;
-    dont_initialize();
 }
 
 sp804::timer::~timer() {
@@ -137,7 +132,7 @@ sp804::timer::~timer() {
 
 void sp804::timer::reset() {
     peripheral::reset();
-    m_ev.cancel();
+    m_deadline.cancel();
 }
 
 void sp804::update_irqc() {
@@ -32,6 +32,7 @@ enum features : u64 {
     VIRTIO_BLK_F_FLUSH = bit(9),
     VIRTIO_BLK_F_TOPOLOGY = bit(10),
     VIRTIO_BLK_F_CONFIG_WCE = bit(11),
+    VIRTIO_BLK_F_MQ = bit(12),
     VIRTIO_BLK_F_DISCARD = bit(13),
     VIRTIO_BLK_F_WRITE_ZEROES = bit(14),
 };
@@ -66,27 +67,33 @@ static void put_status(vq_message& msg, u8 status) {
     msg.copy_out(status, sz - 1);
 }
 
-bool blk::process_command(vq_message& msg) {
+void blk::complete(request& io, u8 status) {
+    put_status(io.msg, status);
+    if (!virtio_in->put(io.vqid, io.msg))
+        log_warn("failed to return request to virtqueue %u", io.vqid);
+}
+
+bool blk::process_command(u32 vqid, vq_message& msg) {
     virtio_blk_req req = {};
     if (msg.length_in() < sizeof(req) || msg.length_out() < sizeof(u8)) {
         log_error("message does not hold required request fields");
-        return false;
+        return true;
     }
 
     if (msg.copy_in(req) != sizeof(req)) {
         log_error("unable to read request");
-        return false;
+        return true;
     }
 
     switch (req.type) {
     case VIRTIO_BLK_T_IN:
-        return process_in(req, msg);
+        return process_in(vqid, req, msg);
 
     case VIRTIO_BLK_T_OUT:
-        return process_out(req, msg);
+        return process_out(vqid, req, msg);
 
     case VIRTIO_BLK_T_FLUSH:
-        return process_flush(req, msg);
+        return process_flush(vqid, req, msg);
 
     case VIRTIO_BLK_T_GET_ID:
         return process_get_id(req, msg);
@@ -104,7 +111,13 @@ bool blk::process_command(vq_message& msg) {
     }
 }
 
-bool blk::process_in(virtio_blk_req& req, vq_message& msg) {
+void blk::transfer_done(request& io, bool success) {
+    if (!success)
+        log_warn("disk request failed for sector %llu", io.sector);
+    complete(io, success ? VIRTIO_BLK_S_OK : VIRTIO_BLK_S_IOERR);
+}
+
+bool blk::process_in(u32 vqid, virtio_blk_req& req, vq_message& msg) {
     size_t length = msg.length_out() - 1;
     log_debug("read sector %llu, %zu bytes", req.sector, length);
     if (length % SECTOR_SIZE) {
@@ -113,28 +126,24 @@ bool blk::process_in(virtio_blk_req& req, vq_message& msg) {
         return true;
     }
 
-    if (!disk.seek(req.sector * SECTOR_SIZE)) {
-        log_warn("seek request failed for sector %llu", req.sector);
-        put_status(msg, VIRTIO_BLK_S_IOERR);
+    auto io = std::make_shared<request>();
+    if (msg.map_out(io->iov, length) != length || io->iov.empty()) {
+        put_status(msg, length ? VIRTIO_BLK_S_IOERR : VIRTIO_BLK_S_OK);
         return true;
     }
 
-    u8 sector[SECTOR_SIZE];
-    for (size_t count = 0; count < length; count += SECTOR_SIZE) {
-        if (!disk.read(sector, SECTOR_SIZE)) {
-            log_warn("disk read request failed");
-            put_status(msg, VIRTIO_BLK_S_IOERR);
-            return true;
-        }
+    io->vqid = vqid;
+    io->msg = msg;
+    io->sector = req.sector;
 
-        msg.copy_out(sector, count);
-    }
+    // scatter the data directly into guest memory
+    disk.readv_async(req.sector * SECTOR_SIZE, io->iov,
+                     [this, io](bool ok) { transfer_done(*io, ok); });
 
-    put_status(msg, VIRTIO_BLK_S_OK);
-    return true;
+    return false;
 }
 
-bool blk::process_out(virtio_blk_req& req, vq_message& msg) {
+bool blk::process_out(u32 vqid, virtio_blk_req& req, vq_message& msg) {
     size_t length = msg.length_in() - sizeof(req);
     log_debug("write sector %llu, %zu bytes", req.sector, length);
     if (length % SECTOR_SIZE) {
@@ -143,37 +152,38 @@ bool blk::process_out(virtio_blk_req& req, vq_message& msg) {
         return true;
     }
 
-    if (!disk.seek(req.sector * SECTOR_SIZE)) {
-        log_warn("seek request failed for sector %llu", req.sector);
-        put_status(msg, VIRTIO_BLK_S_IOERR);
+    auto io = std::make_shared<request>();
+    if (msg.map_in(io->iov, length, sizeof(req)) != length ||
+        io->iov.empty()) {
+        put_status(msg, length ? VIRTIO_BLK_S_IOERR : VIRTIO_BLK_S_OK);
         return true;
     }
 
-    u8 sector[SECTOR_SIZE];
-    for (size_t count = 0; count < length; count += SECTOR_SIZE) {
-        msg.copy_in(sector, count + sizeof(req));
+    io->vqid = vqid;
+    io->msg = msg;
+    io->sector = req.sector;
 
-        if (!disk.write(sector, SECTOR_SIZE)) {
-            log_warn("disk write request failed");
-            put_status(msg, VIRTIO_BLK_S_IOERR);
-            return true;
-        }
-    }
+    disk.writev_async(req.sector * SECTOR_SIZE, io->iov,
+                      [this, io](bool ok) { transfer_done(*io, ok); });
 
-    put_status(msg, VIRTIO_BLK_S_OK);
-    return true;
+    return false;
 }
 
-bool blk::process_flush(virtio_blk_req& req, vq_message& msg) {
+bool blk::process_flush(u32 vqid, virtio_blk_req& req, vq_message& msg) {
     log_debug("flush disk request");
-    if (!disk.flush()) {
-        log_warn("disk flush request failed");
-        put_status(msg, VIRTIO_BLK_S_IOERR);
-        return true;
-    }
 
-    put_status(msg, VIRTIO_BLK_S_OK);
-    return true;
+    auto io = std::make_shared<request>();
+    io->vqid = vqid;
+    io->msg = msg;
+    io->sector = 0;
+
+    disk.flush_async([this, io](bool success) -> void {
+        if (!success)
+            log_warn("disk flush request failed");
+        complete(*io, success ? VIRTIO_BLK_S_OK : VIRTIO_BLK_S_IOERR);
+    });
+
+    return false;
 }
 
 bool blk::process_get_id(virtio_blk_req& req, vq_message& msg) {
@@ -189,7 +199,7 @@ bool blk::process_discard(virtio_blk_req& req, vq_message& msg) {
     virtio_blk_dwz dwz;
     if (msg.copy_in(dwz, sizeof(req)) != sizeof(dwz)) {
         log_error("unable to read discard arguments");
-        return false;
+        return true;
     }
 
     size_t length = dwz.num_sectors * SECTOR_SIZE;
@@ -202,7 +212,7 @@ bool blk::process_write_zeroes(virtio_blk_req& req, vq_message& msg) {
     virtio_blk_dwz dwz;
     if (msg.copy_in(dwz, sizeof(req)) != sizeof(dwz)) {
         log_error("unable to read discard arguments");
-        return false;
+        return true;
     }
 
     if (!disk.seek(dwz.sector * SECTOR_SIZE)) {
@@ -228,7 +238,17 @@ void blk::identify(virtio_device_desc& desc) {
     desc.device_id = VIRTIO_DEVICE_BLOCK;
     desc.vendor_id = VIRTIO_VENDOR_VCML;
     desc.pci_class = PCI_CLASS_STORAGE_SCSI;
-    desc.request_virtqueue(VIRTQUEUE_REQUEST, VIRTQUEUE0_LENGTH);
+
+    if (num_queues == 0u) {
+        log_warn("num_queues must be at least 1");
+        num_queues = 1;
+    }
+
+    // every queue is served independently, requests from different queues
+    // can be in flight at the same time
+    m_config.num_queues = num_queues;
+    for (u32 i = 0; i < num_queues; i++)
+        desc.request_virtqueue(VIRTQUEUE_REQUEST + i, VIRTQUEUE0_LENGTH);
 }
 
 bool blk::notify(u32 vqid) {
@@ -238,7 +258,9 @@ bool blk::notify(u32 vqid) {
         log_debug("received message from virtqueue %u with %u bytes", vqid,
                   msg.length());
 
-        process_command(msg);
+        // requests still in flight are returned once they complete
+        if (!process_command(vqid, msg))
+            continue;
 
         if (!virtio_in->put(vqid, msg))
             return false;
@@ -265,6 +287,8 @@ void blk::read_features(u64& features) {
         features |= VIRTIO_BLK_F_GEOMETRY;
     if (m_config.topology.min_io_size)
         features |= VIRTIO_BLK_F_TOPOLOGY;
+    if (m_config.num_queues > 1)
+        features |= VIRTIO_BLK_F_MQ;
 }
 
 bool blk::write_features(u64 features) {
@@ -292,6 +316,7 @@ blk::blk(const sc_module_name& nm):
     max_size("max_size", 4096),
     max_discard_sectors("max_discard_sectors", 4096),
     max_write_zeroes_sectors("max_write_zeroes_sectors", 4096),
+    num_queues("num_queues", 1),
     disk("disk", image, readonly),
     virtio_in("virtio_in") {
     m_config.capacity = disk.capacity() / SECTOR_SIZE;
@@ -304,6 +329,7 @@ blk::blk(const sc_module_name& nm):
     m_config.max_write_zeroes_sectors = max_write_zeroes_sectors;
     m_config.max_write_zeroes_seg = 1;
     m_config.write_zeroes_may_unmap = true;
+    m_config.num_queues = num_queues;
 }
 
 blk::~blk() {
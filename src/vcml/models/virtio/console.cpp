@@ -13,6 +13,161 @@
 namespace vcml {
 namespace virtio {
 
+u32 console::port_rxq(u32 port) {
+    return port ? VIRTQUEUE_PORT_BASE + 2 * (port - 1) : VIRTQUEUE_DATA_RX;
+}
+
+u32 console::port_txq(u32 port) {
+    return port_rxq(port) + 1;
+}
+
+bool console::lookup_port(u32 vqid, u32& port, bool& tx) const {
+    if (vqid == VIRTQUEUE_CTRL_RX || vqid == VIRTQUEUE_CTRL_TX)
+        return false;
+
+    port = 0;
+    if (vqid >= VIRTQUEUE_PORT_BASE)
+        port = (vqid - VIRTQUEUE_PORT_BASE) / 2 + 1;
+
+    tx = vqid & 1;
+    return port < m_ports.size() && (port == 0 || m_multiport);
+}
+
+serial_initiator_socket& console::port_out(u32 port) {
+    return port ? port_tx[port] : serial_tx;
+}
+
+string console::port_name(u32 port) const {
+    return port < names.count() ? names.get()[port] : "";
+}
+
+void console::send_control(u32 id, u16 event, u16 value, const string& s) {
+    console_control ctrl{ id, event, value };
+    vector<u8> data(sizeof(ctrl) + s.length());
+    memcpy(data.data(), &ctrl, sizeof(ctrl));
+    memcpy(data.data() + sizeof(ctrl), s.data(), s.length());
+    m_ctrl_msgs.push(std::move(data));
+    flush_control();
+}
+
+bool console::flush_control() {
+    while (!m_ctrl_msgs.empty() && !m_ctrl_bufs.empty()) {
+        vq_message msg(m_ctrl_bufs.front());
+        const vector<u8>& data = m_ctrl_msgs.front();
+        if (msg.length_out() < data.size())
+            log_warn("control message truncated");
+
+        msg.trim(msg.copy_out(data));
+        m_ctrl_bufs.pop();
+        m_ctrl_msgs.pop();
+
+        if (!virtio_in->put(VIRTQUEUE_CTRL_RX, msg))
+            return false;
+    }
+
+    return true;
+}
+
+void console::handle_control(vq_message& msg) {
+    console_control ctrl{};
+    if (msg.copy_in(ctrl) < sizeof(ctrl)) {
+        log_warn("ignoring short control message");
+        return;
+    }
+
+    if (ctrl.event != VIRTIO_CONSOLE_DEVICE_READY &&
+        ctrl.id >= m_ports.size()) {
+        log_warn("control message for invalid port %u", ctrl.id);
+        return;
+    }
+
+    switch (ctrl.event) {
+    case VIRTIO_CONSOLE_DEVICE_READY:
+        if (!ctrl.value) {
+            log_warn("driver failed to set up device");
+            break;
+        }
+
+        for (u32 port = 0; port < m_ports.size(); port++)
+            send_control(port, VIRTIO_CONSOLE_DEVICE_ADD, 0);
+        break;
+
+    case VIRTIO_CONSOLE_PORT_READY: {
+        if (!ctrl.value) {
+            log_warn("driver failed to set up port %u", ctrl.id);
+            break;
+        }
+
+        if (ctrl.id == 0)
+            send_control(ctrl.id, VIRTIO_CONSOLE_CONSOLE_PORT, 1);
+
+        string name = port_name(ctrl.id);
+        if (!name.empty())
+            send_control(ctrl.id, VIRTIO_CONSOLE_PORT_NAME, 0, name);
+
+        // host side of all ports is always connected
+        send_control(ctrl.id, VIRTIO_CONSOLE_PORT_OPEN, 1);
+        break;
+    }
+
+    case VIRTIO_CONSOLE_PORT_OPEN:
+        m_ports[ctrl.id].open = ctrl.value;
+        if (ctrl.value)
+            m_rx_ev.notify(SC_ZERO_TIME);
+        break;
+
+    default:
+        log_warn("ignoring control event %hu", ctrl.event);
+        break;
+    }
+}
+
+bool console::receive_port(u32 port, const u8* data, size_t size) {
+    if (port >= m_ports.size())
+        return false;
+
+    size_t n = m_ports[port].rxfifo.push(data, size);
+    if (n < size)
+        log_debug("port %u dropped %zu bytes", port, size - n);
+
+    m_rx_ev.notify(SC_ZERO_TIME);
+    return n == size;
+}
+
+bool console::flush_port(u32 port) {
+    port_state& p = m_ports[port];
+
+    // the guest drops data for ports it has not opened
+    if (m_multiport && !p.open)
+        return true;
+
+    vector<u8> buffer;
+    while (!p.rxfifo.empty() && !p.rxbufs.empty()) {
+        vq_message msg(p.rxbufs.front());
+        buffer.resize(min<size_t>(msg.length_out(), p.rxfifo.size()));
+        for (u8& data : buffer)
+            data = (u8)p.rxfifo.pop();
+
+        msg.trim(msg.copy_out(buffer));
+        p.rxbufs.pop();
+
+        if (!virtio_in->put(port_rxq(port), msg))
+            return false;
+    }
+
+    return true;
+}
+
+void console::flush_rx() {
+    while (true) {
+        wait(m_rx_ev);
+        for (u32 port = 0; port < m_ports.size(); port++) {
+            if (!flush_port(port))
+                log_warn("failed to deliver data on port %u", port);
+        }
+    }
+}
+
 void console::identify(virtio_device_desc& desc) {
     reset();
     desc.device_id = VIRTIO_DEVICE_CONSOLE;
@@ -23,6 +178,11 @@ void console::identify(virtio_device_desc& desc) {
     desc.request_virtqueue(VIRTQUEUE_DATA_TX, 32);
     desc.request_virtqueue(VIRTQUEUE_CTRL_RX, 8);
     desc.request_virtqueue(VIRTQUEUE_CTRL_TX, 8);
+
+    for (u32 port = 1; port < ports; port++) {
+        desc.request_virtqueue(port_rxq(port), 32);
+        desc.request_virtqueue(port_txq(port), 32);
+    }
 }
 
 bool console::notify(u32 vqid) {
@@ -32,23 +192,30 @@ bool console::notify(u32 vqid) {
     while (virtio_in->get(vqid, msg)) {
         count++;
 
-        switch (vqid) {
-        case VIRTQUEUE_DATA_TX: {
-            vector<u8> chars(msg.length_in());
-            msg.copy_in(chars);
-            for (u8 data : chars)
-                serial_tx.send(data);
-            break;
-        }
+        u32 port = 0;
+        bool tx = false;
 
-        case VIRTQUEUE_DATA_RX: {
-            m_fifo.push(msg);
+        if (vqid == VIRTQUEUE_CTRL_RX && m_multiport) {
+            m_ctrl_bufs.push(msg);
+            if (!flush_control())
+                return false;
             continue;
-        }
-
-        default:
+        } else if (vqid == VIRTQUEUE_CTRL_TX && m_multiport) {
+            handle_control(msg);
+        } else if (lookup_port(vqid, port, tx) && !tx) {
+            m_ports[port].rxbufs.push(msg);
+            if (!flush_port(port))
+                return false;
+            continue;
+        } else if (lookup_port(vqid, port, tx)) {
+            vector<u8> data(msg.length_in());
+            msg.copy_in(data);
+            if (port == 0 || port_tx.exists(port))
+                port_out(port).send(data.data(), data.size());
+            else
+                log_debug("port %u not connected", port);
+        } else {
             log_warn("ignoring message in unexpected virtqueue %u", vqid);
-            break;
         }
 
         if (!virtio_in->put(vqid, msg))
@@ -63,17 +230,21 @@ bool console::notify(u32 vqid) {
 
 void console::read_features(u64& features) {
     features |= VIRTIO_CONSOLE_F_EMERG_WRITE;
-    features &= ~VIRTIO_CONSOLE_F_MULTIPORT;
+    if (ports > 1)
+        features |= VIRTIO_CONSOLE_F_MULTIPORT;
+    else
+        features &= ~VIRTIO_CONSOLE_F_MULTIPORT;
 
     if (rows != 0 && cols != 0)
         features |= VIRTIO_CONSOLE_F_SIZE;
 }
 
 bool console::write_features(u64 features) {
-    if (features & VIRTIO_CONSOLE_F_MULTIPORT)
+    if ((features & VIRTIO_CONSOLE_F_MULTIPORT) && ports <= 1)
         return false;
     if ((features & VIRTIO_CONSOLE_F_SIZE) && (rows == 0 || cols == 0))
         return false;
+    m_multiport = features & VIRTIO_CONSOLE_F_MULTIPORT;
     return true;
 }
 
@@ -96,13 +267,24 @@ bool console::write_config(const range& addr, const void* ptr) {
     return true;
 }
 
-void console::serial_receive(u8 data) {
-    vq_message msg(m_fifo.front());
-    msg.copy_out(data);
-    msg.trim(1);
+void console::serial_receive(const serial_target_socket& socket,
+                             serial_payload& tx) {
+    u32 port = &socket == &serial_rx ? 0 : port_rx.index_of(socket);
+    if (!tx.is_bulk()) {
+        u8 data = tx.data & tx.mask;
+        receive_port(port, &data, 1);
+        return;
+    }
 
-    if (virtio_in->put(VIRTQUEUE_DATA_RX, msg))
-        m_fifo.pop();
+    vector<u8> data(tx.buffer, tx.buffer + tx.count);
+    for (u8& val : data)
+        val &= tx.mask;
+    receive_port(port, data.data(), data.size());
+}
+
+void console::serial_receive(const serial_target_socket& socket, u8 data) {
+    u32 port = &socket == &serial_rx ? 0 : port_rx.index_of(socket);
+    receive_port(port, &data, 1);
 }
 
 console::console(const sc_module_name& nm):
@@ -110,12 +292,25 @@ console::console(const sc_module_name& nm):
     virtio_device(),
     serial_host(),
     m_config(),
+    m_multiport(false),
+    m_ports(),
+    m_ctrl_bufs(),
+    m_ctrl_msgs(),
+    m_rx_ev("rx_ev"),
     cols("cols", 0),
     rows("rows", 0),
+    ports("ports", 1),
+    names("names"),
+    rxbuf_size("rxbuf_size", 4 * KiB),
     virtio_in("virtio_in"),
     serial_tx("serial_tx"),
-    serial_rx("serial_rx") {
-    // nothing to do
+    serial_rx("serial_rx"),
+    port_tx("port_tx"),
+    port_rx("port_rx") {
+    VCML_ERROR_ON(ports == 0, "%s needs at least one port", name());
+    VCML_ERROR_ON(rxbuf_size == 0, "%s needs a receive buffer", name());
+    SC_HAS_PROCESS(console);
+    SC_THREAD(flush_rx);
 }
 
 console::~console() {
@@ -125,7 +320,16 @@ console::~console() {
 void console::reset() {
     m_config.cols = cols;
     m_config.rows = rows;
-    m_config.max_nr_ports = 1;
+    m_config.max_nr_ports = ports;
+
+    m_multiport = false;
+    m_ctrl_bufs = {};
+    m_ctrl_msgs = {};
+
+    m_ports.clear();
+    m_ports.resize(ports);
+    for (port_state& p : m_ports)
+        p.rxfifo.resize(rxbuf_size);
 }
 
 VCML_EXPORT_MODEL(vcml::virtio::console, name, args) {
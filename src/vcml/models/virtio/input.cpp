@@ -167,6 +167,53 @@ void input::config_update() {
     }
 }
 
+size_t input::report_length() const {
+    for (size_t i = 0; i < m_events.size(); i++) {
+        const input_event& event = m_events[i];
+        if (event.type == ui::EV_SYN && event.code == ui::SYN_REPORT)
+            return i + 1;
+    }
+
+    return m_events.size();
+}
+
+bool input::deliver_report() {
+    // hold back reports until they fit completely, unless the driver has
+    // already handed us all of its buffers and no more can come
+    size_t length = report_length();
+    if (length > m_messages.size() && m_messages.size() < VIRTQUEUE_SIZE)
+        return false;
+
+    vector<vq_message> msgs;
+    msgs.reserve(length);
+
+    while (!m_messages.empty() && msgs.size() < length) {
+        vq_message msg(m_messages.front());
+        input_event event(m_events.front());
+        m_messages.pop();
+        m_events.pop_front();
+
+        msg.copy_out(event);
+
+        if (event.type == ui::EV_SYN && event.code == ui::SYN_REPORT) {
+            log_debug("event sync");
+        } else {
+            log_debug("event type %hu, code %hu, value %u", event.type,
+                      event.code, event.value);
+        }
+
+        msgs.push_back(std::move(msg));
+    }
+
+    // one used ring update and a single interrupt for the entire report
+    if (!virtio_in->put_batch(VIRTQUEUE_EVENT, msgs)) {
+        log_warn("failed to deliver input report");
+        return false;
+    }
+
+    return true;
+}
+
 void input::update() {
     size_t n = m_events.size();
     ui::input_event event = {};
@@ -218,28 +265,8 @@ void input::update() {
     if (m_events.size() > n)
         push_sync();
 
-    while (!m_events.empty() && !m_messages.empty()) {
-        vq_message msg(m_messages.front());
-        input_event event(m_events.front());
-
-        msg.copy_out(event);
-
-        if (event.type == ui::EV_SYN && event.code == ui::SYN_REPORT) {
-            log_debug("event sync");
-        } else {
-            log_debug("event type %hu, code %hu, value %u", event.type,
-                      event.code, event.value);
-        }
-
-        if (virtio_in->put(VIRTQUEUE_EVENT, msg)) {
-            m_events.pop();
-            m_messages.pop();
-        }
-    }
-
-    sc_time quantum = tlm_global_quantum::instance().get();
-    sc_time polldelay = sc_time(1.0 / pollrate, SC_SEC);
-    next_trigger(max(polldelay, quantum));
+    while (!m_events.empty() && deliver_report())
+        continue;
 }
 
 void input::identify(virtio_device_desc& desc) {
@@ -249,14 +276,23 @@ void input::identify(virtio_device_desc& desc) {
     desc.device_id = VIRTIO_DEVICE_INPUT;
     desc.pci_class = keyboard ? PCI_CLASS_INPUT_KEYBOARD
                               : PCI_CLASS_INPUT_OTHER;
-    desc.request_virtqueue(VIRTQUEUE_EVENT, 8);
+    desc.request_virtqueue(VIRTQUEUE_EVENT, VIRTQUEUE_SIZE);
     desc.request_virtqueue(VIRTQUEUE_STATUS, 8);
 }
 
 bool input::notify(u32 vqid) {
     vq_message msg;
-    while (virtio_in->get(vqid, msg))
-        m_messages.push(msg);
+    while (virtio_in->get(vqid, msg)) {
+        if (vqid == VIRTQUEUE_EVENT)
+            m_messages.push(msg);
+        else if (!virtio_in->put(vqid, msg)) // led status is not modeled
+            return false;
+    }
+
+    // new buffers may take events that are still pending
+    if (!m_events.empty())
+        m_update_ev.notify(SC_ZERO_TIME);
+
     return true;
 }
 
@@ -302,6 +338,14 @@ input::input(const sc_module_name& nm):
     virtio_in("virtio_in") {
     m_keyboard.set_layout(keymap);
 
+    // wake up from the ui thread once events arrive instead of polling
+    auto wakeup = [this]() {
+        on_next_update([this]() { m_update_ev.notify(SC_ZERO_TIME); });
+    };
+
+    m_keyboard.set_notify(wakeup);
+    m_pointer.set_notify(wakeup);
+
     if (keyboard)
         m_console.notify(m_keyboard);
     if (touchpad || mouse)
@@ -310,6 +354,8 @@ input::input(const sc_module_name& nm):
     if (keyboard || touchpad || mouse) {
         SC_HAS_PROCESS(input);
         SC_METHOD(update);
+        sensitive << m_update_ev;
+        dont_initialize();
     }
 }
 
@@ -53,6 +53,8 @@ void mmio::enable_virtqueue(u32 vqid) {
     else
         q = m_queues[vqid] = new split_virtqueue(qd, dmifn);
 
+    q->deferred = irq_batch > 0;
+
     if (!q->validate()) {
         log_warn("failed to enable virtqueue %u", vqid);
         status = VIRTIO_STATUS_DEVICE_NEEDS_RESET;
@@ -81,6 +83,22 @@ void mmio::cleanup_virtqueues() {
     for (auto it : m_queues)
         delete it.second;
     m_queues.clear();
+    m_pending_vqs.clear();
+    m_batched = 0;
+}
+
+void mmio::flush_virtqueues() {
+    bool notify = false;
+    for (auto it : m_queues)
+        notify |= it.second->publish();
+
+    m_batched = 0;
+    m_flush_ev.cancel();
+
+    if (notify) {
+        interrupt_status |= VIRTIO_IRQSTATUS_VQUEUE;
+        irq = interrupt_status != 0u;
+    }
 }
 
 void mmio::invalidate_dmi(u64 start, u64 end) {
@@ -117,13 +135,63 @@ bool mmio::put(u32 vqid, vq_message& msg) {
     }
 
     virtqueue* q = it->second;
-    bool result = q->put(msg);
-    if (result && q->notify) {
+    if (!q->put(msg))
+        return false;
+
+    if (q->deferred) {
+        if (++m_batched >= irq_batch)
+            flush_virtqueues();
+        else if (m_batched == 1)
+            m_flush_ev.notify(irq_delay);
+        return true;
+    }
+
+    if (q->notify) {
         interrupt_status |= VIRTIO_IRQSTATUS_VQUEUE;
         irq = interrupt_status != 0u;
     }
 
-    return result;
+    return true;
+}
+
+bool mmio::put_batch(u32 vqid, vector<vq_message>& msgs) {
+    if (!device_ready()) {
+        log_warn("put: device not ready");
+        return false;
+    }
+
+    auto it = m_queues.find(vqid);
+    if (it == m_queues.end()) {
+        log_warn("put: illegal virtqueue %u", vqid);
+        return false;
+    }
+
+    virtqueue* q = it->second;
+    bool deferred = q->deferred;
+    size_t count = 0;
+
+    q->deferred = true;
+    for (vq_message& msg : msgs) {
+        if (!q->put(msg))
+            break;
+        count++;
+    }
+
+    q->deferred = deferred;
+
+    if (deferred && count > 0) {
+        size_t batched = m_batched;
+        m_batched += count;
+        if (m_batched >= irq_batch)
+            flush_virtqueues();
+        else if (batched == 0)
+            m_flush_ev.notify(irq_delay);
+    } else if (q->publish()) {
+        interrupt_status |= VIRTIO_IRQSTATUS_VQUEUE;
+        irq = interrupt_status != 0u;
+    }
+
+    return count == msgs.size();
 }
 
 bool mmio::notify() {
@@ -265,6 +333,17 @@ void mmio::write_queue_notify(u32 val) {
 
     queue_notify = vqid;
 
+    if (async_notify) {
+        if (!stl_contains(m_pending_vqs, vqid))
+            m_pending_vqs.push_back(vqid);
+        m_notify_ev.notify(SC_ZERO_TIME);
+        return;
+    }
+
+    notify_virtqueue(vqid);
+}
+
+void mmio::notify_virtqueue(u32 vqid) {
     log_debug("notifying virtqueue %u", vqid);
     if (!virtio_out->notify(vqid)) {
         log_warn("notify: device reported failure");
@@ -272,6 +351,20 @@ void mmio::write_queue_notify(u32 val) {
     }
 }
 
+void mmio::notify_thread() {
+    while (true) {
+        wait(m_notify_ev);
+
+        // queues notified while the device is busy are picked up as well
+        while (!m_pending_vqs.empty()) {
+            u32 vqid = m_pending_vqs.front();
+            m_pending_vqs.pop_front();
+            if (device_ready() && stl_contains(m_queues, vqid))
+                notify_virtqueue(vqid);
+        }
+    }
+}
+
 void mmio::write_interrrupt_ack(u32 val) {
     interrupt_ack = val & VIRTIO_IRQSTATUS_MASK;
     interrupt_status &= ~interrupt_ack;
@@ -308,8 +401,15 @@ mmio::mmio(const sc_module_name& nm):
     m_drv_features(),
     m_dev_features(),
     m_queues(),
+    m_batched(0),
+    m_flush_ev("flush_ev"),
+    m_pending_vqs(),
+    m_notify_ev("notify_ev"),
     use_packed_queues("use_packed_queues", false),
     use_strong_barriers("use_strong_barriers", false),
+    irq_batch("irq_batch", 0),
+    irq_delay("irq_delay", SC_ZERO_TIME),
+    async_notify("async_notify", false),
     magic("magic", 0x00, fourcc("virt")),
     version("version", 0x04, 2),
     device_id("device_id", 0x08, 0),
@@ -414,6 +514,13 @@ mmio::mmio(const sc_module_name& nm):
 
     config_gen.sync_always();
     config_gen.allow_read_only();
+
+    SC_HAS_PROCESS(mmio);
+    SC_METHOD(flush_virtqueues);
+    sensitive << m_flush_ev;
+    dont_initialize();
+
+    SC_THREAD(notify_thread);
 }
 
 mmio::~mmio() {
@@ -424,6 +531,7 @@ void mmio::reset() {
     peripheral::reset();
 
     cleanup_virtqueues();
+    m_flush_ev.cancel();
 
     m_drv_features = 0ull;
     m_dev_features = 0ull;
@@ -75,6 +75,18 @@ enum virtio_net_ctrl_mac : u8 {
     VIRTIO_NET_CTRL_MAC_SET = 1,
 };
 
+enum virtio_net_ctrl_mq : u8 {
+    VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET = 0,
+};
+
+// length of all headers up to and including the tcp header of a gso frame
+static u16 gso_hdr_len(const eth_frame& frame) {
+    size_t off = frame.csum_start + 12;
+    if (off >= frame.size())
+        return frame.csum_start;
+    return frame.csum_start + (frame[off] >> 4) * 4;
+}
+
 bool net::filter(const eth_frame& frame) {
     if (m_promisc)
         return true;
@@ -115,9 +127,23 @@ bool net::filter(const eth_frame& frame) {
     return false;
 }
 
+u32 net::ctrl_queue() const {
+    // the control queue follows the last negotiated rx/tx queue pair
+    if (m_features & VIRTIO_NET_F_MQ)
+        return 2 * queues;
+    return VIRTQUEUE_CTRL;
+}
+
+u32 net::rx_queue(const eth_frame& frame) const {
+    // keep all packets of one flow on the same queue to preserve ordering
+    if (m_pairs <= 1)
+        return VIRTQUEUE_RX;
+    return 2 * (frame.flow_hash() % m_pairs) + VIRTQUEUE_RX;
+}
+
 void net::handle_ctrl() {
     vq_message msg;
-    while (virtio_in->get(VIRTQUEUE_CTRL, msg)) {
+    while (virtio_in->get(ctrl_queue(), msg)) {
         u8 command;
         msg.copy_in(command, 0);
 
@@ -131,11 +157,14 @@ void net::handle_ctrl() {
         case VIRTIO_NET_CTRL_MAC:
             handle_ctrl_mac_addr(msg);
             break;
+        case VIRTIO_NET_CTRL_MQ:
+            handle_ctrl_mq(msg);
+            break;
         default:
             log_warn("unsupported command class: %hhu", command);
         }
 
-        if (!virtio_in->put(VIRTQUEUE_CTRL, msg))
+        if (!virtio_in->put(ctrl_queue(), msg))
             log_warn("control command failed");
     }
 }
@@ -229,25 +258,103 @@ void net::handle_ctrl_mac_addr(vq_message& msg) {
     }
 }
 
-bool net::handle_rx(vq_message& msg, eth_frame& frame) {
-    if (msg.length_out() < frame.size() + sizeof(virtio_net_hdr)) {
-        log_warn("reception buffer too small: %u", msg.length_out());
+void net::handle_ctrl_mq(vq_message& msg) {
+    u8 subcmd;
+    u16 pairs;
+    msg.copy_in(subcmd, 1);
+    msg.copy_in(pairs, 2);
+
+    if (subcmd != VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET) {
+        log_warn("unknown multiqueue command: %hhu", subcmd);
+        msg.copy_out(VIRTIO_NET_CTRL_ERR);
+        return;
+    }
+
+    if (pairs < 1 || pairs > queues) {
+        log_warn("invalid number of queue pairs: %hu", pairs);
+        msg.copy_out(VIRTIO_NET_CTRL_ERR);
+        return;
+    }
+
+    log_debug("using %hu queue pairs", pairs);
+    m_pairs = pairs;
+    msg.copy_out(VIRTIO_NET_CTRL_OK);
+}
+
+bool net::handle_rx(u32 vqid, const eth_frame& frame) {
+    queue_stats& stats = m_stats[vqid / 2];
+    bool mergeable = m_features & VIRTIO_NET_F_MRG_RXBUF;
+    size_t total = frame.size() + sizeof(virtio_net_hdr);
+
+    // with mergeable buffers, large frames may span multiple descriptors
+    vector<vq_message> msgs;
+    size_t space = 0;
+    while (space < total && (mergeable || msgs.empty())) {
+        vq_message msg;
+        while (!virtio_in->get(vqid, msg))
+            wait(m_rxev);
+
+        space += msg.length_out();
+        msgs.push_back(std::move(msg));
+    }
+
+    if (space < total) {
+        log_warn("reception buffer too small: %zu", space);
+        msgs[0].trim(0);
+        virtio_in->put(vqid, msgs[0]);
+        stats.rx_dropped++;
         return false;
     }
 
+    // eth_rx_offloads ensures we only get what the guest has accepted
     virtio_net_hdr hdr{};
     hdr.flags = 0;
-    hdr.gso_type = VIRTIO_NET_HDR_GSO_NONE;
-    hdr.num_buffers = 1;
+    hdr.gso_type = frame.gso_type;
+    hdr.num_buffers = msgs.size();
+
+    if (frame.csum_partial) {
+        hdr.flags |= VIRTIO_NET_HDR_F_NEEDS_CSUM;
+        hdr.csum_start = frame.csum_start;
+        hdr.csum_offset = frame.csum_offset;
+    } else if (frame.csum_valid && (m_features & VIRTIO_NET_F_GUEST_CSUM)) {
+        hdr.flags |= VIRTIO_NET_HDR_F_DATA_VALID;
+    }
+
+    if (frame.gso_type != eth_frame::GSO_NONE) {
+        hdr.gso_size = frame.gso_size;
+        hdr.hdr_len = gso_hdr_len(frame);
+    }
+
+    const u8* data = frame.data();
+    size_t remaining = frame.size();
+    bool success = true;
+
+    for (vq_message& msg : msgs) {
+        size_t offset = 0;
+        if (&msg == &msgs[0])
+            offset = msg.copy_out(hdr);
 
-    msg.copy_out(hdr);
-    msg.copy_out(frame.data(), frame.size(), sizeof(hdr));
-    msg.trim(frame.size() + sizeof(hdr));
+        size_t n = min<size_t>(remaining, msg.length_out() - offset);
+        msg.copy_out(data, n, offset);
+        msg.trim(offset + n);
 
+        data += n;
+        remaining -= n;
+
+        success &= virtio_in->put(vqid, msg);
+    }
+
+    if (!success) {
+        stats.rx_dropped++;
+        return false;
+    }
+
+    stats.rx_packets++;
+    stats.rx_bytes += frame.size();
     return true;
 }
 
-bool net::handle_tx(vq_message& msg) {
+bool net::handle_tx(u32 vqid, vq_message& msg) {
     virtio_net_hdr header;
 
     if (msg.length_in() <= sizeof(header)) {
@@ -257,12 +364,18 @@ bool net::handle_tx(vq_message& msg) {
 
     msg.copy_in(header);
 
-    if (header.flags) {
+    bool csum = header.flags & VIRTIO_NET_HDR_F_NEEDS_CSUM;
+    if (header.flags & ~VIRTIO_NET_HDR_F_NEEDS_CSUM ||
+        (csum && !(m_features & VIRTIO_NET_F_CSUM))) {
         log_warn("unsupported packet flags: %hhx", header.flags);
         return false;
     }
 
-    if (header.gso_type != VIRTIO_NET_HDR_GSO_NONE) {
+    bool gso4 = header.gso_type == VIRTIO_NET_HDR_GSO_TCPV4 &&
+                (m_features & VIRTIO_NET_F_HOST_TSO4);
+    bool gso6 = header.gso_type == VIRTIO_NET_HDR_GSO_TCPV6 &&
+                (m_features & VIRTIO_NET_F_HOST_TSO6);
+    if (header.gso_type != VIRTIO_NET_HDR_GSO_NONE && !gso4 && !gso6) {
         log_warn("unsupported packet gso type: %hu", header.gso_type);
         return false;
     }
@@ -270,38 +383,72 @@ bool net::handle_tx(vq_message& msg) {
     eth_frame frame(msg.length_in() - sizeof(header));
     msg.copy_in(frame.data(), frame.size(), sizeof(header));
 
+    // checksums and segmentation are finished by the receiver or backend
+    frame.csum_partial = csum;
+    frame.csum_start = header.csum_start;
+    frame.csum_offset = header.csum_offset;
+    frame.gso_type = header.gso_type;
+    frame.gso_size = header.gso_size;
+
     if (frame.size() < eth_frame::FRAME_MIN_SIZE)
         frame.resize(eth_frame::FRAME_MIN_SIZE);
-    if (frame.size() > m_config.mtu)
+    if (frame.size() > m_config.mtu && !frame.gso_type)
         log_warn("packet exceeds MTU: %zu bytes", frame.size());
 
+    queue_stats& stats = m_stats[vqid / 2];
+    stats.tx_packets++;
+    stats.tx_bytes += frame.size();
+
     eth_tx.send(frame);
     return true;
 }
 
+bool net::cmd_stats(const vector<string>& args, ostream& os) {
+    os << "active queue pairs: " << m_pairs << "/" << queues.get();
+    for (size_t i = 0; i < m_stats.size(); i++) {
+        const queue_stats& stats = m_stats[i];
+        os << std::endl
+           << "queue " << i << ": "
+           << "rx " << stats.rx_packets << " packets, " << stats.rx_bytes
+           << " bytes, " << stats.rx_dropped << " dropped; "
+           << "tx " << stats.tx_packets << " packets, " << stats.tx_bytes
+           << " bytes, " << stats.tx_errors << " errors";
+    }
+
+    return true;
+}
+
 void net::rx_thread() {
     while (true) {
-        vq_message msg;
-        while (!virtio_in->get(VIRTQUEUE_RX, msg))
-            wait(m_rxev);
-
         eth_frame frame;
         while (!eth_rx_pop(frame))
             wait(m_rxev);
 
-        if (!handle_rx(msg, frame) || !virtio_in->put(VIRTQUEUE_RX, msg))
+        if (!handle_rx(rx_queue(frame), frame))
             log_warn("packet reception failed");
     }
 }
 
 void net::tx_thread() {
     while (true) {
-        vq_message msg;
-        while (!virtio_in->get(VIRTQUEUE_TX, msg))
-            wait(m_txev);
+        bool idle = true;
+        for (u32 pair = 0; pair < m_pairs; pair++) {
+            u32 vqid = 2 * pair + VIRTQUEUE_TX;
+
+            vq_message msg;
+            if (!virtio_in->get(vqid, msg))
+                continue;
+
+            idle = false;
+            bool sent = handle_tx(vqid, msg);
+            if (!virtio_in->put(vqid, msg) || !sent) {
+                log_warn("packet transmission failed");
+                m_stats[pair].tx_errors++;
+            }
+        }
 
-        if (!handle_tx(msg) || !virtio_in->put(VIRTQUEUE_TX, msg))
-            log_warn("packet transmission failed");
+        if (idle)
+            wait(m_txev);
     }
 }
 
@@ -310,33 +457,43 @@ void net::identify(virtio_device_desc& desc) {
     desc.device_id = VIRTIO_DEVICE_NET;
     desc.vendor_id = VIRTIO_VENDOR_VCML;
     desc.pci_class = PCI_CLASS_NETWORK_ETHERNET;
-    desc.request_virtqueue(VIRTQUEUE_RX, 256);
-    desc.request_virtqueue(VIRTQUEUE_TX, 256);
-    desc.request_virtqueue(VIRTQUEUE_CTRL, 64);
+    for (u32 pair = 0; pair < queues; pair++) {
+        desc.request_virtqueue(2 * pair + VIRTQUEUE_RX, 256);
+        desc.request_virtqueue(2 * pair + VIRTQUEUE_TX, 256);
+    }
+
+    desc.request_virtqueue(2 * queues, 64);
 }
 
 bool net::notify(u32 vqid) {
-    switch (vqid) {
-    case VIRTQUEUE_RX:
-        m_rxev.notify(SC_ZERO_TIME);
-        return true;
-    case VIRTQUEUE_TX:
-        m_txev.notify(SC_ZERO_TIME);
-        return true;
-    case VIRTQUEUE_CTRL:
+    if (vqid == ctrl_queue()) {
         handle_ctrl();
         return true;
-    default:
+    }
+
+    if (vqid >= 2u * queues) {
         log_warn("invalid virtqueue notified: %u", vqid);
         return false;
     }
+
+    if (vqid % 2 == VIRTQUEUE_RX)
+        m_rxev.notify(SC_ZERO_TIME);
+    else
+        m_txev.notify(SC_ZERO_TIME);
+
+    return true;
 }
 
 void net::read_features(u64& features) {
     features = VIRTIO_NET_F_MTU | VIRTIO_NET_F_MAC | VIRTIO_NET_F_STATUS |
                VIRTIO_NET_F_CTRL_VQ | VIRTIO_NET_F_CTRL_RX |
                VIRTIO_NET_F_CTRL_RX_EXTRA | VIRTIO_NET_F_CTRL_ANNOUNCE |
-               VIRTIO_NET_F_CTRL_MAC_ADDR;
+               VIRTIO_NET_F_CTRL_MAC_ADDR | VIRTIO_NET_F_MRG_RXBUF |
+               VIRTIO_NET_F_CSUM | VIRTIO_NET_F_GUEST_CSUM |
+               VIRTIO_NET_F_HOST_TSO4 | VIRTIO_NET_F_HOST_TSO6 |
+               VIRTIO_NET_F_GUEST_TSO4 | VIRTIO_NET_F_GUEST_TSO6;
+    if (queues > 1)
+        features |= VIRTIO_NET_F_MQ;
 }
 
 bool net::write_features(u64 features) {
@@ -347,6 +504,7 @@ bool net::write_features(u64 features) {
         return false;
     }
 
+    m_features = features;
     return true;
 }
 
@@ -362,6 +520,17 @@ bool net::write_config(const range& addr, const void* ptr) {
     return false;
 }
 
+u32 net::eth_rx_offloads() const {
+    u32 offloads = ETH_OFFLOAD_NONE;
+    if (m_features & VIRTIO_NET_F_GUEST_CSUM)
+        offloads |= ETH_OFFLOAD_CSUM;
+    if (m_features & VIRTIO_NET_F_GUEST_TSO4)
+        offloads |= ETH_OFFLOAD_TSO4;
+    if (m_features & VIRTIO_NET_F_GUEST_TSO6)
+        offloads |= ETH_OFFLOAD_TSO6;
+    return offloads;
+}
+
 void net::eth_link_up() {
     u16 status = m_config.status & ~VIRTIO_NET_S_LINK_UP;
     if (eth_tx.link_up() && eth_rx.link_up())
@@ -393,6 +562,9 @@ net::net(const sc_module_name& nm):
     eth_host(),
     m_config(),
     m_mac(mac_addr::temporary()),
+    m_features(0),
+    m_pairs(1),
+    m_stats(),
     m_promisc(false),
     m_allmulti(false),
     m_alluni(false),
@@ -405,6 +577,7 @@ net::net(const sc_module_name& nm):
     m_txev("txev"),
     mac("mac"),
     mtu("mtu", 1500),
+    queues("queues", 1),
     virtio_in("virtio_in"),
     eth_tx("eth_tx"),
     eth_rx("eth_rx") {
@@ -420,6 +593,9 @@ net::net(const sc_module_name& nm):
     SC_THREAD(tx_thread);
     sensitive << m_txev;
     dont_initialize();
+
+    register_command("stats", 0, &net::cmd_stats,
+                     "shows per-queue rx and tx statistics");
 }
 
 net::~net() {
@@ -449,7 +625,13 @@ void net::reset() {
     if (eth_rx.link_up() && eth_tx.link_up())
         m_config.status |= VIRTIO_NET_S_LINK_UP;
 
-    m_config.max_vq_pairs = 1;
+    VCML_ERROR_ON(queues < 1, "%s needs at least one queue pair", name());
+
+    m_features = 0;
+    m_pairs = 1;
+    m_stats.assign(queues, queue_stats());
+
+    m_config.max_vq_pairs = queues;
     m_config.mtu = mtu;
 }
 
@@ -74,6 +74,8 @@ void pci::enable_virtqueue(u32 vqid) {
     else
         q = m_queues[vqid] = new split_virtqueue(qd, dmifn);
 
+    q->deferred = irq_batch > 0;
+
     if (!q->validate()) {
         log_warn("failed to enable virtqueue %u", vqid);
         device_status = VIRTIO_STATUS_DEVICE_NEEDS_RESET;
@@ -102,6 +104,26 @@ void pci::cleanup_virtqueues() {
     for (auto it : m_queues)
         delete it.second;
     m_queues.clear();
+    m_pending_vqs.clear();
+    m_batched = 0;
+}
+
+void pci::flush_virtqueues() {
+    // queues that share an msi-x vector only get a single interrupt
+    vector<u16> vectors;
+    for (auto it : m_queues) {
+        virtqueue* q = it.second;
+        if (q->publish() && !stl_contains(vectors, q->vector))
+            vectors.push_back(q->vector);
+    }
+
+    m_batched = 0;
+    m_flush_ev.cancel();
+
+    if (!vectors.empty())
+        irq_status |= VIRTIO_IRQSTATUS_VQUEUE;
+    for (u16 vec : vectors)
+        pci_interrupt(true, vec);
 }
 
 bool pci::get(u32 vqid, vq_message& msg) {
@@ -133,13 +155,63 @@ bool pci::put(u32 vqid, vq_message& msg) {
     }
 
     virtqueue* q = it->second;
-    bool result = q->put(msg);
-    if (result && q->notify) {
+    if (!q->put(msg))
+        return false;
+
+    if (q->deferred) {
+        if (++m_batched >= irq_batch)
+            flush_virtqueues();
+        else if (m_batched == 1)
+            m_flush_ev.notify(irq_delay);
+        return true;
+    }
+
+    if (q->notify) {
+        irq_status |= VIRTIO_IRQSTATUS_VQUEUE;
+        pci_interrupt(true, q->vector);
+    }
+
+    return true;
+}
+
+bool pci::put_batch(u32 vqid, vector<vq_message>& msgs) {
+    if (!device_ready()) {
+        log_warn("put: device not ready");
+        return false;
+    }
+
+    auto it = m_queues.find(vqid);
+    if (it == m_queues.end()) {
+        log_warn("put: illegal virtqueue %u", vqid);
+        return false;
+    }
+
+    virtqueue* q = it->second;
+    bool deferred = q->deferred;
+    size_t count = 0;
+
+    q->deferred = true;
+    for (vq_message& msg : msgs) {
+        if (!q->put(msg))
+            break;
+        count++;
+    }
+
+    q->deferred = deferred;
+
+    if (deferred && count > 0) {
+        size_t batched = m_batched;
+        m_batched += count;
+        if (m_batched >= irq_batch)
+            flush_virtqueues();
+        else if (batched == 0)
+            m_flush_ev.notify(irq_delay);
+    } else if (q->publish()) {
         irq_status |= VIRTIO_IRQSTATUS_VQUEUE;
         pci_interrupt(true, q->vector);
     }
 
-    return result;
+    return count == msgs.size();
 }
 
 bool pci::notify() {
@@ -375,6 +447,17 @@ void pci::write_queue_notify(u32 val) {
     }
 
     queue_notify = val;
+    if (async_notify) {
+        if (!stl_contains(m_pending_vqs, vqid))
+            m_pending_vqs.push_back(vqid);
+        m_notify_ev.notify(SC_ZERO_TIME);
+        return;
+    }
+
+    notify_virtqueue(vqid);
+}
+
+void pci::notify_virtqueue(u32 vqid) {
     log_debug("notifying virtqueue %u", vqid);
     if (!virtio_out->notify(vqid)) {
         log_warn("notify: device reported failure");
@@ -382,6 +465,20 @@ void pci::write_queue_notify(u32 val) {
     }
 }
 
+void pci::notify_thread() {
+    while (true) {
+        wait(m_notify_ev);
+
+        // queues notified while the device is busy are picked up as well
+        while (!m_pending_vqs.empty()) {
+            u32 vqid = m_pending_vqs.front();
+            m_pending_vqs.pop_front();
+            if (device_ready() && stl_contains(m_queues, vqid))
+                notify_virtqueue(vqid);
+        }
+    }
+}
+
 u32 pci::read_irq_status() {
     u32 val = irq_status;
     irq_status = 0;
@@ -396,12 +493,19 @@ pci::pci(const sc_module_name& nm):
     m_dev_features(),
     m_device(),
     m_queues(),
+    m_batched(0),
+    m_flush_ev("flush_ev"),
+    m_pending_vqs(),
+    m_notify_ev("notify_ev"),
     m_cap_common(),
     m_cap_notify(),
     m_cap_isr(),
     m_cap_device(),
     use_packed_queues("use_packed_queues", false),
     use_strong_barriers("use_strong_barriers", false),
+    irq_batch("irq_batch", 0),
+    irq_delay("irq_delay", SC_ZERO_TIME),
+    async_notify("async_notify", false),
     msix_vectors("msix_vectors", 16),
     virtio_bar("virtio_bar", 4),
     msix_bar("msix_bar", 2),
@@ -508,6 +612,13 @@ pci::pci(const sc_module_name& nm):
         pci_declare_bar(msix_bar, 0x1000, PCI_BAR_MMIO);
         pci_declare_msix_cap(msix_bar, msix_vectors, 0);
     }
+
+    SC_HAS_PROCESS(pci);
+    SC_METHOD(flush_virtqueues);
+    sensitive << m_flush_ev;
+    dont_initialize();
+
+    SC_THREAD(notify_thread);
 }
 
 pci::~pci() {
@@ -527,6 +638,7 @@ void pci::reset() {
     pci::device::reset();
 
     cleanup_virtqueues();
+    m_flush_ev.cancel();
 
     m_drv_features = 0ull;
     m_dev_features = 0ull;
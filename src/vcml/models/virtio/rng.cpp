@@ -29,16 +29,15 @@ bool rng::notify(u32 vqid) {
         log_debug("received message from virtqueue %u with %u bytes", vqid,
                   msg.length());
 
-        vector<u8> random(msg.length_out());
-        if (pseudo) {
-            for (auto& elem : random)
-                elem = rand();
-        } else {
-            mwr::fill_random(random.data(), random.size());
+        // fill guest buffers in place
+        vector<iovec> iov;
+        msg.map_out(iov);
+        for (const iovec& vec : iov) {
+            if (!m_pool.fill(vec.iov_base, vec.iov_len))
+                log_warn("failed to get random data");
         }
 
         count++;
-        msg.copy_out(random);
 
         if (!virtio_in->put(vqid, msg))
             return false;
@@ -69,9 +68,11 @@ bool rng::write_config(const range& addr, const void* ptr) {
 rng::rng(const sc_module_name& nm):
     module(nm),
     virtio_device(),
+    m_pool(),
     virtio_in("virtio_in"),
     pseudo("pseudo", false),
     seed("seed", 0) {
+    m_pool.reset(pseudo, seed);
 }
 
 rng::~rng() {
@@ -79,8 +80,7 @@ rng::~rng() {
 }
 
 void rng::reset() {
-    if (pseudo)
-        srand(seed);
+    m_pool.reset(pseudo, seed);
 }
 
 VCML_EXPORT_MODEL(vcml::virtio::rng, name, args) {
@@ -10,9 +10,195 @@
 
 #include "vcml/properties/broker.h"
 #include "vcml/logging/logger.h"
+#include "vcml/core/startup.h"
 
 namespace vcml {
 
+static bool is_pattern(const string& key) {
+    return key.find_first_of("*?") != string::npos;
+}
+
+static bool glob_match(const string& pattern, const string& str) {
+    size_t p = 0, s = 0;
+    size_t star = string::npos, mark = 0;
+    while (s < str.length()) {
+        if (p < pattern.length() &&
+            (pattern[p] == '?' || pattern[p] == str[s])) {
+            p++;
+            s++;
+        } else if (p < pattern.length() && pattern[p] == '*') {
+            star = p++;
+            mark = s;
+        } else if (star != string::npos) {
+            p = star + 1;
+            s = ++mark;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.length() && pattern[p] == '*')
+        p++;
+    return p == pattern.length();
+}
+
+static bool pattern_match(const string& pattern, const string& name) {
+    vector<string> pseg = split(pattern, SC_HIERARCHY_CHAR);
+    vector<string> nseg = split(name, SC_HIERARCHY_CHAR);
+    if (pseg.size() != nseg.size())
+        return false;
+
+    for (size_t i = 0; i < pseg.size(); i++)
+        if (!glob_match(pseg[i], nseg[i]))
+            return false;
+
+    return true;
+}
+
+class broker::key_index
+{
+public:
+    struct hit {
+        size_t pos;
+        struct value* val;
+    };
+
+private:
+    // wildcard patterns are stored in a trie with one level per hierarchy
+    // level, so that only matching subtrees need to be searched
+    struct node {
+        hit entry = { 0, nullptr };
+        unordered_map<string, unique_ptr<node>> literal;
+        vector<pair<string, unique_ptr<node>>> wildcard;
+    };
+
+    unordered_map<string, hit> m_exact;
+    node m_root;
+    size_t m_patterns;
+    bool m_dirty;
+
+    static void update(hit& h, size_t pos, struct value* val) {
+        // lower positions have higher priority
+        if (h.val == nullptr || pos < h.pos)
+            h = { pos, val };
+    }
+
+    node& insert_pattern(const string& key);
+    void find(const node& n, const vector<string>& segs, size_t i,
+              hit& best) const;
+
+public:
+    bool is_dirty() const { return m_dirty; }
+    void invalidate() { m_dirty = true; }
+
+    key_index(): m_exact(), m_root(), m_patterns(0), m_dirty(true) {}
+
+    void clear();
+    void insert(size_t pos, const string& key, struct value* val);
+    void rebuild(const vector<broker*>& brokers);
+    hit lookup(const string& name) const;
+};
+
+broker::key_index::node& broker::key_index::insert_pattern(const string& k) {
+    node* curr = &m_root;
+    for (const string& seg : split(k, SC_HIERARCHY_CHAR)) {
+        if (!is_pattern(seg)) {
+            auto& child = curr->literal[seg];
+            if (!child)
+                child = std::make_unique<node>();
+            curr = child.get();
+            continue;
+        }
+
+        node* next = nullptr;
+        for (auto& wc : curr->wildcard)
+            if (wc.first == seg)
+                next = wc.second.get();
+
+        if (next == nullptr) {
+            curr->wildcard.emplace_back(seg, std::make_unique<node>());
+            next = curr->wildcard.back().second.get();
+        }
+
+        curr = next;
+    }
+
+    return *curr;
+}
+
+void broker::key_index::find(const node& n, const vector<string>& segs,
+                             size_t i, hit& best) const {
+    if (i == segs.size()) {
+        if (n.entry.val)
+            update(best, n.entry.pos, n.entry.val);
+        return;
+    }
+
+    // literal children first, so that more specific patterns win ties
+    auto it = n.literal.find(segs[i]);
+    if (it != n.literal.end())
+        find(*it->second, segs, i + 1, best);
+
+    for (const auto& wc : n.wildcard)
+        if (glob_match(wc.first, segs[i]))
+            find(*wc.second, segs, i + 1, best);
+}
+
+void broker::key_index::clear() {
+    m_exact.clear();
+    m_root.entry = { 0, nullptr };
+    m_root.literal.clear();
+    m_root.wildcard.clear();
+    m_patterns = 0;
+}
+
+void broker::key_index::insert(size_t pos, const string& key,
+                               struct value* val) {
+    if (!is_pattern(key)) {
+        auto it = m_exact.find(key);
+        if (it == m_exact.end())
+            m_exact[key] = { pos, val };
+        else
+            update(it->second, pos, val);
+        return;
+    }
+
+    node& n = insert_pattern(key);
+    if (n.entry.val == nullptr)
+        m_patterns++;
+    update(n.entry, pos, val);
+}
+
+void broker::key_index::rebuild(const vector<broker*>& brokers) {
+    clear();
+    for (size_t pos = 0; pos < brokers.size(); pos++) {
+        if (!brokers[pos]->indexed())
+            continue;
+
+        for (auto& it : brokers[pos]->m_values)
+            insert(pos, it.first, &it.second);
+    }
+
+    m_dirty = false;
+}
+
+broker::key_index::hit broker::key_index::lookup(const string& name) const {
+    hit best = { 0, nullptr };
+    auto it = m_exact.find(name);
+    if (it != m_exact.end())
+        best = it->second;
+
+    if (m_patterns > 0)
+        find(m_root, split(name, SC_HIERARCHY_CHAR), 0, best);
+
+    return best;
+}
+
+broker::key_index& broker::shared_index() {
+    static key_index index;
+    return index;
+}
+
 string broker::expand(const string& s) {
     string str = s;
     size_t pos = 0;
@@ -30,8 +216,45 @@ string broker::expand(const string& s) {
     return trim(str);
 }
 
+void broker::expand_deferred(const string& key, struct value& val) {
+    // values currently being expanded, to catch recursive definitions
+    static vector<const struct value*> active;
+    if (stl_contains(active, &val))
+        VCML_REPORT("%s recursive definition of %s", val.origin.c_str(),
+                    key.c_str());
+
+    active.push_back(&val);
+
+    try {
+        val.value = expand(val.value);
+    } catch (report& rep) {
+        active.pop_back();
+        VCML_REPORT("%s %s", val.origin.c_str(), rep.message());
+    }
+
+    active.pop_back();
+    val.deferred = false;
+    val.origin.clear();
+}
+
 static vector<broker*> g_brokers;
 
+void broker::define_value(const string& key, const string& val,
+                          size_t uses) {
+    struct value& v = m_values[key];
+    v = { val, uses, {}, false, {} };
+
+    // keep the index up to date instead of rebuilding it, since brokers
+    // usually define all their values right after construction
+    key_index& index = shared_index();
+    if (index.is_dirty() || !indexed())
+        return;
+
+    auto it = std::find(g_brokers.begin(), g_brokers.end(), this);
+    if (it != g_brokers.end())
+        index.insert(it - g_brokers.begin(), key, &v);
+}
+
 broker::broker(const string& nm): m_name(nm), m_values() {
     define("app", mwr::progname(), 1);
     define("bin", mwr::dirname(mwr::progname()), 1);
@@ -40,20 +263,28 @@ broker::broker(const string& nm): m_name(nm), m_values() {
     define("usr", mwr::username(), 1);
     define("pid", mwr::getpid(), 1);
     g_brokers.push_back(this);
+    shared_index().invalidate();
 }
 
 broker::~broker() {
     stl_remove(g_brokers, this);
+    shared_index().invalidate();
 }
 
 bool broker::lookup(const string& key, string& value) {
-    if (!stl_contains(m_values, key))
-        return false;
-
     auto it = m_values.find(key);
+    if (it == m_values.end()) {
+        for (it = m_values.begin(); it != m_values.end(); it++)
+            if (is_pattern(it->first) && pattern_match(it->first, key))
+                break;
+    }
+
     if (it == m_values.end())
         return false;
 
+    if (it->second.deferred)
+        expand_deferred(it->first, it->second);
+
     value = it->second.value;
     it->second.uses++;
     return true;
@@ -63,11 +294,53 @@ bool broker::defines(const string& key) const {
     return stl_contains(m_values, key);
 }
 
+void broker::define_deferred(const string& key, const string& val,
+                             const string& origin) {
+    string name = expand(key);
+    define_value(name, val, 0);
+    if (val.find("${") != string::npos) {
+        struct value& v = m_values[name];
+        v.deferred = true;
+        v.origin = origin;
+    }
+}
+
+void broker::undefine(const string& key) {
+    m_values.erase(key);
+    shared_index().invalidate();
+}
+
 template <>
 broker* broker::init(const string& name, string& value) {
-    for (auto broker : g_brokers)
-        if (broker->lookup(name, value))
-            return broker;
+    struct value* val = nullptr;
+    return find(name, value, val);
+}
+
+broker* broker::find(const string& name, string& value, struct value*& val) {
+    startup_profiler::scope profile("broker", "property lookups");
+    key_index& index = shared_index();
+    if (index.is_dirty())
+        index.rebuild(g_brokers);
+
+    key_index::hit hit = index.lookup(name);
+    for (size_t pos = 0; pos < g_brokers.size(); pos++) {
+        broker* brkr = g_brokers[pos];
+        if (!brkr->indexed()) {
+            if (brkr->lookup(name, value))
+                return brkr;
+            continue;
+        }
+
+        if (hit.val != nullptr && hit.pos == pos) {
+            if (hit.val->deferred)
+                brkr->expand_deferred(name, *hit.val);
+            value = hit.val->value;
+            hit.val->uses++;
+            val = hit.val;
+            return brkr;
+        }
+    }
+
     return nullptr;
 }
 
@@ -9,10 +9,43 @@
  ******************************************************************************/
 
 #include "vcml/logging/logger.h"
+#include "vcml/core/startup.h"
 #include "vcml/properties/broker_file.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 namespace vcml {
 
+typedef std::string_view strview;
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' ||
+           c == '\f';
+}
+
+static strview strip_left(strview s) {
+    while (!s.empty() && is_space(s.front()))
+        s.remove_prefix(1);
+    return s;
+}
+
+static strview strip_right(strview s) {
+    while (!s.empty() && is_space(s.back()))
+        s.remove_suffix(1);
+    return s;
+}
+
+static strview strip(strview s) {
+    return strip_left(strip_right(s));
+}
+
+static bool has_prefix(strview s, strview prefix) {
+    return s.substr(0, prefix.size()) == prefix;
+}
+
 void broker_file::parse_file(const string& file) {
     if (!mwr::file_exists(file)) {
         log_error("no such file: %s", file.c_str());
@@ -20,63 +53,121 @@ void broker_file::parse_file(const string& file) {
         return;
     }
 
-    size_t lno = 0;
-    string line, prev;
-    ifstream stream(file.c_str());
-
-    if (!stream.good()) {
+    int fd = open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
         log_error("cannot read '%s'", file.c_str());
+        if (fd >= 0)
+            close(fd);
         m_errors++;
         return;
     }
 
+    // empty files cannot be mapped, but there is nothing to parse anyway
+    size_t size = st.st_size;
+    void* map = nullptr;
+    if (size > 0) {
+        map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            log_error("cannot map '%s': %s", file.c_str(), strerror(errno));
+            close(fd);
+            m_errors++;
+            return;
+        }
+
+        madvise(map, size, MADV_SEQUENTIAL);
+    }
+
+    close(fd);
+
+    double start = mwr::timestamp();
+    parse_text((const char*)map, size, file);
+    double secs = mwr::timestamp() - start;
+
+    if (map != nullptr)
+        munmap(map, size);
+
+    // includes are parsed in between, so they count towards this file, too
+    if (startup_profiler::enabled()) {
+        double mib = (double)size / MiB;
+        string name = mkstr("%s (%.1fMiB, %.1fMiB/s)", file.c_str(), mib,
+                            secs > 0.0 ? mib / secs : 0.0);
+        startup_profiler::record("config", name, secs);
+    }
+
+    for (const auto& loop : m_loops) {
+        m_errors++;
+        log_error("%s:%zu unmatched 'for'", loop.file.c_str(), loop.line);
+    }
+}
+
+void broker_file::parse_text(const char* text, size_t size,
+                             const string& file) {
+    const char* end = text + size;
+    const char* ptr = text;
+    size_t lno = 0;
+    size_t stmt_line = 0;
+    size_t stmt_col = 0;
+
+    // only statements spanning multiple lines need to be copied
+    string cont;
+
     try {
-        while (std::getline(stream, line)) {
+        while (ptr < end) {
+            const char* bol = ptr;
+            const char* eol = (const char*)memchr(ptr, '\n', end - ptr);
+            if (eol == nullptr)
+                eol = end;
+            ptr = eol < end ? eol + 1 : end;
             lno++;
 
-            // remove comments
+            strview line(bol, eol - bol);
+
+            // remove comments and trailing white spaces
             size_t pos = line.find('#');
             if (pos != line.npos)
-                line.erase(pos);
-
-            // remove white spaces
-            line = rtrim(line);
-
-            // prepend buffer from previous lines
-            line = strcat(prev, line);
-            prev = "";
+                line = line.substr(0, pos);
+            line = strip_right(line);
+
+            // append to buffer from previous lines
+            if (!cont.empty()) {
+                cont.append(line.data(), line.size());
+                line = cont;
+            } else {
+                line = strip_left(line);
+                stmt_line = lno;
+                stmt_col = line.data() - bol + 1;
+            }
 
             if (line.empty())
                 continue;
 
             // continue on next line?
-            if (line[line.size() - 1] == '\\') {
-                prev += line.substr(0, line.size() - 1);
+            if (line.back() == '\\') {
+                if (cont.empty())
+                    cont.assign(line.data(), line.size());
+                cont.pop_back();
                 continue;
             }
 
-            // trim again and parse
-            parse_expr(ltrim(line), file, lno);
+            parse_expr(strip_left(line), file, stmt_line, stmt_col);
+            cont.clear();
         }
     } catch (std::exception& ex) {
         m_errors++;
-        log_error("%s:%zu %s", file.c_str(), lno, ex.what());
-    }
-
-    for (const auto& loop : m_loops) {
-        m_errors++;
-        log_error("%s:%zu unmatched 'for'", loop.file.c_str(), loop.line);
+        log_error("%s:%zu:%zu %s", file.c_str(), stmt_line, stmt_col,
+                  ex.what());
     }
 }
 
-void broker_file::parse_expr(const string& expr, const string& file,
-                             size_t line) {
+void broker_file::parse_expr(strview expr, const string& file, size_t line,
+                             size_t col) {
     if (expr.empty())
         return;
 
     // check for include directive
-    if (starts_with(expr, "%include ")) {
-        string incl = expand(trim(expr.substr(9)));
+    if (has_prefix(expr, "%include ")) {
+        string incl = expand(string(strip(expr.substr(9))));
         define("dir", mwr::dirname(incl), 1);
         parse_file(incl);
         define("dir", mwr::dirname(file), 1);
@@ -84,34 +175,40 @@ void broker_file::parse_expr(const string& expr, const string& file,
     }
 
     // check for loop directive
-    if (starts_with(expr, "for ")) {
-        parse_loop(trim(expr), file, line);
+    if (has_prefix(expr, "for ")) {
+        parse_loop(strip(expr), file, line, col);
         return;
     }
 
     // check for end-loop directive
-    if (starts_with(expr, "done")) {
-        parse_done(trim(expr), file, line);
+    if (has_prefix(expr, "done")) {
+        parse_done(strip(expr), file, line, col);
         return;
     }
 
     // read key=value part
     size_t separator = expr.find('=');
     if (separator == expr.npos)
-        VCML_REPORT("%s:%zu missing '='", file.c_str(), line);
+        VCML_REPORT("missing '='");
 
-    string key = expr.substr(0, separator);
-    string val = expr.substr(separator + 1);
+    strview key = strip(expr.substr(0, separator));
+    strview val = strip(expr.substr(separator + 1));
+    if (key.empty())
+        return;
 
-    key = trim(key);
-    val = trim(val);
+    // values referring to variables that change while parsing must be
+    // expanded now, all others are only expanded once they are looked up
+    if (m_loops.empty() && !is_volatile(val)) {
+        string origin = mkstr("%s:%zu:%zu", file.c_str(), line, col);
+        define_deferred(string(key), string(val), origin);
+        return;
+    }
 
-    if (!key.empty())
-        resolve(key, val, file, line);
+    resolve(string(key), string(val), file, line);
 }
 
-void broker_file::parse_loop(const string& expr, const string& file,
-                             size_t line) {
+void broker_file::parse_loop(strview expr, const string& file, size_t line,
+                             size_t col) {
     loopdesc loop;
     loop.file = file;
     loop.line = line;
@@ -123,16 +220,16 @@ void broker_file::parse_loop(const string& expr, const string& file,
 
     if (delim0 == expr.npos || delim1 == expr.npos || delim0 >= delim1) {
         m_errors++;
-        log_error("%s:%zu error parsing loop", file.c_str(), line);
+        log_error("%s:%zu:%zu error parsing loop", file.c_str(), line, col);
         return;
     }
 
     // parse ITER
-    loop.iter = trim(expr.substr(offset, delim0 - offset - 1));
+    loop.iter = string(strip(expr.substr(offset, delim0 - offset - 1)));
 
     // parse BOUNDS
-    string bounds = expand(trim(expr.substr(delim0 + 1, delim1 - delim0 - 1)));
-    size_t start = 0, limit = from_string<size_t>(bounds);
+    strview bounds = strip(expr.substr(delim0 + 1, delim1 - delim0 - 1));
+    size_t start = 0, limit = from_string<size_t>(expand(string(bounds)));
 
     for (size_t i = start; i < limit; i++)
         loop.values.push_back(to_string(i));
@@ -140,17 +237,35 @@ void broker_file::parse_loop(const string& expr, const string& file,
     m_loops.push_front(loop);
 }
 
-void broker_file::parse_done(const string& expr, const string& file,
-                             size_t line) {
+void broker_file::parse_done(strview expr, const string& file, size_t line,
+                             size_t col) {
     if (m_loops.empty()) {
         m_errors++;
-        log_error("%s:%zu unmatched '%s'", file.c_str(), line, expr.c_str());
+        log_error("%s:%zu:%zu unmatched '%s'", file.c_str(), line, col,
+                  string(expr).c_str());
         return;
     }
 
     m_loops.pop_front();
 }
 
+bool broker_file::is_volatile(strview val) const {
+    size_t pos = 0;
+    while ((pos = val.find("${", pos)) != val.npos) {
+        size_t end = val.find('}', pos + 2);
+        if (end == val.npos)
+            return true; // let expand report the error right away
+
+        strview var = val.substr(pos + 2, end - pos - 2);
+        if (var == "dir")
+            return true;
+
+        pos = end + 1;
+    }
+
+    return false;
+}
+
 void broker_file::resolve(const string& key, const string& val,
                           const string& file, size_t line) {
     if (m_loops.empty()) {
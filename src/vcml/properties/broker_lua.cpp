@@ -14,6 +14,11 @@
 
 #include <lua.hpp>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 namespace vcml {
 
 static logger& lua_logger() {
@@ -21,6 +26,32 @@ static logger& lua_logger() {
     return log;
 }
 
+// everything a script did to its broker, in order, so that a cached run can
+// be replayed and checked against the current key value store
+struct lua_record {
+    enum op : u8 {
+        OP_DEFINE = 1,
+        OP_LOOKUP = 2,
+        OP_MISSING = 3,
+    };
+
+    struct entry {
+        op type;
+        string key;
+        string val;
+    };
+
+    vector<entry> entries;
+};
+
+// only set while a script runs with caching enabled
+static lua_record* g_record = nullptr;
+
+static void record(lua_record::op type, const string& key, const string& val) {
+    if (g_record)
+        g_record->entries.push_back({ type, key, val });
+}
+
 static broker_lua* lua_broker(lua_State* lua) {
     return static_cast<broker_lua*>(lua_touserdata(lua, lua_upvalueindex(1)));
 }
@@ -76,7 +107,10 @@ static int do_define(lua_State* lua) {
         return 0;
     }
 
-    lua_broker(lua)->define(lua_tostring(lua, -2), lua_tostring(lua, -1));
+    string name = lua_tostring(lua, -2);
+    string value = lua_tostring(lua, -1);
+    record(lua_record::OP_DEFINE, name, value);
+    lua_broker(lua)->define(name, value);
     return 0;
 }
 
@@ -88,10 +122,14 @@ static int do_lookup(lua_State* lua) {
     }
 
     string value, name = lua_tostring(lua, -1);
-    if (lua_broker(lua)->lookup(name, value))
+    if (lua_broker(lua)->lookup(name, value)) {
+        record(lua_record::OP_LOOKUP, name, value);
         lua_pushstring(lua, value.c_str());
-    else
+    } else {
+        record(lua_record::OP_MISSING, name, "");
         lua_pushnil(lua);
+    }
+
     return 1;
 }
 
@@ -136,10 +174,13 @@ static void define_globals(lua_State* lua, broker* b, const string& parent) {
     while (lua_next(lua, -2) != 0) {
         string name = global_name(lua, parent);
         if (!symbol_filtered(name)) {
-            if (lua_isstring(lua, -1))
-                b->define(name, lua_tostring(lua, -1));
-            else if (lua_istable(lua, -1))
+            if (lua_isstring(lua, -1)) {
+                string value = lua_tostring(lua, -1);
+                record(lua_record::OP_DEFINE, name, value);
+                b->define(name, value);
+            } else if (lua_istable(lua, -1)) {
                 define_globals(lua, b, name + ".");
+            }
         }
 
         lua_pop(lua, 1);
@@ -152,7 +193,197 @@ static void define_globals(lua_State* lua, broker* b) {
     lua_pop(lua, 1);
 }
 
-broker_lua::broker_lua(const string& file): broker("lua") {
+static vector<pair<string, string>> lua_strings(const string& file) {
+    return {
+        { "vcml_version_string", VCML_VERSION_STRING },
+        { "systemc_version_string", SC_VERSION },
+        { "username", mwr::username() },
+        { "config", mwr::filename_noext(file) },
+        { "cfgdir", mwr::dirname(file) },
+        { "simdir", mwr::progname() },
+        { "curdir", mwr::curr_dir() },
+    };
+}
+
+static u64 fnv1a(u64 hash, const void* data, size_t size) {
+    const u8* ptr = (const u8*)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ ptr[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+static u64 fnv1a(u64 hash, const string& s) {
+    // include the terminator so that "ab","c" differs from "a","bc"
+    return fnv1a(hash, s.c_str(), s.length() + 1);
+}
+
+// vp.pid is left out on purpose, it would defeat the cache
+static u64 lua_cache_hash(const string& file) {
+    ifstream is(file, std::ios::binary);
+    if (!is)
+        return 0;
+
+    stringstream ss;
+    ss << is.rdbuf();
+
+    u64 hash = fnv1a(0xcbf29ce484222325ull, ss.str());
+    hash = fnv1a(hash, mkstr("%lld:%lld", (long long)VCML_VERSION,
+                             (long long)SYSTEMC_VERSION));
+    for (const auto& [field, value] : lua_strings(file))
+        hash = fnv1a(fnv1a(hash, field), value);
+
+    vector<string> env;
+    for (char** var = environ; var && *var; var++)
+        env.push_back(*var);
+    std::sort(env.begin(), env.end());
+    for (const string& var : env)
+        hash = fnv1a(hash, var);
+
+    return hash ? hash : 1;
+}
+
+static string lua_cache_path(const string& file) {
+    auto dir = mwr::getenv("VCML_LUA_CACHE");
+    if (!dir || dir->empty())
+        return "";
+
+    u64 id = fnv1a(0xcbf29ce484222325ull, file);
+    return mkstr("%s/%s-%016llx.luacache", dir->c_str(),
+                 mwr::filename_noext(file).c_str(), id);
+}
+
+struct lua_cache_header {
+    char magic[8];
+    u32 version;
+    u32 count;
+    u64 hash;
+};
+
+static const char LUA_CACHE_MAGIC[8] = "vcmllua";
+static const u32 LUA_CACHE_VERSION = 1;
+
+static void store_cache(const string& path, u64 hash, const lua_record& rec) {
+    string temp = mkstr("%s.%d", path.c_str(), (int)mwr::getpid());
+    ofstream os(temp, std::ios::binary | std::ios::trunc);
+    if (!os) {
+        lua_logger().warn("cannot write lua cache %s", temp.c_str());
+        return;
+    }
+
+    lua_cache_header hdr = {};
+    memcpy(hdr.magic, LUA_CACHE_MAGIC, sizeof(hdr.magic));
+    hdr.version = LUA_CACHE_VERSION;
+    hdr.count = rec.entries.size();
+    hdr.hash = hash;
+    os.write((const char*)&hdr, sizeof(hdr));
+
+    for (const auto& entry : rec.entries) {
+        u32 lens[2] = { (u32)entry.key.length(), (u32)entry.val.length() };
+        os.put((char)entry.type);
+        os.write((const char*)lens, sizeof(lens));
+        os.write(entry.key.data(), lens[0]);
+        os.write(entry.val.data(), lens[1]);
+    }
+
+    os.close();
+
+    // rename last, so concurrent startups never see partial files
+    if (!os || rename(temp.c_str(), path.c_str()) != 0) {
+        lua_logger().warn("cannot write lua cache %s", path.c_str());
+        remove(temp.c_str());
+    }
+}
+
+bool broker_lua::load_cache(const string& path, u64 hash) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(lua_cache_header)) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const u8* ptr = (const u8*)map;
+    const u8* end = ptr + size;
+
+    lua_cache_header hdr;
+    memcpy(&hdr, ptr, sizeof(hdr));
+    ptr += sizeof(hdr);
+
+    bool valid = memcmp(hdr.magic, LUA_CACHE_MAGIC, 8) == 0 &&
+                 hdr.version == LUA_CACHE_VERSION && hdr.hash == hash;
+
+    // undo everything replayed so far if anything turns out stale
+    std::map<string, struct value> saved = m_values;
+
+    try {
+        for (u32 i = 0; valid && i < hdr.count; i++) {
+            u32 lens[2];
+            if ((size_t)(end - ptr) < 1 + sizeof(lens)) {
+                valid = false;
+                break;
+            }
+
+            u8 type = *ptr++;
+            memcpy(lens, ptr, sizeof(lens));
+            ptr += sizeof(lens);
+
+            if ((size_t)(end - ptr) < (size_t)lens[0] + lens[1]) {
+                valid = false;
+                break;
+            }
+
+            string key((const char*)ptr, lens[0]);
+            string val((const char*)ptr + lens[0], lens[1]);
+            ptr += lens[0] + lens[1];
+
+            string curr;
+            switch (type) {
+            case lua_record::OP_DEFINE:
+                define(key, val);
+                break;
+            case lua_record::OP_LOOKUP:
+                valid = lookup(key, curr) && curr == val;
+                break;
+            case lua_record::OP_MISSING:
+                valid = !lookup(key, curr);
+                break;
+            default:
+                valid = false;
+                break;
+            }
+        }
+    } catch (std::exception& ex) {
+        valid = false;
+    }
+
+    munmap(map, size);
+
+    if (!valid) {
+        vector<string> added;
+        for (auto& [key, val] : m_values) {
+            if (stl_contains(saved, key))
+                val = saved[key];
+            else
+                added.push_back(key);
+        }
+
+        for (const string& key : added)
+            undefine(key);
+    }
+
+    return valid;
+}
+
+void broker_lua::evaluate(const string& file) {
     lua_State* lua = luaL_newstate();
     luaL_openlibs(lua);
 
@@ -167,15 +398,7 @@ broker_lua::broker_lua(const string& file): broker("lua") {
         { "pid", mwr::getpid() },
     };
 
-    const vector<pair<string, string>> strings = {
-        { "vcml_version_string", VCML_VERSION_STRING },
-        { "systemc_version_string", SC_VERSION },
-        { "username", mwr::username() },
-        { "config", mwr::filename_noext(file) },
-        { "cfgdir", mwr::dirname(file) },
-        { "simdir", mwr::progname() },
-        { "curdir", mwr::curr_dir() },
-    };
+    const vector<pair<string, string>> strings = lua_strings(file);
 
     const vector<pair<string, int (*)(lua_State*)>> funcs = {
         { "debug", do_debug },   { "info", do_info },
@@ -224,6 +447,34 @@ broker_lua::broker_lua(const string& file): broker("lua") {
     lua_close(lua);
 }
 
+broker_lua::broker_lua(const string& file): broker("lua") {
+    string path = lua_cache_path(file);
+    if (path.empty()) {
+        evaluate(file);
+        return;
+    }
+
+    u64 hash = lua_cache_hash(file);
+    if (hash && load_cache(path, hash)) {
+        lua_logger().debug("loaded %s from %s", file.c_str(), path.c_str());
+        return;
+    }
+
+    lua_record rec;
+    g_record = &rec;
+
+    try {
+        evaluate(file);
+    } catch (...) {
+        g_record = nullptr;
+        throw;
+    }
+
+    g_record = nullptr;
+    if (hash)
+        store_cache(path, hash, rec);
+}
+
 broker_lua::~broker_lua() {
     // nothing to do
 }
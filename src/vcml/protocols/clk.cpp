@@ -74,7 +74,7 @@ void clk_base_target_socket::stub(hz_t hz) {
 clk_initiator_socket::clk_initiator_socket(const char* nm, address_space as):
     clk_base_initiator_socket(nm, as),
     m_host(dynamic_cast<clk_host*>(hierarchy_top())),
-    m_hz(0),
+    m_domain(),
     m_transport(this) {
     bind(m_transport);
 }
@@ -83,12 +83,12 @@ void clk_initiator_socket::set(hz_t hz) {
     if (hz < 0)
         hz = 0;
 
-    if (hz != m_hz) {
+    if (hz != m_domain.hz()) {
         clk_payload tx;
-        tx.oldhz = m_hz;
+        tx.oldhz = m_domain.hz();
         tx.newhz = hz;
         clk_transport(tx);
-        m_hz = hz;
+        m_domain.set(hz);
     }
 }
 
@@ -118,6 +118,7 @@ void clk_target_socket::clk_transport(const clk_payload& tx) {
 clk_target_socket::clk_target_socket(const char* nm, address_space space):
     clk_base_target_socket(nm, space),
     m_host(hierarchy_search<clk_host>()),
+    m_domain(nullptr),
     m_transport(this),
     m_initiator(nullptr),
     m_targets() {
@@ -143,7 +144,21 @@ void clk_target_socket::complete_binding(clk_base_initiator_socket& socket) {
     m_targets.clear();
 }
 
+const clk_domain* clk_target_socket::domain() const {
+    if (m_domain)
+        return m_domain;
+
+    auto* iface = const_cast<clk_bw_transport_if*>(
+        get_base_port().get_interface(0));
+    if (iface != nullptr)
+        m_domain = iface->clk_get_domain();
+    return m_domain;
+}
+
 hz_t clk_target_socket::read() const {
+    if (const clk_domain* dom = domain())
+        return dom->hz();
+
     const clk_bw_transport_if* iface = get_base_port().get_interface(0);
     if (iface == nullptr)
         return 0;
@@ -152,12 +167,32 @@ hz_t clk_target_socket::read() const {
 }
 
 sc_time clk_target_socket::cycle() const {
+    if (const clk_domain* dom = domain())
+        return dom->cycle();
+
     hz_t hz = read();
     return hz ? sc_time(1.0 / hz, SC_SEC) : SC_ZERO_TIME;
 }
 
+sc_time clk_target_socket::cycles(size_t n) const {
+    if (const clk_domain* dom = domain())
+        return dom->cycles(n);
+    return cycle() * n;
+}
+
+u64 clk_target_socket::cycle_ticks() const {
+    if (const clk_domain* dom = domain())
+        return dom->cycle_ticks();
+    return cycle().value();
+}
+
+u64 clk_target_socket::generation() const {
+    const clk_domain* dom = domain();
+    return dom ? dom->generation() : 0;
+}
+
 clk_initiator_stub::clk_initiator_stub(const char* nm, hz_t hz):
-    clk_bw_transport_if(), m_hz(hz), clk_out(mkstr("%s_stub", nm).c_str()) {
+    clk_bw_transport_if(), m_domain(hz), clk_out(mkstr("%s_stub", nm).c_str()) {
     clk_out.bind(*(clk_bw_transport_if*)this);
 }
 
@@ -10,6 +10,8 @@
 
 #include "vcml/protocols/eth.h"
 
+#include <atomic>
+
 #if defined(MWR_MSVC)
 #define sscanf sscanf_s
 #endif
@@ -37,43 +39,304 @@ string mac_addr::to_string() const {
                  bytes[5]);
 }
 
-eth_frame::eth_frame(const vector<u8>& raw): vector<u8>(raw) {
-    if (size() > FRAME_MAX_SIZE)
-        VCML_ERROR("payload too big");
-    while (size() < FRAME_MIN_SIZE)
-        push_back(0);
+struct eth_buffer {
+    std::atomic<size_t> refs;
+    size_t capacity;
+    eth_buffer* next;
+
+    u8* bytes() { return (u8*)(this + 1); }
+
+    static eth_buffer* alloc(size_t size);
+    static void release(eth_buffer* buf);
+};
+
+// buffers are recycled in power-of-two size classes starting at 2KiB, which
+// is large enough for any regular frame plus headroom
+class eth_buffer_pool
+{
+private:
+    enum : size_t {
+        MIN_SHIFT = 11,
+        NUM_CLASSES = 8,
+        MAX_CACHED = 256,
+    };
+
+    mutex m_mtx;
+    eth_buffer* m_free[NUM_CLASSES];
+    size_t m_count[NUM_CLASSES];
+
+    static size_t size_class(size_t size) {
+        size_t cls = 0;
+        while (cls < NUM_CLASSES && (1ull << (MIN_SHIFT + cls)) < size)
+            cls++;
+        return cls;
+    }
+
+public:
+    eth_buffer_pool(): m_mtx(), m_free(), m_count() {}
+
+    eth_buffer* alloc(size_t size) {
+        size_t cls = size_class(size);
+        if (cls < NUM_CLASSES) {
+            lock_guard<mutex> guard(m_mtx);
+            if (eth_buffer* buf = m_free[cls]) {
+                m_free[cls] = buf->next;
+                m_count[cls]--;
+                return buf;
+            }
+
+            size = 1ull << (MIN_SHIFT + cls);
+        }
+
+        void* mem = ::operator new(sizeof(eth_buffer) + size);
+        eth_buffer* buf = new (mem) eth_buffer;
+        buf->capacity = size;
+        buf->next = nullptr;
+        return buf;
+    }
+
+    void release(eth_buffer* buf) {
+        size_t cls = size_class(buf->capacity);
+        if (cls < NUM_CLASSES) {
+            lock_guard<mutex> guard(m_mtx);
+            if (m_count[cls] < MAX_CACHED) {
+                buf->next = m_free[cls];
+                m_free[cls] = buf;
+                m_count[cls]++;
+                return;
+            }
+        }
+
+        buf->~eth_buffer();
+        ::operator delete(buf);
+    }
+
+    size_t cached() {
+        lock_guard<mutex> guard(m_mtx);
+        size_t n = 0;
+        for (size_t count : m_count)
+            n += count;
+        return n;
+    }
+
+    // never destroyed, frames may still be released during static cleanup
+    static eth_buffer_pool& instance() {
+        static eth_buffer_pool* pool = new eth_buffer_pool();
+        return *pool;
+    }
+};
+
+eth_buffer* eth_buffer::alloc(size_t size) {
+    eth_buffer* buf = eth_buffer_pool::instance().alloc(size);
+    buf->refs = 1;
+    return buf;
 }
 
-eth_frame::eth_frame(vector<u8>&& frame): vector<u8>(std::move(frame)) {
-    if (size() > FRAME_MAX_SIZE)
-        VCML_ERROR("payload too big");
-    while (size() < FRAME_MIN_SIZE)
-        push_back(0);
+void eth_buffer::release(eth_buffer* buf) {
+    if (buf && --buf->refs == 0)
+        eth_buffer_pool::instance().release(buf);
 }
 
-eth_frame::eth_frame(const u8* data, size_t len):
-    vector<u8>(data, data + len) {
-    if (size() > FRAME_MAX_SIZE)
+void eth_frame::make_writable(size_t size) {
+    if (m_buf && m_buf->refs == 1 && m_head + size <= m_buf->capacity)
+        return;
+
+    // grow geometrically so that repeated push_back stays cheap
+    size_t space = max<size_t>(size, FRAME_MAX_SIZE);
+    if (m_buf && size > m_buf->capacity - m_head)
+        space = max(space, 2 * m_size);
+
+    eth_buffer* buf = eth_buffer::alloc(FRAME_HEADROOM + space);
+    if (m_size > 0) {
+        memcpy(buf->bytes() + FRAME_HEADROOM, m_buf->bytes() + m_head,
+               min(m_size, size));
+    }
+
+    eth_buffer::release(m_buf);
+    m_buf = buf;
+    m_head = FRAME_HEADROOM;
+}
+
+mac_addr eth_frame::address(size_t offset) const {
+    VCML_ERROR_ON(offset + 6 > m_size, "packet too small");
+    const u8* p = data() + offset;
+    return mac_addr(p[0], p[1], p[2], p[3], p[4], p[5]);
+}
+
+eth_frame::eth_frame(): m_buf(nullptr), m_head(0), m_size(0) {
+    // nothing to do
+}
+
+eth_frame::eth_frame(eth_frame&& other) noexcept: eth_frame() {
+    *this = std::move(other);
+}
+
+eth_frame::eth_frame(const eth_frame& other): eth_frame() {
+    *this = other;
+}
+
+eth_frame::eth_frame(size_t length): eth_frame() {
+    resize(length);
+}
+
+eth_frame::eth_frame(const vector<u8>& raw):
+    eth_frame(raw.data(), raw.size()) {
+    // nothing to do
+}
+
+eth_frame::eth_frame(const u8* ptr, size_t len): eth_frame() {
+    if (len > FRAME_MAX_SIZE)
         VCML_ERROR("payload too big");
-    while (size() < FRAME_MIN_SIZE)
-        push_back(0);
+
+    resize(max<size_t>(len, FRAME_MIN_SIZE));
+    if (len > 0)
+        memcpy(data(), ptr, len);
 }
 
 eth_frame::eth_frame(const mac_addr& dest, const mac_addr& src,
-                     const vector<u8>& payload) {
-    insert(end(), dest.bytes.begin(), dest.bytes.end());
-    insert(end(), src.bytes.begin(), src.bytes.end());
+                     const vector<u8>& payload): eth_frame() {
+    if (FRAME_HEADER_SIZE + payload.size() > FRAME_MAX_SIZE)
+        VCML_ERROR("payload too big");
 
-    u16 len = payload.size();
-    push_back(len >> 0);
-    push_back(len >> 8);
+    size_t len = FRAME_HEADER_SIZE + payload.size();
+    resize(max<size_t>(len, FRAME_MIN_SIZE));
 
-    insert(end(), payload.begin(), payload.end());
+    u8* ptr = data();
+    memcpy(ptr + 0, dest.bytes.data(), dest.bytes.size());
+    memcpy(ptr + 6, src.bytes.data(), src.bytes.size());
 
-    if (size() > FRAME_MAX_SIZE)
-        VCML_ERROR("payload too big");
-    while (size() < FRAME_MIN_SIZE)
-        push_back(0);
+    ptr[12] = payload.size() >> 0;
+    ptr[13] = payload.size() >> 8;
+
+    if (!payload.empty())
+        memcpy(ptr + FRAME_HEADER_SIZE, payload.data(), payload.size());
+}
+
+eth_frame::~eth_frame() {
+    eth_buffer::release(m_buf);
+}
+
+eth_frame& eth_frame::operator=(const eth_frame& other) {
+    if (this == &other)
+        return *this;
+
+    if (other.m_buf)
+        other.m_buf->refs++;
+    eth_buffer::release(m_buf);
+
+    m_buf = other.m_buf;
+    m_head = other.m_head;
+    m_size = other.m_size;
+
+    csum_partial = other.csum_partial;
+    csum_valid = other.csum_valid;
+    csum_start = other.csum_start;
+    csum_offset = other.csum_offset;
+    gso_type = other.gso_type;
+    gso_size = other.gso_size;
+    return *this;
+}
+
+eth_frame& eth_frame::operator=(eth_frame&& other) noexcept {
+    if (this == &other)
+        return *this;
+
+    std::swap(m_buf, other.m_buf);
+    std::swap(m_head, other.m_head);
+    std::swap(m_size, other.m_size);
+
+    csum_partial = other.csum_partial;
+    csum_valid = other.csum_valid;
+    csum_start = other.csum_start;
+    csum_offset = other.csum_offset;
+    gso_type = other.gso_type;
+    gso_size = other.gso_size;
+
+    other.clear();
+    return *this;
+}
+
+bool eth_frame::operator==(const eth_frame& other) const {
+    if (m_size != other.m_size)
+        return false;
+    if (m_size == 0 || data() == other.data())
+        return true;
+    return memcmp(data(), other.data(), m_size) == 0;
+}
+
+bool eth_frame::shared() const {
+    return m_buf && m_buf->refs > 1;
+}
+
+const u8* eth_frame::data() const {
+    return m_buf ? m_buf->bytes() + m_head : nullptr;
+}
+
+u8* eth_frame::data() {
+    if (!m_buf)
+        return nullptr;
+    make_writable(m_size);
+    return m_buf->bytes() + m_head;
+}
+
+u8 eth_frame::at(size_t i) const {
+    VCML_ERROR_ON(i >= m_size, "frame index %zu out of bounds", i);
+    return data()[i];
+}
+
+u8& eth_frame::at(size_t i) {
+    VCML_ERROR_ON(i >= m_size, "frame index %zu out of bounds", i);
+    return data()[i];
+}
+
+void eth_frame::resize(size_t size) {
+    if (size == m_size)
+        return;
+
+    make_writable(size);
+    if (size > m_size)
+        memset(m_buf->bytes() + m_head + m_size, 0, size - m_size);
+    m_size = size;
+}
+
+void eth_frame::push_back(u8 val) {
+    make_writable(m_size + 1);
+    m_buf->bytes()[m_head + m_size++] = val;
+}
+
+void eth_frame::clear() {
+    eth_buffer::release(m_buf);
+    m_buf = nullptr;
+    m_head = 0;
+    m_size = 0;
+}
+
+u8* eth_frame::prepend(size_t n) {
+    if (!m_buf || m_buf->refs > 1 || m_head < n) {
+        size_t head = FRAME_HEADROOM + n;
+        size_t space = max<size_t>(m_size, FRAME_MAX_SIZE);
+        eth_buffer* buf = eth_buffer::alloc(head + space);
+        if (m_size > 0)
+            memcpy(buf->bytes() + head, m_buf->bytes() + m_head, m_size);
+
+        eth_buffer::release(m_buf);
+        m_buf = buf;
+        m_head = head;
+    }
+
+    m_head -= n;
+    m_size += n;
+    return m_buf->bytes() + m_head;
+}
+
+void eth_frame::pull(size_t n) {
+    n = min(n, m_size);
+    m_head += n;
+    m_size -= n;
+}
+
+size_t eth_frame::pool_size() {
+    return eth_buffer_pool::instance().cached();
 }
 
 u16 eth_frame::ether_type() const {
@@ -83,6 +346,204 @@ u16 eth_frame::ether_type() const {
     return type;
 }
 
+u32 eth_frame::flow_hash() const {
+    if (size() < FRAME_HEADER_SIZE + 4)
+        return 0;
+
+    size_t off = FRAME_HEADER_SIZE;
+    if (bswap(read<u16>(12)) == ETHER_TYPE_VLAN)
+        off += 4;
+
+    const u8* l3 = data() + off;
+    size_t l3sz = size() - off;
+    size_t addroff = 0, addrsz = 0, l4off = 0;
+    u8 proto = 0;
+
+    switch (ether_type()) {
+    case ETHER_TYPE_IPV4:
+        if (l3sz >= 20) {
+            proto = l3[9];
+            addroff = 12;
+            addrsz = 8;
+            l4off = (l3[0] & 0xf) * 4;
+        }
+        break;
+
+    case ETHER_TYPE_IPV6:
+        if (l3sz >= 40) {
+            proto = l3[6];
+            addroff = 8;
+            addrsz = 32;
+            l4off = 40;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    // non-ip traffic is steered by its source and destination address
+    if (addrsz == 0)
+        return crc32_eth(data(), 12);
+
+    u32 hash = crc32_eth(l3 + addroff, addrsz);
+    bool ports = proto == IP_TCP || proto == IP_UDP;
+    if (ports && l3sz >= l4off + 4)
+        hash ^= crc32_eth(l3 + l4off, 4);
+
+    return hash;
+}
+
+static u16 get_be16(const u8* ptr) {
+    return (u16)ptr[0] << 8 | ptr[1];
+}
+
+static u32 get_be32(const u8* ptr) {
+    return (u32)get_be16(ptr) << 16 | get_be16(ptr + 2);
+}
+
+static void put_be16(u8* ptr, u16 val) {
+    ptr[0] = val >> 8;
+    ptr[1] = val;
+}
+
+static void put_be32(u8* ptr, u32 val) {
+    put_be16(ptr, val >> 16);
+    put_be16(ptr + 2, val);
+}
+
+static u32 csum_add(u32 sum, const u8* data, size_t len) {
+    for (size_t i = 0; i + 1 < len; i += 2)
+        sum += get_be16(data + i);
+    if (len & 1)
+        sum += (u32)data[len - 1] << 8;
+    return sum;
+}
+
+static u16 csum_fold(u32 sum) {
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return ~sum;
+}
+
+u32 eth_frame::offloads() const {
+    u32 result = ETH_OFFLOAD_NONE;
+    if (csum_partial)
+        result |= ETH_OFFLOAD_CSUM;
+    if (gso_type == GSO_TCPV4)
+        result |= ETH_OFFLOAD_TSO4;
+    if (gso_type == GSO_TCPV6)
+        result |= ETH_OFFLOAD_TSO6;
+    return result;
+}
+
+bool eth_frame::complete_checksum() {
+    if (!csum_partial)
+        return true;
+
+    size_t field = csum_start + csum_offset;
+    if (csum_start >= size() || field + 2 > size())
+        return false;
+
+    // the checksum field holds the pseudo header sum set up by the sender
+    u32 sum = csum_add(0, data() + csum_start, size() - csum_start);
+    put_be16(data() + field, csum_fold(sum));
+
+    csum_partial = false;
+    csum_valid = true;
+    return true;
+}
+
+bool eth_frame::segment(vector<eth_frame>& segments) const {
+    bool v4 = gso_type == GSO_TCPV4;
+    size_t l3 = FRAME_HEADER_SIZE;
+    if (size() >= l3 + 4 && get_be16(data() + 12) == ETHER_TYPE_VLAN)
+        l3 += 4;
+
+    if (size() < l3 + (v4 ? 20 : 40))
+        return false;
+
+    const u8* ip = data() + l3;
+    size_t iphl = v4 ? (ip[0] & 0xf) * 4 : 40;
+    u8 proto = v4 ? ip[9] : ip[6];
+    if (proto != IP_TCP || size() < l3 + iphl + 20)
+        return false;
+
+    const u8* tcp = ip + iphl;
+    size_t tcphl = (tcp[12] >> 4) * 4;
+    size_t hdrlen = l3 + iphl + tcphl;
+    if (tcphl < 20 || size() < hdrlen)
+        return false;
+
+    // use the ip length to leave out any padding after the payload
+    size_t iplen = v4 ? get_be16(ip + 2) : get_be16(ip + 4) + 40;
+    if (iplen < iphl + tcphl || l3 + iplen > size())
+        return false;
+
+    size_t total = iplen - iphl - tcphl;
+    size_t mss = gso_size ? gso_size : total;
+    u32 seq = get_be32(tcp + 4);
+    u16 ipid = v4 ? get_be16(ip + 4) : 0;
+    u8 tcpflags = tcp[13];
+
+    for (size_t off = 0, i = 0; off < total || i == 0; off += mss, i++) {
+        size_t n = min(mss, total - off);
+
+        eth_frame seg(hdrlen + n);
+        memcpy(seg.data(), data(), hdrlen);
+        memcpy(seg.data() + hdrlen, data() + hdrlen + off, n);
+
+        u8* sip = seg.data() + l3;
+        u8* stcp = sip + iphl;
+
+        if (v4) {
+            put_be16(sip + 2, iphl + tcphl + n);
+            put_be16(sip + 4, ipid + i);
+            put_be16(sip + 10, 0);
+            put_be16(sip + 10, csum_fold(csum_add(0, sip, iphl)));
+        } else {
+            put_be16(sip + 4, tcphl + n);
+        }
+
+        // fin and psh only go with the last, cwr only with the first
+        u8 flags = tcpflags;
+        if (off + n < total)
+            flags &= ~0x09;
+        if (i > 0)
+            flags &= ~0x80;
+
+        put_be32(stcp + 4, seq + off);
+        stcp[13] = flags;
+
+        u32 tcplen = tcphl + n;
+        u32 sum = v4 ? csum_add(0, sip + 12, 8) : csum_add(0, sip + 8, 32);
+        sum += IP_TCP + (tcplen >> 16) + (tcplen & 0xffff);
+
+        put_be16(stcp + 16, 0);
+        put_be16(stcp + 16, csum_fold(csum_add(sum, stcp, tcplen)));
+
+        seg.csum_valid = true;
+        if (seg.size() < FRAME_MIN_SIZE)
+            seg.resize(FRAME_MIN_SIZE);
+
+        segments.push_back(std::move(seg));
+    }
+
+    return true;
+}
+
+bool eth_frame::resolve_offloads(vector<eth_frame>& frames) const {
+    if (gso_type != GSO_NONE)
+        return segment(frames);
+
+    eth_frame frame(*this);
+    if (!frame.complete_checksum())
+        return false;
+
+    frames.push_back(std::move(frame));
+    return true;
+}
+
 string eth_frame::identify() const {
     if (empty())
         return "ETHERNET_EMPTY";
@@ -387,6 +848,8 @@ eth_initiator_socket::eth_initiator_socket(const char* nm, address_space as):
     eth_base_initiator_socket(nm, as),
     m_link_up(true),
     m_host(hierarchy_search<eth_host>()),
+    m_num_frames(0),
+    m_num_bytes(0),
     m_transport(this) {
     bind(m_transport);
     VCML_ERROR_ON(!m_host, "socket %s declared outside eth_host", name());
@@ -405,15 +868,31 @@ void eth_initiator_socket::send(const vector<u8>& data) {
 
 void eth_initiator_socket::send(eth_frame& frame) {
     trace_fw(frame);
-    if (m_link_up)
+    if (m_link_up) {
+        m_num_frames++;
+        m_num_bytes += frame.size();
         get_interface(0)->eth_transport(frame);
+    }
     trace_bw(frame);
 }
 
 void eth_target_socket::eth_transport(eth_frame& frame) {
     trace_fw(frame);
-    if (m_link_up)
+    if (m_link_up) {
+        m_num_frames++;
+        m_num_bytes += frame.size();
+    }
+
+    if (m_link_up && (frame.offloads() & ~m_host->eth_rx_offloads())) {
+        // finish whatever offloads the receiver cannot handle itself
+        vector<eth_frame> frames;
+        if (!frame.resolve_offloads(frames))
+            log_warn("%s: dropping malformed offload frame", name());
+        for (const eth_frame& resolved : frames)
+            m_host->eth_receive(*this, resolved);
+    } else if (m_link_up) {
         m_host->eth_receive(*this, frame);
+    }
     trace_bw(frame);
 }
 
@@ -433,6 +912,8 @@ eth_target_socket::eth_target_socket(const char* nm, address_space as):
     eth_base_target_socket(nm, as),
     m_link_up(true),
     m_host(hierarchy_search<eth_host>()),
+    m_num_frames(0),
+    m_num_bytes(0),
     m_transport(this) {
     bind(m_transport);
     VCML_ERROR_ON(!m_host, "socket %s declared outside eth_host", name());
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/protocols/gpio.h"
+#include "vcml/core/model.h"
 
 namespace vcml {
 
@@ -119,6 +120,9 @@ gpio_initiator_socket::gpio_initiator_socket(const char* nm, address_space as):
     m_host(dynamic_cast<gpio_host*>(hierarchy_top())),
     m_event(nullptr),
     m_state(),
+    m_default(nullptr),
+    m_changed(),
+    m_changing(false),
     m_transport(this) {
     bind(m_transport);
 }
@@ -138,13 +142,53 @@ const sc_event& gpio_initiator_socket::default_event() {
 }
 
 bool gpio_initiator_socket::read(gpio_vector vector) const {
-    return m_state.count(vector) ? m_state.at(vector) : false;
+    if (vector == GPIO_NO_VECTOR && m_default)
+        return m_default->state;
+
+    auto it = m_state.find(vector);
+    return it != m_state.end() && it->second.state;
 }
 
 void gpio_initiator_socket::write(bool state, gpio_vector vector) {
     (*this)[vector] = state;
 }
 
+void gpio_initiator_socket::write(const vector<gpio_payload>& states) {
+    write(states.data(), states.size());
+}
+
+void gpio_initiator_socket::write(const gpio_payload* states, size_t count) {
+    vector<gpio_payload> nested;
+    vector<gpio_payload>& changed = m_changing ? nested : m_changed;
+    changed.clear();
+
+    for (size_t i = 0; i < count; i++) {
+        gpio_state_tracker& tracker = (*this)[states[i].vector];
+        if (tracker.state != states[i].state) {
+            tracker.state = states[i].state;
+            changed.push_back(tracker);
+        }
+    }
+
+    if (changed.empty())
+        return;
+
+    bool outer = !m_changing;
+    m_changing = true;
+
+    for (gpio_payload& tx : changed)
+        trace_fw(tx);
+    for (int i = 0; i < size(); i++)
+        get_interface(i)->gpio_transport_bulk(changed.data(), changed.size());
+    if (m_event)
+        m_event->notify(SC_ZERO_TIME);
+    for (gpio_payload& tx : changed)
+        trace_bw(tx);
+
+    if (outer)
+        m_changing = false;
+}
+
 void gpio_initiator_socket::raise(gpio_vector vector) {
     write(true, vector);
 }
@@ -154,8 +198,10 @@ void gpio_initiator_socket::lower(gpio_vector vector) {
 }
 
 void gpio_initiator_socket::pulse(gpio_vector vector) {
-    write(!read(vector), vector);
-    write(!read(vector), vector);
+    // both edges reach every target in a single sweep
+    bool state = read(vector);
+    const gpio_payload edges[] = { { vector, !state }, { vector, state } };
+    write(edges, 2);
 }
 
 gpio_initiator_socket& gpio_initiator_socket::operator=(bool set) {
@@ -180,15 +226,23 @@ gpio_initiator_socket& gpio_initiator_socket::operator^=(bool set) {
 
 gpio_initiator_socket::gpio_state_tracker& gpio_initiator_socket::operator[](
     gpio_vector vector) {
-    if (m_state.count(vector))
-        return m_state[vector];
+    if (vector == GPIO_NO_VECTOR && m_default)
+        return *m_default;
+
+    auto it = m_state.find(vector);
+    if (it == m_state.end()) {
+        gpio_state_tracker state;
+        state.parent = this;
+        state.state = false;
+        state.vector = vector;
+        it = m_state.emplace(vector, state).first;
+    }
 
-    gpio_state_tracker state;
-    state.parent = this;
-    state.state = false;
-    state.vector = vector;
+    // map nodes stay put on rehash, so the default line can be cached
+    if (vector == GPIO_NO_VECTOR)
+        m_default = &it->second;
 
-    return m_state[vector] = state;
+    return it->second;
 }
 
 void gpio_initiator_socket::gpio_transport(gpio_payload& tx) {
@@ -205,6 +259,7 @@ gpio_target_socket::gpio_target_socket(const char* nm, address_space space):
     m_host(hierarchy_search<gpio_host>()),
     m_event(nullptr),
     m_state(),
+    m_default(nullptr),
     m_initiator(nullptr),
     m_targets(),
     m_transport(this) {
@@ -243,7 +298,11 @@ void gpio_target_socket::complete_binding(gpio_base_initiator_socket& socket) {
 }
 
 bool gpio_target_socket::read(gpio_vector vector) const {
-    return m_state.count(vector) ? m_state.at(vector) : false;
+    if (vector == GPIO_NO_VECTOR && m_default)
+        return *m_default;
+
+    auto it = m_state.find(vector);
+    return it != m_state.end() && it->second;
 }
 
 bool gpio_target_socket::operator==(const gpio_target_socket& other) const {
@@ -254,10 +313,28 @@ bool gpio_target_socket::operator!=(const gpio_target_socket& other) const {
     return !(operator==(other));
 }
 
+bool gpio_target_socket::update_state(const gpio_payload& tx) {
+    // plain interrupt lines skip the map lookup once they have been seen
+    if (tx.vector == GPIO_NO_VECTOR && m_default) {
+        if (*m_default == tx.state)
+            return false;
+        *m_default = tx.state;
+        return true;
+    }
+
+    auto [it, inserted] = m_state.try_emplace(tx.vector, tx.state);
+    if (tx.vector == GPIO_NO_VECTOR)
+        m_default = &it->second;
+    if (!inserted && it->second == tx.state)
+        return false;
+
+    it->second = tx.state;
+    return true;
+}
+
 void gpio_target_socket::gpio_transport_internal(gpio_payload& tx) {
     trace_fw(tx);
-    if (m_state.count(tx.vector) == 0 || m_state[tx.vector] != tx.state) {
-        m_state[tx.vector] = tx.state;
+    if (update_state(tx)) {
         gpio_transport(tx);
         if (m_event)
             m_event->notify(SC_ZERO_TIME);
@@ -265,6 +342,22 @@ void gpio_target_socket::gpio_transport_internal(gpio_payload& tx) {
     trace_bw(tx);
 }
 
+void gpio_target_socket::gpio_transport_bulk_internal(gpio_payload* tx,
+                                                      size_t count) {
+    bool changed = false;
+    for (size_t i = 0; i < count; i++) {
+        trace_fw(tx[i]);
+        if (update_state(tx[i])) {
+            gpio_transport(tx[i]);
+            changed = true;
+        }
+        trace_bw(tx[i]);
+    }
+
+    if (changed && m_event)
+        m_event->notify(SC_ZERO_TIME);
+}
+
 void gpio_target_socket::gpio_transport(gpio_payload& tx) {
     m_host->gpio_transport(*this, tx);
 }
@@ -378,6 +471,9 @@ gpio_base_target_socket& gpio_target(const sc_object& parent,
 }
 
 void gpio_stub(const sc_object& obj, const string& port) {
+    if (is_placeholder(obj))
+        return;
+
     sc_object* child = find_child(obj, port);
     VCML_ERROR_ON(!child, "%s.%s does not exist", obj.name(), port.c_str());
 
@@ -394,6 +490,9 @@ void gpio_stub(const sc_object& obj, const string& port) {
 }
 
 void gpio_stub(const sc_object& obj, const string& port, size_t idx) {
+    if (is_placeholder(obj))
+        return;
+
     sc_object* child = find_child(obj, port);
     VCML_ERROR_ON(!child, "%s.%s does not exist", obj.name(), port.c_str());
 
@@ -414,6 +513,12 @@ void gpio_stub(const sc_object& obj, const string& port, size_t idx) {
 
 void gpio_bind(const sc_object& obj1, const string& port1,
                const sc_object& obj2, const string& port2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        gpio_stub(obj1, port1);
+        gpio_stub(obj2, port2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
@@ -440,6 +545,12 @@ void gpio_bind(const sc_object& obj1, const string& port1,
 
 void gpio_bind(const sc_object& obj1, const string& port1,
                const sc_object& obj2, const string& port2, size_t idx2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        gpio_stub(obj1, port1);
+        gpio_stub(obj2, port2, idx2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
@@ -466,6 +577,12 @@ void gpio_bind(const sc_object& obj1, const string& port1,
 
 void gpio_bind(const sc_object& obj1, const string& port1, size_t idx1,
                const sc_object& obj2, const string& port2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        gpio_stub(obj1, port1, idx1);
+        gpio_stub(obj2, port2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
@@ -492,6 +609,12 @@ void gpio_bind(const sc_object& obj1, const string& port1, size_t idx1,
 
 void gpio_bind(const sc_object& obj1, const string& port1, size_t idx1,
                const sc_object& obj2, const string& port2, size_t idx2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        gpio_stub(obj1, port1, idx1);
+        gpio_stub(obj2, port2, idx2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
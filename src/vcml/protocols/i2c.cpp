@@ -51,6 +51,24 @@ ostream& operator<<(ostream& os, const i2c_payload& tx) {
     return os << "(" << tx.resp << ")";
 }
 
+void i2c_host::i2c_transport(const i2c_target_socket& socket,
+                             i2c_message& msg) {
+    msg.resp = i2c_start(socket, msg.cmd);
+    for (size_t i = 0; success(msg.resp) && i < msg.size; i++) {
+        i2c_response ack = msg.cmd == TLM_READ_COMMAND
+                               ? i2c_read(socket, msg.data[i])
+                               : i2c_write(socket, msg.data[i]);
+        if (ack == I2C_INCOMPLETE)
+            ack = I2C_NACK;
+        if (msg.acks)
+            msg.acks[i] = ack;
+        if (failed(ack))
+            break;
+    }
+
+    i2c_stop(socket);
+}
+
 i2c_base_initiator_socket::i2c_base_initiator_socket(const char* nm,
                                                      address_space space):
     i2c_base_initiator_socket_b(nm, space), m_stub(nullptr) {
@@ -143,6 +161,66 @@ void i2c_initiator_socket::transport(i2c_payload& tx) {
     trace_bw(tx);
 }
 
+i2c_response i2c_initiator_socket::transport(u8 address, tlm_command cmd,
+                                             u8* data, size_t size,
+                                             i2c_response* acks) {
+    vector<i2c_response> local;
+    if (acks == nullptr) {
+        local.resize(size);
+        acks = local.data();
+    }
+
+    i2c_message msg;
+    msg.address = address;
+    msg.cmd = cmd;
+    msg.data = data;
+    msg.size = size;
+    msg.acks = acks;
+    msg.resp = I2C_INCOMPLETE;
+    transport(msg);
+
+    for (size_t i = 0; success(msg.resp) && i < size; i++) {
+        if (!success(acks[i]))
+            return I2C_NACK;
+    }
+
+    return msg.resp;
+}
+
+void i2c_initiator_socket::transport(i2c_message& msg) {
+    VCML_ERROR_ON(msg.address > 127, "invalid i2c address: %hhu",
+                  msg.address);
+    VCML_ERROR_ON(msg.cmd != TLM_READ_COMMAND && msg.cmd != TLM_WRITE_COMMAND,
+                  "invalid i2c message command: %d", msg.cmd);
+
+    if (msg.acks) {
+        for (size_t i = 0; i < msg.size; i++)
+            msg.acks[i] = I2C_INCOMPLETE;
+    }
+
+    // tracers only know single bytes, so split messages while tracing
+    if (tracer::any()) {
+        msg.resp = start(msg.address, msg.cmd);
+        for (size_t i = 0; success(msg.resp) && i < msg.size; i++) {
+            i2c_response ack = transport(msg.data[i]);
+            if (msg.acks)
+                msg.acks[i] = ack;
+            if (failed(ack))
+                break;
+        }
+
+        stop();
+        return;
+    }
+
+    msg.resp = I2C_INCOMPLETE;
+    for (int i = 0; i < size(); i++)
+        get_interface(i)->i2c_transport(msg);
+
+    if (msg.resp == I2C_INCOMPLETE)
+        msg.resp = I2C_NACK;
+}
+
 void i2c_target_socket::i2c_transport(i2c_payload& tx) {
     switch (tx.cmd) {
     case I2C_START: {
@@ -186,6 +264,14 @@ void i2c_target_socket::i2c_transport(i2c_payload& tx) {
     }
 }
 
+void i2c_target_socket::i2c_transport(i2c_message& msg) {
+    m_state = TLM_IGNORE_COMMAND;
+    if (msg.address != m_address && msg.address != I2C_ADDR_BCAST)
+        return;
+
+    m_host->i2c_transport(*this, msg);
+}
+
 void i2c_target_socket::set_address(u8 address) {
     if (address == I2C_ADDR_BCAST || address > 127)
         VCML_ERROR("invalid i2c socket address: %hhu", address);
@@ -212,6 +298,10 @@ void i2c_target_stub::i2c_transport(i2c_payload& tx) {
     // nothing to do
 }
 
+void i2c_target_stub::i2c_transport(i2c_message& msg) {
+    // nothing to do
+}
+
 i2c_target_stub::i2c_target_stub(const char* nm):
     i2c_fw_transport_if(),
     i2c_in(mkstr("%s_stub", nm).c_str(), VCML_AS_DEFAULT) {
@@ -167,6 +167,11 @@ ostream& operator<<(ostream& os, const pci_payload& tx) {
     return os;
 }
 
+bool pci_initiator::pci_msi(const pci_initiator_socket& socket, u64 addr,
+                            u32 data) {
+    return pci_dma_write(socket, addr, sizeof(data), &data);
+}
+
 void pci_target::pci_bar_map(const pci_bar& bar) {
     for (auto& socket : m_sockets)
         (*socket)->pci_bar_map(bar);
@@ -204,6 +209,13 @@ void pci_target::pci_interrupt(pci_irq irq, bool state) {
         (*socket)->pci_interrupt(irq, state);
 }
 
+bool pci_target::pci_msi(u64 addr, u32 data) {
+    bool result = false;
+    for (auto& socket : m_sockets)
+        result |= (*socket)->pci_msi(addr, data);
+    return result;
+}
+
 pci_base_initiator_socket::pci_base_initiator_socket(const char* nm,
                                                      address_space as):
     pci_base_initiator_socket_b(nm, as), m_stub(nullptr) {
@@ -29,7 +29,7 @@ u8 sd_crc7(const sd_command& cmd) {
         (u8)(cmd.argument >> 16), (u8)(cmd.argument >> 8),
         (u8)(cmd.argument),
     };
-    return crc7(buffer, sizeof(buffer)) | 1;
+    return crc7_sd(buffer, sizeof(buffer)) | 1;
 }
 
 void sd_init_read(sd_data& cmd) {
@@ -52,11 +52,36 @@ ostream& operator<<(ostream& os, serial_stop stop) {
 
 ostream& operator<<(ostream& os, const serial_payload& tx) {
     stream_guard guard(os);
-    os << "SERIAL TX" << mkstr(" [%02x] ", tx.data & tx.mask) << "("
-       << std::dec << tx.baud << tx.parity << tx.width << ")";
+    os << "SERIAL TX";
+    if (tx.is_bulk())
+        os << mkstr(" [%zu bytes] ", tx.count);
+    else
+        os << mkstr(" [%02x] ", tx.data & tx.mask);
+    os << "(" << std::dec << tx.baud << tx.parity << tx.width << ")";
     return os;
 }
 
+sc_time serial_symbol_time(const serial_payload& tx) {
+    double bits = 1.0 + tx.width;
+    if (tx.parity != SERIAL_PARITY_NONE)
+        bits += 1.0;
+
+    switch (tx.stop) {
+    case SERIAL_STOP_2:
+        bits += 2.0;
+        break;
+    case SERIAL_STOP_1_5:
+        bits += 1.5;
+        break;
+    case SERIAL_STOP_1:
+    default:
+        bits += 1.0;
+        break;
+    }
+
+    return sc_time(bits / max<baud_t>(tx.baud, 1), SC_SEC);
+}
+
 bool serial_calc_parity(u8 data, serial_parity mode) {
     switch (mode) {
     case SERIAL_PARITY_ODD:
@@ -74,6 +99,9 @@ bool serial_calc_parity(u8 data, serial_parity mode) {
 }
 
 bool serial_test_parity(const serial_payload& tx) {
+    if (tx.is_bulk())
+        return true;
+
     bool parity = (tx.data >> tx.width) & 1;
     switch (tx.parity) {
     case SERIAL_PARITY_NONE:
@@ -93,7 +121,13 @@ bool serial_test_parity(const serial_payload& tx) {
 
 void serial_host::serial_receive(const serial_target_socket& socket,
                                  serial_payload& tx) {
-    serial_receive(socket, tx.data & tx.mask);
+    if (!tx.is_bulk()) {
+        serial_receive(socket, tx.data & tx.mask);
+        return;
+    }
+
+    for (size_t i = 0; i < tx.count; i++)
+        serial_receive(socket, tx.buffer[i] & tx.mask);
 }
 
 void serial_host::serial_receive(const serial_target_socket& socket, u8 data) {
@@ -188,6 +222,20 @@ void serial_initiator_socket::send(u8 data) {
     transport(tx);
 }
 
+void serial_initiator_socket::send(const u8* data, size_t size) {
+    serial_payload tx;
+    tx.data = 0;
+    tx.mask = serial_mask(m_width);
+    tx.baud = m_baud;
+    tx.width = m_width;
+    tx.parity = m_parity;
+    tx.stop = m_stop;
+    tx.buffer = data;
+    tx.count = size;
+
+    transport(tx);
+}
+
 void serial_initiator_socket::transport(serial_payload& tx) {
     trace_fw(tx);
     get_interface(0)->serial_transport(tx);
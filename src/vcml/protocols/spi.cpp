@@ -17,6 +17,16 @@ ostream& operator<<(ostream& os, const spi_payload& spi) {
     return os;
 }
 
+void spi_host::spi_transport(const spi_target_socket& socket,
+                             spi_burst& burst) {
+    for (size_t i = 0; i < burst.size; i++) {
+        spi_payload spi(burst.mosi[i]);
+            spi.miso = burst.miso[i];
+        spi_transport(socket, spi);
+        burst.miso[i] = spi.miso;
+    }
+}
+
 spi_base_initiator_socket::spi_base_initiator_socket(const char* nm,
                                                      address_space a):
     spi_base_initiator_socket_b(nm, a), m_stub(nullptr) {
@@ -66,12 +76,38 @@ void spi_initiator_socket::transport(spi_payload& spi) {
     trace_bw(spi);
 }
 
+void spi_initiator_socket::transport(spi_burst& burst) {
+    // tracers only know single bytes, so split bursts while tracing
+    if (tracer::any()) {
+        for (size_t i = 0; i < burst.size; i++) {
+            spi_payload spi(burst.mosi[i]);
+            spi.miso = burst.miso[i];
+            transport(spi);
+            burst.miso[i] = spi.miso;
+        }
+
+        return;
+    }
+
+    for (int i = 0; i < size(); i++)
+        get_interface(i)->spi_transport(burst);
+}
+
+void spi_initiator_socket::transport(const u8* mosi, u8* miso, size_t size) {
+    spi_burst burst{ mosi, miso, size };
+    transport(burst);
+}
+
 void spi_target_socket::spi_transport(spi_payload& spi) {
     trace_fw(spi);
     m_host->spi_transport(*this, spi);
     trace_bw(spi);
 }
 
+void spi_target_socket::spi_transport(spi_burst& burst) {
+    m_host->spi_transport(*this, burst);
+}
+
 spi_target_socket::spi_target_socket(const char* nm, address_space as):
     spi_base_target_socket(nm, as),
     m_host(hierarchy_search<spi_host>()),
@@ -89,6 +125,10 @@ void spi_target_stub::spi_transport(spi_payload& spi) {
     // nothing to do
 }
 
+void spi_target_stub::spi_transport(spi_burst& burst) {
+    // nothing to do
+}
+
 spi_target_stub::spi_target_stub(const char* nm):
     spi_fw_transport_if(), spi_in(mkstr("%s_stub", nm).c_str()) {
     spi_in.bind(*this);
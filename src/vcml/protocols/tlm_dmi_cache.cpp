@@ -44,12 +44,20 @@ static tlm_dmi dmi_merge(const tlm_dmi& a, const tlm_dmi& b) {
     return result;
 }
 
-tlm_dmi_cache::tlm_dmi_cache(): m_limit(16), m_entries() {
+tlm_dmi_cache::tlm_dmi_cache():
+    m_mtx(),
+    m_limit(16),
+    m_entries(),
+    m_snapshot(new snapshot()),
+    m_readers(0),
+    m_retired() {
     // nothing to do
 }
 
 tlm_dmi_cache::~tlm_dmi_cache() {
-    // nothing to do
+    for (const snapshot* snap : m_retired)
+        delete snap;
+    delete m_snapshot.load();
 }
 
 void tlm_dmi_cache::insert_locked(const tlm_dmi& dmi) {
@@ -74,9 +82,51 @@ void tlm_dmi_cache::insert_locked(const tlm_dmi& dmi) {
         m_entries.resize(m_limit);
 }
 
+void tlm_dmi_cache::publish_locked() {
+    snapshot* snap = new snapshot();
+    snap->entries = m_entries;
+    std::sort(snap->entries.begin(), snap->entries.end(),
+              [](const tlm_dmi& a, const tlm_dmi& b) -> bool {
+                  return a.get_start_address() < b.get_start_address();
+              });
+
+    // maxend[i] holds the highest end address of entries 0..i, which allows
+    // lookups to stop scanning once no earlier entry can cover the request
+    u64 maxend = 0;
+    snap->maxend.reserve(snap->entries.size());
+    for (const tlm_dmi& dmi : snap->entries) {
+        maxend = max<u64>(maxend, dmi.get_end_address());
+        snap->maxend.push_back(maxend);
+    }
+
+    m_retired.push_back(m_snapshot.exchange(snap));
+
+    // once no reader is active, nobody can hold a retired snapshot anymore
+    if (m_readers.load() == 0) {
+        for (const snapshot* old : m_retired)
+            delete old;
+        m_retired.clear();
+    }
+}
+
+void tlm_dmi_cache::set_entry_limit(size_t lim) {
+    lock_guard<mutex> guard(m_mtx);
+    m_limit = lim;
+    if (m_entries.size() > m_limit) {
+        m_entries.resize(m_limit);
+        publish_locked();
+    }
+}
+
+vector<tlm_dmi> tlm_dmi_cache::get_entries() {
+    lock_guard<mutex> guard(m_mtx);
+    return m_entries;
+}
+
 void tlm_dmi_cache::insert(const tlm_dmi& dmi) {
     lock_guard<mutex> guard(m_mtx);
     insert_locked(dmi);
+    publish_locked();
 }
 
 bool tlm_dmi_cache::invalidate(u64 start, u64 end) {
@@ -113,20 +163,39 @@ bool tlm_dmi_cache::invalidate(const range& r) {
         }
     }
 
+    if (invalidations > 0)
+        publish_locked();
+
     return invalidations > 0;
 }
 
-bool tlm_dmi_cache::lookup(const range& r, vcml_access rwx, tlm_dmi& out) {
-    lock_guard<mutex> guard(m_mtx);
-    for (unsigned int i = 0; i < m_entries.size(); i++) {
-        if (r.inside(m_entries[i]) && dmi_check_access(m_entries[i], rwx)) {
-            std::swap(m_entries[i], m_entries[0]);
-            out = m_entries[0];
-            return true;
+bool tlm_dmi_cache::lookup(const range& r, vcml_access rwx,
+                           tlm_dmi& out) const {
+    m_readers++;
+    const snapshot* snap = m_snapshot.load();
+    const vector<tlm_dmi>& entries = snap->entries;
+
+    // find the last entry starting at or below r.start and walk downwards
+    auto it = std::upper_bound(entries.begin(), entries.end(), r.start,
+                               [](u64 addr, const tlm_dmi& dmi) -> bool {
+                                   return addr < dmi.get_start_address();
+                               });
+
+    bool found = false;
+    for (size_t i = it - entries.begin(); i > 0; i--) {
+        if (snap->maxend[i - 1] < r.end)
+            break;
+
+        const tlm_dmi& dmi = entries[i - 1];
+        if (r.inside(dmi) && dmi_check_access(dmi, rwx)) {
+            out = dmi;
+            found = true;
+            break;
         }
     }
 
-    return false;
+    m_readers--;
+    return found;
 }
 
 } // namespace vcml
@@ -12,41 +12,117 @@
 
 namespace vcml {
 
+struct exmon_region {
+    const u8* ptr;
+    size_t size;
+    u64 addr;
+    tlm_exmon* mon;
+};
+
+static vector<exmon_region>& exmon_regions() {
+    static vector<exmon_region> regions;
+    return regions;
+}
+
+static void drop_regions(tlm_exmon* mon) {
+    stl_remove_if(exmon_regions(),
+                  [mon](const exmon_region& r) { return r.mon == mon; });
+}
+
+tlm_exmon::tlm_exmon():
+    m_slots(), m_active(0), m_bounds(), m_excl_dmi(true) {
+    // nothing to do
+}
+
+tlm_exmon::~tlm_exmon() {
+    drop_regions(this);
+}
+
+void tlm_exmon::allow_excl_dmi(bool allow) {
+    m_excl_dmi = allow;
+    if (!allow)
+        drop_regions(this);
+}
+
+const vector<exlock> tlm_exmon::get_locks() const {
+    vector<exlock> locks;
+    locks.reserve(m_active);
+    for (const exlock& lock : m_slots)
+        if (lock.cpu >= 0)
+            locks.push_back(lock);
+    return locks;
+}
+
 bool tlm_exmon::has_lock(int cpu, const range& r) const {
-    for (auto lock : m_locks)
-        if (lock.cpu == cpu && lock.addr.includes(r))
-            return true;
-    return false;
+    assert(cpu >= 0);
+    if ((size_t)cpu >= m_slots.size())
+        return false;
+
+    const exlock& lock = m_slots[cpu];
+    return lock.cpu >= 0 && lock.addr.includes(r);
 }
 
-bool tlm_exmon::add_lock(int cpu, const range& r) {
+bool tlm_exmon::add_lock(int cpu, const range& r, bool dmi) {
     assert(cpu >= 0);
-    break_locks(cpu);
-    m_locks.push_back({ cpu, r });
+    if ((size_t)cpu >= m_slots.size())
+        m_slots.resize(cpu + 1, { -1, range(), false });
+
+    exlock& lock = m_slots[cpu];
+    if (lock.cpu < 0)
+        m_active++;
+
+    lock.cpu = cpu;
+    lock.addr = r;
+    lock.dmi = dmi;
+
+    if (m_active == 1) {
+        m_bounds = r;
+    } else {
+        m_bounds.start = min(m_bounds.start, r.start);
+        m_bounds.end = max(m_bounds.end, r.end);
+    }
+
     return true;
 }
 
 void tlm_exmon::break_locks(int cpu) {
     assert(cpu >= 0);
-    m_locks.erase(std::remove_if(m_locks.begin(), m_locks.end(),
-                                 [cpu](const exlock& lock) -> bool {
-                                     return lock.cpu == cpu;
-                                 }),
-                  m_locks.end());
+    if ((size_t)cpu >= m_slots.size() || m_slots[cpu].cpu < 0)
+        return;
+
+    m_slots[cpu].cpu = -1;
+    m_active--;
 }
 
 void tlm_exmon::break_locks(const range& r) {
-    m_locks.erase(std::remove_if(m_locks.begin(), m_locks.end(),
-                                 [r](const exlock& lock) -> bool {
-                                     return lock.addr.overlaps(r);
-                                 }),
-                  m_locks.end());
+    if (!may_overlap(r))
+        return;
+
+    // shrink the filter to the remaining locks while scanning
+    bool first = true;
+    for (exlock& lock : m_slots) {
+        if (lock.cpu < 0)
+            continue;
+
+        if (lock.addr.overlaps(r)) {
+            lock.cpu = -1;
+            m_active--;
+        } else if (first) {
+            m_bounds = lock.addr;
+            first = false;
+        } else {
+            m_bounds.start = min(m_bounds.start, lock.addr.start);
+            m_bounds.end = max(m_bounds.end, lock.addr.end);
+        }
+    }
 }
 
 bool tlm_exmon::update(tlm_generic_payload& tx) {
-    for (auto lock : m_locks)
-        if (lock.addr.overlaps(tx))
-            tx.set_dmi_allowed(false);
+    if (may_overlap(tx)) {
+        for (const exlock& lock : m_slots)
+            if (lock.cpu >= 0 && !lock.dmi && lock.addr.overlaps(tx))
+                tx.set_dmi_allowed(false);
+    }
 
     bool proceed = true;
     sbiext* ex = tx.get_extension<sbiext>();
@@ -65,8 +141,13 @@ bool tlm_exmon::update(tlm_generic_payload& tx) {
 }
 
 bool tlm_exmon::override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi) {
-    for (auto lock : m_locks) {
-        if (lock.addr.includes(tx.get_address())) {
+    if (!has_locks())
+        return true;
+
+    // locks taken via dmi are checked by their owners using the dmi pointer
+    for (const exlock& lock : m_slots) {
+        if (lock.cpu >= 0 && !lock.dmi &&
+            lock.addr.includes(tx.get_address())) {
             dmi.set_start_address(0);
             dmi.set_end_address((sc_dt::uint64)-1);
             dmi.allow_read_write();
@@ -74,7 +155,9 @@ bool tlm_exmon::override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi) {
         }
     }
 
-    for (auto lock : m_locks) {
+    for (const exlock& lock : m_slots) {
+        if (lock.cpu < 0 || lock.dmi)
+            continue;
         if (lock.addr.end < tx.get_address() &&
             dmi.get_start_address() <= lock.addr.end) {
             dmi_set_start_address(dmi, lock.addr.end + 1);
@@ -88,4 +171,29 @@ bool tlm_exmon::override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi) {
     return true;
 }
 
+void tlm_exmon::register_dmi(const tlm_dmi& dmi) {
+    const u8* ptr = dmi.get_dmi_ptr();
+    u64 addr = dmi.get_start_address();
+    size_t size = dmi.get_end_address() - addr + 1;
+    if (!m_excl_dmi || ptr == nullptr || size == 0)
+        return;
+
+    u64 base;
+    if (lookup_dmi(ptr, size, base) == this && base == addr)
+        return;
+
+    exmon_regions().push_back({ ptr, size, addr, this });
+}
+
+tlm_exmon* tlm_exmon::lookup_dmi(const u8* ptr, size_t size, u64& addr) {
+    for (const exmon_region& r : exmon_regions()) {
+        if (ptr >= r.ptr && ptr + size <= r.ptr + r.size) {
+            addr = r.addr + (ptr - r.ptr);
+            return r.mon;
+        }
+    }
+
+    return nullptr;
+}
+
 } // namespace vcml
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "vcml/protocols/tlm_heatmap.h"
+
+namespace vcml {
+
+tlm_heatmap::tlm_heatmap(u64 page_size):
+    m_page_size(page_size), m_samples(0), m_pages() {
+    VCML_ERROR_ON(!is_pow2(page_size), "invalid heatmap page size");
+}
+
+void tlm_heatmap::record(const tlm_generic_payload& tx, const tlm_sbi& info) {
+    if (info.is_debug || !tx.is_response_ok())
+        return;
+
+    u64 addr = tx.get_address();
+    u64 size = max<u64>(tx_size(tx), 1);
+    for (u64 page = page_of(addr); page < addr + size; page += m_page_size) {
+        counters& cnt = m_pages[page];
+        if (tx.is_write())
+            cnt.writes++;
+        else if (info.is_insn)
+            cnt.fetches++;
+        else
+            cnt.reads++;
+    }
+}
+
+void tlm_heatmap::reset() {
+    m_samples = 0;
+    m_pages.clear();
+}
+
+vector<pair<u64, tlm_heatmap::counters>> tlm_heatmap::hottest(
+    size_t limit) const {
+    vector<pair<u64, counters>> pages(m_pages.begin(), m_pages.end());
+    std::sort(pages.begin(), pages.end(),
+              [](const pair<u64, counters>& a, const pair<u64, counters>& b) {
+                  if (a.second.total() != b.second.total())
+                      return a.second.total() > b.second.total();
+                  return a.first < b.first;
+              });
+
+    if (pages.size() > limit)
+        pages.resize(limit);
+    return pages;
+}
+
+void tlm_heatmap::dump(ostream& os) const {
+    vector<pair<u64, counters>> pages(m_pages.begin(), m_pages.end());
+    std::sort(pages.begin(), pages.end(),
+              [](const pair<u64, counters>& a, const pair<u64, counters>& b) {
+                  return a.first < b.first;
+              });
+
+    os << "page,reads,writes,fetches" << std::endl;
+    for (const auto& page : pages) {
+        os << mkstr("0x%016llx,%llu,%llu,%llu", page.first,
+                    page.second.reads, page.second.writes,
+                    page.second.fetches)
+           << std::endl;
+    }
+}
+
+void tlm_heatmap::save(const string& path) const {
+    ofstream os(path.c_str(), std::ios::trunc);
+    VCML_REPORT_ON(!os.good(), "cannot write heatmap to %s", path.c_str());
+    dump(os);
+}
+
+} // namespace vcml
@@ -13,13 +13,12 @@
 
 namespace vcml {
 
-unsigned int tlm_host::do_transport(tlm_target_socket& socket,
+unsigned int tlm_host::do_transport(proc_data& data,
+                                    tlm_target_socket& socket,
                                     tlm_generic_payload& tx,
                                     const tlm_sbi& info) {
-    sc_process_b* proc = current_process();
-
-    m_processes[proc].tx = &tx;
-    m_processes[proc].sbi = &info;
+    data.tx = &tx;
+    data.sbi = &info;
 
     if (tx.get_response_status() != TLM_INCOMPLETE_RESPONSE)
         VCML_ERROR("invalid in-bound transaction response status");
@@ -29,8 +28,8 @@ unsigned int tlm_host::do_transport(tlm_target_socket& socket,
     if (tx.get_response_status() == TLM_INCOMPLETE_RESPONSE)
         VCML_ERROR("invalid out-bound transaction response status");
 
-    m_processes[proc].tx = nullptr;
-    m_processes[proc].sbi = nullptr;
+    data.tx = nullptr;
+    data.sbi = nullptr;
 
     return n;
 }
@@ -87,9 +86,7 @@ tlm_host::tlm_host(bool allow_dmi, unsigned int bus_width):
 }
 
 sc_time& tlm_host::local_time(sc_process_b* proc) {
-    if (!stl_contains(m_processes, proc))
-        m_processes[proc].time = SC_ZERO_TIME;
-
+    // new entries start out with zero local time
     sc_time& local = m_processes[proc].time;
     update_local_time(local, proc);
     return local;
@@ -156,15 +153,17 @@ void tlm_host::b_transport(tlm_target_socket& socket, tlm_generic_payload& tx,
                            sc_time& dt) {
     sc_process_b* proc = current_thread();
     VCML_ERROR_ON(!proc, "b_transport outside SC_THREAD");
-    m_processes[proc].time = dt;
-    do_transport(socket, tx, socket.current_sideband());
-    dt = m_processes[proc].time;
+    proc_data& data = m_processes[proc]; // stays valid across rehashing
+    data.time = dt;
+    do_transport(data, socket, tx, socket.current_sideband());
+    dt = data.time;
 }
 
 unsigned int tlm_host::transport_dbg(tlm_target_socket& socket,
                                      tlm_generic_payload& tx) {
     sc_time t1(sc_time_stamp());
-    unsigned int n = do_transport(socket, tx, socket.current_sideband());
+    proc_data& data = m_processes[current_process()];
+    unsigned int n = do_transport(data, socket, tx, socket.current_sideband());
     sc_time t2(sc_time_stamp());
 
     if (thctl_is_sysc_thread() && t1 != t2)
@@ -0,0 +1,172 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/protocols/tlm_memory.h"
+
+namespace vcml {
+
+// turns every non-zero byte into 0xff and every zero byte into 0x00
+static inline u64 expand_enables(u64 val) {
+    const u64 lo7 = 0x7f7f7f7f7f7f7f7full;
+    u64 msb = (((val & lo7) + lo7) | val) & ~lo7;
+    return (msb >> 7) * 0xff;
+}
+
+static inline u64 load_enables(const u8* be, size_t belen, size_t idx) {
+    u8 buf[8];
+    if (idx + sizeof(buf) <= belen) {
+        memcpy(buf, be + idx, sizeof(buf));
+    } else {
+        for (size_t i = 0; i < sizeof(buf); i++)
+            buf[i] = be[(idx + i) % belen];
+    }
+
+    u64 val;
+    memcpy(&val, buf, sizeof(val));
+    return val;
+}
+
+// copies only bytes whose byte enable is set, eight at a time; beidx is the
+// byte enable index of the first byte and is advanced past the last one
+static void masked_copy(u8* dest, const u8* src, size_t n, const u8* be,
+                        size_t belen, size_t& beidx) {
+    // short patterns repeat within every word, so their mask is constant
+    bool periodic = (8 % belen) == 0;
+    u64 pattern = periodic ? expand_enables(load_enables(be, belen, beidx))
+                           : 0;
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        u64 mask = pattern;
+        if (!periodic) {
+            mask = expand_enables(load_enables(be, belen, beidx));
+            beidx = (beidx + 8) % belen;
+        }
+
+        if (mask == ~0ull) {
+            memcpy(dest + i, src + i, 8);
+        } else if (mask != 0) {
+            u64 d, s;
+            memcpy(&d, dest + i, sizeof(d));
+            memcpy(&s, src + i, sizeof(s));
+            d = (d & ~mask) | (s & mask);
+            memcpy(dest + i, &d, sizeof(d));
+        }
+    }
+
+    for (; i < n; i++) {
+        if (be[beidx])
+            dest[i] = src[i];
+        beidx = (beidx + 1) % belen;
+    }
+}
+
+void tlm_memory::transport(tlm_generic_payload& tx, const tlm_sbi& sbi) {
+    u64 addr = tx.get_address();
+    u8* ptr = tx.get_data_ptr();
+    unsigned int length = tx.get_data_length();
+    unsigned int width = tx.get_streaming_width();
+    const u8* be = tx.get_byte_enable_ptr();
+    size_t belen = tx.get_byte_enable_length();
+    const tlm_gather* gather = tx_get_gather(tx);
+
+    if (width == 0 || width > length)
+        width = length;
+
+    if (be != nullptr && belen == 0) {
+        tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        return;
+    }
+
+    if (!tx.is_read() && !tx.is_write()) {
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return;
+    }
+
+    if (!sbi.is_debug) {
+        if (tx.is_read() && !is_read_allowed()) {
+            tx.set_response_status(TLM_COMMAND_ERROR_RESPONSE);
+            return;
+        }
+
+        if (tx.is_write() && (m_discard || !is_write_allowed())) {
+            tx.set_response_status(m_discard ? TLM_OK_RESPONSE
+                                             : TLM_COMMAND_ERROR_RESPONSE);
+            return;
+        }
+    }
+
+    // without a gather list, the transaction is a single entry that gets
+    // repeated once per beat of a fixed address burst
+    tlm_gather_entry single = { 0, width };
+    const tlm_gather_entry* entries = &single;
+    size_t nentries = 1;
+    unsigned int nbeats = length / width;
+
+    if (gather != nullptr) {
+        if (width != length) {
+            tx.set_response_status(TLM_BURST_ERROR_RESPONSE);
+            return;
+        }
+
+        if (gather->total_size() != length) {
+            tx.set_response_status(TLM_GENERIC_ERROR_RESPONSE);
+            return;
+        }
+
+        entries = gather->entries.data();
+        nentries = gather->entries.size();
+        nbeats = 1;
+    }
+
+    // check everything up front, so that failing accesses change nothing
+    for (size_t i = 0; i < nentries; i++) {
+        u64 end = addr + entries[i].offset + entries[i].size - 1;
+        if (entries[i].size && (end < addr || end >= m_size)) {
+            tx.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
+            return;
+        }
+    }
+
+    size_t beidx = 0;
+    u8* buf = ptr;
+    for (size_t i = 0; i < nentries; i++) {
+        const tlm_gather_entry& entry = entries[i];
+        if (entry.size == 0)
+            continue;
+
+        u8* mem = data() + addr + entry.offset;
+        unsigned int beat = 0;
+
+        // later beats overwrite earlier ones, so only the last one lands
+        if (tx.is_write() && be == nullptr && nbeats > 1) {
+            beat = nbeats - 1;
+            buf += beat * entry.size;
+        }
+
+        for (; beat < nbeats; beat++, buf += entry.size) {
+            u8* dest = tx.is_read() ? buf : mem;
+            const u8* src = tx.is_read() ? mem : buf;
+            if (be != nullptr)
+                masked_copy(dest, src, entry.size, be, belen, beidx);
+            else
+                memcpy(dest, src, entry.size);
+        }
+
+        if (tx.is_write() && is_tracking_dirty()) {
+            u64 start = addr + entry.offset;
+            mark_dirty({ start, start + entry.size - 1 });
+        }
+    }
+
+    tx.set_response_status(TLM_OK_RESPONSE);
+}
+
+} // namespace vcml
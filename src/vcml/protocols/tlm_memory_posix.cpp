@@ -15,8 +15,58 @@
 #include <unistd.h>
 #include <fcntl.h>
 
+#include <climits>
+#include <fstream>
+
+#ifdef MWR_LINUX
+#include <sys/syscall.h>
+#endif
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
 namespace vcml {
 
+static size_t host_page_size() {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static size_t host_hugepage_size() {
+    size_t size = 2 * MiB;
+#ifdef MWR_LINUX
+    ifstream meminfo("/proc/meminfo");
+    string line;
+    while (std::getline(meminfo, line)) {
+        unsigned long long kib;
+        if (sscanf(line.c_str(), "Hugepagesize: %llu kB", &kib) == 1) {
+            size = kib * KiB;
+            break;
+        }
+    }
+#endif
+    return size;
+}
+
+static bool bind_numa(void* addr, size_t size, int node) {
+#ifdef MWR_LINUX
+    unsigned long mask[16] = {};
+    const size_t bits = sizeof(mask[0]) * CHAR_BIT;
+    if (node < 0 || (size_t)node >= bits * 16)
+        return false;
+
+    mask[node / bits] = 1ul << (node % bits);
+    return syscall(SYS_mbind, addr, size, MPOL_BIND, mask, bits * 16,
+                   MPOL_MF_MOVE) == 0;
+#else
+    return false;
+#endif
+}
+
 int tlm_memory::init_shared(const string& shared, size_t size) {
     VCML_ERROR_ON(is_shared(), "shared memory already initialized");
     m_shared = shared;
@@ -48,7 +98,20 @@ int tlm_memory::init_shared(const string& shared, size_t size) {
 }
 
 tlm_memory::tlm_memory():
-    tlm_dmi(), m_handle(), m_base(), m_size(0), m_discard(false), m_shared() {
+    tlm_dmi(),
+    m_handle(),
+    m_base(),
+    m_size(0),
+    m_discard(false),
+    m_shared(),
+    m_thp(false),
+    m_hugetlb(false),
+    m_prefault(false),
+    m_numa_node(-1),
+    m_page_size(0),
+    m_dirty_shift(0),
+    m_dirty(),
+    m_mapped() {
 }
 
 tlm_memory::tlm_memory(size_t size): tlm_memory() {
@@ -73,7 +136,15 @@ tlm_memory::tlm_memory(tlm_memory&& other) noexcept:
     m_handle(other.m_handle),
     m_base(other.m_base),
     m_size(other.m_size),
-    m_discard(other.m_discard) {
+    m_discard(other.m_discard),
+    m_thp(other.m_thp),
+    m_hugetlb(other.m_hugetlb),
+    m_prefault(other.m_prefault),
+    m_numa_node(other.m_numa_node),
+    m_page_size(other.m_page_size),
+    m_dirty_shift(other.m_dirty_shift),
+    m_dirty(std::move(other.m_dirty)),
+    m_mapped(std::move(other.m_mapped)) {
     other.m_handle = nullptr;
     other.m_base = nullptr;
     other.m_size = 0;
@@ -103,8 +174,51 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
     else
         flags |= MAP_PRIVATE | MAP_ANON;
 
-    m_base = mmap(0, m_size, perms, flags, fd, 0);
+    // prefaulting is done after NUMA binding to place pages correctly
+#ifdef MAP_POPULATE
+    if (m_prefault && m_numa_node < 0)
+        flags |= MAP_POPULATE;
+#endif
+
+    m_base = MAP_FAILED;
+    m_page_size = host_page_size();
+
+#ifdef MAP_HUGETLB
+    // explicit huge pages need a pool reserved by the host administrator,
+    // fall back to regular pages if none are available
+    if (m_hugetlb && !is_shared()) {
+        size_t hpsz = host_hugepage_size();
+        size_t hpsize = (m_size + hpsz - 1) & ~(hpsz - 1);
+        m_base = mmap(0, hpsize, perms, flags | MAP_HUGETLB, fd, 0);
+        if (m_base != MAP_FAILED) {
+            m_size = hpsize;
+            m_page_size = hpsz;
+        }
+    }
+#endif
+
+    if (m_base == MAP_FAILED)
+        m_base = mmap(0, m_size, perms, flags, fd, 0);
     VCML_ERROR_ON(m_base == MAP_FAILED, "mmap failed: %s", strerror(errno));
+
+#ifdef MADV_HUGEPAGE
+    if (m_thp && m_page_size == host_page_size()) {
+        if (madvise(m_base, m_size, MADV_HUGEPAGE) == 0)
+            m_page_size = host_hugepage_size();
+    }
+#endif
+
+    if (m_numa_node >= 0) {
+        if (!bind_numa(m_base, m_size, m_numa_node))
+            m_numa_node = -1;
+
+        if (m_prefault) {
+            volatile u8* page = (volatile u8*)m_base;
+            for (size_t off = 0; off < m_size; off += m_page_size)
+                page[off] = page[off];
+        }
+    }
+
     u8* ptr = (u8*)(((u64)m_base + extra) & ~extra);
     VCML_ERROR_ON(!is_aligned(ptr, al), "memory alignment failed");
 
@@ -127,10 +241,140 @@ void tlm_memory::free() {
     m_shared = "";
     m_base = nullptr;
     m_size = 0;
+    m_mapped.clear();
 
+    untrack_dirty();
     tlm_dmi::init();
 }
 
+bool tlm_memory::release(u8* ptr, size_t len) {
+    range addr(ptr - data(), ptr - data() + len - 1);
+    bool mapped = false;
+    for (const range& file : m_mapped)
+        mapped |= file.overlaps(addr);
+
+    // private file mappings would fall back to the file contents, so only
+    // anonymous memory can simply be discarded
+    if (!mapped && madvise(ptr, len, MADV_DONTNEED) == 0)
+        return true;
+
+    int perms = PROT_READ | PROT_WRITE;
+    int flags = MAP_PRIVATE | MAP_ANON | MAP_FIXED | MAP_NORESERVE;
+#ifdef MAP_HUGETLB
+    if (m_hugetlb && m_page_size != host_page_size())
+        flags |= MAP_HUGETLB;
+#endif
+
+    if (mmap(ptr, len, perms, flags, -1, 0) == MAP_FAILED)
+        return false;
+
+    stl_remove_if(m_mapped, [&](const range& r) { return addr.includes(r); });
+
+    // the new mapping does not inherit the hints of the old one
+#ifdef MADV_HUGEPAGE
+    if (m_thp && !(flags & MAP_HUGETLB))
+        madvise(ptr, len, MADV_HUGEPAGE);
+#endif
+
+    if (m_numa_node >= 0)
+        bind_numa(ptr, len, m_numa_node);
+
+    return true;
+}
+
+void tlm_memory::clear(const range& addr) {
+    VCML_ERROR_ON(data() == nullptr, "memory not initialized");
+    VCML_ERROR_ON(addr.end >= size(), "range out of bounds");
+
+    // explicit huge pages can only be handed back as a whole
+    size_t pgsz = host_page_size();
+    if (m_hugetlb && m_page_size > pgsz)
+        pgsz = m_page_size;
+
+    u8* lo = data() + addr.start;
+    u8* hi = lo + addr.length();
+    u8* first = (u8*)(((uintptr_t)lo + pgsz - 1) & ~(pgsz - 1));
+    u8* last = (u8*)((uintptr_t)hi & ~(pgsz - 1));
+
+    // shared memory must remain visible to all peers
+    if (is_shared() || first >= last || !release(first, last - first)) {
+        memset(lo, 0, hi - lo);
+    } else {
+        memset(lo, 0, first - lo);
+        memset(last, 0, hi - last);
+
+        if (m_prefault) {
+            for (u8* page = first; page < last; page += pgsz)
+                *(volatile u8*)page = 0;
+        }
+    }
+
+    mark_dirty(addr);
+}
+
+bool tlm_memory::map_file(const string& filename, u64 offset, u64 fileoff,
+                          u64 size) {
+    // shared memory must remain visible to all peers
+    if (m_base == nullptr || is_shared())
+        return false;
+
+    // hugetlb mappings cannot be split at regular page boundaries
+    size_t pgsz = host_page_size();
+    if (m_hugetlb && m_page_size != pgsz)
+        return false;
+
+    if ((offset | fileoff) & (pgsz - 1))
+        return false;
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) || !S_ISREG(info.st_mode) ||
+        fileoff > (u64)info.st_size) {
+        close(fd);
+        return false;
+    }
+
+    if (size == ~0ull)
+        size = info.st_size - fileoff;
+
+    if (fileoff + size > (u64)info.st_size || offset + size > this->size()) {
+        close(fd);
+        return false;
+    }
+
+    // only map full pages, the remaining tail is copied so that memory
+    // between the end of the file and the next page boundary is preserved
+    size_t filesz = size;
+    size_t mapsz = filesz & ~(pgsz - 1);
+    u8* dest = data() + offset;
+
+    if (mapsz > 0) {
+        int perms = PROT_READ | PROT_WRITE;
+        int flags = MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE;
+        if (mmap(dest, mapsz, perms, flags, fd, fileoff) == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+    }
+
+    size_t tail = filesz - mapsz;
+    if (tail > 0 && pread(fd, dest + mapsz, tail, fileoff + mapsz) !=
+                        (ssize_t)tail) {
+        close(fd);
+        VCML_ERROR("cannot read %s: %s", filename.c_str(), strerror(errno));
+    }
+
+    close(fd);
+    if (mapsz > 0)
+        m_mapped.push_back({ offset, offset + mapsz - 1 });
+    if (filesz > 0)
+        mark_dirty({ offset, offset + filesz - 1 });
+    return true;
+}
+
 tlm_response_status tlm_memory::fill(u8 data, bool debug) {
     if (!is_write_allowed() && !debug)
         return m_discard ? TLM_OK_RESPONSE : TLM_COMMAND_ERROR_RESPONSE;
@@ -165,19 +409,10 @@ tlm_response_status tlm_memory::write(const range& addr, const void* src,
     }
 
     memcpy(data() + addr.start, src, addr.length());
-    return TLM_OK_RESPONSE;
-}
+    if (is_tracking_dirty())
+        mark_dirty(addr);
 
-void tlm_memory::transport(tlm_generic_payload& tx, const tlm_sbi& sbi) {
-    tlm_response_status res = TLM_OK_RESPONSE;
-    range addr(tx);
-
-    if (tx.is_read())
-        res = read(addr, tx.get_data_ptr(), sbi.is_debug);
-    if (tx.is_write())
-        res = write(addr, tx.get_data_ptr(), sbi.is_debug);
-
-    tx.set_response_status(res);
+    return TLM_OK_RESPONSE;
 }
 
 } // namespace vcml
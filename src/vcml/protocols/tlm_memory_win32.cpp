@@ -48,7 +48,15 @@ tlm_memory::tlm_memory():
     m_base(nullptr),
     m_size(0),
     m_discard(false),
-    m_shared() {
+    m_shared(),
+    m_thp(false),
+    m_hugetlb(false),
+    m_prefault(false),
+    m_numa_node(-1),
+    m_page_size(0),
+    m_dirty_shift(0),
+    m_dirty(),
+    m_mapped() {
 }
 
 tlm_memory::tlm_memory(size_t size): tlm_memory() {
@@ -73,7 +81,15 @@ tlm_memory::tlm_memory(tlm_memory&& other) noexcept:
     m_handle(other.m_handle),
     m_base(other.m_base),
     m_size(other.m_size),
-    m_discard(other.m_discard) {
+    m_discard(other.m_discard),
+    m_thp(other.m_thp),
+    m_hugetlb(other.m_hugetlb),
+    m_prefault(other.m_prefault),
+    m_numa_node(other.m_numa_node),
+    m_page_size(other.m_page_size),
+    m_dirty_shift(other.m_dirty_shift),
+    m_dirty(std::move(other.m_dirty)),
+    m_mapped(std::move(other.m_mapped)) {
     other.m_handle = INVALID_HANDLE_VALUE;
     other.m_base = nullptr;
     other.m_size = 0;
@@ -92,9 +108,47 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
     u64 extra = (al > VCML_ALIGN_4K) ? (1ull << al) - 1 : 0;
     m_size = size + extra;
 
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    m_page_size = sysinfo.dwPageSize;
+
     if (shared.empty()) {
-        m_base = VirtualAlloc(NULL, m_size, MEM_COMMIT, PAGE_READWRITE);
+        DWORD type = MEM_COMMIT | MEM_RESERVE;
+        HANDLE proc = GetCurrentProcess();
+        m_base = nullptr;
+
+        // large pages require SeLockMemoryPrivilege, fall back otherwise
+        size_t lpsz = GetLargePageMinimum();
+        if ((m_hugetlb || m_thp) && lpsz > 0) {
+            size_t lpsize = (m_size + lpsz - 1) & ~(lpsz - 1);
+            DWORD lptype = type | MEM_LARGE_PAGES;
+            if (m_numa_node >= 0) {
+                m_base = VirtualAllocExNuma(proc, NULL, lpsize, lptype,
+                                            PAGE_READWRITE, m_numa_node);
+            } else {
+                m_base = VirtualAlloc(NULL, lpsize, lptype, PAGE_READWRITE);
+            }
+
+            if (m_base) {
+                m_size = lpsize;
+                m_page_size = lpsz;
+            }
+        }
+
+        if (!m_base && m_numa_node >= 0) {
+            m_base = VirtualAllocExNuma(proc, NULL, m_size, type,
+                                        PAGE_READWRITE, m_numa_node);
+        }
+
+        if (!m_base)
+            m_base = VirtualAlloc(NULL, m_size, type, PAGE_READWRITE);
         VCML_ERROR_ON(!m_base, "VirtualAlloc failed: %u", GetLastError());
+
+        if (m_prefault) {
+            volatile u8* page = (volatile u8*)m_base;
+            for (size_t off = 0; off < m_size; off += m_page_size)
+                page[off] = page[off];
+        }
     } else {
         init_shared(shared, m_size);
     }
@@ -125,9 +179,28 @@ void tlm_memory::free() {
     m_shared = "";
     m_size = 0;
 
+    untrack_dirty();
     tlm_dmi::init();
 }
 
+bool tlm_memory::map_file(const string& filename, u64 offset, u64 fileoff,
+                          u64 size) {
+    // views cannot be placed into an existing VirtualAlloc region
+    return false;
+}
+
+bool tlm_memory::release(u8* ptr, size_t len) {
+    // VirtualAlloc offers no way to discard pages and keep them zeroed
+    return false;
+}
+
+void tlm_memory::clear(const range& addr) {
+    VCML_ERROR_ON(data() == nullptr, "memory not initialized");
+    VCML_ERROR_ON(addr.end >= size(), "range out of bounds");
+    memset(data() + addr.start, 0, addr.length());
+    mark_dirty(addr);
+}
+
 tlm_response_status tlm_memory::fill(u8 data, bool debug) {
     if (!is_write_allowed() && !debug)
         return m_discard ? TLM_OK_RESPONSE : TLM_COMMAND_ERROR_RESPONSE;
@@ -162,19 +235,10 @@ tlm_response_status tlm_memory::write(const range& addr, const void* src,
     }
 
     memcpy(data() + addr.start, src, addr.length());
-    return TLM_OK_RESPONSE;
-}
+    if (is_tracking_dirty())
+        mark_dirty(addr);
 
-void tlm_memory::transport(tlm_generic_payload& tx, const tlm_sbi& sbi) {
-    tlm_response_status res = TLM_OK_RESPONSE;
-    range addr(tx);
-
-    if (tx.is_read())
-        res = read(addr, tx.get_data_ptr(), sbi.is_debug);
-    if (tx.is_write())
-        res = write(addr, tx.get_data_ptr(), sbi.is_debug);
-
-    tx.set_response_status(res);
+    return TLM_OK_RESPONSE;
 }
 
 } // namespace vcml
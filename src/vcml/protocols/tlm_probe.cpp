@@ -12,38 +12,209 @@
 
 namespace vcml {
 
+tlm_probe_counter::tlm_probe_counter(const char* nm):
+    property_base(nm), m_value(0), m_str() {
+}
+
+const char* tlm_probe_counter::str() const {
+    m_str = to_string(get());
+    return m_str.c_str();
+}
+
+void tlm_probe_counter::str(const string& s) {
+    // statistics are read-only, writes are ignored
+}
+
+static size_t size_bucket(u64 size) {
+    return size > 0 ? min<size_t>(fls(size), 31) : 0;
+}
+
+static size_t latency_bucket(const sc_time& t) {
+    u64 ns = t.value() / sc_time(1.0, SC_NS).value();
+    return ns > 0 ? min<size_t>(fls(ns) + 1, 31) : 0;
+}
+
+static size_t response_index(tlm_response_status rs) {
+    return (size_t)(TLM_OK_RESPONSE - rs);
+}
+
+void tlm_probe::record_request(const tlm_generic_payload& tx) {
+    switch (tx.get_command()) {
+    case TLM_READ_COMMAND:
+        num_reads.add();
+        bytes_read.add(tx.get_data_length());
+        break;
+    case TLM_WRITE_COMMAND:
+        num_writes.add();
+        bytes_written.add(tx.get_data_length());
+        break;
+    default:
+        num_ignores.add();
+        break;
+    }
+
+    size_t bucket = size_bucket(tx.get_data_length());
+    m_sizes[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void tlm_probe::record_response(const tlm_generic_payload& tx) {
+    tlm_response_status rs = tx.get_response_status();
+    size_t idx = response_index(rs);
+    if (idx < NUM_RESPONSES)
+        m_responses[idx].fetch_add(1, std::memory_order_relaxed);
+    if (failed(rs))
+        num_errors.add();
+}
+
+void tlm_probe::record_latency(const sc_time& t) {
+    size_t bucket = latency_bucket(t);
+    m_latencies[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool tlm_probe::cmd_stats(const vector<string>& args, ostream& os) {
+    if (!collect_stats)
+        os << "statistics collection disabled" << std::endl;
+
+    os << "reads:          " << num_reads << " (" << bytes_read << " bytes)"
+       << std::endl;
+    os << "writes:         " << num_writes << " (" << bytes_written
+       << " bytes)" << std::endl;
+    os << "ignores:        " << num_ignores << std::endl;
+    os << "debug:          " << num_debug << std::endl;
+    os << "errors:         " << num_errors << std::endl;
+    os << "dmi grants:     " << num_dmi_grants << std::endl;
+    os << "dmi invalidate: " << num_dmi_invalidates << std::endl;
+
+    os << "responses:";
+    for (size_t i = 0; i < NUM_RESPONSES; i++) {
+        tlm_response_status rs = (tlm_response_status)(TLM_OK_RESPONSE - i);
+        if (u64 n = m_responses[i])
+            os << "\n  " << tlm_response_to_str(rs) << ": " << n;
+    }
+
+    os << "\nsizes:";
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        if (u64 n = m_sizes[i])
+            os << "\n  " << (1ull << i) << ".." << (2ull << i) - 1 << ": "
+               << n;
+    }
+
+    os << "\nlatencies:";
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        if (u64 n = m_latencies[i]) {
+            if (i == 0)
+                os << "\n  <1ns: " << n;
+            else
+                os << "\n  " << (1ull << (i - 1)) << ".." << (1ull << i) - 1
+                   << "ns: " << n;
+        }
+    }
+
+    return true;
+}
+
+bool tlm_probe::cmd_reset_stats(const vector<string>& args, ostream& os) {
+    reset_stats();
+    os << "statistics cleared";
+    return true;
+}
+
 void tlm_probe::b_transport(tlm_generic_payload& tx, sc_time& t) {
+    if (!collect_stats) {
+        out->b_transport(tx, t);
+        return;
+    }
+
+    record_request(tx);
+    sc_time start = t;
     out->b_transport(tx, t);
+    record_latency(t > start ? t - start : SC_ZERO_TIME);
+    record_response(tx);
 }
 
 unsigned int tlm_probe::transport_dbg(tlm_generic_payload& tx) {
+    if (collect_stats)
+        num_debug.add();
     return out->transport_dbg(tx);
 }
 
 bool tlm_probe::get_direct_mem_ptr(tlm_generic_payload& tx, tlm_dmi& dmi) {
-    return out->get_direct_mem_ptr(tx, dmi);
+    bool granted = out->get_direct_mem_ptr(tx, dmi);
+    if (collect_stats && granted)
+        num_dmi_grants.add();
+    return granted;
 }
 
 void tlm_probe::invalidate_direct_mem_ptr(u64 start, u64 end) {
+    if (collect_stats)
+        num_dmi_invalidates.add();
     return in->invalidate_direct_mem_ptr(start, end);
 }
 
 tlm::tlm_sync_enum tlm_probe::nb_transport_fw(tlm_generic_payload& tx,
                                               tlm::tlm_phase& phase,
                                               sc_time& t) {
+    if (collect_stats && phase == tlm::BEGIN_REQ)
+        record_request(tx);
     return out->nb_transport_fw(tx, phase, t);
 }
 
 tlm::tlm_sync_enum tlm_probe::nb_transport_bw(tlm_generic_payload& trans,
                                               tlm::tlm_phase& phase,
                                               sc_time& t) {
+    if (collect_stats && phase == tlm::BEGIN_RESP)
+        record_response(trans);
     return in->nb_transport_bw(trans, phase, t);
 }
 
 tlm_probe::tlm_probe(const sc_module_name& nm):
-    module(nm), in("in"), out("out") {
+    module(nm),
+    m_responses(),
+    m_sizes(),
+    m_latencies(),
+    collect_stats("collect_stats", false),
+    num_reads("num_reads"),
+    num_writes("num_writes"),
+    num_ignores("num_ignores"),
+    num_debug("num_debug"),
+    num_errors("num_errors"),
+    bytes_read("bytes_read"),
+    bytes_written("bytes_written"),
+    num_dmi_grants("num_dmi_grants"),
+    num_dmi_invalidates("num_dmi_invalidates"),
+    in("in"),
+    out("out") {
     in.bind(*this);
     out.bind(*this);
+
+    register_command("stats", 0, &tlm_probe::cmd_stats,
+                     "prints transaction statistics");
+    register_command("reset_stats", 0, &tlm_probe::cmd_reset_stats,
+                     "clears all transaction statistics");
+}
+
+u64 tlm_probe::count_response(tlm_response_status rs) const {
+    size_t idx = response_index(rs);
+    return idx < NUM_RESPONSES ? m_responses[idx].load() : 0;
+}
+
+void tlm_probe::reset_stats() {
+    for (auto& n : m_responses)
+        n = 0;
+    for (auto& n : m_sizes)
+        n = 0;
+    for (auto& n : m_latencies)
+        n = 0;
+
+    num_reads.reset();
+    num_writes.reset();
+    num_ignores.reset();
+    num_debug.reset();
+    num_errors.reset();
+    bytes_read.reset();
+    bytes_written.reset();
+    num_dmi_grants.reset();
+    num_dmi_invalidates.reset();
 }
 
 } // namespace vcml
@@ -0,0 +1,231 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/protocols/tlm_shared.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <climits>
+
+namespace vcml {
+
+enum : size_t {
+    SHARED_MAX_PEERS = 32,
+    SHARED_RING_SLOTS = 256,
+};
+
+struct tlm_shared_msg {
+    atomic<u64> stamp; // index + 1 once the message is complete
+    u32 type;
+    u32 origin;
+    u64 start;
+    u64 end;
+};
+
+// zero-filled memory is a valid empty channel, so a freshly truncated
+// shared memory object needs no further initialization by whoever is first
+struct tlm_shared_ctl {
+    alignas(64) atomic<u32> peers; // bit n is set while peer n is attached
+    alignas(64) atomic<u64> head;  // number of messages ever published
+    atomic<u32> seq;               // bumped whenever messages get published
+    atomic<u32> readers;           // readers sleeping on seq
+    tlm_shared_msg ring[SHARED_RING_SLOTS];
+};
+
+static_assert(atomic<u32>::is_always_lock_free, "channel needs lock-free");
+static_assert(atomic<u64>::is_always_lock_free, "channel needs lock-free");
+
+static void futex_wait(atomic<u32>& addr, u32 val, u64 timeout_ns) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ns / 1000000000;
+    ts.tv_nsec = timeout_ns % 1000000000;
+    // deliberately not FUTEX_PRIVATE, the peers are other processes
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAIT, val, &ts, nullptr, 0);
+}
+
+static void futex_wake_all(atomic<u32>& addr) {
+    syscall(SYS_futex, (u32*)&addr, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void tlm_shared_channel::attach() {
+    m_fd = shm_open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    VCML_ERROR_ON(m_fd < 0, "cannot open %s: %s", m_path.c_str(),
+                  strerror(errno));
+
+    struct stat info;
+    if (fstat(m_fd, &info) < 0)
+        VCML_ERROR("cannot access %s: %s", m_path.c_str(), strerror(errno));
+
+    if (info.st_size == 0 && ftruncate(m_fd, sizeof(tlm_shared_ctl)) < 0)
+        VCML_ERROR("cannot resize %s: %s", m_path.c_str(), strerror(errno));
+    else if (info.st_size != 0 &&
+             (size_t)info.st_size != sizeof(tlm_shared_ctl))
+        VCML_ERROR("%s is not a compatible channel", m_path.c_str());
+
+    void* mem = mmap(nullptr, sizeof(tlm_shared_ctl), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, m_fd, 0);
+    VCML_ERROR_ON(mem == MAP_FAILED, "cannot map %s: %s", m_path.c_str(),
+                  strerror(errno));
+
+    m_ctl = (tlm_shared_ctl*)mem;
+
+    u32 peers = m_ctl->peers.load();
+    do {
+        for (m_peer = 0; m_peer < SHARED_MAX_PEERS; m_peer++)
+            if (!(peers & (1u << m_peer)))
+                break;
+        if (m_peer == SHARED_MAX_PEERS) {
+            m_ctl = nullptr;
+            munmap(mem, sizeof(tlm_shared_ctl));
+            VCML_ERROR("%s already has %zu peers", m_path.c_str(),
+                       (size_t)SHARED_MAX_PEERS);
+        }
+    } while (!m_ctl->peers.compare_exchange_weak(peers,
+                                                 peers | (1u << m_peer)));
+
+    // only messages published from now on are of interest to us
+    m_tail = m_ctl->head.load();
+}
+
+void tlm_shared_channel::detach() {
+    if (m_ctl != nullptr) {
+        u32 peers = m_ctl->peers.fetch_and(~(1u << m_peer));
+        if ((peers & ~(1u << m_peer)) == 0)
+            shm_unlink(m_path.c_str());
+        munmap(m_ctl, sizeof(tlm_shared_ctl));
+        m_ctl = nullptr;
+    }
+
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void tlm_shared_channel::receive(vector<pair<message, range>>& msgs) {
+    u64 head = m_ctl->head.load(std::memory_order_acquire);
+    bool lapped = head - m_tail > SHARED_RING_SLOTS;
+
+    for (; !lapped && m_tail != head; m_tail++) {
+        tlm_shared_msg& msg = m_ctl->ring[m_tail % SHARED_RING_SLOTS];
+
+        // the writer may have claimed the slot but not filled it yet
+        u64 stamp = msg.stamp.load(std::memory_order_acquire);
+        while (stamp < m_tail + 1)
+            stamp = msg.stamp.load(std::memory_order_acquire);
+
+        message type = (message)msg.type;
+        u32 origin = msg.origin;
+        range addr(msg.start, msg.end);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // the writer may have lapped us while we were copying the slot
+        if (msg.stamp.load(std::memory_order_relaxed) != m_tail + 1) {
+            lapped = true;
+            break;
+        }
+
+        if (origin != m_peer)
+            msgs.emplace_back(type, addr);
+    }
+
+    // lost messages could have been about anything, so break all locks,
+    // drop all dmi pointers and treat all pages as dirty to stay safe
+    if (lapped) {
+        m_tail = m_ctl->head.load(std::memory_order_acquire);
+        range all(0, ~0ull);
+        msgs.emplace_back(MSG_BREAK, all);
+        msgs.emplace_back(MSG_INVALIDATE, all);
+        msgs.emplace_back(MSG_DIRTY, all);
+    }
+}
+
+void tlm_shared_channel::run() {
+    mwr::set_thread_name("vcml_shared");
+    while (m_running) {
+        m_ctl->readers++;
+        u32 seq = m_ctl->seq.load();
+        vector<pair<message, range>> msgs;
+        receive(msgs);
+        if (msgs.empty())
+            futex_wait(m_ctl->seq, seq, 100000000); // 100ms
+        m_ctl->readers--;
+
+        if (msgs.empty())
+            continue;
+
+        shared_ptr<atomic<bool>> alive = m_alive;
+        on_next_update([this, alive, msgs]() -> void {
+            if (*alive) {
+                for (const auto& msg : msgs)
+                    m_handler(msg.first, msg.second);
+            }
+        });
+    }
+}
+
+size_t tlm_shared_channel::num_peers() const {
+    return popcnt(m_ctl->peers.load());
+}
+
+tlm_shared_channel::tlm_shared_channel(const string& shared,
+                                       const handler& h):
+    m_path(shared + "-ctl"),
+    m_fd(-1),
+    m_ctl(nullptr),
+    m_peer(0),
+    m_tail(0),
+    m_handler(h),
+    m_running(true),
+    m_thread(),
+    m_alive(new atomic<bool>(true)) {
+    VCML_ERROR_ON(shared.empty(), "no shared memory name given");
+    VCML_ERROR_ON(!m_handler, "no message handler given");
+
+    try {
+        attach();
+    } catch (...) {
+        detach();
+        throw;
+    }
+
+    m_thread = thread(&tlm_shared_channel::run, this);
+}
+
+tlm_shared_channel::~tlm_shared_channel() {
+    *m_alive = false;
+    m_running = false;
+    if (m_thread.joinable()) {
+        futex_wake_all(m_ctl->seq);
+        m_thread.join();
+    }
+
+    detach();
+}
+
+void tlm_shared_channel::broadcast(message type, const range& addr) {
+    u64 idx = m_ctl->head.fetch_add(1);
+    tlm_shared_msg& msg = m_ctl->ring[idx % SHARED_RING_SLOTS];
+    msg.type = type;
+    msg.origin = m_peer;
+    msg.start = addr.start;
+    msg.end = addr.end;
+    msg.stamp.store(idx + 1, std::memory_order_release);
+
+    m_ctl->seq++; // must be ordered before reading readers
+    if (m_ctl->readers.load())
+        futex_wake_all(m_ctl->seq);
+}
+
+} // namespace vcml
@@ -9,12 +9,42 @@
  ******************************************************************************/
 
 #include "vcml/protocols/tlm_sockets.h"
+#include "vcml/core/model.h"
+
+#include <typeinfo>
 
 namespace vcml {
 
+const tlm_initiator_socket::dmi_hint* tlm_initiator_socket::insert_dmi_hint(
+    const tlm_dmi& dmi) {
+    dmi_hint& hint = m_dmi_hints[m_dmi_next++ % NUM_DMI_HINTS];
+    hint.start = dmi.get_start_address();
+    hint.end = dmi.get_end_address();
+    hint.base = dmi.get_dmi_ptr() - dmi.get_start_address();
+    hint.access = dmi.get_granted_access();
+    hint.generation = m_dmi_gen;
+    hint.rdlat = dmi.get_read_latency();
+    hint.wrlat = dmi.get_write_latency();
+    return &hint;
+}
+
+const tlm_initiator_socket::dmi_hint* tlm_initiator_socket::find_dmi_hint(
+    const range& mem, vcml_access rw) {
+    const dmi_hint* hint = lookup_dmi_hint(mem, rw);
+    if (hint)
+        return hint;
+
+    tlm_dmi dmi;
+    if (!dmi_cache().lookup(mem, rw, dmi))
+        return nullptr;
+
+    return insert_dmi_hint(dmi);
+}
+
 void tlm_initiator_socket::invalidate_direct_mem_ptr_int(sc_dt::uint64 start,
                                                          sc_dt::uint64 end) {
     VCML_ERROR_ON(start > end, "invalid dmi invalidation request");
+    m_dmi_gen++;
     invalidate_direct_mem_ptr(start, end);
 }
 
@@ -26,6 +56,14 @@ void tlm_initiator_socket::invalidate_direct_mem_ptr(u64 start, u64 end) {
 tlm_initiator_socket::tlm_initiator_socket(const char* nm,
                                            address_space space):
     simple_initiator_socket<tlm_initiator_socket>(nm),
+    tlm_trace_filter(this),
+    m_dmi_hints(),
+    m_dmi_next(0),
+    m_dmi_gen(1),
+    m_dmi_hits(0),
+    m_dmi_misses(0),
+    m_stats(),
+    m_excl(),
     m_tx(),
     m_txd(),
     m_sbi(SBI_NONE),
@@ -34,9 +72,12 @@ tlm_initiator_socket::tlm_initiator_socket(const char* nm,
     m_host(hierarchy_search<tlm_host>()),
     m_parent(hierarchy_search<module>()),
     m_adapter(nullptr),
+    m_fw(nullptr),
     trace_all(this, "trace", false),
     trace_errors(this, "trace_errors", false),
-    allow_dmi(this, "allow_dmi", true) {
+    allow_dmi(this, "allow_dmi", true),
+    m_trace_all(trace_all.get()),
+    m_trace_errors(trace_errors.get()) {
     VCML_ERROR_ON(!m_host, "socket '%s' declared outside tlm_host", nm);
     VCML_ERROR_ON(!m_parent, "socket '%s' declared outside module", nm);
 
@@ -66,14 +107,19 @@ u8* tlm_initiator_socket::lookup_dmi_ptr(const range& mem, vcml_access rw) {
     if (!allow_dmi)
         return nullptr;
 
-    tlm_dmi dmi;
-    if (dmi_cache().lookup(mem, rw, dmi))
-        return dmi_get_ptr(dmi, mem.start);
+    const dmi_hint* hint = find_dmi_hint(mem, rw);
+    if (hint) {
+        m_dmi_hits++;
+        return hint->base + mem.start;
+    }
+
+    m_dmi_misses++;
 
+    tlm_dmi dmi;
     tlm_generic_payload tx;
     tlm_command cmd = tlm_command_from_access(rw);
     tx_setup(tx, cmd, mem.start, nullptr, mem.length());
-    if (!(*this)->get_direct_mem_ptr(tx, dmi))
+    if (!fw()->get_direct_mem_ptr(tx, dmi))
         return nullptr;
 
     map_dmi(dmi);
@@ -91,7 +137,7 @@ u8* tlm_initiator_socket::lookup_dmi_ptr(const range& mem, vcml_access rw) {
 
 void tlm_initiator_socket::b_transport(tlm_generic_payload& tx, sc_time& t) {
     trace_fw(tx, t);
-    (*this)->b_transport(tx, t);
+    fw()->b_transport(tx, t);
     trace_bw(tx, t);
 }
 
@@ -106,11 +152,13 @@ unsigned int tlm_initiator_socket::send(tlm_generic_payload& tx,
 
     if ((width == 0) || (width > size) || (size % width)) {
         tx.set_response_status(TLM_BURST_ERROR_RESPONSE);
+        m_stats.num_errors++;
         return 0;
     }
 
     if ((beptr != nullptr) && (belen == 0)) {
         tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        m_stats.num_errors++;
         return 0;
     }
 
@@ -119,17 +167,21 @@ unsigned int tlm_initiator_socket::send(tlm_generic_payload& tx,
 
     if (info.is_debug) {
         sc_time t1(sc_time_stamp());
-        bytes = (*this)->transport_dbg(tx);
+        bytes = fw()->transport_dbg(tx);
         sc_time t2(sc_time_stamp());
 
         if (thctl_is_sysc_thread() && t1 != t2)
             VCML_ERROR("time advanced during debug call");
+
+        m_stats.num_debug++;
     } else {
         if (!is_thread())
             VCML_ERROR("non-debug TLM access outside SC_THREAD forbidden");
 
-        if (info.is_sync || m_host->needs_sync())
+        if (info.is_sync || m_host->needs_sync()) {
+            quantum_count_need_sync();
             m_host->sync();
+        }
 
         sc_time& offset = m_host->local_time();
         sc_time local = sc_time_stamp() + offset;
@@ -139,18 +191,26 @@ unsigned int tlm_initiator_socket::send(tlm_generic_payload& tx,
         sc_time now = sc_time_stamp() + offset;
         VCML_ERROR_ON(now < local, "b_transport time went backwards");
 
-        if (info.is_sync || m_host->needs_sync())
+        if (info.is_sync || m_host->needs_sync()) {
+            quantum_count_need_sync();
             m_host->sync();
+        }
         bytes = tx.is_response_ok() ? tx.get_data_length() : 0;
+
+        m_stats.num_transactions++;
+        m_stats.num_bytes += bytes;
     }
 
+    if (tx.is_response_error())
+        m_stats.num_errors++;
+
     if (info.is_excl && !tx_is_excl(tx))
         bytes = 0;
 
     if (allow_dmi && tx.is_dmi_allowed()) {
         tlm_dmi dmi;
         tx.set_address(addr);
-        if ((*this)->get_direct_mem_ptr(tx, dmi))
+        if (fw()->get_direct_mem_ptr(tx, dmi))
             map_dmi(dmi);
     }
 
@@ -170,9 +230,12 @@ tlm_response_status tlm_initiator_socket::access_dmi(tlm_command cmd, u64 addr,
     if (info.is_nodmi || info.is_excl)
         return TLM_INCOMPLETE_RESPONSE;
 
-    tlm_dmi dmi;
+    const range mem(addr, addr + size - 1);
     tlm_command elevate = info.is_debug ? TLM_READ_COMMAND : cmd;
-    if (!dmi_cache().lookup(addr, size, elevate, dmi))
+    vcml_access rw = tlm_command_to_access(elevate);
+
+    const dmi_hint* hint = find_dmi_hint(mem, rw);
+    if (!hint)
         return TLM_INCOMPLETE_RESPONSE;
 
     if (info.is_sync && !info.is_debug)
@@ -180,11 +243,11 @@ tlm_response_status tlm_initiator_socket::access_dmi(tlm_command cmd, u64 addr,
 
     sc_time latency = SC_ZERO_TIME;
     if (cmd == TLM_READ_COMMAND) {
-        memcpy(data, dmi_get_ptr(dmi, addr), size);
-        latency += dmi.get_read_latency();
+        memcpy(data, hint->base + addr, size);
+        latency += hint->rdlat;
     } else if (cmd == TLM_WRITE_COMMAND) {
-        memcpy(dmi_get_ptr(dmi, addr), data, size);
-        latency += dmi.get_write_latency();
+        memcpy(hint->base + addr, data, size);
+        latency += hint->wrlat;
     }
 
     if (!info.is_debug) {
@@ -196,6 +259,104 @@ tlm_response_status tlm_initiator_socket::access_dmi(tlm_command cmd, u64 addr,
     return TLM_OK_RESPONSE;
 }
 
+template <typename T>
+static void excl_load(const u8* ptr, void* data) {
+    T val = __atomic_load_n((const T*)ptr, __ATOMIC_ACQUIRE);
+    memcpy(data, &val, sizeof(T));
+}
+
+template <typename T>
+static bool excl_store(u8* ptr, const void* expect, const void* data) {
+    T old, val;
+    memcpy(&old, expect, sizeof(T));
+    memcpy(&val, data, sizeof(T));
+    return __atomic_compare_exchange_n((T*)ptr, &old, val, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static void excl_load(const u8* ptr, void* data, unsigned int size) {
+    switch (size) {
+    case 1:
+        return excl_load<u8>(ptr, data);
+    case 2:
+        return excl_load<u16>(ptr, data);
+    case 4:
+        return excl_load<u32>(ptr, data);
+    case 8:
+        return excl_load<u64>(ptr, data);
+    default:
+        VCML_ERROR("invalid exclusive access size: %u", size);
+    }
+}
+
+static bool excl_store(u8* ptr, const void* expect, const void* data,
+                       unsigned int size) {
+    switch (size) {
+    case 1:
+        return excl_store<u8>(ptr, expect, data);
+    case 2:
+        return excl_store<u16>(ptr, expect, data);
+    case 4:
+        return excl_store<u32>(ptr, expect, data);
+    case 8:
+        return excl_store<u64>(ptr, expect, data);
+    default:
+        VCML_ERROR("invalid exclusive access size: %u", size);
+    }
+}
+
+tlm_response_status tlm_initiator_socket::access_dmi_excl(
+    tlm_command cmd, u64 addr, void* data, unsigned int size,
+    const tlm_sbi& info, unsigned int& nbytes) {
+    // host atomics only work on naturally aligned words
+    if (info.is_nodmi || info.is_debug || size > sizeof(m_excl.data) ||
+        !is_pow2(size) || (addr & (size - 1)))
+        return TLM_INCOMPLETE_RESPONSE;
+
+    const range mem(addr, addr + size - 1);
+    const dmi_hint* hint = find_dmi_hint(mem, tlm_command_to_access(cmd));
+    if (!hint)
+        return TLM_INCOMPLETE_RESPONSE;
+
+    u8* ptr = hint->base + addr;
+    u64 target = 0;
+    tlm_exmon* mon = tlm_exmon::lookup_dmi(ptr, size, target);
+    if (mon == nullptr)
+        return TLM_INCOMPLETE_RESPONSE;
+
+    if (info.is_sync)
+        m_host->sync();
+
+    const int cpu = (int)info.cpuid;
+    const range locked(target, target + size - 1);
+    if (cmd == TLM_READ_COMMAND) {
+        excl_load(ptr, data, size);
+        mon->add_lock(cpu, locked, true);
+        m_excl.ptr = ptr;
+        m_excl.size = size;
+        memcpy(m_excl.data, data, size);
+        m_host->local_time() += hint->rdlat;
+        nbytes = size;
+    } else {
+        bool held = m_excl.ptr == ptr && m_excl.size == size &&
+                    mon->has_lock(cpu, locked);
+        if (held && excl_store(ptr, m_excl.data, data, size))
+            nbytes = size;
+        else
+            nbytes = 0;
+
+        // just like stores via transport, this breaks all other locks
+        mon->break_locks(locked);
+        m_excl.ptr = nullptr;
+        m_host->local_time() += hint->wrlat;
+    }
+
+    if (info.is_sync)
+        m_host->sync();
+
+    return TLM_OK_RESPONSE;
+}
+
 tlm_response_status tlm_initiator_socket::access(tlm_command cmd, u64 addr,
                                                  void* data, unsigned int size,
                                                  const tlm_sbi& info,
@@ -204,13 +365,38 @@ tlm_response_status tlm_initiator_socket::access(tlm_command cmd, u64 addr,
     if (!info.is_debug && !is_thread())
         VCML_ERROR("non-debug TLM access outside SC_THREAD forbidden");
 
+    // exclusive loads and stores only inform the monitor if possible
+    if (info.is_excl && allow_dmi && cmd != TLM_IGNORE_COMMAND) {
+        unsigned int n = 0;
+        if (success(access_dmi_excl(cmd, addr, data, size, info, n))) {
+            m_dmi_hits++;
+            m_stats.num_dmi++;
+            m_stats.num_bytes += n;
+            if (sz != nullptr)
+                *sz = n;
+            return TLM_OK_RESPONSE;
+        }
+
+        m_excl.ptr = nullptr;
+    }
+
     // check if we are allowed to do a DMI access on that address
     if (cmd != TLM_IGNORE_COMMAND && allow_dmi) {
         if (success(access_dmi(cmd, addr, data, size, info))) {
+            m_dmi_hits++;
+            if (info.is_debug) {
+                m_stats.num_debug++;
+            } else {
+                m_stats.num_dmi++;
+                m_stats.num_bytes += size;
+            }
+
             if (sz != nullptr)
                 *sz = size;
             return TLM_OK_RESPONSE;
         }
+
+        m_dmi_misses++;
     }
 
     // if DMI was not successful, send a regular transaction
@@ -232,6 +418,100 @@ tlm_response_status tlm_initiator_socket::access(tlm_command cmd, u64 addr,
     return rs;
 }
 
+tlm_response_status tlm_initiator_socket::access(
+    tlm_command cmd, const vector<tlm_segment>& segments, const tlm_sbi& info,
+    unsigned int* nbytes) {
+    // TLM protocol sanity checking
+    if (!info.is_debug && !is_thread())
+        VCML_ERROR("non-debug TLM access outside SC_THREAD forbidden");
+
+    bool use_dmi = cmd != TLM_IGNORE_COMMAND && allow_dmi && !info.is_nodmi &&
+                   !info.is_excl;
+    tlm_command elevate = info.is_debug ? TLM_READ_COMMAND : cmd;
+    vcml_access rw = tlm_command_to_access(elevate);
+
+    // synchronize only once for the entire batch
+    tlm_sbi sbi(info);
+    sbi.is_sync = false;
+    if (info.is_sync && !info.is_debug)
+        m_host->sync();
+
+    tlm_response_status rs = TLM_OK_RESPONSE;
+    sc_time latency = SC_ZERO_TIME;
+    const dmi_hint* hint = nullptr;
+    unsigned int total = 0;
+
+    for (const tlm_segment& seg : segments) {
+        if (seg.size == 0)
+            continue;
+
+        const range mem(seg.addr, seg.addr + seg.size - 1);
+        if (use_dmi) {
+            // consecutive segments usually share one DMI region
+            if (!hint || hint->generation != m_dmi_gen ||
+                mem.start < hint->start || mem.end > hint->end)
+                hint = find_dmi_hint(mem, rw);
+
+            if (hint) {
+                if (cmd == TLM_READ_COMMAND) {
+                    memcpy(seg.data, hint->base + seg.addr, seg.size);
+                    latency += hint->rdlat;
+                } else if (cmd == TLM_WRITE_COMMAND) {
+                    memcpy(hint->base + seg.addr, seg.data, seg.size);
+                    latency += hint->wrlat;
+                }
+
+                m_dmi_hits++;
+                if (info.is_debug) {
+                    m_stats.num_debug++;
+                } else {
+                    m_stats.num_dmi++;
+                    m_stats.num_bytes += seg.size;
+                }
+
+                total += seg.size;
+                continue;
+            }
+
+            m_dmi_misses++;
+        }
+
+        // regular transactions must start at the correct local time
+        if (!info.is_debug && latency != SC_ZERO_TIME) {
+            m_host->local_time() += latency;
+            latency = SC_ZERO_TIME;
+        }
+
+        auto& tx = info.is_debug ? m_txd : m_tx;
+        tx_setup(tx, cmd, seg.addr, seg.data, seg.size);
+        total += send(tx, sbi);
+
+        rs = tx.get_response_status();
+        if (rs == TLM_INCOMPLETE_RESPONSE && info.is_debug)
+            rs = TLM_OK_RESPONSE;
+
+        if (rs == TLM_INCOMPLETE_RESPONSE)
+            m_parent->log_warn("got incomplete response from 0x%016llx",
+                               seg.addr);
+
+        if (failed(rs))
+            break;
+
+        hint = nullptr;
+    }
+
+    if (!info.is_debug) {
+        m_host->local_time() += latency;
+        if (info.is_sync)
+            m_host->sync();
+    }
+
+    if (nbytes != nullptr)
+        *nbytes = total;
+
+    return rs;
+}
+
 void tlm_initiator_socket::stub(tlm_response_status r) {
     VCML_ERROR_ON(m_stub, "socket %s already stubbed", name());
     hierarchy_guard guard(m_parent);
@@ -239,8 +519,43 @@ void tlm_initiator_socket::stub(tlm_response_status r) {
     base_type::bind(m_stub->in);
 }
 
+void tlm_target_socket::b_transport_fast(tlm_generic_payload& tx,
+                                         sc_time& dt) {
+    if (tracer::any() || m_next != m_curr || m_exmon.has_locks() ||
+        (allow_dmi && m_dmi_cache) || m_heatmap) {
+        b_transport(tx, dt);
+        return;
+    }
+
+    tlm_sbi info = tx_get_sbi(tx);
+    if (info.is_excl) {
+        b_transport(tx, dt);
+        return;
+    }
+
+    m_next++;
+    m_payload = &tx;
+    m_sideband = info;
+
+    tx.set_dmi_allowed(false);
+    m_host->b_transport(*this, tx, dt);
+
+    m_stats.num_transactions++;
+    if (tx.is_response_ok())
+        m_stats.num_bytes += tx.get_data_length();
+    else if (tx.is_response_error())
+        m_stats.num_errors++;
+
+    m_curr++;
+    if (m_free_ev)
+        m_free_ev->notify();
+
+    m_payload = nullptr;
+    m_sideband = SBI_NONE;
+}
+
 void tlm_target_socket::b_transport_int(tlm_generic_payload& tx, sc_time& t) {
-    b_transport(tx, t);
+    (this->*m_dispatch)(tx, t);
 }
 
 unsigned int tlm_target_socket::transport_dbg_int(tlm_generic_payload& tx) {
@@ -263,12 +578,15 @@ void tlm_target_socket::b_transport(tlm_generic_payload& tx, sc_time& dt) {
 
     tx.set_dmi_allowed(false);
 
+    if (m_heatmap_pending && range(tx).overlaps(m_heatmap_dmi))
+        restore_heatmap();
+
     tlm_dmi dmi;
     if (allow_dmi && m_dmi_cache && m_dmi_cache->lookup(tx, dmi)) {
         if (tx_is_excl(tx) && tx.is_read()) {
             u64 lo = tx.get_address();
             u64 hi = lo + tx_size(tx) - 1;
-            (*this)->invalidate_direct_mem_ptr(lo, hi);
+            bw()->invalidate_direct_mem_ptr(lo, hi);
         } else {
             tx.set_dmi_allowed(true);
         }
@@ -279,6 +597,15 @@ void tlm_target_socket::b_transport(tlm_generic_payload& tx, sc_time& dt) {
     else
         tx.set_response_status(TLM_OK_RESPONSE);
 
+    if (m_heatmap)
+        m_heatmap->record(tx, m_sideband);
+
+    m_stats.num_transactions++;
+    if (tx.is_response_ok())
+        m_stats.num_bytes += tx.get_data_length();
+    else if (tx.is_response_error())
+        m_stats.num_errors++;
+
     m_curr++;
     if (m_free_ev)
         m_free_ev->notify();
@@ -292,6 +619,7 @@ void tlm_target_socket::b_transport(tlm_generic_payload& tx, sc_time& dt) {
 unsigned int tlm_target_socket::transport_dbg(tlm_generic_payload& tx) {
     m_payload = &tx;
     m_sideband = tx_get_sbi(tx) | SBI_DEBUG;
+    m_stats.num_debug++;
 
     unsigned int n = m_host->transport_dbg(*this, tx);
 
@@ -313,11 +641,17 @@ bool tlm_target_socket::get_dmi_ptr(tlm_generic_payload& tx, tlm_dmi& dmi) {
         !m_host->get_direct_mem_ptr(*this, tx, dmi))
         return false;
 
-    return m_exmon.override_dmi(tx, dmi);
+    if (!m_exmon.override_dmi(tx, dmi))
+        return false;
+
+    m_exmon.register_dmi(dmi);
+    m_stats.num_dmi++;
+    return true;
 }
 
 tlm_target_socket::tlm_target_socket(const char* nm, address_space a):
     simple_target_socket<tlm_target_socket>(nm),
+    tlm_trace_filter(this),
     m_curr(0),
     m_next(0),
     m_free_ev(nullptr),
@@ -327,11 +661,22 @@ tlm_target_socket::tlm_target_socket(const char* nm, address_space a):
     m_host(hierarchy_search<tlm_host>()),
     m_parent(hierarchy_search<module>()),
     m_adapter(nullptr),
+    m_bw(nullptr),
     m_payload(nullptr),
     m_sideband(SBI_NONE),
+    m_stats(),
+    m_heatmap(nullptr),
+    m_heatmap_timer(nullptr),
+    m_heatmap_period(),
+    m_heatmap_rng(0x9e3779b97f4a7c15ull),
+    m_heatmap_pending(false),
+    m_heatmap_dmi(),
+    m_dispatch(&tlm_target_socket::b_transport),
     trace_all(this, "trace", false),
     trace_errors(this, "trace_errors", false),
     allow_dmi(this, "allow_dmi", true),
+    m_trace_all(trace_all.get()),
+    m_trace_errors(trace_errors.get()),
     as(a) {
     VCML_ERROR_ON(!m_host, "socket '%s' declared outside module", nm);
 
@@ -346,6 +691,14 @@ tlm_target_socket::tlm_target_socket(const char* nm, address_space a):
     register_get_direct_mem_ptr(this, &tlm_target_socket::get_dmi_ptr_int);
 }
 
+void tlm_target_socket::end_of_elaboration() {
+    simple_target_socket<tlm_target_socket>::end_of_elaboration();
+
+    // subclasses that override b_transport must always be called
+    if (typeid(*this) == typeid(tlm_target_socket))
+        m_dispatch = &tlm_target_socket::b_transport_fast;
+}
+
 tlm_target_socket::~tlm_target_socket() {
     if (m_host)
         m_host->unregister_socket(this);
@@ -357,11 +710,88 @@ tlm_target_socket::~tlm_target_socket() {
         delete m_dmi_cache;
     if (m_free_ev)
         delete m_free_ev;
+    if (m_heatmap_timer)
+        delete m_heatmap_timer;
+    if (m_heatmap)
+        delete m_heatmap;
+}
+
+void tlm_target_socket::sample_heatmap() {
+    restore_heatmap();
+    m_heatmap_timer->reset(m_heatmap_period);
+
+    if (!m_dmi_cache || !allow_dmi)
+        return;
+
+    u64 pgsz = m_heatmap->page_size();
+    vector<tlm_dmi> entries = m_dmi_cache->get_entries();
+
+    auto num_pages = [&](const tlm_dmi& dmi) -> u64 {
+        u64 lo = m_heatmap->page_of(dmi.get_start_address());
+        u64 hi = m_heatmap->page_of(dmi.get_end_address());
+        return (hi - lo) / pgsz + 1;
+    };
+
+    u64 npages = 0;
+    for (const tlm_dmi& dmi : entries)
+        npages += num_pages(dmi);
+    if (npages == 0)
+        return;
+
+    m_heatmap_rng ^= m_heatmap_rng << 13;
+    m_heatmap_rng ^= m_heatmap_rng >> 7;
+    m_heatmap_rng ^= m_heatmap_rng << 17;
+    u64 pick = m_heatmap_rng % npages;
+
+    for (const tlm_dmi& dmi : entries) {
+        u64 n = num_pages(dmi);
+        if (pick >= n) {
+            pick -= n;
+            continue;
+        }
+
+        u64 page = m_heatmap->page_of(dmi.get_start_address()) + pick * pgsz;
+        u64 lo = max<u64>(page, dmi.get_start_address());
+        u64 hi = min<u64>(page + pgsz - 1, dmi.get_end_address());
+
+        tlm_dmi frag(dmi);
+        dmi_set_start_address(frag, lo);
+        frag.set_end_address(hi);
+
+        unmap_dmi(lo, hi);
+        m_heatmap_dmi = frag;
+        m_heatmap_pending = true;
+        m_heatmap->count_sample();
+        return;
+    }
+}
+
+void tlm_target_socket::restore_heatmap() {
+    if (m_heatmap_pending) {
+        m_heatmap_pending = false;
+        if (m_dmi_cache)
+            m_dmi_cache->insert(m_heatmap_dmi);
+    }
+}
+
+void tlm_target_socket::enable_heatmap(const sc_time& period, u64 pgsz) {
+    VCML_ERROR_ON(m_heatmap, "heatmap already enabled for %s", name());
+    m_heatmap = new tlm_heatmap(pgsz);
+    m_heatmap_period = period;
+    if (period > SC_ZERO_TIME) {
+        m_heatmap_timer = new deadline_timer([this]() { sample_heatmap(); });
+        m_heatmap_timer->reset(period);
+    }
 }
 
 void tlm_target_socket::unmap_dmi(u64 start, u64 end) {
+    // the host revoked dmi on its own, so it must not come back
+    if (m_heatmap_pending && m_heatmap_dmi.get_start_address() <= end &&
+        m_heatmap_dmi.get_end_address() >= start)
+        m_heatmap_pending = false;
+
     if (m_dmi_cache && m_dmi_cache->invalidate(start, end))
-        (*this)->invalidate_direct_mem_ptr(start, end);
+        bw()->invalidate_direct_mem_ptr(start, end);
 }
 
 void tlm_target_socket::remap_dmi(const sc_time& rd, const sc_time& wr) {
@@ -369,7 +799,7 @@ void tlm_target_socket::remap_dmi(const sc_time& rd, const sc_time& wr) {
         for (auto dmi : m_dmi_cache->get_entries()) {
             if (dmi.get_read_latency() != rd ||
                 dmi.get_write_latency() != wr) {
-                (*this)->invalidate_direct_mem_ptr(dmi.get_start_address(),
+                bw()->invalidate_direct_mem_ptr(dmi.get_start_address(),
                                                    dmi.get_end_address());
                 dmi.set_read_latency(rd);
                 dmi.set_write_latency(wr);
@@ -381,7 +811,7 @@ void tlm_target_socket::remap_dmi(const sc_time& rd, const sc_time& wr) {
 void tlm_target_socket::invalidate_dmi() {
     if (m_dmi_cache) {
         for (const tlm_dmi& dmi : m_dmi_cache->get_entries()) {
-            (*this)->invalidate_direct_mem_ptr(dmi.get_start_address(),
+            bw()->invalidate_direct_mem_ptr(dmi.get_start_address(),
                                                dmi.get_end_address());
         }
     }
@@ -464,6 +894,9 @@ tlm::tlm_base_target_socket<>& tlm_target(const sc_object& parent,
 }
 
 void tlm_stub(const sc_object& obj, const string& port) {
+    if (is_placeholder(obj))
+        return;
+
     sc_object* child = find_child(obj, port);
     VCML_ERROR_ON(!child, "%s.%s does not exist", obj.name(), port.c_str());
 
@@ -480,6 +913,9 @@ void tlm_stub(const sc_object& obj, const string& port) {
 }
 
 void tlm_stub(const sc_object& obj, const string& port, size_t idx) {
+    if (is_placeholder(obj))
+        return;
+
     sc_object* child = find_child(obj, port);
     VCML_ERROR_ON(!child, "%s.%s does not exist", obj.name(), port.c_str());
 
@@ -516,6 +952,12 @@ void tlm_stub(const sc_object& obj, const string& port, size_t idx) {
 
 void tlm_bind(const sc_object& obj1, const string& port1,
               const sc_object& obj2, const string& port2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        tlm_stub(obj1, port1);
+        tlm_stub(obj2, port2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
@@ -542,6 +984,12 @@ void tlm_bind(const sc_object& obj1, const string& port1,
 
 void tlm_bind(const sc_object& obj1, const string& port1,
               const sc_object& obj2, const string& port2, size_t idx2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        tlm_stub(obj1, port1);
+        tlm_stub(obj2, port2, idx2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
@@ -568,6 +1016,12 @@ void tlm_bind(const sc_object& obj1, const string& port1,
 
 void tlm_bind(const sc_object& obj1, const string& port1, size_t idx1,
               const sc_object& obj2, const string& port2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        tlm_stub(obj1, port1, idx1);
+        tlm_stub(obj2, port2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
@@ -594,6 +1048,12 @@ void tlm_bind(const sc_object& obj1, const string& port1, size_t idx1,
 
 void tlm_bind(const sc_object& obj1, const string& port1, size_t idx1,
               const sc_object& obj2, const string& port2, size_t idx2) {
+    if (is_placeholder(obj1) || is_placeholder(obj2)) {
+        tlm_stub(obj1, port1, idx1);
+        tlm_stub(obj2, port2, idx2);
+        return;
+    }
+
     auto* p1 = find_child(obj1, port1);
     auto* p2 = find_child(obj2, port2);
 
@@ -618,4 +1078,52 @@ void tlm_bind(const sc_object& obj1, const string& port1, size_t idx1,
         t1->bind(*t2);
 }
 
+static void print_stats(ostream& os, const char* name, const char* kind,
+                        const tlm_socket_stats& stats) {
+    os << name << "," << kind << "," << stats.num_transactions << ","
+       << stats.num_bytes << "," << stats.num_dmi << "," << stats.num_debug
+       << "," << stats.num_errors << std::endl;
+}
+
+static void print_stats(ostream& os, const sc_object* obj) {
+    if (auto* ini = dynamic_cast<const tlm_initiator_socket*>(obj))
+        print_stats(os, ini->name(), ini->kind(), ini->stats());
+    if (auto* tgt = dynamic_cast<const tlm_target_socket*>(obj))
+        print_stats(os, tgt->name(), tgt->kind(), tgt->stats());
+
+    for (const sc_object* child : obj->get_child_objects())
+        print_stats(os, child);
+}
+
+void tlm_print_stats(ostream& os, const sc_object* root) {
+    os << "socket,kind,transactions,bytes,dmi,debug,errors" << std::endl;
+    if (root) {
+        print_stats(os, root);
+        return;
+    }
+
+    for (const sc_object* obj : sc_core::sc_get_top_level_objects())
+        print_stats(os, obj);
+}
+
+static void reset_stats(sc_object* obj) {
+    if (auto* ini = dynamic_cast<tlm_initiator_socket*>(obj))
+        ini->reset_stats();
+    if (auto* tgt = dynamic_cast<tlm_target_socket*>(obj))
+        tgt->reset_stats();
+
+    for (sc_object* child : obj->get_child_objects())
+        reset_stats(child);
+}
+
+void tlm_reset_stats(sc_object* root) {
+    if (root) {
+        reset_stats(root);
+        return;
+    }
+
+    for (sc_object* obj : sc_core::sc_get_top_level_objects())
+        reset_stats(obj);
+}
+
 } // namespace vcml
@@ -0,0 +1,59 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/protocols/tlm_trace_filter.h"
+
+namespace vcml {
+
+bool tlm_trace_filter::match_response(tlm_response_status rs) const {
+    // accept both TLM_OK_RESPONSE and the short form ok
+    string name = to_lower(tlm_response_to_str(rs));
+    for (const string& resp : trace_responses) {
+        string filter = to_lower(resp);
+        if (filter == name || mkstr("tlm_%s_response", filter.c_str()) == name)
+            return true;
+    }
+
+    return false;
+}
+
+tlm_trace_filter::tlm_trace_filter(sc_object* parent):
+    m_count(0),
+    m_sampled(true),
+    trace_ranges(parent, "trace_ranges"),
+    trace_reads(parent, "trace_reads", true),
+    trace_writes(parent, "trace_writes", true),
+    trace_responses(parent, "trace_responses"),
+    trace_ratio(parent, "trace_ratio", 1) {
+    trace_ranges.inherit_default();
+    trace_reads.inherit_default();
+    trace_writes.inherit_default();
+    trace_responses.inherit_default();
+    trace_ratio.inherit_default();
+}
+
+bool tlm_trace_filter::trace_match(const tlm_generic_payload& tx) const {
+    if (tx.is_read() && !trace_reads)
+        return false;
+    if (tx.is_write() && !trace_writes)
+        return false;
+
+    if (trace_ranges.empty())
+        return true;
+
+    range addr(tx);
+    for (const range& r : trace_ranges)
+        if (r.overlaps(addr))
+            return true;
+
+    return false;
+}
+
+} // namespace vcml
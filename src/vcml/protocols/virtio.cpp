@@ -89,6 +89,43 @@ size_t vq_message::copy_in(void* ptr, size_t size, size_t offset) {
     return copied;
 }
 
+static size_t map_buffers(const virtio_dmifn& dmi,
+                          const vector<vq_message::vq_buffer>& buffers,
+                          vcml_access acs, vector<iovec>& iov, size_t size,
+                          size_t offset) {
+    size_t mapped = 0;
+
+    for (auto buf : buffers) {
+        if (size == 0u)
+            break;
+
+        if (offset >= buf.size) {
+            offset -= buf.size;
+            continue;
+        }
+
+        size_t n = min(size, buf.size - offset);
+        u8* ptr = dmi(buf.addr + offset, n, acs);
+        VCML_ERROR_ON(!ptr, "no DMI pointer for 0x%016llx", buf.addr);
+
+        offset = 0;
+
+        iov.push_back({ ptr, n });
+        mapped += n;
+        size -= n;
+    }
+
+    return mapped;
+}
+
+size_t vq_message::map_out(vector<iovec>& iov, size_t size, size_t offset) {
+    return map_buffers(dmi, out, VCML_ACCESS_WRITE, iov, size, offset);
+}
+
+size_t vq_message::map_in(vector<iovec>& iov, size_t size, size_t offset) {
+    return map_buffers(dmi, in, VCML_ACCESS_READ, iov, size, offset);
+}
+
 #define HEX(x)                                                                \
     "0x" << std::setfill('0') << std::setw(x > ~0u ? 16 : 8) << std::hex << x \
          << std::dec << std::setfill(' ')
@@ -133,7 +170,13 @@ virtqueue::virtqueue(const virtio_queue_desc& desc, virtio_dmifn dmi):
     addr_driver(desc.driver),
     addr_device(desc.device),
     has_event_idx(desc.has_event_idx),
+    m_unpublished(0),
+    m_tables(),
     notify(false),
+    deferred(false),
+    num_notify(0),
+    num_suppressed(0),
+    num_table_hits(0),
     vector(desc.vector),
     dmi(std::move(dmi)),
     parent(hierarchy_search<module>()),
@@ -142,7 +185,35 @@ virtqueue::virtqueue(const virtio_queue_desc& desc, virtio_dmifn dmi):
 }
 
 virtqueue::~virtqueue() {
-    // nothing to do
+    if (num_notify || num_suppressed) {
+        log_debug("%llu notifications sent, %llu suppressed", num_notify,
+                  num_suppressed);
+    }
+
+    if (num_table_hits)
+        log_debug("%llu indirect table lookups cached", num_table_hits);
+}
+
+u8* virtqueue::lookup_table(u64 addr, u64 len, vcml_access acs) {
+    table_entry& entry = m_tables[(addr >> 4) % TABLE_CACHE_SIZE];
+    if (entry.ptr && entry.addr == addr && entry.len >= len &&
+        (entry.acs & acs) == acs) {
+        num_table_hits++;
+        return entry.ptr;
+    }
+
+    u8* ptr = dmi(addr, len, acs);
+    if (ptr)
+        entry = { addr, len, acs, ptr };
+    return ptr;
+}
+
+void virtqueue::invalidate_tables(const range& mem) {
+    for (table_entry& entry : m_tables) {
+        range table(entry.addr, entry.addr + entry.len - 1);
+        if (entry.ptr && mem.overlaps(table))
+            entry.ptr = nullptr;
+    }
 }
 
 bool virtqueue::get(vq_message& msg) {
@@ -170,13 +241,39 @@ bool virtqueue::put(vq_message& msg) {
 
     parent->record(TRACE_BW_NOINDENT, *this, msg);
     msg.status = do_put(msg);
-    return success(msg);
+    if (!success(msg))
+        return false;
+
+    m_unpublished++;
+    notify = false;
+    if (!deferred)
+        publish();
+
+    return true;
+}
+
+bool virtqueue::publish() {
+    notify = false;
+    if (!m_unpublished || !validate())
+        return false;
+
+    notify = do_publish();
+    if (notify) {
+        num_notify++;
+        num_suppressed += m_unpublished - 1;
+    } else {
+        num_suppressed += m_unpublished;
+    }
+
+    m_unpublished = 0;
+    return notify;
 }
 
 split_virtqueue::split_virtqueue(const virtio_queue_desc& queue_desc,
                                  virtio_dmifn dmifn):
     virtqueue(queue_desc, std::move(dmifn)),
     m_last_avail_idx(0),
+    m_used_pending(0),
     m_desc(nullptr),
     m_avail(nullptr),
     m_used(nullptr),
@@ -235,6 +332,8 @@ void split_virtqueue::invalidate(const range& mem) {
         m_avail = nullptr;
     if (mem.overlaps(device))
         m_used = nullptr;
+
+    invalidate_tables(mem);
 }
 
 virtio_status split_virtqueue::do_get(vq_message& msg) {
@@ -250,6 +349,12 @@ virtio_status split_virtqueue::do_get(vq_message& msg) {
     if (m_avail_ev)
         *m_avail_ev = m_last_avail_idx;
 
+    // warm up the head of the next chain while this one gets processed
+    if (m_last_avail_idx != m_avail->idx) {
+        u16 next = m_avail->ring[m_last_avail_idx % size];
+        __builtin_prefetch(m_desc + next % size);
+    }
+
     u32 count = 0;
     u32 limit = size;
 
@@ -263,7 +368,7 @@ virtio_status split_virtqueue::do_get(vq_message& msg) {
         }
 
         limit = desc->len / sizeof(vq_desc);
-        desc = base = (vq_desc*)lookup_desc_ptr(desc);
+        desc = base = lookup_indirect(desc);
 
         if (!desc) {
             log_warn("cannot access indirect descriptor");
@@ -302,23 +407,32 @@ virtio_status split_virtqueue::do_get(vq_message& msg) {
 }
 
 virtio_status split_virtqueue::do_put(vq_message& msg) {
-    notify = false;
-
     if (msg.index >= size) {
         log_warn("index out of bounds: %u", msg.index);
         return VIRTIO_ERR_DESC;
     }
 
-    if ((m_used_ev && *m_used_ev == m_used->idx) || !m_avail->no_irq())
-        notify = true;
-
-    m_used->ring[m_used->idx % size].id = msg.index;
-    m_used->ring[m_used->idx % size].len = msg.length();
-    m_used->idx++;
+    // the used index itself is only updated once the buffer gets published
+    u16 idx = m_used->idx + m_used_pending++;
+    m_used->ring[idx % size].id = msg.index;
+    m_used->ring[idx % size].len = msg.length();
 
     return VIRTIO_OK;
 }
 
+bool split_virtqueue::do_publish() {
+    u16 old_idx = m_used->idx;
+    u16 new_idx = old_idx + m_used_pending;
+
+    m_used->idx = new_idx;
+    m_used_pending = 0;
+
+    // with event index the avail ring flags are ignored
+    if (m_used_ev)
+        return need_event(*m_used_ev, new_idx, old_idx);
+    return !m_avail->no_irq();
+}
+
 packed_virtqueue::packed_virtqueue(const virtio_queue_desc& queue_desc,
                                    virtio_dmifn dmifn):
     virtqueue(queue_desc, std::move(dmifn)),
@@ -327,7 +441,8 @@ packed_virtqueue::packed_virtqueue(const virtio_queue_desc& queue_desc,
     m_driver(nullptr),
     m_device(nullptr),
     m_wrap_get(true),
-    m_wrap_put(true) {
+    m_wrap_put(true),
+    m_notify_pending(false) {
     if (!addr_desc || !addr_driver || !addr_device)
         log_warn("invalid virtqueue ring addresses");
 }
@@ -337,25 +452,22 @@ packed_virtqueue::~packed_virtqueue() {
 }
 
 bool packed_virtqueue::validate() {
-    if (m_desc && ((m_driver && m_device) || !has_event_idx))
+    if (m_desc && m_driver && m_device)
         return true;
 
+    // event suppression areas are mandatory for packed virtqueues
     if (!m_desc)
         m_desc = (vq_desc*)dmi(addr_desc, dscsz(), VCML_ACCESS_READ_WRITE);
 
-    if (!m_driver && has_event_idx)
+    if (!m_driver)
         m_driver = (vq_event*)dmi(addr_driver, drvsz(), VCML_ACCESS_READ);
 
-    if (!m_device && has_event_idx)
+    if (!m_device)
         m_device = (vq_event*)dmi(addr_device, devsz(), VCML_ACCESS_WRITE);
 
-    if (!m_desc || (has_event_idx && (!m_driver || !m_device))) {
+    if (!m_desc || !m_driver || !m_device) {
         log_warn("failed to get DMI pointers for packed virtqueue");
         log_warn("  descriptors at 0x%llx -> %p", addr_desc, m_desc);
-
-        if (!has_event_idx)
-            return false;
-
         log_warn("  driver events at 0x%llx -> %p", addr_driver, m_driver);
         log_warn("  device events at 0x%llx -> %p", addr_device, m_device);
         return false;
@@ -363,11 +475,8 @@ bool packed_virtqueue::validate() {
 
     log_debug("created packed virtqueue %u with size %u", id, limit);
     log_debug("  descriptors at 0x%llx -> %p", addr_desc, m_desc);
-
-    if (m_driver)
-        log_debug("  driver events at 0x%llx -> %p", addr_driver, m_driver);
-    if (m_device)
-        log_debug("  device events at 0x%llx -> %p", addr_device, m_device);
+    log_debug("  driver events at 0x%llx -> %p", addr_driver, m_driver);
+    log_debug("  device events at 0x%llx -> %p", addr_device, m_device);
 
     return true;
 }
@@ -383,6 +492,8 @@ void packed_virtqueue::invalidate(const range& mem) {
         m_driver = nullptr;
     if (mem.overlaps(device))
         m_device = nullptr;
+
+    invalidate_tables(mem);
 }
 
 virtio_status packed_virtqueue::do_get(vq_message& msg) {
@@ -407,7 +518,7 @@ virtio_status packed_virtqueue::do_get(vq_message& msg) {
 
         index = 0;
         limit = desc->len / sizeof(vq_desc);
-        desc = base = (vq_desc*)lookup_desc_ptr(desc);
+        desc = base = lookup_indirect(desc);
 
         if (!desc) {
             log_warn("cannot access indirect descriptor");
@@ -466,7 +577,8 @@ virtio_status packed_virtqueue::do_put(vq_message& msg) {
     vq_desc* base = m_desc;
     vq_desc* desc = base + index;
 
-    notify = m_driver->should_notify(index);
+    // descriptors become visible right away, so check every one of them
+    m_notify_pending |= should_notify(index, m_wrap_put);
 
     if (desc->is_indirect()) {
         if (!desc->len || desc->len % sizeof(vq_desc)) {
@@ -476,7 +588,7 @@ virtio_status packed_virtqueue::do_put(vq_message& msg) {
 
         index = 0;
         limit = desc->len / sizeof(vq_desc);
-        desc = base = (vq_desc*)lookup_desc_ptr(desc);
+        desc = base = lookup_indirect(desc);
 
         if (!desc) {
             log_warn("cannot access indirect descriptor");
@@ -505,6 +617,12 @@ virtio_status packed_virtqueue::do_put(vq_message& msg) {
     }
 }
 
+bool packed_virtqueue::do_publish() {
+    bool result = m_notify_pending;
+    m_notify_pending = false;
+    return result;
+}
+
 virtio_base_initiator_socket::virtio_base_initiator_socket(const char* nm):
     virtio_base_initiator_socket_b(nm, VCML_AS_DEFAULT), m_stub(nullptr) {
 }
@@ -41,12 +41,28 @@ const char* protocol_name(protocol_kind kind) {
     }
 }
 
+atomic<size_t> tracer::s_active(0);
+atomic<bool> tracer::s_paused(false);
+
 tracer::tracer(): m_mtx() {
     all().insert(this);
+    s_active++;
 }
 
 tracer::~tracer() {
     all().erase(this);
+    s_active--;
+}
+
+void tracer::record_slice(const sc_object& obj, const char* name,
+                          const sc_time& start, const sc_time& end) {
+    if (paused())
+        return;
+
+    for (tracer* tr : tracer::all()) {
+        lock_guard<mutex> guard(tr->m_mtx);
+        tr->trace_slice(obj, name, start, end);
+    }
 }
 
 void tracer::print_timing(ostream& os, const sc_time& time, u64 delta) {
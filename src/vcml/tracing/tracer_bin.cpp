@@ -0,0 +1,387 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/protocols/tlm.h"
+#include "vcml/protocols/gpio.h"
+#include "vcml/protocols/clk.h"
+#include "vcml/protocols/sd.h"
+#include "vcml/protocols/spi.h"
+#include "vcml/protocols/i2c.h"
+#include "vcml/protocols/pci.h"
+#include "vcml/protocols/eth.h"
+#include "vcml/protocols/can.h"
+#include "vcml/protocols/serial.h"
+#include "vcml/protocols/virtio.h"
+
+#include "vcml/tracing/tracer_bin.h"
+
+#include <stdio.h>
+#include <chrono>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace vcml {
+
+static_assert(sizeof(tracer_bin::record) == 32, "unexpected record layout");
+
+struct tlm_record {
+    u64 addr;
+    u32 length;
+    i32 response;
+    u8 command;
+    u8 reserved[7];
+};
+
+struct gpio_record {
+    u64 vector;
+    u64 state;
+};
+
+struct clk_record {
+    hz_t oldhz;
+    hz_t newhz;
+};
+
+// trace files are gzip compressed if zlib is available, zlib also reads
+// uncompressed files, so traces can always be decoded by a zlib build
+class trace_file
+{
+private:
+#ifdef HAVE_ZLIB
+    gzFile m_file;
+#else
+    FILE* m_file;
+#endif
+
+public:
+    trace_file(const string& filename, bool write) {
+#ifdef HAVE_ZLIB
+        m_file = gzopen(filename.c_str(), write ? "wb1" : "rb");
+#else
+        m_file = fopen(filename.c_str(), write ? "wb" : "rb");
+#endif
+        VCML_ERROR_ON(!m_file, "failed to open %s", filename.c_str());
+    }
+
+    ~trace_file() {
+#ifdef HAVE_ZLIB
+        gzclose(m_file);
+#else
+        fclose(m_file);
+#endif
+    }
+
+    void write(const void* data, size_t size) {
+#ifdef HAVE_ZLIB
+        VCML_ERROR_ON(gzwrite(m_file, data, size) != (int)size,
+                      "error writing trace file");
+#else
+        VCML_ERROR_ON(fwrite(data, 1, size, m_file) != size,
+                      "error writing trace file");
+#endif
+    }
+
+    bool read(void* data, size_t size) {
+#ifdef HAVE_ZLIB
+        return gzread(m_file, data, size) == (int)size;
+#else
+        return fread(data, 1, size, m_file) == size;
+#endif
+    }
+};
+
+void tracer_bin::push(const void* data, size_t size) {
+    const u8* src = (const u8*)data;
+    const u64 capacity = m_ring.size();
+
+    while (size > 0) {
+        u64 head = m_head.load(std::memory_order_relaxed);
+        u64 tail = m_tail.load(std::memory_order_acquire);
+        u64 space = capacity - (head - tail);
+        if (space == 0) {
+            mwr::cpu_yield();
+            continue;
+        }
+
+        u64 pos = head & (capacity - 1);
+        u64 n = min<u64>(min<u64>(size, space), capacity - pos);
+        memcpy(m_ring.data() + pos, src, n);
+        m_head.store(head + n, std::memory_order_release);
+
+        src += n;
+        size -= n;
+    }
+}
+
+void tracer_bin::push_record(const record& rec, const void* data,
+                             size_t size) {
+    push(&rec, sizeof(rec));
+    if (size > 0)
+        push(data, size);
+}
+
+u32 tracer_bin::port_id(const sc_object& port) {
+    auto it = m_ports.find(&port);
+    if (it != m_ports.end())
+        return it->second;
+
+    u32 id = (u32)m_ports.size();
+    m_ports[&port] = id;
+
+    const char* name = port.name();
+    size_t len = strlen(name);
+
+    record rec = {};
+    rec.size = sizeof(rec) + len;
+    rec.port = id;
+    rec.type = RECORD_PORT;
+    push_record(rec, name, len);
+    return id;
+}
+
+template <typename PAYLOAD>
+tracer_bin::record tracer_bin::make_record(const activity<PAYLOAD>& msg,
+                                           record_type type) {
+    record rec = {};
+    rec.size = sizeof(rec);
+    rec.port = port_id(msg.port);
+    rec.type = type;
+    rec.kind = msg.kind;
+    rec.dir = (i8)msg.dir;
+    rec.error = msg.error;
+    rec.time_ns = time_to_ns(msg.t);
+    rec.delta = msg.cycle;
+    return rec;
+}
+
+template <typename PAYLOAD>
+void tracer_bin::trace_text(const activity<PAYLOAD>& msg) {
+    string text = to_string(msg.payload);
+    record rec = make_record(msg, RECORD_TEXT);
+    rec.size += text.length();
+    push_record(rec, text.c_str(), text.length());
+}
+
+void tracer_bin::write_thread() {
+    trace_file file(m_filename, true);
+    const u32 header[2] = { MAGIC, VERSION };
+    file.write(header, sizeof(header));
+
+    const u64 capacity = m_ring.size();
+    while (true) {
+        bool running = m_running;
+        u64 head = m_head.load(std::memory_order_acquire);
+        u64 tail = m_tail.load(std::memory_order_relaxed);
+
+        if (head == tail) {
+            if (!running)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        u64 pos = tail & (capacity - 1);
+        u64 n = min<u64>(head - tail, capacity - pos);
+        file.write(m_ring.data() + pos, n);
+        m_tail.store(tail + n, std::memory_order_release);
+    }
+}
+
+void tracer_bin::trace(const activity<tlm_generic_payload>& msg) {
+    const tlm_generic_payload& tx = msg.payload;
+
+    tlm_record tlm = {};
+    tlm.addr = tx.get_address();
+    tlm.length = tx.get_data_length();
+    tlm.response = tx.get_response_status();
+    tlm.command = tx.get_command();
+
+    size_t size = tx.get_data_ptr() ? tlm.length : 0;
+    record rec = make_record(msg, RECORD_TLM);
+    rec.size += sizeof(tlm) + size;
+
+    push_record(rec, &tlm, sizeof(tlm));
+    if (size > 0)
+        push(tx.get_data_ptr(), size);
+}
+
+void tracer_bin::trace(const activity<gpio_payload>& msg) {
+    gpio_record gpio = { msg.payload.vector, msg.payload.state };
+    record rec = make_record(msg, RECORD_GPIO);
+    rec.size += sizeof(gpio);
+    push_record(rec, &gpio, sizeof(gpio));
+}
+
+void tracer_bin::trace(const activity<clk_payload>& msg) {
+    clk_record clk = { msg.payload.oldhz, msg.payload.newhz };
+    record rec = make_record(msg, RECORD_CLK);
+    rec.size += sizeof(clk);
+    push_record(rec, &clk, sizeof(clk));
+}
+
+void tracer_bin::trace(const activity<pci_payload>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<i2c_payload>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<spi_payload>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<sd_command>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<sd_data>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<vq_message>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<serial_payload>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<eth_frame>& msg) {
+    trace_text(msg);
+}
+
+void tracer_bin::trace(const activity<can_frame>& msg) {
+    trace_text(msg);
+}
+
+tracer_bin::tracer_bin(const string& filename, size_t ring_size):
+    tracer(),
+    m_filename(filename),
+    m_ports(),
+    m_ring(ring_size),
+    m_head(0),
+    m_tail(0),
+    m_running(true),
+    m_writer() {
+    VCML_ERROR_ON(ring_size == 0 || !is_pow2(ring_size),
+                  "trace buffer size must be a power of two");
+
+    // make sure the file can be opened before the writer thread starts
+    ofstream probe(filename, std::ios::binary | std::ios::trunc);
+    VCML_ERROR_ON(!probe, "failed to open %s", filename.c_str());
+    probe.close();
+
+    m_writer = thread(&tracer_bin::write_thread, this);
+    mwr::set_thread_name(m_writer, "trace_writer");
+}
+
+tracer_bin::~tracer_bin() {
+    m_running = false;
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
+static void print_record(ostream& os, const tracer_bin::record& rec,
+                         const string& port, const string& text) {
+    for (const string& line : split(text, '\n')) {
+        os << "[" << protocol_name((protocol_kind)rec.kind);
+        mwr::publisher::print_timing(os, rec.time_ns);
+        os << "] " << port;
+
+        if (is_forward_trace((trace_direction)rec.dir))
+            os << " >> ";
+
+        if (is_backward_trace((trace_direction)rec.dir))
+            os << " << ";
+
+        os << line << std::endl;
+    }
+}
+
+size_t tracer_bin::decode(const string& filename, ostream& os) {
+    trace_file file(filename, false);
+
+    u32 header[2] = {};
+    if (!file.read(header, sizeof(header)) || header[0] != MAGIC)
+        VCML_ERROR("%s is not a binary trace file", filename.c_str());
+    if (header[1] != VERSION)
+        VCML_ERROR("unsupported trace file version %u", header[1]);
+
+    size_t count = 0;
+    unordered_map<u32, string> ports;
+    vector<u8> payload;
+
+    record rec;
+    while (file.read(&rec, sizeof(rec))) {
+        VCML_ERROR_ON(rec.size < sizeof(rec), "corrupt trace record");
+        payload.resize(rec.size - sizeof(rec));
+        if (!payload.empty() && !file.read(payload.data(), payload.size()))
+            VCML_ERROR("trace file %s truncated", filename.c_str());
+
+        const string& port = ports[rec.port];
+        switch (rec.type) {
+        case RECORD_PORT:
+            ports[rec.port] = string(payload.begin(), payload.end());
+            continue;
+
+        case RECORD_TLM: {
+            tlm_record tlm;
+            VCML_ERROR_ON(payload.size() < sizeof(tlm), "corrupt tlm record");
+            memcpy(&tlm, payload.data(), sizeof(tlm));
+
+            tlm_generic_payload tx;
+            tx.set_command((tlm_command)tlm.command);
+            tx.set_address(tlm.addr);
+            tx.set_data_ptr(payload.data() + sizeof(tlm));
+            tx.set_data_length(tlm.length);
+            tx.set_response_status((tlm_response_status)tlm.response);
+            if (payload.size() - sizeof(tlm) < tlm.length)
+                tx.set_data_length(payload.size() - sizeof(tlm));
+            print_record(os, rec, port, to_string(tx));
+            tx.set_data_ptr(nullptr);
+            break;
+        }
+
+        case RECORD_GPIO: {
+            gpio_record gpio;
+            VCML_ERROR_ON(payload.size() < sizeof(gpio), "corrupt gpio record");
+            memcpy(&gpio, payload.data(), sizeof(gpio));
+            gpio_payload tx = { (gpio_vector)gpio.vector, gpio.state != 0 };
+            print_record(os, rec, port, to_string(tx));
+            break;
+        }
+
+        case RECORD_CLK: {
+            clk_record clk;
+            VCML_ERROR_ON(payload.size() < sizeof(clk), "corrupt clk record");
+            memcpy(&clk, payload.data(), sizeof(clk));
+            clk_payload tx = { clk.oldhz, clk.newhz };
+            print_record(os, rec, port, to_string(tx));
+            break;
+        }
+
+        case RECORD_TEXT:
+            print_record(os, rec, port, string(payload.begin(), payload.end()));
+            break;
+
+        default:
+            VCML_ERROR("unknown trace record type %hhu", rec.type);
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+} // namespace vcml
@@ -0,0 +1,290 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/protocols/tlm.h"
+#include "vcml/protocols/gpio.h"
+#include "vcml/protocols/clk.h"
+#include "vcml/protocols/sd.h"
+#include "vcml/protocols/spi.h"
+#include "vcml/protocols/i2c.h"
+#include "vcml/protocols/pci.h"
+#include "vcml/protocols/eth.h"
+#include "vcml/protocols/can.h"
+#include "vcml/protocols/serial.h"
+#include "vcml/protocols/virtio.h"
+
+#include "vcml/tracing/tracer_chrome.h"
+
+namespace vcml {
+
+static void json_escape(ostream& os, const string& str) {
+    for (char c : str) {
+        switch (c) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+                os << mkstr("\\u%04x", (unsigned int)c);
+            else
+                os << c;
+        }
+    }
+}
+
+static void json_time(ostream& os, u64 ns) {
+    // chrome trace timestamps are in microseconds
+    os << ns / 1000 << "." << std::setfill('0') << std::setw(3) << ns % 1000
+       << std::setfill(' ');
+}
+
+u32 tracer_chrome::track_id(const sc_object& obj) {
+    auto it = m_tracks.find(&obj);
+    if (it != m_tracks.end())
+        return it->second;
+
+    u32 id = (u32)m_tracks.size() + 1;
+    m_tracks[&obj] = id;
+
+    event ev = {};
+    ev.phase = 'M';
+    ev.track = id;
+    ev.name = obj.name();
+    push(std::move(ev));
+    return id;
+}
+
+void tracer_chrome::push(event&& ev) {
+    m_events.push_back(std::move(ev));
+    if (m_events.size() >= BATCH_SIZE)
+        flush();
+}
+
+void tracer_chrome::flush() {
+    if (m_events.empty())
+        return;
+
+    vector<event> batch;
+    batch.reserve(BATCH_SIZE);
+    batch.swap(m_events);
+
+    lock_guard<mutex> guard(m_batch_mtx);
+    m_batches.push_back(std::move(batch));
+    m_cv.notify_one();
+}
+
+void tracer_chrome::write_event(const event& ev) {
+    m_stream << (m_first ? "[\n" : ",\n");
+    m_first = false;
+
+    if (ev.phase == 'M') {
+        m_stream << "{\"ph\":\"M\",\"pid\":0,\"tid\":" << ev.track
+                 << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+        json_escape(m_stream, ev.name);
+        m_stream << "\"}}";
+        return;
+    }
+
+    m_stream << "{\"ph\":\"" << ev.phase << "\",\"pid\":0,\"tid\":"
+             << ev.track << ",\"ts\":";
+    json_time(m_stream, ev.time_ns);
+
+    if (ev.phase == 'X') {
+        m_stream << ",\"dur\":";
+        json_time(m_stream, ev.duration_ns);
+    }
+
+    if (ev.phase == 'i')
+        m_stream << ",\"s\":\"t\"";
+
+    if (ev.phase != 'E') {
+        const char* cat = "processor";
+        if (ev.kind < NUM_PROTOCOLS)
+            cat = protocol_name(ev.kind);
+
+        m_stream << ",\"name\":\"";
+        json_escape(m_stream, ev.name);
+        m_stream << "\",\"cat\":\"" << cat << "\"";
+    }
+
+    if (ev.phase == 'C') {
+        m_stream << ",\"args\":{\"level\":" << ev.value << "}}";
+        return;
+    }
+
+    m_stream << ",\"args\":{";
+    if (!ev.args.empty()) {
+        m_stream << "\"desc\":\"";
+        json_escape(m_stream, ev.args);
+        m_stream << "\"";
+    }
+
+    if (ev.error)
+        m_stream << (ev.args.empty() ? "" : ",") << "\"error\":true";
+    m_stream << "}}";
+}
+
+void tracer_chrome::write_thread() {
+    std::unique_lock<mutex> lock(m_batch_mtx);
+    while (true) {
+        m_cv.wait(lock, [&]() { return !m_running || !m_batches.empty(); });
+        if (m_batches.empty())
+            break;
+
+        vector<event> batch = std::move(m_batches.front());
+        m_batches.pop_front();
+
+        lock.unlock();
+        for (const event& ev : batch)
+            write_event(ev);
+        lock.lock();
+    }
+
+    m_stream << (m_first ? "[\n" : "\n") << "]" << std::endl;
+}
+
+template <typename PAYLOAD>
+void tracer_chrome::do_trace(const activity<PAYLOAD>& msg) {
+    event ev = {};
+    ev.track = track_id(msg.port);
+    ev.time_ns = time_to_ns(msg.t);
+    ev.kind = msg.kind;
+    ev.error = msg.error;
+
+    // protocols that trace both directions become slices, all others are
+    // shown as instant events on the track of their port
+    if (protocol<PAYLOAD>::TRACE_FW && protocol<PAYLOAD>::TRACE_BW)
+        ev.phase = is_forward_trace(msg.dir) ? 'B' : 'E';
+    else
+        ev.phase = 'i';
+
+    if (ev.phase != 'E' || msg.error) {
+        ev.args = to_string(msg.payload);
+        ev.name = ev.args.substr(0, ev.args.find_first_of("\n["));
+        ev.name = trim(ev.name);
+    }
+
+    push(std::move(ev));
+}
+
+void tracer_chrome::trace(const activity<tlm_generic_payload>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<gpio_payload>& msg) {
+    // gpio lines are shown as counters holding the current signal level
+    if (!is_forward_trace(msg.dir))
+        return;
+
+    event ev = {};
+    ev.phase = 'C';
+    ev.track = track_id(msg.port);
+    ev.time_ns = time_to_ns(msg.t);
+    ev.value = msg.payload.state;
+    ev.kind = msg.kind;
+    ev.name = msg.port.name();
+    if (msg.payload.vector != GPIO_NO_VECTOR)
+        ev.name += mkstr("[%zu]", msg.payload.vector);
+    push(std::move(ev));
+}
+
+void tracer_chrome::trace(const activity<clk_payload>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<pci_payload>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<i2c_payload>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<spi_payload>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<sd_command>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<sd_data>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<vq_message>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<serial_payload>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<eth_frame>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace(const activity<can_frame>& msg) {
+    do_trace(msg);
+}
+
+void tracer_chrome::trace_slice(const sc_object& obj, const char* name,
+                                const sc_time& start, const sc_time& end) {
+    event ev = {};
+    ev.phase = 'X';
+    ev.track = track_id(obj);
+    ev.time_ns = time_to_ns(start);
+    ev.duration_ns = end > start ? time_to_ns(end - start) : 0;
+    ev.kind = NUM_PROTOCOLS;
+    ev.name = name;
+    push(std::move(ev));
+}
+
+tracer_chrome::tracer_chrome(const string& filename):
+    tracer(),
+    m_filename(filename),
+    m_stream(filename.c_str()),
+    m_tracks(),
+    m_events(),
+    m_first(true),
+    m_batch_mtx(),
+    m_cv(),
+    m_batches(),
+    m_running(true),
+    m_writer() {
+    VCML_ERROR_ON(!m_stream.is_open(), "failed to open %s", filename.c_str());
+    m_events.reserve(BATCH_SIZE);
+    m_writer = thread(&tracer_chrome::write_thread, this);
+    mwr::set_thread_name(m_writer, "trace_writer");
+}
+
+tracer_chrome::~tracer_chrome() {
+    flush();
+
+    {
+        lock_guard<mutex> guard(m_batch_mtx);
+        m_running = false;
+        m_cv.notify_one();
+    }
+
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
+} // namespace vcml
@@ -22,6 +22,8 @@
 
 #include "vcml/tracing/tracer_term.h"
 
+#include <chrono>
+
 namespace vcml {
 
 size_t tracer_term::trace_name_length = 16;
@@ -42,45 +44,79 @@ array<const char*, NUM_PROTOCOLS> tracer_term::colors = {
     /* [PROTO_CAN]      = */ mwr::termcolors::RED,
 };
 
-template <typename PAYLOAD>
-void tracer_term::do_trace(const activity<PAYLOAD>& msg) {
-    VCML_ERROR_ON(!m_os.good(), "trace stream broken");
-
-    stringstream ss;
+void tracer_term::print(ostream& os, const entry& e) const {
     if (m_colors)
-        ss << colors[msg.kind];
+        os << colors[e.kind];
 
-    string sender = msg.port.name();
-    if (trace_name_length < sender.length())
-        trace_name_length = sender.length();
-
-    if (msg.dir == TRACE_FW)
-        trace_curr_indent += trace_indent_incr;
-
-    vector<string> lines = split(to_string(msg.payload), '\n');
+    vector<string> lines = split(e.payload, '\n');
     for (const string& line : lines) {
-        ss << "[" << protocol_name(msg.kind);
-        print_timing(ss, msg.t, msg.cycle);
-        ss << "] " << sender;
+        os << "[" << protocol_name(e.kind);
+        print_timing(os, e.t, e.cycle);
+        os << "] " << e.sender;
 
-        if (trace_name_length > sender.length())
-            ss << string(trace_name_length - sender.length(), ' ');
+        if (e.name_length > e.sender.length())
+            os << string(e.name_length - e.sender.length(), ' ');
 
-        ss << string(trace_curr_indent, ' ');
+        os << string(e.indent, ' ');
 
-        if (is_forward_trace(msg.dir))
-            ss << ">> ";
+        if (is_forward_trace(e.dir))
+            os << ">> ";
 
-        if (is_backward_trace(msg.dir))
-            ss << "<< ";
+        if (is_backward_trace(e.dir))
+            os << "<< ";
 
-        ss << line << std::endl;
+        os << line << "\n";
     }
 
     if (m_colors)
-        ss << mwr::termcolors::CLEAR;
+        os << mwr::termcolors::CLEAR;
+}
+
+void tracer_term::write_thread() {
+    std::unique_lock<mutex> lock(m_mtx);
+    while (m_running || !m_entries.empty()) {
+        m_cv.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+                      [&]() {
+                          return !m_running ||
+                                 m_entries.size() >= BATCH_SIZE;
+                      });
+
+        if (m_entries.empty())
+            continue;
+
+        vector<entry> batch;
+        batch.reserve(BATCH_SIZE);
+        batch.swap(m_entries);
+
+        lock.unlock();
+        stringstream ss;
+        for (const entry& e : batch)
+            print(ss, e);
+        m_os << ss.rdbuf() << std::flush;
+        lock.lock();
+    }
+}
 
-    m_os << ss.rdbuf() << std::flush;
+template <typename PAYLOAD>
+void tracer_term::do_trace(const activity<PAYLOAD>& msg) {
+    VCML_ERROR_ON(!m_os.good(), "trace stream broken");
+
+    entry e;
+    e.kind = msg.kind;
+    e.dir = msg.dir;
+    e.sender = msg.port.name();
+    e.payload = to_string(msg.payload);
+    e.t = msg.t;
+    e.cycle = msg.cycle;
+
+    if (trace_name_length < e.sender.length())
+        trace_name_length = e.sender.length();
+
+    if (msg.dir == TRACE_FW)
+        trace_curr_indent += trace_indent_incr;
+
+    e.name_length = trace_name_length;
+    e.indent = trace_curr_indent;
 
     if (msg.dir == TRACE_BW && trace_curr_indent) {
         if (trace_curr_indent >= trace_indent_incr)
@@ -88,6 +124,18 @@ void tracer_term::do_trace(const activity<PAYLOAD>& msg) {
         else
             trace_curr_indent = 0;
     }
+
+    if (m_buffered) {
+        lock_guard<mutex> guard(m_mtx);
+        m_entries.push_back(std::move(e));
+        if (m_entries.size() == BATCH_SIZE)
+            m_cv.notify_one();
+        return;
+    }
+
+    stringstream ss;
+    print(ss, e);
+    m_os << ss.rdbuf() << std::flush;
 }
 
 void tracer_term::trace(const activity<tlm_generic_payload>& msg) {
@@ -146,12 +194,33 @@ tracer_term::tracer_term(bool use_cerr):
     tracer_term(use_cerr, use_colors(use_cerr)) {
 }
 
-tracer_term::tracer_term(bool use_cerr, bool use_colors):
-    tracer(), m_colors(use_colors), m_os(use_cerr ? std::cerr : std::cout) {
+tracer_term::tracer_term(bool use_cerr, bool use_colors, bool buffered):
+    tracer(),
+    m_colors(use_colors),
+    m_buffered(buffered),
+    m_os(use_cerr ? std::cerr : std::cout),
+    m_mtx(),
+    m_cv(),
+    m_entries(),
+    m_running(buffered),
+    m_writer() {
+    if (m_buffered) {
+        m_entries.reserve(BATCH_SIZE);
+        m_writer = thread(&tracer_term::write_thread, this);
+        mwr::set_thread_name(m_writer, "trace_term");
+    }
 }
 
 tracer_term::~tracer_term() {
-    // nothing to do
+    {
+        lock_guard<mutex> guard(m_mtx);
+        m_running = false;
+        m_cv.notify_one();
+    }
+
+    // writes out whatever is still buffered
+    if (m_writer.joinable())
+        m_writer.join();
 }
 
 } // namespace vcml
@@ -0,0 +1,253 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/version.h"
+
+#include "vcml/protocols/tlm.h"
+#include "vcml/protocols/gpio.h"
+#include "vcml/protocols/clk.h"
+
+#include "vcml/tracing/tracer_vcd.h"
+
+namespace vcml {
+
+static string vcd_identifier(u32 idx) {
+    // vcd identifiers use the printable ascii characters from ! to ~
+    string id;
+    do {
+        id += (char)('!' + idx % 94);
+        idx /= 94;
+    } while (idx > 0);
+    return id;
+}
+
+static void vcd_split(const sc_object& obj, string& scope, string& name) {
+    string full = obj.name();
+    size_t pos = full.rfind('.');
+    if (pos == string::npos) {
+        scope = "";
+        name = full;
+    } else {
+        scope = full.substr(0, pos);
+        name = full.substr(pos + 1);
+    }
+}
+
+static u64 vcd_time_ps(const sc_time& t) {
+    return t.value() / sc_time(1.0, SC_PS).value();
+}
+
+u32 tracer_vcd::signal_id(const sc_object& obj, u64 sub, const string& scope,
+                          const string& name, unsigned int width, bool real) {
+    auto key = std::make_pair(&obj, sub);
+    auto it = m_ids.find(key);
+    if (it != m_ids.end())
+        return it->second;
+
+    u32 idx = (u32)m_signals.size();
+    m_signals.push_back({ scope, name, width, real });
+    m_ids[key] = idx;
+    return idx;
+}
+
+void tracer_vcd::push(const sc_time& t, u32 sig, u64 val, double real) {
+    // local time offsets of decoupled initiators may run ahead of other
+    // ports, but vcd requires monotonic timestamps
+    m_last_ps = max(m_last_ps, vcd_time_ps(t));
+
+    u32 width = m_signals[sig].real ? 0 : m_signals[sig].width;
+    m_changes.push_back({ m_last_ps, sig, width, val, real });
+    if (m_changes.size() >= BATCH_SIZE)
+        flush();
+}
+
+void tracer_vcd::flush() {
+    if (m_changes.empty())
+        return;
+
+    vector<change> batch;
+    batch.reserve(BATCH_SIZE);
+    batch.swap(m_changes);
+
+    lock_guard<mutex> guard(m_batch_mtx);
+    m_batches.push_back(std::move(batch));
+    m_cv.notify_one();
+}
+
+void tracer_vcd::write_change(ostream& os, const change& ch, u64& last) {
+    if (ch.time_ps != last) {
+        os << "#" << ch.time_ps << "\n";
+        last = ch.time_ps;
+    }
+
+    string id = vcd_identifier(ch.signal);
+    if (ch.width == 0) {
+        os << "r" << mkstr("%.17g", ch.real) << " " << id << "\n";
+    } else if (ch.width == 1) {
+        os << (ch.value ? "1" : "0") << id << "\n";
+    } else {
+        os << "b";
+        int msb = ch.value ? 63 - __builtin_clzll(ch.value) : 0;
+        for (int bit = msb; bit >= 0; bit--)
+            os << ((ch.value >> bit) & 1 ? '1' : '0');
+        os << " " << id << "\n";
+    }
+}
+
+void tracer_vcd::write_thread() {
+    u64 last = ~0ull;
+    std::unique_lock<mutex> lock(m_batch_mtx);
+    while (true) {
+        m_cv.wait(lock, [&]() { return !m_running || !m_batches.empty(); });
+        if (m_batches.empty())
+            break;
+
+        vector<change> batch = std::move(m_batches.front());
+        m_batches.pop_front();
+
+        lock.unlock();
+        for (const change& ch : batch)
+            write_change(m_body, ch, last);
+        lock.lock();
+    }
+}
+
+void tracer_vcd::write_header(ostream& os) const {
+    os << "$version vcml " << VCML_VERSION_STRING << " $end\n"
+       << "$timescale 1ps $end\n";
+
+    vector<u32> order(m_signals.size());
+    for (u32 i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        return m_signals[a].scope < m_signals[b].scope;
+    });
+
+    vector<string> current;
+    for (u32 idx : order) {
+        const signal& sig = m_signals[idx];
+        vector<string> scope;
+        if (!sig.scope.empty())
+            scope = split(sig.scope, '.');
+
+        size_t common = 0;
+        while (common < current.size() && common < scope.size() &&
+               current[common] == scope[common])
+            common++;
+
+        for (size_t i = current.size(); i > common; i--)
+            os << "$upscope $end\n";
+        for (size_t i = common; i < scope.size(); i++)
+            os << "$scope module " << scope[i] << " $end\n";
+        current = scope;
+
+        os << "$var " << (sig.real ? "real" : "wire") << " "
+           << (sig.real ? 64 : sig.width) << " " << vcd_identifier(idx) << " "
+           << sig.name << " $end\n";
+    }
+
+    for (size_t i = current.size(); i > 0; i--)
+        os << "$upscope $end\n";
+
+    os << "$enddefinitions $end\n";
+}
+
+void tracer_vcd::trace(const activity<tlm_generic_payload>& msg) {
+    if (!m_trace_tlm)
+        return;
+
+    // tlm ports become a scope holding their address and command signals
+    u32 cmd = signal_id(msg.port, 0, msg.port.name(), "cmd", 2);
+    if (is_backward_trace(msg.dir)) {
+        push(msg.t, cmd, TLM_STATE_IDLE);
+        return;
+    }
+
+    u32 addr = signal_id(msg.port, 1, msg.port.name(), "addr", 64);
+    push(msg.t, addr, msg.payload.get_address());
+
+    if (msg.payload.is_read())
+        push(msg.t, cmd, TLM_STATE_READ);
+    else if (msg.payload.is_write())
+        push(msg.t, cmd, TLM_STATE_WRITE);
+}
+
+void tracer_vcd::trace(const activity<gpio_payload>& msg) {
+    if (!is_forward_trace(msg.dir))
+        return;
+
+    string scope, name;
+    vcd_split(msg.port, scope, name);
+
+    u64 sub = 0;
+    if (msg.payload.vector != GPIO_NO_VECTOR) {
+        name = mkstr("%s_%zu", name.c_str(), msg.payload.vector);
+        sub = msg.payload.vector + 1;
+    }
+
+    u32 sig = signal_id(msg.port, sub, scope, name, 1);
+    push(msg.t, sig, msg.payload.state);
+}
+
+void tracer_vcd::trace(const activity<clk_payload>& msg) {
+    string scope, name;
+    vcd_split(msg.port, scope, name);
+    u32 sig = signal_id(msg.port, 0, scope, name, 64, true);
+    push(msg.t, sig, 0, (double)msg.payload.newhz);
+}
+
+tracer_vcd::tracer_vcd(const string& filename, bool trace_tlm):
+    tracer(),
+    m_filename(filename),
+    m_bodyname(filename + ".body"),
+    m_body(m_bodyname.c_str()),
+    m_trace_tlm(trace_tlm),
+    m_signals(),
+    m_ids(),
+    m_changes(),
+    m_last_ps(0),
+    m_batch_mtx(),
+    m_cv(),
+    m_batches(),
+    m_running(true),
+    m_writer() {
+    VCML_ERROR_ON(!m_body.is_open(), "failed to open %s", m_bodyname.c_str());
+    m_changes.reserve(BATCH_SIZE);
+    m_writer = thread(&tracer_vcd::write_thread, this);
+    mwr::set_thread_name(m_writer, "trace_writer");
+}
+
+tracer_vcd::~tracer_vcd() {
+    flush();
+
+    {
+        lock_guard<mutex> guard(m_batch_mtx);
+        m_running = false;
+        m_cv.notify_one();
+    }
+
+    if (m_writer.joinable())
+        m_writer.join();
+
+    m_body.close();
+
+    ofstream os(m_filename.c_str());
+    if (os.is_open()) {
+        write_header(os);
+        ifstream body(m_bodyname.c_str());
+        if (body.is_open() && body.peek() != EOF)
+            os << body.rdbuf();
+    }
+
+    remove(m_bodyname.c_str());
+}
+
+} // namespace vcml
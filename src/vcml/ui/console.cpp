@@ -14,7 +14,14 @@ namespace vcml {
 namespace ui {
 
 console::console():
-    m_keyboards(), m_pointers(), m_displays(), displays("displays") {
+    m_keyboards(),
+    m_pointers(),
+    m_displays(),
+    m_tracker(),
+    m_damage(),
+    m_conv(),
+    m_shared(),
+    displays("displays") {
     for (const string& type : displays) {
         try {
             auto disp = display::lookup(type);
@@ -42,19 +49,61 @@ void console::notify(pointer& ptr) {
         disp->add_pointer(&ptr);
 }
 
+void console::convert(const damage_rect& rect) {
+    if (m_conv.is_valid())
+        m_conv.convert(m_shared.data(), m_tracker.framebuffer(), rect.x,
+                       rect.y, rect.w, rect.h);
+}
+
 void console::setup(const videomode& mode, u8* fbptr) {
-    for (auto& disp : m_displays)
-        disp->init(mode, fbptr);
+    m_tracker.setup(mode, fbptr);
+    m_conv = pixel_converter();
+    m_shared.clear();
+
+    if (is_shared() && fbptr) {
+        for (auto& disp : m_displays) {
+            if (disp->needs_conversion(mode)) {
+                m_conv = pixel_converter(mode, FORMAT_X8R8G8B8);
+                m_shared.assign(m_conv.dst().size, 0);
+                convert({ 0, 0, mode.xres, mode.yres });
+                break;
+            }
+        }
+    }
+
+    for (auto& disp : m_displays) {
+        if (m_conv.is_valid() && disp->needs_conversion(mode))
+            disp->init(m_conv.dst(), m_shared.data());
+        else
+            disp->init(mode, fbptr);
+    }
 }
 
 void console::render(u32 x, u32 y, u32 w, u32 h) {
+    const videomode& mode = m_tracker.mode();
+    if (m_conv.is_valid() && x < mode.xres && y < mode.yres) {
+        convert({ x, y, min(w, mode.xres - x), min(h, mode.yres - y) });
+
     for (auto& disp : m_displays)
         disp->render(x, y, w, h);
 }
 
 void console::render() {
+    // a single display keeps using its own, possibly parallel, scanning
+    if (!is_shared()) {
+        for (auto& disp : m_displays)
+            disp->render();
+        return;
+    }
+
+    if (m_tracker.update(m_damage) == 0)
+        return;
+
+    for (const damage_rect& rect : m_damage)
+        convert(rect);
+
     for (auto& disp : m_displays)
-        disp->render();
+        disp->render(m_damage);
 }
 
 void console::shutdown() {
@@ -70,6 +119,10 @@ void console::shutdown() {
     m_keyboards.clear();
     m_pointers.clear();
     m_displays.clear();
+
+    m_tracker.setup(videomode(), nullptr);
+    m_conv = pixel_converter();
+    m_shared.clear();
 }
 
 } // namespace ui
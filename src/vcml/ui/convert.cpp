@@ -0,0 +1,504 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "vcml/ui/convert.h"
+
+#if defined(__x86_64__)
+#define VCML_PIXEL_X86
+#define VCML_TARGET_SSE2 __attribute__((target("sse2")))
+#define VCML_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define VCML_PIXEL_NEON
+#include <arm_neon.h>
+#endif
+
+namespace vcml {
+namespace ui {
+
+const char* pixel_isa_str(pixel_isa isa) {
+    switch (isa) {
+    case PIXEL_ISA_SCALAR:
+        return "scalar";
+    case PIXEL_ISA_SSE2:
+        return "sse2";
+    case PIXEL_ISA_AVX2:
+        return "avx2";
+    case PIXEL_ISA_NEON:
+        return "neon";
+    default:
+        return "unknown";
+    }
+}
+
+bool pixel_isa_supported(pixel_isa isa) {
+    switch (isa) {
+    case PIXEL_ISA_SCALAR:
+        return true;
+#ifdef VCML_PIXEL_X86
+    case PIXEL_ISA_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case PIXEL_ISA_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef VCML_PIXEL_NEON
+    case PIXEL_ISA_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+pixel_isa pixel_isa_host() {
+    static const pixel_isa best = []() -> pixel_isa {
+        const pixel_isa isas[] = {
+            PIXEL_ISA_AVX2,
+            PIXEL_ISA_SSE2,
+            PIXEL_ISA_NEON,
+        };
+
+        for (pixel_isa isa : isas)
+            if (pixel_isa_supported(isa))
+                return isa;
+        return PIXEL_ISA_SCALAR;
+    }();
+
+    return best;
+}
+
+// describes how to move each channel (r, g, b, a) of a source pixel into
+// its place in the destination: ch = (pix >> soff) & smask is widened to
+// 8bit via (ch << sl) | (ch >> sr) and finally shifted up by doff
+struct pixel_layout {
+    u32 soff[4];
+    u32 smask[4];
+    u32 sl[4];
+    u32 sr[4];
+    u32 doff[4];
+    u32 fill;
+
+    pixel_layout(const videomode& src, const videomode& dst);
+
+    u32 pack(u32 pix) const {
+        u32 out = fill;
+        for (int i = 0; i < 4; i++) {
+            u32 ch = (pix >> soff[i]) & smask[i];
+            out |= ((ch << sl[i]) | (ch >> sr[i])) << doff[i];
+        }
+
+        return out;
+    }
+};
+
+pixel_layout::pixel_layout(const videomode& src, const videomode& dst) {
+    const color_channel schan[4] = { src.r, src.g, src.b, src.a };
+    const color_channel dchan[4] = { dst.r, dst.g, dst.b, dst.a };
+
+    fill = 0;
+    for (int i = 0; i < 4; i++) {
+        u32 size = min<u32>(schan[i].size, 8);
+        if (size < 4 || (i == 3 && dst.a.size == 0)) {
+            // missing channels are filled in, alpha becomes opaque
+            soff[i] = smask[i] = sl[i] = 0;
+            sr[i] = 8;
+            if (i == 3)
+                fill = 0xffu << dchan[i].offset;
+        } else {
+            soff[i] = schan[i].offset + schan[i].size - size;
+            smask[i] = (1u << size) - 1;
+            sl[i] = 8 - size;
+            sr[i] = 2 * size - 8;
+        }
+
+        doff[i] = dchan[i].offset;
+    }
+}
+
+static inline u32 pixel_load(const u8* src, size_t bpp, bool big_endian) {
+    u32 pix = 0;
+    for (size_t i = 0; i < bpp; i++) {
+        size_t shift = big_endian ? (bpp - i - 1) * 8 : i * 8;
+        pix |= (u32)src[i] << shift;
+    }
+
+    return pix;
+}
+
+static inline void pixel_store(u8* dst, u32 pix) {
+    dst[0] = pix >> 0;
+    dst[1] = pix >> 8;
+    dst[2] = pix >> 16;
+    dst[3] = pix >> 24;
+}
+
+static void convert_scalar(const pixel_converter& conv, u8* dst,
+                           const u8* src, size_t npix) {
+    const pixel_layout layout(conv.src(), conv.dst());
+    const bool big_endian = conv.src().endian == ENDIAN_BIG;
+    const size_t bpp = conv.src().bpp;
+
+    for (size_t i = 0; i < npix; i++, src += bpp, dst += 4)
+        pixel_store(dst, layout.pack(pixel_load(src, bpp, big_endian)));
+}
+
+#ifdef VCML_PIXEL_X86
+struct sse2_layout {
+    __m128i soff[4];
+    __m128i smask[4];
+    __m128i sl[4];
+    __m128i sr[4];
+    __m128i doff[4];
+    __m128i fill;
+};
+
+VCML_TARGET_SSE2
+static inline void sse2_setup(sse2_layout& l, const pixel_layout& p) {
+    for (int i = 0; i < 4; i++) {
+        l.soff[i] = _mm_cvtsi32_si128(p.soff[i]);
+        l.smask[i] = _mm_set1_epi32(p.smask[i]);
+        l.sl[i] = _mm_cvtsi32_si128(p.sl[i]);
+        l.sr[i] = _mm_cvtsi32_si128(p.sr[i]);
+        l.doff[i] = _mm_cvtsi32_si128(p.doff[i]);
+    }
+
+    l.fill = _mm_set1_epi32(p.fill);
+}
+
+VCML_TARGET_SSE2
+static inline __m128i sse2_pack(__m128i pix, const sse2_layout& l) {
+    __m128i out = l.fill;
+    for (int i = 0; i < 4; i++) {
+        __m128i ch = _mm_and_si128(_mm_srl_epi32(pix, l.soff[i]), l.smask[i]);
+        ch = _mm_or_si128(_mm_sll_epi32(ch, l.sl[i]),
+                          _mm_srl_epi32(ch, l.sr[i]));
+        out = _mm_or_si128(out, _mm_sll_epi32(ch, l.doff[i]));
+    }
+
+    return out;
+}
+
+template <size_t BPP>
+VCML_TARGET_SSE2 static inline __m128i sse2_load(const u8* src) {
+    const __m128i zero = _mm_setzero_si128();
+    switch (BPP) {
+    case 1: {
+        u32 val;
+        memcpy(&val, src, sizeof(val));
+        __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(val), zero);
+        return _mm_unpacklo_epi16(v, zero);
+    }
+
+    case 2:
+        return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)src),
+                                  zero);
+
+    case 3:
+        return _mm_setr_epi32(pixel_load(src + 0, 3, false),
+                              pixel_load(src + 3, 3, false),
+                              pixel_load(src + 6, 3, false),
+                              pixel_load(src + 9, 3, false));
+
+    default:
+        return _mm_loadu_si128((const __m128i*)src);
+    }
+}
+
+template <size_t BPP>
+VCML_TARGET_SSE2 static void convert_sse2(const pixel_converter& conv,
+                                          u8* dst, const u8* src,
+                                          size_t npix) {
+    sse2_layout layout;
+    sse2_setup(layout, pixel_layout(conv.src(), conv.dst()));
+
+    size_t i = 0;
+    for (; i + 4 <= npix; i += 4) {
+        __m128i pix = sse2_load<BPP>(src + i * BPP);
+        _mm_storeu_si128((__m128i*)(dst + i * 4), sse2_pack(pix, layout));
+    }
+
+    convert_scalar(conv, dst + i * 4, src + i * BPP, npix - i);
+}
+
+struct avx2_layout {
+    __m128i soff[4];
+    __m256i smask[4];
+    __m128i sl[4];
+    __m128i sr[4];
+    __m128i doff[4];
+    __m256i fill;
+};
+
+VCML_TARGET_AVX2
+static inline void avx2_setup(avx2_layout& l, const pixel_layout& p) {
+    for (int i = 0; i < 4; i++) {
+        l.soff[i] = _mm_cvtsi32_si128(p.soff[i]);
+        l.smask[i] = _mm256_set1_epi32(p.smask[i]);
+        l.sl[i] = _mm_cvtsi32_si128(p.sl[i]);
+        l.sr[i] = _mm_cvtsi32_si128(p.sr[i]);
+        l.doff[i] = _mm_cvtsi32_si128(p.doff[i]);
+    }
+
+    l.fill = _mm256_set1_epi32(p.fill);
+}
+
+VCML_TARGET_AVX2
+static inline __m256i avx2_pack(__m256i pix, const avx2_layout& l) {
+    __m256i out = l.fill;
+    for (int i = 0; i < 4; i++) {
+        __m256i ch = _mm256_srl_epi32(pix, l.soff[i]);
+        ch = _mm256_and_si256(ch, l.smask[i]);
+        ch = _mm256_or_si256(_mm256_sll_epi32(ch, l.sl[i]),
+                             _mm256_srl_epi32(ch, l.sr[i]));
+        out = _mm256_or_si256(out, _mm256_sll_epi32(ch, l.doff[i]));
+    }
+
+    return out;
+}
+
+template <size_t BPP>
+VCML_TARGET_AVX2 static inline __m256i avx2_load(const u8* src) {
+    switch (BPP) {
+    case 1:
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+
+    case 2:
+        return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)src));
+
+    case 3: {
+        // spread 4 packed pixels per lane into 32bit words
+        const __m256i mask = _mm256_setr_epi8(
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, //
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        __m128i lo = _mm_loadu_si128((const __m128i*)(src + 0));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(src + 12));
+        __m256i v = _mm256_castsi128_si256(lo);
+        v = _mm256_inserti128_si256(v, hi, 1);
+        return _mm256_shuffle_epi8(v, mask);
+    }
+
+    default:
+        return _mm256_loadu_si256((const __m256i*)src);
+    }
+}
+
+template <size_t BPP>
+VCML_TARGET_AVX2 static void convert_avx2(const pixel_converter& conv,
+                                          u8* dst, const u8* src,
+                                          size_t npix) {
+    avx2_layout layout;
+    avx2_setup(layout, pixel_layout(conv.src(), conv.dst()));
+
+    // 24bit loads read 4 bytes past the last pixel of each block
+    const size_t slack = BPP == 3 ? 2 : 0;
+
+    size_t i = 0;
+    for (; i + 8 + slack <= npix; i += 8) {
+        __m256i pix = avx2_load<BPP>(src + i * BPP);
+        _mm256_storeu_si256((__m256i*)(dst + i * 4), avx2_pack(pix, layout));
+    }
+
+    convert_scalar(conv, dst + i * 4, src + i * BPP, npix - i);
+}
+#endif
+
+#ifdef VCML_PIXEL_NEON
+struct neon_layout {
+    int32x4_t soff[4];
+    uint32x4_t smask[4];
+    int32x4_t sl[4];
+    int32x4_t sr[4];
+    int32x4_t doff[4];
+    uint32x4_t fill;
+};
+
+static inline void neon_setup(neon_layout& l, const pixel_layout& p) {
+    // neon only shifts left, negative amounts shift right
+    for (int i = 0; i < 4; i++) {
+        l.soff[i] = vdupq_n_s32(-(i32)p.soff[i]);
+        l.smask[i] = vdupq_n_u32(p.smask[i]);
+        l.sl[i] = vdupq_n_s32((i32)p.sl[i]);
+        l.sr[i] = vdupq_n_s32(-(i32)p.sr[i]);
+        l.doff[i] = vdupq_n_s32((i32)p.doff[i]);
+    }
+
+    l.fill = vdupq_n_u32(p.fill);
+}
+
+static inline uint32x4_t neon_pack(uint32x4_t pix, const neon_layout& l) {
+    uint32x4_t out = l.fill;
+    for (int i = 0; i < 4; i++) {
+        uint32x4_t ch = vandq_u32(vshlq_u32(pix, l.soff[i]), l.smask[i]);
+        ch = vorrq_u32(vshlq_u32(ch, l.sl[i]), vshlq_u32(ch, l.sr[i]));
+        out = vorrq_u32(out, vshlq_u32(ch, l.doff[i]));
+    }
+
+    return out;
+}
+
+template <size_t BPP>
+static inline void neon_load(const u8* src, uint32x4_t& lo, uint32x4_t& hi) {
+    switch (BPP) {
+    case 1: {
+        uint16x8_t v = vmovl_u8(vld1_u8(src));
+        lo = vmovl_u16(vget_low_u16(v));
+        hi = vmovl_u16(vget_high_u16(v));
+        break;
+    }
+
+    case 2: {
+        uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(src));
+        lo = vmovl_u16(vget_low_u16(v));
+        hi = vmovl_u16(vget_high_u16(v));
+        break;
+    }
+
+    case 3: {
+        uint8x8x3_t v = vld3_u8(src);
+        uint16x8_t b0 = vmovl_u8(v.val[0]);
+        uint16x8_t b1 = vmovl_u8(v.val[1]);
+        uint16x8_t b2 = vmovl_u8(v.val[2]);
+        lo = vorrq_u32(vmovl_u16(vget_low_u16(b0)),
+                       vshll_n_u16(vget_low_u16(b1), 8));
+        lo = vorrq_u32(lo, vshll_n_u16(vget_low_u16(b2), 16));
+        hi = vorrq_u32(vmovl_u16(vget_high_u16(b0)),
+                       vshll_n_u16(vget_high_u16(b1), 8));
+        hi = vorrq_u32(hi, vshll_n_u16(vget_high_u16(b2), 16));
+        break;
+    }
+
+    default:
+        lo = vreinterpretq_u32_u8(vld1q_u8(src));
+        hi = vreinterpretq_u32_u8(vld1q_u8(src + 16));
+        break;
+    }
+}
+
+template <size_t BPP>
+static void convert_neon(const pixel_converter& conv, u8* dst,
+                         const u8* src, size_t npix) {
+    neon_layout layout;
+    neon_setup(layout, pixel_layout(conv.src(), conv.dst()));
+
+    size_t i = 0;
+    for (; i + 8 <= npix; i += 8) {
+        uint32x4_t lo, hi;
+        neon_load<BPP>(src + i * BPP, lo, hi);
+        lo = neon_pack(lo, layout);
+        hi = neon_pack(hi, layout);
+        vst1q_u8(dst + i * 4 + 0, vreinterpretq_u8_u32(lo));
+        vst1q_u8(dst + i * 4 + 16, vreinterpretq_u8_u32(hi));
+    }
+
+    convert_scalar(conv, dst + i * 4, src + i * BPP, npix - i);
+}
+#endif
+
+typedef pixel_converter::kernel kernel;
+
+static kernel select_bpp(size_t bpp, kernel k1, kernel k2, kernel k3,
+                         kernel k4) {
+    switch (bpp) {
+    case 1:
+        return k1;
+    case 2:
+        return k2;
+    case 3:
+        return k3;
+    case 4:
+        return k4;
+    default:
+        return &convert_scalar;
+    }
+}
+
+static kernel select_kernel(pixel_isa isa, const videomode& src) {
+    if (src.endian == ENDIAN_BIG)
+        return &convert_scalar;
+
+    switch (isa) {
+#ifdef VCML_PIXEL_X86
+    case PIXEL_ISA_SSE2:
+        return select_bpp(src.bpp, &convert_sse2<1>, &convert_sse2<2>,
+                          &convert_sse2<3>, &convert_sse2<4>);
+    case PIXEL_ISA_AVX2:
+        return select_bpp(src.bpp, &convert_avx2<1>, &convert_avx2<2>,
+                          &convert_avx2<3>, &convert_avx2<4>);
+#endif
+#ifdef VCML_PIXEL_NEON
+    case PIXEL_ISA_NEON:
+        return select_bpp(src.bpp, &convert_neon<1>, &convert_neon<2>,
+                          &convert_neon<3>, &convert_neon<4>);
+#endif
+    default:
+        return &convert_scalar;
+    }
+}
+
+pixel_converter::pixel_converter():
+    m_src(), m_dst(), m_isa(PIXEL_ISA_SCALAR), m_kernel(nullptr) {
+    // nothing to do
+}
+
+pixel_converter::pixel_converter(const videomode& src, pixelformat dst):
+    pixel_converter(src, dst, pixel_isa_host()) {
+    // nothing to do
+}
+
+pixel_converter::pixel_converter(const videomode& src, pixelformat dst,
+                                 pixel_isa isa):
+    m_src(src),
+    m_dst(dst, src.xres, src.yres),
+    m_isa(isa),
+    m_kernel(nullptr) {
+    VCML_ERROR_ON(!src.is_valid(), "invalid source videomode");
+    VCML_ERROR_ON(!supported(dst), "cannot convert to %s",
+                  pixelformat_to_str(dst));
+    VCML_ERROR_ON(!pixel_isa_supported(isa), "%s not supported on host",
+                  pixel_isa_str(isa));
+    m_kernel = select_kernel(isa, src);
+}
+
+void pixel_converter::convert(u8* dst, const u8* src, u32 x, u32 y, u32 w,
+                              u32 h) const {
+    if (x >= m_src.xres || y >= m_src.yres)
+        return;
+
+    w = min(w, m_src.xres - x);
+    h = min(h, m_src.yres - y);
+
+    src += y * m_src.stride + x * m_src.bpp;
+    dst += y * m_dst.stride + x * m_dst.bpp;
+
+    for (u32 row = 0; row < h; row++) {
+        convert(dst, src, (size_t)w);
+        src += m_src.stride;
+        dst += m_dst.stride;
+    }
+}
+
+void pixel_converter::convert(u8* dst, const u8* src) const {
+    // frames without padding between lines are converted in one go
+    if (m_src.stride == m_src.xres * m_src.bpp)
+        convert(dst, src, (size_t)m_src.xres * m_src.yres);
+    else
+        convert(dst, src, 0, 0, m_src.xres, m_src.yres);
+}
+
+bool pixel_converter::supported(pixelformat dst) {
+    return pixelformat_bpp(dst) == 4 && pixelformat_r(dst).size == 8 &&
+           pixelformat_g(dst).size == 8 && pixelformat_b(dst).size == 8;
+}
+
+} // namespace ui
+} // namespace vcml
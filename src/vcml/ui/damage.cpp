@@ -0,0 +1,138 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "vcml/ui/damage.h"
+
+namespace vcml {
+namespace ui {
+
+static inline u64 hash_mix(u64 h, u64 val) {
+    return (h ^ val) * 0x100000001b3ull;
+}
+
+u64 damage_tracker::hash_tile(u32 tx, u32 ty) const {
+    u32 x = tx * TILE_W;
+    u32 y = ty * TILE_H;
+    u32 w = min(TILE_W, m_mode.xres - x);
+    u32 h = min(TILE_H, m_mode.yres - y);
+
+    size_t len = w * m_mode.bpp;
+    const u8* row = m_fb + y * m_mode.stride + x * m_mode.bpp;
+
+    u64 hash = 0xcbf29ce484222325ull;
+    for (u32 i = 0; i < h; i++, row += m_mode.stride) {
+        size_t off = 0;
+        for (; off + sizeof(u64) <= len; off += sizeof(u64)) {
+            u64 val;
+            memcpy(&val, row + off, sizeof(val));
+            hash = hash_mix(hash, val);
+        }
+
+        for (; off < len; off++)
+            hash = hash_mix(hash, row[off]);
+    }
+
+    return hash;
+}
+
+damage_tracker::damage_tracker():
+    m_mode(),
+    m_fb(nullptr),
+    m_tiles_x(0),
+    m_tiles_y(0),
+    m_valid(false),
+    m_hashes() {
+    // nothing to do
+}
+
+void damage_tracker::setup(const videomode& mode, const u8* fb) {
+    m_mode = mode;
+    m_fb = fb;
+    m_tiles_x = (mode.xres + TILE_W - 1) / TILE_W;
+    m_tiles_y = (mode.yres + TILE_H - 1) / TILE_H;
+    m_hashes.assign(m_tiles_x * m_tiles_y, 0);
+    m_valid = false;
+}
+
+size_t damage_tracker::update(vector<damage_rect>& damage) {
+    damage.clear();
+    if (m_fb == nullptr)
+        return 0;
+
+    // first rectangle that may still grow downwards
+    size_t open = 0;
+    size_t area = 0;
+
+    for (u32 ty = 0; ty < m_tiles_y; ty++) {
+        size_t first = damage.size();
+        for (u32 tx = 0; tx < m_tiles_x; tx++) {
+            u64& prev = m_hashes[ty * m_tiles_x + tx];
+            u64 hash = hash_tile(tx, ty);
+            bool dirty = !m_valid || hash != prev;
+            prev = hash;
+
+            if (!dirty)
+                continue;
+
+            u32 x = tx * TILE_W;
+            u32 w = min(TILE_W, m_mode.xres - x);
+            damage_rect* last = nullptr;
+            if (damage.size() > first)
+                last = &damage.back();
+
+            if (last && last->x + last->w == x)
+                last->w += w;
+            else
+                damage.push_back({ x, ty * TILE_H, w, 0 });
+        }
+
+        u32 y = ty * TILE_H;
+        u32 h = min(TILE_H, m_mode.yres - y);
+        for (size_t i = first; i < damage.size(); i++)
+            damage[i].h = h;
+
+        // extend spans of the row above that cover exactly the same columns
+        size_t next = first;
+        for (size_t i = first; i < damage.size(); i++) {
+            damage_rect& r = damage[i];
+            bool merged = false;
+            for (size_t j = open; j < first; j++) {
+                damage_rect& above = damage[j];
+                if (above.x == r.x && above.w == r.w &&
+                    above.y + above.h == r.y) {
+                    above.h += r.h;
+                    merged = true;
+                    break;
+                }
+            }
+
+            if (!merged)
+                damage[next++] = r;
+        }
+
+        damage.resize(next);
+
+        // skip rectangles that ended above the next tile row
+        u32 bottom = y + h;
+        while (open < damage.size() &&
+               damage[open].y + damage[open].h < bottom)
+            open++;
+    }
+
+    for (const damage_rect& r : damage)
+        area += (size_t)r.w * r.h;
+
+    m_valid = true;
+    return area;
+}
+
+} // namespace ui
+} // namespace vcml
@@ -38,6 +38,10 @@ display::~display() {
     // nothing to do
 }
 
+bool display::needs_conversion(const videomode& mode) const {
+    return false;
+}
+
 void display::init(const videomode& mode, u8* fbptr) {
     if (has_framebuffer())
         shutdown();
@@ -53,6 +57,11 @@ void display::render(u32 x, u32 y, u32 w, u32 h) {
     // nothing to do
 }
 
+void display::render(const vector<damage_rect>& damage) {
+    for (const damage_rect& r : damage)
+        render(r.x, r.y, r.w, r.h);
+}
+
 void display::render() {
     // nothing to do
 }
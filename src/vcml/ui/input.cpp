@@ -13,9 +13,44 @@
 namespace vcml {
 namespace ui {
 
+bool input::pop_ring(input_event& ev) {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire))
+        return false;
+
+    ev = m_ring[head % CAPACITY];
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void input::insert_event(const input_event& ev) {
+    {
+        lock_guard<mutex> guard(m_push_mtx);
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= CAPACITY) {
+            m_dropped++;
+            return;
+        }
+
+        m_ring[tail % CAPACITY] = ev;
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    if (m_notify && !m_notified.exchange(true))
+        m_notify();
+}
+
+void input::replay_event(const u8* data, size_t size) {
+    input_event ev;
+    VCML_ERROR_ON(size != sizeof(ev), "invalid replay input event");
+    memcpy(&ev, data, sizeof(ev));
+    insert_event(ev);
+}
+
 void input::push_event(const input_event& ev) {
-    lock_guard<mutex> lock(m_mutex);
-    m_events.push(ev);
+    // host input is ignored while replaying recorded events
+    if (!m_replay.is_replaying())
+        insert_event(ev);
 }
 
 void input::push_key(u32 key, u32 state) {
@@ -35,30 +70,48 @@ void input::push_rel(i32 x, i32 y, i32 w) {
     push_event(ev);
 }
 
-input::input(const char* name): m_name(name), m_mutex(), m_events() {
+input::input(const char* name, const char* kind):
+    m_name(name),
+    m_ring(CAPACITY),
+    m_head(0),
+    m_tail(0),
+    m_push_mtx(),
+    m_notified(false),
+    m_notify(),
+    m_dropped(0),
+    m_replay(mkstr("%s.%s", name, kind)) {
+    m_replay.replay([this](const u8* data, size_t size) -> void {
+        replay_event(data, size);
+    });
 }
 
 input::~input() {
     // nothing to do
 }
 
+void input::set_notify(function<void(void)> notify) {
+    m_notify = std::move(notify);
+}
+
 bool input::has_events() const {
-    lock_guard<mutex> lock(m_mutex);
-    return !m_events.empty();
+    return m_head.load() != m_tail.load();
 }
 
 bool input::pop_event(input_event& ev) {
-    lock_guard<mutex> lock(m_mutex);
-    if (m_events.empty())
-        return false;
+    if (!pop_ring(ev)) {
+        // rearm before looking again, so that events pushed in between are
+        // either found here or notified anew
+        m_notified = false;
+        if (!pop_ring(ev))
+            return false;
+    }
 
-    ev = m_events.front();
-    m_events.pop();
+    m_replay.record(&ev, sizeof(ev));
     return true;
 }
 
 keyboard::keyboard(const char* name, const string& layout):
-    input(name),
+    input(name, "keyboard"),
     m_shift_l(false),
     m_shift_r(false),
     m_capsl(false),
@@ -158,7 +211,7 @@ keyboard* keyboard::find(const char* name) {
 }
 
 pointer::pointer(const char* name):
-    input(name), m_buttons(), m_abs_x(), m_abs_y(), m_abs_w() {
+    input(name, "pointer"), m_buttons(), m_abs_x(), m_abs_y(), m_abs_w() {
     if (stl_contains(s_pointers, string(name)))
         VCML_ERROR("pointer input device '%s' already exists", name);
     s_pointers[name] = this;
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/ui/rfb.h"
+#include "vcml/properties/broker.h"
 
 namespace vcml {
 namespace ui {
@@ -209,6 +210,25 @@ static void rfb_ptr_func(char mask, unsigned short x, unsigned short y,
     rfb_server->ptr_event((u32)mask, (u32)x, (u32)y);
 }
 
+void rfb::encode() {
+    u64 frames = m_frames.load(std::memory_order_acquire);
+    if (frames == m_encoded)
+        return;
+
+    m_encoded = frames;
+    if (!m_tracker.update(m_damage))
+        return;
+
+    const videomode& fbm = mode();
+    for (const damage_rect& r : m_damage) {
+        for (u32 y = r.y; y < r.y + r.h; y++) {
+            size_t offset = y * fbm.stride + r.x * fbm.bpp;
+            memcpy(m_shadow.data() + offset, framebuffer() + offset,
+                   r.w * fbm.bpp);
+        }
+    }
+}
+
 void rfb::run() {
     const videomode& fbm = mode();
 
@@ -223,7 +243,7 @@ void rfb::run() {
     rc.pixel_fmt.rshift = fbm.r.offset;
     rc.pixel_fmt.gshift = fbm.g.offset;
     rc.pixel_fmt.bshift = fbm.b.offset;
-    rc.framebuffer = framebuffer();
+    rc.framebuffer = m_shadow.data();
     rc.width = fbm.xres;
     rc.height = fbm.yres;
     rc.server_name = name();
@@ -235,9 +255,17 @@ void rfb::run() {
 
     log_debug("starting librfb server on port %d", m_port);
 
-    while (m_running && sim_running())
+    u64 period = m_fps > 0.0 ? (u64)(1e6 / m_fps) : 0;
+    while (m_running && sim_running()) {
+        u64 start = mwr::timestamp_us();
+        encode();
         rfb_poll_work(m_screen);
 
+        u64 elapsed = mwr::timestamp_us() - start;
+        if (elapsed < period)
+            mwr::usleep(period - elapsed);
+    }
+
     log_debug("terminating librfb server on port %d", m_port);
 
     rfb_shutdown_server(m_screen);
@@ -250,9 +278,14 @@ rfb::rfb(u32 no):
     m_ptr_x(),
     m_ptr_y(),
     m_running(false),
-    m_mutex(),
     m_screen(),
-    m_thread() {
+    m_thread(),
+    m_fps(broker::get_or_default<double>("rfb.fps", 60.0)),
+    m_frames(0),
+    m_encoded(0),
+    m_tracker(),
+    m_damage(),
+    m_shadow() {
     VCML_ERROR_ON(no != (u32)m_port, "invalid port specified: %u", no);
 }
 
@@ -263,11 +296,23 @@ rfb::~rfb() {
 void rfb::init(const videomode& mode, u8* fb) {
     display::init(mode, fb);
 
+    m_shadow.assign(framebuffer_size(), 0);
+    m_tracker.setup(this->mode(), framebuffer());
+    m_frames = 1; // pick up the initial frame contents
+
     m_running = true;
     m_thread = thread(&rfb::run, this);
     set_thread_name(m_thread, name());
 }
 
+void rfb::render(u32 x, u32 y, u32 w, u32 h) {
+    m_frames.fetch_add(1, std::memory_order_release);
+}
+
+void rfb::render() {
+    m_frames.fetch_add(1, std::memory_order_release);
+}
+
 void rfb::shutdown() {
     if (m_thread.joinable()) {
         m_running = false;
@@ -18,6 +18,7 @@
 
 #include "vcml/ui/keymap.h"
 #include "vcml/ui/video.h"
+#include "vcml/ui/damage.h"
 #include "vcml/ui/display.h"
 
 #include <librfb.h>
@@ -33,10 +34,20 @@ private:
     u32 m_ptr_x;
     u32 m_ptr_y;
     atomic<bool> m_running;
-    mutex m_mutex;
     RfbOpaqueContext* m_screen;
     thread m_thread;
+    double m_fps;
 
+    // renders only bump m_frames, the server thread then picks up new
+    // frames at most m_fps times per second and copies changed tiles into
+    // the shadow buffer librfb serves its viewers from
+    atomic<u64> m_frames;
+    u64 m_encoded;
+    damage_tracker m_tracker;
+    vector<damage_rect> m_damage;
+    vector<u8> m_shadow;
+
+    void encode();
     void run();
 
 public:
@@ -46,6 +57,8 @@ public:
     virtual ~rfb();
 
     virtual void init(const videomode& mode, u8* fb) override;
+    virtual void render(u32 x, u32 y, u32 w, u32 h) override;
+    virtual void render() override;
     virtual void shutdown() override;
 
     void key_event(u32 sym, bool down);
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/ui/sdl.h"
+#include "vcml/properties/broker.h"
 
 namespace vcml {
 namespace ui {
@@ -295,7 +296,8 @@ void sdl_client::init_window() {
         VCML_ERROR("cannot create SDL window: %s", SDL_GetError());
 
     window_id = SDL_GetWindowID(window);
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+    const u32 flags = disp->vsync() ? SDL_RENDERER_PRESENTVSYNC : 0;
+    renderer = SDL_CreateRenderer(window, -1, flags);
     if (renderer == nullptr)
         VCML_ERROR("cannot create SDL renderer: %s", SDL_GetError());
 
@@ -307,7 +309,7 @@ void sdl_client::init_window() {
         VCML_ERROR("cannot set clear color: %s", SDL_GetError());
 
     const int access = SDL_TEXTUREACCESS_STREAMING;
-    const int format = sdl_format_from_fbmode(disp->mode());
+    const int format = sdl_format_from_fbmode(disp->frame_mode());
     texture = SDL_CreateTexture(renderer, format, access, w, h);
     if (texture == nullptr)
         VCML_ERROR("cannot create SDL texture: %s", SDL_GetError());
@@ -333,29 +335,45 @@ void sdl_client::exit_window() {
     }
 }
 
-void sdl_client::draw_window() {
+void sdl_client::draw_window(bool full) {
     if (!disp || !window || !renderer || !texture)
         return;
 
     SDL_Rect rect = {};
-    rect.x = 0;
-    rect.y = 0;
-    rect.w = disp->xres();
-    rect.h = disp->yres();
-
-    int pitch = disp->framebuffer_size() / disp->yres();
-    const void* pixels = disp->framebuffer();
+    const u8* pixels = nullptr;
+    bool fresh = disp->fetch_frame(pixels, rect);
+    if (!fresh && !full) {
+        update_title();
+        return;
+    }
 
-    SDL_RenderClear(renderer);
+    // only upload what changed, the texture keeps everything else
+    if (fresh && rect.w > 0 && rect.h > 0) {
+        const videomode& mode = disp->frame_mode();
+        const size_t len = rect.w * mode.bpp;
+        const u8* src = pixels + rect.y * mode.stride + rect.x * mode.bpp;
+
+        void* dst = nullptr;
+        int pitch = 0;
+        if (SDL_LockTexture(texture, &rect, &dst, &pitch) == 0) {
+            for (int row = 0; row < rect.h; row++) {
+                memcpy((u8*)dst + row * pitch, src, len);
+                src += mode.stride;
+            }
 
-    if (pixels) {
-        SDL_UpdateTexture(texture, &rect, pixels, pitch);
-        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+            SDL_UnlockTexture(texture);
+        }
     }
 
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
     frames++;
 
+    update_title();
+}
+
+void sdl_client::update_title() {
     // all times in microseconds
     const u64 update_interval = 1000000;
     u64 delta = mwr::timestamp_us() - time_frame;
@@ -418,7 +436,7 @@ void sdl::poll_events() {
             }
 
             if (event.window.event == SDL_WINDOWEVENT_EXPOSED && client)
-                client->draw_window();
+                client->draw_window(true);
             break;
         }
 
@@ -505,7 +523,7 @@ sdl::~sdl() {
         m_uithread.join();
 }
 
-void sdl::register_display(display* disp) {
+void sdl::register_display(sdl_display* disp) {
     lock_guard<mutex> attach_guard(m_attach_mtx);
     auto finder = [disp](const sdl_client& s) -> bool {
         return s.disp == disp;
@@ -524,7 +542,7 @@ void sdl::register_display(display* disp) {
         m_uithread = thread(&sdl::ui_run, this);
 }
 
-void sdl::unregister_display(display* disp) {
+void sdl::unregister_display(sdl_display* disp) {
     lock_guard<mutex> attach_guard(m_attach_mtx);
 
     if (m_attached > 0) {
@@ -551,28 +569,165 @@ display* sdl::create(u32 nr) {
 }
 
 sdl_display::sdl_display(u32 nr, sdl& owner):
-    display("sdl", nr), m_owner(owner) {
+    display("sdl", nr),
+    m_owner(owner),
+    m_vsync(broker::get_or_default<bool>("sdl.vsync", false)),
+    m_conv(),
+    m_frame_mode(),
+    m_frames(),
+    m_back(0),
+    m_front(1),
+    m_ready(2),
+    m_pending() {
 }
 
 sdl_display::~sdl_display() {
     // nothing to do
 }
 
+static void sdl_rect_union(SDL_Rect& dst, const SDL_Rect& src) {
+    if (dst.w <= 0 || dst.h <= 0) {
+        dst = src;
+        return;
+    }
+
+    SDL_Rect res;
+    SDL_UnionRect(&dst, &src, &res);
+    dst = res;
+}
+
+void sdl_display::copy_rect(sdl_frame& frame, const SDL_Rect& rect) {
+    if (m_conv.is_valid()) {
+        m_conv.convert(frame.pixels.data(), framebuffer(), rect.x, rect.y,
+                       rect.w, rect.h);
+        return;
+    }
+
+    const videomode& fbm = mode();
+    const size_t offset = rect.y * fbm.stride + rect.x * fbm.bpp;
+    const size_t len = rect.w * fbm.bpp;
+
+    const u8* src = framebuffer() + offset;
+    u8* dst = frame.pixels.data() + offset;
+    for (int row = 0; row < rect.h; row++) {
+        memcpy(dst, src, len);
+        src += fbm.stride;
+        dst += fbm.stride;
+    }
+}
+
+void sdl_display::publish(const vector<SDL_Rect>& rects) {
+    // every buffer needs these areas once it is rendered into next time
+    for (sdl_frame& frame : m_frames) {
+        for (const SDL_Rect& rect : rects) {
+            if (frame.stale.size() >= MAX_STALE) {
+                SDL_Rect all = frame.stale[0];
+                for (const SDL_Rect& r : frame.stale)
+                    sdl_rect_union(all, r);
+                frame.stale.assign(1, all);
+            }
+
+            frame.stale.push_back(rect);
+        }
+    }
+
+    sdl_frame& back = m_frames[m_back];
+    for (const SDL_Rect& r : back.stale)
+        copy_rect(back, r);
+    back.stale.clear();
+
+    // the ui thread still has to upload whatever it did not pick up yet
+    if (!(m_ready.load() & FRAME_FRESH))
+        m_pending = SDL_Rect();
+    for (const SDL_Rect& rect : rects)
+        sdl_rect_union(m_pending, rect);
+    back.damage = m_pending;
+
+    m_back = m_ready.exchange(m_back | FRAME_FRESH) & ~FRAME_FRESH;
+}
+
+bool sdl_display::fetch_frame(const u8*& pixels, SDL_Rect& damage) {
+    if (!(m_ready.load() & FRAME_FRESH))
+        return false;
+
+    m_front = m_ready.exchange(m_front) & ~FRAME_FRESH;
+    pixels = m_frames[m_front].pixels.data();
+    damage = m_frames[m_front].damage;
+    return true;
+}
+
+bool sdl_display::needs_conversion(const videomode& mode) const {
+    return mode.grayscale || mode.endian == ENDIAN_BIG;
+}
+
 void sdl_display::init(const videomode& mode, u8* fb) {
     display::init(mode, fb);
+
+    m_conv = pixel_converter();
+    m_frame_mode = mode;
+    if (needs_conversion(mode)) {
+        m_conv = pixel_converter(mode, FORMAT_X8R8G8B8);
+        m_frame_mode = m_conv.dst();
+    }
+
+    for (sdl_frame& frame : m_frames) {
+        frame.pixels.assign(m_frame_mode.size, 0);
+        frame.stale.clear();
+        frame.damage = SDL_Rect();
+    }
+
+    m_back = 0;
+    m_front = 1;
+    m_ready = 2;
+    m_pending = SDL_Rect();
+
+    render();
     m_owner.register_display(this);
 }
 
 void sdl_display::render(u32 x, u32 y, u32 w, u32 h) {
-    // nothing to do
+    if (x >= xres() || y >= yres() || m_frames[0].pixels.empty())
+        return;
+
+    SDL_Rect rect;
+    rect.x = (int)x;
+    rect.y = (int)y;
+    rect.w = (int)(min(x + w, xres()) - x);
+    rect.h = (int)(min(y + h, yres()) - y);
+    publish({ rect });
+}
+
+void sdl_display::render(const vector<damage_rect>& damage) {
+    if (m_frames[0].pixels.empty())
+        return;
+
+    // all rectangles of a frame go out with a single buffer swap
+    vector<SDL_Rect> rects;
+    rects.reserve(damage.size());
+    for (const damage_rect& r : damage) {
+        if (r.x >= xres() || r.y >= yres())
+            continue;
+
+        SDL_Rect rect;
+        rect.x = (int)r.x;
+        rect.y = (int)r.y;
+        rect.w = (int)(min(r.x + r.w, xres()) - r.x);
+        rect.h = (int)(min(r.y + r.h, yres()) - r.y);
+        rects.push_back(rect);
+    }
+
+    if (!rects.empty())
+        publish(rects);
 }
 
 void sdl_display::render() {
-    // nothing to do
+    render(0, 0, xres(), yres());
 }
 
 void sdl_display::shutdown() {
     m_owner.unregister_display(this);
+    for (sdl_frame& frame : m_frames)
+        frame.pixels.clear();
     display::shutdown();
 }
 
@@ -19,6 +19,7 @@
 
 #include "vcml/ui/keymap.h"
 #include "vcml/ui/video.h"
+#include "vcml/ui/convert.h"
 #include "vcml/ui/display.h"
 
 #include <SDL.h>
@@ -26,8 +27,10 @@
 namespace vcml {
 namespace ui {
 
+class sdl_display;
+
 struct sdl_client {
-    display* disp;
+    sdl_display* disp;
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_Texture* texture;
@@ -44,7 +47,8 @@ struct sdl_client {
 
     void init_window();
     void exit_window();
-    void draw_window();
+    void draw_window(bool full = false);
+    void update_title();
 };
 
 class sdl
@@ -70,23 +74,59 @@ private:
 public:
     ~sdl();
 
-    void register_display(display* disp);
-    void unregister_display(display* disp);
+    void register_display(sdl_display* disp);
+    void unregister_display(sdl_display* disp);
 
     static display* create(u32 nr);
 };
 
+struct sdl_frame {
+    vector<u8> pixels;
+    vector<SDL_Rect> stale; // rendered since this buffer was last written
+    SDL_Rect damage;        // area the ui thread needs to upload
+};
+
 class sdl_display : public display
 {
 private:
     sdl& m_owner;
+    bool m_vsync;
+
+    // SDL knows neither grayscale nor big endian pixels
+    pixel_converter m_conv;
+    videomode m_frame_mode;
+
+    // triple buffering: the simulation renders into m_back, the ui thread
+    // uploads from m_front and m_ready holds the latest complete frame
+    sdl_frame m_frames[3];
+    u32 m_back;
+    u32 m_front;
+    atomic<u32> m_ready;
+
+    // damage published since the ui thread last picked up a frame
+    SDL_Rect m_pending;
+
+    static constexpr u32 FRAME_FRESH = 1u << 31;
+    static constexpr size_t MAX_STALE = 64;
+
+    void copy_rect(sdl_frame& frame, const SDL_Rect& rect);
+    void publish(const vector<SDL_Rect>& rects);
 
 public:
+    bool vsync() const { return m_vsync; }
+    const videomode& frame_mode() const { return m_frame_mode; }
+
+    // called from the ui thread, returns the latest frame if it changed
+    bool fetch_frame(const u8*& pixels, SDL_Rect& damage);
+
     sdl_display(u32 nr, sdl& owner);
     virtual ~sdl_display();
 
+    virtual bool needs_conversion(const videomode& mode) const override;
+
     virtual void init(const videomode& mode, u8* fb) override;
     virtual void render(u32 x, u32 y, u32 w, u32 h) override;
+    virtual void render(const vector<damage_rect>& damage) override;
     virtual void render() override;
     virtual void shutdown() override;
 };
@@ -203,7 +203,7 @@ color_channel pixelformat_b(pixelformat fmt) {
     case FORMAT_R5G6B5:
         return { 0, 5 };
     case FORMAT_B5G6R5:
-        return { 16, 5 };
+        return { 11, 5 };
     case FORMAT_GRAY8:
         return { 0, 8 };
     default:
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/ui/vnc.h"
+#include "vcml/properties/broker.h"
 
 namespace vcml {
 namespace ui {
@@ -208,28 +209,43 @@ static void rfb_err_func(const char* format, ...) {
     log_error("%s", trim(str).c_str());
 }
 
-static void rfb_key_func(rfbBool down, rfbKeySym sym, rfbClientPtr cl) {
+static vnc* find_vnc(rfbClientPtr cl) {
     int port = cl->screen->port;
     auto disp = display::lookup(mkstr("vnc:%d", port));
     VCML_ERROR_ON(!disp, "no display found for port %d", port);
     auto vnc_server = dynamic_cast<vnc*>(disp.get());
     VCML_ERROR_ON(!vnc_server, "no vnc server found for port %d", port);
-    vnc_server->key_event((u32)sym, (bool)down);
+    return vnc_server;
+}
+
+static void rfb_key_func(rfbBool down, rfbKeySym sym, rfbClientPtr cl) {
+    find_vnc(cl)->key_event((u32)sym, (bool)down);
 }
 
 static void rfb_ptr_func(int mask, int x, int y, rfbClientPtr cl) {
-    int port = cl->screen->port;
-    auto disp = display::lookup(mkstr("vnc:%d", port));
-    VCML_ERROR_ON(!disp, "no display found for port %d", port);
-    auto vnc_server = dynamic_cast<vnc*>(disp.get());
-    VCML_ERROR_ON(!vnc_server, "no vnc server found for port %d", port);
-    vnc_server->ptr_event((u32)mask, (u32)x, (u32)y);
+    find_vnc(cl)->ptr_event((u32)mask, (u32)x, (u32)y);
+}
+
+static void rfb_display_func(rfbClientPtr cl) {
+    // called before every update, overrides what the viewer asked for
+    vnc* vnc_server = find_vnc(cl);
+#ifdef LIBVNCSERVER_HAVE_LIBJPEG
+    if (vnc_server->quality() >= 0)
+        cl->tightQualityLevel = vnc_server->quality();
+#endif
+#ifdef LIBVNCSERVER_HAVE_LIBZ
+    if (vnc_server->compress() >= 0) {
+        cl->zlibCompressLevel = vnc_server->compress();
+        cl->tightCompressLevel = vnc_server->compress();
+    }
+#endif
 }
 
 void vnc::run() {
     mwr::set_thread_name(mkstr("vnc_%u", dispno()));
 
-    const videomode& fbm = mode();
+    const videomode& fbm = m_conv.is_valid() ? m_conv.dst() : mode();
+    u8* fb = m_conv.is_valid() ? m_shadow.data() : framebuffer();
 
     u32 samples = 0;
     if (fbm.a.size > 0)
@@ -244,11 +260,16 @@ void vnc::run() {
     rfbScreenInfo* screen = rfbGetScreen(nullptr, nullptr, fbm.xres, fbm.yres,
                                          fbm.r.size, samples, fbm.bpp);
 
-    screen->frameBuffer = (char*)framebuffer();
+    screen->frameBuffer = (char*)fb;
     screen->desktopName = name();
     screen->port = screen->ipv6port = m_port;
     screen->kbdAddEvent = &rfb_key_func;
     screen->ptrAddEvent = &rfb_ptr_func;
+    screen->displayHook = &rfb_display_func;
+
+    // libvncserver waits this long to collect changes before encoding
+    if (m_fps > 0.0)
+        screen->deferUpdateTime = max(1, (int)(1000.0 / m_fps));
 
     rfbInitServer(screen);
 
@@ -272,8 +293,16 @@ void vnc::run() {
 
     log_debug("starting vnc server on port %d", screen->port);
 
+#ifdef LIBVNCSERVER_HAVE_LIBPTHREAD
+    // each viewer gets its own thread that encodes its updates, so that
+    // several viewers and displays are encoded in parallel
+    rfbRunEventLoop(screen, -1, TRUE);
+    while (m_running && rfbIsActive(screen) && sim_running())
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+#else
     while (m_running && rfbIsActive(screen) && sim_running())
         rfbProcessEvents(screen, 1000);
+#endif
 
     log_debug("terminating vnc server on port %d", screen->port);
 
@@ -285,6 +314,25 @@ void vnc::run() {
     rfbScreenCleanup(screen);
 }
 
+void vnc::fork_prepare() {
+    m_resume = m_thread.joinable();
+    if (!m_resume)
+        return;
+
+    stop_workers();
+    m_running = false;
+    m_thread.join();
+}
+
+void vnc::fork_child() {
+    if (!m_resume)
+        return;
+
+    setup_bands();
+    m_running = true;
+    m_thread = thread(&vnc::run, this);
+}
+
 vnc::vnc(u32 no):
     display("vnc", no),
     m_port(no), // vnc port = display number
@@ -292,11 +340,32 @@ vnc::vnc(u32 no):
     m_ptr_x(),
     m_ptr_y(),
     m_running(false),
+    m_resume(false),
     m_mutex(),
     m_screen(),
-    m_thread() {
+    m_thread(),
+    m_conv(),
+    m_shadow(),
+    m_threads(),
+    m_quality(broker::get_or_default<int>("vnc.quality", -1)),
+    m_compress(broker::get_or_default<int>("vnc.compress", -1)),
+    m_fps(broker::get_or_default<double>("vnc.fps", 60.0)),
+    m_bands(),
+    m_damage(),
+    m_workers(),
+    m_work_mtx(),
+    m_work_cv(),
+    m_done_cv(),
+    m_work_gen(0),
+    m_work_left(0),
+    m_work_exit(false) {
     VCML_ERROR_ON(no != (u32)m_port, "invalid port specified: %u", no);
 
+    size_t ncpu = max<size_t>(thread::hardware_concurrency(), 1);
+    size_t nthreads = min<size_t>(ncpu, 4);
+    m_threads = broker::get_or_default<size_t>("vnc.threads", nthreads);
+    m_threads = max<size_t>(m_threads, 1);
+
     rfbLog = &rfb_log_func;
     rfbErr = &rfb_err_func;
 }
@@ -305,16 +374,31 @@ vnc::~vnc() {
     // nothing to do
 }
 
+bool vnc::needs_conversion(const videomode& mode) const {
+    // libvncserver only serves 8, 16 and 32bit pixels
+    return mode.bpp == 3;
+}
+
 void vnc::init(const videomode& mode, u8* fb) {
     display::init(mode, fb);
 
+    m_conv = pixel_converter();
+    m_shadow.clear();
+    if (needs_conversion(mode)) {
+        m_conv = pixel_converter(mode, FORMAT_X8R8G8B8);
+        m_shadow.resize(m_conv.dst().size);
+        m_conv.convert(m_shadow.data(), fb);
+    }
+
+    setup_bands();
+
     m_running = true;
     m_thread = thread(&vnc::run, this);
 }
 
 void vnc::render(u32 x, u32 y, u32 w, u32 h) {
     lock_guard<mutex> guard(m_mutex);
-    if (!m_screen)
+    if (x >= xres() || y >= yres())
         return;
 
     if (x + w > xres())
@@ -322,14 +406,27 @@ void vnc::render(u32 x, u32 y, u32 w, u32 h) {
     if (y + h > yres())
         h = yres() - y;
 
+    if (m_conv.is_valid())
+        m_conv.convert(m_shadow.data(), framebuffer(), x, y, w, h);
+
+    if (!m_screen)
+        return;
+
     rfbMarkRectAsModified(m_screen, x, y, x + w, y + h);
 }
 
 void vnc::render() {
-    render(0, 0, xres(), yres());
+    // only hand changed tiles to libvncserver, so that viewers never need
+    // to encode parts of the screen that did not change
+    scan_frame();
+    for (size_t band = 0; band < m_bands.size(); band++)
+        for (const damage_rect& r : m_damage[band])
+            render(r.x, r.y, r.w, r.h);
 }
 
 void vnc::shutdown() {
+    stop_workers();
+
     if (m_thread.joinable()) {
         m_running = false;
         m_thread.join();
@@ -338,6 +435,98 @@ void vnc::shutdown() {
     display::shutdown();
 }
 
+void vnc::setup_bands() {
+    const videomode& fbm = mode();
+    size_t rows = (fbm.yres + damage_tracker::TILE_H - 1) /
+                  damage_tracker::TILE_H;
+    size_t nbands = min(m_threads, max<size_t>(rows, 1));
+    u32 height = ((rows + nbands - 1) / nbands) * damage_tracker::TILE_H;
+
+    m_bands.clear();
+    m_damage.clear();
+
+    for (u32 y = 0; y < fbm.yres; y += height) {
+        videomode band = fbm;
+        band.yres = min(height, fbm.yres - y);
+        band.size = band.stride * band.yres;
+
+        m_bands.emplace_back();
+        m_bands.back().setup(band, framebuffer() + y * fbm.stride);
+        m_damage.emplace_back();
+    }
+
+    m_work_gen = 0;
+    m_work_exit = false;
+    for (size_t band = 1; band < m_bands.size(); band++)
+        m_workers.emplace_back(&vnc::work, this, band);
+}
+
+void vnc::stop_workers() {
+    {
+        lock_guard<mutex> guard(m_work_mtx);
+        m_work_exit = true;
+    }
+
+    m_work_cv.notify_all();
+    for (thread& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+}
+
+void vnc::scan_band(size_t band) {
+    const damage_tracker& tracker = m_bands[band];
+    u32 y = (tracker.framebuffer() - framebuffer()) / mode().stride;
+
+    m_bands[band].update(m_damage[band]);
+    for (damage_rect& r : m_damage[band])
+        r.y += y;
+}
+
+void vnc::scan_frame() {
+    if (m_bands.empty())
+        return;
+
+    {
+        lock_guard<mutex> guard(m_work_mtx);
+        m_work_left = m_bands.size() - 1;
+        m_work_gen++;
+    }
+
+    m_work_cv.notify_all();
+    scan_band(0);
+
+    std::unique_lock<mutex> lock(m_work_mtx);
+    m_done_cv.wait(lock, [&] { return m_work_left == 0; });
+}
+
+void vnc::work(size_t band) {
+    mwr::set_thread_name(mkstr("vnc_%u_%zu", dispno(), band));
+
+    size_t gen = 0;
+    while (true) {
+        {
+            std::unique_lock<mutex> lock(m_work_mtx);
+            m_work_cv.wait(lock, [&] {
+                return m_work_exit || m_work_gen != gen;
+            });
+
+            if (m_work_exit)
+                return;
+
+            gen = m_work_gen;
+        }
+
+        scan_band(band);
+
+        {
+            lock_guard<mutex> guard(m_work_mtx);
+            m_work_left--;
+        }
+
+        m_done_cv.notify_one();
+    }
+}
+
 void vnc::key_event(u32 sym, bool down) {
     u32 symbol = vnc_keysym_to_vcml_keysym(sym);
     if (symbol != KEYSYM_NONE)
@@ -13,11 +13,14 @@
 
 #include "vcml/core/types.h"
 #include "vcml/core/systemc.h"
+#include "vcml/core/fork.h"
 
 #include "vcml/logging/logger.h"
 
 #include "vcml/ui/keymap.h"
 #include "vcml/ui/video.h"
+#include "vcml/ui/convert.h"
+#include "vcml/ui/damage.h"
 #include "vcml/ui/display.h"
 
 #include <rfb/rfb.h>
@@ -26,7 +29,7 @@
 namespace vcml {
 namespace ui {
 
-class vnc : public display
+class vnc : public display, private fork_handler
 {
 private:
     u16 m_port;
@@ -34,18 +37,52 @@ private:
     u32 m_ptr_x;
     u32 m_ptr_y;
     atomic<bool> m_running;
+    bool m_resume;
     mutex m_mutex;
     rfbScreenInfo* m_screen;
     thread m_thread;
 
+    pixel_converter m_conv;
+    vector<u8> m_shadow;
+
+    size_t m_threads;
+    int m_quality;
+    int m_compress;
+    double m_fps;
+
+    // full frame renders are hashed in bands of tile rows, one per worker
+    vector<damage_tracker> m_bands;
+    vector<vector<damage_rect>> m_damage;
+    vector<thread> m_workers;
+    mutex m_work_mtx;
+    condition_variable m_work_cv;
+    condition_variable m_done_cv;
+    size_t m_work_gen;
+    size_t m_work_left;
+    bool m_work_exit;
+
     void run();
 
+    virtual void fork_prepare() override;
+    virtual void fork_child() override;
+
+    void setup_bands();
+    void stop_workers();
+    void scan_band(size_t band);
+    void scan_frame();
+    void work(size_t band);
+
 public:
     u16 port() const { return m_port; }
 
+    int quality() const { return m_quality; }
+    int compress() const { return m_compress; }
+
     vnc(u32 nr);
     virtual ~vnc();
 
+    virtual bool needs_conversion(const videomode& mode) const override;
+
     virtual void init(const videomode& mode, u8* fb) override;
     virtual void render(u32 x, u32 y, u32 w, u32 h) override;
     virtual void render() override;
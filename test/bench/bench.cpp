@@ -0,0 +1,35 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "bench.h"
+
+bench_base::bench_base(const sc_module_name& nm):
+    component(nm), m_reset("reset"), m_clock("clock", 100 * MHz) {
+    m_reset.rst.bind(rst);
+    m_clock.clk.bind(clk);
+    SC_HAS_PROCESS(bench_base);
+    SC_THREAD(run);
+}
+
+void bench_base::run() {
+    wait(SC_ZERO_TIME);
+    benchmark::RunSpecifiedBenchmarks();
+    sc_stop();
+}
+
+extern "C" int main(int argc, char** argv) {
+    // unknown arguments are left for the broker, e.g. -c for properties
+    ::benchmark::Initialize(&argc, argv);
+    ::mwr::report_segfaults();
+    ::vcml::broker_arg broker(argc, argv);
+    int result = sc_core::sc_elab_and_sim(argc, argv);
+    ::benchmark::Shutdown();
+    return result;
+}
@@ -0,0 +1,44 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_BENCH_H
+#define VCML_BENCH_H
+
+#include <benchmark/benchmark.h>
+
+#include <systemc>
+#include "vcml.h"
+
+using namespace ::sc_core;
+using namespace ::vcml;
+
+// benchmarks are run from a simulation thread, so they may use sockets,
+// events and wait; harnesses create all models they need during elaboration
+// and register their benchmarks from within their constructor
+class bench_base : public component
+{
+private:
+    generic::reset m_reset;
+    generic::clock m_clock;
+
+    void run();
+
+public:
+    bench_base() = delete;
+    bench_base(const sc_module_name& nm);
+    virtual ~bench_base() = default;
+
+    template <typename FN>
+    benchmark::internal::Benchmark* add_bench(const string& name, FN fn) {
+        return benchmark::RegisterBenchmark(name.c_str(), fn);
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+static const size_t BUS_SIZES[] = { 10, 50, 100, 500 };
+static const u64 BUS_STRIDE = 0x1000;
+
+// one bus per size, each with as many 4k mappings onto a common target
+class bus_bench : public bench_base
+{
+public:
+    sc_vector<generic::bus> buses;
+    tlm_initiator_array out;
+    tlm_target_array in;
+
+    bus_bench(const sc_module_name& nm):
+        bench_base(nm), buses("bus", 4), out("out"), in("in") {
+        for (size_t i = 0; i < buses.size(); i++) {
+            out[i].allow_dmi = false;
+            buses[i].bind(out[i]);
+            for (size_t j = 0; j < BUS_SIZES[i]; j++) {
+                u64 lo = j * BUS_STRIDE;
+                buses[i].bind(in[i], lo, lo + BUS_STRIDE - 1);
+            }
+
+            clk_bind(*this, "clk", buses[i], "clk");
+            gpio_bind(*this, "rst", buses[i], "rst");
+
+            string name = mkstr("bus/decode/%zu", BUS_SIZES[i]);
+            add_bench(name, [this, i](benchmark::State& state) {
+                decode(state, i, false);
+            });
+
+            name = mkstr("bus/decode_random/%zu", BUS_SIZES[i]);
+            add_bench(name, [this, i](benchmark::State& state) {
+                decode(state, i, true);
+            });
+        }
+    }
+
+    virtual unsigned int transport(tlm_generic_payload& tx,
+                                   const tlm_sbi& info,
+                                   address_space as) override {
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    // sequential accesses stay within one mapping for a while and thus
+    // benefit from the decode hint, random ones need a full lookup
+    void decode(benchmark::State& state, size_t idx, bool random) {
+        size_t n = BUS_SIZES[idx];
+        u32 seed = 1;
+        size_t count = 0;
+        u32 data = 0;
+
+        for (auto _ : state) {
+            size_t map = random ? (seed = seed * 1103515245 + 12345) % n
+                                : (count / 16) % n;
+            u64 addr = map * BUS_STRIDE + (count++ % 16) * 4;
+            benchmark::DoNotOptimize(out[idx].readw(addr, data));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    bus_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
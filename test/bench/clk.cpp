@@ -0,0 +1,67 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+class clk_bench : public bench_base
+{
+public:
+    clk_initiator_socket clk_out;
+    clk_target_socket clk_in;
+
+    size_t notified;
+
+    clk_bench(const sc_module_name& nm):
+        bench_base(nm), clk_out("clk_out"), clk_in("clk_in"), notified(0) {
+        clk_out.bind(clk_in);
+
+        add_bench("clk/change", [this](benchmark::State& state) {
+            change(state);
+        });
+
+        add_bench("clk/unchanged", [this](benchmark::State& state) {
+            unchanged(state);
+        });
+    }
+
+    virtual void clk_notify(const clk_target_socket& socket,
+                            const clk_payload& tx) override {
+        if (&socket == &clk_in)
+            notified++;
+        else
+            bench_base::clk_notify(socket, tx);
+    }
+
+    void change(benchmark::State& state) {
+        size_t count = 0;
+        for (auto _ : state)
+            clk_out = (count++ & 1) ? 100 * MHz : 50 * MHz;
+
+        benchmark::DoNotOptimize(notified);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // setting the current frequency again must not reach the target
+    void unchanged(benchmark::State& state) {
+        clk_out = 100 * MHz;
+        for (auto _ : state)
+            clk_out = 100 * MHz;
+
+        benchmark::DoNotOptimize(notified);
+        state.SetItemsProcessed(state.iterations());
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    clk_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+static const u64 DMI_STRIDE = 0x2000;
+static const u64 DMI_SIZE = 0x1000;
+
+static u8 dmi_buffer[DMI_STRIDE];
+
+// entries are spaced apart, so the cache cannot merge any of them
+static tlm_dmi make_dmi(size_t idx) {
+    tlm_dmi dmi;
+    dmi.set_start_address(idx * DMI_STRIDE);
+    dmi.set_end_address(idx * DMI_STRIDE + DMI_SIZE - 1);
+    dmi.set_dmi_ptr(dmi_buffer);
+    dmi.set_granted_access(tlm_dmi::DMI_ACCESS_READ_WRITE);
+    return dmi;
+}
+
+static void fill_cache(tlm_dmi_cache& cache, size_t n) {
+    cache.set_entry_limit(n);
+    for (size_t i = 0; i < n; i++)
+        cache.insert(make_dmi(i));
+}
+
+class dmi_bench : public bench_base
+{
+public:
+    dmi_bench(const sc_module_name& nm): bench_base(nm) {
+        add_bench("dmi/insert", &dmi_bench::insert)->Range(4, 256);
+        add_bench("dmi/lookup_hit", &dmi_bench::lookup_hit)->Range(4, 256);
+        add_bench("dmi/lookup_miss", &dmi_bench::lookup_miss)->Range(4, 256);
+        add_bench("dmi/invalidate", &dmi_bench::invalidate)->Range(4, 256);
+    }
+
+    static void insert(benchmark::State& state) {
+        size_t n = state.range(0);
+        for (auto _ : state) {
+            tlm_dmi_cache cache;
+            fill_cache(cache, n);
+            benchmark::DoNotOptimize(cache.get_entries().size());
+        }
+
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+
+    static void lookup_hit(benchmark::State& state) {
+        size_t n = state.range(0);
+        tlm_dmi_cache cache;
+        fill_cache(cache, n);
+
+        tlm_dmi dmi;
+        size_t idx = 0;
+        for (auto _ : state) {
+            u64 addr = (idx++ % n) * DMI_STRIDE + 0x10;
+            benchmark::DoNotOptimize(cache.lookup(addr, 4, TLM_READ_COMMAND,
+                                                  dmi));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    static void lookup_miss(benchmark::State& state) {
+        size_t n = state.range(0);
+        tlm_dmi_cache cache;
+        fill_cache(cache, n);
+
+        tlm_dmi dmi;
+        size_t idx = 0;
+        for (auto _ : state) {
+            u64 addr = (idx++ % n) * DMI_STRIDE + DMI_SIZE + 0x10;
+            benchmark::DoNotOptimize(cache.lookup(addr, 4, TLM_READ_COMMAND,
+                                                  dmi));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    static void invalidate(benchmark::State& state) {
+        size_t n = state.range(0);
+        for (auto _ : state) {
+            state.PauseTiming();
+            tlm_dmi_cache cache;
+            fill_cache(cache, n);
+            state.ResumeTiming();
+
+            for (size_t i = 0; i < n; i++)
+                cache.invalidate(i * DMI_STRIDE, i * DMI_STRIDE + 3);
+        }
+
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    dmi_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
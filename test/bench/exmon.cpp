@@ -0,0 +1,88 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+class exmon_bench : public bench_base
+{
+public:
+    exmon_bench(const sc_module_name& nm): bench_base(nm) {
+        add_bench("exmon/update", &exmon_bench::update)->Range(1, 64);
+        add_bench("exmon/has_lock", &exmon_bench::has_lock)->Range(1, 64);
+        add_bench("exmon/break", &exmon_bench::break_locks)->Range(1, 64);
+    }
+
+    // one exclusive load/store pair while n other cpus hold locks elsewhere
+    static void update(benchmark::State& state) {
+        int n = state.range(0);
+        tlm_exmon mon;
+        for (int cpu = 1; cpu <= n; cpu++)
+            mon.add_lock(cpu, { cpu * 0x100u, cpu * 0x100u + 3 });
+
+        sbiext ex;
+        ex.cpuid = 0;
+        ex.is_excl = true;
+
+        tlm_generic_payload tx;
+        tx.set_address(0x10);
+        tx.set_data_length(4);
+        tx.set_extension(&ex);
+
+        for (auto _ : state) {
+            tx.set_read();
+            benchmark::DoNotOptimize(mon.update(tx));
+            tx.set_write();
+            benchmark::DoNotOptimize(mon.update(tx));
+        }
+
+        tx.clear_extension(&ex);
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+
+    static void has_lock(benchmark::State& state) {
+        int n = state.range(0);
+        tlm_exmon mon;
+        for (int cpu = 0; cpu < n; cpu++)
+            mon.add_lock(cpu, { cpu * 0x100u, cpu * 0x100u + 3 });
+
+        int cpu = 0;
+        for (auto _ : state) {
+            range addr(cpu * 0x100u, cpu * 0x100u + 3);
+            benchmark::DoNotOptimize(mon.has_lock(cpu, addr));
+            cpu = (cpu + 1) % n;
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // plain stores break all locks that overlap the written range
+    static void break_locks(benchmark::State& state) {
+        int n = state.range(0);
+        tlm_exmon mon;
+        for (auto _ : state) {
+            state.PauseTiming();
+            for (int cpu = 0; cpu < n; cpu++)
+                mon.add_lock(cpu, { cpu * 0x100u, cpu * 0x100u + 3 });
+            state.ResumeTiming();
+
+            for (int cpu = 0; cpu < n; cpu++)
+                mon.break_locks({ cpu * 0x100u, cpu * 0x100u + 3 });
+        }
+
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    exmon_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
@@ -0,0 +1,89 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+class gpio_bench : public bench_base
+{
+public:
+    gpio_initiator_socket gpio_out;
+    gpio_target_socket gpio_in;
+
+    gpio_initiator_array gpio_array_out;
+    gpio_target_array gpio_array_in;
+
+    size_t notified;
+
+    gpio_bench(const sc_module_name& nm):
+        bench_base(nm),
+        gpio_out("gpio_out"),
+        gpio_in("gpio_in"),
+        gpio_array_out("gpio_array_out"),
+        gpio_array_in("gpio_array_in"),
+        notified(0) {
+        gpio_out.bind(gpio_in);
+        for (size_t i = 0; i < 32; i++)
+            gpio_array_out[i].bind(gpio_array_in[i]);
+
+        add_bench("gpio/toggle", [this](benchmark::State& state) {
+            toggle(state);
+        });
+
+        add_bench("gpio/toggle_array", [this](benchmark::State& state) {
+            toggle_array(state);
+        });
+
+        add_bench("gpio/unchanged", [this](benchmark::State& state) {
+            unchanged(state);
+        });
+    }
+
+    virtual void gpio_notify(const gpio_target_socket& socket,
+                             bool state) override {
+        notified++;
+    }
+
+    void toggle(benchmark::State& state) {
+        bool val = gpio_out;
+        for (auto _ : state)
+            gpio_out = (val = !val);
+
+        benchmark::DoNotOptimize(notified);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void toggle_array(benchmark::State& state) {
+        size_t count = 0;
+        for (auto _ : state) {
+            gpio_initiator_socket& out = gpio_array_out[count++ % 32];
+            out = !out;
+        }
+
+        benchmark::DoNotOptimize(notified);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // writing the current state again must not reach the target
+    void unchanged(benchmark::State& state) {
+        bool val = gpio_out;
+        for (auto _ : state)
+            gpio_out = val;
+
+        benchmark::DoNotOptimize(notified);
+        state.SetItemsProcessed(state.iterations());
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    gpio_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
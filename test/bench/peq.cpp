@@ -0,0 +1,71 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+class peq_bench : public bench_base
+{
+public:
+    peq<int> tree;
+    peq<int> heap;
+
+    peq_bench(const sc_module_name& nm):
+        bench_base(nm), tree("tree", PEQ_TREE), heap("heap", PEQ_HEAP) {
+        add_bench("peq/tree/notify_wait", [this](benchmark::State& state) {
+            notify_wait(state, tree);
+        })->Range(1, 1024);
+
+        add_bench("peq/heap/notify_wait", [this](benchmark::State& state) {
+            notify_wait(state, heap);
+        })->Range(1, 1024);
+
+        add_bench("peq/tree/cancel", [this](benchmark::State& state) {
+            cancel(state, tree);
+        })->Range(1, 1024);
+
+        add_bench("peq/heap/cancel", [this](benchmark::State& state) {
+            cancel(state, heap);
+        })->Range(1, 1024);
+    }
+
+    // schedules n payloads at distinct times and waits for all of them
+    static void notify_wait(benchmark::State& state, peq<int>& queue) {
+        int n = state.range(0);
+        int val;
+
+        for (auto _ : state) {
+            for (int i = n; i > 0; i--)
+                queue.notify(i, sc_time(i, SC_NS));
+            for (int i = 0; i < n; i++)
+                queue.wait(val);
+        }
+
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+
+    static void cancel(benchmark::State& state, peq<int>& queue) {
+        int n = state.range(0);
+        for (auto _ : state) {
+            for (int i = 0; i < n; i++)
+                queue.notify(i, sc_time(i + 1, SC_NS));
+            for (int i = 0; i < n; i++)
+                queue.cancel(i);
+        }
+
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    peq_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
@@ -0,0 +1,102 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+static const size_t REG_COUNTS[] = { 8, 64, 256 };
+
+class bench_peripheral : public peripheral
+{
+public:
+    vector<unique_ptr<reg<u32>>> regs;
+    reg<u32> cbreg;
+    u32 value;
+
+    bench_peripheral(const sc_module_name& nm, size_t nregs):
+        peripheral(nm), regs(), cbreg("cbreg", nregs * 4), value(0) {
+        for (size_t i = 0; i < nregs; i++) {
+            string name = mkstr("reg%zu", i);
+            regs.emplace_back(new reg<u32>(name, i * 4));
+            regs.back()->allow_read_write();
+        }
+
+        cbreg.allow_read_write();
+        cbreg.on_read([&]() -> u32 { return value; });
+        cbreg.on_write([&](u32 val) -> void { value = val; });
+    }
+};
+
+class peripheral_bench : public bench_base
+{
+public:
+    tlm_initiator_array out;
+    vector<unique_ptr<bench_peripheral>> periphs;
+
+    peripheral_bench(const sc_module_name& nm):
+        bench_base(nm), out("out"), periphs() {
+        for (size_t n : REG_COUNTS) {
+            size_t i = periphs.size();
+            string name = mkstr("periph%zu", n);
+            periphs.emplace_back(new bench_peripheral(name.c_str(), n));
+            out[i].allow_dmi = false;
+            out[i].bind(periphs[i]->in);
+            clk_bind(*this, "clk", *periphs[i], "clk");
+            gpio_bind(*this, "rst", *periphs[i], "rst");
+
+            add_bench(mkstr("peripheral/receive/%zu", n),
+                      [this, i](benchmark::State& state) {
+                          receive(state, i);
+                      });
+        }
+
+        add_bench("reg/read_callback", [this](benchmark::State& state) {
+            callback(state, false);
+        });
+
+        add_bench("reg/write_callback", [this](benchmark::State& state) {
+            callback(state, true);
+        });
+    }
+
+    // walks all registers, so that each access needs to be dispatched anew
+    void receive(benchmark::State& state, size_t idx) {
+        size_t n = REG_COUNTS[idx];
+        size_t count = 0;
+        u32 data = 0;
+
+        for (auto _ : state) {
+            u64 addr = (count++ % n) * 4;
+            benchmark::DoNotOptimize(out[idx].readw(addr, data));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void callback(benchmark::State& state, bool write) {
+        u64 addr = periphs[0]->cbreg.get_address();
+        u32 data = 0;
+
+        for (auto _ : state) {
+            if (write)
+                benchmark::DoNotOptimize(out[0].writew(addr, data++));
+            else
+                benchmark::DoNotOptimize(out[0].readw(addr, data));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    peripheral_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
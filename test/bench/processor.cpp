@@ -0,0 +1,190 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+static const size_t MAX_CORES = 8;
+static const size_t QUANTA = 100; // quanta simulated per iteration
+
+// does nothing but advance its cycle count, so everything measured is
+// scheduling overhead; parked processors stop at the next quantum boundary
+// and do not take part in simulation until they are unparked again
+class bench_cpu : public processor
+{
+private:
+    u64 m_cycles;
+    atomic<bool> m_parked;
+    bool m_blocked;
+    sc_event m_unpark_ev;
+
+public:
+    bench_cpu(const sc_module_name& nm):
+        processor(nm, "bench"),
+        m_cycles(0),
+        m_parked(true),
+        m_blocked(false),
+        m_unpark_ev("unpark_ev") {
+        insn.stub();
+        data.stub();
+    }
+
+    virtual ~bench_cpu() = default;
+
+    bool is_parked() const { return m_blocked; }
+
+    void park() { m_parked = true; }
+
+    void unpark(bool use_async) {
+        async = use_async;
+        m_parked = false;
+        set_running(true);
+        m_unpark_ev.notify(SC_ZERO_TIME);
+    }
+
+    virtual u64 cycle_count() const override { return m_cycles; }
+
+    // may run on an async thread, leaving the processor loop is done by
+    // marking the target as halted
+    virtual void simulate(size_t cycles) override {
+        m_cycles += cycles;
+        if (m_parked)
+            set_running(false);
+    }
+
+    virtual void wait_clock_reset() override {
+        while (m_parked) {
+            m_blocked = true;
+            wait(m_unpark_ev);
+        }
+
+        m_blocked = false;
+        processor::wait_clock_reset();
+    }
+};
+
+class processor_bench : public bench_base
+{
+public:
+    sc_vector<bench_cpu> cpus;
+
+    processor_bench(const sc_module_name& nm):
+        bench_base(nm), cpus("cpu", MAX_CORES) {
+        for (bench_cpu& cpu : cpus) {
+            clk_bind(*this, "clk", cpu, "clk");
+            gpio_bind(*this, "rst", cpu, "rst");
+        }
+
+        for (bool async : { false, true }) {
+            for (unsigned int us : { 1, 10, 100, 1000 }) {
+                for (size_t cores = 1; cores <= MAX_CORES; cores *= 2) {
+                    string name = mkstr("processor/%s/%uus/%zu",
+                                        async ? "async" : "sync", us, cores);
+                    sc_time quantum((double)us, SC_US);
+                    add_bench(name, [this, async, quantum,
+                                     cores](benchmark::State& state) {
+                        run_quanta(state, async, quantum, cores);
+                    })->UseRealTime();
+                }
+            }
+        }
+
+        add_bench("processor/suspender", &processor_bench::check_suspender);
+        add_bench("processor/sync", [this](benchmark::State& state) {
+            sync_local(state);
+        });
+
+        add_bench("processor/sc_progress", &processor_bench::progress)
+            ->UseRealTime();
+    }
+
+    void park_all() {
+        for (bench_cpu& cpu : cpus)
+            cpu.park();
+
+        sc_time quantum = tlm_global_quantum::instance().get();
+        sc_time step = max(quantum, clock_cycle());
+        for (bench_cpu& cpu : cpus) {
+            while (!cpu.is_parked())
+                wait(step);
+        }
+    }
+
+    void run_quanta(benchmark::State& state, bool async,
+                    const sc_time& quantum, size_t cores) {
+        park_all();
+        tlm_global_quantum::instance().set(quantum);
+        for (size_t i = 0; i < cores; i++)
+            cpus[i].unpark(async);
+
+        u64 quanta = 0;
+        double sync_time = 0.0;
+        for (size_t i = 0; i < cores; i++) {
+            processor_stats stats = cpus[i].get_stats();
+            quanta -= stats.num_quanta;
+            sync_time -= stats.sync_time;
+        }
+
+        double start = mwr::timestamp();
+        for (auto _ : state)
+            wait(quantum * QUANTA);
+        double elapsed = mwr::timestamp() - start;
+
+        for (size_t i = 0; i < cores; i++) {
+            processor_stats stats = cpus[i].get_stats();
+            quanta += stats.num_quanta;
+            sync_time += stats.sync_time;
+        }
+
+        park_all();
+
+        // overhead per quantum and core, sync_share tells how much of it
+        // the processors spent waiting for systemc to catch up
+        state.counters["quanta"] = benchmark::Counter(
+            quanta, benchmark::Counter::kIsRate);
+        state.counters["ns_per_quantum"] = quanta ? elapsed * 1e9 / quanta
+                                                  : 0.0;
+        state.counters["sync_share"] = sync_time / (elapsed * cores);
+    }
+
+    // the check each processor does at the start of every quantum
+    static void check_suspender(benchmark::State& state) {
+        for (auto _ : state)
+            debugging::suspender::handle_requests();
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // the synchronization each processor does at the end of a quantum
+    void sync_local(benchmark::State& state) {
+        for (auto _ : state) {
+            local_time() += clock_cycle();
+            tlm_host::sync();
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // the progress reports an async processor makes after each step
+    static void progress(benchmark::State& state) {
+        sc_time step(10, SC_NS);
+        sc_async([&]() -> void {
+            for (auto _ : state)
+                sc_progress(step);
+        });
+
+        state.SetItemsProcessed(state.iterations());
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    processor_bench bench("bench");
+    sc_core::sc_start();
+    return 0;
+}
@@ -0,0 +1,509 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "bench.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+enum : u64 {
+    MEM_SIZE = 64 * MiB,
+    RING_STRIDE = 64 * KiB, // rings of queue n start at n * RING_STRIDE
+    DATA_BASE = 1 * MiB,
+    SLOT_SIZE = 128 * KiB, // one slot holds the buffers of one request
+    DISK_SIZE = 64 * MiB, // also update the ramdisk image in sc_main
+};
+
+static const u32 QUEUE_SIZE = 256;
+static const u32 BATCH = 32;
+
+// completions of asynchronous disk i/o arrive from other threads, waiting
+// with a timeout keeps the simulation from running out of events meanwhile
+static const sc_time POLL_TIMEOUT(1.0, SC_US);
+
+static double cpu_time() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+}
+
+// driver side of a split or packed virtqueue: places descriptor chains in
+// guest memory and collects them after the device has used them, just like
+// a guest driver; the packed variant expects in-order completion
+class vq_driver
+{
+private:
+    struct split_desc {
+        u64 addr;
+        u32 len;
+        u16 flags;
+        u16 next;
+    };
+
+    struct packed_desc {
+        u64 addr;
+        u32 len;
+        u16 id;
+        u16 flags;
+    };
+
+    enum desc_flags : u16 {
+        F_NEXT = 1u << 0,
+        F_WRITE = 1u << 1,
+        F_PACKED_AVAIL = 1u << 7,
+        F_PACKED_USED = 1u << 15,
+    };
+
+    u8* m_mem;
+    bool m_packed;
+    u32 m_size;
+
+    vector<u16> m_free;
+    vector<vector<u16>> m_chains;
+
+    u16 m_avail_idx;
+    u16 m_used_idx;
+    bool m_wrap_avail;
+    bool m_wrap_used;
+
+    template <typename T>
+    T* ptr(u64 addr) const {
+        return (T*)(m_mem + addr);
+    }
+
+public:
+    struct buffer {
+        u64 addr;
+        u32 len;
+        bool write;
+    };
+
+    const u64 desc;
+    const u64 driver;
+    const u64 device;
+
+    vq_driver(u8* mem, u64 base, u32 size, bool packed):
+        m_mem(mem),
+        m_packed(packed),
+        m_size(size),
+        m_free(),
+        m_chains(size),
+        m_avail_idx(0),
+        m_used_idx(0),
+        m_wrap_avail(true),
+        m_wrap_used(true),
+        desc(base),
+        driver(base + 16 * KiB),
+        device(base + 32 * KiB) {
+        memset(m_mem + base, 0, RING_STRIDE);
+        for (u32 i = size; i > 0; i--)
+            m_free.push_back(i - 1);
+    }
+
+    size_t num_free() const { return m_free.size(); }
+
+    bool add(const vector<buffer>& bufs);
+    bool poll();
+};
+
+bool vq_driver::add(const vector<buffer>& bufs) {
+    if (bufs.empty() || bufs.size() > m_free.size())
+        return false;
+
+    if (m_packed) {
+        // packed rings hand out descriptors in ring order, ids are the ring
+        // positions of their heads
+        u16 head = m_avail_idx;
+        u16 head_flags = 0;
+        for (size_t i = 0; i < bufs.size(); i++) {
+            packed_desc* d = ptr<packed_desc>(desc) + m_avail_idx;
+            u16 flags = bufs[i].write ? F_WRITE : 0;
+            if (i + 1 < bufs.size())
+                flags |= F_NEXT;
+            flags |= m_wrap_avail ? F_PACKED_AVAIL : F_PACKED_USED;
+
+            d->addr = bufs[i].addr;
+            d->len = bufs[i].len;
+            d->id = head;
+            if (i > 0)
+                d->flags = flags;
+            else
+                head_flags = flags;
+
+            m_chains[head].push_back(m_free.back());
+            m_free.pop_back();
+
+            if (++m_avail_idx == m_size) {
+                m_avail_idx = 0;
+                m_wrap_avail = !m_wrap_avail;
+            }
+        }
+
+        // making the head available publishes the whole chain
+        ptr<packed_desc>(desc)[head].flags = head_flags;
+        return true;
+    }
+
+    vector<u16>& chain = m_chains[m_free.back()];
+    for (size_t i = 0; i < bufs.size(); i++) {
+        chain.push_back(m_free.back());
+        m_free.pop_back();
+    }
+
+    split_desc* descs = ptr<split_desc>(desc);
+    for (size_t i = 0; i < bufs.size(); i++) {
+        split_desc& d = descs[chain[i]];
+        d.addr = bufs[i].addr;
+        d.len = bufs[i].len;
+        d.flags = bufs[i].write ? F_WRITE : 0;
+        d.next = 0;
+        if (i + 1 < bufs.size()) {
+            d.flags |= F_NEXT;
+            d.next = chain[i + 1];
+        }
+    }
+
+    u16* avail = ptr<u16>(driver);
+    avail[2 + m_avail_idx % m_size] = chain[0];
+    avail[1] = ++m_avail_idx;
+    return true;
+}
+
+bool vq_driver::poll() {
+    u16 id;
+    if (m_packed) {
+        packed_desc* d = ptr<packed_desc>(desc) + m_used_idx;
+        bool avail = d->flags & F_PACKED_AVAIL;
+        bool used = d->flags & F_PACKED_USED;
+        if (avail != m_wrap_used || used != m_wrap_used)
+            return false;
+
+        id = m_used_idx;
+        m_used_idx += m_chains[id].size();
+        if (m_used_idx >= m_size) {
+            m_used_idx -= m_size;
+            m_wrap_used = !m_wrap_used;
+        }
+    } else {
+        u16* used = ptr<u16>(device);
+        if (m_used_idx == used[1])
+            return false;
+
+        u32* ring = ptr<u32>(device + 4);
+        id = ring[2 * (m_used_idx++ % m_size)];
+    }
+
+    vector<u16>& chain = m_chains[id];
+    m_free.insert(m_free.end(), chain.rbegin(), chain.rend());
+    chain.clear();
+    return true;
+}
+
+// stands in for the virtio transport and the guest driver at once: queues
+// are set up directly in guest memory and device notifications are
+// delivered without any register accesses
+class virtio_driver : public module, public virtio_controller
+{
+private:
+    u8* m_mem;
+    virtio_device_desc m_desc;
+    std::map<u32, unique_ptr<virtqueue>> m_queues;
+    std::map<u32, unique_ptr<vq_driver>> m_drivers;
+
+public:
+    sc_event used_ev;
+    virtio_initiator_socket virtio_out;
+
+    virtio_driver(const sc_module_name& nm, u8* mem):
+        module(nm),
+        virtio_controller(),
+        m_mem(mem),
+        m_desc(),
+        m_queues(),
+        m_drivers(),
+        used_ev("used_ev"),
+        virtio_out("virtio_out") {
+        // nothing to do
+    }
+
+    virtual ~virtio_driver() = default;
+
+    vq_driver& queue(u32 vqid) { return *m_drivers.at(vqid); }
+
+    void setup(bool packed, u64 features);
+
+    void kick(u32 vqid) { virtio_out->notify(vqid); }
+
+    virtual bool put(u32 vqid, vq_message& msg) override;
+    virtual bool get(u32 vqid, vq_message& msg) override;
+    virtual bool notify() override { return true; }
+};
+
+void virtio_driver::setup(bool packed, u64 features) {
+    m_queues.clear();
+    m_drivers.clear();
+
+    m_desc.reset();
+    virtio_out->identify(m_desc);
+
+    u64 offered = 0;
+    virtio_out->read_features(offered);
+    if (!virtio_out->write_features(offered & features))
+        VCML_ERROR("%s: feature negotiation failed", name());
+
+    virtio_dmifn dmi = [this](u64 addr, u64 size, vcml_access a) -> u8* {
+        return addr + size <= MEM_SIZE ? m_mem + addr : nullptr;
+    };
+
+    hierarchy_guard guard(this);
+    for (auto& it : m_desc.virtqueues) {
+        virtio_queue_desc& qd = it.second;
+        qd.size = min(qd.limit, QUEUE_SIZE);
+
+        auto drv = new vq_driver(m_mem, qd.id * RING_STRIDE, qd.size, packed);
+        qd.desc = drv->desc;
+        qd.driver = drv->driver;
+        qd.device = drv->device;
+        m_drivers[qd.id].reset(drv);
+
+        virtqueue* q;
+        if (packed)
+            q = new packed_virtqueue(qd, dmi);
+        else
+            q = new split_virtqueue(qd, dmi);
+        m_queues[qd.id].reset(q);
+        VCML_ERROR_ON(!q->validate(), "%s: invalid virtqueue", name());
+    }
+}
+
+bool virtio_driver::put(u32 vqid, vq_message& msg) {
+    auto it = m_queues.find(vqid);
+    if (it == m_queues.end() || !it->second->put(msg))
+        return false;
+
+    used_ev.notify(SC_ZERO_TIME);
+    return true;
+}
+
+bool virtio_driver::get(u32 vqid, vq_message& msg) {
+    auto it = m_queues.find(vqid);
+    return it != m_queues.end() && it->second->get(msg);
+}
+
+enum blk_request_type : u32 {
+    BLK_T_IN = 0,
+    BLK_T_OUT = 1,
+};
+
+struct blk_request {
+    u32 type;
+    u32 reserved;
+    u64 sector;
+};
+
+struct net_header {
+    u8 flags;
+    u8 gso_type;
+    u16 hdr_len;
+    u16 gso_size;
+    u16 csum_start;
+    u16 csum_offset;
+    u16 num_buffers;
+};
+
+static const string DISK_FILE = "/tmp/vcml-bench-virtio.img";
+
+class virtio_bench : public bench_base
+{
+public:
+    generic::memory mem;
+
+    virtio_driver ram_drv;
+    virtio_driver file_drv;
+    virtio_driver net_drv;
+
+    virtio::blk blk_ram;
+    virtio::blk blk_file;
+    virtio::net net;
+
+    virtio_bench(const sc_module_name& nm):
+        bench_base(nm),
+        mem("mem", MEM_SIZE),
+        ram_drv("ram_drv", mem.data()),
+        file_drv("file_drv", mem.data()),
+        net_drv("net_drv", mem.data()),
+        blk_ram("blk_ram"),
+        blk_file("blk_file"),
+        net("net") {
+        clk_bind(*this, "clk", mem, "clk");
+        gpio_bind(*this, "rst", mem, "rst");
+        mem.in.stub();
+
+        ram_drv.virtio_out.bind(blk_ram.virtio_in);
+        file_drv.virtio_out.bind(blk_file.virtio_in);
+        net_drv.virtio_out.bind(net.virtio_in);
+
+        // frames sent by the device come right back to it
+        net.eth_tx.bind(net.eth_rx);
+
+        for (bool packed : { false, true }) {
+            for (u32 size : { 4 * KiB, 64 * KiB }) {
+                for (bool write : { false, true }) {
+                    add_blk("ram", ram_drv, packed, write, size);
+                    add_blk("file", file_drv, packed, write, size);
+                }
+            }
+
+            for (u32 size : { 64, 1500 }) {
+                const char* ring = packed ? "packed" : "split";
+                string name = mkstr("virtio/net/loopback/%s/%u", ring, size);
+                add_bench(name, [this, packed, size](benchmark::State& st) {
+                    run_net(st, packed, size);
+                })->UseRealTime();
+            }
+        }
+    }
+
+    void add_blk(const char* backend, virtio_driver& drv, bool packed,
+                 bool write, u32 size) {
+        string name = mkstr("virtio/blk/%s/%s/%s/%u", backend,
+                            packed ? "packed" : "split",
+                            write ? "write" : "read", size);
+        add_bench(name, [this, &drv, packed, write,
+                         size](benchmark::State& st) {
+            run_blk(st, drv, packed, write, size);
+        })->UseRealTime();
+    }
+
+    static void finish(benchmark::State& state, double cpu, size_t bytes) {
+        size_t requests = state.iterations() * BATCH;
+        state.SetItemsProcessed(requests);
+        state.SetBytesProcessed(requests * bytes);
+        state.counters["cpu_us_per_req"] = cpu * 1e6 / requests;
+    }
+
+    // each iteration submits a batch of requests and waits for all of them
+    void run_blk(benchmark::State& state, virtio_driver& drv, bool packed,
+                 bool write, u32 size) {
+        drv.setup(packed, 0);
+        vq_driver& vq = drv.queue(0);
+        u64 nsectors = DISK_SIZE / 512;
+        u64 sector = 0;
+
+        double cpu = cpu_time();
+        for (auto _ : state) {
+            for (u32 i = 0; i < BATCH; i++) {
+                u64 slot = DATA_BASE + i * SLOT_SIZE;
+                blk_request* req = (blk_request*)(mem.data() + slot);
+                req->type = write ? BLK_T_OUT : BLK_T_IN;
+                req->reserved = 0;
+                req->sector = sector;
+                sector = (sector + size / 512) % nsectors;
+
+                vector<vq_driver::buffer> bufs = {
+                    { slot, sizeof(blk_request), false },
+                    { slot + 4 * KiB, size, !write },
+                    { slot + sizeof(blk_request), 1, true },
+                };
+
+                if (!vq.add(bufs))
+                    VCML_ERROR("virtqueue overflow");
+            }
+
+            drv.kick(0);
+            for (u32 done = 0; done < BATCH;) {
+                while (vq.poll())
+                    done++;
+                if (done < BATCH)
+                    wait(POLL_TIMEOUT, drv.used_ev);
+            }
+        }
+
+        finish(state, cpu_time() - cpu, size);
+    }
+
+    // frames travel from the tx queue through the loopback into the rx
+    // queue; rx buffers are reposted for every frame received
+    void run_net(benchmark::State& state, bool packed, u32 size) {
+        net_drv.setup(packed, 0);
+        vq_driver& rx = net_drv.queue(virtio::net::VIRTQUEUE_RX);
+        vq_driver& tx = net_drv.queue(virtio::net::VIRTQUEUE_TX);
+
+        const u64 rxbase = DATA_BASE;
+        const u64 txbase = DATA_BASE + QUEUE_SIZE * 2 * KiB;
+        memset(mem.data() + txbase, 0xff, QUEUE_SIZE * 2 * KiB);
+
+        u32 rxslot = 0;
+        auto post_rx = [&]() -> void {
+            u64 addr = rxbase + (rxslot++ % QUEUE_SIZE) * 2 * KiB;
+            if (!rx.add({ { addr, 2 * KiB, true } }))
+                VCML_ERROR("rx virtqueue overflow");
+        };
+
+        for (u32 i = 0; i < BATCH; i++)
+            post_rx();
+        net_drv.kick(virtio::net::VIRTQUEUE_RX);
+
+        double cpu = cpu_time();
+        for (auto _ : state) {
+            for (u32 i = 0; i < BATCH; i++) {
+                u64 addr = txbase + i * 2 * KiB;
+                memset(mem.data() + addr, 0, sizeof(net_header));
+                u32 len = sizeof(net_header) + size;
+                if (!tx.add({ { addr, len, false } }))
+                    VCML_ERROR("tx virtqueue overflow");
+            }
+
+            net_drv.kick(virtio::net::VIRTQUEUE_TX);
+            for (u32 done = 0; done < BATCH;) {
+                while (tx.poll())
+                    continue;
+
+                u32 received = 0;
+                while (rx.poll())
+                    received++;
+
+                for (u32 i = 0; i < received; i++)
+                    post_rx();
+                if (received)
+                    net_drv.kick(virtio::net::VIRTQUEUE_RX);
+
+                done += received;
+                if (done < BATCH)
+                    wait(POLL_TIMEOUT, net_drv.used_ev);
+            }
+        }
+
+        while (tx.poll())
+            continue;
+
+        finish(state, cpu_time() - cpu, size);
+    }
+};
+
+extern "C" int sc_main(int argc, char** argv) {
+    int fd = ::open(DISK_FILE.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    VCML_ERROR_ON(fd < 0, "cannot create %s", DISK_FILE.c_str());
+    VCML_ERROR_ON(::ftruncate(fd, DISK_SIZE) < 0, "cannot resize disk");
+    ::close(fd);
+
+    broker brk("bench");
+    brk.define("bench.blk_ram.image", "ramdisk:64MiB");
+    brk.define("bench.blk_file.image", DISK_FILE);
+
+    virtio_bench bench("bench");
+    sc_core::sc_start();
+
+    std::remove(DISK_FILE.c_str());
+    return 0;
+}
@@ -75,6 +75,13 @@ public:
         data = 0;
         EXPECT_OK(test3_out32.readw(0x1234, data));
         EXPECT_EQ(data, ~0ull);
+
+        // debug accesses go straight through to the final target
+        data = 0;
+        EXPECT_OK(test1_out32.readw(0x1234, data, SBI_DEBUG));
+        EXPECT_EQ(data, ~0ull);
+        EXPECT_EQ(test1_in32.stats().num_debug, 1u);
+        EXPECT_EQ(test1_in32.stats().num_transactions, 1u);
     }
 };
 
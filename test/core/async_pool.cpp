@@ -0,0 +1,62 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class async_pool_test : public test_base
+{
+public:
+    enum : size_t { NUM_JOBS = 4 };
+
+    atomic<size_t> jobs_done;
+
+    void job(size_t id) {
+        wait(SC_ZERO_TIME);
+
+        sc_time duration(id + 1, SC_SEC);
+        sc_async([&]() -> void {
+            EXPECT_FALSE(thctl_is_sysc_thread());
+
+            for (size_t i = 0; i < 10; i++) {
+                mwr::usleep(100);
+                sc_progress(duration / 10);
+            }
+
+            sc_sync([&]() -> void {
+                EXPECT_TRUE(thctl_is_sysc_thread());
+                jobs_done++;
+            });
+        });
+
+        EXPECT_EQ(sc_time_stamp(), duration);
+    }
+
+    async_pool_test(const sc_module_name& nm):
+        test_base(nm), jobs_done(0) {
+        for (size_t i = 0; i < NUM_JOBS; i++) {
+            sc_spawn_options opts;
+            sc_spawn([this, i]() -> void { job(i); },
+                     mkstr("job%zu", i).c_str(), &opts);
+        }
+    }
+
+    virtual void run_test() override {
+        wait((NUM_JOBS + 1) * sc_time(1, SC_SEC));
+        EXPECT_EQ(jobs_done, NUM_JOBS);
+    }
+};
+
+TEST(async, pool) {
+    // fewer pool threads than jobs forces queueing and stealing
+    sc_async_pool(2);
+
+    async_pool_test test("async");
+    sc_core::sc_start();
+}
@@ -16,6 +16,43 @@ class async_timer_test : public test_base
 public:
     async_timer_test(const sc_module_name& nm): test_base(nm) {}
 
+    void test_wheel() {
+        vector<unique_ptr<async_timer>> timers;
+        vector<sc_time> fired;
+
+        // spread timeouts across several wheel levels
+        const sc_time deltas[] = {
+            sc_time(0, SC_PS),  sc_time(3, SC_PS),  sc_time(200, SC_PS),
+            sc_time(70, SC_NS), sc_time(5, SC_US),  sc_time(17, SC_US),
+            sc_time(2, SC_MS),  sc_time(40, SC_MS), sc_time(1, SC_SEC),
+        };
+
+        for (const sc_time& delta : deltas) {
+            for (int i = 0; i < 4; i++) {
+                auto cb = [&](async_timer& t) -> void {
+                    EXPECT_EQ(sc_time_stamp(), t.timeout());
+                    fired.push_back(t.timeout());
+                };
+
+                timers.emplace_back(new async_timer(delta, cb));
+            }
+        }
+
+        // cancel every other timer, re-arm every fourth one later on
+        for (size_t i = 0; i < timers.size(); i += 2)
+            timers[i]->cancel();
+        for (size_t i = 0; i < timers.size(); i += 4)
+            timers[i]->reset(timers[i + 1]->timeout() - sc_time_stamp() +
+                             sc_time(1, SC_PS));
+
+        wait(2, SC_SEC);
+
+        EXPECT_EQ(fired.size(), timers.size() * 3 / 4);
+        EXPECT_TRUE(std::is_sorted(fired.begin(), fired.end()));
+        for (size_t i = 0; i < timers.size(); i++)
+            EXPECT_EQ(timers[i]->count(), i % 4 == 2 ? 0 : 1) << i;
+    }
+
     virtual void run_test() override {
         async_timer t1(1, SC_MS, [](async_timer& t) -> void {
             EXPECT_EQ(sc_time_stamp(), t.timeout());
@@ -56,6 +93,8 @@ public:
             wait(1, SC_US);
 
         async.join();
+
+        test_wheel();
     }
 };
 
@@ -38,4 +38,42 @@ TEST(broker, file) {
     EXPECT_DEF(broker, "loop.iter1", "1");
     EXPECT_DEF(broker, "loop.iter2", "2");
     EXPECT_UDF(broker, "loop.iter3");
+    EXPECT_DEF(broker, "deferred", "99-7");
+    EXPECT_DEF(broker, "deferred", "99-7");
+}
+
+TEST(broker, wildcards) {
+    mwr::publishers::terminal logger;
+    broker high("high");
+    broker low("low");
+
+    high.define("sys.cpu*.async", "true");
+    high.define("sys.cpu1.async", "false");
+    high.define("sys.*.loglvl", "debug");
+    low.define("sys.cpu0.async", "low");
+    low.define("sys.cpu?.gdb_port", "1234");
+
+    EXPECT_DEF(high, "sys.cpu0.async", "true");
+    EXPECT_DEF(high, "sys.cpu1.async", "false");
+    EXPECT_UDF(high, "sys.cpu0.loglvl");
+
+    string s;
+    EXPECT_EQ(broker::init("sys.cpu0.async", s), &high);
+    EXPECT_EQ(s, "true");
+    EXPECT_EQ(broker::init("sys.cpu1.async", s), &high);
+    EXPECT_EQ(s, "false");
+    EXPECT_EQ(broker::init("sys.uart.loglvl", s), &high);
+    EXPECT_EQ(s, "debug");
+    EXPECT_EQ(broker::init("sys.cpu3.gdb_port", s), &low);
+    EXPECT_EQ(s, "1234");
+    EXPECT_EQ(broker::init("sys.cpu10.gdb_port", s), nullptr);
+    EXPECT_EQ(broker::init("sys.uart.sub.loglvl", s), nullptr);
+
+    high.undefine("sys.cpu*.async");
+    EXPECT_EQ(broker::init("sys.cpu0.async", s), &low);
+    EXPECT_EQ(s, "low");
+
+    high.define("sys.cpu0.async", "again");
+    EXPECT_EQ(broker::init("sys.cpu0.async", s), &high);
+    EXPECT_EQ(s, "again");
 }
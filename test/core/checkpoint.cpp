@@ -0,0 +1,165 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "testing.h"
+
+TEST(checkpoint, records) {
+    const string path = "/tmp/vcml-test-checkpoint-records.bin";
+
+    u32 val = 0x11223344;
+    u8 buf[3] = { 1, 2, 3 };
+
+    {
+        checkpoint cp(path, true);
+        EXPECT_TRUE(cp.is_writing());
+        cp.save("val", val);
+        cp.save("buf", buf, sizeof(buf), 0);
+        cp.save("buf", buf, 1, 3);
+    }
+
+    checkpoint cp(path, false);
+    EXPECT_FALSE(cp.is_writing());
+    EXPECT_TRUE(cp.has("val"));
+    EXPECT_FALSE(cp.has("nothing"));
+
+    u32 copy = 0;
+    EXPECT_TRUE(cp.load("val", copy));
+    EXPECT_EQ(copy, val);
+    EXPECT_FALSE(cp.load("nothing", copy));
+
+    vector<u64> offsets;
+    size_t n = cp.load_all("buf", [&](u64 off, const u8* data, size_t len) {
+        EXPECT_EQ(data[0], 1);
+        offsets.push_back(off);
+    });
+
+    EXPECT_EQ(n, 2u);
+    EXPECT_EQ(offsets, vector<u64>({ 0, 3 }));
+
+    std::remove(path.c_str());
+}
+
+static void test_memory(const string& path, bool compress) {
+    const size_t size = 1 * MiB;
+
+    tlm_memory mem(size);
+    for (size_t i = 0; i < 16 * KiB; i++)
+        mem[64 * KiB + i] = (u8)(i * 7);
+    mem[size - 1] = 0x42;
+
+    {
+        checkpoint cp(path, true, compress);
+        cp.save_memory("mem", mem);
+    }
+
+    tlm_memory copy(size);
+    copy.fill(0xee);
+
+    checkpoint cp(path, false);
+    ASSERT_TRUE(cp.has("mem"));
+    cp.load_memory("mem", copy);
+    EXPECT_EQ(memcmp(mem.data(), copy.data(), size), 0);
+
+    // restored memory must not write back to the checkpoint file
+    copy[64 * KiB] = 0xff;
+    checkpoint check(path, false);
+    tlm_memory again(size);
+    check.load_memory("mem", again);
+    EXPECT_EQ(again[64 * KiB], mem[64 * KiB]);
+
+    std::remove(path.c_str());
+}
+
+TEST(checkpoint, memory) {
+    test_memory("/tmp/vcml-test-checkpoint-memory.bin", false);
+}
+
+TEST(checkpoint, compressed) {
+    test_memory("/tmp/vcml-test-checkpoint-compressed.bin", true);
+}
+
+TEST(checkpoint, incremental) {
+    const string base = "/tmp/vcml-test-checkpoint-base.bin";
+    const string delta = "/tmp/vcml-test-checkpoint-delta.bin";
+    const size_t size = 1 * MiB;
+
+    tlm_memory mem(size);
+    mem.track_dirty();
+    mem[0] = 0x11;
+    mem[128 * KiB] = 0x22;
+    mem.mark_dirty({ 0, 128 * KiB });
+
+    {
+        checkpoint cp(base, true);
+        EXPECT_FALSE(cp.is_incremental());
+        cp.save_memory("mem", mem);
+    }
+
+    EXPECT_EQ(mem.fetch_dirty({ 0, size - 1 })[0], 0u);
+
+    mem[0] = 0x33;
+    mem[128 * KiB] = 0;
+    mem[512 * KiB] = 0x44;
+    mem.mark_dirty({ 0, 0 });
+    mem.mark_dirty({ 128 * KiB, 128 * KiB });
+    mem.mark_dirty({ 512 * KiB, 512 * KiB });
+
+    {
+        checkpoint cp(delta, true, false, base);
+        EXPECT_TRUE(cp.is_incremental());
+        cp.save_memory("mem", mem);
+    }
+
+    checkpoint cp(delta, false);
+    ASSERT_TRUE(cp.is_incremental());
+    EXPECT_EQ(string(cp.parent()), base);
+
+    // only the three pages written since the base checkpoint are stored
+    size_t n = cp.load_all("mem", [](u64, const u8*, size_t) {});
+    EXPECT_EQ(n, 4u);
+
+    tlm_memory copy(size);
+    copy.fill(0xee);
+
+    checkpoint parent(cp.parent(), false);
+    parent.load_memory("mem", copy);
+    EXPECT_EQ(copy[128 * KiB], 0x22);
+
+    cp.load_memory("mem", copy);
+    EXPECT_EQ(memcmp(mem.data(), copy.data(), size), 0);
+
+    std::remove(base.c_str());
+    std::remove(delta.c_str());
+}
+
+TEST(checkpoint, properties) {
+    const string path = "/tmp/vcml-test-checkpoint-properties.bin";
+
+    module top("top");
+    hierarchy_guard guard(&top);
+    property<int> a("a", 1);
+    property<string> b("b", "hello world");
+
+    {
+        checkpoint cp(path, true);
+        cp.save_properties(top, nullptr);
+    }
+
+    a = 2;
+    b = "changed";
+
+    checkpoint cp(path, false);
+    cp.load_properties(top, nullptr);
+    EXPECT_EQ(a, 1);
+    EXPECT_EQ(b.get(), "hello world");
+
+    std::remove(path.c_str());
+}
@@ -36,6 +36,21 @@ TEST(clk, result) {
     EXPECT_FALSE(failed(tx));
 }
 
+TEST(clk, domain) {
+    clk_domain dom(100 * MHz);
+    EXPECT_EQ(dom.cycle(), sc_time(10, SC_NS));
+    EXPECT_EQ(dom.cycle_ticks(), dom.cycle().value());
+    EXPECT_EQ(dom.cycles(7), sc_time(70, SC_NS));
+
+    dom.set(25 * MHz);
+    EXPECT_EQ(dom.cycle_ticks(), sc_time(40, SC_NS).value());
+    EXPECT_EQ(dom.cycles(3), sc_time(120, SC_NS));
+
+    dom.set(0);
+    EXPECT_EQ(dom.cycle_ticks(), 0u);
+    EXPECT_EQ(dom.cycles(3), SC_ZERO_TIME);
+}
+
 MATCHER_P(clk_match_socket, name, "Matches a clk socket by name") {
     return strcmp(arg.basename(), name) == 0;
 }
@@ -112,11 +127,17 @@ public:
         EXPECT_EQ(clk_out, 100 * MHz) << "clk port did not update";
         EXPECT_EQ(clk_out.cycle(), sc_time(10, SC_NS)) << "wrong cycle";
         EXPECT_EQ(clk_out.cycles(2), sc_time(20, SC_NS)) << "wrong cycles";
+        EXPECT_EQ(clk_in.cycle(), sc_time(10, SC_NS)) << "wrong cycle";
+
+        // targets share the clock domain of their initiator
+        u64 gen = clk_in.generation();
+        EXPECT_EQ(gen, clk_out.domain().generation());
 
         // Setting same frequency should not trigger anything
         EXPECT_CALL(*this, clk_notify(_, _)).Times(0);
         clk_out = 100 * MHz;
         EXPECT_EQ(clk_out, 100 * MHz) << "clk port changed unexpectedly";
+        EXPECT_EQ(clk_in.generation(), gen) << "generation changed";
 
         // Test turning clock off
         EXPECT_CALL(*this, clk_notify(clk_match_socket("clk_in"),
@@ -125,6 +146,8 @@ public:
                                       clk_match_payload(100 * MHz, 0)));
         clk_out = 0;
         EXPECT_EQ(clk_out, 0 * Hz) << "clk port did not turn off";
+        EXPECT_EQ(clk_in.generation(), gen + 1) << "generation unchanged";
+        EXPECT_EQ(clk_in.cycle(), SC_ZERO_TIME) << "stale cycle";
     }
 };
 
@@ -0,0 +1,73 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+static const crc_isa ALL_ISAS[] = {
+    CRC_ISA_BYTEWISE,
+    CRC_ISA_SLICED,
+    CRC_ISA_PCLMUL,
+    CRC_ISA_ARMV8,
+};
+
+TEST(crc, check) {
+    const u8* check = (const u8*)"123456789";
+    EXPECT_EQ(crc7_sd(check, 9), 0x75 << 1);
+    for (crc_isa isa : ALL_ISAS) {
+        if (!crc_isa_supported(isa))
+            continue;
+
+        EXPECT_EQ(crc16_sd(check, 9, 0, isa), 0x31c3) << crc_isa_str(isa);
+        EXPECT_EQ(crc32_eth(check, 9, 0, isa), 0xcbf43926)
+            << crc_isa_str(isa);
+    }
+}
+
+TEST(crc, isas) {
+    vector<u8> data(4 * KiB + 13);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (u8)(i * 131 + (i >> 5));
+
+    // cover all head and tail lengths around the folding block sizes
+    const size_t lengths[] = { 0, 1, 7, 8, 15, 63, 64, 65, 127, 128, 129,
+                               255, 512, 1500, 4 * KiB + 13 };
+    for (size_t len : lengths) {
+        for (size_t off : { 0, 1, 3 }) {
+            if (off + len > data.size())
+                continue;
+
+            const u8* ptr = data.data() + off;
+            u16 ref16 = crc16_sd(ptr, len, 0x1234, CRC_ISA_BYTEWISE);
+            u32 ref32 = crc32_eth(ptr, len, 0x12345678, CRC_ISA_BYTEWISE);
+            for (crc_isa isa : ALL_ISAS) {
+                if (!crc_isa_supported(isa))
+                    continue;
+
+                EXPECT_EQ(crc16_sd(ptr, len, 0x1234, isa), ref16)
+                    << crc_isa_str(isa) << " len " << len << " off " << off;
+                EXPECT_EQ(crc32_eth(ptr, len, 0x12345678, isa), ref32)
+                    << crc_isa_str(isa) << " len " << len << " off " << off;
+            }
+        }
+    }
+}
+
+TEST(crc, chaining) {
+    vector<u8> data(1000, 0xa5);
+    u32 crc = crc32_eth(data.data(), 300);
+    crc = crc32_eth(data.data() + 300, 700, crc);
+    EXPECT_EQ(crc, crc32_eth(data.data(), data.size()));
+
+    u16 sum = crc16_sd(data.data(), 300);
+    sum = crc16_sd(data.data() + 300, 700, sum);
+    EXPECT_EQ(sum, crc16_sd(data.data(), data.size()));
+
+    EXPECT_TRUE(crc_isa_supported(crc_isa_host()));
+}
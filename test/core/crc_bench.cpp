@@ -0,0 +1,57 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+template <typename FUNC>
+static double benchmark(const vector<u8>& data, FUNC fn) {
+    const size_t total = 8 * MiB;
+    size_t count = max<size_t>(total / data.size(), 1);
+
+    u32 sink = 0;
+    double t0 = mwr::timestamp();
+    for (size_t i = 0; i < count; i++)
+        sink ^= fn(data.data(), data.size());
+    double t1 = mwr::timestamp();
+
+    EXPECT_NE(sink, ~0u); // keeps the loop from being optimized away
+    return (double)(count * data.size()) / (t1 - t0) / MiB;
+}
+
+TEST(crc, bench) {
+    const size_t sizes[] = { 64, 512, 1514, 64 * KiB };
+
+    const crc_isa isas[] = {
+        CRC_ISA_BYTEWISE,
+        CRC_ISA_SLICED,
+        CRC_ISA_PCLMUL,
+        CRC_ISA_ARMV8,
+    };
+
+    for (size_t size : sizes) {
+        vector<u8> data(size, 0x5a);
+        for (crc_isa isa : isas) {
+            if (!crc_isa_supported(isa))
+                continue;
+
+            double crc16 = benchmark(data, [isa](const u8* p, size_t n) {
+                return (u32)crc16_sd(p, n, 0, isa);
+            });
+
+            double crc32 = benchmark(data, [isa](const u8* p, size_t n) {
+                return crc32_eth(p, n, 0, isa);
+            });
+
+            std::cout << size << " bytes " << crc_isa_str(isa)
+                      << ": crc16 " << (u64)crc16 << "MiB/s, crc32 "
+                      << (u64)crc32 << "MiB/s" << std::endl;
+        }
+    }
+}
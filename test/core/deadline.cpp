@@ -0,0 +1,75 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class deadline_test : public test_base
+{
+public:
+    deadline_test(const sc_module_name& nm): test_base(nm) {}
+
+    virtual void run_test() override {
+        vector<int> fired;
+        deadline_timer a([&]() { fired.push_back(0); });
+        deadline_timer b([&]() { fired.push_back(1); });
+        deadline_timer c([&]() { fired.push_back(2); });
+
+        EXPECT_FALSE(a.is_pending());
+        EXPECT_EQ(next_deadline(), SC_MAX_TIME);
+
+        a.reset(sc_time(30, SC_NS));
+        b.reset(sc_time(10, SC_NS));
+        c.reset(sc_time(20, SC_NS));
+        EXPECT_TRUE(a.is_pending());
+        EXPECT_EQ(next_deadline(), sc_time_stamp() + sc_time(10, SC_NS));
+        EXPECT_EQ(c.remaining(), sc_time(20, SC_NS));
+
+        // cancelling and re-arming must reorder the shared heap
+        b.cancel();
+        EXPECT_FALSE(b.is_pending());
+        EXPECT_EQ(b.remaining(), SC_ZERO_TIME);
+        EXPECT_EQ(next_deadline(), sc_time_stamp() + sc_time(20, SC_NS));
+        a.reset(sc_time(5, SC_NS));
+        EXPECT_EQ(next_deadline(), sc_time_stamp() + sc_time(5, SC_NS));
+
+        wait(40, SC_NS);
+        EXPECT_EQ(fired, vector<int>({ 0, 2 }));
+        EXPECT_FALSE(a.is_pending());
+        EXPECT_FALSE(c.is_pending());
+        EXPECT_EQ(next_deadline(), SC_MAX_TIME);
+
+        // equal deadlines fire in the order they were set
+        fired.clear();
+        sc_time t = sc_time_stamp() + sc_time(10, SC_NS);
+        c.reset_at(t);
+        a.reset_at(t);
+        b.reset_at(t);
+        wait(10, SC_NS);
+        wait(SC_ZERO_TIME);
+        EXPECT_EQ(fired, vector<int>({ 2, 0, 1 }));
+
+        // periodic re-arming from within the callback
+        size_t count = 0;
+        deadline_timer p([&]() {
+            if (++count < 100)
+                p.reset(sc_time(1, SC_US));
+        });
+
+        p.reset(sc_time(1, SC_US));
+        wait(200, SC_US);
+        EXPECT_EQ(count, 100);
+        EXPECT_FALSE(p.is_pending());
+    }
+};
+
+TEST(deadline, timers) {
+    deadline_test test("test");
+    sc_core::sc_start();
+}
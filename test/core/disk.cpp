@@ -108,6 +108,142 @@ TEST(disk, file) {
     std::remove("my.disk");
 }
 
+TEST(disk, pio) {
+    mwr::publishers::terminal log;
+    log.set_level(LOG_DEBUG);
+
+    for (const string prefix : { "pio:", "direct:", "mmap:" }) {
+        create_file("my.disk", 8 * MiB);
+
+        block::disk disk("disk", prefix + "my.disk");
+        EXPECT_EQ(disk.capacity(), 8 * MiB);
+        EXPECT_EQ(disk.pos(), 0);
+
+        u8 a[] = { 0x12, 0x34, 0x56, 0x78 };
+        u8 b[] = { 0x00, 0x00, 0x00, 0x00 };
+
+        EXPECT_TRUE(disk.seek(0xffe));
+        EXPECT_TRUE(disk.write(a, sizeof(a)));
+        EXPECT_EQ(disk.pos(), 0x1002);
+        EXPECT_TRUE(disk.seek(0xffe));
+        EXPECT_TRUE(disk.read(b, sizeof(b)));
+        EXPECT_EQ(memcmp(a, b, sizeof(a)), 0);
+
+        EXPECT_TRUE(disk.seek(0x1000));
+        EXPECT_TRUE(disk.wzero(4 * KiB, true));
+        EXPECT_TRUE(disk.seek(0xffe));
+        EXPECT_TRUE(disk.read(b, sizeof(b)));
+        EXPECT_EQ(b[0], 0x12);
+        EXPECT_EQ(b[1], 0x34);
+        EXPECT_EQ(b[2], 0x00);
+        EXPECT_EQ(b[3], 0x00);
+
+        EXPECT_FALSE(disk.seek(8 * MiB + 1));
+        EXPECT_TRUE(disk.seek(8 * MiB - 1));
+        EXPECT_FALSE(disk.write(a, sizeof(a)));
+
+        std::remove("my.disk");
+    }
+}
+
+TEST(disk, positional) {
+    mwr::publishers::terminal log;
+    log.set_level(LOG_DEBUG);
+
+    for (const string image : { "ramdisk:1MiB", "pio:my.disk" }) {
+        create_file("my.disk", 1 * MiB);
+        block::disk disk("disk", image);
+
+        u8 a[] = { 0x12, 0x34, 0x56, 0x78 };
+        u8 b[] = { 0x00, 0x00, 0x00, 0x00 };
+
+        EXPECT_TRUE(disk.write_at(0xffe, a, sizeof(a)));
+        EXPECT_TRUE(disk.read_at(0xffe, b, sizeof(b)));
+        EXPECT_EQ(memcmp(a, b, sizeof(a)), 0);
+        EXPECT_EQ(disk.pos(), 0) << "positional access moved the cursor";
+        EXPECT_FALSE(disk.write_at(1 * MiB - 1, a, sizeof(a)));
+        EXPECT_FALSE(disk.read_at(1 * MiB + 1, b, 0));
+
+        EXPECT_EQ(disk.stats.num_seek_req, 0);
+        EXPECT_EQ(disk.stats.num_req, 4);
+        EXPECT_EQ(disk.stats.num_err, 2);
+
+        // concurrent backends serve several threads without a cursor
+        vector<thread> threads;
+        for (size_t t = 0; t < 4; t++) {
+            threads.emplace_back([&disk, t]() {
+                u8 buf[64];
+                memset(buf, (int)t, sizeof(buf));
+                for (size_t i = 0; i < 256; i++) {
+                    size_t off = (t * 256 + i) * sizeof(buf);
+                    disk.write_at(off, buf, sizeof(buf));
+                }
+            });
+        }
+
+        for (thread& t : threads)
+            t.join();
+
+        EXPECT_EQ(disk.stats.num_write_req, 2 + 4 * 256);
+        EXPECT_EQ(disk.stats.num_bytes_written, 4 + 4 * 256 * 64);
+
+        u8 val = 0xff;
+        EXPECT_TRUE(disk.read_at(3 * 256 * 64, &val, 1));
+        EXPECT_EQ(val, 3);
+    }
+
+    std::remove("my.disk");
+}
+
+TEST(disk, cow) {
+    mwr::publishers::terminal log;
+    log.set_level(LOG_DEBUG);
+
+    create_file("base.disk", 1 * MiB);
+    {
+        vector<char> fill(128 * KiB, 0x11);
+        ofstream of("base.disk", std::ios::binary | std::ios::in);
+        of.write(fill.data(), fill.size());
+    }
+
+    u8 a[] = { 0x01, 0x02, 0x03, 0x04 };
+    u8 b[8] = {};
+    u8 expect[] = { 0x11, 0x11, 0x01, 0x02, 0x03, 0x04, 0x11, 0x11 };
+
+    for (const string delta : { "", ",delta.disk" }) {
+        block::disk disk("disk", "cow:base.disk" + delta);
+        EXPECT_EQ(disk.capacity(), 1 * MiB);
+        EXPECT_FALSE(disk.readonly);
+
+        // write crosses the boundary of the first two clusters
+        EXPECT_TRUE(disk.seek(0xfffe));
+        EXPECT_TRUE(disk.write(a, sizeof(a)));
+        EXPECT_TRUE(disk.seek(0xfffc));
+        EXPECT_TRUE(disk.read(b, sizeof(b)));
+        EXPECT_EQ(memcmp(b, expect, sizeof(b)), 0);
+
+        EXPECT_FALSE(disk.seek(1 * MiB + 1));
+        EXPECT_TRUE(disk.seek(1 * MiB - 1));
+        EXPECT_FALSE(disk.write(a, sizeof(a)));
+    }
+
+    // the base must remain untouched
+    ifstream base("base.disk", std::ios::binary);
+    base.seekg(0xfffc);
+    base.read((char*)b, sizeof(b));
+    for (u8 val : b)
+        EXPECT_EQ(val, 0x11);
+
+    // the delta file keeps its data for the next run
+    block::disk disk("disk", "cow:base.disk,delta.disk");
+    EXPECT_TRUE(disk.seek(0xfffc));
+    EXPECT_TRUE(disk.read(b, sizeof(b)));
+    EXPECT_EQ(memcmp(b, expect, sizeof(b)), 0);
+
+    std::remove("base.disk");
+    std::remove("delta.disk");
+}
+
 TEST(disk, nothing) {
     mwr::publishers::terminal log;
     log.set_level(LOG_DEBUG);
@@ -160,6 +296,33 @@ TEST(disk, serial) {
     std::remove("file2");
 }
 
+TEST(ramdisk, chunks) {
+    mwr::publishers::terminal log;
+    log.set_level(LOG_DEBUG);
+
+    block::disk disk("disk", "ramdisk:1000KiB", false);
+
+    vector<u8> a(200 * KiB), b(200 * KiB);
+    for (size_t i = 0; i < a.size(); i++)
+        a[i] = (u8)(i * 7);
+
+    // unaligned accesses span over multiple chunks
+    EXPECT_TRUE(disk.seek(1000 * KiB - a.size()));
+    EXPECT_TRUE(disk.write(a.data(), a.size()));
+    EXPECT_TRUE(disk.seek(1000 * KiB - b.size()));
+    EXPECT_TRUE(disk.read(b.data(), b.size()));
+    EXPECT_EQ(a, b);
+
+    EXPECT_TRUE(disk.seek(1000 * KiB - a.size() + 1));
+    EXPECT_TRUE(disk.wzero(128 * KiB, true));
+    EXPECT_TRUE(disk.seek(1000 * KiB - b.size()));
+    EXPECT_TRUE(disk.read(b.data(), b.size()));
+    EXPECT_EQ(b[0], a[0]);
+    for (size_t i = 1; i <= 128 * KiB; i++)
+        ASSERT_EQ(b[i], 0) << "at offset " << i;
+    EXPECT_EQ(b[128 * KiB + 1], a[128 * KiB + 1]);
+}
+
 TEST(ramdisk, unmap_zero) {
     mwr::publishers::terminal log;
     log.set_level(LOG_DEBUG);
@@ -179,3 +342,201 @@ TEST(ramdisk, unmap_zero) {
     EXPECT_EQ(disk.stats.num_req, 3);
     EXPECT_EQ(disk.stats.num_err, 0);
 }
+
+class disk_async_test : public test_base
+{
+public:
+    block::disk disk;
+    block::disk timed;
+
+    disk_async_test(const sc_module_name& nm):
+        test_base(nm),
+        disk("disk", "pio:async.disk"),
+        timed("timed", "ramdisk:1MiB") {
+        // nothing to do
+    }
+
+    void wait_idle(block::disk& d) {
+        while (d.in_flight() > 0)
+            wait(1, SC_US);
+    }
+
+    void wait_idle() { wait_idle(disk); }
+
+    void test_timing() {
+        ASSERT_TRUE(timed.has_timing());
+        ASSERT_FALSE(disk.has_timing());
+
+        vector<u8> a(4 * KiB, 0xee);
+        sc_time t1, t2;
+        timed.write_async(0x1000, a.data(), a.size(), [&](bool ok) {
+            EXPECT_TRUE(ok);
+            t1 = sc_time_stamp();
+        });
+        timed.write_async(0x2000, a.data(), a.size(), [&](bool ok) {
+            EXPECT_TRUE(ok);
+            t2 = sc_time_stamp();
+        });
+
+        sc_time start = sc_time_stamp();
+        EXPECT_EQ(timed.in_flight(), 2u);
+        wait_idle(timed);
+
+        // the first write needs a seek, the second one continues where the
+        // first ended and only pays for latency and 4KiB at 180MiB/s
+        EXPECT_GE(t1 - start, sc_time(8, SC_MS));
+        EXPECT_EQ(t2 - t1, sc_time(100000 + 21701, SC_NS));
+        EXPECT_EQ(t2, timed.busy_until());
+        EXPECT_EQ(timed.stats.write_latency.count, 2u);
+        EXPECT_EQ(timed.stats.read_latency.count, 0u);
+    }
+
+    virtual void run_test() override {
+        ASSERT_EQ(disk.capacity(), 1 * MiB);
+
+        vector<u8> a(16 * KiB), b(16 * KiB);
+        for (size_t i = 0; i < a.size(); i++)
+            a[i] = (u8)i;
+
+        size_t done = 0;
+        for (size_t off = 0; off < a.size(); off += 4 * KiB) {
+            disk.write_async(off, a.data() + off, 4 * KiB, [&](bool ok) {
+                EXPECT_TRUE(ok);
+                done++;
+            });
+        }
+
+        EXPECT_EQ(disk.pos(), 0u);
+        wait_idle();
+        EXPECT_EQ(done, 4u);
+
+        disk.flush_async([&](bool ok) { EXPECT_TRUE(ok); });
+        disk.read_async(0, b.data(), b.size(), [&](bool ok) {
+            EXPECT_TRUE(ok);
+            done++;
+        });
+
+        wait_idle();
+        EXPECT_EQ(done, 5u);
+        EXPECT_EQ(a, b);
+
+        // scatter the same data into two halves in reverse order
+        vector<u8> c(a.size());
+        vector<iovec> iov = { { c.data() + c.size() / 2, c.size() / 2 },
+                              { c.data(), c.size() / 2 } };
+        disk.readv_async(0, iov, [&](bool ok) {
+            EXPECT_TRUE(ok);
+            done++;
+        });
+
+        wait_idle();
+        EXPECT_EQ(done, 6u);
+        EXPECT_EQ(memcmp(c.data(), a.data() + a.size() / 2, a.size() / 2), 0);
+        EXPECT_EQ(memcmp(c.data() + c.size() / 2, a.data(), a.size() / 2), 0);
+
+        // out of range requests fail right away
+        disk.read_async(disk.capacity(), b.data(), 1, [&](bool ok) {
+            EXPECT_FALSE(ok);
+            done++;
+        });
+
+        EXPECT_EQ(done, 7u);
+        EXPECT_EQ(disk.stats.num_write_req, 4u);
+        EXPECT_EQ(disk.stats.num_read_req, 3u);
+        EXPECT_EQ(disk.stats.num_flush_req, 1u);
+        EXPECT_EQ(disk.stats.num_bytes_written, a.size());
+        EXPECT_EQ(disk.stats.num_bytes_read, b.size() + c.size());
+        EXPECT_EQ(disk.stats.num_err, 1u);
+        EXPECT_EQ(disk.stats.write_latency.count, 4u);
+        EXPECT_EQ(disk.stats.read_latency.count, 3u);
+        EXPECT_EQ(disk.stats.flush_latency.count, 1u);
+
+        test_timing();
+    }
+};
+
+TEST(disk, cache) {
+    mwr::publishers::terminal log;
+    log.set_level(LOG_DEBUG);
+
+    // every page of the image holds its page number plus one
+    create_file("cache.disk", 1 * MiB);
+    {
+        ofstream of("cache.disk", std::ios::binary | std::ios::in);
+        for (char i = 0; i < 16; i++) {
+            vector<char> fill(4 * KiB, i + 1);
+            of.write(fill.data(), fill.size());
+        }
+    }
+
+    vcml::broker broker("test");
+    broker.define("cache.cache_size", "16384");
+    broker.define("cache.cache_readahead", "8192");
+
+    block::disk disk("cache", "cache.disk");
+    ASSERT_TRUE(disk.has_cache());
+    EXPECT_EQ(disk.capacity(), 1 * MiB);
+
+    vector<u8> b(4 * KiB);
+    EXPECT_TRUE(disk.seek(0x1000));
+    EXPECT_TRUE(disk.read(b.data(), 4));
+    EXPECT_EQ(b[0], 2);
+    EXPECT_TRUE(disk.read(b.data(), 0x1000 - 4));
+    EXPECT_EQ(b[0], 2);
+    EXPECT_EQ(disk.stats.num_cache_misses, 1);
+    EXPECT_EQ(disk.stats.num_cache_hits, 1);
+    EXPECT_EQ(disk.stats.num_cache_readahead, 0);
+
+    // continues where the last read ended, so pages 3 and 4 come along
+    EXPECT_TRUE(disk.read(b.data(), 4));
+    EXPECT_EQ(b[0], 3);
+    EXPECT_EQ(disk.stats.num_cache_misses, 2);
+    EXPECT_EQ(disk.stats.num_cache_readahead, 2);
+
+    EXPECT_TRUE(disk.seek(0x3000));
+    EXPECT_TRUE(disk.read(b.data(), 4));
+    EXPECT_EQ(b[0], 4);
+    EXPECT_TRUE(disk.seek(0x4000));
+    EXPECT_TRUE(disk.read(b.data(), 4));
+    EXPECT_EQ(b[0], 5);
+    EXPECT_EQ(disk.stats.num_cache_misses, 2);
+    EXPECT_EQ(disk.stats.num_cache_hits, 3);
+    EXPECT_EQ(disk.stats.num_cache_evictions, 0);
+
+    // the cache is full, so the least recently used page 1 must go
+    u8 a[] = { 0x01, 0x02, 0x03, 0x04 };
+    EXPECT_TRUE(disk.seek(0x8000));
+    EXPECT_TRUE(disk.write(a, sizeof(a)));
+    EXPECT_EQ(disk.stats.num_cache_misses, 3);
+    EXPECT_EQ(disk.stats.num_cache_evictions, 1);
+
+    u8 c[4] = {};
+    ifstream before("cache.disk", std::ios::binary);
+    before.seekg(0x8000);
+    before.read((char*)c, sizeof(c));
+    for (u8 val : c)
+        EXPECT_EQ(val, 9);
+
+    EXPECT_TRUE(disk.flush());
+    ifstream after("cache.disk", std::ios::binary);
+    after.seekg(0x8000);
+    after.read((char*)c, sizeof(c));
+    EXPECT_EQ(memcmp(a, c, sizeof(a)), 0);
+
+    EXPECT_TRUE(disk.seek(0x8000));
+    EXPECT_TRUE(disk.read(b.data(), 8));
+    EXPECT_EQ(memcmp(a, b.data(), sizeof(a)), 0);
+    EXPECT_EQ(b[4], 9);
+    EXPECT_EQ(disk.stats.num_cache_misses, 3);
+
+    std::remove("cache.disk");
+}
+
+TEST(disk, async) {
+    create_file("async.disk", 1 * MiB);
+    vcml::broker broker("test");
+    broker.define("async.timed.timing", "hdd");
+    disk_async_test test("async");
+    sc_core::sc_start();
+    std::remove("async.disk");
+}
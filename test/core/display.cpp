@@ -52,6 +52,167 @@ TEST(display, videomode) {
     EXPECT_EQ(mode.size, resx * resy * 1);
 }
 
+TEST(display, damage) {
+    videomode mode = videomode::a8r8g8b8(200, 40);
+    vector<u8> fb(mode.size, 0);
+    auto poke = [&](u32 x, u32 y) { fb[y * mode.stride + x * mode.bpp]++; };
+
+    damage_tracker tracker;
+    tracker.setup(mode, fb.data());
+    EXPECT_EQ(tracker.num_tiles(), 4u * 3u);
+
+    // the first frame is always fully damaged and merged into one rect
+    vector<damage_rect> damage;
+    EXPECT_EQ(tracker.update(damage), 200u * 40u);
+    ASSERT_EQ(damage.size(), 1u);
+    EXPECT_EQ(damage[0].x, 0u);
+    EXPECT_EQ(damage[0].y, 0u);
+    EXPECT_EQ(damage[0].w, 200u);
+    EXPECT_EQ(damage[0].h, 40u);
+
+    // unchanged frames report nothing
+    EXPECT_EQ(tracker.update(damage), 0u);
+    EXPECT_TRUE(damage.empty());
+
+    // a single pixel damages its tile only
+    poke(70, 20);
+    EXPECT_EQ(tracker.update(damage), 64u * 16u);
+    ASSERT_EQ(damage.size(), 1u);
+    EXPECT_EQ(damage[0].x, 64u);
+    EXPECT_EQ(damage[0].y, 16u);
+
+    // tiles stacked on top of each other are merged
+    poke(10, 5);
+    poke(10, 20);
+    poke(199, 39);
+    EXPECT_EQ(tracker.update(damage), 64u * 32u + 8u * 8u);
+    ASSERT_EQ(damage.size(), 2u);
+    EXPECT_EQ(damage[0].x, 0u);
+    EXPECT_EQ(damage[0].y, 0u);
+    EXPECT_EQ(damage[0].w, 64u);
+    EXPECT_EQ(damage[0].h, 32u);
+    EXPECT_EQ(damage[1].x, 192u);
+    EXPECT_EQ(damage[1].y, 32u);
+    EXPECT_EQ(damage[1].w, 8u);
+    EXPECT_EQ(damage[1].h, 8u);
+
+    // everything is reported again after invalidation
+    tracker.invalidate();
+    EXPECT_EQ(tracker.update(damage), 200u * 40u);
+}
+
+TEST(display, convert) {
+    // r5g6b5 magenta, r8g8b8 orange and a gray8 pixel
+    const u8 rgb565[] = { 0x1f, 0xf8 };
+    const u8 rgb888[] = { 0x00, 0x80, 0xff };
+    const u8 gray[] = { 0x42 };
+    u8 out[4];
+
+    pixel_converter c1(videomode::r5g6b5(1, 1), FORMAT_A8R8G8B8);
+    c1.convert(out, rgb565, 1);
+    EXPECT_EQ(out[0], 0xff);
+    EXPECT_EQ(out[1], 0x00);
+    EXPECT_EQ(out[2], 0xff);
+    EXPECT_EQ(out[3], 0xff);
+
+    pixel_converter c2(videomode::r8g8b8(1, 1), FORMAT_A8B8G8R8);
+    c2.convert(out, rgb888, 1);
+    EXPECT_EQ(out[0], 0xff);
+    EXPECT_EQ(out[1], 0x80);
+    EXPECT_EQ(out[2], 0x00);
+    EXPECT_EQ(out[3], 0xff);
+
+    pixel_converter c3(videomode::gray8(1, 1), FORMAT_X8R8G8B8);
+    c3.convert(out, gray, 1);
+    EXPECT_EQ(out[0], 0x42);
+    EXPECT_EQ(out[1], 0x42);
+    EXPECT_EQ(out[2], 0x42);
+
+    EXPECT_FALSE(pixel_converter::supported(FORMAT_R8G8B8));
+    EXPECT_THROW(pixel_converter(videomode::gray8(1, 1), FORMAT_R5G6B5),
+                 std::exception);
+}
+
+TEST(display, convert_simd) {
+    // odd sizes make sure the scalar tail of each kernel gets exercised
+    const u32 w = 131;
+    const u32 h = 7;
+
+    for (int i = FORMAT_A8R8G8B8; i <= FORMAT_GRAY8; i++) {
+        videomode mode((pixelformat)i, w, h);
+        vector<u8> input(mode.size);
+        for (size_t j = 0; j < input.size(); j++)
+            input[j] = (j * 7919) >> 3;
+
+        for (pixelformat dst : { FORMAT_A8R8G8B8, FORMAT_R8G8B8X8 }) {
+            pixel_converter ref(mode, dst, PIXEL_ISA_SCALAR);
+            vector<u8> expect(ref.dst().size);
+            ref.convert(expect.data(), input.data());
+
+            for (pixel_isa isa : { PIXEL_ISA_SSE2, PIXEL_ISA_AVX2,
+                                   PIXEL_ISA_NEON }) {
+                if (!pixel_isa_supported(isa))
+                    continue;
+
+                pixel_converter conv(mode, dst, isa);
+                vector<u8> output(conv.dst().size);
+                conv.convert(output.data(), input.data());
+                EXPECT_EQ(output, expect)
+                    << pixel_isa_str(isa) << ": " << mode << " to "
+                    << pixelformat_to_str(dst);
+            }
+        }
+    }
+}
+
+TEST(display, convert_rect) {
+    videomode mode = videomode::r8g8b8(16, 16);
+    vector<u8> input(mode.size, 0xff);
+    pixel_converter conv(mode, FORMAT_X8R8G8B8);
+    vector<u8> output(conv.dst().size, 0);
+
+    conv.convert(output.data(), input.data(), 4, 4, 8, 100);
+    EXPECT_EQ(output[(4 * 16 + 4) * 4], 0xff);
+    EXPECT_EQ(output[(15 * 16 + 11) * 4], 0xff);
+    EXPECT_EQ(output[(15 * 16 + 12) * 4], 0x00);
+    EXPECT_EQ(output[(3 * 16 + 4) * 4], 0x00);
+}
+
+TEST(display, input) {
+    keyboard kb("input_test");
+    size_t notified = 0;
+    kb.set_notify([&]() { notified++; });
+
+    // the consumer gets woken once until it finds the queue empty
+    kb.notify_key(KEYSYM_A, true);
+    kb.notify_key(KEYSYM_A, false);
+    EXPECT_EQ(notified, 1u);
+    EXPECT_TRUE(kb.has_events());
+
+    input_event ev;
+    ASSERT_TRUE(kb.pop_event(ev));
+    EXPECT_TRUE(ev.is_key());
+    EXPECT_EQ(ev.key.code, KEYSYM_A);
+    EXPECT_EQ(ev.key.state, VCML_KEY_DOWN);
+    ASSERT_TRUE(kb.pop_event(ev));
+    EXPECT_EQ(ev.key.state, VCML_KEY_UP);
+    EXPECT_FALSE(kb.pop_event(ev));
+    EXPECT_FALSE(kb.has_events());
+
+    kb.notify_key(KEYSYM_B, true);
+    EXPECT_EQ(notified, 2u);
+
+    // events beyond the capacity of the ring are dropped
+    for (size_t i = 0; i < input::CAPACITY; i++)
+        kb.notify_key(KEYSYM_B, false);
+    EXPECT_EQ(kb.num_dropped(), 1u);
+
+    size_t n = 0;
+    while (kb.pop_event(ev))
+        n++;
+    EXPECT_EQ(n, input::CAPACITY);
+}
+
 TEST(display, server) {
     u16 port1 = 40000;
     u16 port2 = 40001;
@@ -92,3 +253,65 @@ TEST(display, server) {
     p4->shutdown();
     p5->shutdown();
 }
+
+class mock_display : public display
+{
+public:
+    size_t frames;
+    size_t rects;
+
+    mock_display(u32 nr): display("mock", nr), frames(0), rects(0) {}
+    virtual ~mock_display() = default;
+
+    virtual bool needs_conversion(const videomode& mode) const override {
+        return mode.bpp == 3;
+    }
+
+    virtual void render(const vector<damage_rect>& damage) override {
+        frames++;
+        rects += damage.size();
+    }
+};
+
+TEST(display, console_shared) {
+    display::register_display_type("mock", [](u32 nr) -> display* {
+        return new mock_display(nr);
+    });
+
+    broker config("console");
+    config.define("displays", "mock:1 mock:2");
+
+    console con;
+    auto d1 = std::dynamic_pointer_cast<mock_display>(
+        display::lookup("mock:1"));
+    auto d2 = std::dynamic_pointer_cast<mock_display>(
+        display::lookup("mock:2"));
+    ASSERT_TRUE(d1 && d2);
+
+    // both displays get the same converted frame
+    videomode mode = videomode::r8g8b8(100, 20);
+    vector<u8> fb(mode.size, 0x11);
+    con.setup(mode, fb.data());
+    EXPECT_EQ(d1->mode().bpp, 4u);
+    EXPECT_EQ(d1->framebuffer(), d2->framebuffer());
+    EXPECT_NE(d1->framebuffer(), fb.data());
+
+    // damage is detected once and handed to all displays
+    con.render();
+    EXPECT_EQ(d1->frames, 1u);
+    EXPECT_EQ(d2->frames, 1u);
+
+    con.render();
+    EXPECT_EQ(d1->frames, 1u);
+    EXPECT_EQ(d2->frames, 1u);
+
+    u8 before[4];
+    memcpy(before, d1->framebuffer(), sizeof(before));
+    fb[0] = fb[1] = fb[2] = 0xff;
+    con.render();
+    EXPECT_EQ(d1->frames, 2u);
+    EXPECT_EQ(d2->rects, 2u);
+    EXPECT_NE(memcmp(before, d1->framebuffer(), sizeof(before)), 0);
+
+    con.shutdown();
+}
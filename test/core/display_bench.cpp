@@ -0,0 +1,62 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "testing.h"
+
+using namespace vcml::ui;
+
+static double benchmark(const pixel_converter& conv) {
+    const size_t count = 4;
+
+    vector<u8> input(conv.src().size, 0x5a);
+    vector<u8> output(conv.dst().size);
+
+    double t0 = mwr::timestamp();
+    for (size_t i = 0; i < count; i++)
+        conv.convert(output.data(), input.data());
+    double t1 = mwr::timestamp();
+    return (t1 - t0) * 1e3 / count;
+}
+
+TEST(display, convert_bench) {
+    const pair<u32, u32> resolutions[] = {
+        { 1920, 1080 },
+        { 3840, 2160 },
+    };
+
+    const pixelformat formats[] = {
+        FORMAT_R8G8B8,
+        FORMAT_R5G6B5,
+        FORMAT_A8B8G8R8,
+        FORMAT_GRAY8,
+    };
+
+    const pixel_isa isas[] = {
+        PIXEL_ISA_SCALAR,
+        PIXEL_ISA_SSE2,
+        PIXEL_ISA_AVX2,
+        PIXEL_ISA_NEON,
+    };
+
+    for (auto res : resolutions) {
+        for (pixelformat fmt : formats) {
+            videomode mode(fmt, res.first, res.second);
+            for (pixel_isa isa : isas) {
+                if (!pixel_isa_supported(isa))
+                    continue;
+
+                pixel_converter conv(mode, FORMAT_X8R8G8B8, isa);
+                std::cout << mode << " " << pixel_isa_str(isa) << ": "
+                          << benchmark(conv) << "ms per frame" << std::endl;
+            }
+        }
+    }
+}
@@ -108,3 +108,41 @@ TEST(dmi, lookup) {
     EXPECT_EQ(vcml::dmi_get_ptr(dmi2, 997), dummy + 997);
     EXPECT_FALSE(cache.lookup(998, 4, tlm::TLM_READ_COMMAND, dmi2));
 }
+
+TEST(dmi, lookup_overlapping) {
+    unsigned char dummy[4096];
+    vcml::tlm_dmi_cache cache;
+    tlm::tlm_dmi dmi, dmi2;
+
+    dmi.allow_read_write();
+    dmi.set_start_address(0);
+    dmi.set_end_address(3000);
+    dmi.set_dmi_ptr(dummy);
+    cache.insert(dmi);
+
+    dmi.allow_read();
+    dmi.set_start_address(1000);
+    dmi.set_end_address(1999);
+    dmi.set_dmi_ptr(dummy + 1000);
+    cache.insert(dmi);
+
+    dmi.allow_read_write();
+    dmi.set_start_address(3500);
+    dmi.set_end_address(4000);
+    dmi.set_dmi_ptr(dummy + 3500);
+    cache.insert(dmi);
+
+    EXPECT_EQ(cache.get_entries().size(), 3);
+    EXPECT_TRUE(cache.lookup(1500, 4, tlm::TLM_WRITE_COMMAND, dmi2));
+    EXPECT_EQ(dmi2.get_start_address(), 0);
+    EXPECT_EQ(dmi2.get_end_address(), 3000);
+    EXPECT_TRUE(cache.lookup(2998, 2, tlm::TLM_READ_COMMAND, dmi2));
+    EXPECT_FALSE(cache.lookup(2998, 4, tlm::TLM_READ_COMMAND, dmi2));
+    EXPECT_FALSE(cache.lookup(3200, 4, tlm::TLM_READ_COMMAND, dmi2));
+    EXPECT_TRUE(cache.lookup(3500, 4, tlm::TLM_WRITE_COMMAND, dmi2));
+    EXPECT_EQ(vcml::dmi_get_ptr(dmi2, 3500), dummy + 3500);
+
+    cache.invalidate(0, 3000);
+    EXPECT_FALSE(cache.lookup(1500, 4, tlm::TLM_READ_COMMAND, dmi2));
+    EXPECT_TRUE(cache.lookup(3600, 4, tlm::TLM_READ_COMMAND, dmi2));
+}
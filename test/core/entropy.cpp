@@ -0,0 +1,50 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include "testing.h"
+
+TEST(entropy, pseudo) {
+    entropy_pool a(true, 42);
+    entropy_pool b(true, 42);
+    entropy_pool c(true, 43);
+
+    EXPECT_TRUE(a.is_pseudo());
+    EXPECT_EQ(a.next<u64>(), b.next<u64>());
+    EXPECT_NE(a.next<u64>(), c.next<u64>());
+
+    // resetting restarts the sequence from the seed
+    a.reset(true, 42);
+    b.reset(true, 42);
+    EXPECT_EQ(a.next<u32>(), b.next<u32>());
+}
+
+TEST(entropy, bulk) {
+    const size_t size = 3 * entropy_pool::POOL_SIZE + 123;
+    vector<u8> bulk(size), bytes(size);
+
+    // large requests bypass the pool, but yield the same sequence
+    entropy_pool a(true, 7);
+    entropy_pool b(true, 7);
+    EXPECT_TRUE(a.fill(bulk.data(), bulk.size()));
+    for (size_t i = 0; i < size; i++)
+        EXPECT_TRUE(b.fill(&bytes[i], 1));
+    EXPECT_EQ(bulk, bytes);
+}
+
+TEST(entropy, host) {
+    entropy_pool pool;
+    EXPECT_FALSE(pool.is_pseudo());
+
+    u64 a = 0, b = 0;
+    EXPECT_TRUE(pool.fill(&a, sizeof(a)));
+    EXPECT_TRUE(pool.fill(&b, sizeof(b)));
+    EXPECT_NE(a, b);
+}
@@ -48,6 +48,148 @@ TEST(ethernet, frame) {
     EXPECT_FALSE(failed(frame));
 }
 
+TEST(ethernet, sharing) {
+    vector<u8> data = { 0x11, 0x22, 0x33, 0x44 };
+    eth_frame a("ff:ff:ff:ff:ff:ff", "12:23:34:45:56:67", data);
+    const eth_frame& ca = a;
+
+    // copies share the frame data until either of them gets modified
+    eth_frame b(a);
+    const eth_frame& cb = b;
+    EXPECT_TRUE(a.shared());
+    EXPECT_EQ(ca.data(), cb.data());
+    EXPECT_EQ(a, b);
+
+    b[14] = 0x55;
+    EXPECT_FALSE(a.shared());
+    EXPECT_FALSE(b.shared());
+    EXPECT_NE(ca.data(), cb.data());
+    EXPECT_EQ(a.payload(0), 0x11);
+    EXPECT_EQ(b.payload(0), 0x55);
+
+    // headers get prepended into the headroom without moving the data
+    const u8* old = ca.data();
+    u8* hdr = a.prepend(4);
+    memset(hdr, 0xaa, 4);
+    EXPECT_EQ(ca.data() + 4, old);
+    EXPECT_EQ(a.size(), eth_frame::FRAME_MIN_SIZE + 4);
+    a.pull(4);
+    EXPECT_EQ(ca.data(), old);
+    EXPECT_EQ(a.destination(), "ff:ff:ff:ff:ff:ff");
+
+    // released buffers go back to the pool and are handed out again
+    size_t cached = eth_frame::pool_size();
+    b.clear();
+    EXPECT_EQ(eth_frame::pool_size(), cached + 1);
+    eth_frame c(100);
+    EXPECT_EQ(eth_frame::pool_size(), cached);
+}
+
+static u32 csum_pseudo(const u8* ip, size_t tcplen) {
+    u32 sum = eth_frame::IP_TCP + tcplen;
+    for (size_t i = 12; i < 20; i += 2)
+        sum += ip[i] << 8 | ip[i + 1];
+    return sum;
+}
+
+static u16 csum_inet(const u8* data, size_t len, u32 sum = 0) {
+    for (size_t i = 0; i + 1 < len; i += 2)
+        sum += data[i] << 8 | data[i + 1];
+    if (len & 1)
+        sum += data[len - 1] << 8;
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return ~sum;
+}
+
+static eth_frame make_tcp_frame(size_t payload) {
+    eth_frame frame(14 + 20 + 20 + payload);
+    u8* ip = frame.data() + 14;
+    u8* tcp = ip + 20;
+
+    frame[12] = 0x08; // ipv4
+    frame[13] = 0x00;
+
+    ip[0] = 0x45;
+    ip[2] = (40 + payload) >> 8;
+    ip[3] = (40 + payload);
+    ip[4] = 0x12;
+    ip[5] = 0x34;
+    ip[8] = 64;
+    ip[9] = eth_frame::IP_TCP;
+    ip[12] = 10;
+    ip[15] = 1;
+    ip[16] = 10;
+    ip[19] = 2;
+
+    tcp[1] = 80;
+    tcp[3] = 80;
+    tcp[6] = 0x10; // seq 0x1000
+    tcp[12] = 0x50;
+    tcp[13] = 0x19; // fin, psh, ack
+
+    for (size_t i = 0; i < payload; i++)
+        tcp[20 + i] = i;
+
+    return frame;
+}
+
+TEST(ethernet, checksum) {
+    eth_frame frame = make_tcp_frame(101);
+    u8* ip = frame.data() + 14;
+    u8* tcp = ip + 20;
+
+    // senders leave the pseudo header sum in the checksum field
+    u32 pseudo = csum_pseudo(ip, 121);
+    u16 partial = ~csum_inet(nullptr, 0, pseudo);
+    tcp[16] = partial >> 8;
+    tcp[17] = partial;
+
+    frame.csum_partial = true;
+    frame.csum_start = 34;
+    frame.csum_offset = 16;
+    EXPECT_EQ(frame.offloads(), ETH_OFFLOAD_CSUM);
+
+    ASSERT_TRUE(frame.complete_checksum());
+    EXPECT_FALSE(frame.csum_partial);
+    EXPECT_TRUE(frame.csum_valid);
+    EXPECT_EQ(frame.offloads(), ETH_OFFLOAD_NONE);
+    EXPECT_EQ(csum_inet(tcp, 121, pseudo), 0);
+}
+
+TEST(ethernet, segment) {
+    eth_frame frame = make_tcp_frame(2500);
+    frame.csum_partial = true;
+    frame.csum_start = 34;
+    frame.csum_offset = 16;
+    frame.gso_type = eth_frame::GSO_TCPV4;
+    frame.gso_size = 1000;
+    EXPECT_EQ(frame.offloads(), ETH_OFFLOAD_CSUM | ETH_OFFLOAD_TSO4);
+
+    vector<eth_frame> segments;
+    ASSERT_TRUE(frame.resolve_offloads(segments));
+    ASSERT_EQ(segments.size(), 3u);
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        const eth_frame& seg = segments[i];
+        const u8* ip = seg.data() + 14;
+        const u8* tcp = ip + 20;
+        size_t n = i < 2 ? 1000 : 500;
+
+        EXPECT_EQ(seg.size(), 54 + n);
+        EXPECT_EQ(seg.offloads(), ETH_OFFLOAD_NONE);
+        EXPECT_EQ((size_t)(ip[2] << 8 | ip[3]), 40 + n);
+        EXPECT_EQ((size_t)(ip[4] << 8 | ip[5]), 0x1234 + i);
+        EXPECT_EQ(csum_inet(ip, 20), 0);
+
+        u32 seq = tcp[4] << 24 | tcp[5] << 16 | tcp[6] << 8 | tcp[7];
+        EXPECT_EQ(seq, 0x1000 + i * 1000);
+        EXPECT_EQ(tcp[13], i < 2 ? 0x10 : 0x19);
+        EXPECT_EQ(tcp[20], (u8)(i * 1000));
+        EXPECT_EQ(csum_inet(tcp, 20 + n, csum_pseudo(ip, 20 + n)), 0);
+    }
+}
+
 MATCHER_P(eth_match_socket, socket, "Matches an ethernet socket") {
     return &arg == socket;
 }
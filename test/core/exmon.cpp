@@ -114,3 +114,118 @@ TEST(tlm_exmon, dmi) {
     EXPECT_EQ(dmi.get_end_address(), -1);
     EXPECT_EQ(dmi.get_dmi_ptr(), (unsigned char*)400);
 }
+
+TEST(tlm_exmon, excl_dmi) {
+    unsigned char mem[256] = {};
+    vcml::u64 addr = 0;
+
+    tlm::tlm_dmi dmi;
+    dmi.set_dmi_ptr(mem);
+    dmi.set_start_address(0x1000);
+    dmi.set_end_address(0x10ff);
+
+    {
+        vcml::tlm_exmon mon;
+        EXPECT_TRUE(mon.allows_excl_dmi());
+        mon.register_dmi(dmi);
+        mon.register_dmi(dmi);
+
+        EXPECT_EQ(vcml::tlm_exmon::lookup_dmi(mem + 0x10, 4, addr), &mon);
+        EXPECT_EQ(addr, 0x1010);
+        EXPECT_EQ(vcml::tlm_exmon::lookup_dmi(mem + 0xfe, 4, addr), nullptr);
+
+        // locks taken via dmi must not restrict dmi for anybody else
+        mon.add_lock(0, { 0x1010, 0x1013 }, true);
+        tlm::tlm_generic_payload tx;
+        tx.set_address(0x1010);
+        EXPECT_TRUE(mon.override_dmi(tx, dmi));
+        EXPECT_EQ(dmi.get_start_address(), 0x1000);
+        EXPECT_EQ(dmi.get_end_address(), 0x10ff);
+
+        mon.add_lock(1, { 0x1010, 0x1013 });
+        EXPECT_FALSE(mon.override_dmi(tx, dmi));
+
+        mon.allow_excl_dmi(false);
+        EXPECT_EQ(vcml::tlm_exmon::lookup_dmi(mem, 4, addr), nullptr);
+
+        mon.allow_excl_dmi(true);
+        dmi.set_dmi_ptr(mem);
+        dmi.set_start_address(0x1000);
+        dmi.set_end_address(0x10ff);
+        mon.register_dmi(dmi);
+        EXPECT_EQ(vcml::tlm_exmon::lookup_dmi(mem, 4, addr), &mon);
+    }
+
+    // regions are forgotten once their monitor is gone
+    EXPECT_EQ(vcml::tlm_exmon::lookup_dmi(mem, 4, addr), nullptr);
+}
+
+// reference list-based monitor to compare against
+struct exmon_reference {
+    std::vector<vcml::exlock> locks;
+
+    void add_lock(int cpu, const vcml::range& r) {
+        break_locks(cpu);
+        locks.push_back({ cpu, r });
+    }
+
+    bool has_lock(int cpu, const vcml::range& r) const {
+        for (const auto& lock : locks)
+            if (lock.cpu == cpu && lock.addr.includes(r))
+                return true;
+        return false;
+    }
+
+    template <typename PRED>
+    void remove(PRED pred) {
+        locks.erase(std::remove_if(locks.begin(), locks.end(), pred),
+                    locks.end());
+    }
+
+    void break_locks(int cpu) {
+        remove([cpu](const vcml::exlock& l) { return l.cpu == cpu; });
+    }
+
+    void break_locks(const vcml::range& r) {
+        remove([r](const vcml::exlock& l) { return l.addr.overlaps(r); });
+    }
+};
+
+TEST(tlm_exmon, benchmark) {
+    const int ncpus = 16;
+    const int rounds = 20000;
+
+    vcml::tlm_exmon mon;
+    exmon_reference ref;
+
+    auto run = [&](auto& m) -> size_t {
+        size_t successes = 0;
+        for (int i = 0; i < rounds; i++) {
+            for (int cpu = 0; cpu < ncpus; cpu++) {
+                vcml::range lock(0x1000 + cpu * 64, 0x1000 + cpu * 64 + 3);
+                m.add_lock(cpu, lock);
+                m.break_locks(vcml::range(0x8000 + i % 256, 0x8000 + i % 256));
+                if (m.has_lock(cpu, lock))
+                    successes++;
+                if (cpu == i % ncpus)
+                    m.break_locks(lock);
+            }
+        }
+        return successes;
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t expect = run(ref);
+    auto t1 = std::chrono::steady_clock::now();
+    size_t actual = run(mon);
+    auto t2 = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(actual, expect);
+    EXPECT_EQ(mon.get_locks().size(), ref.locks.size());
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    std::cout << "reference: " << duration_cast<microseconds>(t1 - t0).count()
+              << "us, exmon: " << duration_cast<microseconds>(t2 - t1).count()
+              << "us" << std::endl;
+}
@@ -128,6 +128,24 @@ public:
         EXPECT_FALSE(in[0].read(TEST_VECTOR));
         EXPECT_FALSE(in[1].read(TEST_VECTOR));
 
+        // test bulk updates, lines that do not change are not forwarded
+        EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), true, TEST_VECTOR));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), true, TEST_VECTOR));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), true, 7));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), true, 7));
+        out.write({ { TEST_VECTOR, true }, { 7, true }, { 8, false } });
+        EXPECT_TRUE(in[0][TEST_VECTOR]);
+        EXPECT_TRUE(in[1][7]);
+        EXPECT_FALSE(in[0][8]);
+
+        EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), false, 7));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), false, 7));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), false, TEST_VECTOR));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), false, TEST_VECTOR));
+        out.write({ { 7, false }, { TEST_VECTOR, false }, { 7, false } });
+        EXPECT_FALSE(in[0][7]);
+        EXPECT_FALSE(in[1][TEST_VECTOR]);
+
         // test default events
         EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), true, GPIO_NO_VECTOR));
         EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), true, GPIO_NO_VECTOR));
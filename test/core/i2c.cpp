@@ -142,6 +142,44 @@ public:
         EXPECT_ACK(i2c_out.stop());
         EXPECT_CALL(*this, i2c_write(_, data)).Times(0);
         EXPECT_NACK(i2c_out.transport(data));
+
+        // test writing a whole message
+        u8 msg[3] = { 1, 2, 3 };
+        i2c_response acks[3] = {};
+        EXPECT_CALL(*this, i2c_start(i2c_match_address(44), TLM_WRITE_COMMAND))
+            .Times(1)
+            .WillOnce(Return(I2C_ACK));
+        EXPECT_CALL(*this, i2c_write(i2c_match_address(44), _))
+            .Times(3)
+            .WillRepeatedly(Return(I2C_ACK));
+        EXPECT_CALL(*this, i2c_stop(i2c_match_address(44)))
+            .Times(1)
+            .WillOnce(Return(I2C_ACK));
+        EXPECT_ACK(i2c_out.transport(44, TLM_WRITE_COMMAND, msg, 3, acks));
+        EXPECT_ACK(acks[0]);
+        EXPECT_ACK(acks[1]);
+        EXPECT_ACK(acks[2]);
+
+        // reading stops after the first byte that was not acknowledged
+        EXPECT_CALL(*this, i2c_start(i2c_match_address(42), TLM_READ_COMMAND))
+            .Times(1)
+            .WillOnce(Return(I2C_ACK));
+        EXPECT_CALL(*this, i2c_read(i2c_match_address(42), _))
+            .Times(2)
+            .WillOnce(DoAll(SetArgReferee<1>(7), Return(I2C_ACK)))
+            .WillOnce(Return(I2C_NACK));
+        EXPECT_CALL(*this, i2c_stop(i2c_match_address(42)))
+            .Times(1)
+            .WillOnce(Return(I2C_ACK));
+        EXPECT_NACK(i2c_out.transport(42, TLM_READ_COMMAND, msg, 3, acks));
+        EXPECT_EQ(msg[0], 7);
+        EXPECT_ACK(acks[0]);
+        EXPECT_NACK(acks[1]);
+        EXPECT_EQ(acks[2], I2C_INCOMPLETE);
+
+        // messages to non-existent addresses fail without any data
+        EXPECT_NACK(i2c_out.transport(99, TLM_WRITE_COMMAND, msg, 3, acks));
+        EXPECT_EQ(acks[0], I2C_INCOMPLETE);
     }
 };
 
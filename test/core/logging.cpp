@@ -114,6 +114,22 @@ TEST(logging, component) {
     comp.log_error("error message");
 }
 
+TEST(logging, compiled_in) {
+    EXPECT_TRUE(vcml::logger::compiled_in(vcml::LOG_ERROR));
+    EXPECT_EQ(vcml::logger::compiled_in(vcml::LOG_DEBUG),
+              VCML_LOG_LEVEL >= vcml::LOG_DEBUG);
+
+    vcml::component comp("mock_compiled_in");
+    comp.loglvl = vcml::LOG_DEBUG;
+    EXPECT_EQ(comp.log.can_log(vcml::LOG_DEBUG),
+              vcml::logger::compiled_in(vcml::LOG_DEBUG));
+
+    // arguments of discarded messages must not be evaluated
+    int count = 0;
+    comp.log_debug("debug message %d", count++);
+    EXPECT_EQ(count, vcml::logger::compiled_in(vcml::LOG_DEBUG) ? 1 : 0);
+}
+
 class mock_component : public vcml::component
 {
 public:
@@ -156,3 +172,59 @@ TEST(logging, reporting) {
     EXPECT_CALL(publisher, publish(match_level(vcml::LOG_ERROR))).Times(1);
     vcml::log.error(rep);
 }
+
+TEST(logging, async) {
+    std::stringstream ss;
+    vcml::component comp("async");
+    {
+        vcml::async_publisher async(ss, 16);
+        async.set_level(vcml::LOG_ERROR, vcml::LOG_DEBUG);
+        for (int i = 0; i < 10; i++)
+            comp.log_warn("repeated warning");
+        comp.log_info("final message");
+    }
+
+    std::string out = ss.str();
+    size_t first = out.find("repeated warning");
+    EXPECT_NE(first, std::string::npos);
+    EXPECT_EQ(out.find("repeated warning", first + 1), std::string::npos);
+    EXPECT_NE(out.find("final message"), std::string::npos);
+
+    // repeats may be reported in several chunks if the writer went idle
+    size_t repeats = 0;
+    for (size_t pos = out.find("] async: ("); pos != std::string::npos;
+         pos = out.find("] async: (", pos + 1))
+        repeats += std::stoul(out.substr(pos + 10));
+    EXPECT_EQ(repeats, 9u);
+}
+
+TEST(logging, throttle) {
+    vcml::log_throttle throttle(2);
+
+    // reported at the 1st, 2nd, 4th and 8th occurrence, then never again
+    std::vector<vcml::u64> reported;
+    for (vcml::u64 i = 1; i <= 32; i++) {
+        if (throttle.record(0, 0x1000, 4))
+            reported.push_back(i);
+    }
+
+    EXPECT_EQ(reported, std::vector<vcml::u64>({ 1, 2, 4, 8 }));
+    EXPECT_EQ(throttle.count(0, 0x1000), 32u);
+    EXPECT_EQ(throttle.count(1, 0x1000), 0u);
+
+    EXPECT_TRUE(throttle.record(1, 0x1000, 4));
+    EXPECT_FALSE(throttle.record(1, 0x2000, 4)) << "cache should be full";
+    EXPECT_TRUE(throttle.record(1, 0x2000, 0)) << "limit 0 reports all";
+    EXPECT_EQ(throttle.size(), 2u);
+    EXPECT_EQ(throttle.untracked(), 2u);
+    EXPECT_EQ(throttle.total(), 35u);
+
+    std::stringstream ss;
+    throttle.summary(ss, [](vcml::u64 s) { return "src" + std::to_string(s); });
+    EXPECT_NE(ss.str().find("src0 0x0000000000001000: 32"), std::string::npos);
+    EXPECT_NE(ss.str().find("2 errors at untracked"), std::string::npos);
+
+    throttle.reset();
+    EXPECT_EQ(throttle.total(), 0u);
+    EXPECT_EQ(throttle.size(), 0u);
+}
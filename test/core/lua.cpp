@@ -10,6 +10,8 @@
 
 #include "testing.h"
 
+#include <filesystem>
+
 TEST(core, lua) {
     string s;
     mwr::publishers::terminal logger;
@@ -32,3 +34,36 @@ TEST(core, lua) {
         std::cout << prop << " = " << val << std::endl;
     }
 }
+
+TEST(core, lua_cache) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "vcml-test-lua-cache";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    setenv("VCML_LUA_CACHE", dir.c_str(), 1);
+
+    string s1, s2;
+    {
+        broker_lua lua(get_resource_path("test.lua"));
+        ASSERT_TRUE(lua.lookup("outer.inner.strprop", s1));
+    }
+
+    size_t files = 0;
+    for (const auto& entry : fs::directory_iterator(dir))
+        files += entry.path().extension() == ".luacache" ? 1 : 0;
+    EXPECT_EQ(files, 1u);
+
+    // second run replays the cached keys
+    {
+        broker_lua lua(get_resource_path("test.lua"));
+        ASSERT_TRUE(lua.lookup("outer.inner.strprop", s2));
+        EXPECT_EQ(s1, s2);
+        ASSERT_TRUE(lua.lookup("index.property", s2));
+        EXPECT_EQ(s2, "456");
+        ASSERT_TRUE(lua.lookup("test.property2", s2));
+        EXPECT_EQ(s2, "123");
+    }
+
+    unsetenv("VCML_LUA_CACHE");
+    fs::remove_all(dir);
+}
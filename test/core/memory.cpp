@@ -112,3 +112,183 @@ TEST(memory, sharing_wrong_size) {
     EXPECT_DEATH({ tlm_memory b(name, size * 2); }, "unexpected size");
     EXPECT_DEATH({ tlm_memory b(name, size / 2); }, "unexpected size");
 }
+
+TEST(memory, hugepages) {
+    const size_t size = 3 * MiB;
+
+    tlm_memory mem;
+    mem.use_transparent_hugepages();
+    mem.use_explicit_hugepages();
+    mem.prefault();
+    mem.init(size, VCML_ALIGN_NONE);
+
+    EXPECT_EQ(mem.size(), size) << "huge page rounding visible to user";
+    EXPECT_GE(mem.page_size(), 4 * KiB) << "invalid page size";
+
+    u8 data = 0x42;
+    EXPECT_OK(mem.write(range(size - 1, size - 1), &data, false));
+    EXPECT_EQ(mem[size - 1], data) << "data not stored";
+}
+
+TEST(memory, map_file) {
+    const size_t size = 64 * KiB;
+    const string path = "/tmp/vcml-test-map-file.bin";
+
+    vector<u8> image(8 * KiB + 3);
+    for (size_t i = 0; i < image.size(); i++)
+        image[i] = (u8)(i * 7);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char*)image.data(), image.size());
+    file.close();
+
+    tlm_memory mem(size);
+    mem.fill(0xee);
+
+    EXPECT_FALSE(mem.map_file(path, 0x100)) << "unaligned file mapped";
+    EXPECT_FALSE(mem.map_file(path, size - 4 * KiB)) << "oversized mapped";
+    ASSERT_TRUE(mem.map_file(path, 16 * KiB)) << "cannot map file";
+
+    for (size_t i = 0; i < image.size(); i++)
+        ASSERT_EQ(mem[16 * KiB + i], image[i]) << "mismatch at " << i;
+
+    EXPECT_EQ(mem[16 * KiB + image.size()], 0xee) << "tail overwritten";
+    EXPECT_EQ(mem[16 * KiB - 1], 0xee) << "head overwritten";
+
+    mem[16 * KiB] = 0x42;
+    std::ifstream check(path, std::ios::binary);
+    EXPECT_EQ(check.get(), image[0]) << "guest write reached image file";
+
+    std::remove(path.c_str());
+}
+
+TEST(memory, clear) {
+    const size_t size = 64 * KiB;
+    const string path = "/tmp/vcml-test-clear.bin";
+
+    vector<u8> image(8 * KiB, 0x5a);
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char*)image.data(), image.size());
+    file.close();
+
+    tlm_memory mem(size);
+    mem.track_dirty(4 * KiB);
+    mem.fill(0xee);
+    ASSERT_TRUE(mem.map_file(path, 16 * KiB)) << "cannot map file";
+    mem.fetch_dirty({ 0, size - 1 });
+
+    range addr(0x100, 40 * KiB);
+    mem.clear(addr);
+    for (u64 i = addr.start; i <= addr.end; i++)
+        ASSERT_EQ(mem[i], 0) << "not cleared at " << i;
+
+    EXPECT_EQ(mem[addr.start - 1], 0xee) << "head cleared";
+    EXPECT_EQ(mem[addr.end + 1], 0xee) << "tail cleared";
+
+    vector<u64> dirty = mem.fetch_dirty({ 0, size - 1 });
+    ASSERT_EQ(dirty.size(), 1);
+    EXPECT_EQ(dirty[0], 0x7ff) << "cleared pages not marked dirty";
+
+    // dropping the file mapping must not bring back the file contents
+    mem.clear();
+    EXPECT_EQ(mem[16 * KiB], 0) << "file contents visible after clear";
+    mem[16 * KiB] = 0x42;
+    EXPECT_EQ(mem[16 * KiB], 0x42) << "cleared memory not writable";
+
+    std::ifstream check(path, std::ios::binary);
+    EXPECT_EQ(check.get(), 0x5a) << "clear reached image file";
+    std::remove(path.c_str());
+}
+
+TEST(memory, dirty) {
+    tlm_memory mem(64 * KiB);
+    EXPECT_FALSE(mem.is_tracking_dirty());
+
+    mem.track_dirty(4 * KiB);
+    EXPECT_TRUE(mem.is_tracking_dirty());
+    EXPECT_EQ(mem.dirty_page_size(), 4 * KiB);
+
+    u32 data = 0xffffffff;
+    EXPECT_OK(mem.write(0x1000, data));
+    EXPECT_OK(mem.write(0x3ffe, data));
+    EXPECT_OK(mem.read(0x8000, data));
+
+    vector<u64> dirty = mem.fetch_dirty({ 0, 64 * KiB - 1 });
+    ASSERT_EQ(dirty.size(), 1);
+    EXPECT_EQ(dirty[0], 0b11010) << "wrong pages reported dirty";
+
+    dirty = mem.fetch_dirty({ 0, 64 * KiB - 1 });
+    EXPECT_EQ(dirty[0], 0) << "dirty bitmap not cleared";
+
+    mem.mark_dirty({ 0x5000, 0x5000 });
+    dirty = mem.fetch_dirty({ 0x4000, 0x7fff });
+    ASSERT_EQ(dirty.size(), 1);
+    EXPECT_EQ(dirty[0], 0b10) << "bitmap not relative to range start";
+
+    mem.untrack_dirty();
+    EXPECT_FALSE(mem.is_tracking_dirty());
+}
+
+TEST(memory, transport) {
+    tlm_memory mem(4 * KiB);
+    mem.track_dirty(1 * KiB);
+
+    u8 buf[32];
+    for (size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (u8)(i + 1);
+
+    // fixed address burst, only the last beat remains in memory
+    tlm_generic_payload tx;
+    tx_setup(tx, TLM_WRITE_COMMAND, 0x100, buf, sizeof(buf));
+    tx.set_streaming_width(4);
+    mem.transport(tx, SBI_NONE);
+    EXPECT_OK(tx.get_response_status());
+    EXPECT_EQ(mem[0x100], 29);
+    EXPECT_EQ(mem[0x103], 32);
+    EXPECT_EQ(mem[0x104], 0) << "burst did not wrap";
+
+    // reads replicate the memory into every beat
+    u8 rd[16] = {};
+    tx_setup(tx, TLM_READ_COMMAND, 0x100, rd, sizeof(rd));
+    tx.set_streaming_width(4);
+    mem.transport(tx, SBI_NONE);
+    EXPECT_OK(tx.get_response_status());
+    for (size_t i = 0; i < sizeof(rd); i++)
+        EXPECT_EQ(rd[i], (u8)(29 + i % 4)) << "at index " << i;
+
+    // byte enables leave disabled bytes untouched
+    u8 be[3] = { 0xff, 0x00, 0xff };
+    tx_setup(tx, TLM_WRITE_COMMAND, 0x200, buf, sizeof(buf));
+    tx.set_byte_enable_ptr(be);
+    tx.set_byte_enable_length(sizeof(be));
+    mem.transport(tx, SBI_NONE);
+    EXPECT_OK(tx.get_response_status());
+    for (size_t i = 0; i < sizeof(buf); i++)
+        EXPECT_EQ(mem[0x200 + i], i % 3 == 1 ? 0 : buf[i]) << "at " << i;
+
+    // gather list, the data buffer holds all entries back to back
+    vector<u64> dirty = mem.fetch_dirty({ 0, 4 * KiB - 1 });
+    tx_setup(tx, TLM_WRITE_COMMAND, 0x400, buf, 12);
+    tx.set_extension(new tlm_gather({ { 0x000, 4 }, { 0x800, 8 } }));
+    mem.transport(tx, SBI_NONE);
+    EXPECT_OK(tx.get_response_status());
+    EXPECT_EQ(mem[0x400], 1);
+    EXPECT_EQ(mem[0x403], 4);
+    EXPECT_EQ(mem[0xc00], 5);
+    EXPECT_EQ(mem[0xc07], 12);
+    dirty = mem.fetch_dirty({ 0, 4 * KiB - 1 });
+    EXPECT_EQ(dirty[0], 0b1010) << "gather did not mark pages dirty";
+
+    // gather lists are bounds checked before anything gets copied
+    tx_setup(tx, TLM_WRITE_COMMAND, 0x400, buf, 12);
+    tx.get_extension<tlm_gather>()->entries[1].offset = 0xc00;
+    mem[0x400] = 0;
+    mem.transport(tx, SBI_NONE);
+    EXPECT_AE(tx.get_response_status());
+    EXPECT_EQ(mem[0x400], 0) << "failed gather modified memory";
+
+    tx_setup(tx, TLM_READ_COMMAND, 0x400, buf, 8);
+    mem.transport(tx, SBI_NONE);
+    EXPECT_EQ(tx.get_response_status(), TLM_GENERIC_ERROR_RESPONSE)
+        << "gather size mismatch not detected";
+}
@@ -0,0 +1,89 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+static const u16 METRICS_PORT = 47891;
+
+class metrics_harness : public test_base
+{
+public:
+    tlm_initiator_socket out;
+    tlm_target_socket in;
+
+    metrics_harness(const sc_module_name& nm):
+        test_base(nm), out("out"), in("in") {
+        out.allow_dmi = false;
+        out.bind(in);
+    }
+
+    virtual unsigned int transport(tlm_target_socket& socket,
+                                   tlm_generic_payload& tx,
+                                   const tlm_sbi& sideband) override {
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    string scrape(const string& path) {
+        string response;
+        atomic<bool> done(false);
+        thread client([&]() -> void {
+            try {
+                mwr::socket sock;
+                sock.connect("localhost", METRICS_PORT);
+                sock.send("GET " + path + " HTTP/1.1\r\n\r\n");
+                while (true)
+                    response += sock.recv_char();
+            } catch (...) {
+                // server closed the connection
+            }
+
+            done = true;
+        });
+
+        // keep the simulation going, snapshots are taken on its side
+        while (!done)
+            wait(1, SC_US);
+
+        client.join();
+        return response;
+    }
+
+    virtual void run_test() override {
+        EXPECT_OK(out.writew<u32>(0x10, 0x1234));
+        EXPECT_OK(out.writew<u32>(0x14, 0x5678));
+
+        debugging::metrics_server server(METRICS_PORT);
+        EXPECT_TRUE(server.snapshot().empty());
+        server.start();
+
+        string resp = scrape("/metrics");
+        EXPECT_TRUE(starts_with(resp, "HTTP/1.1 200 OK\r\n"));
+        EXPECT_TRUE(contains(resp, "application/openmetrics-text"));
+        EXPECT_TRUE(contains(resp, "# TYPE vcml_sim_time_seconds gauge"));
+        EXPECT_TRUE(contains(resp, "vcml_tlm_initiator_transactions_total"
+                                   "{socket=\"metrics.out\"} 2\n"));
+        EXPECT_TRUE(contains(resp, "vcml_tlm_target_bytes_total"
+                                   "{socket=\"metrics.in\"} 8\n"));
+        EXPECT_TRUE(ends_with(resp, "# EOF\n"));
+        EXPECT_FALSE(server.snapshot().empty());
+
+        resp = scrape("/nothing");
+        EXPECT_TRUE(starts_with(resp, "HTTP/1.1 404 Not Found\r\n"));
+
+        server.shutdown();
+        EXPECT_FALSE(server.is_running());
+    }
+};
+
+TEST(metrics, scrape) {
+    metrics_harness test("metrics");
+    sc_core::sc_start();
+}
@@ -51,3 +51,59 @@ TEST(mode, nonexistent) {
 TEST(mode, duplicate) {
     EXPECT_FALSE(vcml::model::define("my_model", nullptr));
 }
+
+TEST(model, startup_profile) {
+    startup_profiler::enable();
+    startup_profiler::reset();
+
+    {
+        vcml::model m("p", "empty");
+        startup_profiler::scope scope("test", "scope");
+    }
+
+    startup_profiler::enable(false);
+    vcml::model m("q", "empty");
+
+    // module properties also account for broker lookups
+    vector<startup_profiler::entry> entries = startup_profiler::entries();
+    ASSERT_EQ(entries.size(), 3);
+    for (const auto& entry : entries) {
+        EXPECT_GE(entry.seconds, 0.0);
+        if (entry.phase == "broker")
+            EXPECT_GT(entry.count, 1);
+        else
+            EXPECT_EQ(entry.count, 1);
+    }
+
+    stringstream ss;
+    startup_profiler::report(ss);
+    EXPECT_NE(ss.str().find("construct p"), string::npos);
+    EXPECT_NE(ss.str().find("test      scope"), string::npos);
+    EXPECT_EQ(ss.str().find("construct q"), string::npos);
+}
+
+class irq_source : public module
+{
+public:
+    gpio_initiator_socket irq;
+    irq_source(const sc_module_name& nm): module(nm), irq("irq") {}
+    virtual ~irq_source() = default;
+    VCML_KIND(irq_source);
+};
+
+TEST(model, optional) {
+    broker config("optional");
+    config.define("on.enabled", "true");
+
+    vcml::model on("on", "my_model abc def hij", true);
+    vcml::model off("off", "my_model abc def hij", true);
+    EXPECT_TRUE(on.is_enabled());
+    EXPECT_FALSE(off.is_enabled());
+    EXPECT_STREQ(on->kind(), "vcml::my_model");
+    EXPECT_STREQ(off->kind(), "vcml::placeholder");
+
+    // binding to a placeholder stubs the other side
+    irq_source src("src");
+    gpio_bind(src, "irq", off, "irq");
+    EXPECT_TRUE(src.irq.is_stubbed());
+}
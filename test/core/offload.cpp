@@ -0,0 +1,74 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class offload_test : public test_base
+{
+public:
+    offload job;
+
+    atomic<bool> busy;
+    bool overlapped;
+
+    offload_test(const sc_module_name& nm):
+        test_base(nm),
+        job(this, "job", true, sc_time(1, SC_MS), 1000000),
+        busy(false),
+        overlapped(false) {
+        SC_HAS_PROCESS(offload_test);
+        SC_THREAD(ticker);
+    }
+
+    void ticker() {
+        while (sc_time_stamp() < sc_time(1, SC_MS)) {
+            if (busy)
+                overlapped = true;
+            wait(10, SC_US);
+        }
+    }
+
+    virtual void run_test() override {
+        EXPECT_EQ(job.cost(0), sc_time(1, SC_MS));
+        EXPECT_EQ(job.cost(1000), sc_time(2, SC_MS));
+
+        // the job runs on a worker while the ticker keeps going
+        u32 result = 0;
+        job.run(
+            [&]() -> void {
+                EXPECT_FALSE(thctl_is_sysc_thread());
+                busy = true;
+                mwr::usleep(20000);
+                result = 42;
+                busy = false;
+            },
+            1000);
+
+        EXPECT_EQ(result, 42) << "resumed before job finished";
+        EXPECT_EQ(sc_time_stamp(), sc_time(2, SC_MS));
+        EXPECT_TRUE(overlapped) << "simulation stalled during job";
+        EXPECT_EQ(job.num_jobs(), 1);
+        EXPECT_EQ(job.num_async(), 1);
+
+        // without async, the job runs inline but still costs time
+        job.async = false;
+        job.run([&]() -> void { EXPECT_TRUE(thctl_is_sysc_thread()); });
+        EXPECT_EQ(sc_time_stamp(), sc_time(3, SC_MS));
+        EXPECT_EQ(job.num_jobs(), 2);
+        EXPECT_EQ(job.num_async(), 1);
+    }
+};
+
+TEST(offload, run) {
+    offload_test test("offload");
+    EXPECT_EQ(string(test.job.async.name()), "job_async");
+    EXPECT_EQ(string(test.job.throughput.name()), "job_throughput");
+    sc_core::sc_start();
+}
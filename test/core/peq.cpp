@@ -16,12 +16,14 @@ public:
     peq_test(const sc_module_name& nm): test_base(nm) {}
     virtual ~peq_test() = default;
 
-    virtual void run_test() override {
+    void test_queue(const char* nm, peq_backend backend) {
         int val;
-        peq<int> queue("peq");
+        peq<int> queue(nm, backend);
+        sc_time start = sc_time_stamp();
 
-        EXPECT_STREQ(queue.name(), "test.run.peq");
+        EXPECT_STREQ(queue.name(), mkstr("test.run.%s", nm).c_str());
         EXPECT_STREQ(queue.kind(), "vcml::peq");
+        EXPECT_EQ(queue.backend(), backend);
 
         queue.notify(2, 2.0, SC_SEC);
         queue.notify(1, 1.0, SC_SEC);
@@ -30,21 +32,21 @@ public:
 
         queue.wait(val);
         EXPECT_EQ(val, 1);
-        EXPECT_EQ(sc_time_stamp(), sc_time(1.0, SC_SEC));
+        EXPECT_EQ(sc_time_stamp() - start, sc_time(1.0, SC_SEC));
 
         queue.notify(4, 2.0, SC_SEC);
 
         queue.wait(val);
         EXPECT_EQ(val, 2);
-        EXPECT_EQ(sc_time_stamp(), sc_time(2.0, SC_SEC));
+        EXPECT_EQ(sc_time_stamp() - start, sc_time(2.0, SC_SEC));
 
         queue.wait(val);
         EXPECT_EQ(val, 3);
-        EXPECT_EQ(sc_time_stamp(), sc_time(3.0, SC_SEC));
+        EXPECT_EQ(sc_time_stamp() - start, sc_time(3.0, SC_SEC));
 
         queue.wait(val);
         EXPECT_EQ(val, 4);
-        EXPECT_EQ(sc_time_stamp(), sc_time(3.0, SC_SEC));
+        EXPECT_EQ(sc_time_stamp() - start, sc_time(3.0, SC_SEC));
 
         queue.notify(5, 1.0, SC_SEC);
         queue.notify(6, 2.0, SC_SEC);
@@ -53,7 +55,51 @@ public:
 
         queue.wait(val);
         EXPECT_EQ(val, 6);
-        EXPECT_EQ(sc_time_stamp(), sc_time(5.0, SC_SEC));
+        EXPECT_EQ(sc_time_stamp() - start, sc_time(5.0, SC_SEC));
+
+        queue.notify(7, 1.0, SC_SEC);
+        queue.cancel(7);
+        queue.notify(7, 2.0, SC_SEC);
+
+        queue.wait(val);
+        EXPECT_EQ(val, 7);
+        EXPECT_EQ(sc_time_stamp() - start, sc_time(7.0, SC_SEC));
+    }
+
+    void benchmark(const char* nm, peq_backend backend) {
+        const int events = 20000;
+        peq<int> queue(nm, backend);
+        double t0 = mwr::timestamp();
+
+        for (int i = 0; i < events; i++)
+            queue.notify(i, (i % 64) * sc_time(1.0, SC_NS));
+        for (int i = 0; i < events; i += 4)
+            queue.cancel(i);
+
+        int val, count = 0, prev = -1;
+        sc_time last = sc_time_stamp();
+        for (int i = 0; i < events * 3 / 4; i++) {
+            queue.wait(val);
+            EXPECT_NE(val % 4, 0);
+            if (sc_time_stamp() == last)
+                EXPECT_GT(val, prev) << "events out of order";
+            last = sc_time_stamp();
+            prev = val;
+            count++;
+        }
+
+        double t1 = mwr::timestamp();
+        EXPECT_EQ(count, events * 3 / 4);
+        std::cout << nm << ": " << (t1 - t0) * 1e9 / events << "ns per event"
+                  << std::endl;
+    }
+
+    virtual void run_test() override {
+        test_queue("peq", PEQ_TREE);
+        test_queue("peq_heap", PEQ_HEAP);
+
+        benchmark("bench_tree", PEQ_TREE);
+        benchmark("bench_heap", PEQ_HEAP);
     }
 };
 
@@ -22,6 +22,7 @@ public:
         tlm_bind(*this, "out", probe, "in");
         tlm_bind(probe, "out", *this, "in");
         EXPECT_STREQ(probe.kind(), "vcml::tlm_probe");
+        probe.collect_stats = true;
     }
 
     virtual ~test_harness() = default;
@@ -43,6 +44,19 @@ public:
 
         EXPECT_CALL(*this, receive(TLM_READ_COMMAND, 0x5678));
         EXPECT_OK(out.readw(0x5678, data));
+
+        EXPECT_EQ(probe.num_writes, 1);
+        EXPECT_EQ(probe.num_reads, 1);
+        EXPECT_EQ(probe.bytes_written, 4);
+        EXPECT_EQ(probe.bytes_read, 4);
+        EXPECT_EQ(probe.num_errors, 0);
+        EXPECT_EQ(probe.count_response(TLM_OK_RESPONSE), 2);
+        EXPECT_EQ(probe.count_size(2), 2);
+        EXPECT_STREQ(probe.num_writes.str(), "1");
+
+        probe.reset_stats();
+        EXPECT_EQ(probe.num_writes, 0);
+        EXPECT_EQ(probe.count_size(2), 0);
     }
 };
 
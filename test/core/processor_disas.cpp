@@ -0,0 +1,92 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+
+#include "vcml.h"
+
+class disas_processor : public vcml::processor
+{
+public:
+    vcml::u8 mem[64];
+    size_t disassembled;
+    size_t traced;
+
+    disas_processor(const sc_core::sc_module_name& nm):
+        vcml::processor(nm, "disas"), mem(), disassembled(0), traced(0) {
+        for (size_t i = 0; i < sizeof(mem); i++)
+            mem[i] = (vcml::u8)i;
+    }
+
+    virtual ~disas_processor() = default;
+
+    virtual vcml::u64 cycle_count() const override { return 0; }
+    virtual void simulate(size_t n) override {}
+
+    virtual vcml::u64 program_counter() override { return 0; }
+
+    virtual vcml::u64 read_pmem_dbg(vcml::u64 addr, void* buf,
+                                    vcml::u64 size) override {
+        if (addr >= sizeof(mem))
+            return 0;
+        size = std::min<vcml::u64>(size, sizeof(mem) - addr);
+        memcpy(buf, mem + addr, size);
+        return size;
+    }
+
+    virtual bool disassemble(vcml::u8* ibuf, vcml::u64& addr,
+                             std::string& code) override {
+        code = vcml::mkstr("insn %02x", ibuf[0]);
+        addr += 4;
+        disassembled++;
+        return true;
+    }
+
+    virtual void stacktrace(std::vector<vcml::debugging::stackframe>& trace,
+                            size_t limit) override {
+        vcml::processor::stacktrace(trace, limit);
+        traced++;
+    }
+};
+
+TEST(processor, disas_cache) {
+    disas_processor cpu("DISAS");
+    std::stringstream ss1, ss2, ss3;
+
+    // second disassembly of the same range is served from the cache
+    EXPECT_TRUE(cpu.execute("disas", { "0", "16" }, ss1));
+    EXPECT_EQ(cpu.disassembled, 4u);
+    EXPECT_TRUE(cpu.execute("disas", { "0", "16" }, ss2));
+    EXPECT_EQ(cpu.disassembled, 4u);
+    EXPECT_EQ(ss1.str(), ss2.str());
+
+    // modified instructions get disassembled again
+    cpu.mem[4] = 0xff;
+    EXPECT_TRUE(cpu.execute("disas", { "0", "16" }, ss3));
+    EXPECT_EQ(cpu.disassembled, 5u);
+    EXPECT_NE(ss3.str().find("insn ff"), std::string::npos);
+}
+
+TEST(processor, stack_cache) {
+    disas_processor cpu("STACK");
+    std::stringstream ss;
+
+    EXPECT_TRUE(cpu.execute("stack", ss));
+    EXPECT_TRUE(cpu.execute("stack", ss));
+    EXPECT_EQ(cpu.traced, 1u);
+
+    // stack memory may have changed once the simulation resumed
+    cpu.session_suspend();
+    cpu.session_resume();
+    EXPECT_TRUE(cpu.execute("stack", ss));
+    EXPECT_EQ(cpu.traced, 2u);
+}
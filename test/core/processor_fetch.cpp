@@ -0,0 +1,80 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+
+#include "vcml.h"
+
+class fetch_processor : public vcml::processor
+{
+public:
+    vcml::gpio_initiator_socket rst_out;
+    vcml::clk_initiator_socket clk_out;
+
+    fetch_processor(const sc_core::sc_module_name& nm):
+        vcml::processor(nm, "fetch"), rst_out("rst_out"), clk_out("clk_out") {
+        // nothing to do
+    }
+
+    virtual ~fetch_processor() = default;
+
+    virtual vcml::u64 cycle_count() const override { return 0; }
+    virtual void simulate(size_t n) override {}
+
+    virtual void end_of_elaboration() override {
+        clk_out = 1 * vcml::kHz;
+        rst_out.pulse();
+    }
+};
+
+TEST(processor, fetch_block) {
+    vcml::generic::memory imem("IMEM", 0x1000);
+    vcml::generic::memory dmem("DMEM", 0x1000);
+    fetch_processor cpu("FETCH");
+
+    cpu.clk_out.bind(cpu.clk);
+    cpu.rst_out.bind(cpu.rst);
+    cpu.clk_out.bind(imem.clk);
+    cpu.rst_out.bind(imem.rst);
+    cpu.clk_out.bind(dmem.clk);
+    cpu.rst_out.bind(dmem.rst);
+
+    cpu.insn.bind(imem.in);
+    cpu.data.bind(dmem.in);
+
+    sc_core::sc_start(sc_core::SC_ZERO_TIME);
+
+    vcml::u32 insn = 0x11223344;
+    EXPECT_EQ(cpu.insn.writew(0x10, insn, vcml::SBI_DEBUG),
+              tlm::TLM_OK_RESPONSE);
+
+    // blocks reach up to the end of the dmi region
+    vcml::u64 size = 0;
+    const vcml::u8* ptr = cpu.fetch_block(0x10, size);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(size, 0x1000 - 0x10);
+    EXPECT_EQ(memcmp(ptr, &insn, sizeof(insn)), 0);
+
+    // lookups within the same block are served without the socket
+    vcml::u64 epoch = cpu.fetch_epoch();
+    vcml::u64 misses = cpu.insn.dmi_misses();
+    EXPECT_EQ(cpu.fetch_block(0x20, size), ptr + 0x10);
+    EXPECT_EQ(size, 0x1000 - 0x20);
+    EXPECT_EQ(cpu.insn.dmi_misses(), misses);
+    EXPECT_EQ(cpu.fetch_epoch(), epoch);
+
+    // invalidating dmi starts a new epoch
+    imem.in.invalidate_dmi();
+    EXPECT_NE(cpu.fetch_epoch(), epoch);
+    EXPECT_NE(cpu.fetch_block(0x10, size), nullptr);
+}
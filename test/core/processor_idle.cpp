@@ -0,0 +1,96 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+
+#include "vcml.h"
+
+const vcml::hz_t DEFCLK = 1 * vcml::kHz;
+
+class idle_processor : public vcml::processor
+{
+public:
+    vcml::u64 cycles;
+    bool wfi;
+
+    vcml::gpio_initiator_socket rst_out;
+    vcml::clk_initiator_socket clk_out;
+    vcml::gpio_initiator_socket irq0;
+
+    idle_processor(const sc_core::sc_module_name& nm):
+        vcml::processor(nm, "idle"),
+        cycles(0),
+        wfi(false),
+        rst_out("rst_out"),
+        clk_out("clk_out"),
+        irq0("irq0") {
+        // nothing to do
+    }
+
+    virtual ~idle_processor() = default;
+
+    virtual vcml::u64 cycle_count() const override { return cycles; }
+
+    virtual void simulate(size_t n) override {
+        if (wfi) {
+            wfi = false;
+            cycles++;
+            enter_idle();
+        } else {
+            cycles += n;
+        }
+    }
+
+    virtual void end_of_elaboration() override {
+        clk_out = DEFCLK;
+        rst_out.pulse();
+    }
+};
+
+TEST(processor, idle) {
+    vcml::generic::memory imem("IMEM", 0x1000);
+    vcml::generic::memory dmem("DMEM", 0x1000);
+
+    idle_processor cpu("IDLE");
+
+    cpu.clk_out.bind(cpu.clk);
+    cpu.rst_out.bind(cpu.rst);
+    cpu.clk_out.bind(imem.clk);
+    cpu.rst_out.bind(imem.rst);
+    cpu.clk_out.bind(dmem.clk);
+    cpu.rst_out.bind(dmem.rst);
+
+    cpu.insn.bind(imem.in);
+    cpu.data.bind(dmem.in);
+    cpu.irq[0].bind(cpu.irq0);
+
+    sc_core::sc_start(sc_core::SC_ZERO_TIME);
+
+    sc_core::sc_time quantum(1.0, sc_core::SC_SEC);
+    sc_core::sc_time cycle = cpu.clock_cycle();
+    tlm::tlm_global_quantum::instance().set(quantum);
+
+    EXPECT_FALSE(vcml::processor::platform_idle());
+
+    cpu.wfi = true;
+    sc_core::sc_start(10 * quantum);
+    EXPECT_EQ(cpu.cycles, 1) << "processor simulated while idle";
+    EXPECT_TRUE(vcml::processor::platform_idle());
+
+    cpu.irq0 = true;
+    sc_core::sc_start(quantum);
+    EXPECT_EQ(cpu.get_idle_time(), 10 * quantum - cycle);
+    EXPECT_EQ(cpu.get_idle_cycles(), (10 * quantum - cycle) / cycle);
+    EXPECT_GT(cpu.cycles, 1) << "processor did not wake up";
+    EXPECT_FALSE(cpu.is_idle());
+    EXPECT_FALSE(vcml::processor::platform_idle());
+}
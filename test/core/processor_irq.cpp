@@ -0,0 +1,105 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+
+#include "vcml.h"
+
+const vcml::hz_t DEFCLK = 1 * vcml::kHz;
+
+class idle_processor : public vcml::processor
+{
+public:
+    vcml::u64 cycles;
+    bool wfi;
+
+    vcml::gpio_initiator_socket rst_out;
+    vcml::clk_initiator_socket clk_out;
+    vcml::gpio_initiator_socket irq0;
+
+    idle_processor(const sc_core::sc_module_name& nm):
+        vcml::processor(nm, "idle"),
+        cycles(0),
+        wfi(false),
+        rst_out("rst_out"),
+        clk_out("clk_out"),
+        irq0("irq0") {
+        // nothing to do
+    }
+
+    virtual ~idle_processor() = default;
+
+    virtual vcml::u64 cycle_count() const override { return cycles; }
+
+    virtual void simulate(size_t n) override {
+        if (wfi) {
+            wfi = false;
+            cycles++;
+            enter_idle();
+        } else {
+            cycles += n;
+        }
+    }
+
+    virtual void end_of_elaboration() override {
+        clk_out = DEFCLK;
+        rst_out.pulse();
+    }
+};
+
+TEST(processor, irq_edges) {
+    vcml::generic::memory imem("IMEM", 0x1000);
+    vcml::generic::memory dmem("DMEM", 0x1000);
+
+    idle_processor cpu("EDGES");
+
+    cpu.clk_out.bind(cpu.clk);
+    cpu.rst_out.bind(cpu.rst);
+    cpu.clk_out.bind(imem.clk);
+    cpu.rst_out.bind(imem.rst);
+    cpu.clk_out.bind(dmem.clk);
+    cpu.rst_out.bind(dmem.rst);
+
+    cpu.insn.bind(imem.in);
+    cpu.data.bind(dmem.in);
+    cpu.irq[0].bind(cpu.irq0);
+
+    sc_core::sc_start(sc_core::SC_ZERO_TIME);
+
+    // pending bitmap follows the line and every edge bumps the generation
+    vcml::u64 gen = cpu.irq_generation();
+    EXPECT_FALSE(cpu.irq_pending_any());
+    cpu.irq0 = true;
+    EXPECT_TRUE(cpu.irq_pending(0));
+    EXPECT_FALSE(cpu.irq_pending(1));
+    EXPECT_EQ(cpu.irq_pending_word(0), 1u);
+    EXPECT_EQ(cpu.irq_generation(), gen + 1);
+    cpu.irq0 = false;
+    EXPECT_FALSE(cpu.irq_pending_any());
+    EXPECT_EQ(cpu.irq_generation(), gen + 2);
+
+    const size_t edges = 100000;
+    double start = mwr::timestamp();
+    for (size_t i = 0; i < edges; i++)
+        cpu.irq0 = !cpu.irq0;
+    double delta = mwr::timestamp() - start;
+
+    vcml::irq_stats stats;
+    ASSERT_TRUE(cpu.get_irq_stats(0, stats));
+    EXPECT_EQ(stats.irq, 0);
+    EXPECT_EQ(stats.irq_count, edges / 2 + 1);
+    EXPECT_FALSE(stats.irq_status);
+    EXPECT_FALSE(cpu.get_irq_stats(1, stats));
+    EXPECT_EQ(vcml::get_quantum_stats().num_irqs, edges / 2 + 1);
+
+    std::cout << "irq edge cost: " << delta * 1e9 / edges << "ns" << std::endl;
+}
@@ -0,0 +1,95 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+
+#include "vcml.h"
+
+const vcml::hz_t DEFCLK = 1 * vcml::kHz;
+
+class idle_processor : public vcml::processor
+{
+public:
+    vcml::u64 cycles;
+    bool wfi;
+
+    vcml::gpio_initiator_socket rst_out;
+    vcml::clk_initiator_socket clk_out;
+    vcml::gpio_initiator_socket irq0;
+
+    idle_processor(const sc_core::sc_module_name& nm):
+        vcml::processor(nm, "idle"),
+        cycles(0),
+        wfi(false),
+        rst_out("rst_out"),
+        clk_out("clk_out"),
+        irq0("irq0") {
+        // nothing to do
+    }
+
+    virtual ~idle_processor() = default;
+
+    virtual vcml::u64 cycle_count() const override { return cycles; }
+
+    virtual void simulate(size_t n) override {
+        if (wfi) {
+            wfi = false;
+            cycles++;
+            enter_idle();
+        } else {
+            cycles += n;
+        }
+    }
+
+    virtual void end_of_elaboration() override {
+        clk_out = DEFCLK;
+        rst_out.pulse();
+    }
+};
+
+TEST(processor, parallel) {
+    vcml::generic::memory imem0("IMEM0", 0x1000);
+    vcml::generic::memory dmem0("DMEM0", 0x1000);
+    vcml::generic::memory imem1("IMEM1", 0x1000);
+    vcml::generic::memory dmem1("DMEM1", 0x1000);
+
+    idle_processor cpu0("CPU0");
+    idle_processor cpu1("CPU1");
+
+    cpu0.insn.bind(imem0.in);
+    cpu0.data.bind(dmem0.in);
+    cpu1.insn.bind(imem1.in);
+    cpu1.data.bind(dmem1.in);
+
+    for (auto* mem : { &imem0, &dmem0, &imem1, &dmem1 }) {
+        cpu0.clk_out.bind(mem->clk);
+        cpu0.rst_out.bind(mem->rst);
+    }
+
+    for (idle_processor* cpu : { &cpu0, &cpu1 }) {
+        cpu->clk_out.bind(cpu->clk);
+        cpu->rst_out.bind(cpu->rst);
+        cpu->irq[0].bind(cpu->irq0);
+        cpu->parallel = true;
+        cpu->deterministic = true;
+    }
+
+    sc_core::sc_start(sc_core::SC_ZERO_TIME);
+
+    sc_core::sc_time quantum(1.0, sc_core::SC_SEC);
+    sc_core::sc_time cycle = cpu0.clock_cycle();
+    tlm::tlm_global_quantum::instance().set(quantum);
+
+    sc_core::sc_start(10 * quantum);
+    EXPECT_EQ(cpu0.cycles, 10 * (quantum / cycle));
+    EXPECT_EQ(cpu1.cycles, 10 * (quantum / cycle));
+}
@@ -0,0 +1,97 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+
+#include "vcml.h"
+
+class regs_processor : public vcml::processor
+{
+public:
+    vcml::u64 regs[3];
+    size_t reads;
+    size_t writes;
+
+    regs_processor(const sc_core::sc_module_name& nm):
+        vcml::processor(nm, "regs"), regs(), reads(0), writes(0) {
+        regs[0] = 0x11;
+        regs[1] = 0x22;
+        regs[2] = 0x33;
+
+        define_cpureg_rw(0, "r0", 8);
+        define_cpureg_rw(1, "r1", 8);
+        define_cpureg_r(2, "r2", 8);
+        reads = 0;
+    }
+
+    virtual ~regs_processor() = default;
+
+    virtual vcml::u64 cycle_count() const override { return 0; }
+    virtual void simulate(size_t n) override {}
+
+    virtual bool read_reg_dbg(size_t regno, void* buf, size_t len) override {
+        if (regno >= 3)
+            return false;
+        memcpy(buf, &regs[regno], std::min(len, sizeof(regs[regno])));
+        reads++;
+        return true;
+    }
+
+    virtual bool write_reg_dbg(size_t regno, const void* buf,
+                               size_t len) override {
+        if (regno >= 3)
+            return false;
+        memcpy(&regs[regno], buf, std::min(len, sizeof(regs[regno])));
+        writes++;
+        return true;
+    }
+
+    vcml::property_base* prop(const char* name) {
+        return dynamic_cast<vcml::property_base*>(get_attribute(name));
+    }
+};
+
+TEST(processor, cpuregs) {
+    regs_processor cpu("REGS");
+    ASSERT_NE(cpu.prop("r0"), nullptr);
+    ASSERT_NE(cpu.prop("r1"), nullptr);
+    ASSERT_NE(cpu.prop("r2"), nullptr);
+
+    // suspending does not touch any register until it gets accessed
+    cpu.regs[0] = 0x44;
+    cpu.session_suspend();
+    EXPECT_EQ(cpu.reads, 0u);
+    EXPECT_STREQ(cpu.prop("r0")->str(), "68");
+    EXPECT_STREQ(cpu.prop("r0")->str(), "68");
+    EXPECT_EQ(cpu.reads, 1u);
+
+    // only modified registers are written back upon resume
+    cpu.prop("r1")->str("85");
+    EXPECT_EQ(cpu.reads, 2u);
+    cpu.session_resume();
+    EXPECT_EQ(cpu.writes, 1u);
+    EXPECT_EQ(cpu.regs[1], 85u);
+    EXPECT_EQ(cpu.regs[0], 0x44u);
+
+    // nothing modified, nothing to write back
+    cpu.session_suspend();
+    cpu.session_resume();
+    EXPECT_EQ(cpu.writes, 1u);
+    EXPECT_EQ(cpu.reads, 2u);
+
+    // values are fetched again after the simulation ran
+    cpu.regs[2] = 0x55;
+    cpu.session_suspend();
+    EXPECT_STREQ(cpu.prop("r2")->str(), "85");
+    cpu.session_resume();
+    EXPECT_EQ(cpu.writes, 1u);
+}
@@ -0,0 +1,70 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <testing.h>
+using namespace ::vcml::debugging;
+
+class test_target : public module, public target
+{
+public:
+    symbol fn_main;
+    symbol fn_work;
+    vector<stackframe> frames;
+
+    test_target(const sc_module_name& nm):
+        module(nm),
+        target(),
+        fn_main("main", SYMKIND_FUNCTION, ENDIAN_LITTLE, 0x100, 0x1000, 0),
+        fn_work("work", SYMKIND_FUNCTION, ENDIAN_LITTLE, 0x100, 0x2000, 0),
+        frames() {}
+
+    virtual void stacktrace(vector<stackframe>& trace,
+                            size_t limit) override {
+        trace.assign(frames.begin(), frames.end());
+        if (trace.size() > limit)
+            trace.resize(limit);
+    }
+};
+
+TEST(profiler, sample) {
+    test_target tgt("target");
+    profiler prof(tgt);
+
+    tgt.frames = { { 0x2010, 0, &tgt.fn_work }, { 0x1010, 0, &tgt.fn_main } };
+    prof.sample(3);
+
+    tgt.frames = { { 0x1020, 0, &tgt.fn_main } };
+    prof.sample();
+
+    tgt.frames = { { 0x9000, 0, nullptr } };
+    prof.sample(0);
+    prof.sample();
+
+    EXPECT_EQ(prof.samples(), 5);
+
+    vector<profile_entry> flat = prof.flat_profile();
+    ASSERT_EQ(flat.size(), 3);
+    EXPECT_EQ(flat[0].function, "work");
+    EXPECT_EQ(flat[0].self, 3);
+    EXPECT_EQ(flat[0].total, 3);
+    EXPECT_EQ(flat[1].function, "main");
+    EXPECT_EQ(flat[1].self, 1);
+    EXPECT_EQ(flat[1].total, 4);
+    EXPECT_EQ(flat[2].function, "[unknown]");
+    EXPECT_EQ(flat[2].self, 1);
+
+    stringstream ss;
+    prof.write_folded(ss);
+    EXPECT_EQ(ss.str(), "[unknown] 1\nmain 1\nmain;work 3\n");
+
+    prof.reset();
+    EXPECT_EQ(prof.samples(), 0);
+    EXPECT_TRUE(prof.flat_profile().empty());
+}
@@ -205,3 +205,53 @@ TEST(property, init) {
     EXPECT_EQ(vcml::broker::get_or_default<int>("test.prop_u32"), 12345678);
     EXPECT_EQ(vcml::broker::get_or_default<int>("test.prop_u33"), 0);
 }
+
+struct parse_counter {
+    int val;
+    static size_t parsed;
+};
+
+size_t parse_counter::parsed = 0;
+
+std::istream& operator>>(std::istream& is, parse_counter& pc) {
+    parse_counter::parsed++;
+    return is >> pc.val;
+}
+
+std::ostream& operator<<(std::ostream& os, const parse_counter& pc) {
+    return os << pc.val;
+}
+
+class parse_component : public vcml::component
+{
+public:
+    vcml::property<parse_counter, 2> counted;
+    vcml::property<std::vector<parse_counter>> listed;
+
+    parse_component(const sc_core::sc_module_name& nm):
+        vcml::component(nm), counted("counted"), listed("listed") {}
+    virtual ~parse_component() = default;
+};
+
+TEST(property, parse_once) {
+    vcml::broker broker("parse");
+    broker.define("*.counted", "4 5");
+    broker.define("*.listed", "6 7 8");
+
+    // values shared via the same broker key only get parsed once
+    parse_component a("a");
+    parse_component b("b");
+    EXPECT_EQ(parse_counter::parsed, 5u);
+    EXPECT_EQ(a.counted[1].val, 5);
+    EXPECT_EQ(b.counted[0].val, 4);
+    EXPECT_EQ(b.listed.count(), 3u);
+    EXPECT_EQ(a.listed[2].val, 8);
+
+    // redefining a key drops its parsed value
+    broker.define("*.counted", "9 10");
+    a.counted.reset();
+    b.counted.reset();
+    EXPECT_EQ(parse_counter::parsed, 7u);
+    EXPECT_EQ(a.counted[0].val, 9);
+    EXPECT_EQ(b.counted[1].val, 10);
+}
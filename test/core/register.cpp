@@ -183,6 +183,30 @@ TEST(registers, write_byte_enable) {
     EXPECT_TRUE(tx.is_response_ok());
 }
 
+TEST(registers, write_streaming) {
+    mock_peripheral mock;
+    sc_core::sc_time cycle(1.0 / mock.clk, sc_core::SC_SEC);
+    sc_core::sc_time& local = mock.local_time();
+    tlm::tlm_generic_payload tx;
+
+    u32 buffer[] = { 0x11111111, 0x22222222, 0x33333333 };
+
+    local = sc_core::SC_ZERO_TIME;
+    tx_setup(tx, tlm::TLM_WRITE_COMMAND, 4, buffer, sizeof(buffer));
+    tx.set_streaming_width(sizeof(u32));
+
+    // fixed-address burst into a fifo register, one callback per beat
+    Sequence s;
+    EXPECT_CALL(mock, reg_write(0x11111111)).InSequence(s);
+    EXPECT_CALL(mock, reg_write(0x22222222)).InSequence(s);
+    EXPECT_CALL(mock, reg_write(0x33333333)).InSequence(s);
+    EXPECT_EQ(mock.test_transport(tx), sizeof(buffer));
+    EXPECT_EQ(tx.get_data_length(), sizeof(buffer));
+    EXPECT_EQ(tx.get_streaming_width(), sizeof(u32));
+    EXPECT_EQ(local, cycle * mock.write_latency * 3);
+    EXPECT_TRUE(tx.is_response_ok());
+}
+
 TEST(registers, permissions) {
     mock_peripheral mock;
 
@@ -366,6 +390,29 @@ TEST(registers, banking) {
     tx.clear_extension(&bank);
 }
 
+TEST(registers, bank_storage) {
+    mock_peripheral mock;
+    mock.test_reg_a.set_banked();
+
+    // banks read their initial value until they are written
+    const auto& creg = mock.test_reg_a;
+    EXPECT_EQ(creg.bank(3), 0xffffffffu);
+
+    mock.test_reg_a.bank(1) = 1;
+    mock.test_reg_a.bank(-1) = 2;
+    mock.test_reg_a.bank(40) = 3;
+    EXPECT_EQ(mock.test_reg_a.bank(0), 0xffffffffu);
+    EXPECT_EQ(mock.test_reg_a.bank(1), 1u);
+    EXPECT_EQ(mock.test_reg_a.bank(-1), 2u);
+    EXPECT_EQ(mock.test_reg_a.bank(40), 3u);
+    EXPECT_EQ(mock.test_reg_a.bank(39), 0xffffffffu);
+
+    mock.test_reg_a.reset();
+    EXPECT_EQ(mock.test_reg_a.bank(1), 0xffffffffu);
+    EXPECT_EQ(mock.test_reg_a.bank(-1), 0xffffffffu);
+    EXPECT_EQ(mock.test_reg_a.bank(40), 0xffffffffu);
+}
+
 TEST(registers, endianess) {
     mock_peripheral mock;
     mock.set_big_endian();
@@ -632,6 +679,65 @@ TEST(registers, masking) {
     EXPECT_EQ(mock.array_reg[3], 8);
 }
 
+class static_callback_test : public peripheral
+{
+public:
+    reg<u32> test_reg;
+    reg<u32, 4> array_reg;
+
+    u32 last_written;
+    size_t last_index;
+
+    u32 read_test_reg() { return 0x1234; }
+    void write_test_reg(u32 val) { last_written = val; }
+
+    u32 read_array_reg(size_t idx) { return (u32)idx * 2; }
+    void write_array_reg(u32 val, size_t idx) {
+        last_written = val;
+        last_index = idx;
+    }
+
+    static_callback_test(const sc_module_name& nm):
+        peripheral(nm),
+        test_reg("test_reg", 0x0),
+        array_reg("array_reg", 0x10),
+        last_written(),
+        last_index() {
+        test_reg.on_read<&static_callback_test::read_test_reg>();
+        test_reg.on_write<&static_callback_test::write_test_reg>();
+        array_reg.on_read<&static_callback_test::read_array_reg>();
+        array_reg.on_write<&static_callback_test::write_array_reg>();
+        clk.stub(100 * MHz);
+        rst.stub();
+    }
+};
+
+TEST(registers, static_callbacks) {
+    static_callback_test mock("static_callbacks");
+
+    u32 data = 0;
+    tlm_generic_payload tx;
+
+    tx_setup(tx, TLM_READ_COMMAND, 0, &data, sizeof(data));
+    EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 4);
+    EXPECT_EQ(data, 0x1234u);
+
+    data = 0xabcd;
+    tx_setup(tx, TLM_WRITE_COMMAND, 0, &data, sizeof(data));
+    EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 4);
+    EXPECT_EQ(mock.last_written, 0xabcdu);
+
+    tx_setup(tx, TLM_READ_COMMAND, 0x18, &data, sizeof(data));
+    EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 4);
+    EXPECT_EQ(data, 4u);
+
+    data = 0x55;
+    tx_setup(tx, TLM_WRITE_COMMAND, 0x1c, &data, sizeof(data));
+    EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 4);
+    EXPECT_EQ(mock.last_written, 0x55u);
+    EXPECT_EQ(mock.last_index, 3);
+}
+
 class test_peripheral_sockets : public peripheral
 {
 public:
@@ -703,3 +809,38 @@ TEST(registers, peripheral_cmd_mmap) {
     mock.execute("mmap", { "111" }, std::cout);
     std::cout << std::endl;
 }
+
+TEST(registers, stats) {
+    mock_peripheral mock;
+    tlm::tlm_generic_payload tx;
+    unsigned char buffer[4] = {};
+
+    // disabled by default
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 0, buffer, sizeof(buffer));
+    EXPECT_EQ(mock.test_transport(tx), 4);
+    EXPECT_EQ(mock.test_reg_a.stats().num_reads, 0);
+    EXPECT_FALSE(mock.execute("regstats", std::cout));
+    std::cout << std::endl;
+
+    mock.register_stats = true;
+    for (int i = 0; i < 3; i++) {
+        tx_setup(tx, tlm::TLM_READ_COMMAND, 0, buffer, sizeof(buffer));
+        EXPECT_EQ(mock.test_transport(tx), 4);
+    }
+
+    tx_setup(tx, tlm::TLM_WRITE_COMMAND, 0, buffer, sizeof(buffer));
+    EXPECT_EQ(mock.test_transport(tx), 4);
+
+    EXPECT_EQ(mock.test_reg_a.stats().num_reads, 3);
+    EXPECT_EQ(mock.test_reg_a.stats().num_writes, 1);
+    EXPECT_EQ(mock.test_reg_b.stats().num_accesses(), 0);
+
+    stringstream ss;
+    EXPECT_TRUE(mock.execute("regstats", { "1" }, ss));
+    std::cout << ss.str() << std::endl;
+    EXPECT_NE(ss.str().find("test_reg_a"), string::npos);
+    EXPECT_EQ(ss.str().find("test_reg_b"), string::npos);
+
+    mock.test_reg_a.reset_stats();
+    EXPECT_EQ(mock.test_reg_a.stats().num_accesses(), 0);
+}
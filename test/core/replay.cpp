@@ -0,0 +1,67 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+static const string REPLAY_FILE = "/tmp/vcml-test-replay.bin";
+
+class replay_harness : public test_base
+{
+public:
+    replay_channel chan;
+    replay_channel other;
+    vector<string> inputs;
+
+    replay_harness(const sc_module_name& nm):
+        test_base(nm), chan("test.chan"), other("test.other"), inputs() {
+        EXPECT_TRUE(chan.is_replaying());
+        EXPECT_FALSE(chan.is_recording());
+
+        chan.replay([&](const u8* data, size_t size) -> void {
+            EXPECT_EQ(sc_time_stamp(), SC_ZERO_TIME);
+            inputs.emplace_back((const char*)data, size);
+        });
+
+        other.replay([&](const u8* data, size_t size) -> void {
+            ADD_FAILURE() << "unexpected input on " << other.name();
+        });
+    }
+
+    virtual void run_test() override {
+        wait(1, SC_MS);
+        EXPECT_EQ(inputs, vector<string>({ "abc", "de" }));
+    }
+};
+
+TEST(replay, roundtrip) {
+    replay_record(REPLAY_FILE);
+    EXPECT_TRUE(replay_recording());
+
+    {
+        replay_channel chan("test.chan");
+        replay_channel other("test.other");
+        EXPECT_TRUE(chan.is_recording());
+        EXPECT_FALSE(chan.is_replaying());
+        chan.record("abc", 3);
+        chan.record("de", 2);
+    }
+
+    replay_close();
+    EXPECT_FALSE(replay_recording());
+
+    replay_open(REPLAY_FILE);
+    EXPECT_TRUE(replay_replaying());
+
+    replay_harness test("replay");
+    sc_core::sc_start();
+
+    replay_close();
+    std::remove(REPLAY_FILE.c_str());
+}
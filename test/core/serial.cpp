@@ -47,6 +47,30 @@ TEST(serial, success) {
     EXPECT_FALSE(failed(tx));
 }
 
+TEST(serial, fifo) {
+    serial_fifo fifo(4);
+    EXPECT_TRUE(fifo.empty());
+    EXPECT_EQ(fifo.capacity(), 4u);
+
+    const u8 data[] = { 1, 2, 3, 4, 5, 6 };
+    EXPECT_EQ(fifo.push(data, 3), 3u);
+    EXPECT_EQ(fifo.pop(), 1);
+    EXPECT_EQ(fifo.push(data + 3, 3), 2u);
+    EXPECT_TRUE(fifo.full());
+    EXPECT_FALSE(fifo.push(0xff));
+
+    for (u16 val : { 2, 3, 4, 5 })
+        EXPECT_EQ(fifo.pop(), val);
+    EXPECT_TRUE(fifo.empty());
+    EXPECT_EQ(fifo.pop(), 0);
+
+    EXPECT_TRUE(fifo.push(0x1ff));
+    EXPECT_EQ(fifo.front(), 0x1ff);
+    fifo.resize(8);
+    EXPECT_TRUE(fifo.empty());
+    EXPECT_EQ(fifo.space(), 8u);
+}
+
 MATCHER_P(serial_match_socket, socket, "Matches a serial socket") {
     return &arg == socket;
 }
@@ -86,6 +86,16 @@ public:
 
         EXPECT_EQ(count1, 10);
         EXPECT_EQ(count2, 10);
+
+        // hosts without a bulk handler receive bursts byte by byte
+        u8 mosi[4] = { 1, 2, 3, 4 };
+        u8 miso[4] = {};
+        spi_out.transport(mosi, miso, sizeof(mosi));
+        for (size_t i = 0; i < sizeof(miso); i++)
+            EXPECT_EQ(miso[i], 2 * mosi[i]);
+
+        EXPECT_EQ(count1, 14);
+        EXPECT_EQ(count2, 14);
     }
 };
 
@@ -210,3 +210,55 @@ TEST(symtab, find_with_offset) {
         }
     }
 }
+
+TEST(symtab, shared_elf) {
+    symtab a, b;
+    u64 na = a.load_elf(get_resource_path("elf.elf"));
+    u64 nb = b.load_elf(get_resource_path("elf.elf"));
+
+    EXPECT_EQ(na, nb);
+    EXPECT_EQ(a.count(), b.count());
+    ASSERT_FALSE(a.empty());
+
+    EXPECT_TRUE(std::is_sorted(a.functions().begin(), a.functions().end(),
+                               symtab::symbol_compare()));
+    EXPECT_TRUE(std::is_sorted(a.objects().begin(), a.objects().end(),
+                               symtab::symbol_compare()));
+
+    const symbol* func = b.find_function("func_c");
+    ASSERT_NE(func, nullptr);
+    EXPECT_EQ(b.find_function(func->virt_addr()), func);
+
+    // modifying one table must neither affect the other nor leave stale
+    // entries in its name index
+    symbol removed = *func;
+    b.remove(removed);
+    EXPECT_EQ(b.find_function("func_c"), nullptr);
+    EXPECT_NE(a.find_function("func_c"), nullptr);
+
+    symbol added("added", SYMKIND_FUNCTION, ENDIAN_LITTLE, 4, ~0ull - 8, 0);
+    b.insert(added);
+    ASSERT_NE(b.find_function("added"), nullptr);
+    EXPECT_EQ(b.find_function(~0ull - 8)->virt_addr(), added.virt_addr());
+}
+
+TEST(symtab, prefetch_elf) {
+    string path = get_resource_path("elf.elf");
+    symtab::prefetch_elf(path);
+    symtab::prefetch_elf(path); // served from the pending parse
+
+    symtab a, b;
+    EXPECT_GT(a.load_elf(path), 0u);
+    EXPECT_GT(b.load_elf(path), 0u);
+
+    // tables loaded from the same file share their symbol storage
+    EXPECT_EQ(&a.functions(), &b.functions());
+    EXPECT_EQ(&a.objects(), &b.objects());
+
+    symbol added("added", SYMKIND_OBJECT, ENDIAN_LITTLE, 4, ~0ull - 8, 0);
+    b.insert(added);
+    EXPECT_EQ(&a.functions(), &b.functions());
+    EXPECT_NE(&a.objects(), &b.objects());
+    EXPECT_EQ(a.find_object("added"), nullptr);
+    EXPECT_NE(b.find_object("added"), nullptr);
+}
@@ -80,4 +80,25 @@ TEST(systemc, callback) {
 
     sc_core::sc_start(10, SC_SEC);
     EXPECT_TRUE(update_called);
+
+    vector<int> order;
+    update_queue_stats before = get_update_queue_stats();
+    std::thread producer([&]() -> void {
+        for (int i = 0; i < 100; i++)
+            on_next_update([&order, i]() -> void { order.push_back(i); });
+    });
+
+    producer.join();
+    EXPECT_EQ(get_update_queue_stats().depth, 100);
+
+    sc_core::sc_start(10, SC_SEC);
+    ASSERT_EQ(order.size(), 100);
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(order[i], i) << "update jobs executed out of order";
+
+    update_queue_stats after = get_update_queue_stats();
+    EXPECT_EQ(after.depth, 0);
+    EXPECT_EQ(after.num_jobs - before.num_jobs, 100);
+    EXPECT_EQ(after.num_batches - before.num_batches, 1);
+    EXPECT_GE(after.max_depth, 100);
 }
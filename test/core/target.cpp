@@ -0,0 +1,113 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <testing.h>
+using namespace ::vcml::debugging;
+
+class test_target : public module, public target
+{
+public:
+    test_target(const sc_module_name& nm): module(nm), target() {}
+
+    virtual bool insert_breakpoint(u64 addr) override { return true; }
+    virtual bool remove_breakpoint(u64 addr) override { return true; }
+
+    virtual bool insert_watchpoint(const range& mem, vcml_access a) override {
+        return true;
+    }
+
+    virtual bool remove_watchpoint(const range& mem, vcml_access a) override {
+        return true;
+    }
+
+    using target::insert_breakpoint;
+    using target::remove_breakpoint;
+    using target::insert_watchpoint;
+    using target::remove_watchpoint;
+    using target::notify_breakpoint_hit;
+    using target::notify_watchpoint_read;
+    using target::notify_watchpoint_write;
+};
+
+class test_subscriber : public subscriber
+{
+public:
+    size_t breakpoints = 0;
+    size_t reads = 0;
+    size_t writes = 0;
+
+    virtual void notify_breakpoint_hit(const breakpoint& bp) override {
+        breakpoints++;
+    }
+
+    virtual void notify_watchpoint_read(const watchpoint& wp,
+                                        const range& addr) override {
+        reads++;
+    }
+
+    virtual void notify_watchpoint_write(const watchpoint& wp,
+                                         const range& addr,
+                                         u64 newval) override {
+        writes++;
+    }
+};
+
+TEST(target, breakpoints) {
+    test_target tgt("target");
+    test_subscriber subscr;
+
+    EXPECT_FALSE(tgt.is_breakpoint(0x1000));
+    const breakpoint* bp = tgt.insert_breakpoint(0x1000, &subscr);
+    ASSERT_NE(bp, nullptr);
+    EXPECT_TRUE(tgt.is_breakpoint(0x1000));
+    EXPECT_FALSE(tgt.is_breakpoint(0x1004));
+    EXPECT_EQ(tgt.lookup_breakpoint(0x1000), bp);
+    EXPECT_EQ(tgt.insert_breakpoint(0x1000, &subscr), bp);
+
+    tgt.notify_breakpoint_hit(0x1004);
+    EXPECT_EQ(subscr.breakpoints, 0);
+    tgt.notify_breakpoint_hit(0x1000);
+    EXPECT_EQ(subscr.breakpoints, 1);
+
+    EXPECT_TRUE(tgt.remove_breakpoint(0x1000, &subscr));
+    EXPECT_FALSE(tgt.is_breakpoint(0x1000));
+    EXPECT_EQ(tgt.lookup_breakpoint(0x1000), nullptr);
+    EXPECT_TRUE(tgt.breakpoints().empty());
+}
+
+TEST(target, watchpoints) {
+    test_target tgt("target");
+    test_subscriber subscr;
+
+    const range mem(0x1ffc, 0x2003); // spans two pages
+    EXPECT_FALSE(tgt.is_watched(mem));
+    ASSERT_TRUE(tgt.insert_watchpoint(mem, VCML_ACCESS_READ_WRITE, &subscr));
+
+    EXPECT_TRUE(tgt.is_watched(0x1000));
+    EXPECT_TRUE(tgt.is_watched(0x2fff));
+    EXPECT_FALSE(tgt.is_watched(0x3000));
+    EXPECT_FALSE(tgt.is_watched(range(0x3000, 0x3fff)));
+    EXPECT_TRUE(tgt.is_watched(range(0x0000, 0x1000)));
+
+    tgt.notify_watchpoint_read(range(0x1000, 0x1003));
+    tgt.notify_watchpoint_write(range(0x3000, 0x3003), 0);
+    EXPECT_EQ(subscr.reads, 0);
+    EXPECT_EQ(subscr.writes, 0);
+
+    tgt.notify_watchpoint_read(range(0x2000, 0x2003));
+    tgt.notify_watchpoint_write(range(0x1ffc, 0x1fff), 0);
+    EXPECT_EQ(subscr.reads, 1);
+    EXPECT_EQ(subscr.writes, 1);
+
+    EXPECT_TRUE(tgt.remove_watchpoint(mem, VCML_ACCESS_READ_WRITE, &subscr));
+    EXPECT_FALSE(tgt.is_watched(0x1000));
+    EXPECT_FALSE(tgt.is_watched(0x2000));
+    EXPECT_TRUE(tgt.watchpoints().empty());
+}
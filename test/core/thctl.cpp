@@ -13,52 +13,49 @@
 class thctl_test : public test_base
 {
 public:
-    atomic<int> crit_count;
-    bool crit1_done;
-    bool crit2_done;
-
-    thctl_test(const sc_module_name& nm = sc_gen_unique_name("test")):
-        test_base(nm), crit_count(), crit1_done(false), crit2_done(false) {}
+    thctl_test(const sc_module_name& nm): test_base(nm) {}
 
     virtual void run_test() override {
-        std::thread t1([&]() -> void {
-            ASSERT_FALSE(thctl_is_sysc_thread());
-            thctl_guard lock;
-            crit_count++;
-            mwr::usleep(1000);
-            crit1_done = true;
-            EXPECT_EQ(crit_count, 1);
-            crit_count--;
-        });
-
-        std::thread t2([&]() -> void {
-            ASSERT_FALSE(thctl_is_sysc_thread());
-            thctl_guard lock;
-            crit_count++;
-            mwr::usleep(1000);
-            crit2_done = true;
-            EXPECT_EQ(crit_count, 1);
-            crit_count--;
+        atomic<bool> done(false);
+        size_t jobs = 0;
+
+        std::thread worker([&]() -> void {
+            EXPECT_FALSE(thctl_is_sysc_thread());
+
+            for (int i = 0; i < 10; i++) {
+                thctl_guard guard;
+                EXPECT_TRUE(thctl_is_in_critical());
+                jobs++;
+            }
+
+            thctl_batch batch;
+            for (int i = 0; i < 10; i++)
+                batch.add([&]() -> void {
+                    EXPECT_TRUE(thctl_is_in_critical());
+                    jobs++;
+                });
+
+            EXPECT_EQ(batch.size(), 10);
+            batch.commit();
+            EXPECT_TRUE(batch.empty());
+
+            const thctl_stats& stats = thctl_get_stats();
+            EXPECT_EQ(stats.num_entries, 11);
+            EXPECT_LE(stats.num_parked, stats.num_entries);
+            EXPECT_GE(stats.wait_time, 0.0);
+            done = true;
         });
 
-        ASSERT_TRUE(thctl_is_sysc_thread());
-        EXPECT_FALSE(crit1_done);
-        EXPECT_FALSE(crit2_done);
-        EXPECT_EQ(crit_count, 0);
-
-        while (!crit1_done || !crit2_done)
-            wait(SC_ZERO_TIME);
-
-        EXPECT_TRUE(crit1_done);
-        EXPECT_TRUE(crit2_done);
-        EXPECT_EQ(crit_count, 0);
+        while (!done)
+            wait(1, SC_MS);
 
-        t1.join();
-        t2.join();
+        worker.join();
+        EXPECT_EQ(jobs, 20);
+        EXPECT_EQ(thctl_get_stats().num_entries, 0);
     }
 };
 
 TEST(thctl, critical) {
-    thctl_test test;
+    thctl_test test("test");
     sc_core::sc_start();
 }
@@ -80,3 +80,59 @@ TEST(tlm, base_sockets) {
     tlm_harness test("tlm");
     sc_core::sc_start();
 }
+
+class tlm_order_harness : public test_base
+{
+public:
+    tlm_initiator_socket out;
+    tlm_target_socket in;
+
+    size_t active;
+    vector<u64> order;
+
+    tlm_order_harness(const sc_module_name& nm):
+        test_base(nm), out("out"), in("in"), active(0), order() {
+        out.bind(in);
+        SC_HAS_PROCESS(tlm_order_harness);
+        SC_THREAD(second);
+    }
+
+    virtual unsigned int transport(tlm_target_socket& socket,
+                                   tlm_generic_payload& tx,
+                                   const tlm_sbi& sideband) override {
+        EXPECT_EQ(active++, 0u) << "transactions overlap";
+        wait(10, SC_NS);
+        order.push_back(tx.get_address());
+        active--;
+
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    void access(u64 addr) {
+        u32 data = 0;
+        sc_time t = SC_ZERO_TIME;
+        tlm_generic_payload tx;
+        tx_setup(tx, TLM_READ_COMMAND, addr, &data, sizeof(data));
+        out.b_transport(tx, t);
+        EXPECT_TRUE(tx.is_response_ok());
+    }
+
+    void second() {
+        wait(1, SC_NS);
+        access(2);
+    }
+
+    virtual void run_test() override {
+        // the second access arrives while the first one is still pending
+        access(1);
+        wait(20, SC_NS);
+        EXPECT_EQ(order, vector<u64>({ 1, 2 }));
+        EXPECT_EQ(in.stats().num_transactions, 2u);
+    }
+};
+
+TEST(tlm, serialized) {
+    tlm_order_harness test("order");
+    sc_core::sc_start();
+}
@@ -0,0 +1,92 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class tlm_stats_harness : public test_base
+{
+public:
+    u8 mem[256];
+
+    tlm_initiator_socket out;
+    tlm_target_socket in;
+
+    tlm_stats_harness(const sc_module_name& nm):
+        test_base(nm), mem(), out("out"), in("in") {
+        out.bind(in);
+        in.map_dmi(mem, 0, sizeof(mem) - 1, VCML_ACCESS_READ_WRITE);
+    }
+
+    virtual unsigned int transport(tlm_target_socket& socket,
+                                   tlm_generic_payload& tx,
+                                   const tlm_sbi& sideband) override {
+        if (tx.get_address() >= sizeof(mem)) {
+            tx.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
+            return 0;
+        }
+
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    virtual void run_test() override {
+        u32 data = 0;
+
+        // first access goes through b_transport and fetches dmi
+        EXPECT_OK(out.writew<u32>(0x10, 0x1234));
+        EXPECT_EQ(out.stats().num_transactions, 1);
+        EXPECT_EQ(out.stats().num_bytes, 4);
+        EXPECT_EQ(out.stats().num_dmi, 0);
+        EXPECT_EQ(in.stats().num_transactions, 1);
+        EXPECT_EQ(in.stats().num_bytes, 4);
+        EXPECT_EQ(in.stats().num_dmi, 1);
+
+        // second access is served via dmi
+        EXPECT_OK(out.readw<u32>(0x10, data));
+        EXPECT_EQ(out.stats().num_transactions, 1);
+        EXPECT_EQ(out.stats().num_bytes, 8);
+        EXPECT_EQ(out.stats().num_dmi, 1);
+        EXPECT_EQ(in.stats().num_transactions, 1);
+
+        // debug accesses do not count towards bytes
+        EXPECT_OK(out.readw<u32>(0x20, data, SBI_DEBUG));
+        EXPECT_EQ(out.stats().num_debug, 1);
+        EXPECT_EQ(in.stats().num_debug, 0);
+        EXPECT_OK(out.readw<u32>(0x20, data, SBI_DEBUG | SBI_NODMI));
+        EXPECT_EQ(out.stats().num_debug, 2);
+        EXPECT_EQ(out.stats().num_bytes, 8);
+        EXPECT_EQ(in.stats().num_debug, 1);
+
+        EXPECT_AE(out.writew<u32>(0x200, 0));
+        EXPECT_EQ(out.stats().num_transactions, 2);
+        EXPECT_EQ(out.stats().num_errors, 1);
+        EXPECT_EQ(out.stats().num_bytes, 8);
+        EXPECT_EQ(in.stats().num_transactions, 2);
+        EXPECT_EQ(in.stats().num_errors, 1);
+        EXPECT_EQ(in.stats().num_bytes, 4);
+
+        stringstream ss;
+        EXPECT_TRUE(execute("tlm_stats", ss));
+        EXPECT_TRUE(starts_with(ss.str(), "socket,kind,transactions,"));
+        EXPECT_NE(ss.str().find("stats.out,tlm_initiator_socket,2,8,1,2,1"),
+                  string::npos);
+        EXPECT_NE(ss.str().find("stats.in,tlm_target_socket,2,4,1,1,1"),
+                  string::npos);
+
+        tlm_reset_stats(this);
+        EXPECT_EQ(out.stats().num_transactions, 0);
+        EXPECT_EQ(in.stats().num_transactions, 0);
+    }
+};
+
+TEST(tlm, stats) {
+    tlm_stats_harness test("stats");
+    sc_core::sc_start();
+}
@@ -98,6 +98,38 @@ public:
 
         EXPECT_CALL(mock, trace(match_trace_error(true))).Times(1);
         EXPECT_AE(out.writew(0, data)) << "did not get an address error";
+
+        out.trace_all = true;
+        out.trace_errors = false;
+        out.trace_ranges.str("0x1000..0x1fff");
+
+        EXPECT_CALL(mock, trace(_)).Times(0);
+        EXPECT_OK(out.writew(addr, data)) << "failed to send transaction";
+
+        addr = 0x1000;
+        EXPECT_CALL(mock, trace(match_trace(TRACE_FW, addr, data)));
+        EXPECT_CALL(mock, trace(match_trace(TRACE_BW, addr, data)));
+        EXPECT_OK(out.writew(addr, data)) << "failed to send transaction";
+
+        out.trace_ranges.set(vector<range>());
+        out.trace_writes = false;
+
+        EXPECT_CALL(mock, trace(_)).Times(0);
+        EXPECT_OK(out.writew(addr, data)) << "failed to send transaction";
+
+        out.trace_writes = true;
+        out.trace_ratio = 2;
+
+        EXPECT_CALL(mock, trace(match_trace(TRACE_FW, addr, data)));
+        EXPECT_CALL(mock, trace(match_trace(TRACE_BW, addr, data)));
+        EXPECT_OK(out.writew(addr, data)) << "failed to send transaction";
+        EXPECT_OK(out.writew(addr, data)) << "failed to send transaction";
+
+        out.trace_ratio = 1;
+        out.trace_responses.str("address_error");
+
+        EXPECT_CALL(mock, trace(match_trace(TRACE_FW, addr, data)));
+        EXPECT_OK(out.writew(addr, data)) << "failed to send transaction";
     }
 };
 
@@ -110,6 +142,67 @@ TEST(tracing, basic) {
             << protocol_name((protocol_kind)i);
     }
 
+    const string txtfile = "/tmp/vcml-test-trace.txt";
+    const string binfile = "/tmp/vcml-test-trace.bin";
+    auto text = std::make_unique<tracer_file>(txtfile);
+    auto binary = std::make_unique<tracer_bin>(binfile, 4 * KiB);
+
+    const string jsonfile = "/tmp/vcml-test-trace.json";
+    auto chrome = std::make_unique<tracer_chrome>(jsonfile);
+
+    const string vcdfile = "/tmp/vcml-test-trace.vcd";
+    auto vcd = std::make_unique<tracer_vcd>(vcdfile, true);
+
+    auto buffered = std::make_unique<tracer_term>(true, false, true);
+    EXPECT_TRUE(buffered->is_buffered());
+
+    CaptureStderr();
     test_harness test("harness");
     sc_core::sc_start();
+
+    // buffered output must be complete once the tracer is gone
+    buffered.reset();
+    string output = GetCapturedStderr();
+    size_t nlines = 0;
+    for (const string& line : split(output, '\n'))
+        nlines += starts_with(line, "[TLM") ? 1 : 0;
+    EXPECT_EQ(nlines, 8u);
+
+    // binary traces must decode to the same output as text traces
+    text.reset();
+    binary.reset();
+
+    std::ifstream txt(txtfile);
+    stringstream expected, decoded;
+    expected << txt.rdbuf();
+    EXPECT_EQ(tracer_bin::decode(binfile, decoded), 8);
+    EXPECT_EQ(decoded.str(), expected.str());
+
+    remove(txtfile.c_str());
+    remove(binfile.c_str());
+
+    chrome.reset();
+    std::ifstream json(jsonfile);
+    stringstream events;
+    events << json.rdbuf();
+    EXPECT_TRUE(starts_with(events.str(), "[\n"));
+    EXPECT_TRUE(ends_with(events.str(), "\n]\n"));
+    EXPECT_NE(events.str().find("\"name\":\"thread_name\""), string::npos);
+    EXPECT_NE(events.str().find("\"ph\":\"B\""), string::npos);
+    EXPECT_NE(events.str().find("\"ph\":\"E\""), string::npos);
+    EXPECT_NE(events.str().find("\"error\":true"), string::npos);
+    remove(jsonfile.c_str());
+
+    EXPECT_EQ(vcd->num_signals(), 2u);
+    vcd.reset();
+    std::ifstream vcdstream(vcdfile);
+    stringstream waves;
+    waves << vcdstream.rdbuf();
+    EXPECT_NE(waves.str().find("$scope module out $end"), string::npos);
+    EXPECT_NE(waves.str().find("$var wire 2 ! cmd $end"), string::npos);
+    EXPECT_NE(waves.str().find("$var wire 64 \" addr $end"), string::npos);
+    EXPECT_NE(waves.str().find("$enddefinitions $end"), string::npos);
+    EXPECT_NE(waves.str().find("b10 !"), string::npos);
+    EXPECT_NE(waves.str().find("b1000000000000 \""), string::npos);
+    remove(vcdfile.c_str());
 }
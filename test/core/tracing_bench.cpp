@@ -0,0 +1,88 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+// test_base always instantiates a terminal tracer, so this harness sets
+// up its own clock and reset to measure sockets without any tracer active
+class bench_harness : public component
+{
+public:
+    generic::reset reset;
+    generic::clock clock;
+
+    tlm_initiator_socket out;
+    tlm_target_socket in;
+
+    bench_harness(const sc_module_name& nm):
+        component(nm),
+        reset("reset"),
+        clock("clock", 100 * MHz),
+        out("out"),
+        in("in") {
+        reset.rst.bind(rst);
+        clock.clk.bind(clk);
+        out.bind(in);
+        out.allow_dmi = false;
+        in.allow_dmi = false;
+        SC_HAS_PROCESS(bench_harness);
+        SC_THREAD(run);
+    }
+
+    virtual unsigned int transport(tlm_generic_payload& tx,
+                                   const tlm_sbi& info,
+                                   address_space as) override {
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    double benchmark(bool trace) {
+        const size_t count = 100000;
+        out.trace_all = trace;
+        in.trace_all = trace;
+
+        u32 data = 0;
+        double t0 = mwr::timestamp();
+        for (size_t i = 0; i < count; i++)
+            EXPECT_OK(out.writew(i * 4, data));
+        double t1 = mwr::timestamp();
+        return (t1 - t0) * 1e9 / count;
+    }
+
+    void run() {
+        wait(SC_ZERO_TIME);
+        run_test();
+        sc_stop();
+    }
+
+    void run_test() {
+        // without any tracer, sockets with tracing enabled must not be
+        // slower than those without, both take the same single branch
+        ASSERT_FALSE(tracer::any());
+        double untraced = benchmark(false);
+        double traced = benchmark(true);
+
+        std::cout << "trace off: " << untraced << "ns per transaction"
+                  << std::endl
+                  << "trace on:  " << traced << "ns per transaction"
+                  << std::endl;
+
+        tracer_file tr("/dev/null");
+        EXPECT_TRUE(tracer::any());
+        double recorded = benchmark(true);
+        std::cout << "recorded:  " << recorded << "ns per transaction"
+                  << std::endl;
+    }
+};
+
+TEST(tracing, benchmark) {
+    bench_harness test("harness");
+    sc_core::sc_start();
+}
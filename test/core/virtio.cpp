@@ -39,6 +39,175 @@ TEST(virtio, msgcopy) {
     free(s3);
 }
 
+TEST(virtio, msgmap) {
+    char s1[] = "abc";
+    char s2[] = "def";
+    char s3[] = "ghij";
+
+    vq_message msg;
+    msg.dmi = [](u64 addr, u32 size, vcml_access a) -> u8* {
+        return (u8*)addr; // guest addr == host addr for this test
+    };
+
+    msg.append((uintptr_t)s1, strlen(s1), false);
+    msg.append((uintptr_t)s2, strlen(s2), false);
+    msg.append((uintptr_t)s3, strlen(s3), true);
+
+    vector<iovec> iov;
+    EXPECT_EQ(msg.map_in(iov, 4, 1), 4u);
+    ASSERT_EQ(iov.size(), 2u);
+    EXPECT_EQ(iov[0].iov_base, s1 + 1);
+    EXPECT_EQ(iov[0].iov_len, 2u);
+    EXPECT_EQ(iov[1].iov_base, s2);
+    EXPECT_EQ(iov[1].iov_len, 2u);
+
+    iov.clear();
+    EXPECT_EQ(msg.map_out(iov, 10), 4u);
+    ASSERT_EQ(iov.size(), 1u);
+    EXPECT_EQ(iov[0].iov_base, s3);
+    EXPECT_EQ(iov[0].iov_len, 4u);
+
+    iov.clear();
+    EXPECT_EQ(msg.map_in(iov), 6u);
+    EXPECT_EQ(iov.size(), 2u);
+}
+
+TEST(virtio, event_idx) {
+    alignas(16) u8 mem[512] = {};
+
+    virtio_queue_desc qd(0, 4);
+    qd.desc = (uintptr_t)mem;
+    qd.driver = (uintptr_t)mem + 64;
+    qd.device = (uintptr_t)mem + 128;
+    qd.has_event_idx = true;
+
+    auto dmi = [](u64 addr, u64 size, vcml_access a) -> u8* {
+        return (u8*)addr; // guest addr == host addr for this test
+    };
+
+    module parent("event_idx");
+    hierarchy_guard guard(&parent);
+    split_virtqueue vq(qd, dmi);
+
+    u16* used_idx = (u16*)(mem + 128 + 2);
+    u16* used_event = (u16*)(mem + 64 + 4 + 4 * sizeof(u16));
+
+    vq_message msg;
+    msg.index = 0;
+
+    // driver wants an interrupt after the first buffer only
+    *used_event = 0;
+    EXPECT_TRUE(vq.put(msg));
+    EXPECT_TRUE(vq.notify);
+    EXPECT_TRUE(vq.put(msg));
+    EXPECT_FALSE(vq.notify);
+    EXPECT_EQ(*used_idx, 2);
+
+    // driver asks again for the next buffer
+    *used_event = 2;
+    EXPECT_TRUE(vq.put(msg));
+    EXPECT_TRUE(vq.notify);
+
+    EXPECT_EQ(vq.num_notify, 2u);
+    EXPECT_EQ(vq.num_suppressed, 1u);
+}
+
+TEST(virtio, publish) {
+    alignas(16) u8 mem[512] = {};
+
+    virtio_queue_desc qd(0, 4);
+    qd.desc = (uintptr_t)mem;
+    qd.driver = (uintptr_t)mem + 64;
+    qd.device = (uintptr_t)mem + 128;
+    qd.has_event_idx = true;
+
+    auto dmi = [](u64 addr, u64 size, vcml_access a) -> u8* {
+        return (u8*)addr; // guest addr == host addr for this test
+    };
+
+    module parent("publish");
+    hierarchy_guard guard(&parent);
+    split_virtqueue vq(qd, dmi);
+    vq.deferred = true;
+
+    u16* used_idx = (u16*)(mem + 128 + 2);
+    u16* used_event = (u16*)(mem + 64 + 4 + 4 * sizeof(u16));
+
+    vq_message msg;
+    msg.index = 0;
+
+    // nothing becomes visible to the driver before publishing
+    *used_event = 1;
+    EXPECT_TRUE(vq.put(msg));
+    EXPECT_TRUE(vq.put(msg));
+    EXPECT_TRUE(vq.put(msg));
+    EXPECT_FALSE(vq.notify);
+    EXPECT_EQ(*used_idx, 0);
+    EXPECT_EQ(vq.unpublished(), 3u);
+
+    // used_event was passed somewhere within the batch
+    EXPECT_TRUE(vq.publish());
+    EXPECT_EQ(*used_idx, 3);
+    EXPECT_EQ(vq.unpublished(), 0u);
+    EXPECT_FALSE(vq.publish());
+
+    EXPECT_EQ(vq.num_notify, 1u);
+    EXPECT_EQ(vq.num_suppressed, 2u);
+}
+
+TEST(virtio, indirect_cache) {
+    struct desc {
+        u64 addr;
+        u32 len;
+        u16 flags;
+        u16 next;
+    };
+
+    alignas(16) u8 mem[512] = {};
+
+    virtio_queue_desc qd(0, 4);
+    qd.desc = (uintptr_t)mem;
+    qd.driver = (uintptr_t)mem + 64;
+    qd.device = (uintptr_t)mem + 128;
+
+    desc* ring = (desc*)mem;
+    desc* table = (desc*)(mem + 256);
+    ring[0] = { (uintptr_t)table, 2 * sizeof(desc), 4, 0 }; // indirect
+    table[0] = { (uintptr_t)mem + 320, 16, 1, 1 };         // next
+    table[1] = { (uintptr_t)mem + 384, 16, 2, 0 };         // write
+
+    u16* avail = (u16*)(mem + 64);
+    avail[1] = 2; // the same chain is made available twice
+
+    size_t lookups = 0;
+    auto dmi = [&](u64 addr, u64 size, vcml_access a) -> u8* {
+        if (addr == (uintptr_t)table)
+            lookups++;
+        return (u8*)addr; // guest addr == host addr for this test
+    };
+
+    module parent("indirect_cache");
+    hierarchy_guard guard(&parent);
+    split_virtqueue vq(qd, dmi);
+
+    vq_message msg;
+    ASSERT_TRUE(vq.get(msg));
+    EXPECT_EQ(msg.length_in(), 16u);
+    EXPECT_EQ(msg.length_out(), 16u);
+    ASSERT_TRUE(vq.put(msg));
+
+    ASSERT_TRUE(vq.get(msg));
+    EXPECT_EQ(msg.ndescs(), 2u);
+    EXPECT_EQ(lookups, 1u);
+    EXPECT_EQ(vq.num_table_hits, 1u);
+
+    // invalidating the table forces a new lookup
+    vq.invalidate({ (uintptr_t)table, (uintptr_t)table + 31 });
+    avail[1] = 3;
+    ASSERT_TRUE(vq.get(msg));
+    EXPECT_EQ(lookups, 2u);
+}
+
 class virtio_harness : public test_base,
                        public virtio_controller,
                        public virtio_device
@@ -108,8 +277,17 @@ public:
         EXPECT_CALL(*this, notify()).Times(1).WillOnce(Return(false));
         EXPECT_FALSE(virtio_in->notify());
 
+        // batches fall back to individual puts and stop at the first error
+        vector<vq_message> msgs(3);
+        EXPECT_CALL(*this, put(1, _))
+            .Times(2)
+            .WillOnce(Return(true))
+            .WillOnce(Return(false));
+        EXPECT_FALSE(virtio_in->put_batch(1, msgs));
+
         // notifying a stubbed socket should return false
         EXPECT_FALSE(virtio_in2->notify());
+        EXPECT_FALSE(virtio_in2->put_batch(1, msgs));
 
         // reading features from a stub clear all bits
         features = 123;
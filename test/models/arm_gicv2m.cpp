@@ -23,11 +23,41 @@ public:
                  gpio_vector vector),
                 (override));
     tlm_initiator_socket out;
+    tlm_initiator_socket msi_out;
 
     gpio_target_array in;
+    gpio_target_socket irq_in;
+
+    arm::gic400* gic;
 
     gicv2m_stim(const sc_module_name& nm):
-        test_base(nm), out("out"), in("in") {}
+        test_base(nm),
+        out("out"),
+        msi_out("msi_out"),
+        in("in"),
+        irq_in("irq_in"),
+        gic(nullptr) {}
+
+    void test_direct_spi() {
+        const size_t irq = BASE_SPI + 3;
+        gic->distif.ctlr = 1;
+        gic->cpuif.ctlr.bank(0) = 1;
+        gic->cpuif.pmr.bank(0) = 0xff;
+        gic->distif.itargets_spi[irq - arm::gic400::NPRIV] = 1;
+        gic->set_irq_trigger(irq, arm::gic400::EDGE);
+        gic->enable_irq(irq, 1);
+
+        // msis bypass the out ports and go straight into the gic
+        EXPECT_CALL(*this, gpio_notify(Ref(irq_in), true, GPIO_NO_VECTOR));
+        EXPECT_OK(msi_out.writew(0x040, irq)) << "failed to write SETSPI";
+        EXPECT_TRUE(gic->is_irq_pending(irq, 1));
+        EXPECT_TRUE(irq_in.read());
+        EXPECT_EQ(gic->cpuif.hppir.bank(0), irq);
+
+        // signaling an already pending msi again changes nothing
+        EXPECT_OK(msi_out.writew(0x040, irq)) << "failed to write SETSPI";
+        EXPECT_TRUE(irq_in.read());
+    }
 
     virtual void run_test() override {
         enum addresses : size_t {
@@ -40,6 +70,8 @@ public:
         EXPECT_OK(out.readw(TYPER_ADDR, val)) << "failed to read TYPER reg";
         EXPECT_EQ(val, BASE_SPI << 16 | NUM_SPI);
 
+        test_direct_spi();
+
         Sequence s;
         for (size_t i = BASE_SPI; i < BASE_SPI + NUM_SPI; i++) {
             EXPECT_CALL(*this, gpio_notify(Ref(in[i]), true, GPIO_NO_VECTOR))
@@ -64,6 +96,8 @@ TEST(gicv2m, gicv2m) {
     vcml::broker broker("test");
     broker.define("gicv2m.base_spi", BASE_SPI);
     broker.define("gicv2m.num_spi", NUM_SPI);
+    broker.define("msi.base_spi", BASE_SPI);
+    broker.define("msi.num_spi", 16);
 
     gicv2m_stim stim("gicv2m_stim");
     arm::gicv2m gicv2m("gicv2m");
@@ -73,6 +107,21 @@ TEST(gicv2m, gicv2m) {
 
     stim.out.bind(gicv2m.in);
 
+    arm::gicv2m msi("msi");
+    arm::gic400 gic("gic");
+    msi.connect(gic);
+    stim.gic = &gic;
+    stim.msi_out.bind(msi.in);
+    stim.clk.bind(msi.clk);
+    stim.rst.bind(msi.rst);
+    stim.clk.bind(gic.clk);
+    stim.rst.bind(gic.rst);
+    gic.distif.in.stub();
+    gic.cpuif.in.stub();
+    gic.vifctrl.in.stub();
+    gic.vcpuif.in.stub();
+    gic.irq_out[0].bind(stim.irq_in);
+
     for (size_t i = BASE_SPI; i < BASE_SPI + NUM_SPI; i++)
         gicv2m.out[i].bind(stim.in[i]);
 
@@ -0,0 +1,66 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class can_bus_bench : public test_base, public can_host
+{
+public:
+    can::bus bus;
+
+    can_initiator_array can_tx;
+    can_target_array can_rx;
+
+    vector<u32> received[3];
+
+    can_bus_bench(const sc_module_name& nm):
+        test_base(nm),
+        can_host(),
+        bus("bus"),
+        can_tx("can_tx"),
+        can_rx("can_rx"),
+        received() {
+        for (size_t i = 0; i < 3; i++)
+            bus.bind(can_tx[i], can_rx[i]);
+
+        bus.add_filter(2, 0x100, CAN_SID);
+        bus.add_filter(2, 0x300, CAN_SID);
+    }
+
+    virtual void can_receive(const can_target_socket& rx,
+                             can_frame& frame) override {
+        received[can_rx.index_of(rx)].push_back(frame.msgid);
+    }
+
+    void send(size_t from, u32 msgid) {
+        can_frame frame = {};
+        frame.msgid = msgid;
+        can_tx[from].send(frame);
+    }
+
+    virtual void run_test() override {
+        send(0, 0x100);
+        send(0, 0x200);
+        send(1, 0x300);
+
+        EXPECT_EQ(received[0], vector<u32>({ 0x300 }));
+        EXPECT_EQ(received[1], vector<u32>({ 0x100, 0x200 }));
+        EXPECT_EQ(received[2], vector<u32>({ 0x100, 0x300 }));
+
+        bus.clear_filters(2);
+        send(0, 0x200);
+        EXPECT_EQ(received[2], vector<u32>({ 0x100, 0x300, 0x200 }));
+    }
+};
+
+TEST(can, bus) {
+    can_bus_bench bench("bench");
+    sc_core::sc_start();
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#include <unistd.h>
+
+class can_shm_bench : public test_base, public can_host
+{
+public:
+    can::bridge bridge_a;
+    can::bridge bridge_b;
+    can::bridge bridge_c;
+
+    can_initiator_array can_tx;
+    can_target_array can_rx;
+
+    vector<can_frame> received[3];
+    sc_time arrival[3];
+
+    can_shm_bench(const sc_module_name& nm):
+        test_base(nm),
+        can_host(),
+        bridge_a("bridge_a"),
+        bridge_b("bridge_b"),
+        bridge_c("bridge_c"),
+        can_tx("can_tx"),
+        can_rx("can_rx"),
+        received(),
+        arrival() {
+        can_tx[0].bind(bridge_a.can_rx);
+        bridge_a.can_tx.bind(can_rx[0]);
+        can_tx[1].bind(bridge_b.can_rx);
+        bridge_b.can_tx.bind(can_rx[1]);
+        can_tx[2].bind(bridge_c.can_rx);
+        bridge_c.can_tx.bind(can_rx[2]);
+
+        // all nodes of the bus live in this process for the test, so
+        // lock-step never has to wait for any of them
+        string bus = mkstr("shm:test%d", (int)getpid());
+        bridge_a.create_backend(bus);
+        bridge_b.create_backend(bus + ":sync:100us");
+        bridge_c.create_backend(bus + ":sync:100us");
+    }
+
+    virtual void can_receive(const can_target_socket& rx,
+                             can_frame& frame) override {
+        size_t idx = can_rx.index_of(rx);
+        received[idx].push_back(frame);
+        arrival[idx] = sc_time_stamp();
+    }
+
+    bool wait_for(size_t idx, size_t count) {
+        // frames arrive from the reader thread via on_next_update
+        for (int i = 0; i < 1000 && received[idx].size() < count; i++) {
+            mwr::usleep(1000);
+            wait(1, SC_US);
+        }
+
+        return received[idx].size() >= count;
+    }
+
+    virtual void run_test() override {
+        wait(SC_ZERO_TIME);
+
+        can_frame frame = {};
+        frame.msgid = 0x123;
+        frame.dlc = 2;
+        frame.data[0] = 0xab;
+        frame.data[1] = 0xcd;
+
+        can_tx[0].send(frame);
+        ASSERT_TRUE(wait_for(1, 1));
+        ASSERT_TRUE(wait_for(2, 1));
+        EXPECT_TRUE(received[1][0] == frame);
+        EXPECT_TRUE(received[2][0] == frame);
+        EXPECT_TRUE(received[0].empty());
+
+        // synchronized nodes get frames exactly one quantum after sending
+        wait(1, SC_MS);
+        sc_time sent = sc_time_stamp();
+        frame.msgid = 0x456;
+        can_tx[1].send(frame);
+        ASSERT_TRUE(wait_for(0, 1));
+        ASSERT_TRUE(wait_for(2, 2));
+        EXPECT_TRUE(received[0][0] == frame);
+        EXPECT_TRUE(received[2][1] == frame);
+        EXPECT_GE(arrival[2], sent + sc_time(100, SC_US));
+        EXPECT_EQ(received[1].size(), 1u);
+
+        EXPECT_EQ(bridge_a.num_dropped(), 0u);
+        EXPECT_EQ(bridge_b.num_dropped(), 0u);
+        EXPECT_EQ(bridge_c.num_dropped(), 0u);
+    }
+};
+
+TEST(can, shm) {
+    can_shm_bench bench("bench");
+    sc_core::sc_start();
+}
@@ -16,6 +16,17 @@ static void emit_sev(u8*& buf, u32 ev_id) {
     buf += 2;
 }
 
+static void emit_wfe(u8*& buf, u32 ev_id) {
+    buf[0] = 0b00110110;
+    buf[1] = ev_id << 3;
+    buf += 2;
+}
+
+static void emit_wmb(u8*& buf) {
+    buf[0] = 0b00010011;
+    buf += 1;
+}
+
 static void emit_end(u8*& buf) {
     buf[0] = 0b00000000;
     buf += 1;
@@ -163,6 +174,74 @@ public:
                       data_char_ptr[dst_buffer_addr + i]);
             EXPECT_EQ(i, data_char_ptr[dst_buffer_addr + i]);
         }
+
+        // acknowledge the event and clear the channel's interrupt
+        u32 intclr_val = 1u << ev_id;
+        out.write(dma.intclr.get_address(), &intclr_val, 4);
+        EXPECT_FALSE(irq_in) << "interrupt not cleared";
+
+        // rewrite the program in place: four bursts of four 32bit beats to a
+        // new destination, a stale instruction cache would use the old one
+        const u32 dst2_buffer_addr = 0x4000;
+        for (int i = 0; i < 64; i++)
+            (&data_char_ptr[src_buffer_addr])[i] = 0x80 + i;
+
+        insn_buf_tail = channel_insn_buffer;
+        emit_configuration(insn_buf_tail, !!(dma.channels[0].csr & (1 << 21)),
+                           2u, 3u, src_buffer_addr, 1u, 2u, 3u,
+                           dst2_buffer_addr, 1u);
+        emit_rw_loop(insn_buf_tail, 3);
+        emit_sev(insn_buf_tail, ev_id);
+        emit_end(insn_buf_tail);
+
+        execute_dbg_insn(0, 0x1000);
+
+        while (!irq_in)
+            wait(1.0, sc_core::SC_SEC);
+
+        for (int i = 0; i < 64; i++)
+            EXPECT_EQ(data_char_ptr[dst2_buffer_addr + i], 0x80 + i);
+
+        out.write(dma.intclr.get_address(), &intclr_val, 4);
+        EXPECT_FALSE(irq_in) << "interrupt not cleared";
+
+        // channel 1 waits for an event from channel 0 and may not hold up
+        // channel 0 while doing so
+        const u32 ch1_insn_addr = 0x1100;
+        const u32 dst3_buffer_addr = 0x5000;
+        const u32 sync_ev = 1;
+
+        insn_buf_tail = &data_char_ptr[ch1_insn_addr];
+        emit_wfe(insn_buf_tail, sync_ev);
+        emit_configuration(insn_buf_tail, !!(dma.channels[1].csr & (1 << 21)),
+                           2u, 3u, dst2_buffer_addr, 1u, 2u, 3u,
+                           dst3_buffer_addr, 1u);
+        emit_rw_loop(insn_buf_tail, 3);
+        emit_wmb(insn_buf_tail);
+        emit_sev(insn_buf_tail, ev_id);
+        emit_end(insn_buf_tail);
+
+        insn_buf_tail = channel_insn_buffer;
+        emit_configuration(insn_buf_tail, !!(dma.channels[0].csr & (1 << 21)),
+                           2u, 3u, src_buffer_addr, 1u, 2u, 3u,
+                           dst2_buffer_addr, 1u);
+        for (int i = 0; i < 64; i++)
+            (&data_char_ptr[src_buffer_addr])[i] = 0x40 + i;
+        emit_rw_loop(insn_buf_tail, 3);
+        emit_wmb(insn_buf_tail);
+        emit_sev(insn_buf_tail, sync_ev);
+        emit_end(insn_buf_tail);
+
+        execute_dbg_insn(1, ch1_insn_addr);
+        wait(1.0, sc_core::SC_SEC);
+        EXPECT_FALSE(irq_in) << "channel 1 did not wait for its event";
+        execute_dbg_insn(0, 0x1000);
+
+        while (!irq_in)
+            wait(1.0, sc_core::SC_SEC);
+
+        for (int i = 0; i < 64; i++)
+            EXPECT_EQ(data_char_ptr[dst3_buffer_addr + i], 0x40 + i);
     }
 };
 
@@ -0,0 +1,112 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class network_bench : public test_base, public eth_host
+{
+public:
+    ethernet::network net;
+
+    eth_initiator_array eth_tx;
+    eth_target_array eth_rx;
+
+    size_t received[3];
+
+    const mac_addr addr[3] = {
+        "02:00:00:00:00:0a",
+        "02:00:00:00:00:0b",
+        "02:00:00:00:00:0c",
+    };
+
+    network_bench(const sc_module_name& nm):
+        test_base(nm),
+        eth_host(),
+        net("net"),
+        eth_tx("eth_tx"),
+        eth_rx("eth_rx"),
+        received() {
+        net.learning = true;
+        net.vlans = true;
+        for (size_t i = 0; i < 3; i++)
+            net.bind(eth_tx[i], eth_rx[i]);
+    }
+
+    virtual void eth_receive(const eth_target_socket& rx,
+                             const eth_frame& frame) override {
+        received[eth_rx.index_of(rx)]++;
+    }
+
+    void send(size_t from, const mac_addr& to, u16 vlan = 0) {
+        vector<u8> data = { 0x11, 0x22, 0x33, 0x44 };
+        eth_frame frame(to, addr[from], data);
+        if (vlan) {
+            frame[12] = 0x81;
+            frame[13] = 0x00;
+            frame[14] = vlan >> 8;
+            frame[15] = vlan & 0xff;
+        }
+
+        memset(received, 0, sizeof(received));
+        eth_tx[from].send(frame);
+    }
+
+    void expect_received(size_t a, size_t b, size_t c) {
+        EXPECT_EQ(received[0], a);
+        EXPECT_EQ(received[1], b);
+        EXPECT_EQ(received[2], c);
+    }
+
+    virtual void run_test() override {
+        wait(SC_ZERO_TIME);
+
+        // unknown destination gets flooded, sender address is learned
+        send(0, addr[1]);
+        expect_received(0, 1, 1);
+        EXPECT_EQ(net.num_learned(), 1u);
+
+        // known destination only goes to its port
+        send(1, addr[0]);
+        expect_received(1, 0, 0);
+        send(0, addr[1]);
+        expect_received(0, 1, 0);
+        EXPECT_EQ(net.num_learned(), 2u);
+
+        // broadcasts are always flooded
+        send(2, "ff:ff:ff:ff:ff:ff");
+        expect_received(1, 1, 0);
+        EXPECT_EQ(net.num_learned(), 3u);
+
+        // addresses are learned separately for each vlan
+        send(0, addr[1], 5);
+        expect_received(0, 1, 1);
+        send(1, addr[0], 5);
+        expect_received(1, 0, 0);
+
+        stringstream ss;
+        EXPECT_TRUE(net.execute("show_ports", ss));
+        EXPECT_NE(ss.str().find("port 2: rx 1 frames"), string::npos)
+            << ss.str();
+
+        // stale entries age out and cause flooding again
+        net.aging = sc_time(1, SC_US);
+        wait(2, SC_US);
+        send(0, addr[1]);
+        expect_received(0, 1, 1);
+
+        EXPECT_TRUE(net.execute("flush_macs", ss));
+        EXPECT_EQ(net.num_learned(), 0u);
+    }
+};
+
+TEST(ethernet, network) {
+    network_bench bench("bench");
+    sc_core::sc_start();
+}
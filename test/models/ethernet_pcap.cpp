@@ -0,0 +1,100 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#include <unistd.h>
+
+static vector<u8> read_file(const string& path) {
+    ifstream is(path, std::ios::binary);
+    return vector<u8>(std::istreambuf_iterator<char>(is),
+                      std::istreambuf_iterator<char>());
+}
+
+static u32 read_u32(const vector<u8>& data, size_t offset) {
+    u32 val = 0;
+    memcpy(&val, data.data() + offset, sizeof(val));
+    return val;
+}
+
+class pcap_bench : public test_base
+{
+public:
+    ethernet::bridge bridge;
+    eth_initiator_socket eth_tx;
+    eth_target_socket eth_rx;
+
+    string pcap;
+    string pcapng;
+
+    pcap_bench(const sc_module_name& nm):
+        test_base(nm),
+        bridge("bridge"),
+        eth_tx("eth_tx"),
+        eth_rx("eth_rx"),
+        pcap(mkstr("/tmp/vcml-test-%d.pcap", (int)getpid())),
+        pcapng(mkstr("/tmp/vcml-test-%d.pcapng", (int)getpid())) {
+        eth_tx.bind(bridge.eth_rx);
+        bridge.eth_tx.bind(eth_rx);
+    }
+
+    virtual void run_test() override {
+        size_t a = bridge.create_backend("file:" + pcap + ":snaplen=16");
+        size_t b = bridge.create_backend("file:" + pcapng + ":rotate=100");
+
+        vector<u8> data(32, 0xab);
+        eth_frame frame("ff:ff:ff:ff:ff:ff", "02:00:00:00:00:0a", data);
+
+        wait(1500, SC_NS);
+        eth_tx.send(frame);
+        wait(2, SC_SEC);
+        eth_tx.send(frame);
+
+        // destroying the backends flushes everything to disk
+        EXPECT_TRUE(bridge.destroy_backend(a));
+        EXPECT_TRUE(bridge.destroy_backend(b));
+
+        vector<u8> file = read_file(pcap);
+        ASSERT_EQ(file.size(), 24u + 2 * (16u + 16u));
+        EXPECT_EQ(read_u32(file, 0), 0xa1b23c4d);
+        EXPECT_EQ(read_u32(file, 16), 16u); // snaplen
+        EXPECT_EQ(read_u32(file, 20), 1u);  // ethernet
+
+        EXPECT_EQ(read_u32(file, 24), 0u);    // seconds
+        EXPECT_EQ(read_u32(file, 28), 1500u); // nanoseconds
+        EXPECT_EQ(read_u32(file, 32), 16u);   // captured
+        EXPECT_EQ(read_u32(file, 36), 64u);   // original
+        EXPECT_EQ(read_u32(file, 56), 2u);    // seconds
+        EXPECT_EQ(read_u32(file, 60), 1500u); // nanoseconds
+
+        // a full frame does not fit twice, so the second one rotates
+        file = read_file(pcapng);
+        ASSERT_EQ(file.size(), 28u + 32u + 32u + 64u);
+        EXPECT_EQ(read_u32(file, 0), 0x0a0d0d0a);
+        EXPECT_EQ(read_u32(file, 60), 6u);
+        EXPECT_EQ(read_u32(file, 72), 0u);
+        EXPECT_EQ(read_u32(file, 76), 1500u);
+
+        file = read_file(pcapng + ".1");
+        ASSERT_EQ(file.size(), 28u + 32u + 32u + 64u);
+        EXPECT_EQ(read_u32(file, 0), 0x0a0d0d0a);
+        EXPECT_EQ(read_u32(file, 72), 0u);
+        EXPECT_EQ(read_u32(file, 76), 2000001500u);
+
+        unlink(pcap.c_str());
+        unlink(pcapng.c_str());
+        unlink((pcapng + ".1").c_str());
+    }
+};
+
+TEST(ethernet, pcap) {
+    pcap_bench bench("bench");
+    sc_core::sc_start();
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#include <unistd.h>
+
+class shm_bench : public test_base, public eth_host
+{
+public:
+    ethernet::bridge bridge_a;
+    ethernet::bridge bridge_b;
+
+    eth_initiator_socket eth_tx_a;
+    eth_target_socket eth_rx_a;
+    eth_initiator_socket eth_tx_b;
+    eth_target_socket eth_rx_b;
+
+    vector<eth_frame> received_a;
+    vector<eth_frame> received_b;
+
+    shm_bench(const sc_module_name& nm):
+        test_base(nm),
+        eth_host(),
+        bridge_a("bridge_a"),
+        bridge_b("bridge_b"),
+        eth_tx_a("eth_tx_a"),
+        eth_rx_a("eth_rx_a"),
+        eth_tx_b("eth_tx_b"),
+        eth_rx_b("eth_rx_b"),
+        received_a(),
+        received_b() {
+        eth_tx_a.bind(bridge_a.eth_rx);
+        bridge_a.eth_tx.bind(eth_rx_a);
+        eth_tx_b.bind(bridge_b.eth_rx);
+        bridge_b.eth_tx.bind(eth_rx_b);
+
+        // both ends of the link live in this process for the test
+        string link = mkstr("shm:test%d", (int)getpid());
+        bridge_a.create_backend(link);
+        bridge_b.create_backend(link + ":sync");
+    }
+
+    virtual void eth_receive(const eth_target_socket& rx,
+                             const eth_frame& frame) override {
+        if (&rx == &eth_rx_a)
+            received_a.push_back(frame);
+        else
+            received_b.push_back(frame);
+    }
+
+    bool wait_for(const vector<eth_frame>& frames, size_t count) {
+        // frames arrive from the reader thread via on_next_update
+        for (int i = 0; i < 1000 && frames.size() < count; i++) {
+            mwr::usleep(1000);
+            wait(1, SC_US);
+        }
+
+        return frames.size() >= count;
+    }
+
+    virtual void run_test() override {
+        wait(SC_ZERO_TIME);
+
+        vector<u8> data = { 0x11, 0x22, 0x33, 0x44 };
+        eth_frame frame("ff:ff:ff:ff:ff:ff", "02:00:00:00:00:0a", data);
+
+        eth_tx_a.send(frame);
+        ASSERT_TRUE(wait_for(received_b, 1));
+        EXPECT_EQ(received_b[0], frame);
+        EXPECT_TRUE(received_a.empty());
+
+        // the synchronized side never receives frames ahead of time
+        wait(1, SC_MS);
+        sc_time sent = sc_time_stamp();
+        eth_tx_a.send(frame);
+        ASSERT_TRUE(wait_for(received_b, 2));
+        EXPECT_GE(sc_time_stamp(), sent);
+        EXPECT_EQ(bridge_b.num_dropped(), 0u);
+
+        eth_tx_b.send(frame);
+        ASSERT_TRUE(wait_for(received_a, 1));
+        EXPECT_EQ(received_a[0], frame);
+        EXPECT_EQ(received_b.size(), 2u);
+    }
+};
+
+TEST(ethernet, shm) {
+    shm_bench bench("bench");
+    sc_core::sc_start();
+}
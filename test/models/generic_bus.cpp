@@ -21,6 +21,8 @@ public:
     tlm_initiator_socket out2;
     tlm_target_socket in;
 
+    u8 buffer[0x2000];
+
     MOCK_METHOD(void, invalidate, (u64, u64));
 
     virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
@@ -59,6 +61,8 @@ public:
 
         bus.stub(0xe000, 0xe7ff);
         tlm_stub(bus, *this, "out2", 0xe800, 0xefff);
+
+        map_dmi(buffer, 0x10000, 0x11fff, VCML_ACCESS_READ_WRITE);
     }
 
     virtual void run_test() override {
@@ -112,8 +116,10 @@ public:
                 << "bus forwarded overlapping DMI pointers";
         }
 
-        EXPECT_CALL(*this, invalidate(0x0000, 0x1fff)).Times(2);
-        EXPECT_CALL(*this, invalidate(0x6000, 0x7fff)).Times(2);
+        // only out1 has been granted DMI for mem1 so far
+        EXPECT_TRUE(out1.lookup_dmi_ptr(0xa000, 4));
+        EXPECT_CALL(*this, invalidate(0x0000, 0x1fff)).Times(1);
+        EXPECT_CALL(*this, invalidate(0x6000, 0x7fff)).Times(1);
         EXPECT_CALL(*this, invalidate(0xa000, 0xbfff)).Times(1);
         mem1.unmap_dmi(0, 0x1fff);
         ASSERT_EQ(cache.get_entries().size(), 1)
@@ -121,9 +127,16 @@ public:
         EXPECT_EQ(cache.get_entries()[0].get_start_address(), 0x2000)
             << "bus invalidated wrong DMI region";
 
+        auto grant_dmi = [&]() {
+            EXPECT_TRUE(out1.lookup_dmi_ptr(0x8000, 0x2000));
+            EXPECT_TRUE(out2.lookup_dmi_ptr(0x8000, 0x2000));
+        };
+
+        grant_dmi();
         EXPECT_CALL(*this, invalidate(0x8000, 0x9fff)).Times(2);
         in->invalidate_direct_mem_ptr(0, ~0ull);
 
+        grant_dmi();
         EXPECT_CALL(*this, invalidate(0x8100, 0x8fff)).Times(2);
         in->invalidate_direct_mem_ptr(0x10100, 0x10fff);
 
@@ -133,6 +146,9 @@ public:
         EXPECT_CALL(*this, invalidate(0x8000, 0x800f)).Times(2);
         in->invalidate_direct_mem_ptr(0x9000, 0x1000f);
 
+        EXPECT_CALL(*this, invalidate(_, _)).Times(0);
+        in->invalidate_direct_mem_ptr(0x10100, 0x10fff);
+
         EXPECT_AE(out1.readw<u32>(0xc000, data))
             << "bus transaction went through for area unmapped for out1";
         EXPECT_AE(out2.readw<u32>(0xa000, data))
@@ -161,6 +177,12 @@ public:
         EXPECT_OK(out2.readw<u32>(0xe800, data))
             << "cannot read from privately stubbed area";
 
+        bus.bind(mem2.in, 0x10000, 0x11fff);
+        EXPECT_OK(out1.readw<u32>(0x10000, data))
+            << "cannot access memory mapped during simulation";
+        EXPECT_EQ(data, 0x55555555)
+            << "unexpected data from memory mapped during simulation";
+
         bus.execute("mmap", std::cout);
         std::cout << std::endl;
     }
@@ -170,3 +192,66 @@ TEST(generic_bus, transfer) {
     bus_harness test("test");
     sc_core::sc_start();
 }
+
+class dmi_map_harness : public test_base
+{
+public:
+    generic::memory mem1;
+    generic::memory mem2;
+    generic::bus bus;
+    generic::bus sub;
+
+    tlm_initiator_socket out;
+
+    dmi_map_harness(const sc_module_name& nm):
+        test_base(nm),
+        mem1("mem1", 0x2000),
+        mem2("mem2", 0x2000),
+        bus("bus"),
+        sub("sub"),
+        out("out") {
+        clk_bind(*this, "clk", mem1, "clk");
+        clk_bind(*this, "clk", mem2, "clk");
+        clk_bind(*this, "clk", bus, "clk");
+        clk_bind(*this, "clk", sub, "clk");
+
+        gpio_bind(*this, "rst", mem1, "rst");
+        gpio_bind(*this, "rst", mem2, "rst");
+        gpio_bind(*this, "rst", bus, "rst");
+        gpio_bind(*this, "rst", sub, "rst");
+
+        bus.bind(out);
+        bus.bind(mem1.in, 0x0000, 0x1fff);
+        bus.bind(sub.in[0], 0x10000, 0x1ffff);
+        bus.stub(0x4000, 0x4fff);
+        sub.bind(mem2.in, 0x1000, 0x2fff);
+    }
+
+    virtual void run_test() override {
+        vector<tlm_dmi> map = bus.dmi_map(out);
+        ASSERT_EQ(map.size(), 2);
+        EXPECT_EQ(map[0].get_start_address(), 0x0000);
+        EXPECT_EQ(map[0].get_end_address(), 0x1fff);
+        EXPECT_EQ(map[0].get_dmi_ptr(), mem1.data());
+        EXPECT_EQ(map[1].get_start_address(), 0x11000);
+        EXPECT_EQ(map[1].get_end_address(), 0x12fff);
+        EXPECT_EQ(map[1].get_dmi_ptr(), mem2.data());
+
+        // prepopulated regions are dropped like any other dmi region
+        for (const tlm_dmi& dmi : map)
+            out.map_dmi(dmi);
+        EXPECT_TRUE(out.lookup_dmi_ptr(0x11000, 4));
+        mem2.unmap_dmi(0, 0x1fff);
+        EXPECT_FALSE(out.lookup_dmi_ptr(0x11000, 4))
+            << "invalidation did not reach prepopulated region";
+        EXPECT_TRUE(out.lookup_dmi_ptr(0x0000, 4));
+
+        bus.execute("dmimap", { "0" }, std::cout);
+        std::cout << std::endl;
+    }
+};
+
+TEST(generic_bus, dmi_map) {
+    dmi_map_harness test("test");
+    sc_core::sc_start();
+}
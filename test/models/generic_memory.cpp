@@ -10,27 +10,50 @@
 
 #include "testing.h"
 
+#include <unistd.h>
+
 class test_harness : public test_base
 {
 public:
     generic::memory ram;
     generic::memory rom;
+    generic::memory pram;
+    generic::memory shm_a;
+    generic::memory shm_b;
 
     tlm_initiator_socket ram_port;
     tlm_initiator_socket rom_port;
+    tlm_initiator_socket shm_a_port;
+    tlm_initiator_socket shm_b_port;
 
     test_harness(const sc_module_name& nm):
         test_base(nm),
         ram("ram", 4 * KiB, false, VCML_ALIGN_2M),
         rom("rom", 4 * KiB, true, VCML_ALIGN_NONE),
+        pram("pram", 16 * KiB),
+        shm_a("shm_a", 4 * KiB),
+        shm_b("shm_b", 4 * KiB),
         ram_port("ram_port"),
-        rom_port("rom_port") {
+        rom_port("rom_port"),
+        shm_a_port("shm_a_port"),
+        shm_b_port("shm_b_port") {
         ram_port.bind(ram.in);
         rom_port.bind(rom.in);
+        shm_a_port.bind(shm_a.in);
+        shm_b_port.bind(shm_b.in);
+        shm_a.rst.stub();
+        shm_b.rst.stub();
+        shm_a.clk.stub(10 * MHz);
+        shm_b.clk.stub(10 * MHz);
         ram.rst.stub();
         rom.rst.stub();
         ram.clk.stub(10 * MHz);
         rom.clk.stub(10 * MHz);
+        pram.rst.stub();
+        pram.clk.stub(10 * MHz);
+
+        pram.pristine = true;
+        pram[0] = 0x5a;
     }
 
     virtual void run_test() override {
@@ -61,12 +84,133 @@ public:
         ASSERT_CE(rom_port.writew(0x0, 0xfefefefe))
             << "read-only memory permitted write access after DMI invalidate";
 
+        u32 a = 0xaaaaaaaa, b = 0xbbbbbbbb, c = 0xcccccccc;
+        vector<tlm_segment> segments = {
+            { 0x10, &a, sizeof(a) },
+            { 0x14, &b, sizeof(b) },
+            { 0x20, &c, sizeof(c) },
+        };
+
+        unsigned int nbytes = 0;
+        ASSERT_OK(ram_port.write(segments, SBI_NONE, &nbytes))
+            << "cannot write scattered segments";
+        EXPECT_EQ(nbytes, 12);
+
+        u64 ab = 0;
+        u32 cc = 0;
+        segments = { { 0x10, &ab, sizeof(ab) }, { 0x20, &cc, sizeof(cc) } };
+        ASSERT_OK(ram_port.read(segments, SBI_NONE, &nbytes))
+            << "cannot read scattered segments";
+        EXPECT_EQ(nbytes, 12);
+        EXPECT_EQ(ab, 0xbbbbbbbbaaaaaaaaull);
+        EXPECT_EQ(cc, 0xccccccccu);
+
+        segments = { { 0x0, &a, sizeof(a) } };
+        ASSERT_CE(rom_port.write(segments))
+            << "read-only memory permitted batched write access";
+
         ASSERT_TRUE(is_aligned(ram.data(), VCML_ALIGN_2M))
             << "memory is not 21 bit aligned";
+
+        // exclusive pairs are served via dmi and only inform the monitor
+        u64 hits = ram_port.dmi_hits();
+        u32 word = 0;
+        ASSERT_OK(ram_port.readw(0x40, word, SBI_EXCL, &nbytes));
+        EXPECT_EQ(nbytes, 4);
+        EXPECT_GT(ram_port.dmi_hits(), hits) << "exclusive load missed dmi";
+        EXPECT_TRUE(ram.in.exmon().has_lock(0, { 0x40, 0x43 }));
+        EXPECT_TRUE(has_dmi(ram_port, 0x40)) << "exclusive load revoked dmi";
+        ASSERT_OK(ram_port.writew(0x40, 0xabcdu, SBI_EXCL, &nbytes));
+        EXPECT_EQ(nbytes, 4) << "exclusive store failed";
+        EXPECT_FALSE(ram.in.exmon().has_locks()) << "lock not released";
+        ASSERT_OK(ram_port.writew(0x40, 0x1234u, SBI_EXCL, &nbytes));
+        EXPECT_EQ(nbytes, 0) << "exclusive store without load succeeded";
+        ASSERT_OK(ram_port.readw(0x40, word));
+        EXPECT_EQ(word, 0xabcdu);
+
+        // pristine memories restore their contents at simulation start
+        pram[0] = 0x11;
+        pram[8 * KiB] = 0x22;
+        pram.do_reset();
+        EXPECT_EQ(pram[0], 0x5a);
+        EXPECT_EQ(pram[8 * KiB], 0x00);
+
+        // cleared memories read zero after reset and grant dmi again
+        ram.clear_on_reset = true;
+        ASSERT_OK(ram_port.writew(0x0, 0x11223344));
+        ram.do_reset();
+        EXPECT_EQ(ram_port.dmi_cache().get_entries().size(), 0)
+            << "dmi not invalidated when clearing memory";
+        ASSERT_OK(ram_port.readw(0x0, data));
+        EXPECT_EQ(data, 0u) << "memory not cleared on reset";
+        EXPECT_GT(ram_port.dmi_cache().get_entries().size(), 0)
+            << "dmi not granted again after reset";
+        ram.clear_on_reset = false;
+
+        // heatmaps count transport accesses and sample those via dmi
+        ram.in.enable_heatmap(sc_time(1.0, SC_US));
+        const tlm_heatmap* hm = ram.in.heatmap();
+        ASSERT_OK(ram_port.writew(0x100, 0x1u, SBI_NODMI));
+        ASSERT_OK(ram_port.readw(0x104, word, SBI_NODMI));
+        EXPECT_EQ(hm->pages().at(0).writes, 1u);
+        EXPECT_EQ(hm->pages().at(0).reads, 1u);
+        wait(1500, SC_NS);
+        EXPECT_EQ(hm->num_samples(), 1u);
+        EXPECT_FALSE(has_dmi(ram_port, 0x100)) << "sampled page kept dmi";
+        ASSERT_OK(ram_port.readw(0x100, word));
+        EXPECT_EQ(hm->pages().at(0).reads, 2u) << "dmi access not sampled";
+        EXPECT_TRUE(has_dmi(ram_port, 0x100)) << "dmi not granted again";
+
+        test_shared();
+    }
+
+    static bool has_dmi(tlm_initiator_socket& port, u64 addr) {
+        for (const tlm_dmi& dmi : port.dmi_cache().get_entries())
+            if (range(dmi).includes(addr))
+                return true;
+        return false;
+    }
+
+    // messages between shared memories arrive asynchronously
+    template <typename COND>
+    void wait_until(COND cond) {
+        for (int i = 0; i < 10000 && !cond(); i++) {
+            wait(1, SC_US);
+            mwr::usleep(100);
+        }
+    }
+
+    void test_shared() {
+        ASSERT_EQ(shm_a.data()[0], shm_b.data()[0]);
+        ASSERT_OK(shm_b_port.writew(0x0, 0x12345678u));
+        ASSERT_TRUE(has_dmi(shm_b_port, 0x0));
+
+        // an exclusive read in one process revokes dmi in all others
+        u32 val = 0;
+        ASSERT_OK(shm_a_port.readw(0x0, val, SBI_EXCL));
+        EXPECT_EQ(val, 0x12345678u);
+        EXPECT_TRUE(shm_a.in.exmon().has_locks());
+        wait_until([&]() { return !has_dmi(shm_b_port, 0x0); });
+        EXPECT_FALSE(has_dmi(shm_b_port, 0x0))
+            << "exclusive lock did not revoke dmi of peer";
+
+        // which forces writes through transport, breaking the lock
+        ASSERT_OK(shm_b_port.writew(0x0, 0x87654321u));
+        wait_until([&]() { return !shm_a.in.exmon().has_locks(); });
+        EXPECT_FALSE(shm_a.in.exmon().has_locks())
+            << "write of peer did not break exclusive lock";
+
+        ASSERT_OK(shm_b_port.writew(0x4, 0xaabbccddu));
+        EXPECT_TRUE(has_dmi(shm_b_port, 0x4))
+            << "peer did not regain dmi after lock was broken";
     }
 };
 
 TEST(generic_memory, access) {
+    string shared = mkstr("/vcml-test-coherent-%d", (int)getpid());
+    vcml::broker broker("test");
+    broker.define("harness.shm_a.shared", shared);
+    broker.define("harness.shm_b.shared", shared);
     test_harness test("harness");
     sc_core::sc_start();
 }
@@ -0,0 +1,138 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// lives in a forked child with its own simulation, because the target end
+// blocks its kernel until the initiator end has answered
+class remote_server : public sc_core::sc_module
+{
+public:
+    int pipe_fd;
+
+    generic::memory mem;
+    generic::remote_initiator remote;
+
+    remote_server(const sc_module_name& nm, const string& chan, int fd):
+        sc_core::sc_module(nm),
+        pipe_fd(fd),
+        mem("mem", 16 * KiB),
+        remote("remote", chan) {
+        remote.out.bind(mem.in);
+        mem.clk.stub(100 * MHz);
+        mem.rst.stub();
+        remote.clk.stub(100 * MHz);
+        remote.rst.stub();
+
+        fcntl(pipe_fd, F_SETFL, O_NONBLOCK);
+
+        SC_HAS_PROCESS(remote_server);
+        SC_THREAD(keep_alive);
+    }
+
+    // keeps the kernel busy to serve requests until the client closes
+    // its end of the pipe, or gives up after ten seconds
+    void keep_alive() {
+        u64 start = mwr::timestamp_us();
+        char c;
+        while (mwr::timestamp_us() - start < 10000000) {
+            if (read(pipe_fd, &c, 1) == 0)
+                break;
+            mwr::usleep(100);
+            wait(1, SC_US);
+        }
+
+        sc_core::sc_stop();
+    }
+};
+
+class remote_client : public test_base
+{
+public:
+    generic::remote_target remote;
+    tlm_initiator_socket out;
+
+    remote_client(const sc_module_name& nm, const string& chan):
+        test_base(nm), remote("remote", chan), out("out") {
+        out.bind(remote.in);
+        remote.clk.stub(100 * MHz);
+        remote.rst.stub();
+    }
+
+    virtual void run_test() override {
+        // the server needs a moment to come up in the child process
+        u32 val = 0;
+        for (int i = 0; i < 5000; i++) {
+            if (success(out.readw(0x0, val, SBI_DEBUG)))
+                break;
+            mwr::usleep(1000);
+        }
+
+        ASSERT_OK(out.writew(0x10, 0x11223344u, SBI_DEBUG));
+        ASSERT_OK(out.readw(0x10, val, SBI_DEBUG));
+        EXPECT_EQ(val, 0x11223344u);
+
+        // larger than a single slot of the channel
+        vector<u8> wr(6000), rd(6000);
+        for (size_t i = 0; i < wr.size(); i++)
+            wr[i] = (u8)i;
+        ASSERT_OK(out.write(0x100, wr.data(), wr.size(), SBI_NODMI));
+        ASSERT_OK(out.read(0x100, rd.data(), rd.size(), SBI_NODMI));
+        EXPECT_EQ(wr, rd);
+
+        // the server memory is shared, so dmi should be granted for it
+        ASSERT_OK(out.writew(0x20, 0xabcdef01u));
+        EXPECT_GT(out.dmi_cache().get_entries().size(), 0)
+            << "did not get DMI access to remote memory";
+        ASSERT_OK(out.readw(0x20, val));
+        EXPECT_EQ(val, 0xabcdef01u);
+    }
+};
+
+TEST(generic, remote) {
+    string chan = mkstr("test%d", (int)getpid());
+    string shared = mkstr("/vcml-test-remote-%d", (int)getpid());
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+
+    if (pid == 0) {
+        close(fds[1]);
+        {
+            vcml::broker broker("server");
+            broker.define("server.mem.shared", shared);
+            remote_server server("server", chan, fds[0]);
+            sc_core::sc_start();
+        }
+
+        _exit(0);
+    }
+
+    close(fds[0]);
+
+    {
+        remote_client client("client", chan);
+        sc_core::sc_start();
+    }
+
+    close(fds[1]);
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
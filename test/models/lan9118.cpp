@@ -167,6 +167,70 @@ public:
         EXPECT_TRUE(irq.read()) << "interrupt did not get raised";
         check_irq(31);
         EXPECT_FALSE(irq.read()) << "interrupts did not get cleared";
+
+        // check a frame looped back through the tx and rx data fifos
+        u8 frame[64];
+        for (size_t i = 0; i < sizeof(frame); i++)
+            frame[i] = i < 6 ? 0xff : (u8)i;
+
+        phy_write(PHY_CR, 1u << 14);                     // loopback
+        mac_write(MAC_CR, 1u << 2 | 1u << 3 | 1u << 18); // rx, tx, promisc
+        EXPECT_OK(out.writew(CSR_TX_CFG, 1u << 1)) << "cannot enable TX";
+
+        u32 cmda = 1u << 13 | 1u << 12 | sizeof(frame);
+        u32 cmdb = 0xab << 16 | sizeof(frame);
+        EXPECT_OK(out.writew(0x20, cmda)) << "cannot write TX CMDA";
+        EXPECT_OK(out.writew(0x20, cmdb)) << "cannot write TX CMDB";
+        for (size_t i = 0; i < sizeof(frame); i += 4) {
+            memcpy(&data, frame + i, sizeof(data));
+            EXPECT_OK(out.writew(0x20, data)) << "cannot write TX data";
+        }
+
+        wait(1, SC_MS);
+
+        EXPECT_OK(out.readw(CSR_RX_FIFO_INF, data)) << "cannot read RX_INF";
+        EXPECT_EQ(data, 1u << 16 | (sizeof(frame) + 4)) << "frame missing";
+        EXPECT_OK(out.readw(0x40, data)) << "cannot read RX status";
+        EXPECT_EQ((data >> 16) & 0x3fff, sizeof(frame) + 4);
+
+        for (size_t i = 0; i < sizeof(frame); i += 4) {
+            u32 expect;
+            memcpy(&expect, frame + i, sizeof(expect));
+            EXPECT_OK(out.readw(0x00, data)) << "cannot read RX data";
+            EXPECT_EQ(data, expect) << "RX data mismatch at byte " << i;
+        }
+
+        EXPECT_OK(out.readw(0x00, data)) << "cannot read RX crc";
+        EXPECT_EQ(data, crc32_eth(frame, sizeof(frame))) << "RX crc mismatch";
+        EXPECT_OK(out.readw(CSR_RX_FIFO_INF, data)) << "cannot read RX_INF";
+        EXPECT_EQ(data, 0u) << "RX fifos not drained";
+
+        // same again, but moving the frame using streaming bursts
+        u32 words[2 + sizeof(frame) / 4];
+        words[0] = cmda;
+        words[1] = cmdb;
+        memcpy(words + 2, frame, sizeof(frame));
+
+        tlm_generic_payload tx;
+        tx_setup(tx, TLM_WRITE_COMMAND, 0x20, words, sizeof(words));
+        tx.set_streaming_width(4);
+        EXPECT_EQ(out.send(tx), sizeof(words)) << "TX burst failed";
+        EXPECT_TRUE(tx.is_response_ok()) << "TX burst not accepted";
+
+        wait(1, SC_MS);
+
+        EXPECT_OK(out.readw(0x40, data)) << "cannot read RX status";
+        EXPECT_EQ((data >> 16) & 0x3fff, sizeof(frame) + 4);
+
+        u32 rx[sizeof(frame) / 4 + 1];
+        tx_setup(tx, TLM_READ_COMMAND, 0x08, rx, sizeof(rx));
+        tx.set_streaming_width(4);
+        EXPECT_EQ(out.send(tx), sizeof(rx)) << "RX burst failed";
+        EXPECT_TRUE(tx.is_response_ok()) << "RX burst not accepted";
+        EXPECT_EQ(memcmp(rx, frame, sizeof(frame)), 0) << "RX data mismatch";
+        EXPECT_EQ(rx[sizeof(frame) / 4], crc32_eth(frame, sizeof(frame)));
+        EXPECT_OK(out.readw(CSR_RX_FIFO_INF, data)) << "cannot read RX_INF";
+        EXPECT_EQ(data, 0u) << "RX fifos not drained after burst";
     }
 };
 
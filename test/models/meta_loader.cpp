@@ -65,3 +65,22 @@ TEST(loader, simulate) {
     loader_test stim;
     sc_core::sc_start();
 }
+
+TEST(loader, compression) {
+    const string raw = "/tmp/vcml-test-loader-raw.bin";
+    const string gz = "/tmp/vcml-test-loader-gzip.bin";
+    const string zst = "/tmp/vcml-test-loader-zstd.bin";
+
+    ofstream(raw, std::ios::binary) << "raw data";
+    ofstream(gz, std::ios::binary) << "\x1f\x8b\x08\x00";
+    ofstream(zst, std::ios::binary) << "\x28\xb5\x2f\xfd";
+
+    EXPECT_FALSE(debugging::is_compressed_image(raw));
+    EXPECT_TRUE(debugging::is_compressed_image(gz));
+    EXPECT_TRUE(debugging::is_compressed_image(zst));
+    EXPECT_EQ(debugging::detect_image_type(gz), debugging::IMAGE_BIN);
+
+    remove(raw.c_str());
+    remove(gz.c_str());
+    remove(zst.c_str());
+}
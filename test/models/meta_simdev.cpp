@@ -0,0 +1,90 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#include <unistd.h>
+
+class simdev_test : public test_base
+{
+public:
+    meta::simdev simdev;
+    generic::memory mem;
+
+    tlm_initiator_socket out;
+    tlm_initiator_socket mem_out;
+
+    string stats;
+
+    simdev_test(const sc_module_name& nm):
+        test_base(nm),
+        simdev("simdev"),
+        mem("mem", 4 * KiB),
+        out("out"),
+        mem_out("mem_out"),
+        stats(mkstr("/tmp/vcml-simdev-%d.csv", (int)getpid())) {
+        out.bind(simdev.in);
+        mem_out.bind(mem.in);
+        clk.bind(simdev.clk);
+        clk.bind(mem.clk);
+        rst.bind(simdev.rst);
+        rst.bind(mem.rst);
+
+        simdev.roi_tracing = true;
+        simdev.stats_file = stats;
+    }
+
+    virtual ~simdev_test() { remove(stats.c_str()); }
+
+    virtual void run_test() override {
+        // nothing gets traced before the guest enters its roi
+        EXPECT_TRUE(tracer::paused());
+        EXPECT_FALSE(roi_active());
+
+        u32 val = 0;
+        ASSERT_OK(mem_out.writew(0x0, 0x1234u, SBI_NODMI));
+        EXPECT_GT(mem.in.stats().num_transactions, 0);
+
+        ASSERT_OK(out.writew(0x40, 1u));
+        EXPECT_TRUE(roi_active());
+        EXPECT_FALSE(tracer::paused());
+        EXPECT_EQ(mem.in.stats().num_transactions, 0)
+            << "roi begin did not reset socket statistics";
+        ASSERT_OK(out.readw(0x40, val));
+        EXPECT_EQ(val, 1u);
+
+        ASSERT_OK(mem_out.readw(0x0, val, SBI_NODMI));
+        EXPECT_EQ(mem.in.stats().num_transactions, 1);
+
+        ASSERT_OK(out.writew(0x48, 7u));
+        EXPECT_FALSE(roi_active());
+        EXPECT_TRUE(tracer::paused());
+
+        ASSERT_OK(out.writew(0x58, 8u));
+
+        ifstream file(stats);
+        ASSERT_TRUE(file.good()) << "no statistics written to " << stats;
+        string content((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+        EXPECT_NE(content.find("# region of interest 7"), string::npos);
+        EXPECT_NE(content.find("# statistics dump 8"), string::npos);
+        EXPECT_NE(content.find("simdev_test.mem.in"), string::npos);
+
+        ASSERT_OK(out.writew(0x50, 1u));
+        EXPECT_EQ(mem.in.stats().num_transactions, 0);
+
+        tracer::resume();
+    }
+};
+
+TEST(simdev, roi) {
+    simdev_test test("simdev_test");
+    sc_core::sc_start();
+}
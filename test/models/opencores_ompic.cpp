@@ -0,0 +1,70 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class ompic_stim : public test_base
+{
+public:
+    opencores::ompic ompic;
+
+    tlm_initiator_socket out;
+    gpio_target_array irq_in;
+
+    ompic_stim(const sc_module_name& nm):
+        test_base(nm), ompic("ompic", 2), out("out"), irq_in("irq_in") {
+        out.bind(ompic.in);
+        clk.bind(ompic.clk);
+        rst.bind(ompic.rst);
+        for (size_t core = 0; core < 2; core++)
+            ompic.irq[core].bind(irq_in[core]);
+    }
+
+    virtual void run_test() override {
+        const u32 gen = opencores::ompic::CTRL_IRQ_GEN;
+        const u32 ack = opencores::ompic::CTRL_IRQ_ACK;
+
+        // cpu0 sends data 0x1234 to cpu1
+        u32 val = 0;
+        ASSERT_OK(out.writew(0x0, gen | 1u << 16 | 0x1234u));
+        EXPECT_TRUE(irq_in[1].read());
+        EXPECT_FALSE(irq_in[0].read());
+        EXPECT_TRUE(ompic.is_pending(1));
+        ASSERT_OK(out.readw(0xc, val));
+        EXPECT_EQ(val, gen | 0u << 16 | 0x1234u);
+
+        // a second ipi before the ack is coalesced into the pending one
+        ASSERT_OK(out.writew(0x0, gen | 1u << 16 | 0x5678u));
+        EXPECT_TRUE(irq_in[1].read());
+        EXPECT_EQ(ompic.num_ipis_sent(0), 2);
+        EXPECT_EQ(ompic.num_ipis_received(1), 2);
+        EXPECT_EQ(ompic.num_ipis_coalesced(1), 1);
+
+        // cpu1 acknowledges
+        ASSERT_OK(out.writew(0x8, ack));
+        EXPECT_FALSE(irq_in[1].read());
+        EXPECT_FALSE(ompic.is_pending(1));
+        ASSERT_OK(out.readw(0xc, val));
+        EXPECT_EQ(val, 0u << 16 | 0x5678u);
+
+        // ipis to cores that do not exist are ignored
+        ASSERT_OK(out.writew(0x8, gen | 7u << 16));
+        EXPECT_EQ(ompic.num_ipis_sent(1), 0);
+
+        stringstream ss;
+        EXPECT_TRUE(ompic.execute("stats", ss));
+        EXPECT_NE(ss.str().find("cpu1 0 2 1 no"), string::npos) << ss.str();
+    }
+};
+
+TEST(opencores, ompic) {
+    ompic_stim stim("stim");
+    sc_core::sc_start();
+}
@@ -34,6 +34,7 @@ enum : u64 {
     PCI_BAR0_OFFSET = 0x10,
     PCI_BAR1_OFFSET = 0x14,
     PCI_BAR2_OFFSET = 0x18,
+    PCI_BAR3_OFFSET = 0x1c,
     PCI_CAP_OFFSET = 0x34,
 
     PCI_MSI_CTRL_OFF = 0x2,
@@ -50,6 +51,8 @@ enum : u64 {
     MMAP_PCI_CFG_SIZE = 0x10000,
     MMAP_PCI_MMIO_ADDR = 0x100010000,
     MMAP_PCI_MMIO_SIZE = 0x1000,
+    MMAP_PCI_MEM_ADDR = 0x100020000,
+    MMAP_PCI_MEM_SIZE = 0x1000,
     MMAP_PCI_MSI_ADDR = 0x40000,
     MMAP_PCI_MSI_SIZE = 0xc0000,
 
@@ -65,6 +68,7 @@ public:
     pci_target_socket pci_in;
     reg<u32> test_reg;
     reg<u32> test_reg_io;
+    u8 test_mem[MMAP_PCI_MEM_SIZE];
 
     void write_test_reg_io(u32 val) {
         if (val == 0x1234)
@@ -77,7 +81,8 @@ public:
         device(nm, TEST_CONFIG),
         pci_in("PCI_IN"),
         test_reg(PCI_AS_BAR0, "TEST_REG", TEST_REG_OFFSET, 1234),
-        test_reg_io(PCI_AS_BAR2, "TEST_REG_IO", TEST_REG_IO_OFF, 0x1234) {
+        test_reg_io(PCI_AS_BAR2, "TEST_REG_IO", TEST_REG_IO_OFF, 0x1234),
+        test_mem() {
         test_reg.allow_read_write();
         test_reg.sync_always();
         test_reg_io.allow_read_write();
@@ -85,6 +90,7 @@ public:
         test_reg_io.on_write(&pci_test_device::write_test_reg_io);
         pci_declare_bar(0, MMAP_PCI_MMIO_SIZE, PCI_BAR_MMIO | PCI_BAR_64);
         pci_declare_bar(2, MMAP_PCI_IO_SIZE, PCI_BAR_IO);
+        pci_declare_bar(3, MMAP_PCI_MEM_SIZE, PCI_BAR_PREFETCH, test_mem);
         pci_declare_pm_cap(PCI_PM_CAP_VER_1_1);
     }
 
@@ -147,6 +153,8 @@ public:
                                  MMAP_PCI_CFG_ADDR + MMAP_PCI_CFG_SIZE - 1);
         const range mmap_pci_mmio(MMAP_PCI_MMIO_ADDR,
                                   MMAP_PCI_MMIO_ADDR + MMAP_PCI_MMIO_SIZE - 1);
+        const range mmap_pci_mem(MMAP_PCI_MEM_ADDR,
+                                 MMAP_PCI_MEM_ADDR + MMAP_PCI_MEM_SIZE - 1);
         const range mmap_pci_io(MMAP_PCI_IO_ADDR,
                                 MMAP_PCI_IO_ADDR + MMAP_PCI_IO_SIZE - 1);
 
@@ -155,6 +163,7 @@ public:
         mmio_bus.bind(msi, mmap_pci_msi);
         mmio_bus.bind(pci_root.cfg_in, mmap_pci_cfg);
         mmio_bus.bind(pci_root.mmio_in[0], mmap_pci_mmio, MMAP_PCI_MMIO_ADDR);
+        mmio_bus.bind(pci_root.mmio_in[1], mmap_pci_mem, MMAP_PCI_MEM_ADDR);
 
         io_bus.bind(io);
         io_bus.bind(pci_root.io_in[0], mmap_pci_io, MMAP_PCI_IO_ADDR);
@@ -196,6 +205,12 @@ public:
         EXPECT_EQ(vendor_id, TEST_CONFIG.vendor_id) << "no vendor at slot 0";
         EXPECT_EQ(device_id, TEST_CONFIG.device_id) << "no device at slot 0";
 
+        // wide accesses span multiple config registers
+        u32 ids = 0;
+        pci_read_cfg(0, PCI_VENDOR_OFFSET, ids);
+        u32 expect = TEST_CONFIG.vendor_id | (u32)TEST_CONFIG.device_id << 16;
+        EXPECT_EQ(ids, expect);
+
         u32 nodev = 0;
         pci_read_cfg(1, PCI_VENDOR_OFFSET, nodev);
         EXPECT_EQ(nodev, 0xffffffff) << "vendor/device reported at slot 1";
@@ -246,6 +261,23 @@ public:
         wait_clock_cycle();
         EXPECT_FALSE(int_a.read()) << "interrupt did not get lowered";
 
+        //
+        // test dmi to prefetchable memory bar3
+        //
+        u32 bar3 = (u32)MMAP_PCI_MEM_ADDR | PCI_BAR_PREFETCH;
+        pci_write_cfg(0, PCI_BAR3_OFFSET, bar3);
+        EXPECT_OK(mmio.writew<u32>(MMAP_PCI_MEM_ADDR + 8, 0xabcd))
+            << "BAR3 setup failed: cannot write BAR3 range";
+        EXPECT_EQ(*(u32*)(pci_device.test_mem + 8), 0xabcd);
+        EXPECT_EQ(mmio.lookup_dmi_ptr(MMAP_PCI_MEM_ADDR, 4),
+                  pci_device.test_mem)
+            << "no DMI granted for BAR3";
+
+        // moving the bar must invalidate the dmi mapping
+        pci_write_cfg(0, PCI_BAR3_OFFSET, 0xffffffff);
+        EXPECT_EQ(mmio.lookup_dmi_ptr(MMAP_PCI_MEM_ADDR, 4), nullptr)
+            << "DMI for BAR3 remained active";
+
         //
         // test resetting bar0 & bar2
         //
@@ -356,6 +356,40 @@ public:
         EXPECT_EQ(msi_addr, msix_addr) << "got wrong MSIX address";
         EXPECT_EQ(msi_data, msix_data) << "got wrong MSIX data";
 
+        //
+        // test MSI-X moderation and direct delivery to an msi endpoint
+        //
+        size_t delivered = 0;
+        const range msix_range(msix_addr, msix_addr + 3);
+        pcie_root.map_msi(msix_range, [&](u64 addr, u32 data) -> bool {
+            EXPECT_EQ(addr, msix_addr) << "got wrong MSIX address";
+            EXPECT_EQ(data, msix_data) << "got wrong MSIX data";
+            delivered++;
+            return true;
+        });
+
+        msi_addr = msi_data = 0;
+        pcie_device.pci_moderate_irq(TEST_IRQ_VECTOR, 3, sc_time(1, SC_US));
+        for (int i = 0; i < 2; i++) {
+            EXPECT_OK(io.writew(MMAP_PCI_IO_ADDR + TEST_REG_IO_OFF, 0x1234))
+                << "BAR2 setup failed: cannot read BAR2 range";
+        }
+
+        wait_clock_cycle();
+        EXPECT_EQ(delivered, 0) << "MSIX sent before count threshold";
+        EXPECT_OK(io.writew(MMAP_PCI_IO_ADDR + TEST_REG_IO_OFF, 0x1234))
+            << "BAR2 setup failed: cannot read BAR2 range";
+        wait_clock_cycle();
+        EXPECT_EQ(delivered, 1) << "MSIX not sent at count threshold";
+
+        EXPECT_OK(io.writew(MMAP_PCI_IO_ADDR + TEST_REG_IO_OFF, 0x1234))
+            << "BAR2 setup failed: cannot read BAR2 range";
+        wait_clock_cycle();
+        EXPECT_EQ(delivered, 1) << "MSIX sent before time threshold";
+        wait(sc_time(1, SC_US));
+        EXPECT_EQ(delivered, 2) << "MSIX not sent at time threshold";
+        EXPECT_EQ(msi_addr, 0) << "MSIX bypassed the msi endpoint";
+
         //
         // test resetting bar0 & bar2
         //
@@ -76,10 +76,14 @@ public:
         ASSERT_EQ(mtimecmp1, mtime + 2 * d) << "mtimecmp1 holds wrong value";
         ASSERT_FALSE(irq_mtimer0.read()) << "IRQ_TIMER_0 triggered early";
         ASSERT_FALSE(irq_mtimer1.read()) << "IRQ_TIMER_1 triggered early";
+        EXPECT_EQ(aclint.next_timer_deadline(),
+                  sc_time_stamp() + clock_cycles(d));
         wait(clock_cycles(d));
         wait(SC_ZERO_TIME);
         ASSERT_TRUE(irq_mtimer0.read()) << "IRQ_TIMER_0 not triggered";
         ASSERT_FALSE(irq_mtimer1.read()) << "IRQ_TIMER_1 triggered early";
+        EXPECT_EQ(aclint.next_timer_deadline(),
+                  sc_time_stamp() + clock_cycles(d));
         wait(clock_cycles(d));
         wait(SC_ZERO_TIME);
         ASSERT_TRUE(irq_mtimer0.read()) << "IRQ_TIMER_0 not triggered";
@@ -91,6 +95,7 @@ public:
         wait(SC_ZERO_TIME);
         ASSERT_FALSE(irq_mtimer0.read()) << "IRQ_TIMER_0 not cleared";
         ASSERT_FALSE(irq_mtimer1.read()) << "IRQ_TIMER_1 not cleared";
+        EXPECT_EQ(aclint.next_timer_deadline(), SC_MAX_TIME);
 
         // schedule IRQ_TIMER0/1 in the past
         ASSERT_OK(out_mtimer.readw(0x7ff8, mtime)) << "cannot read mtime";
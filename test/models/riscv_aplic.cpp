@@ -178,6 +178,7 @@ public:
         // trigger level irq
         EXPECT_CALL(*this, msi_receive(0x100000004000, 16));
         irq1.raise();
+        wait(SC_ZERO_TIME); // msis go out at the end of the delta cycle
 
         // read pending bits and test input
         ASSERT_OK(out_m.readw(0x1c00, data));
@@ -191,6 +192,7 @@ public:
         // test delegated irq
         EXPECT_CALL(*this, msi_receive(0x200000004000, 6));
         irq2.pulse();
+        wait(SC_ZERO_TIME);
         ASSERT_OK(out_m.readw(0x1d00, data));
         EXPECT_EQ(data, 0);
         ASSERT_OK(out_m.readw(0x1d00, data));
@@ -0,0 +1,92 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+// sources and contexts supported at most by the riscv plic specification
+static const size_t NSRC = riscv::plic::NIRQ - 1;
+static const size_t NCTX = riscv::plic::NCTX;
+
+class plic_bench : public test_base
+{
+public:
+    tlm_initiator_socket out;
+
+    gpio_initiator_array irqs;
+    gpio_target_array irqt;
+
+    riscv::plic plic;
+
+    plic_bench(const sc_module_name& nm):
+        test_base(nm),
+        out("out"),
+        irqs("irqs", NSRC + 1),
+        irqt("irqt", NCTX),
+        plic("plic") {
+        clk.bind(plic.clk);
+        rst.bind(plic.rst);
+        out.bind(plic.in);
+
+        for (size_t irq = 1; irq <= NSRC; irq++)
+            irqs[irq].bind(plic.irqs[irq]);
+        for (size_t ctx = 0; ctx < NCTX; ctx++)
+            plic.irqt[ctx].bind(irqt[ctx]);
+    }
+
+    virtual void run_test() override {
+        for (size_t irq = 1; irq <= NSRC; irq++)
+            ASSERT_OK(out.writew(irq * 4, (u32)(irq % 7) + 1));
+
+        // every context listens to a different group of 32 sources
+        double t0 = mwr::timestamp();
+        for (size_t ctx = 0; ctx < NCTX; ctx++) {
+            u64 addr = 0x2000 + ctx * 0x80 + (ctx % 32) * 4;
+            ASSERT_OK(out.writew(addr, ~0u));
+        }
+
+        double t1 = mwr::timestamp();
+        for (size_t irq = 1; irq <= NSRC; irq++)
+            irqs[irq].write(true);
+        wait(SC_ZERO_TIME);
+
+        double t2 = mwr::timestamp();
+        u32 claims[64];
+        for (size_t ctx = 0; ctx < 64; ctx++) {
+            u64 addr = 0x200004 + ctx * 0x1000;
+            ASSERT_OK(out.readw(addr, claims[ctx]));
+            EXPECT_NE(claims[ctx], 0u);
+        }
+
+        for (size_t ctx = 0; ctx < 64; ctx++) {
+            u64 addr = 0x200004 + ctx * 0x1000;
+            ASSERT_OK(out.writew(addr, claims[ctx]));
+        }
+
+        double t3 = mwr::timestamp();
+        for (size_t irq = 1; irq <= NSRC; irq++)
+            irqs[irq].write(false);
+        wait(SC_ZERO_TIME);
+
+        for (size_t ctx = 0; ctx < NCTX; ctx++)
+            EXPECT_FALSE(irqt[ctx].read()) << "context " << ctx;
+
+        std::cout << "enable: " << (t1 - t0) * 1e6 / NCTX << "us/ctx"
+                  << std::endl
+                  << "raise:  " << (t2 - t1) * 1e6 / NSRC << "us/irq"
+                  << std::endl
+                  << "claim:  " << (t3 - t2) * 1e6 / 128 << "us/access"
+                  << std::endl;
+    }
+};
+
+TEST(plic, bench) {
+    plic_bench bench("bench");
+    sc_core::sc_start();
+}
@@ -0,0 +1,92 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class sdcard_harness : public test_base
+{
+public:
+    sd::card card;
+    sd_initiator_socket sd_out;
+
+    sdcard_harness(const sc_module_name& nm):
+        test_base(nm), card("card", "ramdisk:1MiB"), sd_out("sd_out") {
+        rst.bind(card.rst);
+        clk.bind(card.clk);
+        sd_out.bind(card.sd_in);
+    }
+
+    sd_status command(u8 opcode, u32 argument) {
+        sd_command cmd;
+        sd_reset(cmd);
+        cmd.opcode = opcode;
+        cmd.argument = argument;
+        cmd.crc = sd_crc7(cmd);
+        sd_out.transport(cmd);
+        return cmd.status;
+    }
+
+    sd_status_rx write_block(size_t blkno) {
+        u8 data[512];
+        for (size_t i = 0; i < sizeof(data); i++)
+            data[i] = (u8)(blkno + i);
+
+        u16 crc = crc16_sd(data, sizeof(data));
+        for (u8 val : data)
+            EXPECT_EQ(sd_out.write_data(val), SDRX_OK);
+        EXPECT_EQ(sd_out.write_data(crc >> 8), SDRX_OK);
+        EXPECT_EQ(sd_out.write_data(crc >> 0), SDRX_OK);
+        return sd_out.write_data(0xff);
+    }
+
+    sd_status_tx read_block(size_t blkno) {
+        u8 val = 0;
+        for (size_t i = 0; i < 512; i++) {
+            EXPECT_EQ(sd_out.read_data(val), SDTX_OK);
+            EXPECT_EQ(val, (u8)(blkno + i));
+        }
+
+        EXPECT_EQ(sd_out.read_data(val), SDTX_OK); // crc
+        EXPECT_EQ(sd_out.read_data(val), SDTX_OK);
+        return sd_out.read_data(val);
+    }
+
+    virtual void run_test() override {
+        ASSERT_TRUE(card.is_sdsc());
+
+        // multi-block writes are collected and stored in one request
+        ASSERT_EQ(command(25, 0), SD_OK_RX_RDY); // WRITE_MULTIPLE_BLOCK
+        for (size_t blk = 0; blk < 32; blk++)
+            EXPECT_EQ(write_block(blk), SDRX_OK_BLK_DONE);
+        EXPECT_EQ(card.disk.stats.num_write_req, 0u);
+        ASSERT_EQ(command(12, 0), SD_OK); // STOP_TRANSMISSION
+        EXPECT_EQ(card.disk.stats.num_write_req, 1u);
+        EXPECT_EQ(card.disk.stats.num_bytes_written, 32u * 512u);
+
+        // multi-block reads fetch growing windows instead of single blocks
+        ASSERT_EQ(command(18, 0), SD_OK_TX_RDY); // READ_MULTIPLE_BLOCK
+        for (size_t blk = 0; blk < 32; blk++)
+            EXPECT_EQ(read_block(blk), SDTX_OK_BLK_DONE);
+        ASSERT_EQ(command(12, 0), SD_OK); // STOP_TRANSMISSION
+        EXPECT_LE(card.disk.stats.num_read_req, 4u);
+
+        // single block writes go straight to disk and drop stale windows
+        ASSERT_EQ(command(24, 512), SD_OK_RX_RDY); // WRITE_BLOCK
+        EXPECT_EQ(write_block(7), SDRX_OK_COMPLETE);
+        EXPECT_EQ(card.disk.stats.num_write_req, 2u);
+        ASSERT_EQ(command(17, 512), SD_OK_TX_RDY); // READ_SINGLE_BLOCK
+        EXPECT_EQ(read_block(7), SDTX_OK_COMPLETE);
+    }
+};
+
+TEST(sdcard, bulk) {
+    sdcard_harness test("harness");
+    sc_core::sc_start();
+}
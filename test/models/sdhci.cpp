@@ -502,6 +502,87 @@ public:
         ASSERT_OK(out.readw(0x32, value_of_error_int_stat))
             << "error interrupt has been triggered additionally";
         EXPECT_EQ(0x0000, value_of_error_int_stat);
+
+        /**********************************************************************
+         *                                                                    *
+         *             test read_multiple_block (with ADMA2)                  *
+         *                                                                    *
+         **********************************************************************/
+
+        ASSERT_OK(out.writew<u8>(0x2F, 0x01)) << "reset the SDHCI";
+        sdhci.dma_enabled = true; // tests with DMA
+
+        cmd.opcode = 18;
+        cmd.status = SD_INCOMPLETE;
+
+        EXPECT_CALL(sdcard, test_transport(_))
+            .WillOnce(DoAll(SetArgReferee<0>(cmd), Return(SD_OK_TX_RDY)));
+
+        EXPECT_CALL(sdcard, test_data_read(_))
+            .WillOnce(DoAll(SetArgReferee<0>(0x01), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0X02), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x03), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x04), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x05), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x06), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x07), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x08), Return(SDTX_OK_BLK_DONE)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x09), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x0A), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0X0B), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x0C), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x0D), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x0E), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x0F), Return(SDTX_OK)))
+            .WillOnce(DoAll(SetArgReferee<0>(0x10), Return(SDTX_OK_BLK_DONE)));
+
+        // four bytes to 0x80, link to 0x120, twelve bytes to 0x90 and stop
+        u64 desc0 = 0x0000008000040021;
+        u64 desc1 = 0x0000012000000031;
+        u64 desc2 = 0x00000090000c0027;
+        ASSERT_OK(mem.write(range(0x100, 0x107), &desc0, SBI_NONE));
+        ASSERT_OK(mem.write(range(0x108, 0x10f), &desc1, SBI_NONE));
+        ASSERT_OK(mem.write(range(0x120, 0x127), &desc2, SBI_NONE));
+
+        u32 caps = 0;
+        ASSERT_OK(out.readw(0x40, caps)) << "read CAPABILITIES register";
+        EXPECT_TRUE(caps & bit(19)) << "ADMA2 not supported";
+
+        ASSERT_OK(out.writew<u8>(0x28, 0x10)) << "select 32-bit ADMA2";
+        ASSERT_OK(out.writew<u32>(0x58, 0x100)) << "set the ADMA address";
+        ASSERT_OK(out.writew<u16>(0x04, 0x0008))
+            << "define block size to eight byte";
+        ASSERT_OK(out.writew<u16>(0x06, 0x0002))
+            << "write two to BLOCK_COUNT_16BIT register";
+        ASSERT_OK(out.writew<u32>(0x08, 0x00000000))
+            << "write zero to ARG register";
+        ASSERT_OK(out.writew<u16>(0x0e, 0x123a))
+            << "write CMD18 (READ_MULTIPLE_BLOCK) to CMD register";
+
+        wait(1, SC_US); // allow the ADMA transfer to complete
+        EXPECT_TRUE(sdhci.irq.read())
+            << "check whether an interrupt has been triggered";
+
+        ASSERT_OK(out.readw(0x30, value_of_normal_int_stat))
+            << "command complete, transfer complete and dma interrupt";
+        EXPECT_EQ(0x000b, value_of_normal_int_stat);
+        ASSERT_OK(out.writew<u16>(0x30, 0x000b)) << "clear the interrupt";
+
+        ASSERT_OK(out.readw(0x32, value_of_error_int_stat))
+            << "error interrupt has been triggered additionally";
+        EXPECT_EQ(0x0000, value_of_error_int_stat);
+
+        u32 adma_addr = 0;
+        ASSERT_OK(out.readw(0x58, adma_addr)) << "read the ADMA address";
+        EXPECT_EQ(0x128, adma_addr) << "ADMA did not follow the link";
+
+        u32 mem2 = 0;
+        mem.read(range(0x80, 0x83), &mem2, SBI_NONE);
+        mem.read(range(0x90, 0x97), &mem0, SBI_NONE);
+        mem.read(range(0x98, 0x9f), &mem1, SBI_NONE);
+        EXPECT_EQ(mem2, 0x04030201) << "first ADMA segment";
+        EXPECT_EQ(mem0, 0x0c0b0a0908070605) << "second ADMA segment";
+        EXPECT_EQ(mem1 & 0xffffffff, 0x100f0e0d) << "second ADMA segment";
     }
 };
 
@@ -86,7 +86,9 @@ public:
         ASSERT_OK(out.writew<u32>(CDNS_IER, bit(8)));
         ASSERT_OK(out.writew<u32>(CDNS_RTOR, 10u));
         serial_tx.send('A');
-        EXPECT_TRUE(irq);
+        EXPECT_FALSE(irq) << "timeout irq raised too early";
+        wait(4500, SC_US); // rtor * 4 bit periods at 9600 baud
+        EXPECT_TRUE(irq) << "timeout irq not raised";
 
         // clear rx interrupt
         ASSERT_OK(out.writew(CDNS_ISR, bit(8)));
@@ -19,6 +19,8 @@ public:
 
     gpio_target_socket irq_in;
 
+    serial_initiator_socket serial_tx;
+
     serial::pl011 uart;
 
     pl011_bench(const sc_module_name& nm):
@@ -26,6 +28,7 @@ public:
         out("out"),
         reset_out("reset_out"),
         irq_in("irq_in"),
+        serial_tx("serial_tx"),
         uart("pl011") {
         out.bind(uart.in);
         uart.irq.bind(irq_in);
@@ -33,7 +36,7 @@ public:
         reset_out.bind(rst);
         clk.bind(uart.clk);
 
-        uart.serial_rx.stub();
+        serial_tx.bind(uart.serial_rx);
         uart.serial_tx.stub();
     }
 
@@ -41,9 +44,12 @@ public:
         enum addresses : u64 {
             PL011_UARTDR = 0x00,
             PL011_UARTFR = 0x18,
+            PL011_UARTLCR = 0x2c,
             PL011_UARTCR = 0x30,
+            PL011_UARTIFLS = 0x34,
             PL011_UARTIMSC = 0x38,
             PL011_UARTRIS = 0x3c,
+            PL011_UARTICR = 0x44,
         };
 
         // check initial UART status
@@ -72,6 +78,36 @@ public:
         EXPECT_OK(out.writew(PL011_UARTIMSC, val)) << "cannot write UARTIMSC";
         EXPECT_TRUE(irq_in) << "interrupt did not trigger";
 
+        // enable FIFO, receive interrupt at half full
+        EXPECT_OK(out.writew<u32>(PL011_UARTLCR, serial::pl011::LCR_FEN));
+        EXPECT_OK(out.writew<u32>(PL011_UARTIFLS, 2 << 3));
+        val = serial::pl011::RIS_RX | serial::pl011::RIS_RT;
+        EXPECT_OK(out.writew(PL011_UARTIMSC, val));
+        EXPECT_OK(out.writew<u32>(PL011_UARTICR, serial::pl011::RIS_TX));
+        EXPECT_FALSE(irq_in) << "spurious interrupt received";
+
+        // below the trigger level only the receive timeout fires
+        const u8 data[8] = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h' };
+        serial_tx.send(data, 4);
+        EXPECT_FALSE(irq_in) << "receive interrupt below trigger level";
+        wait(4, SC_MS); // 32 bit periods at 9600 baud
+        EXPECT_TRUE(irq_in) << "receive timeout did not trigger";
+        EXPECT_OK(out.readw(PL011_UARTRIS, val));
+        EXPECT_EQ(val, serial::pl011::RIS_RT);
+
+        for (u8 c : { 'a', 'b', 'c', 'd' }) {
+            EXPECT_OK(out.readw(PL011_UARTDR, val));
+            EXPECT_EQ(val, c);
+        }
+
+        EXPECT_FALSE(irq_in) << "interrupt not cleared on empty FIFO";
+
+        // reaching the trigger level interrupts right away
+        serial_tx.send(data, 8);
+        EXPECT_TRUE(irq_in) << "receive interrupt did not trigger";
+        EXPECT_OK(out.readw(PL011_UARTRIS, val));
+        EXPECT_EQ(val, serial::pl011::RIS_RX);
+
         // check reset works
         reset_out = true;
         wait(10, SC_MS);
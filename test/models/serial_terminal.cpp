@@ -0,0 +1,167 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class backend_mock : public serial::backend
+{
+public:
+    vector<string> batches;
+    string input;
+
+    backend_mock(serial::terminal* term): backend(term, "mock") {}
+    virtual ~backend_mock() = default;
+
+    virtual bool read(u8& val) override { return read(&val, 1) > 0; }
+
+    virtual size_t read(u8* data, size_t size) override {
+        size_t n = min(size, input.size());
+        memcpy(data, input.data(), n);
+        input.erase(0, n);
+        return n;
+    }
+    virtual void write(u8 val) override { write(&val, 1); }
+
+    virtual void write(const u8* data, size_t size) override {
+        batches.emplace_back((const char*)data, size);
+    }
+};
+
+class terminal_bench : public test_base, public serial_host
+{
+public:
+    serial_initiator_socket serial_tx;
+    serial_target_socket serial_rx;
+
+    serial::terminal term;
+    backend_mock mock;
+    string received;
+
+    terminal_bench(const sc_module_name& nm):
+        test_base(nm),
+        serial_host(),
+        serial_tx("serial_tx"),
+        serial_rx("serial_rx"),
+        term("term"),
+        mock(&term),
+        received() {
+        serial_tx.bind(term.serial_rx);
+        term.serial_tx.bind(serial_rx);
+    }
+
+    virtual void serial_receive(u8 data) override {
+        received.push_back((char)data);
+    }
+
+    void send(const string& s) {
+        for (char c : s)
+            serial_tx.send((u8)c);
+    }
+
+    virtual void run_test() override {
+        // a full line is handed over in one piece
+        send("hello\n");
+        ASSERT_EQ(mock.batches.size(), 1u);
+        EXPECT_EQ(mock.batches[0], "hello\n");
+
+        // a prompt without newline appears once flush_delay has passed
+        send("$ ");
+        EXPECT_EQ(mock.batches.size(), 1u);
+        wait(term.flush_delay);
+        wait(SC_ZERO_TIME);
+        ASSERT_EQ(mock.batches.size(), 2u);
+        EXPECT_EQ(mock.batches[1], "$ ");
+
+        // long output is split at flush_size
+        send(string(term.flush_size + 10, 'x'));
+        ASSERT_EQ(mock.batches.size(), 3u);
+        EXPECT_EQ(mock.batches[2].size(), term.flush_size.get());
+
+        // whatever is left is flushed on demand
+        term.flush();
+        ASSERT_EQ(mock.batches.size(), 4u);
+        EXPECT_EQ(mock.batches[3], string(10, 'x'));
+
+        vector<u8> hist;
+        term.fetch_history(hist);
+        EXPECT_EQ(hist.size(), 8u + term.flush_size + 10);
+
+        // pasted input is forwarded at the configured baud rate
+        mock.input = "paste";
+        term.notify(&mock);
+        wait(term.serial_tx.cycle() * 2);
+        EXPECT_LT(received.size(), 5u);
+        EXPECT_TRUE(mock.input.empty());
+        wait(term.serial_tx.cycle() * 4);
+        EXPECT_EQ(received, "paste");
+    }
+};
+
+class backend_slow : public serial::backend
+{
+public:
+    mutex mtx;
+    string output;
+    atomic<bool> stalled;
+    atomic<bool> writing;
+
+    backend_slow(serial::terminal* term):
+        backend(term, "slow"), stalled(true), writing(false) {}
+    virtual ~backend_slow() { stop_queue(); }
+
+    virtual bool read(u8& val) override { return false; }
+    virtual void write(u8 val) override { write(&val, 1); }
+
+    virtual void write(const u8* data, size_t size) override {
+        writing = true;
+        while (stalled)
+            mwr::usleep(100);
+        lock_guard<mutex> guard(mtx);
+        output.append((const char*)data, size);
+    }
+};
+
+TEST(serial, output_queue) {
+    serial::terminal term("queue_term");
+    backend_slow slow(&term);
+
+    // the consumer is stuck writing the first byte, later output beyond
+    // the queue capacity must be dropped instead of stalling the sender
+    slow.start_queue(16, true);
+    slow.send((const u8*)"A", 1);
+    while (!slow.writing)
+        mwr::usleep(100);
+
+    string text = "0123456789abcdefXYZW";
+    slow.send((const u8*)text.data(), text.size());
+
+    serial::backend::queue_stats stats = slow.get_queue_stats();
+    EXPECT_EQ(stats.num_bytes, 17u);
+    EXPECT_EQ(stats.num_dropped, 4u);
+    EXPECT_EQ(stats.num_stalls, 0u);
+    EXPECT_EQ(stats.peak_level, 16u);
+
+    slow.stalled = false;
+    slow.stop_queue();
+    EXPECT_EQ(slow.output, "A" + text.substr(0, 16));
+
+    // blocking queues hand over everything, however small they are
+    slow.output.clear();
+    slow.start_queue(4, false);
+    slow.send((const u8*)text.data(), text.size());
+    slow.stop_queue();
+    EXPECT_EQ(slow.output, text);
+    EXPECT_EQ(slow.get_queue_stats().num_dropped, 4u);
+}
+
+TEST(serial, terminal) {
+    terminal_bench bench("bench");
+    sc_core::sc_start();
+}
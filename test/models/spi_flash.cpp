@@ -16,11 +16,17 @@ public:
     spi::flash flash;
     spi_initiator_socket spi_out;
     gpio_initiator_socket cs_out;
+    tlm_initiator_socket xip_out;
 
     test_harness(const sc_module_name& nm):
-        test_base(nm), flash("flash"), spi_out("spi_out"), cs_out("cs_out") {
+        test_base(nm),
+        flash("flash"),
+        spi_out("spi_out"),
+        cs_out("cs_out"),
+        xip_out("xip_out") {
         spi_out.bind(flash.spi_in);
         cs_out.bind(flash.cs_in);
+        xip_out.bind(flash.xip_in);
         rst.bind(flash.rst);
         clk.bind(flash.clk);
     }
@@ -56,6 +62,75 @@ public:
         spi_send(0x05); // READ_STATUS
         status = spi_recv();
         EXPECT_EQ(status, 0);
+
+        // flash contents can be read and executed in place via dmi, they
+        // are paged in from the disk upon first access
+        u16 data = 0xffff;
+        EXPECT_EQ(flash.xip_chunks_loaded(), 0u);
+        EXPECT_EQ(xip_out.lookup_dmi_ptr(0x10, 2), nullptr);
+        EXPECT_OK(xip_out.readw(0x10, data));
+        EXPECT_EQ(data, 0);
+        EXPECT_EQ(flash.xip_chunks_loaded(), 1u);
+        EXPECT_NE(xip_out.lookup_dmi_ptr(0x10, 2), nullptr);
+        EXPECT_EQ(xip_out.lookup_dmi_ptr(spi::flash::XIP_CHUNK, 2), nullptr);
+        EXPECT_CE(xip_out.writew<u16>(0x10, 0x1234));
+
+        // erasing revokes dmi until the command has ended
+        spi_send(0xd8); // SECTOR_ERASE
+        spi_send(0x00);
+        spi_send(0x00);
+        spi_send(0x00);
+        EXPECT_EQ(xip_out.lookup_dmi_ptr(0x10, 2), nullptr);
+        cs_out.lower();
+        cs_out.raise();
+
+        spi_send(0x02); // PAGE_PROGRAM
+        spi_send(0x00);
+        spi_send(0x00);
+        spi_send(0x10);
+        spi_send(0xaa);
+        spi_send(0xbb);
+        EXPECT_OK(xip_out.readw(0x10, data));
+        EXPECT_EQ(data, 0xbbaa);
+        EXPECT_EQ(xip_out.lookup_dmi_ptr(0x10, 2), nullptr);
+        cs_out.lower();
+
+        EXPECT_OK(xip_out.readw(0x10, data));
+        EXPECT_EQ(data, 0xbbaa);
+        EXPECT_NE(xip_out.lookup_dmi_ptr(0x10, 2), nullptr);
+
+        // programming stays active until the next command, so use bursts
+        // to program more data and to read everything back in one go
+        u8 page[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+        u8 miso[6] = {};
+        spi_out.transport(page, miso, sizeof(page));
+        EXPECT_OK(xip_out.readw(0x14, data));
+        EXPECT_EQ(data, 0x4433);
+
+        cs_out.lower();
+        flash.reset();
+        cs_out.raise();
+
+        u8 cmd[12] = { 0x03, 0x00, 0x00, 0x10 }; // READ_DATA
+        spi_out.transport(cmd, cmd, sizeof(cmd));
+        const u8 expect[8] = {
+            0xaa, 0xbb, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+        };
+        for (size_t i = 0; i < sizeof(expect); i++)
+            EXPECT_EQ(cmd[4 + i], expect[i]) << "byte " << i;
+        cs_out.lower();
+        flash.reset();
+        cs_out.raise();
+
+        // chunks programmed before being paged in read back from disk
+        spi_send(0x06); // WRITE_ENABLE
+        u8 prog[6] = { 0x02, 0x02, 0x00, 0x00, 0x5a, 0xa5 }; // PAGE_PROGRAM
+        spi_out.transport(prog, miso, sizeof(prog));
+        cs_out.lower();
+        EXPECT_EQ(flash.xip_chunks_loaded(), 1u);
+        EXPECT_OK(xip_out.readw(0x20000, data));
+        EXPECT_EQ(data, 0xa55a);
+        EXPECT_EQ(flash.xip_chunks_loaded(), 2u);
     }
 };
 
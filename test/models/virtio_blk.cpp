@@ -30,6 +30,7 @@ public:
         virtio_blk("virtio_blk"),
         out("out"),
         irq("irq") {
+        virtio_blk.num_queues = 2;
         virtio.virtio_out.bind(virtio_blk.virtio_in);
 
         bus.bind(mem.in, 0, 0xfff);
@@ -80,6 +81,7 @@ public:
         ASSERT_OK(out.writew(BLK_DEVF_SEL, 0u));
         ASSERT_OK(out.readw(BLK_DEVF, data));
         ASSERT_TRUE(data & (bit(5) | bit(6))); // readonly + block size
+        ASSERT_TRUE(data & bit(12));           // multiqueue
         ASSERT_OK(out.writew(BLK_DRVF_SEL, 0u));
         ASSERT_OK(out.writew(BLK_DRVF, data));
 
@@ -98,6 +100,11 @@ public:
         data = 1;
         ASSERT_OK(out.writew(BLK_VQ_SEL, data));
         ASSERT_OK(out.readw(BLK_VQ_MAX, data));
+        EXPECT_EQ(data, 256);
+
+        data = 2;
+        ASSERT_OK(out.writew(BLK_VQ_SEL, data));
+        ASSERT_OK(out.readw(BLK_VQ_MAX, data));
         EXPECT_EQ(data, 0);
     }
 };
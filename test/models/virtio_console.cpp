@@ -19,6 +19,9 @@ public:
     virtio::mmio virtio;
     virtio::console virtio_console;
 
+    virtio::mmio multi;
+    virtio::console multi_console;
+
     tlm_initiator_socket out;
     gpio_target_socket irq;
 
@@ -28,27 +31,42 @@ public:
         mem("mem", 0x1000),
         virtio("virtio"),
         virtio_console("virtio_input"),
+        multi("multi"),
+        multi_console("multi_console"),
         out("out"),
         irq("irq") {
         virtio.virtio_out.bind(virtio_console.virtio_in);
         virtio_console.serial_tx.stub();
         virtio_console.serial_rx.stub();
 
+        multi.virtio_out.bind(multi_console.virtio_in);
+        multi_console.serial_tx.stub();
+        multi_console.serial_rx.stub();
+        for (u32 port = 1; port < multi_console.ports; port++) {
+            multi_console.port_tx[port].stub();
+            multi_console.port_rx[port].stub();
+        }
+
         bus.bind(mem.in, 0, 0xfff);
         bus.bind(virtio.in, 0x1000, 0x1fff);
+        bus.bind(multi.in, 0x2000, 0x2fff);
 
         bus.bind(out);
         bus.bind(virtio.out);
+        bus.bind(multi.out);
 
         virtio.irq.bind(irq);
+        multi.irq.stub();
 
         clk.bind(bus.clk);
         clk.bind(mem.clk);
         clk.bind(virtio.clk);
+        clk.bind(multi.clk);
 
         rst.bind(bus.rst);
         rst.bind(mem.rst);
         rst.bind(virtio.rst);
+        rst.bind(multi.rst);
     }
 
     virtual void run_test() override {
@@ -57,9 +75,12 @@ public:
             CONSOLE_MAGIC = CONSOLE_BASE + 0x00,
             CONSOLE_VERSION = CONSOLE_BASE + 0x04,
             CONSOLE_DEVID = CONSOLE_BASE + 0x08,
+            CONSOLE_DEVF = CONSOLE_BASE + 0x10,
+            CONSOLE_DEVF_SEL = CONSOLE_BASE + 0x14,
             CONSOLE_VQ_SEL = CONSOLE_BASE + 0x30,
             CONSOLE_VQ_MAX = CONSOLE_BASE + 0x34,
             CONSOLE_STATUS = CONSOLE_BASE + 0x70,
+            MULTI_OFFSET = 0x1000,
         };
 
         u32 data;
@@ -106,11 +127,34 @@ public:
         ASSERT_OK(out.writew(CONSOLE_VQ_SEL, data));
         ASSERT_OK(out.readw(CONSOLE_VQ_MAX, data));
         EXPECT_EQ(data, 0);
+
+        // single port consoles must not offer multiport
+        ASSERT_OK(out.writew(CONSOLE_DEVF_SEL, 0u));
+        ASSERT_OK(out.readw(CONSOLE_DEVF, data));
+        EXPECT_FALSE(data & bit(1));
+
+        // three ports need a control queue pair plus three data pairs
+        ASSERT_OK(out.writew(CONSOLE_DEVF_SEL + MULTI_OFFSET, 0u));
+        ASSERT_OK(out.readw(CONSOLE_DEVF + MULTI_OFFSET, data));
+        EXPECT_TRUE(data & bit(1));
+
+        for (u32 vq = 0; vq < 9; vq++) {
+            ASSERT_OK(out.writew(CONSOLE_VQ_SEL + MULTI_OFFSET, vq));
+            ASSERT_OK(out.readw(CONSOLE_VQ_MAX + MULTI_OFFSET, data));
+            if (vq < 8)
+                EXPECT_GT(data, 0) << "virtqueue " << vq;
+            else
+                EXPECT_EQ(data, 0) << "virtqueue " << vq;
+        }
     }
 };
 
 TEST(virtio, rng) {
-    virtio_rng_stim stim;
+    vcml::broker broker("test");
+    broker.define("stim.multi_console.ports", 3);
+    broker.define("stim.multi_console.names", "con log xfer");
+
+    virtio_rng_stim stim("stim");
     stim.clk.stub(100 * MHz);
     stim.rst.stub();
 
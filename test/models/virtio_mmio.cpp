@@ -0,0 +1,164 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class mock_virtio_device : public module, public virtio_device
+{
+public:
+    virtio_target_socket virtio_in;
+
+    bool* busy;
+    bool last_busy;
+    size_t num_notified;
+
+    mock_virtio_device(const sc_module_name& nm, bool* b):
+        module(nm),
+        virtio_in("virtio_in"),
+        busy(b),
+        last_busy(false),
+        num_notified(0) {
+        // nothing to do
+    }
+
+    virtual void identify(virtio_device_desc& desc) override {
+        desc.device_id = VIRTIO_DEVICE_RNG;
+        desc.vendor_id = VIRTIO_VENDOR_VCML;
+        desc.pci_class = PCI_CLASS_OTHERS;
+        desc.request_virtqueue(0, 8);
+    }
+
+    // records whether the notifying register write is still in progress
+    virtual bool notify(u32 vqid) override {
+        EXPECT_EQ(vqid, 0u);
+        num_notified++;
+        last_busy = *busy;
+        return true;
+    }
+
+    virtual void read_features(u64& features) override { features = 0; }
+    virtual bool write_features(u64 features) override { return true; }
+
+    virtual bool read_config(const range& addr, void* ptr) override {
+        return false;
+    }
+
+    virtual bool write_config(const range& addr, const void* ptr) override {
+        return false;
+    }
+};
+
+class virtio_mmio_test : public test_base
+{
+public:
+    enum addresses : u64 {
+        VIRTIO_BASE = 0x1000,
+        VIRTIO_QUEUE_SEL = VIRTIO_BASE + 0x30,
+        VIRTIO_QUEUE_NUM = VIRTIO_BASE + 0x38,
+        VIRTIO_QUEUE_READY = VIRTIO_BASE + 0x44,
+        VIRTIO_QUEUE_NOTIFY = VIRTIO_BASE + 0x50,
+        VIRTIO_STATUS = VIRTIO_BASE + 0x70,
+        VIRTIO_QUEUE_DESC = VIRTIO_BASE + 0x80,
+        VIRTIO_QUEUE_DRIVER = VIRTIO_BASE + 0x90,
+        VIRTIO_QUEUE_DEVICE = VIRTIO_BASE + 0xa0,
+    };
+
+    bool busy;
+
+    generic::bus bus;
+    generic::memory mem;
+
+    virtio::mmio virtio;
+    mock_virtio_device device;
+
+    tlm_initiator_socket out;
+    gpio_target_socket irq;
+
+    virtio_mmio_test(const sc_module_name& nm):
+        test_base(nm),
+        busy(false),
+        bus("bus"),
+        mem("mem", 0x1000),
+        virtio("virtio"),
+        device("device", &busy),
+        out("out"),
+        irq("irq") {
+        virtio.virtio_out.bind(device.virtio_in);
+
+        bus.bind(mem.in, 0, 0xfff);
+        bus.bind(virtio.in, 0x1000, 0x1fff);
+
+        bus.bind(out);
+        bus.bind(virtio.out);
+
+        virtio.irq.bind(irq);
+
+        clk.bind(bus.clk);
+        clk.bind(mem.clk);
+        clk.bind(virtio.clk);
+
+        rst.bind(bus.rst);
+        rst.bind(mem.rst);
+        rst.bind(virtio.rst);
+    }
+
+    void notify(u32 vqid) {
+        busy = true;
+        ASSERT_OK(out.writew(VIRTIO_QUEUE_NOTIFY, vqid));
+        busy = false;
+    }
+
+    virtual void run_test() override {
+        u32 data = VIRTIO_STATUS_ACKNOWLEDGE;
+        ASSERT_OK(out.writew(VIRTIO_STATUS, data));
+        data |= VIRTIO_STATUS_DRIVER;
+        ASSERT_OK(out.writew(VIRTIO_STATUS, data));
+        data |= VIRTIO_STATUS_FEATURES_OK;
+        ASSERT_OK(out.writew(VIRTIO_STATUS, data));
+        data |= VIRTIO_STATUS_DRIVER_OK;
+        ASSERT_OK(out.writew(VIRTIO_STATUS, data));
+
+        // split virtqueue with 8 entries in the first page of memory
+        ASSERT_OK(out.writew(VIRTIO_QUEUE_SEL, 0u));
+        ASSERT_OK(out.writew(VIRTIO_QUEUE_NUM, 8u));
+        ASSERT_OK(out.writew(VIRTIO_QUEUE_DESC, 0x000u));
+        ASSERT_OK(out.writew(VIRTIO_QUEUE_DRIVER, 0x100u));
+        ASSERT_OK(out.writew(VIRTIO_QUEUE_DEVICE, 0x200u));
+        ASSERT_OK(out.writew(VIRTIO_QUEUE_READY, 1u));
+        ASSERT_TRUE(virtio.device_ready());
+
+        // by default, the device is notified within the register write
+        notify(0);
+        EXPECT_EQ(device.num_notified, 1u);
+        EXPECT_TRUE(device.last_busy);
+
+        // asynchronously, the write completes first and repeated
+        // notifications of a pending queue are merged
+        virtio.async_notify = true;
+        notify(0);
+        notify(0);
+        EXPECT_EQ(device.num_notified, 1u);
+
+        wait(1, SC_NS);
+        EXPECT_EQ(device.num_notified, 2u);
+        EXPECT_FALSE(device.last_busy);
+
+        // pending notifications are dropped when the device is reset
+        notify(0);
+        ASSERT_OK(out.writew(VIRTIO_STATUS, 0u));
+        wait(1, SC_NS);
+        EXPECT_EQ(device.num_notified, 2u);
+    }
+};
+
+TEST(virtio, mmio) {
+    virtio_mmio_test test("test");
+    sc_core::sc_start();
+}
@@ -30,7 +30,15 @@ public:
                             virtio::net::VIRTIO_NET_F_CTRL_RX |
                             virtio::net::VIRTIO_NET_F_CTRL_RX_EXTRA |
                             virtio::net::VIRTIO_NET_F_CTRL_ANNOUNCE |
-                            virtio::net::VIRTIO_NET_F_CTRL_MAC_ADDR;
+                            virtio::net::VIRTIO_NET_F_CTRL_MAC_ADDR |
+                            virtio::net::VIRTIO_NET_F_MRG_RXBUF |
+                            virtio::net::VIRTIO_NET_F_CSUM |
+                            virtio::net::VIRTIO_NET_F_GUEST_CSUM |
+                            virtio::net::VIRTIO_NET_F_HOST_TSO4 |
+                            virtio::net::VIRTIO_NET_F_HOST_TSO6 |
+                            virtio::net::VIRTIO_NET_F_GUEST_TSO4 |
+                            virtio::net::VIRTIO_NET_F_GUEST_TSO6 |
+                            virtio::net::VIRTIO_NET_F_MQ;
 
     virtio_net_stim(const sc_module_name& nm = sc_gen_unique_name("stim")):
         test_base(nm),
@@ -40,6 +48,7 @@ public:
         virtio_net("virtio_net"),
         out("out"),
         irq("irq") {
+        virtio_net.queues = 2;
         virtio.virtio_out.bind(virtio_net.virtio_in);
 
         virtio_net.eth_rx.stub();
@@ -117,14 +126,21 @@ public:
         ASSERT_OK(out.readw(NET_VQ_MAX, data));
         EXPECT_EQ(data, 256);
 
-        // ctrl queue should exist
-        data = virtio::net::VIRTQUEUE_CTRL;
-        ASSERT_OK(out.writew(NET_VQ_SEL, data));
+        // second queue pair should exist
+        ASSERT_OK(out.writew(NET_VQ_SEL, 2u));
+        ASSERT_OK(out.readw(NET_VQ_MAX, data));
+        EXPECT_EQ(data, 256);
+        ASSERT_OK(out.writew(NET_VQ_SEL, 3u));
+        ASSERT_OK(out.readw(NET_VQ_MAX, data));
+        EXPECT_EQ(data, 256);
+
+        // ctrl queue should follow the last queue pair
+        ASSERT_OK(out.writew(NET_VQ_SEL, 4u));
         ASSERT_OK(out.readw(NET_VQ_MAX, data));
         EXPECT_EQ(data, 64);
 
         // other queues should not exist
-        data = virtio::net::VIRTQUEUE_CTRL + 1;
+        data = 5;
         ASSERT_OK(out.writew(NET_VQ_SEL, data));
         ASSERT_OK(out.readw(NET_VQ_MAX, data));
         EXPECT_EQ(data, 0);
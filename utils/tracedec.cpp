@@ -0,0 +1,38 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/tracing/tracer_bin.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <trace.bin> [output.txt]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        if (argc == 3) {
+            vcml::ofstream os(argv[2]);
+            if (!os) {
+                std::cerr << "cannot open " << argv[2] << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            vcml::tracer_bin::decode(argv[1], os);
+        } else {
+            vcml::tracer_bin::decode(argv[1], std::cout);
+        }
+    } catch (std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}